@@ -25,7 +25,40 @@ static NSString *const AWSAPIGatewayAPIKeyHeader = @"x-api-key";
 
 static NSString *const AWSAPIGatewaySDKVersion = @"2.6.12";
 
-static int defaultChunkSize = 1024;
+typedef NS_ENUM(NSInteger, AWSAPIGatewayResponseMapperState) {
+    AWSAPIGatewayResponseMapperStateUndecided,
+    AWSAPIGatewayResponseMapperStateBuffering,
+    AWSAPIGatewayResponseMapperStateMappingArray,
+    AWSAPIGatewayResponseMapperStateMappedArray,
+    AWSAPIGatewayResponseMapperStateFailed,
+};
+
+/**
+ Turns the response of one `invokeHTTPRequest` call into its result as the body arrives. A successful response
+ whose body is a JSON array is mapped one element at a time and only the element being received is kept in memory;
+ any other response is buffered and mapped once it is complete.
+ */
+@interface AWSAPIGatewayResponseMapper : NSObject
+
+@property (nonatomic, readonly) AWSTask *task;
+
+- (instancetype)initWithResponseClass:(Class)responseClass;
+
+- (void)receiveResponse:(NSURLResponse *)response;
+- (void)receiveData:(NSData *)data;
+- (void)finishWithError:(NSError *)error;
+
+@end
+
+/**
+ The delegate of the shared session. It feeds each data task to its response mapper and recreates body streams
+ from the data or file they were made from when the session needs to resend a body.
+ */
+@interface AWSAPIGatewaySessionDelegate : NSObject <NSURLSessionDataDelegate>
+
+@property (nonatomic, strong) AWSSynchronizedMutableDictionary *responseMappers;
+
+@end
 
 @interface AWSAPIGatewayClient()
 
@@ -77,7 +110,10 @@ static int defaultChunkSize = 1024;
         static dispatch_once_t onceToken;
         dispatch_once(&onceToken, ^{
             NSURLSessionConfiguration *sessionConfiguration = [NSURLSessionConfiguration defaultSessionConfiguration];
-            session = [NSURLSession sessionWithConfiguration:sessionConfiguration];
+            AWSAPIGatewaySessionDelegate *sessionDelegate = [AWSAPIGatewaySessionDelegate new];
+            session = [NSURLSession sessionWithConfiguration:sessionConfiguration
+                                                    delegate:sessionDelegate
+                                               delegateQueue:nil];
         });
 
         _session = session;
@@ -101,87 +137,33 @@ static int defaultChunkSize = 1024;
         [request addValue:self.APIKey forHTTPHeaderField:AWSAPIGatewayAPIKeyHeader];
     }
     
-    AWSTask *task = [AWSTask taskWithResult:nil];
-    
-    task = [task continueWithSuccessBlock:^id(AWSTask *task) {
-        NSError *error = nil;
-        if (apiRequest.HTTPBody != nil) {
-            
-            if ([apiRequest.HTTPBody isKindOfClass:[NSString class]]) {
-                NSString *body = (NSString *)apiRequest.HTTPBody;
-                NSDictionary *bodyParameters = [NSJSONSerialization JSONObjectWithData:[body dataUsingEncoding:NSUTF8StringEncoding] options:0 error:nil];
-                request.HTTPBody = [NSJSONSerialization dataWithJSONObject:bodyParameters
-                                                                   options:0
-                                                                     error:&error];
-            } else if ([apiRequest.HTTPBody isKindOfClass:[NSDictionary class]]) {
-                request.HTTPBody = [NSJSONSerialization dataWithJSONObject:apiRequest.HTTPBody
-                                                                   options:0
-                                                                     error:&error];
-            } else if ([apiRequest.HTTPBody isKindOfClass:[NSInputStream class]]) {
-                
-                NSInputStream *iStream = (NSInputStream *)apiRequest.HTTPBody;
-                NSOutputStream *oStream = [[NSOutputStream alloc] initToMemory];
-                [iStream open];
-                [oStream open];
-                
-                int len = defaultChunkSize;
-                uint8_t buf[len];
-                
-                while (YES) {
-                    if ( [oStream hasSpaceAvailable] ) {
-                        NSInteger bytesRead = [iStream read:buf maxLength:len];
-                        
-                        if ([oStream write:(const uint8_t *)buf maxLength:bytesRead] == -1) {
-                            @throw [NSException exceptionWithName:NSInternalInconsistencyException
-                                                           reason:[NSString stringWithFormat:@"Error occurred while writing input stream to output stream."]
-                                                         userInfo:nil];
-                            break;
-                        }
-                        if (defaultChunkSize != bytesRead) {
-                            break;
-                        }
-                    }
-                }
-                
-                NSData *data = [oStream propertyForKey: NSStreamDataWrittenToMemoryStreamKey];
-                if (!data) {
-                    AWSDDLogVerbose(@"No data written to memory!");
-                } else {
-                    request.HTTPBody = data;
-                }
-                [oStream close];
-                oStream = nil;
-            } else {
-                request.HTTPBody = apiRequest.HTTPBody;
-            }
-            
-            if (!request.HTTPBody && ![apiRequest.HTTPBody isKindOfClass:[NSInputStream class]]) {
-                AWSDDLogError(@"Failed to set a request body. %@", error);
-            }
+    NSError *error = nil;
+    if (apiRequest.HTTPBody != nil) {
+        
+        if ([apiRequest.HTTPBody isKindOfClass:[NSString class]]) {
+            NSString *body = (NSString *)apiRequest.HTTPBody;
+            NSDictionary *bodyParameters = [NSJSONSerialization JSONObjectWithData:[body dataUsingEncoding:NSUTF8StringEncoding] options:0 error:nil];
+            request.HTTPBody = [NSJSONSerialization dataWithJSONObject:bodyParameters
+                                                               options:0
+                                                                 error:&error];
+        } else if ([apiRequest.HTTPBody isKindOfClass:[NSDictionary class]]) {
+            request.HTTPBody = [NSJSONSerialization dataWithJSONObject:apiRequest.HTTPBody
+                                                               options:0
+                                                                 error:&error];
+        } else if ([apiRequest.HTTPBody isKindOfClass:[NSInputStream class]]) {
+            // The stream is sent as it is read. The signer reads it into memory only if it has to hash it.
+            request.HTTPBodyStream = apiRequest.HTTPBody;
+        } else {
+            request.HTTPBody = apiRequest.HTTPBody;
         }
-        return nil;
-    }];
-    
-    // Refreshes credentials if necessary
-    task = [task continueWithSuccessBlock:^id(AWSTask *task) {
-        id signer = [self.configuration.requestInterceptors lastObject];
-        if (signer) {
-            if ([signer respondsToSelector:@selector(credentialsProvider)]) {
-                id<AWSCredentialsProvider> credentialsProvider = [signer performSelector:@selector(credentialsProvider)];
-                return [credentialsProvider credentials];
-            }
+        
+        if (!request.HTTPBody && !request.HTTPBodyStream) {
+            AWSDDLogError(@"Failed to set a request body. %@", error);
         }
-        return nil;
-    }];
-    
-    // Signs the request
-    for (id<AWSNetworkingRequestInterceptor> interceptor in self.configuration.requestInterceptors) {
-        task = [task continueWithSuccessBlock:^id(AWSTask *task) {
-            return [interceptor interceptRequest:request];
-        }];
     }
     
-    return  [task continueWithSuccessBlock:^id(AWSTask *task) {
+    // Signs the request
+    return [[self interceptRequest:request] continueWithSuccessBlock:^id(AWSTask *task) {
         AWSTaskCompletionSource *completionSource = [AWSTaskCompletionSource new];
         
         void (^completionHandler)(NSData *data, NSURLResponse *response, NSError *error) = ^(NSData *data, NSURLResponse *response, NSError *error) {
@@ -225,131 +207,109 @@ static int defaultChunkSize = 1024;
         [request addValue:self.APIKey forHTTPHeaderField:AWSAPIGatewayAPIKeyHeader];
     }
 
-    NSError *error = nil;
     if (body != nil) {
-        NSDictionary *bodyParameters = [[AWSMTLJSONAdapter JSONDictionaryFromModel:body] aws_removeNullValues];
-        request.HTTPBody = [NSJSONSerialization dataWithJSONObject:bodyParameters
-                                                           options:0
-                                                             error:&error];
-        if (!request.HTTPBody) {
+        NSError *error = nil;
+        if (![self setBody:body ofRequest:request error:&error]) {
             AWSDDLogError(@"Failed to serialize a request body. %@", error);
+            return [AWSTask taskWithError:error];
         }
     }
 
-    // Refreshes credentials if necessary
-    AWSTask *task = [AWSTask taskWithResult:nil];
-    task = [task continueWithSuccessBlock:^id(AWSTask *task) {
-        id signer = [self.configuration.requestInterceptors lastObject];
-        if (signer) {
-            if ([signer respondsToSelector:@selector(credentialsProvider)]) {
-                id<AWSCredentialsProvider> credentialsProvider = [signer performSelector:@selector(credentialsProvider)];
-                return [credentialsProvider credentials];
-            }
+    // Signs the request
+    return [[self interceptRequest:request] continueWithSuccessBlock:^id(AWSTask *task) {
+        AWSAPIGatewayResponseMapper *responseMapper = [[AWSAPIGatewayResponseMapper alloc] initWithResponseClass:responseClass];
+
+        NSURLSessionDataTask *sessionTask = nil;
+        if ([self.session.delegate isKindOfClass:[AWSAPIGatewaySessionDelegate class]]) {
+            sessionTask = [self.session dataTaskWithRequest:request];
+            [((AWSAPIGatewaySessionDelegate *)self.session.delegate).responseMappers setObject:responseMapper
+                                                                                        forKey:@(sessionTask.taskIdentifier)];
+        } else {
+            // A session set up by a subclass delivers the body all at once.
+            sessionTask = [self.session dataTaskWithRequest:request
+                                          completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
+                                              [responseMapper receiveResponse:response];
+                                              if (data) {
+                                                  [responseMapper receiveData:data];
+                                              }
+                                              [responseMapper finishWithError:error];
+                                          }];
         }
-        return nil;
+        [sessionTask resume];
+
+        return responseMapper.task;
     }];
+}
 
-    // Signs the request
-    for (id<AWSNetworkingRequestInterceptor> interceptor in self.configuration.requestInterceptors) {
-        task = [task continueWithSuccessBlock:^id(AWSTask *task) {
-            return [interceptor interceptRequest:request];
-        }];
+/**
+ Sets `body` as the body of `request`. Models are written straight to JSON data; it is not streamed because the
+ signer needs the hash of the payload before the request is sent. Input streams and file URLs are streamed.
+ */
+- (BOOL)setBody:(id)body ofRequest:(NSMutableURLRequest *)request error:(NSError **)error {
+    if ([body isKindOfClass:[NSInputStream class]]) {
+        request.HTTPBodyStream = body;
+        return YES;
     }
 
-    return [task continueWithSuccessBlock:^id(AWSTask *task) {
-        AWSTaskCompletionSource *completionSource = [AWSTaskCompletionSource new];
-
-        void (^completionHandler)(NSData *data, NSURLResponse *response, NSError *error) = ^(NSData *data, NSURLResponse *response, NSError *error) {
-            // Networking errors
-            if (error) {
-                [completionSource setError:error];
-                return;
-            }
-
-            // Serializes the HTTP body
-            id JSONObject = nil;
-            if (data && [data length] > 0) {
-                JSONObject = [NSJSONSerialization JSONObjectWithData:data
-                                                             options:NSJSONReadingAllowFragments
-                                                               error:&error];
-                if (!JSONObject) {
-                    NSString *bodyString = [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
-                    if ([bodyString length] > 0) {
-                        AWSDDLogError(@"The body is not in JSON format. Body: %@\nError: %@", bodyString, error);
-                    }
-                    [completionSource setError:error];
-                    return;
-                }
-            }
+    if ([body isKindOfClass:[NSURL class]]) {
+        if (![body checkResourceIsReachableAndReturnError:error]) {
+            return NO;
+        }
+        NSNumber *fileSize = nil;
+        [body getResourceValue:&fileSize forKey:NSURLFileSizeKey error:nil];
+        request.HTTPBodyStream = [NSInputStream inputStreamWithURL:body];
+        // Lets the signer hash the file without reading the stream, and the session reopen the file.
+        [NSURLProtocol setProperty:[body path] forKey:AWSSignatureV4PayloadSourceKey inRequest:request];
+        if (fileSize && ![request valueForHTTPHeaderField:@"Content-Length"]) {
+            [request setValue:[fileSize stringValue] forHTTPHeaderField:@"Content-Length"];
+        }
+        return YES;
+    }
 
-            // Handles developer defined errors
-            NSHTTPURLResponse *HTTPResponse = (NSHTTPURLResponse *)response;
+    if ([body isKindOfClass:[NSData class]]) {
+        request.HTTPBody = body;
+        return YES;
+    }
 
-            NSDictionary *HTTPHeaderFields = HTTPResponse.allHeaderFields;
-            NSInteger HTTPStatusCode = HTTPResponse.statusCode;
-            if (HTTPStatusCode/100 == 4 || HTTPStatusCode/100 == 5) {
-                NSMutableDictionary *userInfo = [NSMutableDictionary new];
-                if (JSONObject) {
-                    userInfo[AWSAPIGatewayErrorHTTPBodyKey] = JSONObject;
-                }
-                if (HTTPHeaderFields) {
-                    userInfo[AWSAPIGatewayErrorHTTPHeaderFieldsKey] = HTTPHeaderFields;
-                }
+    if ([body isKindOfClass:[NSDictionary class]] || [body isKindOfClass:[NSArray class]]) {
+        request.HTTPBody = [NSJSONSerialization dataWithJSONObject:body
+                                                           options:0
+                                                             error:error];
+        return request.HTTPBody != nil;
+    }
 
-                if (HTTPStatusCode/100 == 4) {
-                    NSError *clientError = [NSError errorWithDomain:AWSAPIGatewayErrorDomain
-                                                               code:AWSAPIGatewayErrorTypeClient
-                                                           userInfo:userInfo];
-                    [completionSource setError:clientError];
-                }
-                if (HTTPStatusCode/100 == 5) {
-                    NSError *clientError = [NSError errorWithDomain:AWSAPIGatewayErrorDomain
-                                                               code:AWSAPIGatewayErrorTypeService
-                                                           userInfo:userInfo];
-                    [completionSource setError:clientError];
-                }
-                return;
-            }
+    request.HTTPBody = [AWSMTLJSONAdapter JSONDataFromModel:body error:error];
+    return request.HTTPBody != nil;
+}
 
-            // Maps a serialized JSON object to an Objective-C object
-            if (JSONObject) {
-                if (responseClass
-                    && responseClass != [NSDictionary class]) {
-                    if ([JSONObject isKindOfClass:[NSDictionary class]]) {
-                        NSError *responseSerializationError = nil;
-                        JSONObject = [AWSMTLJSONAdapter modelOfClass:responseClass
-                                                  fromJSONDictionary:JSONObject
-                                                               error:&responseSerializationError];
-                        if (!JSONObject) {
-                            AWSDDLogError(@"Failed to serialize the body JSON. %@", responseSerializationError);
-                        }
-                    }
-                    if ([JSONObject isKindOfClass:[NSArray class]]) {
-                        NSError *responseSerializationError = nil;
-                        NSMutableArray *models = [NSMutableArray new];
-                        for (id object in JSONObject) {
-                            id model = [AWSMTLJSONAdapter modelOfClass:responseClass
-                                                    fromJSONDictionary:object
-                                                                 error:&responseSerializationError];
-                            [models addObject:model];
-                            if (!JSONObject) {
-                                AWSDDLogError(@"Failed to serialize the body JSON. %@", responseSerializationError);
-                            }
-                        }
-                        JSONObject = models;
-                    }
-                }
-                [completionSource setResult:JSONObject];
-            } else {
-                [completionSource setResult:nil];
-            }
-        };
-        NSURLSessionDataTask *sessionTask = [self.session dataTaskWithRequest:request
-                                                            completionHandler:completionHandler];
-        [sessionTask resume];
+/**
+ Runs the request interceptors one after another. Interceptors usually return tasks that are already completed,
+ e.g. once the credentials are cached, and those are run in place rather than chained.
+ */
+- (AWSTask *)interceptRequest:(NSMutableURLRequest *)request {
+    return [self interceptRequest:request
+                     interceptors:self.configuration.requestInterceptors
+                       startIndex:0];
+}
 
-        return completionSource.task;
-    }];
+- (AWSTask *)interceptRequest:(NSMutableURLRequest *)request
+                 interceptors:(NSArray<id<AWSNetworkingRequestInterceptor>> *)interceptors
+                   startIndex:(NSUInteger)startIndex {
+    for (NSUInteger i = startIndex; i < [interceptors count]; i++) {
+        AWSTask *task = [interceptors[i] interceptRequest:request];
+        if (task == nil || (task.completed && !task.faulted && !task.cancelled)) {
+            continue;
+        }
+        if (task.completed) {
+            return task;
+        }
+        return [task continueWithSuccessBlock:^id(AWSTask *task) {
+            return [self interceptRequest:request
+                             interceptors:interceptors
+                               startIndex:i + 1];
+        }];
+    }
+    return [AWSTask taskWithResult:nil];
 }
 
 - (NSURL *)requestURL:(NSString *)URLString query:(NSDictionary *)query URLPathComponentsDictionary:(NSDictionary * _Nullable)URLPathComponentsDictionary {
@@ -428,3 +388,326 @@ static int defaultChunkSize = 1024;
 }
 
 @end
+
+@implementation AWSAPIGatewayResponseMapper {
+    Class _responseClass;
+    AWSTaskCompletionSource *_completionSource;
+    NSHTTPURLResponse *_HTTPResponse;
+    AWSAPIGatewayResponseMapperState _state;
+    NSError *_error;
+
+    // While mapping an array, holds the element being received.
+    NSMutableData *_data;
+    NSUInteger _scanOffset;
+    NSUInteger _elementStart;
+    NSUInteger _elementCount;
+    NSUInteger _depth;
+    BOOL _inString;
+    BOOL _escaped;
+    NSMutableArray *_models;
+}
+
+- (instancetype)initWithResponseClass:(Class)responseClass {
+    if (self = [super init]) {
+        _responseClass = responseClass;
+        _completionSource = [AWSTaskCompletionSource new];
+        _data = [NSMutableData new];
+        _state = AWSAPIGatewayResponseMapperStateUndecided;
+    }
+    return self;
+}
+
+- (AWSTask *)task {
+    return _completionSource.task;
+}
+
+- (void)receiveResponse:(NSURLResponse *)response {
+    if (![response isKindOfClass:[NSHTTPURLResponse class]]) {
+        return;
+    }
+    _HTTPResponse = (NSHTTPURLResponse *)response;
+
+    // Only successful responses that are mapped to models are worth mapping while they arrive.
+    if (!_responseClass
+        || _responseClass == [NSDictionary class]
+        || _HTTPResponse.statusCode/100 == 4
+        || _HTTPResponse.statusCode/100 == 5) {
+        _state = AWSAPIGatewayResponseMapperStateBuffering;
+    }
+}
+
+- (void)receiveData:(NSData *)data {
+    if (_state == AWSAPIGatewayResponseMapperStateFailed) {
+        return;
+    }
+    [_data appendData:data];
+
+    if (_state == AWSAPIGatewayResponseMapperStateUndecided) {
+        const uint8_t *bytes = [_data bytes];
+        for (NSUInteger i = 0; i < [_data length]; i++) {
+            if (bytes[i] == ' ' || bytes[i] == '\t' || bytes[i] == '\r' || bytes[i] == '\n') {
+                continue;
+            }
+            if (bytes[i] == '[') {
+                _state = AWSAPIGatewayResponseMapperStateMappingArray;
+                _models = [NSMutableArray new];
+                _depth = 1;
+                _scanOffset = i + 1;
+                _elementStart = i + 1;
+            } else {
+                _state = AWSAPIGatewayResponseMapperStateBuffering;
+            }
+            break;
+        }
+    }
+
+    if (_state == AWSAPIGatewayResponseMapperStateMappingArray) {
+        [self scanArray];
+    }
+}
+
+/**
+ Finds the elements of the top level array that have been received in full and maps them. Only the nesting depth
+ and whether the scan is inside a string are tracked; each element is parsed by `NSJSONSerialization`.
+ */
+- (void)scanArray {
+    const uint8_t *bytes = [_data bytes];
+    NSUInteger length = [_data length];
+    for (NSUInteger i = _scanOffset; i < length; i++) {
+        uint8_t c = bytes[i];
+        if (_inString) {
+            if (_escaped) {
+                _escaped = NO;
+            } else if (c == '\\') {
+                _escaped = YES;
+            } else if (c == '"') {
+                _inString = NO;
+            }
+            continue;
+        }
+
+        if (c == '"') {
+            _inString = YES;
+        } else if (c == '[' || c == '{') {
+            _depth++;
+        } else if (c == ']' || c == '}') {
+            _depth--;
+            if (_depth == 0) {
+                if (c != ']' || ![self mapElementInRange:NSMakeRange(_elementStart, i - _elementStart) lastElement:YES]) {
+                    [self failWithMalformedArray];
+                    return;
+                }
+                _state = AWSAPIGatewayResponseMapperStateMappedArray;
+                _elementStart = i + 1;
+                break;
+            }
+        } else if (c == ',' && _depth == 1) {
+            if (![self mapElementInRange:NSMakeRange(_elementStart, i - _elementStart) lastElement:NO]) {
+                [self failWithMalformedArray];
+                return;
+            }
+            _elementStart = i + 1;
+        }
+    }
+
+    // Drops the elements that have been mapped.
+    [_data replaceBytesInRange:NSMakeRange(0, _elementStart) withBytes:NULL length:0];
+    _scanOffset = length - _elementStart;
+    _elementStart = 0;
+}
+
+- (BOOL)mapElementInRange:(NSRange)range lastElement:(BOOL)lastElement {
+    const uint8_t *bytes = [_data bytes];
+    BOOL isEmpty = YES;
+    for (NSUInteger i = range.location; i < NSMaxRange(range) && isEmpty; i++) {
+        isEmpty = bytes[i] == ' ' || bytes[i] == '\t' || bytes[i] == '\r' || bytes[i] == '\n';
+    }
+    if (isEmpty) {
+        // Only `[]` may have an empty element.
+        return lastElement && _elementCount == 0;
+    }
+    _elementCount++;
+
+    NSError *error = nil;
+    id JSONObject = [NSJSONSerialization JSONObjectWithData:[_data subdataWithRange:range]
+                                                    options:NSJSONReadingAllowFragments
+                                                      error:&error];
+    if (!JSONObject) {
+        _error = error;
+        return NO;
+    }
+
+    if (![JSONObject isKindOfClass:[NSDictionary class]]) {
+        AWSDDLogError(@"Failed to serialize the body JSON. The array element is not a JSON object: %@", JSONObject);
+        return YES;
+    }
+    id model = [AWSMTLJSONAdapter modelOfClass:_responseClass
+                            fromJSONDictionary:JSONObject
+                                         error:&error];
+    if (model) {
+        [_models addObject:model];
+    } else {
+        AWSDDLogError(@"Failed to serialize the body JSON. %@", error);
+    }
+    return YES;
+}
+
+- (void)failWithMalformedArray {
+    _state = AWSAPIGatewayResponseMapperStateFailed;
+    if (!_error) {
+        _error = [NSError errorWithDomain:NSCocoaErrorDomain
+                                     code:NSPropertyListReadCorruptError
+                                 userInfo:@{NSDebugDescriptionErrorKey : @"The body is not a well-formed JSON array."}];
+    }
+    _data = nil;
+}
+
+- (void)finishWithError:(NSError *)error {
+    // Networking errors
+    if (error) {
+        [_completionSource setError:error];
+        return;
+    }
+
+    switch (_state) {
+        case AWSAPIGatewayResponseMapperStateUndecided:
+        case AWSAPIGatewayResponseMapperStateBuffering:
+            [self finishBufferedResponse];
+            return;
+        case AWSAPIGatewayResponseMapperStateMappingArray:
+            [self failWithMalformedArray];
+            break;
+        case AWSAPIGatewayResponseMapperStateMappedArray: {
+            const uint8_t *bytes = [_data bytes];
+            for (NSUInteger i = 0; i < [_data length]; i++) {
+                if (bytes[i] != ' ' && bytes[i] != '\t' && bytes[i] != '\r' && bytes[i] != '\n') {
+                    [self failWithMalformedArray];
+                    break;
+                }
+            }
+            break;
+        }
+        case AWSAPIGatewayResponseMapperStateFailed:
+            break;
+    }
+
+    if (_state == AWSAPIGatewayResponseMapperStateFailed) {
+        AWSDDLogError(@"The body is not in JSON format. Error: %@", _error);
+        [_completionSource setError:_error];
+    } else {
+        [_completionSource setResult:[_models copy]];
+    }
+}
+
+- (void)finishBufferedResponse {
+    NSData *data = _data;
+    NSError *error = nil;
+
+    // Serializes the HTTP body
+    id JSONObject = nil;
+    if (data && [data length] > 0) {
+        JSONObject = [NSJSONSerialization JSONObjectWithData:data
+                                                     options:NSJSONReadingAllowFragments
+                                                       error:&error];
+        if (!JSONObject) {
+            NSString *bodyString = [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
+            if ([bodyString length] > 0) {
+                AWSDDLogError(@"The body is not in JSON format. Body: %@\nError: %@", bodyString, error);
+            }
+            [_completionSource setError:error];
+            return;
+        }
+    }
+
+    // Handles developer defined errors
+    NSDictionary *HTTPHeaderFields = _HTTPResponse.allHeaderFields;
+    NSInteger HTTPStatusCode = _HTTPResponse.statusCode;
+    if (HTTPStatusCode/100 == 4 || HTTPStatusCode/100 == 5) {
+        NSMutableDictionary *userInfo = [NSMutableDictionary new];
+        if (JSONObject) {
+            userInfo[AWSAPIGatewayErrorHTTPBodyKey] = JSONObject;
+        }
+        if (HTTPHeaderFields) {
+            userInfo[AWSAPIGatewayErrorHTTPHeaderFieldsKey] = HTTPHeaderFields;
+        }
+
+        if (HTTPStatusCode/100 == 4) {
+            NSError *clientError = [NSError errorWithDomain:AWSAPIGatewayErrorDomain
+                                                       code:AWSAPIGatewayErrorTypeClient
+                                                   userInfo:userInfo];
+            [_completionSource setError:clientError];
+        }
+        if (HTTPStatusCode/100 == 5) {
+            NSError *clientError = [NSError errorWithDomain:AWSAPIGatewayErrorDomain
+                                                       code:AWSAPIGatewayErrorTypeService
+                                                   userInfo:userInfo];
+            [_completionSource setError:clientError];
+        }
+        return;
+    }
+
+    // Maps a serialized JSON object to an Objective-C object
+    if (JSONObject) {
+        if (_responseClass
+            && _responseClass != [NSDictionary class]
+            && [JSONObject isKindOfClass:[NSDictionary class]]) {
+            NSError *responseSerializationError = nil;
+            JSONObject = [AWSMTLJSONAdapter modelOfClass:_responseClass
+                                      fromJSONDictionary:JSONObject
+                                                   error:&responseSerializationError];
+            if (!JSONObject) {
+                AWSDDLogError(@"Failed to serialize the body JSON. %@", responseSerializationError);
+            }
+        }
+        [_completionSource setResult:JSONObject];
+    } else {
+        [_completionSource setResult:nil];
+    }
+}
+
+@end
+
+@implementation AWSAPIGatewaySessionDelegate
+
+- (instancetype)init {
+    if (self = [super init]) {
+        _responseMappers = [AWSSynchronizedMutableDictionary new];
+    }
+    return self;
+}
+
+- (void)URLSession:(NSURLSession *)session
+              task:(NSURLSessionTask *)task
+ needNewBodyStream:(void (^)(NSInputStream *bodyStream))completionHandler {
+    id payloadSource = [NSURLProtocol propertyForKey:AWSSignatureV4PayloadSourceKey inRequest:task.originalRequest];
+    if ([payloadSource isKindOfClass:[NSData class]]) {
+        completionHandler([NSInputStream inputStreamWithData:payloadSource]);
+    } else if ([payloadSource isKindOfClass:[NSString class]]) {
+        completionHandler([NSInputStream inputStreamWithFileAtPath:payloadSource]);
+    } else {
+        // A stream passed in by the caller cannot be read again.
+        completionHandler(nil);
+    }
+}
+
+- (void)URLSession:(NSURLSession *)session
+          dataTask:(NSURLSessionDataTask *)dataTask
+didReceiveResponse:(NSURLResponse *)response
+ completionHandler:(void (^)(NSURLSessionResponseDisposition disposition))completionHandler {
+    AWSAPIGatewayResponseMapper *responseMapper = [self.responseMappers objectForKey:@(dataTask.taskIdentifier)];
+    [responseMapper receiveResponse:response];
+    completionHandler(NSURLSessionResponseAllow);
+}
+
+- (void)URLSession:(NSURLSession *)session dataTask:(NSURLSessionDataTask *)dataTask didReceiveData:(NSData *)data {
+    AWSAPIGatewayResponseMapper *responseMapper = [self.responseMappers objectForKey:@(dataTask.taskIdentifier)];
+    [responseMapper receiveData:data];
+}
+
+- (void)URLSession:(NSURLSession *)session task:(NSURLSessionTask *)task didCompleteWithError:(NSError *)error {
+    AWSAPIGatewayResponseMapper *responseMapper = [self.responseMappers objectForKey:@(task.taskIdentifier)];
+    [self.responseMappers removeObjectForKey:@(task.taskIdentifier)];
+    [responseMapper finishWithError:error];
+}
+
+@end
@@ -0,0 +1,392 @@
+//
+// Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+
+#import <XCTest/XCTest.h>
+#import "AWSAPIGateway.h"
+#import "AWSTestHTTPServer.h"
+
+static NSUInteger const AWSAPIGatewayClientStreamingTestsItemCount = 200;
+static NSUInteger const AWSAPIGatewayClientStreamingTestsPerformanceRequestCount = 20;
+
+@interface AWSAPIGatewayClient()
+
+@property (nonatomic, strong) NSURLSession *session;
+
+- (AWSTask *)invokeHTTPRequest:(NSString *)HTTPMethod
+                     URLString:(NSString *)URLString
+                pathParameters:(NSDictionary *)pathParameters
+               queryParameters:(NSDictionary *)queryParameters
+              headerParameters:(NSDictionary *)headerParameters
+                          body:(id)body
+                 responseClass:(Class)responseClass;
+
+@end
+
+@interface AWSAPIGatewayClientStreamingTestsOwner : AWSModel
+
+@property (nonatomic, strong) NSString *name;
+@property (nonatomic, strong) NSNumber *verified;
+
+@end
+
+@implementation AWSAPIGatewayClientStreamingTestsOwner
+
++ (NSDictionary *)JSONKeyPathsByPropertyKey {
+    return @{@"name" : @"name",
+             @"verified" : @"verified"};
+}
+
+@end
+
+@interface AWSAPIGatewayClientStreamingTestsItem : AWSModel
+
+@property (nonatomic, strong) NSString *identifier;
+@property (nonatomic, strong) NSString *note;
+@property (nonatomic, strong) NSNumber *price;
+@property (nonatomic, strong) NSNumber *quantity;
+@property (nonatomic, strong) NSArray<NSString *> *tags;
+@property (nonatomic, strong) AWSAPIGatewayClientStreamingTestsOwner *owner;
+
+@end
+
+@implementation AWSAPIGatewayClientStreamingTestsItem
+
++ (NSDictionary *)JSONKeyPathsByPropertyKey {
+    return @{@"identifier" : @"id",
+             @"note" : @"note",
+             @"price" : @"price",
+             @"quantity" : @"quantity",
+             @"tags" : @"tags",
+             @"owner" : @"owner"};
+}
+
++ (NSValueTransformer *)ownerJSONTransformer {
+    return [NSValueTransformer awsmtl_JSONDictionaryTransformerWithModelClass:[AWSAPIGatewayClientStreamingTestsOwner class]];
+}
+
+@end
+
+@interface AWSAPIGatewayClientStreamingTests : XCTestCase
+
+@property (nonatomic, strong) AWSTestHTTPServer *server;
+@property (nonatomic, strong) AWSAPIGatewayClient *client;
+@property (atomic, copy) NSString *responseStatus;
+@property (atomic, copy) NSData *responseBody;
+@property (atomic, assign) NSUInteger responseChunkSize;
+
+@end
+
+@implementation AWSAPIGatewayClientStreamingTests
+
+- (void)setUp {
+    [super setUp];
+    self.responseStatus = @"200 OK";
+    self.responseBody = [NSData new];
+    self.responseChunkSize = 0;
+
+    // Every request gets the canned JSON response, in pieces when a chunk size is set.
+    __weak AWSAPIGatewayClientStreamingTests *weakSelf = self;
+    self.server = [AWSTestHTTPServer new];
+    self.server.responseHandler = ^AWSTestHTTPResponse *(AWSTestHTTPRequest *request) {
+        AWSAPIGatewayClientStreamingTests *strongSelf = weakSelf;
+        AWSTestHTTPResponse *response = [AWSTestHTTPResponse responseWithStatus:strongSelf.responseStatus
+                                                                        headers:@{@"Content-Type" : @"application/json"}
+                                                                           body:strongSelf.responseBody];
+        response.chunkSize = strongSelf.responseChunkSize;
+        response.chunkDelay = strongSelf.responseChunkSize > 0 ? 0.002 : 0;
+        return response;
+    };
+    XCTAssertTrue([self.server start]);
+    self.client = [self clientWithSigning:YES];
+}
+
+- (void)tearDown {
+    [self.server stop];
+    [super tearDown];
+}
+
+- (AWSAPIGatewayClient *)clientWithSigning:(BOOL)signing {
+    AWSStaticCredentialsProvider *credentialsProvider = [[AWSStaticCredentialsProvider alloc] initWithAccessKey:@"accessKey"
+                                                                                                      secretKey:@"secretKey"];
+    AWSServiceConfiguration *configuration = [[AWSServiceConfiguration alloc] initWithRegion:AWSRegionUSEast1
+                                                                         credentialsProvider:credentialsProvider];
+    configuration.baseURL = self.server.URL;
+    if (signing) {
+        AWSEndpoint *endpoint = [[AWSEndpoint alloc] initWithRegion:AWSRegionUSEast1
+                                                            service:AWSServiceAPIGateway
+                                                                URL:self.server.URL];
+        AWSSignatureV4Signer *signer = [[AWSSignatureV4Signer alloc] initWithCredentialsProvider:credentialsProvider
+                                                                                       endpoint:endpoint];
+        configuration.requestInterceptors = @[[AWSNetworkingRequestInterceptor new], signer];
+    } else {
+        configuration.requestInterceptors = @[[AWSNetworkingRequestInterceptor new]];
+    }
+
+    AWSAPIGatewayClient *client = [AWSAPIGatewayClient new];
+    client.configuration = configuration;
+    return client;
+}
+
++ (AWSAPIGatewayClientStreamingTestsItem *)itemAtIndex:(NSUInteger)index {
+    AWSAPIGatewayClientStreamingTestsItem *item = [AWSAPIGatewayClientStreamingTestsItem new];
+    item.identifier = [NSString stringWithFormat:@"item-%lu", (unsigned long)index];
+    // Brackets, commas, quotes and escapes inside strings must not end an element.
+    item.note = index % 3 == 0 ? @"] }, {\"id\": \"fake\\\"\" [" : @"café \U0001F600\n";
+    item.price = @(index * 1.25);
+    item.quantity = @(index);
+    item.tags = @[@"a", @"b,c"];
+    item.owner = [AWSAPIGatewayClientStreamingTestsOwner new];
+    item.owner.name = index % 2 == 0 ? @"owner" : nil;
+    item.owner.verified = @(index % 2 == 0);
+    return item;
+}
+
++ (NSData *)JSONArrayOfItems:(NSUInteger)count {
+    NSMutableArray *JSONArray = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger i = 0; i < count; i++) {
+        [JSONArray addObject:[[AWSMTLJSONAdapter JSONDictionaryFromModel:[self itemAtIndex:i]] aws_removeNullValues]];
+    }
+    return [NSJSONSerialization dataWithJSONObject:JSONArray options:NSJSONWritingPrettyPrinted error:nil];
+}
+
+- (AWSTask *)invokeWithBody:(id)body responseClass:(Class)responseClass {
+    return [[self.client invokeHTTPRequest:@"POST"
+                                 URLString:@"/items/{itemId}"
+                            pathParameters:@{@"itemId" : @"item-1"}
+                           queryParameters:@{@"limit" : @10}
+                          headerParameters:@{@"Content-Type" : @"application/json",
+                                             @"Accept" : @"application/json"}
+                                      body:body
+                             responseClass:responseClass] waitUntilFinished];
+}
+
+#pragma mark - Request bodies
+
+- (void)testModelBodyIsSentAsJSON {
+    AWSAPIGatewayClientStreamingTestsItem *item = [AWSAPIGatewayClientStreamingTests itemAtIndex:4];
+    AWSTask *task = [self invokeWithBody:item responseClass:nil];
+    XCTAssertNil(task.error);
+
+    AWSTestHTTPRequest *request = [self.server.requestLog lastObject];
+    XCTAssertEqualObjects(request.method, @"POST");
+    XCTAssertEqualObjects(request.path, @"/items/item-1?limit=10");
+    XCTAssertTrue([request.headers[@"authorization"] hasPrefix:@"AWS4-HMAC-SHA256"]);
+
+    NSDictionary *expected = [[AWSMTLJSONAdapter JSONDictionaryFromModel:item] aws_removeNullValues];
+    XCTAssertEqualObjects([NSJSONSerialization JSONObjectWithData:request.body options:0 error:nil], expected);
+}
+
+- (void)testInputStreamBodyIsStreamed {
+    NSMutableData *data = [NSMutableData dataWithLength:256 * 1024];
+    arc4random_buf([data mutableBytes], [data length]);
+
+    // Unsigned, the stream is sent as it is read.
+    self.client = [self clientWithSigning:NO];
+    XCTAssertNil([self invokeWithBody:[NSInputStream inputStreamWithData:data] responseClass:nil].error);
+    XCTAssertEqualObjects([self.server.requestLog lastObject].body, data);
+
+    // Signed, the signer hashes it first.
+    self.client = [self clientWithSigning:YES];
+    XCTAssertNil([self invokeWithBody:[NSInputStream inputStreamWithData:data] responseClass:nil].error);
+    AWSTestHTTPRequest *request = [self.server.requestLog lastObject];
+    XCTAssertEqualObjects(request.body, data);
+    XCTAssertEqualObjects(request.headers[@"content-length"], [@([data length]) stringValue]);
+}
+
+- (void)testFileBodyIsStreamed {
+    NSMutableData *data = [NSMutableData dataWithLength:512 * 1024];
+    arc4random_buf([data mutableBytes], [data length]);
+    NSURL *fileURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]]];
+    XCTAssertTrue([data writeToURL:fileURL atomically:YES]);
+
+    XCTAssertNil([self invokeWithBody:fileURL responseClass:nil].error);
+    AWSTestHTTPRequest *request = [self.server.requestLog lastObject];
+    XCTAssertEqualObjects(request.body, data);
+    XCTAssertEqualObjects(request.headers[@"content-length"], [@([data length]) stringValue]);
+
+    [[NSFileManager defaultManager] removeItemAtURL:fileURL error:nil];
+    XCTAssertNotNil([self invokeWithBody:fileURL responseClass:nil].error);
+}
+
+- (void)testInvokeStreamsInputStreamBody {
+    NSData *data = [@"{\"key\":\"value\"}" dataUsingEncoding:NSUTF8StringEncoding];
+    AWSAPIGatewayRequest *request = [[AWSAPIGatewayRequest alloc] initWithHTTPMethod:@"PUT"
+                                                                           URLString:@"/raw"
+                                                                     queryParameters:nil
+                                                                    headerParameters:@{@"Content-Type" : @"application/octet-stream"}
+                                                                            HTTPBody:[NSInputStream inputStreamWithData:data]];
+    self.responseBody = [@"{}" dataUsingEncoding:NSUTF8StringEncoding];
+    AWSTask<AWSAPIGatewayResponse *> *task = [[self.client invoke:request] waitUntilFinished];
+    XCTAssertNil(task.error);
+    XCTAssertEqual(task.result.statusCode, 200);
+    XCTAssertEqualObjects([self.server.requestLog lastObject].body, data);
+}
+
+#pragma mark - Responses
+
+- (void)testArrayResponseIsMappedAsItArrives {
+    self.responseBody = [AWSAPIGatewayClientStreamingTests JSONArrayOfItems:AWSAPIGatewayClientStreamingTestsItemCount];
+    // An odd size splits tokens, strings and escape sequences.
+    self.responseChunkSize = 997;
+
+    AWSTask *task = [self invokeWithBody:nil responseClass:[AWSAPIGatewayClientStreamingTestsItem class]];
+    XCTAssertNil(task.error);
+    NSArray<AWSAPIGatewayClientStreamingTestsItem *> *items = task.result;
+    XCTAssertEqual([items count], AWSAPIGatewayClientStreamingTestsItemCount);
+    for (NSUInteger i = 0; i < [items count]; i++) {
+        XCTAssertEqualObjects(items[i], [AWSAPIGatewayClientStreamingTests itemAtIndex:i]);
+    }
+}
+
+- (void)testSmallChunksOfArrayResponse {
+    self.responseBody = [AWSAPIGatewayClientStreamingTests JSONArrayOfItems:3];
+    self.responseChunkSize = 5;
+
+    AWSTask *task = [self invokeWithBody:nil responseClass:[AWSAPIGatewayClientStreamingTestsItem class]];
+    XCTAssertNil(task.error);
+    XCTAssertEqualObjects(task.result, (@[[AWSAPIGatewayClientStreamingTests itemAtIndex:0],
+                                          [AWSAPIGatewayClientStreamingTests itemAtIndex:1],
+                                          [AWSAPIGatewayClientStreamingTests itemAtIndex:2]]));
+}
+
+- (void)testEmptyArrayResponse {
+    self.responseBody = [@" [ ] " dataUsingEncoding:NSUTF8StringEncoding];
+    AWSTask *task = [self invokeWithBody:nil responseClass:[AWSAPIGatewayClientStreamingTestsItem class]];
+    XCTAssertNil(task.error);
+    XCTAssertEqualObjects(task.result, @[]);
+}
+
+- (void)testArrayElementsThatAreNotObjectsAreSkipped {
+    self.responseBody = [@"[{\"id\":\"a\"}, 1, \"text\", null, {\"id\":\"b\"}]" dataUsingEncoding:NSUTF8StringEncoding];
+    AWSTask *task = [self invokeWithBody:nil responseClass:[AWSAPIGatewayClientStreamingTestsItem class]];
+    XCTAssertNil(task.error);
+    XCTAssertEqualObjects([task.result valueForKey:@"identifier"], (@[@"a", @"b"]));
+}
+
+- (void)testMalformedArrayResponseFails {
+    for (NSString *body in @[@"[{\"id\":\"a\"}, {\"id\":", @"[{\"id\":\"a\"},]", @"[{\"id\":\"a\"}} ", @"[{\"id\":\"a\"}] x"]) {
+        self.responseBody = [body dataUsingEncoding:NSUTF8StringEncoding];
+        AWSTask *task = [self invokeWithBody:nil responseClass:[AWSAPIGatewayClientStreamingTestsItem class]];
+        XCTAssertNotNil(task.error, @"%@", body);
+        XCTAssertNil(task.result);
+    }
+}
+
+- (void)testObjectResponse {
+    self.responseBody = [NSJSONSerialization dataWithJSONObject:[AWSMTLJSONAdapter JSONDictionaryFromModel:[AWSAPIGatewayClientStreamingTests itemAtIndex:1]]
+                                                               options:0
+                                                                 error:nil];
+    AWSTask *task = [self invokeWithBody:nil responseClass:[AWSAPIGatewayClientStreamingTestsItem class]];
+    XCTAssertNil(task.error);
+    XCTAssertEqualObjects(task.result, [AWSAPIGatewayClientStreamingTests itemAtIndex:1]);
+
+    task = [self invokeWithBody:nil responseClass:[NSDictionary class]];
+    XCTAssertEqualObjects(task.result[@"id"], @"item-1");
+}
+
+- (void)testErrorResponse {
+    self.responseStatus = @"404 Not Found";
+    self.responseBody = [@"[{\"message\":\"not found\"}]" dataUsingEncoding:NSUTF8StringEncoding];
+    AWSTask *task = [self invokeWithBody:nil responseClass:[AWSAPIGatewayClientStreamingTestsItem class]];
+    XCTAssertEqualObjects(task.error.domain, AWSAPIGatewayErrorDomain);
+    XCTAssertEqual(task.error.code, AWSAPIGatewayErrorTypeClient);
+    XCTAssertEqualObjects(task.error.userInfo[AWSAPIGatewayErrorHTTPBodyKey], (@[@{@"message" : @"not found"}]));
+
+    self.responseStatus = @"502 Bad Gateway";
+    self.responseBody = [@"{\"message\":\"bad gateway\"}" dataUsingEncoding:NSUTF8StringEncoding];
+    task = [self invokeWithBody:nil responseClass:[AWSAPIGatewayClientStreamingTestsItem class]];
+    XCTAssertEqual(task.error.code, AWSAPIGatewayErrorTypeService);
+    XCTAssertEqualObjects(task.error.userInfo[AWSAPIGatewayErrorHTTPBodyKey], @{@"message" : @"bad gateway"});
+}
+
+#pragma mark - Performance
+
+// The pipeline invokeHTTPRequest used before: the body goes through a JSON dictionary, the credentials and every
+// interceptor are separate chained tasks, and the response is buffered before it is parsed and mapped.
+- (AWSTask *)invokeWithBufferedPipelineWithBody:(id)body responseClass:(Class)responseClass {
+    NSURL *URL = [NSURL URLWithString:[NSString stringWithFormat:@"%@/items/item-1?limit=10", self.client.configuration.baseURL]];
+    NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:URL];
+    request.HTTPMethod = @"POST";
+    request.allHTTPHeaderFields = @{@"Content-Type" : @"application/json", @"Accept" : @"application/json"};
+    NSDictionary *bodyParameters = [[AWSMTLJSONAdapter JSONDictionaryFromModel:body] aws_removeNullValues];
+    request.HTTPBody = [NSJSONSerialization dataWithJSONObject:bodyParameters options:0 error:nil];
+
+    AWSTask *task = [AWSTask taskWithResult:nil];
+    task = [task continueWithSuccessBlock:^id(AWSTask *task) {
+        AWSSignatureV4Signer *signer = [self.client.configuration.requestInterceptors lastObject];
+        return [signer.credentialsProvider credentials];
+    }];
+    for (id<AWSNetworkingRequestInterceptor> interceptor in self.client.configuration.requestInterceptors) {
+        task = [task continueWithSuccessBlock:^id(AWSTask *task) {
+            return [interceptor interceptRequest:request];
+        }];
+    }
+
+    NSURLSession *session = [NSURLSession sharedSession];
+    return [task continueWithSuccessBlock:^id(AWSTask *task) {
+        AWSTaskCompletionSource *completionSource = [AWSTaskCompletionSource new];
+        [[session dataTaskWithRequest:request completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
+            if (error) {
+                [completionSource setError:error];
+                return;
+            }
+            NSArray *JSONObject = [NSJSONSerialization JSONObjectWithData:data options:NSJSONReadingAllowFragments error:nil];
+            NSMutableArray *models = [NSMutableArray new];
+            for (id object in JSONObject) {
+                [models addObject:[AWSMTLJSONAdapter modelOfClass:responseClass fromJSONDictionary:object error:nil]];
+            }
+            [completionSource setResult:models];
+        }] resume];
+        return completionSource.task;
+    }];
+}
+
+- (void)measureRoundTripsWithInvocation:(AWSTask *(^)(id body))invocation {
+    self.responseBody = [AWSAPIGatewayClientStreamingTests JSONArrayOfItems:AWSAPIGatewayClientStreamingTestsItemCount];
+    self.responseChunkSize = 16 * 1024;
+    AWSAPIGatewayClientStreamingTestsItem *item = [AWSAPIGatewayClientStreamingTests itemAtIndex:7];
+
+    [self measureBlock:^{
+        NSMutableArray<AWSTask *> *tasks = [NSMutableArray arrayWithCapacity:AWSAPIGatewayClientStreamingTestsPerformanceRequestCount];
+        for (NSUInteger i = 0; i < AWSAPIGatewayClientStreamingTestsPerformanceRequestCount; i++) {
+            [tasks addObject:invocation(item)];
+        }
+        [[AWSTask taskForCompletionOfAllTasks:tasks] waitUntilFinished];
+        for (AWSTask *task in tasks) {
+            XCTAssertEqual([task.result count], AWSAPIGatewayClientStreamingTestsItemCount);
+        }
+    }];
+}
+
+- (void)testPerformanceInvokeHTTPRequest {
+    [self measureRoundTripsWithInvocation:^AWSTask *(id body) {
+        return [self.client invokeHTTPRequest:@"POST"
+                                    URLString:@"/items/{itemId}"
+                               pathParameters:@{@"itemId" : @"item-1"}
+                              queryParameters:@{@"limit" : @10}
+                             headerParameters:@{@"Content-Type" : @"application/json",
+                                                @"Accept" : @"application/json"}
+                                         body:body
+                                responseClass:[AWSAPIGatewayClientStreamingTestsItem class]];
+    }];
+}
+
+- (void)testPerformanceInvokeHTTPRequestWithBufferedPipeline {
+    [self measureRoundTripsWithInvocation:^AWSTask *(id body) {
+        return [self invokeWithBufferedPipelineWithBody:body responseClass:[AWSAPIGatewayClientStreamingTestsItem class]];
+    }];
+}
+
+@end
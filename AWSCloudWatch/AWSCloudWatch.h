@@ -23,3 +23,4 @@ FOUNDATION_EXPORT const unsigned char AWSCloudWatchVersionString[];
 
 #import <AWSCore/AWSCore.h>
 #import "AWSCloudWatchService.h"
+#import "AWSCloudWatchMetricAggregator.h"
@@ -0,0 +1,154 @@
+//
+// Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+
+#import <Foundation/Foundation.h>
+#import "AWSCloudWatchModel.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class AWSCloudWatch;
+@class AWSTask;
+
+/**
+ The maximum number of metric datums in one `PutMetricData` request.
+ */
+FOUNDATION_EXPORT NSUInteger const AWSCloudWatchMetricAggregatorMaximumDatumsPerRequest;
+
+/**
+ The maximum size in bytes of the body of one `PutMetricData` request.
+ */
+FOUNDATION_EXPORT NSUInteger const AWSCloudWatchMetricAggregatorMaximumRequestBytes;
+
+/**
+ `AWSCloudWatchMetricAggregator` accumulates counters, gauges and timings on the device and sends them to Amazon CloudWatch as statistic sets, so that a metric recorded thousands of times a minute costs one datum per flush instead of one request per value.
+
+ Values are aggregated per metric name, unit and dimension set into a sample count, sum, minimum and maximum. Recording only takes the lock of one of several shards, so threads recording different metrics rarely wait on each other. Every `flushInterval` the aggregated values are sent with `putMetricData:`, in requests that stay within the limits of 20 datums and 40 KB. When the device is offline, the datums are kept in a small database on disk and sent with the next successful flush.
+
+ @discussion Memory is bounded by `maximumSeriesCount`: once that many distinct series are waiting for a flush, values for new series are dropped and counted in `droppedValueCount`. The database is bounded by `spillByteLimit`, and datums older than two weeks, which CloudWatch no longer accepts, are discarded.
+ */
+@interface AWSCloudWatchMetricAggregator : NSObject
+
+/**
+ The service client the datums are sent with.
+ */
+@property (nonatomic, strong, readonly) AWSCloudWatch *cloudWatch;
+
+/**
+ The CloudWatch namespace of every metric recorded with this aggregator.
+ */
+@property (nonatomic, strong, readonly) NSString *metricNamespace;
+
+/**
+ The interval in seconds between automatic flushes after `start`. The default is 60 seconds.
+ */
+@property (nonatomic, assign) NSTimeInterval flushInterval;
+
+/**
+ The maximum number of distinct series kept in memory between flushes. The default is 1000.
+ */
+@property (nonatomic, assign) NSUInteger maximumSeriesCount;
+
+/**
+ The maximum number of bytes kept on disk while the device is offline. When exceeded, the oldest datums are discarded. The default is 1MB.
+ */
+@property (nonatomic, assign) NSUInteger spillByteLimit;
+
+/**
+ The number of values dropped because `maximumSeriesCount` was reached or because they were not finite.
+ */
+@property (nonatomic, assign, readonly) NSUInteger droppedValueCount;
+
+/**
+ The number of bytes of datums currently kept on disk.
+ */
+@property (nonatomic, assign, readonly) NSUInteger spillBytesUsed;
+
+/**
+ Returns an aggregator that sends its datums with the given service client and keeps offline datums in a database named after the namespace.
+
+ @param cloudWatch      The service client.
+ @param metricNamespace The CloudWatch namespace of the metrics.
+ */
+- (instancetype)initWithCloudWatch:(AWSCloudWatch *)cloudWatch
+                   metricNamespace:(NSString *)metricNamespace;
+
+/**
+ Returns an aggregator that keeps offline datums in the database at the given path.
+
+ @param cloudWatch      The service client.
+ @param metricNamespace The CloudWatch namespace of the metrics.
+ @param spillPath       The path of the database for offline datums.
+ */
+- (instancetype)initWithCloudWatch:(AWSCloudWatch *)cloudWatch
+                   metricNamespace:(NSString *)metricNamespace
+                         spillPath:(NSString *)spillPath NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ Adds a value to a counter.
+
+ @param metricName The name of the metric.
+ @param value      The amount to add, usually 1.
+ @param dimensions The dimensions of the metric, or nil.
+ */
+- (void)incrementCounter:(NSString *)metricName
+                      by:(double)value
+              dimensions:(nullable NSDictionary<NSString *, NSString *> *)dimensions;
+
+/**
+ Records a duration in milliseconds.
+
+ @param metricName   The name of the metric.
+ @param milliseconds The duration.
+ @param dimensions   The dimensions of the metric, or nil.
+ */
+- (void)recordTiming:(NSString *)metricName
+        milliseconds:(double)milliseconds
+          dimensions:(nullable NSDictionary<NSString *, NSString *> *)dimensions;
+
+/**
+ Records a sample of a gauge or any other value.
+
+ @param value      The value.
+ @param metricName The name of the metric.
+ @param unit       The unit of the value.
+ @param dimensions The dimensions of the metric, or nil.
+ */
+- (void)recordValue:(double)value
+         metricName:(NSString *)metricName
+               unit:(AWSCloudWatchStandardUnit)unit
+         dimensions:(nullable NSDictionary<NSString *, NSString *> *)dimensions;
+
+/**
+ Starts flushing every `flushInterval` seconds.
+ */
+- (void)start;
+
+/**
+ Stops the automatic flushes. Values recorded afterwards are kept until the next `flush`.
+ */
+- (void)stop;
+
+/**
+ Sends the datums kept on disk and the values aggregated so far. Datums that cannot be sent because the device is offline are kept on disk; datums rejected by the service are discarded.
+
+ @return AWSTask - task.result is always nil. task.error is the last error returned by the service, if any.
+ */
+- (AWSTask *)flush;
+
+@end
+
+NS_ASSUME_NONNULL_END
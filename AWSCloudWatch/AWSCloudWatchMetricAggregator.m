@@ -0,0 +1,564 @@
+//
+// Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+
+#import "AWSCloudWatchMetricAggregator.h"
+#import <pthread.h>
+#import <stdatomic.h>
+#import "AWSCloudWatchService.h"
+#import <AWSCore/AWSCategory.h>
+#import <AWSCore/AWSCocoaLumberjack.h>
+#import <AWSCore/AWSFMDB.h>
+
+NSUInteger const AWSCloudWatchMetricAggregatorMaximumDatumsPerRequest = 20;
+NSUInteger const AWSCloudWatchMetricAggregatorMaximumRequestBytes = 40 * 1024;
+
+static NSTimeInterval const AWSCloudWatchMetricAggregatorFlushIntervalDefault = 60.0;
+static NSUInteger const AWSCloudWatchMetricAggregatorMaximumSeriesCountDefault = 1000;
+static NSUInteger const AWSCloudWatchMetricAggregatorSpillByteLimitDefault = 1024 * 1024; // 1MB
+// CloudWatch rejects datums with timestamps more than two weeks in the past.
+static NSTimeInterval const AWSCloudWatchMetricAggregatorDatumAgeLimit = 14 * 24 * 60 * 60;
+static NSString *const AWSCloudWatchMetricAggregatorDatabasePathPrefix = @"com/amazonaws/AWSCloudWatchMetricAggregator";
+
+static NSUInteger const AWSCloudWatchMetricAggregatorMinimumShardCount = 4;
+static NSUInteger const AWSCloudWatchMetricAggregatorMaximumShardCount = 64;
+
+#pragma mark - Request size estimates
+
+// "MetricData.member.20." and the separating "&".
+static NSUInteger const AWSCloudWatchMetricAggregatorMemberPrefixBytes = 22;
+// An upper bound on the encoded length of a number, a timestamp or a unit.
+static NSUInteger const AWSCloudWatchMetricAggregatorScalarValueBytes = 32;
+
+// The length of the string after form encoding, which leaves only unreserved ASCII characters as they are.
+static NSUInteger AWSCloudWatchMetricAggregatorEncodedLength(NSString *string) {
+    NSUInteger length = 0;
+    for (const unsigned char *c = (const unsigned char *)[string UTF8String]; c && *c; c++) {
+        BOOL unreserved = (*c >= 'a' && *c <= 'z') || (*c >= 'A' && *c <= 'Z') || (*c >= '0' && *c <= '9')
+        || *c == '-' || *c == '_' || *c == '.' || *c == '~';
+        length += unreserved ? 1 : 3;
+    }
+    return length;
+}
+
+// An upper bound on the bytes a datum adds to the body of a PutMetricData request.
+static NSUInteger AWSCloudWatchMetricAggregatorEstimatedDatumBytes(AWSCloudWatchMetricDatum *datum) {
+    NSUInteger bytes = AWSCloudWatchMetricAggregatorMemberPrefixBytes + [@"MetricName=" length] + AWSCloudWatchMetricAggregatorEncodedLength(datum.metricName);
+    for (NSString *field in @[@"Unit=", @"Timestamp=", @"Value=",
+                              @"StatisticValues.SampleCount=", @"StatisticValues.Sum=",
+                              @"StatisticValues.Minimum=", @"StatisticValues.Maximum="]) {
+        bytes += AWSCloudWatchMetricAggregatorMemberPrefixBytes + [field length] + AWSCloudWatchMetricAggregatorScalarValueBytes;
+    }
+    for (AWSCloudWatchDimension *dimension in datum.dimensions) {
+        bytes += 2 * (AWSCloudWatchMetricAggregatorMemberPrefixBytes + [@"Dimensions.member.10.Value=" length]);
+        bytes += AWSCloudWatchMetricAggregatorEncodedLength(dimension.name) + AWSCloudWatchMetricAggregatorEncodedLength(dimension.value);
+    }
+    return bytes;
+}
+
+#pragma mark - AWSCloudWatchMetricSeriesKey
+
+// Identifies a series by metric name, unit and dimensions, with the dimensions sorted by name.
+@interface AWSCloudWatchMetricSeriesKey : NSObject <NSCopying> {
+    @package
+    NSString *_metricName;
+    AWSCloudWatchStandardUnit _unit;
+    NSArray<NSString *> *_dimensionNames;
+    NSArray<NSString *> *_dimensionValues;
+    NSUInteger _hash;
+}
+
+@end
+
+@implementation AWSCloudWatchMetricSeriesKey
+
+- (instancetype)initWithMetricName:(NSString *)metricName
+                              unit:(AWSCloudWatchStandardUnit)unit
+                        dimensions:(NSDictionary<NSString *, NSString *> *)dimensions {
+    if (self = [super init]) {
+        _metricName = [metricName copy];
+        _unit = unit;
+        _hash = [_metricName hash] * 31 + (NSUInteger)unit;
+        if ([dimensions count] > 0) {
+            _dimensionNames = [dimensions count] == 1 ? [dimensions allKeys] : [[dimensions allKeys] sortedArrayUsingSelector:@selector(compare:)];
+            _dimensionValues = [dimensions objectsForKeys:_dimensionNames notFoundMarker:@""];
+            for (NSUInteger i = 0; i < [_dimensionNames count]; i++) {
+                _hash = _hash * 31 + [_dimensionNames[i] hash];
+                _hash = _hash * 31 + [_dimensionValues[i] hash];
+            }
+        }
+    }
+    return self;
+}
+
+- (NSUInteger)hash {
+    return _hash;
+}
+
+- (BOOL)isEqual:(id)object {
+    if (self == object) {
+        return YES;
+    }
+    if (![object isKindOfClass:[AWSCloudWatchMetricSeriesKey class]]) {
+        return NO;
+    }
+    AWSCloudWatchMetricSeriesKey *other = object;
+    return _hash == other->_hash
+    && _unit == other->_unit
+    && [_metricName isEqualToString:other->_metricName]
+    && (_dimensionNames == other->_dimensionNames || [_dimensionNames isEqualToArray:other->_dimensionNames])
+    && (_dimensionValues == other->_dimensionValues || [_dimensionValues isEqualToArray:other->_dimensionValues]);
+}
+
+- (id)copyWithZone:(NSZone *)zone {
+    return self;
+}
+
+@end
+
+#pragma mark - AWSCloudWatchMetricStatistics
+
+@interface AWSCloudWatchMetricStatistics : NSObject {
+    @package
+    NSUInteger _sampleCount;
+    double _sum;
+    double _minimum;
+    double _maximum;
+}
+
+@end
+
+@implementation AWSCloudWatchMetricStatistics
+
+@end
+
+#pragma mark - AWSCloudWatchMetricAggregatorShard
+
+// The series whose keys hash to this shard. The lock guards the dictionary and every statistics object in it.
+@interface AWSCloudWatchMetricAggregatorShard : NSObject {
+    @package
+    pthread_mutex_t _lock;
+    NSMutableDictionary<AWSCloudWatchMetricSeriesKey *, AWSCloudWatchMetricStatistics *> *_series;
+}
+
+@end
+
+@implementation AWSCloudWatchMetricAggregatorShard
+
+- (instancetype)init {
+    if (self = [super init]) {
+        pthread_mutex_init(&_lock, NULL);
+        _series = [NSMutableDictionary new];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    pthread_mutex_destroy(&_lock);
+}
+
+@end
+
+#pragma mark - AWSCloudWatchMetricAggregator
+
+@interface AWSCloudWatchMetricAggregator() {
+    NSArray<AWSCloudWatchMetricAggregatorShard *> *_shards;
+    NSUInteger _shardMask;
+    _Atomic(NSUInteger) _seriesCount;
+    _Atomic(NSUInteger) _droppedValueCount;
+}
+
+@property (nonatomic, strong) AWSCloudWatch *cloudWatch;
+@property (nonatomic, strong) NSString *metricNamespace;
+@property (nonatomic, strong) AWSFMDatabaseQueue *databaseQueue;
+@property (nonatomic, strong) dispatch_queue_t flushQueue;
+@property (nonatomic, strong) dispatch_source_t flushTimer;
+
+@end
+
+@implementation AWSCloudWatchMetricAggregator
+
+- (instancetype)initWithCloudWatch:(AWSCloudWatch *)cloudWatch
+                   metricNamespace:(NSString *)metricNamespace {
+    NSString *databaseDirectoryPath = [NSTemporaryDirectory() stringByAppendingPathComponent:AWSCloudWatchMetricAggregatorDatabasePathPrefix];
+    NSString *databaseName = [metricNamespace stringByReplacingOccurrencesOfString:@"/" withString:@"_"];
+    return [self initWithCloudWatch:cloudWatch
+                    metricNamespace:metricNamespace
+                          spillPath:[databaseDirectoryPath stringByAppendingPathComponent:databaseName]];
+}
+
+- (instancetype)initWithCloudWatch:(AWSCloudWatch *)cloudWatch
+                   metricNamespace:(NSString *)metricNamespace
+                         spillPath:(NSString *)spillPath {
+    if (self = [super init]) {
+        _cloudWatch = cloudWatch;
+        _metricNamespace = [metricNamespace copy];
+        _flushInterval = AWSCloudWatchMetricAggregatorFlushIntervalDefault;
+        _maximumSeriesCount = AWSCloudWatchMetricAggregatorMaximumSeriesCountDefault;
+        _spillByteLimit = AWSCloudWatchMetricAggregatorSpillByteLimitDefault;
+        _flushQueue = dispatch_queue_create("com.amazonaws.AWSCloudWatchMetricAggregator.flush", DISPATCH_QUEUE_SERIAL);
+
+        // A power of two, so a series' shard is a mask of its hash, with about two shards per core.
+        NSUInteger shardCount = AWSCloudWatchMetricAggregatorMinimumShardCount;
+        while (shardCount < 2 * [[NSProcessInfo processInfo] activeProcessorCount] && shardCount < AWSCloudWatchMetricAggregatorMaximumShardCount) {
+            shardCount <<= 1;
+        }
+        NSMutableArray *shards = [[NSMutableArray alloc] initWithCapacity:shardCount];
+        for (NSUInteger i = 0; i < shardCount; i++) {
+            [shards addObject:[AWSCloudWatchMetricAggregatorShard new]];
+        }
+        _shards = [shards copy];
+        _shardMask = shardCount - 1;
+
+        NSString *databaseDirectoryPath = [spillPath stringByDeletingLastPathComponent];
+        if (![[NSFileManager defaultManager] fileExistsAtPath:databaseDirectoryPath]) {
+            NSError *error = nil;
+            if (![[NSFileManager defaultManager] createDirectoryAtPath:databaseDirectoryPath
+                                           withIntermediateDirectories:YES
+                                                            attributes:nil
+                                                                 error:&error]) {
+                AWSDDLogError(@"Failed to create a directory for database. [%@]", error);
+            }
+        }
+
+        AWSDDLogDebug(@"Database path: [%@]", spillPath);
+        _databaseQueue = [AWSFMDatabaseQueue databaseQueueWithPath:spillPath];
+        [_databaseQueue inDatabase:^(AWSFMDatabase *db) {
+            if (![db executeUpdate:
+                  @"CREATE TABLE IF NOT EXISTS datum_batch ("
+                  @"id INTEGER PRIMARY KEY AUTOINCREMENT,"
+                  @"data BLOB NOT NULL,"
+                  @"timestamp REAL NOT NULL)"]) {
+                AWSDDLogError(@"SQLite error. [%@]", db.lastError);
+            }
+        }];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    if (_flushTimer) {
+        dispatch_source_cancel(_flushTimer);
+    }
+    [_databaseQueue close];
+}
+
+- (NSUInteger)droppedValueCount {
+    return atomic_load(&_droppedValueCount);
+}
+
+#pragma mark - Recording
+
+- (void)incrementCounter:(NSString *)metricName
+                      by:(double)value
+              dimensions:(NSDictionary<NSString *, NSString *> *)dimensions {
+    [self recordValue:value metricName:metricName unit:AWSCloudWatchStandardUnitCount dimensions:dimensions];
+}
+
+- (void)recordTiming:(NSString *)metricName
+        milliseconds:(double)milliseconds
+          dimensions:(NSDictionary<NSString *, NSString *> *)dimensions {
+    [self recordValue:milliseconds metricName:metricName unit:AWSCloudWatchStandardUnitMilliseconds dimensions:dimensions];
+}
+
+- (void)recordValue:(double)value
+         metricName:(NSString *)metricName
+               unit:(AWSCloudWatchStandardUnit)unit
+         dimensions:(NSDictionary<NSString *, NSString *> *)dimensions {
+    if (!isfinite(value) || [metricName length] == 0) {
+        atomic_fetch_add(&_droppedValueCount, 1);
+        return;
+    }
+
+    AWSCloudWatchMetricSeriesKey *key = [[AWSCloudWatchMetricSeriesKey alloc] initWithMetricName:metricName
+                                                                                           unit:unit
+                                                                                     dimensions:dimensions];
+    AWSCloudWatchMetricAggregatorShard *shard = _shards[key->_hash & _shardMask];
+
+    pthread_mutex_lock(&shard->_lock);
+    AWSCloudWatchMetricStatistics *statistics = [shard->_series objectForKey:key];
+    if (!statistics) {
+        if (atomic_fetch_add(&_seriesCount, 1) >= self.maximumSeriesCount) {
+            atomic_fetch_sub(&_seriesCount, 1);
+            pthread_mutex_unlock(&shard->_lock);
+            atomic_fetch_add(&_droppedValueCount, 1);
+            return;
+        }
+        statistics = [AWSCloudWatchMetricStatistics new];
+        statistics->_minimum = value;
+        statistics->_maximum = value;
+        [shard->_series setObject:statistics forKey:key];
+    }
+    statistics->_sampleCount++;
+    statistics->_sum += value;
+    statistics->_minimum = MIN(statistics->_minimum, value);
+    statistics->_maximum = MAX(statistics->_maximum, value);
+    pthread_mutex_unlock(&shard->_lock);
+}
+
+// Takes the aggregated series out of every shard, so values recorded from now on go to the next flush.
+- (NSArray<AWSCloudWatchMetricDatum *> *)collectDatums {
+    NSDate *timestamp = [NSDate date];
+    NSMutableArray<AWSCloudWatchMetricDatum *> *datums = [NSMutableArray new];
+    for (AWSCloudWatchMetricAggregatorShard *shard in _shards) {
+        pthread_mutex_lock(&shard->_lock);
+        NSDictionary<AWSCloudWatchMetricSeriesKey *, AWSCloudWatchMetricStatistics *> *series = shard->_series;
+        if ([series count] > 0) {
+            shard->_series = [NSMutableDictionary new];
+        }
+        pthread_mutex_unlock(&shard->_lock);
+
+        if ([series count] == 0) {
+            continue;
+        }
+        atomic_fetch_sub(&_seriesCount, [series count]);
+
+        [series enumerateKeysAndObjectsUsingBlock:^(AWSCloudWatchMetricSeriesKey *key, AWSCloudWatchMetricStatistics *statistics, BOOL *stop) {
+            AWSCloudWatchStatisticSet *statisticSet = [AWSCloudWatchStatisticSet new];
+            statisticSet.sampleCount = @(statistics->_sampleCount);
+            statisticSet.sum = @(statistics->_sum);
+            statisticSet.minimum = @(statistics->_minimum);
+            statisticSet.maximum = @(statistics->_maximum);
+
+            AWSCloudWatchMetricDatum *datum = [AWSCloudWatchMetricDatum new];
+            datum.metricName = key->_metricName;
+            datum.unit = key->_unit;
+            datum.timestamp = timestamp;
+            datum.statisticValues = statisticSet;
+            if (key->_dimensionNames) {
+                NSMutableArray<AWSCloudWatchDimension *> *dimensions = [NSMutableArray arrayWithCapacity:[key->_dimensionNames count]];
+                for (NSUInteger i = 0; i < [key->_dimensionNames count]; i++) {
+                    AWSCloudWatchDimension *dimension = [AWSCloudWatchDimension new];
+                    dimension.name = key->_dimensionNames[i];
+                    dimension.value = key->_dimensionValues[i];
+                    [dimensions addObject:dimension];
+                }
+                datum.dimensions = dimensions;
+            }
+            [datums addObject:datum];
+        }];
+    }
+    return datums;
+}
+
+// Splits the datums into requests within the datum count and body size limits.
+- (NSArray<NSArray<AWSCloudWatchMetricDatum *> *> *)batchesForDatums:(NSArray<AWSCloudWatchMetricDatum *> *)datums {
+    NSUInteger requestBytes = [@"Action=PutMetricData&Version=2010-08-01&Namespace=" length] + AWSCloudWatchMetricAggregatorEncodedLength(self.metricNamespace);
+    NSMutableArray<NSArray<AWSCloudWatchMetricDatum *> *> *batches = [NSMutableArray new];
+    NSMutableArray<AWSCloudWatchMetricDatum *> *batch = [NSMutableArray new];
+    NSUInteger batchBytes = requestBytes;
+    for (AWSCloudWatchMetricDatum *datum in datums) {
+        NSUInteger datumBytes = AWSCloudWatchMetricAggregatorEstimatedDatumBytes(datum);
+        if ([batch count] > 0
+            && ([batch count] == AWSCloudWatchMetricAggregatorMaximumDatumsPerRequest
+                || batchBytes + datumBytes > AWSCloudWatchMetricAggregatorMaximumRequestBytes)) {
+            [batches addObject:batch];
+            batch = [NSMutableArray new];
+            batchBytes = requestBytes;
+        }
+        [batch addObject:datum];
+        batchBytes += datumBytes;
+    }
+    if ([batch count] > 0) {
+        [batches addObject:batch];
+    }
+    return batches;
+}
+
+#pragma mark - Flushing
+
+- (void)start {
+    @synchronized(self) {
+        if (self.flushTimer) {
+            return;
+        }
+        uint64_t interval = (uint64_t)(self.flushInterval * NSEC_PER_SEC);
+        self.flushTimer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_BACKGROUND, 0));
+        dispatch_source_set_timer(self.flushTimer, dispatch_time(DISPATCH_TIME_NOW, (int64_t)interval), interval, interval / 10);
+        __weak AWSCloudWatchMetricAggregator *weakSelf = self;
+        dispatch_source_set_event_handler(self.flushTimer, ^{
+            [weakSelf flush];
+        });
+        dispatch_resume(self.flushTimer);
+    }
+}
+
+- (void)stop {
+    @synchronized(self) {
+        if (self.flushTimer) {
+            dispatch_source_cancel(self.flushTimer);
+            self.flushTimer = nil;
+        }
+    }
+}
+
+- (AWSTask *)flush {
+    NSArray<AWSCloudWatchMetricDatum *> *datums = [self collectDatums];
+    AWSTaskCompletionSource *completionSource = [AWSTaskCompletionSource taskCompletionSource];
+
+    // Flushes run one at a time, so datums taken from disk are never sent twice.
+    dispatch_async(self.flushQueue, ^{
+        NSError *lastError = nil;
+        BOOL offline = NO;
+
+        // Older datums first, so CloudWatch receives them while their timestamps are still accepted.
+        NSDictionary<NSNumber *, NSArray<AWSCloudWatchMetricDatum *> *> *spilledBatches = [self spilledBatches];
+        for (NSNumber *batchID in [[spilledBatches allKeys] sortedArrayUsingSelector:@selector(compare:)]) {
+            NSError *error = [self sendDatums:spilledBatches[batchID]];
+            if ([self isOfflineError:error]) {
+                offline = YES;
+                break;
+            }
+            if (error) {
+                lastError = error;
+            }
+            [self removeSpilledBatch:batchID];
+        }
+
+        for (NSArray<AWSCloudWatchMetricDatum *> *batch in [self batchesForDatums:datums]) {
+            if (!offline) {
+                NSError *error = [self sendDatums:batch];
+                if (![self isOfflineError:error]) {
+                    if (error) {
+                        lastError = error;
+                    }
+                    continue;
+                }
+                offline = YES;
+            }
+            [self spillBatch:batch];
+        }
+
+        if (lastError) {
+            [completionSource setError:lastError];
+        } else {
+            [completionSource setResult:nil];
+        }
+    });
+
+    return completionSource.task;
+}
+
+- (NSError *)sendDatums:(NSArray<AWSCloudWatchMetricDatum *> *)datums {
+    AWSCloudWatchPutMetricDataInput *putMetricDataInput = [AWSCloudWatchPutMetricDataInput new];
+    putMetricDataInput.namespace = self.metricNamespace;
+    putMetricDataInput.metricData = datums;
+
+    AWSTask *task = [self.cloudWatch putMetricData:putMetricDataInput];
+    [task waitUntilFinished];
+    if (task.error && ![self isOfflineError:task.error]) {
+        AWSDDLogError(@"Failed to send %lu metric datums. The datums are discarded. [%@]", (unsigned long)[datums count], task.error);
+    }
+    return task.error;
+}
+
+- (BOOL)isOfflineError:(NSError *)error {
+    return [error.domain isEqualToString:NSURLErrorDomain];
+}
+
+#pragma mark - Spilling
+
+- (NSUInteger)spillBytesUsed {
+    __block NSUInteger bytes = 0;
+    [self.databaseQueue inDatabase:^(AWSFMDatabase *db) {
+        bytes = (NSUInteger)[db longForQuery:@"SELECT IFNULL(SUM(LENGTH(data)), 0) FROM datum_batch"];
+    }];
+    return bytes;
+}
+
+- (void)spillBatch:(NSArray<AWSCloudWatchMetricDatum *> *)datums {
+    NSMutableArray *JSONObjects = [NSMutableArray arrayWithCapacity:[datums count]];
+    NSDate *timestamp = [NSDate date];
+    for (AWSCloudWatchMetricDatum *datum in datums) {
+        [JSONObjects addObject:[[AWSMTLJSONAdapter JSONDictionaryFromModel:datum] aws_removeNullValues]];
+        timestamp = [timestamp earlierDate:datum.timestamp];
+    }
+    NSError *error = nil;
+    NSData *data = [NSJSONSerialization dataWithJSONObject:JSONObjects options:0 error:&error];
+    if (!data) {
+        AWSDDLogError(@"Failed to serialize metric datums. [%@]", error);
+        return;
+    }
+
+    NSUInteger spillByteLimit = self.spillByteLimit;
+    [self.databaseQueue inDatabase:^(AWSFMDatabase *db) {
+        if (![db executeUpdate:@"INSERT INTO datum_batch (data, timestamp) VALUES (?, ?)", data, @([timestamp timeIntervalSince1970])]) {
+            AWSDDLogError(@"SQLite error. [%@]", db.lastError);
+            return;
+        }
+
+        if (![db executeUpdate:@"DELETE FROM datum_batch WHERE timestamp < ?", @([[NSDate date] timeIntervalSince1970] - AWSCloudWatchMetricAggregatorDatumAgeLimit)]) {
+            AWSDDLogError(@"SQLite error. [%@]", db.lastError);
+        }
+
+        // Discards the oldest batches until the rest fit within the limit.
+        long long bytes = [db longForQuery:@"SELECT IFNULL(SUM(LENGTH(data)), 0) FROM datum_batch"];
+        AWSFMResultSet *rs = [db executeQuery:@"SELECT id, LENGTH(data) FROM datum_batch ORDER BY id"];
+        NSMutableArray<NSNumber *> *discardedIDs = [NSMutableArray new];
+        while (bytes > (long long)spillByteLimit && [rs next]) {
+            [discardedIDs addObject:@([rs longLongIntForColumnIndex:0])];
+            bytes -= [rs longLongIntForColumnIndex:1];
+        }
+        [rs close];
+        for (NSNumber *batchID in discardedIDs) {
+            if (![db executeUpdate:@"DELETE FROM datum_batch WHERE id = ?", batchID]) {
+                AWSDDLogError(@"SQLite error. [%@]", db.lastError);
+            }
+        }
+        if ([discardedIDs count] > 0) {
+            AWSDDLogWarn(@"Discarded %lu batches of offline metric datums to stay within %lu bytes.", (unsigned long)[discardedIDs count], (unsigned long)spillByteLimit);
+        }
+    }];
+}
+
+- (NSDictionary<NSNumber *, NSArray<AWSCloudWatchMetricDatum *> *> *)spilledBatches {
+    NSMutableDictionary<NSNumber *, NSData *> *rows = [NSMutableDictionary new];
+    [self.databaseQueue inDatabase:^(AWSFMDatabase *db) {
+        AWSFMResultSet *rs = [db executeQuery:@"SELECT id, data FROM datum_batch WHERE timestamp >= ?", @([[NSDate date] timeIntervalSince1970] - AWSCloudWatchMetricAggregatorDatumAgeLimit)];
+        while ([rs next]) {
+            [rows setObject:[rs dataForColumnIndex:1] forKey:@([rs longLongIntForColumnIndex:0])];
+        }
+        [rs close];
+    }];
+
+    NSMutableDictionary<NSNumber *, NSArray<AWSCloudWatchMetricDatum *> *> *batches = [NSMutableDictionary new];
+    [rows enumerateKeysAndObjectsUsingBlock:^(NSNumber *batchID, NSData *data, BOOL *stop) {
+        NSMutableArray<AWSCloudWatchMetricDatum *> *datums = [NSMutableArray new];
+        NSArray *JSONObjects = [NSJSONSerialization JSONObjectWithData:data options:0 error:nil];
+        for (NSDictionary *JSONObject in JSONObjects) {
+            AWSCloudWatchMetricDatum *datum = [AWSMTLJSONAdapter modelOfClass:[AWSCloudWatchMetricDatum class]
+                                                           fromJSONDictionary:JSONObject
+                                                                        error:nil];
+            if (datum) {
+                [datums addObject:datum];
+            }
+        }
+        if ([datums count] > 0) {
+            [batches setObject:datums forKey:batchID];
+        } else {
+            [self removeSpilledBatch:batchID];
+        }
+    }];
+    return batches;
+}
+
+- (void)removeSpilledBatch:(NSNumber *)batchID {
+    [self.databaseQueue inDatabase:^(AWSFMDatabase *db) {
+        if (![db executeUpdate:@"DELETE FROM datum_batch WHERE id = ?", batchID]) {
+            AWSDDLogError(@"SQLite error. [%@]", db.lastError);
+        }
+    }];
+}
+
+@end
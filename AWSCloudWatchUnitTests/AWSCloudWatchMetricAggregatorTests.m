@@ -0,0 +1,261 @@
+//
+// Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+
+#import <XCTest/XCTest.h>
+#import "AWSTestUtility.h"
+#import "AWSTestStubEndpoint.h"
+#import "AWSCloudWatchService.h"
+#import "AWSCloudWatchMetricAggregator.h"
+
+static NSString *const AWSCloudWatchMetricAggregatorTestsKey = @"AWSCloudWatchMetricAggregatorTests";
+static NSString *const AWSCloudWatchMetricAggregatorTestsNamespace = @"AWSCloudWatchMetricAggregatorTests/App";
+
+// Keeps the parameters of each request and replies to PutMetricData.
+@interface AWSCloudWatchMetricAggregatorStubEndpoint : AWSTestStubEndpoint
+
+@property (atomic, assign) BOOL offline;
+@property (nonatomic, strong) NSMutableArray<NSDictionary *> *requestParameters;
+@property (nonatomic, strong) NSMutableArray<NSNumber *> *requestBodyLengths;
+
+@end
+
+@implementation AWSCloudWatchMetricAggregatorStubEndpoint
+
+- (instancetype)init {
+    if (self = [super init]) {
+        _requestParameters = [NSMutableArray new];
+        _requestBodyLengths = [NSMutableArray new];
+    }
+    return self;
+}
+
+- (NSArray<NSDictionary *> *)datums {
+    NSMutableArray<NSDictionary *> *datums = [NSMutableArray new];
+    @synchronized(self) {
+        for (NSDictionary *parameters in self.requestParameters) {
+            [datums addObjectsFromArray:parameters[@"MetricData"]];
+        }
+    }
+    return datums;
+}
+
+- (AWSTask<AWSTestHTTPResponse *> *)responseForRequest:(NSURLRequest *)request parameters:(NSDictionary *)parameters {
+    if (self.offline) {
+        return [AWSTask taskWithError:[NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorNotConnectedToInternet userInfo:nil]];
+    }
+
+    @synchronized(self) {
+        [self.requestParameters addObject:parameters];
+        [self.requestBodyLengths addObject:@([request.HTTPBody length])];
+    }
+
+    NSData *body = [@"<PutMetricDataResponse xmlns=\"http://monitoring.amazonaws.com/doc/2010-08-01/\"><ResponseMetadata><RequestId>stub</RequestId></ResponseMetadata></PutMetricDataResponse>" dataUsingEncoding:NSUTF8StringEncoding];
+    return [AWSTask taskWithResult:[AWSTestHTTPResponse responseWithStatus:@"200 OK"
+                                                                   headers:@{@"Content-Type" : @"text/xml"}
+                                                                      body:body]];
+}
+
+@end
+
+@interface AWSCloudWatchMetricAggregatorTests : XCTestCase
+
+@property (nonatomic, strong) AWSCloudWatchMetricAggregatorStubEndpoint *endpoint;
+@property (nonatomic, strong) NSString *spillPath;
+
+@end
+
+@implementation AWSCloudWatchMetricAggregatorTests
+
+- (void)setUp {
+    [super setUp];
+    [AWSTestUtility setupFakeCognitoCredentialsProvider];
+
+    AWSServiceConfiguration *configuration = [[AWSServiceConfiguration alloc] initWithRegion:AWSRegionUSEast1
+                                                                         credentialsProvider:[AWSServiceManager defaultServiceManager].defaultServiceConfiguration.credentialsProvider];
+    [AWSCloudWatch registerCloudWatchWithConfiguration:configuration forKey:AWSCloudWatchMetricAggregatorTestsKey];
+    self.endpoint = [AWSCloudWatchMetricAggregatorStubEndpoint new];
+    [self.endpoint attachToServiceClient:[AWSCloudWatch CloudWatchForKey:AWSCloudWatchMetricAggregatorTestsKey]];
+
+    self.spillPath = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSString stringWithFormat:@"%@-%@", AWSCloudWatchMetricAggregatorTestsKey, [[NSUUID UUID] UUIDString]]];
+}
+
+- (void)tearDown {
+    [AWSCloudWatch removeCloudWatchForKey:AWSCloudWatchMetricAggregatorTestsKey];
+    [[NSFileManager defaultManager] removeItemAtPath:self.spillPath error:nil];
+    [super tearDown];
+}
+
+- (AWSCloudWatchMetricAggregator *)aggregator {
+    return [[AWSCloudWatchMetricAggregator alloc] initWithCloudWatch:[AWSCloudWatch CloudWatchForKey:AWSCloudWatchMetricAggregatorTestsKey]
+                                                     metricNamespace:AWSCloudWatchMetricAggregatorTestsNamespace
+                                                           spillPath:self.spillPath];
+}
+
+- (void)testValuesAreAggregatedPerSeries {
+    AWSCloudWatchMetricAggregator *aggregator = [self aggregator];
+    for (NSUInteger i = 1; i <= 100; i++) {
+        [aggregator recordTiming:@"Latency" milliseconds:i dimensions:@{@"Operation" : @"Get", @"Stage" : @"prod"}];
+    }
+    // The same dimensions in another order belong to the same series.
+    [aggregator recordTiming:@"Latency" milliseconds:1000 dimensions:@{@"Stage" : @"prod", @"Operation" : @"Get"}];
+    [aggregator incrementCounter:@"Requests" by:1 dimensions:nil];
+    [aggregator incrementCounter:@"Requests" by:2 dimensions:nil];
+    [aggregator recordValue:NAN metricName:@"Memory" unit:AWSCloudWatchStandardUnitBytes dimensions:nil];
+
+    XCTAssertNil([[aggregator flush] waitUntilFinished].error);
+
+    XCTAssertEqual([self.endpoint.requestParameters count], 1);
+    XCTAssertEqualObjects(self.endpoint.requestParameters[0][@"Namespace"], AWSCloudWatchMetricAggregatorTestsNamespace);
+    NSMutableDictionary<NSString *, NSDictionary *> *datums = [NSMutableDictionary new];
+    for (NSDictionary *datum in [self.endpoint datums]) {
+        datums[datum[@"MetricName"]] = datum;
+    }
+    XCTAssertEqual([datums count], 2);
+
+    NSDictionary *latency = datums[@"Latency"];
+    XCTAssertEqualObjects(latency[@"Unit"], @"Milliseconds");
+    XCTAssertEqualObjects(latency[@"StatisticValues"][@"SampleCount"], @101);
+    XCTAssertEqualObjects(latency[@"StatisticValues"][@"Sum"], @6050);
+    XCTAssertEqualObjects(latency[@"StatisticValues"][@"Minimum"], @1);
+    XCTAssertEqualObjects(latency[@"StatisticValues"][@"Maximum"], @1000);
+    NSArray *expectedDimensions = @[@{@"Name" : @"Operation", @"Value" : @"Get"}, @{@"Name" : @"Stage", @"Value" : @"prod"}];
+    XCTAssertEqualObjects(latency[@"Dimensions"], expectedDimensions);
+    XCTAssertNotNil(latency[@"Timestamp"]);
+
+    NSDictionary *requests = datums[@"Requests"];
+    XCTAssertEqualObjects(requests[@"Unit"], @"Count");
+    XCTAssertEqualObjects(requests[@"StatisticValues"][@"SampleCount"], @2);
+    XCTAssertEqualObjects(requests[@"StatisticValues"][@"Sum"], @3);
+    XCTAssertNil(requests[@"Dimensions"]);
+
+    XCTAssertEqual(aggregator.droppedValueCount, 1);
+
+    // Nothing was recorded since, so the next flush sends nothing.
+    XCTAssertNil([[aggregator flush] waitUntilFinished].error);
+    XCTAssertEqual([self.endpoint.requestParameters count], 1);
+}
+
+- (void)testRequestsStayWithinLimits {
+    AWSCloudWatchMetricAggregator *aggregator = [self aggregator];
+    NSString *longValue = [@"" stringByPaddingToLength:250 withString:@"é/" startingAtIndex:0];
+    for (NSUInteger i = 0; i < 200; i++) {
+        NSMutableDictionary *dimensions = [NSMutableDictionary new];
+        for (NSUInteger d = 0; d < 10; d++) {
+            dimensions[[NSString stringWithFormat:@"Dimension%lu", (unsigned long)d]] = [NSString stringWithFormat:@"%lu%@", (unsigned long)i, longValue];
+        }
+        [aggregator recordValue:i metricName:@"Wide" unit:AWSCloudWatchStandardUnitNone dimensions:dimensions];
+        [aggregator incrementCounter:[NSString stringWithFormat:@"Narrow%lu", (unsigned long)i] by:1 dimensions:nil];
+    }
+
+    XCTAssertNil([[aggregator flush] waitUntilFinished].error);
+
+    XCTAssertEqual([[self.endpoint datums] count], 400);
+    XCTAssertGreaterThan([self.endpoint.requestParameters count], 20);
+    for (NSDictionary *parameters in self.endpoint.requestParameters) {
+        XCTAssertLessThanOrEqual([parameters[@"MetricData"] count], AWSCloudWatchMetricAggregatorMaximumDatumsPerRequest);
+    }
+    for (NSNumber *length in self.endpoint.requestBodyLengths) {
+        XCTAssertLessThanOrEqual([length unsignedIntegerValue], AWSCloudWatchMetricAggregatorMaximumRequestBytes);
+    }
+}
+
+- (void)testSeriesCountIsBounded {
+    AWSCloudWatchMetricAggregator *aggregator = [self aggregator];
+    aggregator.maximumSeriesCount = 10;
+    for (NSUInteger i = 0; i < 20; i++) {
+        [aggregator incrementCounter:[NSString stringWithFormat:@"Counter%lu", (unsigned long)i] by:1 dimensions:nil];
+    }
+    // Existing series keep aggregating after the bound is reached.
+    for (NSUInteger i = 0; i < 20; i++) {
+        [aggregator incrementCounter:[NSString stringWithFormat:@"Counter%lu", (unsigned long)i] by:1 dimensions:nil];
+    }
+    XCTAssertEqual(aggregator.droppedValueCount, 20);
+
+    XCTAssertNil([[aggregator flush] waitUntilFinished].error);
+    NSUInteger recorded = 0;
+    for (NSDictionary *datum in [self.endpoint datums]) {
+        recorded += [datum[@"StatisticValues"][@"SampleCount"] unsignedIntegerValue];
+    }
+    XCTAssertEqual([[self.endpoint datums] count], 10);
+    XCTAssertEqual(recorded, 20);
+
+    // A flush frees the series for new metrics.
+    [aggregator incrementCounter:@"Counter19" by:1 dimensions:nil];
+    XCTAssertEqual(aggregator.droppedValueCount, 20);
+}
+
+- (void)testOfflineDatumsAreSpilledAndSentLater {
+    AWSCloudWatchMetricAggregator *aggregator = [self aggregator];
+    self.endpoint.offline = YES;
+    for (NSUInteger i = 0; i < 30; i++) {
+        [aggregator incrementCounter:[NSString stringWithFormat:@"Offline%lu", (unsigned long)i] by:1 dimensions:@{@"Screen" : @"Main"}];
+    }
+    XCTAssertNil([[aggregator flush] waitUntilFinished].error);
+    XCTAssertEqual([self.endpoint.requestParameters count], 0);
+    XCTAssertGreaterThan(aggregator.spillBytesUsed, 0);
+
+    // Still offline: the spilled datums stay on disk.
+    XCTAssertNil([[aggregator flush] waitUntilFinished].error);
+    XCTAssertGreaterThan(aggregator.spillBytesUsed, 0);
+
+    // A new aggregator, as after a relaunch, sends the spilled datums before its own.
+    self.endpoint.offline = NO;
+    AWSCloudWatchMetricAggregator *relaunchedAggregator = [self aggregator];
+    [relaunchedAggregator incrementCounter:@"Online" by:1 dimensions:nil];
+    XCTAssertNil([[relaunchedAggregator flush] waitUntilFinished].error);
+
+    NSArray<NSDictionary *> *datums = [self.endpoint datums];
+    XCTAssertEqual([datums count], 31);
+    XCTAssertEqualObjects([datums lastObject][@"MetricName"], @"Online");
+    XCTAssertEqualObjects(datums[0][@"Dimensions"], (@[@{@"Name" : @"Screen", @"Value" : @"Main"}]));
+    XCTAssertEqualObjects(datums[0][@"StatisticValues"][@"SampleCount"], @1);
+    XCTAssertEqual(relaunchedAggregator.spillBytesUsed, 0);
+}
+
+- (void)testSpillIsBounded {
+    AWSCloudWatchMetricAggregator *aggregator = [self aggregator];
+    aggregator.spillByteLimit = 8 * 1024;
+    self.endpoint.offline = YES;
+    for (NSUInteger flush = 0; flush < 10; flush++) {
+        for (NSUInteger i = 0; i < 20; i++) {
+            [aggregator incrementCounter:[NSString stringWithFormat:@"Counter%lu", (unsigned long)i] by:1 dimensions:nil];
+        }
+        XCTAssertNil([[aggregator flush] waitUntilFinished].error);
+    }
+
+    XCTAssertGreaterThan(aggregator.spillBytesUsed, 0);
+    XCTAssertLessThanOrEqual(aggregator.spillBytesUsed, 8 * 1024);
+}
+
+#pragma mark - Performance
+
+- (void)testPerformanceRecordUnderContention {
+    AWSCloudWatchMetricAggregator *aggregator = [self aggregator];
+    NSArray<NSString *> *metricNames = @[@"Latency", @"Requests", @"Errors", @"Bytes", @"Frames", @"Retries", @"Hits", @"Misses"];
+
+    [self measureBlock:^{
+        dispatch_apply(8, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t thread) {
+            for (NSUInteger i = 0; i < 20000; i++) {
+                [aggregator recordTiming:metricNames[(thread + i) % [metricNames count]]
+                            milliseconds:i % 250
+                              dimensions:@{@"Operation" : metricNames[i % 4]}];
+            }
+        });
+    }];
+
+    XCTAssertEqual(aggregator.droppedValueCount, 0);
+}
+
+@end
@@ -285,14 +285,7 @@
 #pragma mark - Size operations
 
 - (long) size {
-    NSArray * allRecords = [self getAllRecords];
-    long size = 0;
-    if(allRecords != nil){
-        for (AWSCognitoRecord *record in allRecords) {
-            size += [self sizeForRecord:record];
-        }
-    }
-    return size;
+    return [[self.sqliteManager datasetSize:self.name] longValue];
 }
 
 - (long) sizeForKey: (NSString *) aKey {
@@ -304,16 +297,7 @@
         return 0;
     }
     
-    //get the size of the key
-    long sizeOfKey = [self sizeForString:aRecord.recordId];
-    
-    //if it has been deleted, just return the size of the key
-    if ([aRecord isDeleted]) {
-        return sizeOfKey;
-    }
-    
-    //return size of key + size of value
-    return sizeOfKey + [self sizeForString:aRecord.data.string];
+    return [aRecord size];
 }
 
 - (long) sizeForString:(NSString *) aString{
@@ -405,12 +389,22 @@
             if(response.records){
                 // get the dataset sync count for updating the last sync count
                 self.lastSyncCount = response.datasetSyncCount;
+                
+                // look up the local state of all changed records at once
+                NSMutableArray *recordIds = [NSMutableArray arrayWithCapacity:response.records.count];
+                for(AWSCognitoSyncRecord *record in response.records){
+                    if (record.key) {
+                        [recordIds addObject:record.key];
+                    }
+                }
+                NSDictionary *localRecords = [self.sqliteManager getRecordsByIds:recordIds datasetName:self.name error:&error];
+                
                 for(AWSCognitoSyncRecord *record in response.records){
                     [existingRecords addObject:record.key];
                     [changedRecordNames addObject:record.key];
                     
                     //overlay local with remote if local isn't dirty
-                    AWSCognitoRecord * existing = [self.sqliteManager getRecordById:record.key datasetName:self.name error:&error];
+                    AWSCognitoRecord * existing = [localRecords objectForKey:record.key];
                     
                     AWSCognitoRecordValueType recordType = AWSCognitoRecordValueTypeString;
                     if (record.value == nil) {
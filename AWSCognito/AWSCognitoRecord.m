@@ -173,6 +173,14 @@
     return self.data.type == AWSCognitoRecordValueTypeDeleted;
 }
 
+- (long)size {
+    long size = [self.recordId lengthOfBytesUsingEncoding:NSUTF8StringEncoding];
+    if (![self isDeleted]) {
+        size += [self.data.string lengthOfBytesUsingEncoding:NSUTF8StringEncoding];
+    }
+    return size;
+}
+
 - (NSString *)description
 {
     NSMutableString *buffer = [NSMutableString new];
@@ -15,6 +15,7 @@
 
 #import "AWSCognitoSyncResources.h"
 #import <AWSCore/AWSCocoaLumberjack.h>
+#import <AWSCore/AWSServiceDefinition.h>
 
 @interface AWSCognitoSyncResources ()
 
@@ -43,9 +44,8 @@
     if (self = [super init]) {
         //init method
         NSError *error = nil;
-        _definitionDictionary = [NSJSONSerialization JSONObjectWithData:[[self definitionString] dataUsingEncoding:NSUTF8StringEncoding]
-                                                                options:kNilOptions
-                                                                  error:&error];
+        _definitionDictionary = [AWSServiceDefinition definitionWithJSONString:[self definitionString]
+                                                                         error:&error];
         if (_definitionDictionary == nil) {
             if (error) {
                 AWSDDLogError(@"Failed to parse JSON service definition: %@",error);
@@ -35,6 +35,9 @@ FOUNDATION_EXPORT NSString *const AWSCognitoSyncCountFieldName;
 FOUNDATION_EXPORT NSString *const AWSCognitoDefaultSqliteMetadataTableName;
 FOUNDATION_EXPORT NSString *const AWSCognitoDatasetFieldName;
 FOUNDATION_EXPORT NSString *const AWSCognitoLastSyncCount;
+FOUNDATION_EXPORT NSString *const AWSCognitoRecordSizeFieldName;
+FOUNDATION_EXPORT NSString *const AWSCognitoDefaultSqliteSizeTableName;
+FOUNDATION_EXPORT NSString *const AWSCognitoDirtyRecordsIndexName;
 
 FOUNDATION_EXPORT NSString* const AWSCognitoDeletedRecord;
 FOUNDATION_EXPORT int64_t const AWSCognitoNotSyncedDeletedRecordDirty;
@@ -35,6 +35,9 @@ NSString *const AWSCognitoDatasetFieldName = @"Dataset";
 NSString *const AWSCognitoSyncCountFieldName = @"SyncCount";
 NSString *const AWSCognitoDefaultSqliteMetadataTableName = @"CognitoMetadata";
 NSString *const AWSCognitoLastSyncCount = @"LastSyncCount";
+NSString *const AWSCognitoRecordSizeFieldName = @"Size";
+NSString *const AWSCognitoDefaultSqliteSizeTableName = @"CognitoDatasetSize";
+NSString *const AWSCognitoDirtyRecordsIndexName = @"CognitoDirtyRecords";
 int64_t const AWSCognitoNotSyncedDeletedRecordDirty = -1;
 NSString* const AWSCognitoDeletedRecord = @"\0";
 NSString *const AWSCognitoUserDefaultsUserAgentPrefix = @"CognitoV1.0";
@@ -40,6 +40,12 @@
  */
 - (AWSCognitoRecord *)copyForFlush;
 
+/**
+ * The number of bytes the record counts toward the dataset size limit: the UTF-8 length of the key, plus the UTF-8
+ * length of the value unless the record is deleted.
+ */
+- (long)size;
+
 @end
 
 @interface AWSCognitoRecordValue()
@@ -22,7 +22,8 @@
 
 @interface AWSCognitoSQLiteManager : NSObject
 
-@property (nonatomic, strong) NSString *identityId;
+// Atomic because reads run on the read queue while the identity changes on the write queue.
+@property (atomic, strong) NSString *identityId;
 @property (nonatomic, strong) NSString *deviceId;
 
 
@@ -36,6 +37,7 @@
 - (BOOL)putDatasetMetadata:(NSArray *)datasets error:(NSError **)error;
 - (BOOL)updateDatasetMetadata:(AWSCognitoDatasetMetadata *)dataset error:(NSError **)error;
 - (AWSCognitoRecord *)getRecordById:(NSString *)recordId datasetName:(NSString *)datasetName error:(NSError **)error;
+- (NSDictionary<NSString *, AWSCognitoRecord *> *)getRecordsByIds:(NSArray<NSString *> *)recordIds datasetName:(NSString *)datasetName error:(NSError **)error;
 - (BOOL)putRecord:(AWSCognitoRecord *)record datasetName:(NSString *)datasetName  error:(NSError **)error;
 - (BOOL)flagRecordAsDeletedById:(NSString *)recordId datasetName:(NSString *)datasetName  error:(NSError **)error;
 - (BOOL)deleteRecordById:(NSString *)recordId datasetName:(NSString *)datasetName error:(NSError **)error;
@@ -46,6 +48,7 @@
 - (BOOL)resetSyncCount:(NSString *)datasetName error:(NSError **)error;
 
 - (NSNumber *) numRecords:(NSString *)datasetName;
+- (NSNumber *)datasetSize:(NSString *)datasetName;
 
 - (NSArray<NSString *> *)getMergeDatasets:(NSString *)datasetName error:(NSError **)error;
 - (BOOL)reparentDatasets:(NSString *)oldId withNewId:(NSString *)newId error:(NSError **)error;
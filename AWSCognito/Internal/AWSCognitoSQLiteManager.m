@@ -28,17 +28,35 @@
 #import "AWSCognitoConflict_Internal.h"
 #import "AWSCognitoSyncService.h"
 
+// How long, in milliseconds, a connection waits on a lock held by another connection.
+static int const AWSCognitoSQLiteBusyTimeout = 5000;
+
+// How many record ids getRecordsByIds: looks up with one query. A shorter batch is
+// padded with its last id, so one cached statement serves every batch.
+static NSUInteger const AWSCognitoSQLiteRecordLookupBatchSize = 100;
+
 @interface AWSCognitoSQLiteManager()
 {
 }
 
 @property (nonatomic, assign) sqlite3 *sqlite;
 
+// Read-only connection used by the read path so reads don't wait behind
+// writers. Only opened when the database is in WAL mode, NULL otherwise.
+@property (nonatomic, assign) sqlite3 *readSqlite;
+@property (nonatomic, assign) BOOL walEnabled;
+
+// Prepared statements of each connection, keyed by operation.
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSValue *> *statements;
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSValue *> *readStatements;
+
 // iOS 6 and later, dispatch_queue_t is an Objective-C object.
 #if OS_OBJECT_USE_OBJC
 @property (nonatomic, strong) dispatch_queue_t dispatchQueue;
+@property (nonatomic, strong) dispatch_queue_t readQueue;
 #else
 @property (nonatomic, assign) dispatch_queue_t dispatchQueue;
+@property (nonatomic, assign) dispatch_queue_t readQueue;
 #endif
 
 @end
@@ -54,24 +72,163 @@
         _identityId = identityId;
         _deviceId = deviceId;
         _dispatchQueue = dispatch_queue_create("com.amazon.cognito.SerialDispatchQueue", DISPATCH_QUEUE_SERIAL);
+        _readQueue = dispatch_queue_create("com.amazon.cognito.ReadDispatchQueue", DISPATCH_QUEUE_SERIAL);
+        _statements = [NSMutableDictionary new];
+        _readStatements = [NSMutableDictionary new];
 
         [self setupSQL];
         [self initializeTables];
+        [self setupReadSQL];
     }
 
     return self;
 }
 
+- (void)dealloc {
+    [self finalizeStatements:_statements];
+    [self finalizeStatements:_readStatements];
+    if (_readSqlite) {
+        sqlite3_close(_readSqlite);
+    }
+    if (_sqlite) {
+        sqlite3_close(_sqlite);
+    }
+#if !OS_OBJECT_USE_OBJC
+    dispatch_release(_dispatchQueue);
+    dispatch_release(_readQueue);
+#endif
+}
+
 - (void)setupSQL {
     
     
     if(sqlite3_open([[self filePath] UTF8String], &_sqlite) != SQLITE_OK)
     {
         sqlite3_close(_sqlite);
+        _sqlite = NULL;
         AWSDDLogInfo(@"SQLite setup failed.");
 
         return;
     }
+
+    sqlite3_busy_timeout(_sqlite, AWSCognitoSQLiteBusyTimeout);
+
+    // WAL lets the read connection run while a sync merge is being written,
+    // and makes commits cheaper. NORMAL is durable across app crashes in WAL mode.
+    sqlite3_stmt *statement;
+    if (sqlite3_prepare_v2(_sqlite, "PRAGMA journal_mode=WAL", -1, &statement, NULL) == SQLITE_OK) {
+        if (sqlite3_step(statement) == SQLITE_ROW) {
+            const char *journalMode = (const char *)sqlite3_column_text(statement, 0);
+            _walEnabled = journalMode != NULL && strcmp(journalMode, "wal") == 0;
+        }
+    }
+    sqlite3_finalize(statement);
+
+    if (_walEnabled) {
+        sqlite3_exec(_sqlite, "PRAGMA synchronous=NORMAL", NULL, NULL, NULL);
+    } else {
+        AWSDDLogInfo(@"WAL is not available, reads will be serialized with writes: %s", sqlite3_errmsg(_sqlite));
+    }
+
+    // The dataset size triggers must also see the rows INSERT OR REPLACE deletes.
+    sqlite3_exec(_sqlite, "PRAGMA recursive_triggers=ON", NULL, NULL, NULL);
+}
+
+- (void)setupReadSQL {
+    if (!self.sqlite || !self.walEnabled) {
+        return;
+    }
+
+    if(sqlite3_open_v2([[self filePath] UTF8String], &_readSqlite, SQLITE_OPEN_READONLY, NULL) != SQLITE_OK)
+    {
+        AWSDDLogInfo(@"SQLite read connection setup failed: %s", sqlite3_errmsg(_readSqlite));
+        sqlite3_close(_readSqlite);
+        _readSqlite = NULL;
+
+        return;
+    }
+
+    sqlite3_busy_timeout(_readSqlite, AWSCognitoSQLiteBusyTimeout);
+}
+
+#pragma mark - Statement cache
+
+/**
+ * Returns the prepared statement for the given operation on the given connection,
+ * preparing it with the SQL from sqlBlock the first time it is used. Returns NULL
+ * if preparing fails. Must be called on the queue of the connection, and the
+ * statement must be handed back with finishStatement: once stepped.
+ **/
+- (sqlite3_stmt *)statementForKey:(NSString *)key
+                       connection:(sqlite3 *)connection
+                       statements:(NSMutableDictionary<NSString *, NSValue *> *)statements
+                              sql:(NSString *(^)(void))sqlBlock {
+    sqlite3_stmt *statement = [statements[key] pointerValue];
+    if (statement) {
+        return statement;
+    }
+
+    NSString *sqlString = sqlBlock();
+    AWSDDLogDebug(@"Preparing %@ = '%@'", key, sqlString);
+
+    if(sqlite3_prepare_v2(connection, [sqlString UTF8String], -1, &statement, NULL) != SQLITE_OK)
+    {
+        sqlite3_finalize(statement);
+        return NULL;
+    }
+    statements[key] = [NSValue valueWithPointer:statement];
+
+    return statement;
+}
+
+/**
+ * Returns the cached statement for the given operation on the write connection.
+ **/
+- (sqlite3_stmt *)statementForKey:(NSString *)key sql:(NSString *(^)(void))sqlBlock {
+    return [self statementForKey:key connection:self.sqlite statements:self.statements sql:sqlBlock];
+}
+
+/**
+ * Resets a cached statement so it can be reused, and so it doesn't keep a read
+ * transaction open.
+ **/
+- (void)finishStatement:(sqlite3_stmt *)statement {
+    if (statement) {
+        sqlite3_reset(statement);
+        sqlite3_clear_bindings(statement);
+    }
+}
+
+- (void)finalizeStatements:(NSMutableDictionary<NSString *, NSValue *> *)statements {
+    for (NSValue *value in statements.allValues) {
+        sqlite3_finalize([value pointerValue]);
+    }
+    [statements removeAllObjects];
+}
+
+/**
+ * Runs a block that only reads from the database. With WAL it runs on the read
+ * connection and doesn't wait for writes in progress; otherwise it runs on the
+ * write queue like everything else.
+ **/
+- (void)performRead:(void (^)(sqlite3 *connection, NSMutableDictionary<NSString *, NSValue *> *statements))block {
+    if (self.readSqlite) {
+        // The read connection may have been closed by deleteSQLiteDatabase in the meantime.
+        __block BOOL didRead = NO;
+        dispatch_sync(self.readQueue, ^{
+            if (self.readSqlite) {
+                block(self.readSqlite, self.readStatements);
+                didRead = YES;
+            }
+        });
+        if (didRead) {
+            return;
+        }
+    }
+
+    dispatch_sync(self.dispatchQueue, ^{
+        block(self.sqlite, self.statements);
+    });
 }
 
 - (void)deleteAllData {
@@ -116,71 +273,279 @@
 - (void)initializeTables {
     
     dispatch_sync(self.dispatchQueue, ^{
-        NSString *createString = [NSString stringWithFormat:
-                                  @"CREATE TABLE IF NOT EXISTS %@ ( \
-                                  %@ TEXT NOT NULL DEFAULT %@, \
-                                  %@ TEXT NOT NULL, \
-                                  %@ TEXT NOT NULL, \
-                                  %@ INTEGER NOT NULL, \
-                                  %@ TEXT NOT NULL, \
-                                  %@ TEXT NOT NULL, \
-                                  %@ INTEGER NOT NULL DEFAULT 0, \
-                                  %@ INTEGER NOT NULL DEFAULT 1, \
-                                  %@ INTEGER NOT NULL, PRIMARY KEY(%@,%@,%@))",
-                                  AWSCognitoDefaultSqliteDataTableName,
-                                  AWSCognitoTableIdentityKeyName,
-                                  AWSCognitoUnknownIdentity,
-                                  AWSCognitoTableDatasetKeyName,
-                                  AWSCognitoTableRecordKeyName,
-                                  AWSCognitoLastModifiedFieldName,
-                                  AWSCognitoModifiedByFieldName,
-                                  AWSCognitoRecordValueName,
-                                  AWSCognitoSyncCountFieldName,
-                                  AWSCognitoDirtyFieldName,
-                                  AWSCognitoTypeFieldName,
-                                  AWSCognitoTableIdentityKeyName,
-                                  AWSCognitoTableDatasetKeyName,
-                                  AWSCognitoTableRecordKeyName];
+        [self createTables];
+    });
+}
+
+/**
+ * Creates the record and metadata tables if they don't exist yet. Must be called
+ * on the dispatch queue.
+ **/
+- (void)createTables {
+    NSString *createString = [NSString stringWithFormat:
+                              @"CREATE TABLE IF NOT EXISTS %@ ( \
+                              %@ TEXT NOT NULL DEFAULT %@, \
+                              %@ TEXT NOT NULL, \
+                              %@ TEXT NOT NULL, \
+                              %@ INTEGER NOT NULL, \
+                              %@ TEXT NOT NULL, \
+                              %@ TEXT NOT NULL, \
+                              %@ INTEGER NOT NULL DEFAULT 0, \
+                              %@ INTEGER NOT NULL DEFAULT 1, \
+                              %@ INTEGER NOT NULL, \
+                              %@ INTEGER NOT NULL DEFAULT 0, PRIMARY KEY(%@,%@,%@))",
+                              AWSCognitoDefaultSqliteDataTableName,
+                              AWSCognitoTableIdentityKeyName,
+                              AWSCognitoUnknownIdentity,
+                              AWSCognitoTableDatasetKeyName,
+                              AWSCognitoTableRecordKeyName,
+                              AWSCognitoLastModifiedFieldName,
+                              AWSCognitoModifiedByFieldName,
+                              AWSCognitoRecordValueName,
+                              AWSCognitoSyncCountFieldName,
+                              AWSCognitoDirtyFieldName,
+                              AWSCognitoTypeFieldName,
+                              AWSCognitoRecordSizeFieldName,
+                              AWSCognitoTableIdentityKeyName,
+                              AWSCognitoTableDatasetKeyName,
+                              AWSCognitoTableRecordKeyName];
+    
+    char *error;
+    if(sqlite3_exec(_sqlite, [createString UTF8String], NULL, NULL, &error) != SQLITE_OK)
+    {
+        sqlite3_close(_sqlite);
+        AWSDDLogInfo(@"SQLite setup failed: %s", error);
         
+        return;
+    }
+    NSString *createString2 = [NSString stringWithFormat:@"CREATE TABLE IF NOT EXISTS %@ ( \
+                               %@ TEXT NOT NULL DEFAULT %@, \
+                               %@ TEXT NOT NULL, \
+                               %@ INTEGER NOT NULL DEFAULT 0, \
+                               %@ INTEGER NOT NULL DEFAULT 0, \
+                               %@ TEXT NOT NULL, \
+                               %@ INTEGER NOT NULL DEFAULT 0, \
+                               %@ INTEGER NOT NULL DEFAULT 0, \
+                               %@ INTEGER NOT NULL DEFAULT 0, \
+                               PRIMARY KEY(%@,%@))",
+                               AWSCognitoDefaultSqliteMetadataTableName,
+                               AWSCognitoTableIdentityKeyName,
+                               AWSCognitoUnknownIdentity,
+                               AWSCognitoTableDatasetKeyName,
+                               AWSCognitoLastSyncCount,
+                               AWSCognitoLastModifiedFieldName,
+                               AWSCognitoModifiedByFieldName,
+                               AWSCognitoDatasetCreationDateFieldName,
+                               AWSCognitoDataStorageFieldName,
+                               AWSCognitoRecordCountFieldName,
+                               AWSCognitoTableIdentityKeyName,
+                               AWSCognitoTableDatasetKeyName ];
+    if(sqlite3_exec(_sqlite, [createString2 UTF8String], NULL, NULL, &error) != SQLITE_OK)
+    {
+        sqlite3_close(_sqlite);
+        AWSDDLogInfo(@"SQLite setup failed: %s", error);
+        
+        return;
+    }
+    
+    [self initializeDatasetSizeTracking];
+}
+
+/**
+ * Sets up the running size and record count of each dataset, and the index of dirty records.
+ *
+ * Each record row stores its own size. Triggers on the record table keep the per-dataset totals in the size
+ * table up to date within the transaction of every write, so reading the size of a dataset is a single row
+ * lookup. Databases created before the size column existed are migrated once. Must be called on the
+ * dispatch queue.
+ **/
+- (void)initializeDatasetSizeTracking {
+    if (!self.sqlite) {
+        return;
+    }
+    sqlite3_exec(self.sqlite, "BEGIN EXCLUSIVE TRANSACTION", 0, 0, 0);
+
+    BOOL result = YES;
+    NSString *sqlString = [NSString stringWithFormat:@"SELECT %@ FROM %@ LIMIT 0",
+                           AWSCognitoRecordSizeFieldName,
+                           AWSCognitoDefaultSqliteDataTableName];
+    sqlite3_stmt *statement;
+    BOOL hasSizeColumn = sqlite3_prepare_v2(self.sqlite, [sqlString UTF8String], -1, &statement, NULL) == SQLITE_OK;
+    sqlite3_finalize(statement);
+    if (!hasSizeColumn) {
+        result = [self addRecordSizeColumn];
+    }
+
+    sqlString = [NSString stringWithFormat:@"SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = '%@'",
+                 AWSCognitoDefaultSqliteSizeTableName];
+    BOOL hasSizeTable = NO;
+    if (sqlite3_prepare_v2(self.sqlite, [sqlString UTF8String], -1, &statement, NULL) == SQLITE_OK) {
+        hasSizeTable = sqlite3_step(statement) == SQLITE_ROW;
+    }
+    sqlite3_finalize(statement);
+
+    NSMutableArray<NSString *> *sqlStrings = [NSMutableArray new];
+    if (!hasSizeTable) {
+        [sqlStrings addObject:[NSString stringWithFormat:@"CREATE TABLE %@ ( \
+                               %@ TEXT NOT NULL, \
+                               %@ TEXT NOT NULL, \
+                               %@ INTEGER NOT NULL DEFAULT 0, \
+                               %@ INTEGER NOT NULL DEFAULT 0, \
+                               PRIMARY KEY(%@,%@))",
+                               AWSCognitoDefaultSqliteSizeTableName,
+                               AWSCognitoTableIdentityKeyName,
+                               AWSCognitoTableDatasetKeyName,
+                               AWSCognitoRecordSizeFieldName,
+                               AWSCognitoRecordCountFieldName,
+                               AWSCognitoTableIdentityKeyName,
+                               AWSCognitoTableDatasetKeyName]];
+        [sqlStrings addObject:[NSString stringWithFormat:@"INSERT INTO %@ (%@, %@, %@, %@) \
+                               SELECT %@, %@, SUM(%@), COUNT(*) FROM %@ GROUP BY %@, %@",
+                               AWSCognitoDefaultSqliteSizeTableName,
+                               AWSCognitoTableIdentityKeyName,
+                               AWSCognitoTableDatasetKeyName,
+                               AWSCognitoRecordSizeFieldName,
+                               AWSCognitoRecordCountFieldName,
+                               AWSCognitoTableIdentityKeyName,
+                               AWSCognitoTableDatasetKeyName,
+                               AWSCognitoRecordSizeFieldName,
+                               AWSCognitoDefaultSqliteDataTableName,
+                               AWSCognitoTableIdentityKeyName,
+                               AWSCognitoTableDatasetKeyName]];
+    }
+
+    // Adds a row's size to the totals of its dataset, creating the totals row if needed. The totals row is
+    // created without a conflict clause because the trigger would inherit the OR REPLACE of putRecord.
+    NSString *(^addRow)(NSString *) = ^NSString *(NSString *row) {
+        return [NSString stringWithFormat:@"INSERT INTO %@ (%@, %@) SELECT %@.%@, %@.%@ \
+                WHERE NOT EXISTS (SELECT 1 FROM %@ WHERE %@ = %@.%@ AND %@ = %@.%@); \
+                UPDATE %@ SET %@ = %@ + %@.%@, %@ = %@ + 1 WHERE %@ = %@.%@ AND %@ = %@.%@;",
+                AWSCognitoDefaultSqliteSizeTableName,
+                AWSCognitoTableIdentityKeyName,
+                AWSCognitoTableDatasetKeyName,
+                row, AWSCognitoTableIdentityKeyName,
+                row, AWSCognitoTableDatasetKeyName,
+                AWSCognitoDefaultSqliteSizeTableName,
+                AWSCognitoTableIdentityKeyName, row, AWSCognitoTableIdentityKeyName,
+                AWSCognitoTableDatasetKeyName, row, AWSCognitoTableDatasetKeyName,
+                AWSCognitoDefaultSqliteSizeTableName,
+                AWSCognitoRecordSizeFieldName, AWSCognitoRecordSizeFieldName, row, AWSCognitoRecordSizeFieldName,
+                AWSCognitoRecordCountFieldName, AWSCognitoRecordCountFieldName,
+                AWSCognitoTableIdentityKeyName, row, AWSCognitoTableIdentityKeyName,
+                AWSCognitoTableDatasetKeyName, row, AWSCognitoTableDatasetKeyName];
+    };
+    // Removes a row's size from the totals of its dataset.
+    NSString *(^removeRow)(NSString *) = ^NSString *(NSString *row) {
+        return [NSString stringWithFormat:@"UPDATE %@ SET %@ = %@ - %@.%@, %@ = %@ - 1 WHERE %@ = %@.%@ AND %@ = %@.%@;",
+                AWSCognitoDefaultSqliteSizeTableName,
+                AWSCognitoRecordSizeFieldName, AWSCognitoRecordSizeFieldName, row, AWSCognitoRecordSizeFieldName,
+                AWSCognitoRecordCountFieldName, AWSCognitoRecordCountFieldName,
+                AWSCognitoTableIdentityKeyName, row, AWSCognitoTableIdentityKeyName,
+                AWSCognitoTableDatasetKeyName, row, AWSCognitoTableDatasetKeyName];
+    };
+    [sqlStrings addObject:[NSString stringWithFormat:@"CREATE TRIGGER IF NOT EXISTS %@Insert AFTER INSERT ON %@ BEGIN %@ END",
+                           AWSCognitoDefaultSqliteSizeTableName,
+                           AWSCognitoDefaultSqliteDataTableName,
+                           addRow(@"NEW")]];
+    [sqlStrings addObject:[NSString stringWithFormat:@"CREATE TRIGGER IF NOT EXISTS %@Delete AFTER DELETE ON %@ BEGIN %@ END",
+                           AWSCognitoDefaultSqliteSizeTableName,
+                           AWSCognitoDefaultSqliteDataTableName,
+                           removeRow(@"OLD")]];
+    // Also covers records moved to another identity or dataset by a merge.
+    [sqlStrings addObject:[NSString stringWithFormat:@"CREATE TRIGGER IF NOT EXISTS %@Update AFTER UPDATE OF %@, %@, %@ ON %@ BEGIN %@ %@ END",
+                           AWSCognitoDefaultSqliteSizeTableName,
+                           AWSCognitoRecordSizeFieldName,
+                           AWSCognitoTableIdentityKeyName,
+                           AWSCognitoTableDatasetKeyName,
+                           AWSCognitoDefaultSqliteDataTableName,
+                           removeRow(@"OLD"),
+                           addRow(@"NEW")]];
+
+    for (NSString *sql in sqlStrings) {
+        if (!result) {
+            break;
+        }
         char *error;
-        if(sqlite3_exec(_sqlite, [createString UTF8String], NULL, NULL, &error) != SQLITE_OK)
-        {
-            sqlite3_close(_sqlite);
-            AWSDDLogInfo(@"SQLite setup failed: %s", error);
-            
-            return;
+        if (sqlite3_exec(self.sqlite, [sql UTF8String], NULL, NULL, &error) != SQLITE_OK) {
+            AWSDDLogError(@"Error setting up dataset size tracking: %s", error);
+            sqlite3_free(error);
+            result = NO;
         }
-        NSString *createString2 = [NSString stringWithFormat:@"CREATE TABLE IF NOT EXISTS %@ ( \
-                                   %@ TEXT NOT NULL DEFAULT %@, \
-                                   %@ TEXT NOT NULL, \
-                                   %@ INTEGER NOT NULL DEFAULT 0, \
-                                   %@ INTEGER NOT NULL DEFAULT 0, \
-                                   %@ TEXT NOT NULL, \
-                                   %@ INTEGER NOT NULL DEFAULT 0, \
-                                   %@ INTEGER NOT NULL DEFAULT 0, \
-                                   %@ INTEGER NOT NULL DEFAULT 0, \
-                                   PRIMARY KEY(%@,%@))",
-                                   AWSCognitoDefaultSqliteMetadataTableName,
-                                   AWSCognitoTableIdentityKeyName,
-                                   AWSCognitoUnknownIdentity,
-                                   AWSCognitoTableDatasetKeyName,
-                                   AWSCognitoLastSyncCount,
-                                   AWSCognitoLastModifiedFieldName,
-                                   AWSCognitoModifiedByFieldName,
-                                   AWSCognitoDatasetCreationDateFieldName,
-                                   AWSCognitoDataStorageFieldName,
-                                   AWSCognitoRecordCountFieldName,
-                                   AWSCognitoTableIdentityKeyName,
-                                   AWSCognitoTableDatasetKeyName ];
-        if(sqlite3_exec(_sqlite, [createString2 UTF8String], NULL, NULL, &error) != SQLITE_OK)
-        {
-            sqlite3_close(_sqlite);
-            AWSDDLogInfo(@"SQLite setup failed: %s", error);
-            
-            return;
+    }
+
+    if (result) {
+        sqlite3_exec(self.sqlite, "COMMIT TRANSACTION", 0, 0, 0);
+    } else {
+        sqlite3_exec(self.sqlite, "ROLLBACK TRANSACTION", 0, 0, 0);
+    }
+
+    // Lets a push read only the dirty rows of a dataset. Partial indexes need SQLite 3.8.0; without one the
+    // query falls back to scanning the dataset.
+    NSString *indexString = [NSString stringWithFormat:@"CREATE INDEX IF NOT EXISTS %@ ON %@ (%@, %@) WHERE %@ != 0",
+                             AWSCognitoDirtyRecordsIndexName,
+                             AWSCognitoDefaultSqliteDataTableName,
+                             AWSCognitoTableIdentityKeyName,
+                             AWSCognitoTableDatasetKeyName,
+                             AWSCognitoDirtyFieldName];
+    char *error;
+    if (sqlite3_exec(self.sqlite, [indexString UTF8String], NULL, NULL, &error) != SQLITE_OK) {
+        AWSDDLogInfo(@"Dirty record index is not available: %s", error);
+        sqlite3_free(error);
+    }
+}
+
+/**
+ * Adds the size column to a record table created by an earlier version and fills it in. Must be called on the
+ * dispatch queue inside a transaction.
+ **/
+- (BOOL)addRecordSizeColumn {
+    NSString *sqlString = [NSString stringWithFormat:@"ALTER TABLE %@ ADD COLUMN %@ INTEGER NOT NULL DEFAULT 0",
+                           AWSCognitoDefaultSqliteDataTableName,
+                           AWSCognitoRecordSizeFieldName];
+    char *error;
+    if (sqlite3_exec(self.sqlite, [sqlString UTF8String], NULL, NULL, &error) != SQLITE_OK) {
+        AWSDDLogError(@"Error adding the record size column: %s", error);
+        sqlite3_free(error);
+        return NO;
+    }
+
+    NSString *selectString = [NSString stringWithFormat:@"SELECT rowid, %@, %@, %@ FROM %@",
+                              AWSCognitoTableRecordKeyName,
+                              AWSCognitoRecordValueName,
+                              AWSCognitoTypeFieldName,
+                              AWSCognitoDefaultSqliteDataTableName];
+    NSString *updateString = [NSString stringWithFormat:@"UPDATE %@ SET %@ = ? WHERE rowid = ?",
+                              AWSCognitoDefaultSqliteDataTableName,
+                              AWSCognitoRecordSizeFieldName];
+    sqlite3_stmt *selectStatement;
+    sqlite3_stmt *updateStatement;
+    BOOL result = YES;
+    if((sqlite3_prepare_v2(self.sqlite, [selectString UTF8String], -1, &selectStatement, NULL) != SQLITE_OK) ||
+       (sqlite3_prepare_v2(self.sqlite, [updateString UTF8String], -1, &updateStatement, NULL) != SQLITE_OK)) {
+        AWSDDLogError(@"Error computing record sizes: %s", sqlite3_errmsg(self.sqlite));
+        result = NO;
+    }
+    else {
+        while (result && sqlite3_step(selectStatement) == SQLITE_ROW) {
+            char *recordIdChars = (char *) sqlite3_column_text(selectStatement, 1);
+            char *dataChars = (char *) sqlite3_column_text(selectStatement, 2);
+            int64_t type = sqlite3_column_int64(selectStatement, 3);
+            AWSCognitoRecordValue *data = [[AWSCognitoRecordValue alloc] initWithJson:[[NSString alloc] initWithUTF8String:dataChars] type:(int)type];
+            AWSCognitoRecord *record = [[AWSCognitoRecord alloc] initWithId:[[NSString alloc] initWithUTF8String:recordIdChars] data:data];
+
+            sqlite3_bind_int64(updateStatement, 1, [record size]);
+            sqlite3_bind_int64(updateStatement, 2, sqlite3_column_int64(selectStatement, 0));
+            if (SQLITE_DONE != sqlite3_step(updateStatement)) {
+                AWSDDLogError(@"Error computing record sizes: %s", sqlite3_errmsg(self.sqlite));
+                result = NO;
+            }
+            sqlite3_reset(updateStatement);
         }
-        
-    });
+    }
+    sqlite3_finalize(selectStatement);
+    sqlite3_finalize(updateStatement);
+
+    return result;
 }
 
 - (void)initializeDatasetTables:(NSString *) datasetName {
@@ -231,22 +596,21 @@
 - (NSArray<AWSCognitoDatasetMetadata *> *)getDatasets:(NSError * __autoreleasing *)error {
     __block NSMutableArray<AWSCognitoDatasetMetadata *> *datasets = [NSMutableArray array];
     
-    dispatch_sync(self.dispatchQueue, ^{
-        NSString *query = [NSString stringWithFormat:@"SELECT %@, %@, %@, %@, %@, %@, %@ FROM %@ WHERE %@ = ?",
-                           AWSCognitoTableDatasetKeyName,
-                           AWSCognitoLastSyncCount,
-                           AWSCognitoLastModifiedFieldName,
-                           AWSCognitoModifiedByFieldName,
-                           AWSCognitoDatasetCreationDateFieldName,
-                           AWSCognitoDataStorageFieldName,
-                           AWSCognitoRecordCountFieldName,
-                           AWSCognitoDefaultSqliteMetadataTableName,
-                           AWSCognitoTableIdentityKeyName];
-        
-        AWSDDLogDebug(@"query = '%@'", query);
-        
-        sqlite3_stmt *statement;
-        if(sqlite3_prepare_v2(self.sqlite, [query UTF8String], -1, &statement, NULL) == SQLITE_OK)
+    [self performRead:^(sqlite3 *connection, NSMutableDictionary<NSString *, NSValue *> *statements) {
+        sqlite3_stmt *statement = [self statementForKey:@"getDatasets" connection:connection statements:statements sql:^NSString *{
+            return [NSString stringWithFormat:@"SELECT %@, %@, %@, %@, %@, %@, %@ FROM %@ WHERE %@ = ?",
+                    AWSCognitoTableDatasetKeyName,
+                    AWSCognitoLastSyncCount,
+                    AWSCognitoLastModifiedFieldName,
+                    AWSCognitoModifiedByFieldName,
+                    AWSCognitoDatasetCreationDateFieldName,
+                    AWSCognitoDataStorageFieldName,
+                    AWSCognitoRecordCountFieldName,
+                    AWSCognitoDefaultSqliteMetadataTableName,
+                    AWSCognitoTableIdentityKeyName];
+        }];
+        
+        if(statement)
         {
             NSString * identityId = [self identityId];
             
@@ -276,38 +640,36 @@
         }
         else
         {
-            AWSDDLogInfo(@"Error creating query statement: %s", sqlite3_errmsg(self.sqlite));
+            AWSDDLogInfo(@"Error creating query statement: %s", sqlite3_errmsg(connection));
             if(error != nil)
             {
-                *error = [AWSCognitoUtil errorLocalDataStorageFailed:[NSString stringWithFormat:@"%s", sqlite3_errmsg(self.sqlite)]];
+                *error = [AWSCognitoUtil errorLocalDataStorageFailed:[NSString stringWithFormat:@"%s", sqlite3_errmsg(connection)]];
             }
         }
         
-        sqlite3_reset(statement);
-        sqlite3_finalize(statement);
-    });
+        [self finishStatement:statement];
+    }];
     
     return datasets;
 }
 
 - (void)loadDatasetMetadata:(AWSCognitoDatasetMetadata *)metadata error:(NSError * __autoreleasing *)error {
     
-    dispatch_sync(self.dispatchQueue, ^{
-        NSString *query = [NSString stringWithFormat:@"SELECT %@, %@, %@, %@, %@, %@ FROM %@ WHERE %@ = ? and %@ = ?",
-                           AWSCognitoLastSyncCount,
-                           AWSCognitoLastModifiedFieldName,
-                           AWSCognitoModifiedByFieldName,
-                           AWSCognitoDatasetCreationDateFieldName,
-                           AWSCognitoDataStorageFieldName,
-                           AWSCognitoRecordCountFieldName,
-                           AWSCognitoDefaultSqliteMetadataTableName,
-                           AWSCognitoTableIdentityKeyName,
-                           AWSCognitoDatasetFieldName];
-        
-        AWSDDLogDebug(@"query = '%@'", query);
-        
-        sqlite3_stmt *statement;
-        if(sqlite3_prepare_v2(self.sqlite, [query UTF8String], -1, &statement, NULL) == SQLITE_OK)
+    [self performRead:^(sqlite3 *connection, NSMutableDictionary<NSString *, NSValue *> *statements) {
+        sqlite3_stmt *statement = [self statementForKey:@"loadDatasetMetadata" connection:connection statements:statements sql:^NSString *{
+            return [NSString stringWithFormat:@"SELECT %@, %@, %@, %@, %@, %@ FROM %@ WHERE %@ = ? and %@ = ?",
+                    AWSCognitoLastSyncCount,
+                    AWSCognitoLastModifiedFieldName,
+                    AWSCognitoModifiedByFieldName,
+                    AWSCognitoDatasetCreationDateFieldName,
+                    AWSCognitoDataStorageFieldName,
+                    AWSCognitoRecordCountFieldName,
+                    AWSCognitoDefaultSqliteMetadataTableName,
+                    AWSCognitoTableIdentityKeyName,
+                    AWSCognitoDatasetFieldName];
+        }];
+        
+        if(statement)
         {
             sqlite3_bind_text(statement, 1, [self.identityId UTF8String], -1, SQLITE_TRANSIENT);
             sqlite3_bind_text(statement, 2, [metadata.name UTF8String], -1, SQLITE_TRANSIENT);
@@ -331,16 +693,15 @@
         }
         else
         {
-            AWSDDLogInfo(@"Error creating query statement: %s", sqlite3_errmsg(self.sqlite));
+            AWSDDLogInfo(@"Error creating query statement: %s", sqlite3_errmsg(connection));
             if(error != nil)
             {
-                *error = [AWSCognitoUtil errorLocalDataStorageFailed:[NSString stringWithFormat:@"%s", sqlite3_errmsg(self.sqlite)]];
+                *error = [AWSCognitoUtil errorLocalDataStorageFailed:[NSString stringWithFormat:@"%s", sqlite3_errmsg(connection)]];
             }
         }
         
-        sqlite3_reset(statement);
-        sqlite3_finalize(statement);
-    });
+        [self finishStatement:statement];
+    }];
 }
 
 
@@ -443,70 +804,93 @@
     return success;
 }
 
-- (AWSCognitoRecord *)getRecordById_internal:(NSString *)recordId datasetName:(NSString *)datasetName error:(NSError * __autoreleasing *)error sync:(BOOL) sync{
-    __block AWSCognitoRecord *record = nil;
-    void (^getRecord)(void) = ^{
-        NSString *query = [NSString stringWithFormat:@"SELECT %@, %@, %@, %@, %@, %@ FROM %@ WHERE %@ = ? AND %@ = ? AND %@ = ?",
-                           AWSCognitoLastModifiedFieldName,
-                           AWSCognitoModifiedByFieldName,
-                           AWSCognitoRecordValueName,
-                           AWSCognitoTypeFieldName,
-                           AWSCognitoSyncCountFieldName,
-                           AWSCognitoDirtyFieldName,
-                           AWSCognitoDefaultSqliteDataTableName,
-                           AWSCognitoTableRecordKeyName,
-                           AWSCognitoTableIdentityKeyName,
-                           AWSCognitoTableDatasetKeyName
-                           ];
+/**
+ * Builds a record from the current row of a statement that selects the last modified
+ * date, modified by, value, type, sync count and dirty count columns, in that order.
+ **/
+- (AWSCognitoRecord *)recordWithId:(NSString *)recordId fromStatement:(sqlite3_stmt *)statement {
+    int64_t lastMod = sqlite3_column_int64(statement, 0);
+    char *modByChars = (char *) sqlite3_column_text(statement, 1);
+    char *dataChars = (char *)sqlite3_column_text(statement, 2);
+    int64_t type = sqlite3_column_int64(statement, 3);
+    int64_t syncCount = sqlite3_column_int64(statement, 4);
+    int64_t dirtyInt = sqlite3_column_int64(statement, 5);
+    
+    NSString *modBy = [[NSString alloc] initWithUTF8String:modByChars];
+    NSString *data = [[NSString alloc] initWithUTF8String:dataChars];
+    
+    AWSCognitoRecord *record = [[AWSCognitoRecord alloc] initWithId:recordId
+                                                               data:[[AWSCognitoRecordValue alloc]initWithJson:data type:(int)type]];
+    record.lastModifiedBy = modBy;
+    record.lastModified = [AWSCognitoUtil millisSinceEpochToDate:[NSNumber numberWithLongLong:lastMod]];
+    record.dirtyCount = dirtyInt;
+    record.syncCount = syncCount;
+    
+    return record;
+}
+
+/**
+ * Looks up a record with the get record statement of the connection. Returns nil
+ * if the record doesn't exist.
+ **/
+- (AWSCognitoRecord *)getRecordById:(NSString *)recordId
+                        datasetName:(NSString *)datasetName
+                         connection:(sqlite3 *)connection
+                         statements:(NSMutableDictionary<NSString *, NSValue *> *)statements
+                              error:(NSError * __autoreleasing *)error {
+    AWSCognitoRecord *record = nil;
+    sqlite3_stmt *statement = [self statementForKey:@"getRecordById" connection:connection statements:statements sql:^NSString *{
+        return [NSString stringWithFormat:@"SELECT %@, %@, %@, %@, %@, %@ FROM %@ WHERE %@ = ? AND %@ = ? AND %@ = ?",
+                AWSCognitoLastModifiedFieldName,
+                AWSCognitoModifiedByFieldName,
+                AWSCognitoRecordValueName,
+                AWSCognitoTypeFieldName,
+                AWSCognitoSyncCountFieldName,
+                AWSCognitoDirtyFieldName,
+                AWSCognitoDefaultSqliteDataTableName,
+                AWSCognitoTableRecordKeyName,
+                AWSCognitoTableIdentityKeyName,
+                AWSCognitoTableDatasetKeyName];
+    }];
+    
+    if(statement)
+    {
+        sqlite3_bind_text(statement, 1, [recordId UTF8String], -1, SQLITE_TRANSIENT);
         
-        AWSDDLogDebug(@"query = '%@'", query);
+        NSString * identityId = [self identityId];
         
-        sqlite3_stmt *statement;
-        if(sqlite3_prepare_v2(self.sqlite, [query UTF8String], -1, &statement, NULL) == SQLITE_OK)
+        sqlite3_bind_text(statement, 2, [identityId UTF8String], -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(statement, 3, [datasetName UTF8String], -1, SQLITE_TRANSIENT);
+        
+        if (sqlite3_step(statement) == SQLITE_ROW)
         {
-            sqlite3_bind_text(statement, 1, [recordId UTF8String], -1, SQLITE_TRANSIENT);
-            
-            NSString * identityId = [self identityId];
-            
-            sqlite3_bind_text(statement, 2, [identityId UTF8String], -1, SQLITE_TRANSIENT);
-            sqlite3_bind_text(statement, 3, [datasetName UTF8String], -1, SQLITE_TRANSIENT);
-            
-            if (sqlite3_step(statement) == SQLITE_ROW)
-            {
-                int64_t lastMod = sqlite3_column_int64(statement, 0);
-                char *modByChars = (char *) sqlite3_column_text(statement, 1);
-                char *dataChars = (char *)sqlite3_column_text(statement, 2);
-                int64_t type = sqlite3_column_int64(statement, 3);
-                int64_t syncCount = sqlite3_column_int64(statement, 4);
-                int64_t dirtyInt = sqlite3_column_int64(statement, 5);
-                
-                NSString *modBy = [[NSString alloc] initWithUTF8String:modByChars];
-                NSString *data = [[NSString alloc] initWithUTF8String:dataChars];
-                
-                record = [[AWSCognitoRecord alloc] initWithId:recordId
-                                                         data:[[AWSCognitoRecordValue alloc]initWithJson:data type:(int)type]];
-                record.lastModifiedBy = modBy;
-                record.lastModified = [AWSCognitoUtil millisSinceEpochToDate:[NSNumber numberWithLongLong:lastMod]];
-                record.dirtyCount = dirtyInt;
-                record.syncCount = syncCount;
-            }
+            record = [self recordWithId:recordId fromStatement:statement];
         }
-        else
+    }
+    else
+    {
+        AWSDDLogInfo(@"Error creating query statement: %s", sqlite3_errmsg(connection));
+        if(error != nil)
         {
-            AWSDDLogInfo(@"Error creating query statement: %s", sqlite3_errmsg(self.sqlite));
-            if(error != nil)
-            {
-                *error = [AWSCognitoUtil errorLocalDataStorageFailed:[NSString stringWithFormat:@"%s", sqlite3_errmsg(self.sqlite)]];
-            }
+            *error = [AWSCognitoUtil errorLocalDataStorageFailed:[NSString stringWithFormat:@"%s", sqlite3_errmsg(connection)]];
         }
-        
-        sqlite3_reset(statement);
-        sqlite3_finalize(statement);
-    };
+    }
+    
+    [self finishStatement:statement];
+    
+    return record;
+}
+
+- (AWSCognitoRecord *)getRecordById_internal:(NSString *)recordId datasetName:(NSString *)datasetName error:(NSError * __autoreleasing *)error sync:(BOOL) sync{
+    __block AWSCognitoRecord *record = nil;
     if(sync){
-        dispatch_sync(self.dispatchQueue, getRecord);
+        [self performRead:^(sqlite3 *connection, NSMutableDictionary<NSString *, NSValue *> *statements) {
+            record = [self getRecordById:recordId datasetName:datasetName connection:connection statements:statements error:error];
+        }];
     }else{
-        getRecord();
+        // Already on the write queue, possibly inside a transaction whose
+        // changes only the write connection can see.
+        record = [self getRecordById:recordId datasetName:datasetName connection:self.sqlite statements:self.statements error:error];
     }
     
     return record;
@@ -516,35 +900,106 @@
     return [self getRecordById_internal:recordId datasetName:datasetName error:error sync:YES];
 }
 
+- (NSDictionary<NSString *, AWSCognitoRecord *> *)getRecordsByIds:(NSArray<NSString *> *)recordIds datasetName:(NSString *)datasetName error:(NSError * __autoreleasing *)error {
+    NSMutableDictionary<NSString *, AWSCognitoRecord *> *records = [NSMutableDictionary dictionaryWithCapacity:recordIds.count];
+    if (recordIds.count == 0) {
+        return records;
+    }
+    
+    [self performRead:^(sqlite3 *connection, NSMutableDictionary<NSString *, NSValue *> *statements) {
+        sqlite3_stmt *statement = [self statementForKey:@"getRecordsByIds" connection:connection statements:statements sql:^NSString *{
+            NSMutableArray<NSString *> *placeholders = [NSMutableArray arrayWithCapacity:AWSCognitoSQLiteRecordLookupBatchSize];
+            for (NSUInteger i = 0; i < AWSCognitoSQLiteRecordLookupBatchSize; i++) {
+                [placeholders addObject:@"?"];
+            }
+            return [NSString stringWithFormat:@"SELECT %@, %@, %@, %@, %@, %@, %@ FROM %@ WHERE %@ = ? AND %@ = ? AND %@ IN (%@)",
+                    AWSCognitoLastModifiedFieldName,
+                    AWSCognitoModifiedByFieldName,
+                    AWSCognitoRecordValueName,
+                    AWSCognitoTypeFieldName,
+                    AWSCognitoSyncCountFieldName,
+                    AWSCognitoDirtyFieldName,
+                    AWSCognitoTableRecordKeyName,
+                    AWSCognitoDefaultSqliteDataTableName,
+                    AWSCognitoTableIdentityKeyName,
+                    AWSCognitoTableDatasetKeyName,
+                    AWSCognitoTableRecordKeyName,
+                    [placeholders componentsJoinedByString:@", "]];
+        }];
+        if (!statement) {
+            AWSDDLogInfo(@"Error creating query statement: %s", sqlite3_errmsg(connection));
+            if(error != nil)
+            {
+                *error = [AWSCognitoUtil errorLocalDataStorageFailed:[NSString stringWithFormat:@"%s", sqlite3_errmsg(connection)]];
+            }
+            return;
+        }
+        
+        NSString *identityId = [self identityId];
+        for (NSUInteger start = 0; start < recordIds.count; start += AWSCognitoSQLiteRecordLookupBatchSize) {
+            NSUInteger end = MIN(start + AWSCognitoSQLiteRecordLookupBatchSize, recordIds.count);
+            
+            sqlite3_bind_text(statement, 1, [identityId UTF8String], -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(statement, 2, [datasetName UTF8String], -1, SQLITE_TRANSIENT);
+            for (NSUInteger i = 0; i < AWSCognitoSQLiteRecordLookupBatchSize; i++) {
+                NSString *recordId = recordIds[MIN(start + i, end - 1)];
+                sqlite3_bind_text(statement, (int)i + 3, [recordId UTF8String], -1, SQLITE_TRANSIENT);
+            }
+            
+            int result;
+            while ((result = sqlite3_step(statement)) == SQLITE_ROW) {
+                NSString *recordId = [[NSString alloc] initWithUTF8String:(const char *)sqlite3_column_text(statement, 6)];
+                records[recordId] = [self recordWithId:recordId fromStatement:statement];
+            }
+            if (result != SQLITE_DONE) {
+                AWSDDLogInfo(@"Error looking up records: %s", sqlite3_errmsg(connection));
+                if(error != nil)
+                {
+                    *error = [AWSCognitoUtil errorLocalDataStorageFailed:[NSString stringWithFormat:@"%s", sqlite3_errmsg(connection)]];
+                }
+                [self finishStatement:statement];
+                return;
+            }
+            [self finishStatement:statement];
+        }
+    }];
+    
+    return records;
+}
+
 - (NSString *) identityId {
-    if(_identityId == nil) {
-        _identityId = AWSCognitoUnknownIdentity;
+    @synchronized(self) {
+        return _identityId ?: AWSCognitoUnknownIdentity;
+    }
+}
+
+- (void)setIdentityId:(NSString *)identityId {
+    @synchronized(self) {
+        _identityId = identityId;
     }
-    return _identityId;
 }
 
 - (NSDictionary *)recordsUpdatedAfterLastSync:(NSString *) datasetName error:(NSError * __autoreleasing *)error
 {
     __block NSMutableDictionary *newRecords = [NSMutableDictionary new];
 
-    dispatch_sync(self.dispatchQueue, ^{
-        NSString *query = [NSString stringWithFormat:@"SELECT %@, %@, %@, %@, %@, %@, %@ FROM %@ WHERE %@ != 0 AND %@ = ? AND %@ = ?",
-                           AWSCognitoTableRecordKeyName,
-                           AWSCognitoLastModifiedFieldName,
-                           AWSCognitoModifiedByFieldName,
-                           AWSCognitoRecordValueName,
-                           AWSCognitoTypeFieldName,
-                           AWSCognitoSyncCountFieldName,
-                           AWSCognitoDirtyFieldName,
-                           AWSCognitoDefaultSqliteDataTableName,
-                           AWSCognitoDirtyFieldName,
-                           AWSCognitoTableIdentityKeyName,
-                           AWSCognitoTableDatasetKeyName];
-
-        sqlite3_stmt *statement;
-        
-        
-        if(sqlite3_prepare_v2(self.sqlite, [query UTF8String], -1, &statement, NULL) == SQLITE_OK)
+    [self performRead:^(sqlite3 *connection, NSMutableDictionary<NSString *, NSValue *> *statements) {
+        sqlite3_stmt *statement = [self statementForKey:@"recordsUpdatedAfterLastSync" connection:connection statements:statements sql:^NSString *{
+            return [NSString stringWithFormat:@"SELECT %@, %@, %@, %@, %@, %@, %@ FROM %@ WHERE %@ != 0 AND %@ = ? AND %@ = ?",
+                    AWSCognitoTableRecordKeyName,
+                    AWSCognitoLastModifiedFieldName,
+                    AWSCognitoModifiedByFieldName,
+                    AWSCognitoRecordValueName,
+                    AWSCognitoTypeFieldName,
+                    AWSCognitoSyncCountFieldName,
+                    AWSCognitoDirtyFieldName,
+                    AWSCognitoDefaultSqliteDataTableName,
+                    AWSCognitoDirtyFieldName,
+                    AWSCognitoTableIdentityKeyName,
+                    AWSCognitoTableDatasetKeyName];
+        }];
+        
+        if(statement)
         {
             NSString * identityId = [self identityId];
             sqlite3_bind_text(statement, 1, [identityId UTF8String], -1, SQLITE_TRANSIENT);
@@ -576,13 +1031,15 @@
         }
         else
         {
-            AWSDDLogInfo(@"Error creating query statement: %s", sqlite3_errmsg(self.sqlite));
+            AWSDDLogInfo(@"Error creating query statement: %s", sqlite3_errmsg(connection));
             if(error != nil)
             {
-                *error = [AWSCognitoUtil errorLocalDataStorageFailed:[NSString stringWithFormat:@"%s", sqlite3_errmsg(self.sqlite)]];
+                *error = [AWSCognitoUtil errorLocalDataStorageFailed:[NSString stringWithFormat:@"%s", sqlite3_errmsg(connection)]];
             }
         }
-    });
+        
+        [self finishStatement:statement];
+    }];
 
     return [NSDictionary dictionaryWithDictionary:newRecords];
 }
@@ -591,24 +1048,24 @@
 {
     __block NSMutableArray *allRecords = nil;
 
-    dispatch_sync(self.dispatchQueue, ^{
-
-        NSString *query = [NSString stringWithFormat:@"SELECT %@, %@, %@, %@, %@, %@, %@ FROM %@ WHERE %@ = ? AND %@ = ?",
-                           AWSCognitoTableRecordKeyName,
-                           AWSCognitoLastModifiedFieldName,
-                           AWSCognitoModifiedByFieldName,
-                           AWSCognitoRecordValueName,
-                           AWSCognitoTypeFieldName,
-                           AWSCognitoSyncCountFieldName,
-                           AWSCognitoDirtyFieldName,
-                           AWSCognitoDefaultSqliteDataTableName,
-                           AWSCognitoTableIdentityKeyName,
-                           AWSCognitoTableDatasetKeyName];
+    [self performRead:^(sqlite3 *connection, NSMutableDictionary<NSString *, NSValue *> *statements) {
+        sqlite3_stmt *statement = [self statementForKey:@"allRecords" connection:connection statements:statements sql:^NSString *{
+            return [NSString stringWithFormat:@"SELECT %@, %@, %@, %@, %@, %@, %@ FROM %@ WHERE %@ = ? AND %@ = ?",
+                    AWSCognitoTableRecordKeyName,
+                    AWSCognitoLastModifiedFieldName,
+                    AWSCognitoModifiedByFieldName,
+                    AWSCognitoRecordValueName,
+                    AWSCognitoTypeFieldName,
+                    AWSCognitoSyncCountFieldName,
+                    AWSCognitoDirtyFieldName,
+                    AWSCognitoDefaultSqliteDataTableName,
+                    AWSCognitoTableIdentityKeyName,
+                    AWSCognitoTableDatasetKeyName];
+        }];
 
         AWSCognitoRecord *record = nil;
 
-        sqlite3_stmt *statement;
-        if(sqlite3_prepare_v2(self.sqlite, [query UTF8String], -1, &statement, NULL) == SQLITE_OK)
+        if(statement)
         {
             NSString * identityId = [self identityId];
             sqlite3_bind_text(statement, 1, [identityId UTF8String], -1, SQLITE_TRANSIENT);
@@ -646,12 +1103,11 @@
         }
         else
         {
-            AWSDDLogInfo(@"Error creating query statement: %s", sqlite3_errmsg(self.sqlite));
+            AWSDDLogInfo(@"Error creating query statement: %s", sqlite3_errmsg(connection));
         }
 
-        sqlite3_reset(statement);
-        sqlite3_finalize(statement);
-    });
+        [self finishStatement:statement];
+    }];
 
     return allRecords;
 }
@@ -674,47 +1130,51 @@
          * Inserts a new record or replaces the current record with a given record.
          * Increment the dirty count if we are updating the data.
          */
-        NSString *sqlString = [NSString stringWithFormat:
-                               @"INSERT OR REPLACE INTO %@ ( \
-                               %@, \
-                               %@, \
-                               %@, \
-                               %@, \
-                               %@, \
-                               %@, \
-                               %@, \
-                               %@, \
-                               %@ \
-                               ) VALUES ( \
-                               ?, \
-                               ?, \
-                               ?, \
-                               ?, \
-                               ?, \
-                               ?, \
-                               COALESCE((SELECT %@ FROM %@ WHERE %@ = ? AND %@ = ? AND %@ = ?)+1, 1), \
-                               ?, \
-                               ? )",
-
-                               AWSCognitoDefaultSqliteDataTableName,
-                               AWSCognitoTableRecordKeyName,
-                               AWSCognitoLastModifiedFieldName,
-                               AWSCognitoModifiedByFieldName,
-                               AWSCognitoRecordValueName,
-                               AWSCognitoTypeFieldName,
-                               AWSCognitoSyncCountFieldName,
-                               AWSCognitoDirtyFieldName,
-                               AWSCognitoTableIdentityKeyName,
-                               AWSCognitoTableDatasetKeyName,
-                               
-                               AWSCognitoDirtyFieldName,
-                               AWSCognitoDefaultSqliteDataTableName,
-                               AWSCognitoTableRecordKeyName,
-                               AWSCognitoTableIdentityKeyName,
-                               AWSCognitoTableDatasetKeyName
-                            ];
-
-        if(sqlite3_prepare_v2(self.sqlite, [sqlString UTF8String], -1, &statement, NULL) == SQLITE_OK) {
+        statement = [self statementForKey:@"putRecord" sql:^NSString *{
+            return [NSString stringWithFormat:
+                    @"INSERT OR REPLACE INTO %@ ( \
+                    %@, \
+                    %@, \
+                    %@, \
+                    %@, \
+                    %@, \
+                    %@, \
+                    %@, \
+                    %@, \
+                    %@, \
+                    %@ \
+                    ) VALUES ( \
+                    ?, \
+                    ?, \
+                    ?, \
+                    ?, \
+                    ?, \
+                    ?, \
+                    COALESCE((SELECT %@ FROM %@ WHERE %@ = ? AND %@ = ? AND %@ = ?)+1, 1), \
+                    ?, \
+                    ?, \
+                    ? )",
+
+                    AWSCognitoDefaultSqliteDataTableName,
+                    AWSCognitoTableRecordKeyName,
+                    AWSCognitoLastModifiedFieldName,
+                    AWSCognitoModifiedByFieldName,
+                    AWSCognitoRecordValueName,
+                    AWSCognitoTypeFieldName,
+                    AWSCognitoSyncCountFieldName,
+                    AWSCognitoDirtyFieldName,
+                    AWSCognitoTableIdentityKeyName,
+                    AWSCognitoTableDatasetKeyName,
+                    AWSCognitoRecordSizeFieldName,
+
+                    AWSCognitoDirtyFieldName,
+                    AWSCognitoDefaultSqliteDataTableName,
+                    AWSCognitoTableRecordKeyName,
+                    AWSCognitoTableIdentityKeyName,
+                    AWSCognitoTableDatasetKeyName];
+        }];
+
+        if(statement) {
             sqlite3_bind_text(statement, 1, recordID, -1, SQLITE_TRANSIENT);
             sqlite3_bind_int64(statement, 2, lastModified);
             sqlite3_bind_text(statement, 3, lastModifiedBy, -1, SQLITE_TRANSIENT);
@@ -728,6 +1188,7 @@
 
             sqlite3_bind_text(statement, 10, identityIdChars, -1, SQLITE_TRANSIENT);
             sqlite3_bind_text(statement, 11, datasetNameChars, -1, SQLITE_TRANSIENT);
+            sqlite3_bind_int64(statement, 12, [record size]);
 
             if(SQLITE_DONE == sqlite3_step(statement)) {
                 result = YES;
@@ -748,13 +1209,56 @@
         if(result) {
             record.lastModified = lastModifiedDate;
         }
-        sqlite3_reset(statement);
-        sqlite3_finalize(statement);
+        [self finishStatement:statement];
     });
 
     return result;
 }
 
+/**
+ * Returns the statement that overwrites a record only if it still matches the state it was read in.
+ **/
+- (sqlite3_stmt *)conditionallyUpdateRecordStatement {
+    return [self statementForKey:@"conditionallyUpdateRecord" sql:^NSString *{
+        return [NSString stringWithFormat:
+                @"UPDATE %@ SET \
+                %@ = ?, \
+                %@ = ?, \
+                %@ = ?, \
+                %@ = ?, \
+                %@ = ?, \
+                %@ = ?, \
+                %@ = ? \
+                WHERE %@ = ? \
+                AND %@ = ? \
+                AND %@ = ? \
+                AND %@ = ? \
+                AND %@ = ? \
+                AND %@ = ? \
+                AND %@ = ? \
+                AND %@ = ? \
+                ",
+
+                AWSCognitoDefaultSqliteDataTableName,
+                AWSCognitoLastModifiedFieldName,
+                AWSCognitoModifiedByFieldName,
+                AWSCognitoRecordValueName,
+                AWSCognitoTypeFieldName,
+                AWSCognitoSyncCountFieldName,
+                AWSCognitoDirtyFieldName,
+                AWSCognitoRecordSizeFieldName,
+
+                AWSCognitoTableRecordKeyName,
+                AWSCognitoLastModifiedFieldName,
+                AWSCognitoModifiedByFieldName,
+                AWSCognitoRecordValueName,
+                AWSCognitoSyncCountFieldName,
+                AWSCognitoDirtyFieldName,
+                AWSCognitoTableIdentityKeyName,
+                AWSCognitoTableDatasetKeyName];
+    }];
+}
+
 - (BOOL)conditionallyPutRecord:(AWSCognitoRecord *)record datasetName:(NSString*)datasetName withCurrentState:(AWSCognitoRecord *)currentState error:(NSError **)error {
     sqlite3_stmt *statement;
     
@@ -771,42 +1275,9 @@
         const char *currentModifiedBy = [currentState.lastModifiedBy UTF8String];
         const char *currentData = [[currentState.data toJsonString] UTF8String];
         
-        NSString *sqlString = [NSString stringWithFormat:
-                               @"UPDATE %@ SET \
-                               %@ = ?, \
-                               %@ = ?, \
-                               %@ = ?, \
-                               %@ = ?, \
-                               %@ = ?, \
-                               %@ = ? \
-                               WHERE %@ = ? \
-                               AND %@ = ? \
-                               AND %@ = ? \
-                               AND %@ = ? \
-                               AND %@ = ? \
-                               AND %@ = ? \
-                               AND %@ = ? \
-                               AND %@ = ? \
-                               ",
-                               
-                               AWSCognitoDefaultSqliteDataTableName,
-                               AWSCognitoLastModifiedFieldName,
-                               AWSCognitoModifiedByFieldName,
-                               AWSCognitoRecordValueName,
-                               AWSCognitoTypeFieldName,
-                               AWSCognitoSyncCountFieldName,
-                               AWSCognitoDirtyFieldName,
-                               
-                               AWSCognitoTableRecordKeyName,
-                               AWSCognitoLastModifiedFieldName,
-                               AWSCognitoModifiedByFieldName,
-                               AWSCognitoRecordValueName,
-                               AWSCognitoSyncCountFieldName,
-                               AWSCognitoDirtyFieldName,
-                               AWSCognitoTableIdentityKeyName,
-                               AWSCognitoTableDatasetKeyName];
+        statement = [self conditionallyUpdateRecordStatement];
         
-        if(sqlite3_prepare_v2(self.sqlite, [sqlString UTF8String], -1, &statement, NULL) == SQLITE_OK) {
+        if(statement) {
             sqlite3_bind_int64(statement, 1, lastModified);
             
             sqlite3_bind_text(statement, 2, modifiedBy, -1, SQLITE_TRANSIENT);
@@ -814,22 +1285,23 @@
             sqlite3_bind_int64(statement, 4, record.data.type);
             sqlite3_bind_int64(statement, 5, record.syncCount);
             sqlite3_bind_int64(statement, 6, record.dirtyCount);
+            sqlite3_bind_int64(statement, 7, [record size]);
             
-            sqlite3_bind_text(statement, 7, recordID, -1, SQLITE_TRANSIENT);
-            sqlite3_bind_int64(statement, 8, currentLastModified);
-            sqlite3_bind_text(statement, 9, currentModifiedBy, -1, SQLITE_TRANSIENT);
-            sqlite3_bind_text(statement, 10, currentData, -1, SQLITE_TRANSIENT);
-            sqlite3_bind_int64(statement, 11, currentState.syncCount);
-            sqlite3_bind_int64(statement, 12, currentState.dirtyCount);
-            sqlite3_bind_text(statement, 13, identityIdChars, -1, SQLITE_TRANSIENT);
-            sqlite3_bind_text(statement, 14, datasetNameChars, -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(statement, 8, recordID, -1, SQLITE_TRANSIENT);
+            sqlite3_bind_int64(statement, 9, currentLastModified);
+            sqlite3_bind_text(statement, 10, currentModifiedBy, -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(statement, 11, currentData, -1, SQLITE_TRANSIENT);
+            sqlite3_bind_int64(statement, 12, currentState.syncCount);
+            sqlite3_bind_int64(statement, 13, currentState.dirtyCount);
+            sqlite3_bind_text(statement, 14, identityIdChars, -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(statement, 15, datasetNameChars, -1, SQLITE_TRANSIENT);
             
             if(SQLITE_DONE != sqlite3_step(statement)) {
                 AWSDDLogInfo(@"Error while updating data: %s", sqlite3_errmsg(self.sqlite));
                 if(error != nil) {
                     *error = [AWSCognitoUtil errorLocalDataStorageFailed:[NSString stringWithFormat:@"%s", sqlite3_errmsg(self.sqlite)]];
                 }
-                [self resetStatement:statement];
+                [self finishStatement:statement];
                 return NO;
             }
             int numRows = sqlite3_changes(self.sqlite);
@@ -841,7 +1313,7 @@
                 if(error != nil) {
                     *error = [AWSCognitoUtil errorLocalDataStorageFailed:errorMsg];
                 }
-                [self resetStatement:statement];
+                [self finishStatement:statement];
                 return NO;
             }
         }
@@ -850,47 +1322,52 @@
             if(error != nil) {
                 *error = [AWSCognitoUtil errorLocalDataStorageFailed:[NSString stringWithFormat:@"%s", sqlite3_errmsg(self.sqlite)]];
             }
-            [self resetStatement:statement];
+            [self finishStatement:statement];
             return NO;
         }
     }
     else { // Inserts the new data from the remote.
-        NSString *sqlString = [NSString stringWithFormat:
-                               @"INSERT INTO %@ ( \
-                               %@, \
-                               %@, \
-                               %@, \
-                               %@, \
-                               %@, \
-                               %@, \
-                               %@, \
-                               %@, \
-                               %@ \
-                               ) VALUES ( \
-                               ?, \
-                               ?, \
-                               ?, \
-                               ?, \
-                               ?, \
-                               ?, \
-                               ?, \
-                               ?, \
-                               ? \
-                               )",
-                               
-                               AWSCognitoDefaultSqliteDataTableName,
-                               
-                               AWSCognitoTableRecordKeyName,
-                               AWSCognitoLastModifiedFieldName,
-                               AWSCognitoModifiedByFieldName,
-                               AWSCognitoRecordValueName,
-                               AWSCognitoTypeFieldName,
-                               AWSCognitoSyncCountFieldName,
-                               AWSCognitoTableIdentityKeyName,
-                               AWSCognitoTableDatasetKeyName,
-                               AWSCognitoDirtyFieldName];
-        
-        if(sqlite3_prepare_v2(self.sqlite, [sqlString UTF8String], -1, &statement, NULL) == SQLITE_OK) {
+        statement = [self statementForKey:@"conditionallyInsertRecord" sql:^NSString *{
+            return [NSString stringWithFormat:
+                    @"INSERT INTO %@ ( \
+                    %@, \
+                    %@, \
+                    %@, \
+                    %@, \
+                    %@, \
+                    %@, \
+                    %@, \
+                    %@, \
+                    %@, \
+                    %@ \
+                    ) VALUES ( \
+                    ?, \
+                    ?, \
+                    ?, \
+                    ?, \
+                    ?, \
+                    ?, \
+                    ?, \
+                    ?, \
+                    ?, \
+                    ? \
+                    )",
+
+                    AWSCognitoDefaultSqliteDataTableName,
+
+                    AWSCognitoTableRecordKeyName,
+                    AWSCognitoLastModifiedFieldName,
+                    AWSCognitoModifiedByFieldName,
+                    AWSCognitoRecordValueName,
+                    AWSCognitoTypeFieldName,
+                    AWSCognitoSyncCountFieldName,
+                    AWSCognitoTableIdentityKeyName,
+                    AWSCognitoTableDatasetKeyName,
+                    AWSCognitoDirtyFieldName,
+                    AWSCognitoRecordSizeFieldName];
+        }];
+        
+        if(statement) {
             sqlite3_bind_text(statement, 1, recordID, -1, SQLITE_TRANSIENT);
             sqlite3_bind_int64(statement, 2, lastModified);
             sqlite3_bind_text(statement, 3, modifiedBy, -1, SQLITE_TRANSIENT);
@@ -900,6 +1377,7 @@
             sqlite3_bind_text(statement, 7, identityIdChars, -1, SQLITE_TRANSIENT);
             sqlite3_bind_text(statement, 8, datasetNameChars, -1, SQLITE_TRANSIENT);
             sqlite3_bind_int64(statement, 9, 0);
+            sqlite3_bind_int64(statement, 10, [record size]);
             
             
             if(SQLITE_DONE != sqlite3_step(statement)) {
@@ -907,7 +1385,7 @@
                 if(error != nil) {
                     *error = [AWSCognitoUtil errorLocalDataStorageFailed:[NSString stringWithFormat:@"%s", sqlite3_errmsg(self.sqlite)]];
                 }
-                [self resetStatement:statement];
+                [self finishStatement:statement];
                 return NO;
             }
         }
@@ -916,59 +1394,17 @@
             if(error != nil) {
                 *error = [AWSCognitoUtil errorLocalDataStorageFailed:[NSString stringWithFormat:@"%s", sqlite3_errmsg(self.sqlite)]];
             }
-            [self resetStatement:statement];
+            [self finishStatement:statement];
             return NO;
         }
     }
     
-    [self resetStatement:statement];
+    [self finishStatement:statement];
     return YES;
 }
 
-/**
- * Resets and finalizes a statement
- **/
-- (void)resetStatement:(sqlite3_stmt *) statement {
-    sqlite3_reset(statement);
-    sqlite3_finalize(statement);
-}
-
 - (BOOL)conditionallyPutResolvedRecords:(NSArray *) resolvedRecords datasetName:(NSString*)datasetName error:(NSError **)error {
-    sqlite3_stmt *statement = nil;
-    NSString *sqlString = [NSString stringWithFormat:
-                           @"UPDATE %@ SET \
-                           %@ = ?, \
-                           %@ = ?, \
-                           %@ = ?, \
-                           %@ = ?, \
-                           %@ = ?, \
-                           %@ = ? \
-                           WHERE %@ = ? \
-                           AND %@ = ? \
-                           AND %@ = ? \
-                           AND %@ = ? \
-                           AND %@ = ? \
-                           AND %@ = ? \
-                           AND %@ = ? \
-                           AND %@ = ? \
-                           ",
-                           
-                           AWSCognitoDefaultSqliteDataTableName,
-                           AWSCognitoLastModifiedFieldName,
-                           AWSCognitoModifiedByFieldName,
-                           AWSCognitoRecordValueName,
-                           AWSCognitoTypeFieldName,
-                           AWSCognitoSyncCountFieldName,
-                           AWSCognitoDirtyFieldName,
-                           
-                           AWSCognitoTableRecordKeyName,
-                           AWSCognitoLastModifiedFieldName,
-                           AWSCognitoModifiedByFieldName,
-                           AWSCognitoRecordValueName,
-                           AWSCognitoSyncCountFieldName,
-                           AWSCognitoDirtyFieldName,
-                           AWSCognitoTableIdentityKeyName,
-                           AWSCognitoTableDatasetKeyName];
+    sqlite3_stmt *statement = [self conditionallyUpdateRecordStatement];
     
     for(AWSCognitoResolvedConflict *resolved in resolvedRecords){
         AWSCognitoRecord * currentState = resolved.conflict.localRecord;
@@ -986,7 +1422,7 @@
         const char *currentModifiedBy = [currentState.lastModifiedBy UTF8String];
         const char *currentData = [[currentState.data toJsonString] UTF8String];
         
-        if(sqlite3_prepare_v2(self.sqlite, [sqlString UTF8String], -1, &statement, NULL) == SQLITE_OK)
+        if(statement)
         {
             sqlite3_bind_int64(statement, 1, lastModified);
             
@@ -995,15 +1431,16 @@
             sqlite3_bind_int64(statement, 4, record.data.type);
             sqlite3_bind_int64(statement, 5, record.syncCount);
             sqlite3_bind_int64(statement, 6, record.dirtyCount);
+            sqlite3_bind_int64(statement, 7, [record size]);
             
-            sqlite3_bind_text(statement, 7, recordID, -1, SQLITE_TRANSIENT);
-            sqlite3_bind_int64(statement, 8, currentLastModified);
-            sqlite3_bind_text(statement, 9, currentModifiedBy, -1, SQLITE_TRANSIENT);
-            sqlite3_bind_text(statement, 10, currentData, -1, SQLITE_TRANSIENT);
-            sqlite3_bind_int64(statement, 11, currentState.syncCount);
-            sqlite3_bind_int64(statement, 12, currentState.dirtyCount);
-            sqlite3_bind_text(statement, 13, identityIdChars, -1, SQLITE_TRANSIENT);
-            sqlite3_bind_text(statement, 14, datasetNameChars, -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(statement, 8, recordID, -1, SQLITE_TRANSIENT);
+            sqlite3_bind_int64(statement, 9, currentLastModified);
+            sqlite3_bind_text(statement, 10, currentModifiedBy, -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(statement, 11, currentData, -1, SQLITE_TRANSIENT);
+            sqlite3_bind_int64(statement, 12, currentState.syncCount);
+            sqlite3_bind_int64(statement, 13, currentState.dirtyCount);
+            sqlite3_bind_text(statement, 14, identityIdChars, -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(statement, 15, datasetNameChars, -1, SQLITE_TRANSIENT);
             
             if(SQLITE_DONE != sqlite3_step(statement)){
                 AWSDDLogInfo(@"Error while updating data: %s", sqlite3_errmsg(self.sqlite));
@@ -1011,14 +1448,14 @@
                 {
                     *error = [AWSCognitoUtil errorLocalDataStorageFailed:[NSString stringWithFormat:@"%s", sqlite3_errmsg(self.sqlite)]];
                 }
-                [self resetStatement:statement];
+                [self finishStatement:statement];
                 return NO;
             }
         }
         
         sqlite3_reset(statement);
     }
-    sqlite3_finalize(statement);
+    [self finishStatement:statement];
     return YES;
 }
 
@@ -1039,36 +1476,41 @@
         const char *datasetNameChars = [datasetName UTF8String];
         const char *identityIdChars = [[self identityId] UTF8String];
 
-        NSString *sqlString = [NSString stringWithFormat:
-                               @"UPDATE %@ SET \
-                               %@ = %lld, \
-                               %@ = ?, \
-                               %@ = ?, \
-                               %@ = ?, \
-                               %@ = ? \
-                               WHERE %@ = ? AND %@ = ? AND %@ = ?",
-                               AWSCognitoDefaultSqliteDataTableName,
-
-                               AWSCognitoDirtyFieldName,
-                               AWSCognitoNotSyncedDeletedRecordDirty,
-
-                               AWSCognitoModifiedByFieldName,
-                               AWSCognitoLastModifiedFieldName,
-                               AWSCognitoRecordValueName,
-                               AWSCognitoTypeFieldName,
-                               AWSCognitoTableRecordKeyName,
-                               AWSCognitoTableIdentityKeyName,
-                               AWSCognitoTableDatasetKeyName];
-
-        if(sqlite3_prepare_v2(self.sqlite, [sqlString UTF8String], -1, &statement, NULL) == SQLITE_OK)
+        statement = [self statementForKey:@"flagRecordAsDeleted" sql:^NSString *{
+            return [NSString stringWithFormat:
+                    @"UPDATE %@ SET \
+                    %@ = %lld, \
+                    %@ = ?, \
+                    %@ = ?, \
+                    %@ = ?, \
+                    %@ = ?, \
+                    %@ = ? \
+                    WHERE %@ = ? AND %@ = ? AND %@ = ?",
+                    AWSCognitoDefaultSqliteDataTableName,
+
+                    AWSCognitoDirtyFieldName,
+                    AWSCognitoNotSyncedDeletedRecordDirty,
+
+                    AWSCognitoModifiedByFieldName,
+                    AWSCognitoLastModifiedFieldName,
+                    AWSCognitoRecordValueName,
+                    AWSCognitoTypeFieldName,
+                    AWSCognitoRecordSizeFieldName,
+                    AWSCognitoTableRecordKeyName,
+                    AWSCognitoTableIdentityKeyName,
+                    AWSCognitoTableDatasetKeyName];
+        }];
+
+        if(statement)
         {
             sqlite3_bind_text(statement, 1, lastModifiedBy, -1, SQLITE_TRANSIENT);
             sqlite3_bind_int64(statement, 2, lastModified);
             sqlite3_bind_text(statement, 3, data, -1, SQLITE_TRANSIENT);
             sqlite3_bind_int64(statement, 4, value.type);
-            sqlite3_bind_text(statement, 5, recordID, -1, SQLITE_TRANSIENT);
-            sqlite3_bind_text(statement, 6, identityIdChars, -1, SQLITE_TRANSIENT);
-            sqlite3_bind_text(statement, 7, datasetNameChars, -1, SQLITE_TRANSIENT);
+            sqlite3_bind_int64(statement, 5, [[[AWSCognitoRecord alloc] initWithId:recordId data:value] size]);
+            sqlite3_bind_text(statement, 6, recordID, -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(statement, 7, identityIdChars, -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(statement, 8, datasetNameChars, -1, SQLITE_TRANSIENT);
             
             if(SQLITE_DONE == sqlite3_step(statement))
             {
@@ -1092,8 +1534,7 @@
             }
         }
 
-        sqlite3_reset(statement);
-        sqlite3_finalize(statement);
+        [self finishStatement:statement];
     });
 
     return result;
@@ -1107,13 +1548,14 @@
         const char *datasetNameChars = [datasetName UTF8String];
         const char *identityIdChars = [[self identityId] UTF8String];
         
-        NSString *statementString = [NSString stringWithFormat:@"DELETE FROM %@ WHERE %@ = ? AND %@ = ? AND %@ = ?",
-                                     AWSCognitoDefaultSqliteDataTableName,
-                                     AWSCognitoTableRecordKeyName,
-                                     AWSCognitoTableIdentityKeyName,
-                                     AWSCognitoTableDatasetKeyName];
-        sqlite3_stmt *statement;
-        if(sqlite3_prepare_v2(self.sqlite, [statementString UTF8String], -1, &statement, NULL) == SQLITE_OK)
+        sqlite3_stmt *statement = [self statementForKey:@"deleteRecordById" sql:^NSString *{
+            return [NSString stringWithFormat:@"DELETE FROM %@ WHERE %@ = ? AND %@ = ? AND %@ = ?",
+                    AWSCognitoDefaultSqliteDataTableName,
+                    AWSCognitoTableRecordKeyName,
+                    AWSCognitoTableIdentityKeyName,
+                    AWSCognitoTableDatasetKeyName];
+        }];
+        if(statement)
         {
             sqlite3_bind_text(statement, 1, [recordId UTF8String], -1, SQLITE_TRANSIENT);
             sqlite3_bind_text(statement, 2, identityIdChars, -1, SQLITE_TRANSIENT);
@@ -1141,8 +1583,7 @@
             }
         }
 
-        sqlite3_reset(statement);
-        sqlite3_finalize(statement);
+        [self finishStatement:statement];
     });
 
     return result;
@@ -1236,15 +1677,15 @@
 {
     __block int64_t numRecords = 0;
     
-    dispatch_sync(self.dispatchQueue, ^{
-        NSString *query = [NSString stringWithFormat:@"SELECT COUNT(*) FROM %@ WHERE %@=? AND %@ = ?",
-                           AWSCognitoDefaultSqliteDataTableName,
-                           AWSCognitoTableDatasetKeyName,
-                           AWSCognitoTableIdentityKeyName];
-        
-        sqlite3_stmt *statement;
-        
-        if(sqlite3_prepare_v2(self.sqlite, [query UTF8String], -1, &statement, NULL) == SQLITE_OK)
+    [self performRead:^(sqlite3 *connection, NSMutableDictionary<NSString *, NSValue *> *statements) {
+        sqlite3_stmt *statement = [self statementForKey:@"numRecords" connection:connection statements:statements sql:^NSString *{
+            return [NSString stringWithFormat:@"SELECT COUNT(*) FROM %@ WHERE %@=? AND %@ = ?",
+                    AWSCognitoDefaultSqliteDataTableName,
+                    AWSCognitoTableDatasetKeyName,
+                    AWSCognitoTableIdentityKeyName];
+        }];
+        
+        if(statement)
         {
             sqlite3_bind_text(statement, 1, [datasetName UTF8String], -1, SQLITE_TRANSIENT);
             sqlite3_bind_text(statement, 2, [[self identityId] UTF8String], -1, SQLITE_TRANSIENT);
@@ -1256,16 +1697,50 @@
         }
         else
         {
-            AWSDDLogInfo(@"Error creating num records count statement: %s", sqlite3_errmsg(self.sqlite));
+            AWSDDLogInfo(@"Error creating num records count statement: %s", sqlite3_errmsg(connection));
         }
         
-        sqlite3_reset(statement);
-        sqlite3_finalize(statement);
-    });
+        [self finishStatement:statement];
+    }];
     
     return [NSNumber numberWithLongLong:numRecords];
 }
 
+//Gets the size in bytes of the records stored in SQLite, as kept up to date by the size triggers
+- (NSNumber *)datasetSize:(NSString *)datasetName
+{
+    __block int64_t size = 0;
+
+    [self performRead:^(sqlite3 *connection, NSMutableDictionary<NSString *, NSValue *> *statements) {
+        sqlite3_stmt *statement = [self statementForKey:@"datasetSize" connection:connection statements:statements sql:^NSString *{
+            return [NSString stringWithFormat:@"SELECT %@ FROM %@ WHERE %@=? AND %@ = ?",
+                    AWSCognitoRecordSizeFieldName,
+                    AWSCognitoDefaultSqliteSizeTableName,
+                    AWSCognitoTableDatasetKeyName,
+                    AWSCognitoTableIdentityKeyName];
+        }];
+
+        if(statement)
+        {
+            sqlite3_bind_text(statement, 1, [datasetName UTF8String], -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(statement, 2, [[self identityId] UTF8String], -1, SQLITE_TRANSIENT);
+
+            if (sqlite3_step(statement)==SQLITE_ROW)
+            {
+                size = sqlite3_column_int64(statement, 0);
+            }
+        }
+        else
+        {
+            AWSDDLogInfo(@"Error creating dataset size statement: %s", sqlite3_errmsg(connection));
+        }
+
+        [self finishStatement:statement];
+    }];
+
+    return [NSNumber numberWithLongLong:size];
+}
+
 #pragma mark - Sync table utilities
 
 //Gets last sync count stored in SQLite
@@ -1273,16 +1748,16 @@
 {
     __block int64_t lastSyncCount = 0;
 
-    dispatch_sync(self.dispatchQueue, ^{
-        NSString *query = [NSString stringWithFormat:@"SELECT %@ FROM %@ WHERE %@=? AND %@ = ?",
-                           AWSCognitoLastSyncCount,
-                           AWSCognitoDefaultSqliteMetadataTableName,
-                           AWSCognitoTableDatasetKeyName,
-                           AWSCognitoTableIdentityKeyName];
-
-        sqlite3_stmt *statement;
+    [self performRead:^(sqlite3 *connection, NSMutableDictionary<NSString *, NSValue *> *statements) {
+        sqlite3_stmt *statement = [self statementForKey:@"lastSyncCount" connection:connection statements:statements sql:^NSString *{
+            return [NSString stringWithFormat:@"SELECT %@ FROM %@ WHERE %@=? AND %@ = ?",
+                    AWSCognitoLastSyncCount,
+                    AWSCognitoDefaultSqliteMetadataTableName,
+                    AWSCognitoTableDatasetKeyName,
+                    AWSCognitoTableIdentityKeyName];
+        }];
 
-        if(sqlite3_prepare_v2(self.sqlite, [query UTF8String], -1, &statement, NULL) == SQLITE_OK)
+        if(statement)
         {
             sqlite3_bind_text(statement, 1, [datasetName UTF8String], -1, SQLITE_TRANSIENT);
             sqlite3_bind_text(statement, 2, [[self identityId] UTF8String], -1, SQLITE_TRANSIENT);
@@ -1294,12 +1769,11 @@
         }
         else
         {
-            AWSDDLogInfo(@"Error creating query sync count statement: %s", sqlite3_errmsg(self.sqlite));
+            AWSDDLogInfo(@"Error creating query sync count statement: %s", sqlite3_errmsg(connection));
         }
 
-        sqlite3_reset(statement);
-        sqlite3_finalize(statement);
-    });
+        [self finishStatement:statement];
+    }];
 
     return [NSNumber numberWithLongLong:lastSyncCount];
 }
@@ -1311,15 +1785,16 @@
     }
     
     dispatch_sync(self.dispatchQueue, ^{
-        NSString *sqlString = [NSString stringWithFormat:@"INSERT OR REPLACE INTO %@(%@,%@,%@,%@) VALUES (?,?,?,?)",
-                               AWSCognitoDefaultSqliteMetadataTableName,
-                               AWSCognitoTableDatasetKeyName,
-                               AWSCognitoLastSyncCount,
-                               AWSCognitoTableIdentityKeyName,
-                               AWSCognitoModifiedByFieldName];
-        sqlite3_stmt *statement;
-
-        if(sqlite3_prepare_v2(self.sqlite, [sqlString UTF8String], -1, &statement, NULL) == SQLITE_OK)
+        sqlite3_stmt *statement = [self statementForKey:@"updateLastSyncCount" sql:^NSString *{
+            return [NSString stringWithFormat:@"INSERT OR REPLACE INTO %@(%@,%@,%@,%@) VALUES (?,?,?,?)",
+                    AWSCognitoDefaultSqliteMetadataTableName,
+                    AWSCognitoTableDatasetKeyName,
+                    AWSCognitoLastSyncCount,
+                    AWSCognitoTableIdentityKeyName,
+                    AWSCognitoModifiedByFieldName];
+        }];
+
+        if(statement)
         {
             sqlite3_bind_text(statement, 1, [datasetName UTF8String], -1, SQLITE_TRANSIENT);
             sqlite3_bind_int64(statement, 2, [syncCount longLongValue]);
@@ -1336,8 +1811,7 @@
         {
             AWSDDLogInfo(@"Error updating sync count: %s", sqlite3_errmsg(self.sqlite));
         }
-        sqlite3_reset(statement);
-        sqlite3_finalize(statement);
+        [self finishStatement:statement];
     });
 }
 
@@ -1767,6 +2241,22 @@
 - (void)deleteSQLiteDatabase
 {
     dispatch_sync(self.dispatchQueue, ^{
+        // Close both connections before their files go away, so no cached statement
+        // or open handle outlives the database. Reads wait on the read queue meanwhile.
+        dispatch_sync(self.readQueue, ^{
+            [self finalizeStatements:self.readStatements];
+            if (self.readSqlite) {
+                sqlite3_close(self.readSqlite);
+                self.readSqlite = NULL;
+            }
+        });
+        [self finalizeStatements:self.statements];
+        if (self.sqlite) {
+            sqlite3_close(self.sqlite);
+            self.sqlite = NULL;
+        }
+        self.walEnabled = NO;
+
         if([[NSFileManager defaultManager] fileExistsAtPath:[self filePath]])
         {
             NSError *error;
@@ -1775,6 +2265,20 @@
                 AWSDDLogDebug(@"Error deleting DB file %@", error);
             }
         }
+        for (NSString *suffix in @[@"-wal", @"-shm"]) {
+            NSString *path = [[self filePath] stringByAppendingString:suffix];
+            if([[NSFileManager defaultManager] fileExistsAtPath:path])
+            {
+                [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+            }
+        }
+
+        // Start over with an empty database, the same as a new manager.
+        [self setupSQL];
+        [self createTables];
+        dispatch_sync(self.readQueue, ^{
+            [self setupReadSQL];
+        });
     });
 }
 
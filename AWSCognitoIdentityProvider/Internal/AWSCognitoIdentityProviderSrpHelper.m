@@ -33,15 +33,204 @@ AWSJKBigInteger* finalizeSignedBigIntHash(CC_SHA256_CTX *ctx);
 
 static NSString* N_IN_HEX = @"FFFFFFFFFFFFFFFFC90FDAA22168C234C4C6628B80DC1CD129024E088A67CC74020BBEA63B139B22514A08798E3404DDEF9519B3CD3A431B302B0A6DF25F14374FE1356D6D51C245E485B576625E7EC6F44C42E9A637ED6B0BFF5CB6F406B7EDEE386BFB5A899FA5AE9F24117C4B1FE649286651ECE45B3DC2007CB8A163BF0598DA48361C55D39A69163FA8FD24CF5F83655D23DCA3AD961C62F356208552BB9ED529077096966D670C354E4ABC9804F1746C08CA18217C32905E462E36CE3BE39E772C180E86039B2783A2EC07A28FB5C55DF06F4C52C9DE2BCBF6955817183995497CEA956AE515D2261898FA051015728E5A8AAAC42DAD33170D04507A33A85521ABDF1CBA64ECFB850458DBEF0A8AEA71575D060C7DB3970F85A6E1E4C7ABF5AE8CDB0933D71E8C94E04A25619DCEE3D2261AD2EE6BF12FFA06D98A0864D87602733EC86A64521F2B18177B200CBBE117577A615D6C770988C0BAD946E208E24FA074E5AB3143DB5BFCE0FD108E4B82D120A93AD2CAFFFFFFFFFFFFFFFF";
 
+#pragma mark - Fixed-base exponentiation
+
+// Exponents of up to this many bits use the fixed-base table; private keys and x are 256 bits.
+#define AWS_SRP_FIXED_BASE_MAX_EXPONENT_BITS 256
+#define AWS_SRP_FIXED_BASE_WINDOW_BITS 4
+#define AWS_SRP_FIXED_BASE_TABLE_SIZE (AWS_SRP_FIXED_BASE_MAX_EXPONENT_BITS / AWS_SRP_FIXED_BASE_WINDOW_BITS)
+
+// g^(2^(4i)) mod N for every 4-bit window i of an exponent, kept in Montgomery form, so that g^e mod N takes
+// about 80 Montgomery multiplications (Yao's method) instead of the 256 squarings of a sliding window.
+typedef struct {
+    aws_mp_int N;
+    aws_mp_int g;
+    aws_mp_digit rho;
+    aws_mp_int one;
+    aws_mp_int table[AWS_SRP_FIXED_BASE_TABLE_SIZE];
+} AWSSrpFixedBase;
+
+// c = a * b * R^-1 mod N, with c distinct from a and b.
+static int awsSrpMontgomeryMultiply(AWSSrpFixedBase *base, aws_mp_int *a, aws_mp_int *b, aws_mp_int *c) {
+    int err = aws_mp_mul(a, b, c);
+    if (err != AWS_MP_OKAY) {
+        return err;
+    }
+    return aws_mp_montgomery_reduce(c, &base->N, base->rho);
+}
+
+static int awsSrpFixedBaseInit(AWSSrpFixedBase *base, aws_mp_int *N, aws_mp_int *g) {
+    int err = AWS_MP_OKAY;
+    if ((err = aws_mp_init_copy(&base->N, N)) != AWS_MP_OKAY
+        || (err = aws_mp_init_copy(&base->g, g)) != AWS_MP_OKAY
+        || (err = aws_mp_init(&base->one)) != AWS_MP_OKAY
+        || (err = aws_mp_montgomery_setup(&base->N, &base->rho)) != AWS_MP_OKAY
+        || (err = aws_mp_montgomery_calc_normalization(&base->one, &base->N)) != AWS_MP_OKAY) {
+        return err;
+    }
+
+    aws_mp_int square;
+    if ((err = aws_mp_init_size(&square, base->N.used * 2 + 1)) != AWS_MP_OKAY) {
+        return err;
+    }
+    for (int i = 0; i < AWS_SRP_FIXED_BASE_TABLE_SIZE && err == AWS_MP_OKAY; i++) {
+        if ((err = aws_mp_init_size(&base->table[i], base->N.used * 2 + 1)) != AWS_MP_OKAY) {
+            break;
+        }
+        if (i == 0) {
+            // g * R mod N
+            err = aws_mp_mulmod(g, &base->one, &base->N, &base->table[0]);
+            continue;
+        }
+        err = aws_mp_copy(&base->table[i - 1], &base->table[i]);
+        for (int j = 0; j < AWS_SRP_FIXED_BASE_WINDOW_BITS && err == AWS_MP_OKAY; j++) {
+            if ((err = aws_mp_sqr(&base->table[i], &square)) == AWS_MP_OKAY
+                && (err = aws_mp_montgomery_reduce(&square, &base->N, base->rho)) == AWS_MP_OKAY) {
+                aws_mp_exch(&square, &base->table[i]);
+            }
+        }
+    }
+    aws_mp_clear(&square);
+    return err;
+}
+
+// Y = g^X mod N. Exponents the table does not cover fall back to the generic exponentiation.
+static int awsSrpFixedBaseExptmod(AWSSrpFixedBase *base, aws_mp_int *X, aws_mp_int *Y) {
+    if (X->sign == AWS_MP_NEG || aws_mp_count_bits(X) > AWS_SRP_FIXED_BASE_MAX_EXPONENT_BITS) {
+        return aws_mp_exptmod(&base->g, X, &base->N, Y);
+    }
+
+    uint8_t exponent[AWS_SRP_FIXED_BASE_MAX_EXPONENT_BITS / 8] = {0};
+    int err = aws_mp_to_unsigned_bin(X, exponent + sizeof(exponent) - aws_mp_unsigned_bin_size(X));
+    if (err != AWS_MP_OKAY) {
+        return err;
+    }
+
+    // A accumulates the product over window values j of B_j, the product of the table entries whose window is at least j.
+    aws_mp_int A, B, product;
+    if ((err = aws_mp_init_size(&A, base->N.used * 2 + 1)) != AWS_MP_OKAY) {
+        return err;
+    }
+    if ((err = aws_mp_init_size(&B, base->N.used * 2 + 1)) != AWS_MP_OKAY) {
+        aws_mp_clear(&A);
+        return err;
+    }
+    if ((err = aws_mp_init_size(&product, base->N.used * 2 + 1)) != AWS_MP_OKAY) {
+        aws_mp_clear_multi(&A, &B, NULL);
+        return err;
+    }
+
+    BOOL isAOne = YES;
+    BOOL isBOne = YES;
+    for (int j = (1 << AWS_SRP_FIXED_BASE_WINDOW_BITS) - 1; j > 0 && err == AWS_MP_OKAY; j--) {
+        for (int i = 0; i < AWS_SRP_FIXED_BASE_TABLE_SIZE && err == AWS_MP_OKAY; i++) {
+            uint8_t byte = exponent[sizeof(exponent) - 1 - i / 2];
+            int window = (i % 2) ? (byte >> 4) : (byte & 0x0F);
+            if (window != j) {
+                continue;
+            }
+            if (isBOne) {
+                err = aws_mp_copy(&base->table[i], &B);
+                isBOne = NO;
+            } else if ((err = awsSrpMontgomeryMultiply(base, &B, &base->table[i], &product)) == AWS_MP_OKAY) {
+                aws_mp_exch(&B, &product);
+            }
+        }
+        if (isBOne || err != AWS_MP_OKAY) {
+            continue;
+        }
+        if (isAOne) {
+            err = aws_mp_copy(&B, &A);
+            isAOne = NO;
+        } else if ((err = awsSrpMontgomeryMultiply(base, &A, &B, &product)) == AWS_MP_OKAY) {
+            aws_mp_exch(&A, &product);
+        }
+    }
+
+    if (err == AWS_MP_OKAY) {
+        if (isAOne) {
+            aws_mp_set(Y, 1);
+        } else if ((err = aws_mp_montgomery_reduce(&A, &base->N, base->rho)) == AWS_MP_OKAY) {
+            // Leaves Montgomery form.
+            err = aws_mp_copy(&A, Y);
+        }
+    }
+    aws_mp_clear_multi(&A, &B, &product, NULL);
+    return err;
+}
+
+// The table for the RFC 5054 group used by Cognito, built on first use.
+static AWSSrpFixedBase *awsSrpDefaultFixedBase(void) {
+    static AWSSrpFixedBase fixedBase;
+    static AWSSrpFixedBase *result = NULL;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        AWSCognitoIdentityProviderSrpCommonState *commonState = [AWSCognitoIdentityProviderSrpCommonState new];
+        if (awsSrpFixedBaseInit(&fixedBase, [commonState.N value], [commonState.g value]) == AWS_MP_OKAY) {
+            result = &fixedBase;
+        } else {
+            AWSDDLogError(@"Failed to build the SRP fixed-base table.");
+        }
+    });
+    return result;
+}
+
+// Y = g^X mod N, through the fixed-base table when N and g are the default group.
+static int awsSrpExptmodG(aws_mp_int *g, aws_mp_int *X, aws_mp_int *N, aws_mp_int *Y) {
+    AWSSrpFixedBase *fixedBase = awsSrpDefaultFixedBase();
+    if (fixedBase && aws_mp_cmp(N, &fixedBase->N) == AWS_MP_EQ && aws_mp_cmp(g, &fixedBase->g) == AWS_MP_EQ) {
+        return awsSrpFixedBaseExptmod(fixedBase, X, Y);
+    }
+    return aws_mp_exptmod(g, X, N, Y);
+}
+
+#pragma mark - Hashing without intermediate objects
+
+// Hashes a non-negative value the way +[NSData aws_dataWithSignedBigInteger:] serializes it: big-endian, with a
+// leading zero byte only when the top bit of a multi-byte value is set. Negative values go through NSData.
+static void awsSrpUpdateHashWithSignedBigInt(CC_SHA256_CTX *ctx, AWSJKBigInteger *bigInt) {
+    aws_mp_int *value = [bigInt value];
+    if (value->sign == AWS_MP_NEG) {
+        NSData *data = [NSData aws_dataWithSignedBigInteger:bigInt];
+        CC_SHA256_Update(ctx, data.bytes, (CC_LONG)data.length);
+        return;
+    }
+
+    // 3072-bit values and a sign byte fit on the stack.
+    uint8_t stackBuffer[512];
+    int byteCount = aws_mp_unsigned_bin_size(value);
+    uint8_t *buffer = byteCount + 1 <= (int)sizeof(stackBuffer) ? stackBuffer : malloc((size_t)byteCount + 1);
+    buffer[0] = 0;
+    aws_mp_to_unsigned_bin(value, buffer + 1);
+    if (byteCount > 1 && (buffer[1] & 0x80) == 0x80) {
+        CC_SHA256_Update(ctx, buffer, (CC_LONG)byteCount + 1);
+    } else {
+        CC_SHA256_Update(ctx, buffer + 1, (CC_LONG)byteCount);
+    }
+    if (buffer != stackBuffer) {
+        free(buffer);
+    }
+}
+
 #pragma mark - Srp State
 @implementation AWSCognitoIdentityProviderSrpCommonState
 - (instancetype)init {
     if (self = [super init]) {
-            self.N = [[AWSJKBigInteger alloc] initWithString:N_IN_HEX
-                                               andRadix:16];
-
-            self.g = [[AWSJKBigInteger alloc] initWithUnsignedLong:2l];
-            self.k = [self calculateK:self.N g:self.g];
+        // AWSJKBigInteger is immutable, so every default state shares one parse of N and one hash for k.
+        static AWSJKBigInteger *defaultN = nil;
+        static AWSJKBigInteger *defaultG = nil;
+        static AWSJKBigInteger *defaultK = nil;
+        static dispatch_once_t onceToken;
+        dispatch_once(&onceToken, ^{
+            defaultN = [[AWSJKBigInteger alloc] initWithString:N_IN_HEX
+                                                      andRadix:16];
+            defaultG = [[AWSJKBigInteger alloc] initWithUnsignedLong:2l];
+            defaultK = [self calculateK:defaultN g:defaultG];
+        });
+
+        self.N = defaultN;
+        self.g = defaultG;
+        self.k = defaultK;
     }
     return self;
 }
@@ -188,12 +377,10 @@ static NSString* N_IN_HEX = @"FFFFFFFFFFFFFFFFC90FDAA22168C234C4C6628B80DC1CD129
                               password:password
                               salt:self.salt];
 
-        AWSJKBigInteger *N = [[AWSJKBigInteger alloc] initWithString:N_IN_HEX
-                                       andRadix:16];
-        AWSJKBigInteger *g = [[AWSJKBigInteger alloc] initWithUnsignedLong:2l];
-        
+        AWSCognitoIdentityProviderSrpCommonState *commonState = [AWSCognitoIdentityProviderSrpCommonState new];
+
         //calculate v
-        self.v = [g pow:x andMod:N];
+        self.v = [AWSCognitoIdentityProviderSrpHelper generatePublicABigInt:x N:commonState.N g:commonState.g];
     }
     return self;
 }
@@ -269,21 +456,35 @@ static NSString* N_IN_HEX = @"FFFFFFFFFFFFFFFFC90FDAA22168C234C4C6628B80DC1CD129
     
     self.u = [AWSCognitoIdentityProviderSrpHelper hashBigInts:@[self.clientState.publicA, B]];
 
-    AWSJKBigInteger *k = self.commonState.k;
-    AWSJKBigInteger *g = self.commonState.g;
-    AWSJKBigInteger *N = self.commonState.N;
+    aws_mp_int *k = [self.commonState.k value];
+    aws_mp_int *g = [self.commonState.g value];
+    aws_mp_int *N = [self.commonState.N value];
+    aws_mp_int *a = [self.clientState.privateA value];
 
-    AWSJKBigInteger *a = self.clientState.privateA;
-    AWSJKBigInteger *exp = [a add:[self.u multiply:self.x]];
-    AWSJKBigInteger *base = [B subtract:[k multiply:[g pow:self.x andMod:N]]];
+    // Work on the digits directly; only S is wrapped in an object at the end.
+    aws_mp_int base, exp, S;
+    if (aws_mp_init_multi(&base, &exp, &S, NULL) != AWS_MP_OKAY) {
+        return nil;
+    }
 
-    //Need this for negative base #s
-    base = [AWSCognitoIdentityProviderSrpHelper mod:base divisor:N];
+    // base = (B - k * g^x) mod N; submod already leaves a negative difference in [0, N).
+    // exp = a + u * x
+    int err = AWS_MP_OKAY;
+    if ((err = awsSrpExptmodG(g, [self.x value], N, &S)) != AWS_MP_OKAY
+        || (err = aws_mp_mulmod(k, &S, N, &base)) != AWS_MP_OKAY
+        || (err = aws_mp_submod([B value], &base, N, &base)) != AWS_MP_OKAY
+        || (err = aws_mp_mul([self.u value], [self.x value], &exp)) != AWS_MP_OKAY
+        || (err = aws_mp_add(a, &exp, &exp)) != AWS_MP_OKAY
+        || (err = aws_mp_exptmod(&base, &exp, N, &S)) != AWS_MP_OKAY) {
+        AWSDDLogError(@"Failed to calculate S: %d", err);
+        aws_mp_clear_multi(&base, &exp, &S, NULL);
+        return nil;
+    }
 
-    AWSJKBigInteger *S = [base pow:exp andMod:N];
-    S = [AWSCognitoIdentityProviderSrpHelper mod:S divisor:N];
-    
-    return S;
+    AWSJKBigInteger *result = [[AWSJKBigInteger alloc] initWithValue:&S];
+    aws_mp_clear_multi(&base, &exp, &S, NULL);
+
+    return result;
 }
 
 + (NSString *)generateDateString:(NSDate *)date {
@@ -301,12 +502,30 @@ static NSString* N_IN_HEX = @"FFFFFFFFFFFFFFFFC90FDAA22168C234C4C6628B80DC1CD129
 }
 
 + (AWSJKBigInteger*) generatePublicABigInt:(AWSJKBigInteger*)privateA N:(AWSJKBigInteger*)N g:(AWSJKBigInteger*)g {
-    AWSJKBigInteger *publicA = [g pow:privateA andMod:N];
-    return publicA;
+    aws_mp_int publicA;
+    aws_mp_init(&publicA);
+    if (awsSrpExptmodG([g value], [privateA value], [N value], &publicA) != AWS_MP_OKAY) {
+        aws_mp_clear(&publicA);
+        return nil;
+    }
+
+    AWSJKBigInteger *result = [[AWSJKBigInteger alloc] initWithValue:&publicA];
+    aws_mp_clear(&publicA);
+    return result;
 }
 
 + (AWSJKBigInteger*) mod:(AWSJKBigInteger*)dividend divisor:(AWSJKBigInteger*) divisor {
-    return [[divisor add:[dividend remainder:divisor]] remainder:divisor];
+    // aws_mp_mod already returns a value in [0, divisor) for negative dividends.
+    aws_mp_int remainder;
+    aws_mp_init(&remainder);
+    if (aws_mp_mod([dividend value], [divisor value], &remainder) != AWS_MP_OKAY) {
+        aws_mp_clear(&remainder);
+        return nil;
+    }
+
+    AWSJKBigInteger *result = [[AWSJKBigInteger alloc] initWithValue:&remainder];
+    aws_mp_clear(&remainder);
+    return result;
 }
 
 #pragma mark - Hashing
@@ -316,8 +535,7 @@ static NSString* N_IN_HEX = @"FFFFFFFFFFFFFFFFC90FDAA22168C234C4C6628B80DC1CD129
     CC_SHA256_Init(&ctx);
     
     for (AWSJKBigInteger *i in bigInts) {
-        NSData *data = [NSData aws_dataWithSignedBigInteger:i];
-        CC_SHA256_Update(&ctx, data.bytes, (CC_LONG)data.length);        
+        awsSrpUpdateHashWithSignedBigInt(&ctx, i);
     }
     
     return finalizeSignedBigIntHash(&ctx);
@@ -414,12 +632,10 @@ AWSJKBigInteger* finalizeSignedBigIntHash(CC_SHA256_CTX *ctx) {
     CC_SHA256_Update(&identityHashCtx, [password UTF8String], (CC_LONG)[password lengthOfBytesUsingEncoding:NSUTF8StringEncoding]);
     CC_SHA256_Final(identityHash, &identityHashCtx);
     
-    NSData *saltData = [NSData aws_dataWithSignedBigInteger:salt];
-    
     uint8_t finalHash[CC_SHA256_DIGEST_LENGTH];
     CC_SHA256_CTX ctx;
     CC_SHA256_Init(&ctx);
-    CC_SHA256_Update(&ctx, saltData.bytes, (CC_LONG)saltData.length);
+    awsSrpUpdateHashWithSignedBigInt(&ctx, salt);
     CC_SHA256_Update(&ctx, identityHash, sizeof(identityHash));
     CC_SHA256_Final(finalHash, &ctx);
     return [NSData dataWithBytes:finalHash length:CC_SHA256_DIGEST_LENGTH];
@@ -438,10 +654,9 @@ AWSJKBigInteger* finalizeSignedBigIntHash(CC_SHA256_CTX *ctx) {
     CC_SHA256_Update(&identityHashCtx, password.UTF8String, (CC_LONG)[password lengthOfBytesUsingEncoding:NSUTF8StringEncoding]);
     CC_SHA256_Final(identityHash, &identityHashCtx);
     
-    NSData *saltData = [NSData aws_dataWithSignedBigInteger:salt];
     CC_SHA256_CTX ctx;
     CC_SHA256_Init(&ctx);
-    CC_SHA256_Update(&ctx, saltData.bytes, (CC_LONG)saltData.length);
+    awsSrpUpdateHashWithSignedBigInt(&ctx, salt);
     CC_SHA256_Update(&ctx, identityHash, sizeof(identityHash));
     
 
@@ -453,8 +668,7 @@ AWSJKBigInteger* finalizeSignedBigIntHash(CC_SHA256_CTX *ctx) {
     CC_SHA256_Init(&ctx);
     
     for (AWSJKBigInteger *i in bigInts) {
-        NSData *data = [NSData aws_dataWithSignedBigInteger:i];
-        CC_SHA256_Update(&ctx, data.bytes, (CC_LONG)data.length);
+        awsSrpUpdateHashWithSignedBigInt(&ctx, i);
     }
     
     return finalizeUnsignedBigIntHash(&ctx);
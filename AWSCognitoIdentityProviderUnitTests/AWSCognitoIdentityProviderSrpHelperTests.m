@@ -0,0 +1,207 @@
+//
+// Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+
+#import <XCTest/XCTest.h>
+#import <CommonCrypto/CommonDigest.h>
+#import "AWSCognitoIdentityProviderSrpHelper.h"
+#import "AWSJKBigInteger.h"
+#import "NSData+AWSCognitoIdentityProvider.h"
+
+// Known answers computed independently from the SRP-6a definitions Cognito uses (SHA-256, the RFC 5054 3072-bit group).
+static NSString *const AWSSrpTestsPrivateA = @"5c9d1b1a2e3f405162738495a6b7c8d9eaf0b1c2d3e4f5061728394a5b6c7d8e";
+static NSString *const AWSSrpTestsSalt = @"c4a1f2e3d4c5b6a79880796a5b4c3d2e";
+static NSString *const AWSSrpTestsPoolName = @"abcDEFghi";
+static NSString *const AWSSrpTestsUserName = @"testuser";
+static NSString *const AWSSrpTestsPassword = @"P@ssw0rd!";
+static NSString *const AWSSrpTestsK = @"538282c4354742d7cbbde2359fcf67f9f5b3a6b08791e5011b43b8a5b66d9ee6";
+static NSString *const AWSSrpTestsPublicA = @"4411505afb3d9200ee4ff2d23a06bf5d932e7fbef3990fe6a097726b339760cfb5446fa689df11ce22257584875aec42"
+                                            "413a7102d65ff68228f261dae8d53421f897c6804d70789f39c9bca83a07025fd81f05421ff9838c0589fb2fc63c5d42"
+                                            "6317c6d7948e21da404318e79af3c876d1f0836c5ffa93135d52985d6e501f377407a98edac2b6a11db2e4a490f63c00"
+                                            "32ae75e9d7364c1f55b91f9f3fc4a47277b70369b50c9bdb6835ca4de2e872fa388c9380077f6a4339c0fb8a050914cc"
+                                            "60d624b2e7aa130675d6df85728f2020ae183846bc41efb70f725c38fa571759c5a0d224488391059f2d6e8dcfb0f805"
+                                            "408b9066f0879a544bc5ae3d5c6d5b8cd407297250b8e53decc6e1238261df8480f4c9a9df0b63ea27b5f2740a412384"
+                                            "8034400c1dedaf22170c79fbd470d391d47a83959cec17cfd50e867fb9f1012012987e6dfda00b394bd67900351546ef"
+                                            "214f48e8e3eed262a4511c69781781ad6a0846b89cc8e4ee49a17c1dee85ba855467c5bab00c62552a1bf4d686129b0a";
+static NSString *const AWSSrpTestsPublicB = @"1df6e2ce1d1b7af701b28d5a146c85678c72c5e20c9748043795076a54ac3dbd9e0dc09a46f1db0d66108a8248f50c2d"
+                                            "5bef15a090bcdac6b8dc78171fb771a534441cbe83b8fb02ca63a091778bc7cdb64c3331b1340dade6510225efbebf4b"
+                                            "d30af99c7eda95090f1675c14bb9ed5e4f9fd963c1afeb8a2e4dcf39ca321bb29710e42fb948f7d438c7e74b591c78e8"
+                                            "5228184cb601658aa65493695084f9d8a1850efd6492714791c129858dd69831c4d90afa10b8a49e62280f3d33d56154"
+                                            "77212150b85ab198e5ba4d9e511b7e900b2f0fea32dd897fc32b1176fb21b76080279888de654b861984c7ac0a390832"
+                                            "12c26e387551907fb17f625db566deb404c1e7c9303981bc5d1a2744000c14ccc6347b52a2e81460f5a4a30052c881c8"
+                                            "123acde0d8ffcdcd1e0b90fc3c1be43be9f5e5b257f40fe476ff1eeaa25795389ea0e44791ca4ba686fe73a189d1dfd7"
+                                            "ee906f95817924249fc4cc0edb2bc8b027dd666e2643706c9f27bf1708b9cc818661c2bf24a5d4ef2971121e42bf14db";
+static NSString *const AWSSrpTestsX = @"462b0dcfde6f81e4dc3443bbc57c80db1d52a3fa27e0fc8719eb09c6ebeb90cf";
+static NSString *const AWSSrpTestsU = @"bbc66f577cfafef1e09baa819aad46bd115978970e82f86a80154ce3a1f4f0ca";
+static NSString *const AWSSrpTestsS = @"2306b93f3b6729e2d6ccfb54e0ba9dd5c54b549ba5b5a89a0ffe2728299c91afbb555d72964ed34d9325fdfa1df8316a"
+                                       "cd25c74b25c150b5f2198da1cc2e16c5a00ee08ba504b28f7f3b053f438cdd090af54b056a64f16d443b4165e216c2e2"
+                                       "58521e59cbbd4da8efb1bba049e46e307e7bbfe8581b2c9a3b2cb746d8e8e8c50c474c88349ebcf242d3b4d2c5714bc9"
+                                       "bcc4ac4dfbb9a8a6f0d6205e7d11564aac82817a110dffff5f73be517387d54a3a8a18a75c2f6e5c7c0f1a8e31fa9cbf"
+                                       "c6be1ea8f57ae11ef64af35b65fa5d635e68003ec1943d14e61e26d84fff57100d1b77bd13e8ca6d7e13254ec1d155be"
+                                       "f29883472b72ce04913ba08b2d5df8121c12e2e15ea81035d79aa73554e06b4ab85baffcdbc0d430d244c9e34ba406e8"
+                                       "d9835a72f8bc622f6cb6cb212466e15974bb8612178ffd4c5481d3f2072ad632dffe8fe8c0fccce3e4284661f03e804b"
+                                       "f4990240a0a671b05767f0fb55c93c263513c23aeae618b27c6f996016724f46acea5ad807ff1f1bd80964a88f7299ab";
+static NSString *const AWSSrpTestsV = @"abd4388bbd1edeadfd032e39a551af7706f9299f15266beb9d11b95946c640e31fe7560d2175a5840228dfb30ae8311d"
+                                       "b370efc34ef8764b5cd928f6da1e5d794c7038ed62a8deb71d74ec9a8085b60cce9b4866cd23e61c4cb833880e12c344"
+                                       "40092de89007873b3cb469dd62a5a52f00c07615bbe91aa11685de87ca609b760e3fa868ef7deba6bc5b1c3de5733dea"
+                                       "b138a0ba7219a4d0d264e0b8b17ed45b5984196e7ec05e8a55ac8046a0d2f5972daf91f652d9a3a68976494d2a9615e0"
+                                       "d7f72455f475bd331fd33a01d8f8f3277ae8c2e0c79c40b949dc161f42f8681f328e4f1eb5ecc8edded8c388d1de7c24"
+                                       "1d8dcf244ea40f4919e8ae82b0ad3735adc39d812d0e25d931d0d0933458dbff5228389d29067060106eedb7e428a8db"
+                                       "c9a44b09aba950b8a6f8b1cdd075db3ae0463d1a3749691c9a4935c5f96e07696d5b80429a884cd256bbc0b841bf91f8"
+                                       "d89a41702ba9d412ff53bf230d29f68d1a99440e9a446fcf59958f79d82b0770c1ac0477a76c87b4a99315a899729787";
+static NSString *const AWSSrpTestsAuthenticationKey = @"e847297af8df45a842a211c8b40d6986";
+static NSString *const AWSSrpTestsSignature = @"8VClTgeEjprKgUsWBLlDWwsRTtlwhmEwEo08Aj9ltpA=";
+
+@interface AWSCognitoIdentityProviderSrpHelperTests : XCTestCase
+
+@end
+
+@implementation AWSCognitoIdentityProviderSrpHelperTests
+
++ (AWSJKBigInteger *)bigIntegerWithHexString:(NSString *)hexString {
+    return [[AWSJKBigInteger alloc] initWithString:hexString andRadix:16];
+}
+
++ (NSString *)hexStringWithData:(NSData *)data {
+    NSMutableString *hexString = [NSMutableString stringWithCapacity:data.length * 2];
+    const uint8_t *bytes = data.bytes;
+    for (NSUInteger i = 0; i < data.length; i++) {
+        [hexString appendFormat:@"%02x", bytes[i]];
+    }
+    return hexString;
+}
+
+- (void)assertBigInteger:(AWSJKBigInteger *)bigInteger equalsHexString:(NSString *)hexString {
+    XCTAssertEqual([bigInteger compare:[AWSCognitoIdentityProviderSrpHelperTests bigIntegerWithHexString:hexString]], NSOrderedSame,
+                   @"%@ is not %@", [bigInteger stringValueWithRadix:16], hexString);
+}
+
+- (AWSCognitoIdentityProviderSrpHelper *)helper {
+    AWSJKBigInteger *privateA = [AWSCognitoIdentityProviderSrpHelperTests bigIntegerWithHexString:AWSSrpTestsPrivateA];
+    AWSCognitoIdentityProviderSrpCommonState *commonState = [AWSCognitoIdentityProviderSrpCommonState new];
+    AWSJKBigInteger *publicA = [AWSCognitoIdentityProviderSrpHelper generatePublicABigInt:privateA N:commonState.N g:commonState.g];
+    AWSCognitoIdentityProviderSrpClientState *clientState = [AWSCognitoIdentityProviderSrpClientState clientStateForUserName:AWSSrpTestsUserName
+                                                                                                                    password:AWSSrpTestsPassword
+                                                                                                                    privateA:privateA
+                                                                                                                     publicA:publicA];
+    clientState.timestamp = [NSDate dateWithTimeIntervalSince1970:1536000000];
+    return [[AWSCognitoIdentityProviderSrpHelper alloc] initWithClientState:clientState];
+}
+
+- (AWSCognitoIdentityProviderSrpServerState *)serverState {
+    uint8_t secretBlock[32];
+    for (uint8_t i = 0; i < sizeof(secretBlock); i++) {
+        secretBlock[i] = i + 1;
+    }
+    return [AWSCognitoIdentityProviderSrpServerState serverStateForPoolName:AWSSrpTestsPoolName
+                                                          publicBHexString:AWSSrpTestsPublicB
+                                                             saltHexString:AWSSrpTestsSalt
+                                                            derivedKeyInfo:@"Caldera Derived Key"
+                                                            derivedKeySize:16
+                                                        serviceSecretBlock:[NSData dataWithBytes:secretBlock length:sizeof(secretBlock)]];
+}
+
+- (void)testKnownAnswers {
+    AWSCognitoIdentityProviderSrpHelper *helper = [self helper];
+    [self assertBigInteger:helper.commonState.k equalsHexString:AWSSrpTestsK];
+    [self assertBigInteger:helper.clientState.publicA equalsHexString:AWSSrpTestsPublicA];
+
+    NSData *signature = [helper completeAuthentication:[self serverState]];
+
+    [self assertBigInteger:helper.x equalsHexString:AWSSrpTestsX];
+    [self assertBigInteger:helper.u equalsHexString:AWSSrpTestsU];
+    [self assertBigInteger:helper.S equalsHexString:AWSSrpTestsS];
+    XCTAssertEqualObjects([AWSCognitoIdentityProviderSrpHelperTests hexStringWithData:helper.authenticationKey], AWSSrpTestsAuthenticationKey);
+    XCTAssertEqualObjects([AWSCognitoIdentityProviderSrpHelper generateDateString:helper.clientState.timestamp], @"Mon Sep 3 18:40:00 UTC 2018");
+    XCTAssertEqualObjects([signature base64EncodedStringWithOptions:0], AWSSrpTestsSignature);
+}
+
+- (void)testPasswordVerifier {
+    AWSJKBigInteger *salt = [AWSCognitoIdentityProviderSrpHelperTests bigIntegerWithHexString:AWSSrpTestsSalt];
+    AWSJKBigInteger *x = [AWSCognitoIdentityProviderSrpHelper calculateX:AWSSrpTestsPoolName userName:AWSSrpTestsUserName password:AWSSrpTestsPassword salt:salt];
+    AWSCognitoIdentityProviderSrpCommonState *commonState = [AWSCognitoIdentityProviderSrpCommonState new];
+
+    [self assertBigInteger:x equalsHexString:AWSSrpTestsX];
+    [self assertBigInteger:[AWSCognitoIdentityProviderSrpHelper generatePublicABigInt:x N:commonState.N g:commonState.g] equalsHexString:AWSSrpTestsV];
+}
+
+- (void)testFixedBaseMatchesGenericExponentiation {
+    AWSCognitoIdentityProviderSrpCommonState *commonState = [AWSCognitoIdentityProviderSrpCommonState new];
+    NSArray<NSString *> *exponents = @[@"0", @"1", @"f", @"10", @"ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff",
+                                       @"8000000000000000000000000000000000000000000000000000000000000000",
+                                       // wider than the table, so it takes the generic path
+                                       @"1ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff"];
+    for (NSString *exponent in exponents) {
+        AWSJKBigInteger *e = [AWSCognitoIdentityProviderSrpHelperTests bigIntegerWithHexString:exponent];
+        XCTAssertEqual([[AWSCognitoIdentityProviderSrpHelper generatePublicABigInt:e N:commonState.N g:commonState.g] compare:[commonState.g pow:e andMod:commonState.N]], NSOrderedSame, @"%@", exponent);
+    }
+    for (NSUInteger i = 0; i < 20; i++) {
+        AWSJKBigInteger *privateA = [AWSCognitoIdentityProviderSrpHelper generatePrivateABigInt:commonState.N];
+        XCTAssertEqual([[AWSCognitoIdentityProviderSrpHelper generatePublicABigInt:privateA N:commonState.N g:commonState.g] compare:[commonState.g pow:privateA andMod:commonState.N]], NSOrderedSame);
+    }
+
+    // Any other group uses the generic exponentiation.
+    AWSJKBigInteger *N = [AWSCognitoIdentityProviderSrpHelperTests bigIntegerWithHexString:@"EEAF0AB9ADB38DD69C33F80AFA8FC5E86072618775FF3C0B9EA2314C9C256576D674DF7496EA81D3383B4813D692C6E0E0D5D8E250B98BE48E495C1D6089DAD15DC7D7B46154D6B6CE8EF4AD69B15D4982559B297BCF1885C529F566660E57EC68EDBC3C05726CC02FD4CBF4976EAA9AFD5138FE8376435B9FC61D2FC0EB06E3"];
+    AWSJKBigInteger *g = [[AWSJKBigInteger alloc] initWithUnsignedLong:2];
+    AWSJKBigInteger *e = [AWSCognitoIdentityProviderSrpHelperTests bigIntegerWithHexString:AWSSrpTestsPrivateA];
+    XCTAssertEqual([[AWSCognitoIdentityProviderSrpHelper generatePublicABigInt:e N:N g:g] compare:[g pow:e andMod:N]], NSOrderedSame);
+}
+
+- (void)testHashingMatchesDataSerialization {
+    // 0x80 has its top bit set but is a single byte, which the serialization keeps without a sign byte.
+    for (NSString *hexString in @[@"0", @"7f", @"80", @"ff", @"100", @"8000", AWSSrpTestsPublicA]) {
+        AWSJKBigInteger *bigInteger = [AWSCognitoIdentityProviderSrpHelperTests bigIntegerWithHexString:hexString];
+        NSData *data = [NSData aws_dataWithSignedBigInteger:bigInteger];
+        uint8_t hash[CC_SHA256_DIGEST_LENGTH];
+        CC_SHA256(data.bytes, (CC_LONG)data.length, hash);
+        AWSJKBigInteger *expected = [[NSData dataWithBytes:hash length:sizeof(hash)] aws_toBigInt];
+        XCTAssertEqual([[AWSCognitoIdentityProviderSrpHelper hashBigInts:@[bigInteger]] compare:expected], NSOrderedSame, @"%@", hexString);
+    }
+}
+
+#pragma mark - Performance
+
+- (void)testPerformancePublicA {
+    AWSCognitoIdentityProviderSrpCommonState *commonState = [AWSCognitoIdentityProviderSrpCommonState new];
+    AWSJKBigInteger *privateA = [AWSCognitoIdentityProviderSrpHelperTests bigIntegerWithHexString:AWSSrpTestsPrivateA];
+
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 20; i++) {
+            [AWSCognitoIdentityProviderSrpHelper generatePublicABigInt:privateA N:commonState.N g:commonState.g];
+        }
+    }];
+}
+
+- (void)testPerformancePublicAWithGenericExponentiation {
+    AWSCognitoIdentityProviderSrpCommonState *commonState = [AWSCognitoIdentityProviderSrpCommonState new];
+    AWSJKBigInteger *privateA = [AWSCognitoIdentityProviderSrpHelperTests bigIntegerWithHexString:AWSSrpTestsPrivateA];
+
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 20; i++) {
+            [commonState.g pow:privateA andMod:commonState.N];
+        }
+    }];
+}
+
+- (void)testPerformanceCompleteAuthentication {
+    AWSCognitoIdentityProviderSrpServerState *serverState = [self serverState];
+
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 10; i++) {
+            [[self helper] completeAuthentication:serverState];
+        }
+    }];
+}
+
+@end
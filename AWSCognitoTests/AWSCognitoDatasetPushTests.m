@@ -0,0 +1,263 @@
+//
+// Copyright 2010-2017 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+
+#import <UIKit/UIKit.h>
+#import <XCTest/XCTest.h>
+#import <AWSCore/AWSCore.h>
+#import "AWSCognito.h"
+#import "AWSCognitoSQLiteManager.h"
+#import "AWSCognitoDataset_Internal.h"
+#import "AWSCognitoConstants.h"
+
+static NSString *const AWSCognitoDatasetPushTestsIdentityId = @"us-east-1:pushTestsIdentity";
+static NSString *const AWSCognitoDatasetPushTestsDatasetName = @"pushTestsDataset";
+
+@interface AWSCognitoSync()
+
+- (instancetype)initWithConfiguration:(AWSServiceConfiguration *)configuration;
+
+@end
+
+@interface AWSCognitoDataset()
+
+- (AWSTask *)syncPush:(uint32_t)remainingAttempts;
+
+@end
+
+/**
+ * Hands out credentials and an identity id without calling Cognito Identity.
+ */
+@interface AWSCognitoDatasetPushTestsCredentialsProvider : AWSCognitoCredentialsProvider
+
+@end
+
+@implementation AWSCognitoDatasetPushTestsCredentialsProvider
+
+- (AWSTask<AWSCredentials *> *)credentials {
+    return [AWSTask taskWithResult:[[AWSCredentials alloc] initWithAccessKey:@"accessKey"
+                                                                   secretKey:@"secretKey"
+                                                                  sessionKey:nil
+                                                                  expiration:[NSDate distantFuture]]];
+}
+
+- (NSString *)identityId {
+    return AWSCognitoDatasetPushTestsIdentityId;
+}
+
+@end
+
+/**
+ * Answers ListRecords with the remote records changed after the requested sync count, and UpdateRecords by
+ * accepting every patch at the next sync count.
+ */
+@interface AWSCognitoDatasetPushTestsCognitoSync : AWSCognitoSync
+
+@property (nonatomic, strong) NSMutableArray<AWSCognitoSyncUpdateRecordsRequest *> *updateRecordsRequests;
+@property (nonatomic, strong) NSArray<AWSCognitoSyncRecord *> *remoteRecords;
+@property (nonatomic, strong) NSNumber *remoteSyncCount;
+
+@end
+
+@implementation AWSCognitoDatasetPushTestsCognitoSync
+
+- (AWSTask<AWSCognitoSyncListRecordsResponse *> *)listRecords:(AWSCognitoSyncListRecordsRequest *)request {
+    NSMutableArray *records = [NSMutableArray arrayWithCapacity:self.remoteRecords.count];
+    for (AWSCognitoSyncRecord *record in self.remoteRecords) {
+        if ([record.syncCount longLongValue] > [request.lastSyncCount longLongValue]) {
+            [records addObject:record];
+        }
+    }
+    AWSCognitoSyncListRecordsResponse *response = [AWSCognitoSyncListRecordsResponse new];
+    response.records = records;
+    response.count = @(records.count);
+    response.datasetExists = @(self.remoteRecords.count > 0);
+    response.datasetDeletedAfterRequestedSyncCount = @NO;
+    response.datasetSyncCount = self.remoteSyncCount;
+    response.lastModifiedBy = @"stub";
+    response.syncSessionToken = @"syncSessionToken";
+    return [AWSTask taskWithResult:response];
+}
+
+- (AWSTask<AWSCognitoSyncUpdateRecordsResponse *> *)updateRecords:(AWSCognitoSyncUpdateRecordsRequest *)request {
+    [self.updateRecordsRequests addObject:request];
+
+    NSMutableArray *records = [NSMutableArray arrayWithCapacity:request.recordPatches.count];
+    for (AWSCognitoSyncRecordPatch *patch in request.recordPatches) {
+        AWSCognitoSyncRecord *record = [AWSCognitoSyncRecord new];
+        record.key = patch.key;
+        record.value = patch.op == AWSCognitoSyncOperationRemove ? nil : patch.value;
+        record.syncCount = @([patch.syncCount longLongValue] + 1);
+        record.lastModifiedBy = @"stub";
+        record.lastModifiedDate = [NSDate date];
+        [records addObject:record];
+    }
+    AWSCognitoSyncUpdateRecordsResponse *response = [AWSCognitoSyncUpdateRecordsResponse new];
+    response.records = records;
+    return [AWSTask taskWithResult:response];
+}
+
+@end
+
+@interface AWSCognitoDatasetPushTests : XCTestCase
+
+@property (nonatomic, strong) AWSCognitoSQLiteManager *manager;
+@property (nonatomic, strong) AWSCognitoDatasetPushTestsCognitoSync *cognitoSync;
+@property (nonatomic, strong) AWSCognitoDataset *dataset;
+
+@end
+
+@implementation AWSCognitoDatasetPushTests
+
+- (void)setUp {
+    [super setUp];
+    self.manager = [[AWSCognitoSQLiteManager alloc] initWithIdentityId:AWSCognitoDatasetPushTestsIdentityId deviceId:@"tester"];
+    AWSCognitoCredentialsProvider *credentialsProvider = [[AWSCognitoDatasetPushTestsCredentialsProvider alloc] initWithRegionType:AWSRegionUSEast1
+                                                                                                                    identityPoolId:@"us-east-1:pushTestsPool"];
+    AWSServiceConfiguration *configuration = [[AWSServiceConfiguration alloc] initWithRegion:AWSRegionUSEast1
+                                                                         credentialsProvider:credentialsProvider];
+    self.cognitoSync = [[AWSCognitoDatasetPushTestsCognitoSync alloc] initWithConfiguration:configuration];
+    self.cognitoSync.updateRecordsRequests = [NSMutableArray new];
+    self.cognitoSync.remoteSyncCount = @0;
+    self.dataset = [[AWSCognitoDataset alloc] initWithDatasetName:AWSCognitoDatasetPushTestsDatasetName
+                                                    sqliteManager:self.manager
+                                                   cognitoService:self.cognitoSync];
+    self.dataset.synchronizeRetries = AWSCognitoMaxSyncRetries;
+}
+
+- (void)tearDown {
+    [self.manager deleteSQLiteDatabase];
+    [super tearDown];
+}
+
+- (void)push {
+    AWSTask *task = [self.dataset syncPush:1];
+    [task waitUntilFinished];
+    XCTAssertNil(task.error, @"Error on push [%@]", task.error);
+}
+
+- (void)synchronize {
+    AWSTask *task = [self.dataset synchronize];
+    [task waitUntilFinished];
+    XCTAssertNil(task.error, @"Error on synchronize [%@]", task.error);
+}
+
+// Replaces the remote dataset with `recordCount` records, all changed at the next sync count.
+- (void)changeRemoteRecordsWithCount:(int)recordCount value:(NSString *)value {
+    long long syncCount = [self.cognitoSync.remoteSyncCount longLongValue] + 1;
+    NSMutableArray *records = [NSMutableArray arrayWithCapacity:recordCount];
+    for (int i = 0; i < recordCount; i++) {
+        AWSCognitoSyncRecord *record = [AWSCognitoSyncRecord new];
+        record.key = [NSString stringWithFormat:@"record%d", i];
+        record.value = value;
+        record.syncCount = @(syncCount);
+        record.lastModifiedBy = @"remote";
+        record.lastModifiedDate = [NSDate date];
+        [records addObject:record];
+    }
+    self.cognitoSync.remoteRecords = records;
+    self.cognitoSync.remoteSyncCount = @(syncCount);
+}
+
+- (void)testSynchronizeMergesRemoteChanges {
+    [self changeRemoteRecordsWithCount:20 value:@"remote"];
+    [self.dataset setString:@"local" forKey:@"local"];
+
+    [self synchronize];
+    XCTAssertEqualObjects(@"remote", [self.dataset stringForKey:@"record7"]);
+    XCTAssertEqual(1, [[self.manager lastSyncCount:AWSCognitoDatasetPushTestsDatasetName] longLongValue]);
+    XCTAssertEqual(1, self.cognitoSync.updateRecordsRequests.count);
+    XCTAssertEqualObjects(@"local", self.cognitoSync.updateRecordsRequests.lastObject.recordPatches.firstObject.key);
+
+    [self changeRemoteRecordsWithCount:20 value:@"changed"];
+
+    [self synchronize];
+    XCTAssertEqualObjects(@"changed", [self.dataset stringForKey:@"record7"]);
+    XCTAssertEqualObjects(@"local", [self.dataset stringForKey:@"local"]);
+    XCTAssertEqual(2, [[self.manager lastSyncCount:AWSCognitoDatasetPushTestsDatasetName] longLongValue]);
+    XCTAssertEqual(1, self.cognitoSync.updateRecordsRequests.count);
+    XCTAssertEqual(0, [self.manager recordsUpdatedAfterLastSync:AWSCognitoDatasetPushTestsDatasetName error:nil].count);
+}
+
+- (void)testPushSendsOnlyChangedRecords {
+    for (int i = 0; i < 50; i++) {
+        [self.dataset setString:@"value" forKey:[NSString stringWithFormat:@"key%02d", i]];
+    }
+    XCTAssertEqual(50 * 10, [self.dataset size]);
+
+    [self push];
+    XCTAssertEqual(1, self.cognitoSync.updateRecordsRequests.count);
+    XCTAssertEqual(50, self.cognitoSync.updateRecordsRequests.lastObject.recordPatches.count);
+    XCTAssertEqual(0, [self.manager recordsUpdatedAfterLastSync:AWSCognitoDatasetPushTestsDatasetName error:nil].count);
+
+    // Nothing changed, so nothing is sent.
+    [self push];
+    XCTAssertEqual(1, self.cognitoSync.updateRecordsRequests.count);
+
+    [self.dataset setString:@"changed" forKey:@"key03"];
+    [self.dataset removeObjectForKey:@"key04"];
+    XCTAssertEqual(48 * 10 + 12 + 5, [self.dataset size]);
+
+    [self push];
+    XCTAssertEqual(2, self.cognitoSync.updateRecordsRequests.count);
+    NSMutableDictionary<NSString *, AWSCognitoSyncRecordPatch *> *patches = [NSMutableDictionary new];
+    for (AWSCognitoSyncRecordPatch *patch in self.cognitoSync.updateRecordsRequests.lastObject.recordPatches) {
+        patches[patch.key] = patch;
+    }
+    XCTAssertEqualObjects((@[@"key03", @"key04"]), [patches.allKeys sortedArrayUsingSelector:@selector(compare:)]);
+    XCTAssertEqual(AWSCognitoSyncOperationReplace, patches[@"key03"].op);
+    XCTAssertEqualObjects(@"changed", patches[@"key03"].value);
+    XCTAssertEqual(1, [patches[@"key03"].syncCount longLongValue]);
+    XCTAssertEqual(AWSCognitoSyncOperationRemove, patches[@"key04"].op);
+    XCTAssertEqual(0, [self.manager recordsUpdatedAfterLastSync:AWSCognitoDatasetPushTestsDatasetName error:nil].count);
+}
+
+- (void)testPushOfOversizedDatasetFailsLocally {
+    NSString *largeValue = [@"" stringByPaddingToLength:AWSCognitoMaxDatasetSize withString:@"x" startingAtIndex:0];
+    AWSCognitoRecord *record = [[AWSCognitoRecord alloc] initWithId:@"large" data:[[AWSCognitoRecordValue alloc] initWithString:largeValue]];
+    NSError *error = nil;
+    XCTAssertTrue([self.manager putRecord:record datasetName:AWSCognitoDatasetPushTestsDatasetName error:&error]);
+    XCTAssertEqual(AWSCognitoMaxDatasetSize + 5, [self.dataset size]);
+
+    AWSTask *task = [self.dataset syncPush:1];
+    [task waitUntilFinished];
+    XCTAssertEqualObjects(AWSCognitoErrorDomain, task.error.domain);
+    XCTAssertEqual(AWSCognitoErrorUserDataSizeLimitExceeded, task.error.code);
+    XCTAssertEqual(0, self.cognitoSync.updateRecordsRequests.count);
+}
+
+#pragma mark - Benchmarks
+
+// Each pass pulls and merges a change to every record of the dataset through -synchronize.
+- (void)testPerformanceSynchronizePull5k {
+    int recordCount = 5000;
+    [self changeRemoteRecordsWithCount:recordCount value:@"a representative record value"];
+    [self synchronize];
+
+    __block int pass = 0;
+    [self measureMetrics:[[self class] defaultPerformanceMetrics] automaticallyStartMeasuring:NO forBlock:^{
+        [self changeRemoteRecordsWithCount:recordCount value:[NSString stringWithFormat:@"a representative record value %d", ++pass]];
+
+        [self startMeasuring];
+        CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+        [self synchronize];
+        CFAbsoluteTime elapsed = CFAbsoluteTimeGetCurrent() - start;
+        [self stopMeasuring];
+
+        NSLog(@"Synchronized %d changed records in %.1f ms (%.1f us per record)", recordCount, elapsed * 1e3, elapsed * 1e6 / recordCount);
+        XCTAssertEqual([self.cognitoSync.remoteSyncCount longLongValue], [[self.manager lastSyncCount:AWSCognitoDatasetPushTestsDatasetName] longLongValue]);
+    }];
+}
+
+@end
@@ -19,6 +19,8 @@
 #import <AWSCore/AWSCore.h>
 #import "AWSCognito.h"
 #import "AWSCognitoConflict_Internal.h"
+#import "AWSCognitoRecord_Internal.h"
+#import <sqlite3.h>
 
 @interface AmazonCognitoSqliteManagerTests : XCTestCase
 
@@ -233,4 +235,292 @@ NSString *const DatasetName = @"testDataset";
         XCTAssertTrue(reset.syncCount == 0, @"record sync count not reset");
     }
 }
+
+- (void)testRepeatedPutAndGetReuseStatements {
+    NSError * error;
+    for (int i = 0; i < 100; i++) {
+        AWSCognitoRecordValue* value = [[AWSCognitoRecordValue alloc] initWithString:[NSString stringWithFormat:@"value%d", i]];
+        AWSCognitoRecord* record = [[AWSCognitoRecord alloc] initWithId:[NSString stringWithFormat:@"key%d", i % 10] data:value];
+        XCTAssertTrue([self.manager putRecord:record datasetName:DatasetName error:&error]);
+        XCTAssertNil(error, @"Error on put [%@]", error);
+        AWSCognitoRecord* result = [self.manager getRecordById:record.recordId datasetName:DatasetName error:&error];
+        XCTAssertNil(error, @"Error on get [%@]", error);
+        XCTAssertEqualObjects(value.string, result.data.string);
+    }
+    XCTAssertEqualObjects([NSNumber numberWithInt:10], [self.manager numRecords:DatasetName]);
+    XCTAssertNil([self.manager getRecordById:@"missing" datasetName:DatasetName error:&error]);
+    XCTAssertNil(error, @"Error on get [%@]", error);
+}
+
+- (void)testGetRecordsByIds {
+    NSError * error;
+    AWSCognitoRecordValue* on = [[AWSCognitoRecordValue alloc] initWithString:@"on"];
+    [self.manager putRecord:[[AWSCognitoRecord alloc] initWithId:@"wifi" data:on] datasetName:DatasetName error:&error];
+    [self.manager putRecord:[[AWSCognitoRecord alloc] initWithId:@"bluetooth" data:on] datasetName:DatasetName error:&error];
+    XCTAssertNil(error, @"Error on put [%@]", error);
+
+    NSDictionary<NSString *, AWSCognitoRecord *> *records = [self.manager getRecordsByIds:@[@"wifi", @"bluetooth", @"missing"]
+                                                                              datasetName:DatasetName
+                                                                                    error:&error];
+    XCTAssertNil(error, @"Error on get [%@]", error);
+    XCTAssertEqual(2, records.count);
+    XCTAssertEqualObjects(@"on", records[@"wifi"].data.string);
+    XCTAssertEqualObjects(@"on", records[@"bluetooth"].data.string);
+    XCTAssertNil(records[@"missing"]);
+    XCTAssertEqual(0, [self.manager getRecordsByIds:@[] datasetName:DatasetName error:&error].count);
+}
+
+- (void)testGetRecordsByIdsAcrossBatches {
+    NSError * error;
+    AWSCognitoRecordValue* on = [[AWSCognitoRecordValue alloc] initWithString:@"on"];
+    NSMutableArray<NSString *> *recordIds = [NSMutableArray new];
+    for (int i = 0; i < 250; i++) {
+        NSString *recordId = [NSString stringWithFormat:@"record%d", i];
+        [recordIds addObject:recordId];
+        if (i % 2 == 0) {
+            XCTAssertTrue([self.manager putRecord:[[AWSCognitoRecord alloc] initWithId:recordId data:on] datasetName:DatasetName error:&error]);
+        }
+    }
+
+    NSDictionary<NSString *, AWSCognitoRecord *> *records = [self.manager getRecordsByIds:recordIds datasetName:DatasetName error:&error];
+    XCTAssertNil(error, @"Error on get [%@]", error);
+    XCTAssertEqual(125, records.count);
+    XCTAssertEqualObjects(@"on", records[@"record248"].data.string);
+    XCTAssertNil(records[@"record249"]);
+}
+
+- (void)testDeleteSQLiteDatabaseStartsOver {
+    NSError * error;
+    AWSCognitoRecordValue* on = [[AWSCognitoRecordValue alloc] initWithString:@"on"];
+    XCTAssertTrue([self.manager putRecord:[[AWSCognitoRecord alloc] initWithId:@"wifi" data:on] datasetName:DatasetName error:&error]);
+    XCTAssertNotNil([self.manager getRecordById:@"wifi" datasetName:DatasetName error:&error]);
+
+    [self.manager deleteSQLiteDatabase];
+
+    XCTAssertNil([self.manager getRecordById:@"wifi" datasetName:DatasetName error:&error]);
+    XCTAssertNil(error, @"Error on get [%@]", error);
+
+    [self.manager initializeDatasetTables:DatasetName];
+    XCTAssertTrue([self.manager putRecord:[[AWSCognitoRecord alloc] initWithId:@"bluetooth" data:on] datasetName:DatasetName error:&error]);
+    XCTAssertEqualObjects(@"on", [self.manager getRecordById:@"bluetooth" datasetName:DatasetName error:&error].data.string);
+    XCTAssertEqual(1, [self.manager getRecordsByIds:@[@"wifi", @"bluetooth"] datasetName:DatasetName error:&error].count);
+    XCTAssertNil(error, @"Error on get [%@]", error);
+}
+
+- (void)testReadsDuringRemoteMerge {
+    NSError * error;
+    AWSCognitoRecordValue* on = [[AWSCognitoRecordValue alloc] initWithString:@"on"];
+    [self.manager putRecord:[[AWSCognitoRecord alloc] initWithId:@"wifi" data:on] datasetName:DatasetName error:&error];
+    XCTAssertNil(error, @"Error on put [%@]", error);
+
+    NSMutableArray *records = [NSMutableArray arrayWithCapacity:2000];
+    for (int i = 0; i < 2000; i++) {
+        AWSCognitoRecord* record = [[AWSCognitoRecord alloc] initWithId:[NSString stringWithFormat:@"remote%d", i] data:on];
+        record.syncCount = 1;
+        record.lastModifiedBy = @"me";
+        [records addObject:[[AWSCognitoRecordTuple alloc] initWithLocalRecord:nil remoteRecord:record]];
+    }
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"merge finished"];
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        NSError *mergeError = nil;
+        XCTAssertTrue([self.manager updateWithRemoteChanges:DatasetName nonConflicts:records resolvedConflicts:@[] error:&mergeError]);
+        XCTAssertNil(mergeError, @"Error on merge [%@]", mergeError);
+        [expectation fulfill];
+    });
+
+    // Reads see either the state before or after the merge, never a partial one.
+    for (int i = 0; i < 50; i++) {
+        AWSCognitoRecord* result = [self.manager getRecordById:@"wifi" datasetName:DatasetName error:&error];
+        XCTAssertNil(error, @"Error on get [%@]", error);
+        XCTAssertEqualObjects(@"on", result.data.string);
+        NSInteger count = [[self.manager numRecords:DatasetName] integerValue];
+        XCTAssertTrue(count == 1 || count == 2001, @"Unexpected record count %ld", (long)count);
+    }
+
+    [self waitForExpectationsWithTimeout:30 handler:nil];
+    XCTAssertEqualObjects([NSNumber numberWithInt:2001], [self.manager numRecords:DatasetName]);
+}
+
+// The size the dataset would have if it were summed from its records.
+- (long)sumOfRecordSizes:(NSString *)datasetName {
+    long size = 0;
+    for (AWSCognitoRecord *record in [self.manager allRecords:datasetName]) {
+        size += [record size];
+    }
+    return size;
+}
+
+- (void)testDatasetSizeTracksLocalWrites {
+    NSError * error;
+    XCTAssertEqual(0, [[self.manager datasetSize:DatasetName] longValue]);
+
+    AWSCognitoRecord* record = [[AWSCognitoRecord alloc] initWithId:@"wifi" data:[[AWSCognitoRecordValue alloc] initWithString:@"on"]];
+    XCTAssertTrue([self.manager putRecord:record datasetName:DatasetName error:&error]);
+    XCTAssertEqual(6, [[self.manager datasetSize:DatasetName] longValue]);
+
+    // Replacing a record counts only its new value.
+    record.data = [[AWSCognitoRecordValue alloc] initWithString:@"\u00e9t\u00e9"];
+    XCTAssertTrue([self.manager putRecord:record datasetName:DatasetName error:&error]);
+    XCTAssertEqual(9, [[self.manager datasetSize:DatasetName] longValue]);
+
+    XCTAssertTrue([self.manager putRecord:[[AWSCognitoRecord alloc] initWithId:@"bluetooth" data:[[AWSCognitoRecordValue alloc] initWithString:@"off"]]
+                              datasetName:DatasetName
+                                    error:&error]);
+    XCTAssertEqual(21, [[self.manager datasetSize:DatasetName] longValue]);
+
+    // A deleted record still counts its key until the deletion is synced.
+    XCTAssertTrue([self.manager flagRecordAsDeletedById:@"bluetooth" datasetName:DatasetName error:&error]);
+    XCTAssertEqual(18, [[self.manager datasetSize:DatasetName] longValue]);
+    XCTAssertEqual([self sumOfRecordSizes:DatasetName], [[self.manager datasetSize:DatasetName] longValue]);
+
+    XCTAssertTrue([self.manager deleteRecordById:@"bluetooth" datasetName:DatasetName error:&error]);
+    XCTAssertEqual(9, [[self.manager datasetSize:DatasetName] longValue]);
+
+    XCTAssertTrue([self.manager deleteDataset:DatasetName error:&error]);
+    XCTAssertEqual(0, [[self.manager datasetSize:DatasetName] longValue]);
+    XCTAssertNil(error, @"Error on write [%@]", error);
+}
+
+- (void)testDatasetSizeTracksRemoteChanges {
+    NSError * error;
+    AWSCognitoRecord* local = [[AWSCognitoRecord alloc] initWithId:@"wifi" data:[[AWSCognitoRecordValue alloc] initWithString:@"on"]];
+    [self.manager putRecord:local datasetName:DatasetName error:&error];
+    local = [self.manager getRecordById:@"wifi" datasetName:DatasetName error:&error];
+
+    NSMutableArray *tuples = [NSMutableArray array];
+    AWSCognitoRecord* changed = [[AWSCognitoRecord alloc] initWithId:@"wifi" data:[[AWSCognitoRecordValue alloc] initWithString:@"disabled"]];
+    changed.syncCount = 1;
+    changed.lastModifiedBy = @"remote";
+    [tuples addObject:[[AWSCognitoRecordTuple alloc] initWithLocalRecord:local remoteRecord:changed]];
+    for (int i = 0; i < 10; i++) {
+        AWSCognitoRecord* remote = [[AWSCognitoRecord alloc] initWithId:[NSString stringWithFormat:@"remote%d", i]
+                                                                   data:[[AWSCognitoRecordValue alloc] initWithString:@"value"]];
+        remote.syncCount = 1;
+        remote.lastModifiedBy = @"remote";
+        [tuples addObject:[[AWSCognitoRecordTuple alloc] initWithLocalRecord:nil remoteRecord:remote]];
+    }
+    XCTAssertTrue([self.manager updateWithRemoteChanges:DatasetName nonConflicts:tuples resolvedConflicts:@[] error:&error]);
+    XCTAssertNil(error, @"Error on merge [%@]", error);
+    XCTAssertEqual(12 + 10 * 12, [[self.manager datasetSize:DatasetName] longValue]);
+    XCTAssertEqual([self sumOfRecordSizes:DatasetName], [[self.manager datasetSize:DatasetName] longValue]);
+
+    // Merged datasets move their size along with their records.
+    XCTAssertTrue([self.manager reparentDatasets:TestId1 withNewId:TestId2 error:&error]);
+    XCTAssertEqual(0, [[self.manager datasetSize:DatasetName] longValue]);
+    self.manager.identityId = TestId2;
+    NSString *mergedDatasetName = [NSString stringWithFormat:@"%@.%@", DatasetName, TestId1];
+    XCTAssertEqual(12 + 10 * 12, [[self.manager datasetSize:mergedDatasetName] longValue]);
+    XCTAssertEqual([self sumOfRecordSizes:mergedDatasetName], [[self.manager datasetSize:mergedDatasetName] longValue]);
+}
+
+- (void)testDirtyRecordsAfterRemoteUpdate {
+    NSError * error;
+    for (int i = 0; i < 100; i++) {
+        AWSCognitoRecord* record = [[AWSCognitoRecord alloc] initWithId:[NSString stringWithFormat:@"key%d", i]
+                                                                   data:[[AWSCognitoRecordValue alloc] initWithString:@"value"]];
+        [self.manager putRecord:record datasetName:DatasetName error:&error];
+    }
+    NSDictionary *dirty = [self.manager recordsUpdatedAfterLastSync:DatasetName error:&error];
+    XCTAssertEqual(100, dirty.count);
+
+    // Acknowledge all but one of the records, as a successful push does.
+    NSMutableArray *tuples = [NSMutableArray array];
+    for (AWSCognitoRecord *record in dirty.allValues) {
+        if ([record.recordId isEqualToString:@"key7"]) {
+            continue;
+        }
+        AWSCognitoRecord *pushed = [record copy];
+        pushed.syncCount = 1;
+        pushed.dirtyCount = 0;
+        [tuples addObject:[[AWSCognitoRecordTuple alloc] initWithLocalRecord:record remoteRecord:pushed]];
+    }
+    XCTAssertTrue([self.manager updateLocalRecordMetadata:DatasetName records:tuples error:&error]);
+
+    dirty = [self.manager recordsUpdatedAfterLastSync:DatasetName error:&error];
+    XCTAssertNil(error, @"Error on get [%@]", error);
+    XCTAssertEqualObjects(@[@"key7"], dirty.allKeys);
+    XCTAssertEqual([self sumOfRecordSizes:DatasetName], [[self.manager datasetSize:DatasetName] longValue]);
+}
+
+- (void)testDatasetSizeOfExistingDatabase {
+    NSString *filePath = [[NSSearchPathForDirectoriesInDomains(NSDocumentDirectory, NSUserDomainMask, YES) firstObject]
+                          stringByAppendingPathComponent:@"CognitoData.sqlite3"];
+    [self.manager deleteSQLiteDatabase];
+    self.manager = nil;
+
+    // A record table as created before record sizes were stored.
+    sqlite3 *sqlite;
+    XCTAssertEqual(SQLITE_OK, sqlite3_open([filePath UTF8String], &sqlite));
+    XCTAssertEqual(SQLITE_OK, sqlite3_exec(sqlite, "CREATE TABLE CognitoData (IdentityId TEXT NOT NULL DEFAULT UnknownId, Dataset TEXT NOT NULL, "
+                                           "Key TEXT NOT NULL, LastModified INTEGER NOT NULL, ModifiedBy TEXT NOT NULL, Data TEXT NOT NULL, "
+                                           "SyncCount INTEGER NOT NULL DEFAULT 0, Dirty INTEGER NOT NULL DEFAULT 1, Type INTEGER NOT NULL, "
+                                           "PRIMARY KEY(IdentityId,Dataset,Key))", NULL, NULL, NULL));
+    NSString *insert = [NSString stringWithFormat:@"INSERT INTO CognitoData (IdentityId, Dataset, Key, LastModified, ModifiedBy, Data, Type) VALUES "
+                        "('%@', '%@', 'wifi', 0, 'me', '%@', %ld), ('%@', '%@', 'gone', 0, 'me', '%@', %ld)",
+                        TestId1, DatasetName, [[[AWSCognitoRecordValue alloc] initWithString:@"on"] toJsonString], (long)AWSCognitoRecordValueTypeString,
+                        TestId1, DatasetName, [[[AWSCognitoRecordValue alloc] initWithString:@"\0" type:AWSCognitoRecordValueTypeDeleted] toJsonString], (long)AWSCognitoRecordValueTypeDeleted];
+    XCTAssertEqual(SQLITE_OK, sqlite3_exec(sqlite, [insert UTF8String], NULL, NULL, NULL));
+    sqlite3_close(sqlite);
+
+    self.manager = [[AWSCognitoSQLiteManager alloc] initWithIdentityId:TestId1 deviceId:DeviceId];
+    [self.manager initializeDatasetTables:DatasetName];
+    XCTAssertEqual(10, [[self.manager datasetSize:DatasetName] longValue]);
+
+    NSError *error = nil;
+    XCTAssertTrue([self.manager putRecord:[[AWSCognitoRecord alloc] initWithId:@"wifi" data:[[AWSCognitoRecordValue alloc] initWithString:@"off"]]
+                              datasetName:DatasetName
+                                    error:&error]);
+    XCTAssertEqual(11, [[self.manager datasetSize:DatasetName] longValue]);
+}
+
+#pragma mark - Benchmarks
+
+// Mirrors the local side of a push on a dataset that is mostly in sync: collect
+// the dirty records, then check the dataset size before sending them.
+- (void)measurePushPreparationWithRecordCount:(int)recordCount summingRecords:(BOOL)summingRecords {
+    AWSCognitoRecordValue* value = [[AWSCognitoRecordValue alloc] initWithString:@"a representative record value"];
+    NSMutableArray *tuples = [NSMutableArray arrayWithCapacity:recordCount];
+    for (int i = 0; i < recordCount; i++) {
+        AWSCognitoRecord* remote = [[AWSCognitoRecord alloc] initWithId:[NSString stringWithFormat:@"record%d", i] data:value];
+        remote.syncCount = 1;
+        remote.lastModifiedBy = @"remote";
+        [tuples addObject:[[AWSCognitoRecordTuple alloc] initWithLocalRecord:nil remoteRecord:remote]];
+    }
+    NSError *error = nil;
+    XCTAssertTrue([self.manager updateWithRemoteChanges:DatasetName nonConflicts:tuples resolvedConflicts:@[] error:&error]);
+    for (int i = 0; i < 10; i++) {
+        AWSCognitoRecord* record = [[AWSCognitoRecord alloc] initWithId:[NSString stringWithFormat:@"record%d", i * 97] data:value];
+        XCTAssertTrue([self.manager putRecord:record datasetName:DatasetName error:&error]);
+    }
+
+    [self measureBlock:^{
+        CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+        for (int i = 0; i < 10; i++) {
+            NSError *error = nil;
+            NSDictionary *dirty = [self.manager recordsUpdatedAfterLastSync:DatasetName error:&error];
+            XCTAssertEqual(10, dirty.count);
+            long size = summingRecords ? [self sumOfRecordSizes:DatasetName] : [[self.manager datasetSize:DatasetName] longValue];
+            XCTAssertTrue(size > 0);
+        }
+        CFAbsoluteTime elapsed = CFAbsoluteTimeGetCurrent() - start;
+        NSLog(@"Prepared a push of %d records in %.2f ms", recordCount, elapsed * 1e3 / 10);
+    }];
+}
+
+- (void)testPerformancePushPreparation1k {
+    [self measurePushPreparationWithRecordCount:1000 summingRecords:NO];
+}
+
+- (void)testPerformancePushPreparation10k {
+    [self measurePushPreparationWithRecordCount:10000 summingRecords:NO];
+}
+
+- (void)testPerformancePushPreparationSummingRecords1k {
+    [self measurePushPreparationWithRecordCount:1000 summingRecords:YES];
+}
+
+- (void)testPerformancePushPreparationSummingRecords10k {
+    [self measurePushPreparationWithRecordCount:10000 summingRecords:YES];
+}
 @end
@@ -34,9 +34,11 @@ FOUNDATION_EXPORT const unsigned char AWSCoreVersionString[];
 #import "AWSClientContext.h"
 #import "AWSSynchronizedMutableDictionary.h"
 #import "AWSSerialization.h"
+#import "AWSServiceDefinition.h"
 #import "AWSURLRequestSerialization.h"
 #import "AWSURLResponseSerialization.h"
 #import "AWSURLSessionManager.h"
+#import "AWSTransferScheduler.h"
 #import "AWSSignature.h"
 #import "AWSURLRequestRetryHandler.h"
 #import "AWSValidation.h"
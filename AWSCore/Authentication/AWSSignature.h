@@ -18,6 +18,12 @@
 
 FOUNDATION_EXPORT NSString *const AWSSignatureV4Algorithm;
 FOUNDATION_EXPORT NSString *const AWSSignatureV4Terminator;
+FOUNDATION_EXPORT NSString *const AWSSignatureV4UnsignedPayload;
+
+/**
+ The `NSURLProtocol` property key under which a request serializer records what the `HTTPBodyStream` of a request reads: an `NSData`, or the path of a file as an `NSString`. `AWSSignatureV4Signer` hashes the payload from it without consuming the stream.
+ */
+FOUNDATION_EXPORT NSString *const AWSSignatureV4PayloadSourceKey;
 
 @class AWSEndpoint;
 
@@ -28,7 +34,10 @@ FOUNDATION_EXPORT NSString *const AWSSignatureV4Terminator;
 + (NSData *)sha256HMacWithData:(NSData *)data withKey:(NSData *)key;
 + (NSString *)hashString:(NSString *)stringToHash;
 + (NSData *)hash:(NSData *)dataToHash;
++ (NSData *)hashStream:(NSInputStream *)stream error:(NSError **)error;
++ (NSData *)hashFileAtURL:(NSURL *)fileURL error:(NSError **)error;
 + (NSString *)hexEncode:(NSString *)string;
++ (NSString *)hexEncodeData:(NSData *)data;
 + (NSString *)HMACSign:(NSData *)data withKey:(NSString *)key usingAlgorithm:(uint32_t)algorithm;
 
 @end
@@ -37,6 +46,11 @@ FOUNDATION_EXPORT NSString *const AWSSignatureV4Terminator;
 
 @property (nonatomic, strong, readonly) id<AWSCredentialsProvider> credentialsProvider;
 
+/**
+ Whether a body stream whose source was not recorded under `AWSSignatureV4PayloadSourceKey` is sent as `UNSIGNED-PAYLOAD` instead of being read into memory to be hashed. Set it only for services that accept unsigned payloads. The default is `NO`. It does not apply to S3, whose streams are signed with `aws-chunked` encoding.
+ */
+@property (nonatomic, assign) BOOL allowsUnsignedPayload;
+
 - (instancetype)initWithCredentialsProvider:(id<AWSCredentialsProvider>)credentialsProvider
                                    endpoint:(AWSEndpoint *)endpoint;
 
@@ -24,6 +24,45 @@
 static NSString *const AWSSigV4Marker = @"AWS4";
 NSString *const AWSSignatureV4Algorithm = @"AWS4-HMAC-SHA256";
 NSString *const AWSSignatureV4Terminator = @"aws4_request";
+NSString *const AWSSignatureV4UnsignedPayload = @"UNSIGNED-PAYLOAD";
+NSString *const AWSSignatureV4PayloadSourceKey = @"AWSSignatureV4PayloadSource";
+
+static const char AWSSignatureHexDigits[] = "0123456789abcdef";
+static const NSUInteger AWSSignatureHashBufferLength = 64 * 1024;
+
+// Reads the stream to its end once, hashing each buffer and appending it to `copy` when one is given.
+static NSData *AWSSignatureHashStream(NSInputStream *stream, NSMutableData *copy, NSError **error) {
+    if ([stream streamStatus] == NSStreamStatusNotOpen) {
+        [stream open];
+    }
+
+    CC_SHA256_CTX context;
+    CC_SHA256_Init(&context);
+
+    uint8_t *buffer = malloc(AWSSignatureHashBufferLength);
+    NSInteger bytesRead;
+    while ((bytesRead = [stream read:buffer maxLength:AWSSignatureHashBufferLength]) > 0) {
+        CC_SHA256_Update(&context, buffer, (CC_LONG)bytesRead);
+        [copy appendBytes:buffer length:bytesRead];
+    }
+    free(buffer);
+
+    NSError *streamError = [stream streamError];
+    [stream close];
+    if (bytesRead < 0) {
+        if (error) {
+            *error = streamError ?: [NSError errorWithDomain:NSCocoaErrorDomain
+                                                        code:NSFileReadUnknownError
+                                                    userInfo:nil];
+        }
+        return nil;
+    }
+
+    unsigned char result[CC_SHA256_DIGEST_LENGTH];
+    CC_SHA256_Final(result, &context);
+
+    return [[NSData alloc] initWithBytes:result length:CC_SHA256_DIGEST_LENGTH];
+}
 
 @implementation AWSSignatureSignerUtility
 
@@ -47,36 +86,80 @@ NSString *const AWSSignatureV4Terminator = @"aws4_request";
 }
 
 + (NSData *)hash:(NSData *)dataToHash {
-    if ([dataToHash length] > UINT32_MAX) {
-        return nil;
+    const uint8_t *bytes = [dataToHash bytes];
+    NSUInteger length = [dataToHash length];
+    CC_SHA256_CTX context;
+    CC_SHA256_Init(&context);
+    // CC_SHA256_Update takes a 32-bit length, so larger payloads are fed in slices.
+    while (length > 0) {
+        CC_LONG sliceLength = (CC_LONG)MIN(length, (NSUInteger)UINT32_MAX);
+        CC_SHA256_Update(&context, bytes, sliceLength);
+        bytes += sliceLength;
+        length -= sliceLength;
     }
 
-    const void *cStr = [dataToHash bytes];
     unsigned char result[CC_SHA256_DIGEST_LENGTH];
-
-    CC_SHA256(cStr, (uint32_t)[dataToHash length], result);
+    CC_SHA256_Final(result, &context);
 
     return [[NSData alloc] initWithBytes:result length:CC_SHA256_DIGEST_LENGTH];
 }
 
++ (NSData *)hashStream:(NSInputStream *)stream error:(NSError **)error {
+    return AWSSignatureHashStream(stream, nil, error);
+}
+
++ (NSData *)hashFileAtURL:(NSURL *)fileURL error:(NSError **)error {
+    NSInputStream *stream = [NSInputStream inputStreamWithURL:fileURL];
+    if (!stream) {
+        if (error) {
+            *error = [NSError errorWithDomain:NSCocoaErrorDomain
+                                         code:NSFileReadNoSuchFileError
+                                     userInfo:@{NSURLErrorKey : fileURL}];
+        }
+        return nil;
+    }
+    return AWSSignatureHashStream(stream, nil, error);
+}
+
 + (NSString *)hexEncode:(NSString *)string {
     NSUInteger len = [string length];
     unichar *chars = malloc(len * sizeof(unichar));
 
     [string getCharacters:chars];
 
-    NSMutableString *hexString = [NSMutableString new];
+    NSMutableString *hexString = [NSMutableString stringWithCapacity:len * 2];
     for (NSUInteger i = 0; i < len; i++) {
-        if ((int)chars[i] < 16) {
-            [hexString appendString:@"0"];
+        if (chars[i] <= 0xff) {
+            unichar digits[2] = {AWSSignatureHexDigits[chars[i] >> 4], AWSSignatureHexDigits[chars[i] & 0x0f]};
+            CFStringAppendCharacters((__bridge CFMutableStringRef)hexString, digits, 2);
+        } else {
+            [hexString appendFormat:@"%x", chars[i]];
         }
-        [hexString appendString:[NSString stringWithFormat:@"%x", chars[i]]];
     }
     free(chars);
 
     return hexString;
 }
 
++ (NSString *)hexEncodeData:(NSData *)data {
+    NSUInteger length = [data length];
+    if (length == 0) {
+        return @"";
+    }
+
+    const uint8_t *bytes = [data bytes];
+    char *hex = malloc(length * 2);
+    for (NSUInteger i = 0; i < length; i++) {
+        hex[i * 2] = AWSSignatureHexDigits[bytes[i] >> 4];
+        hex[i * 2 + 1] = AWSSignatureHexDigits[bytes[i] & 0x0f];
+    }
+
+    return [[NSString alloc] initWithBytesNoCopy:hex
+                                          length:length * 2
+                                        encoding:NSASCIIStringEncoding
+                                    freeWhenDone:YES];
+}
+
 + (NSString *)HMACSign:(NSData *)data withKey:(NSString *)key usingAlgorithm:(CCHmacAlgorithm)algorithm {
     CCHmacContext context;
     const char    *keyCString = [key cStringUsingEncoding:NSASCIIStringEncoding];
@@ -157,8 +240,22 @@ NSString *const AWSSignatureV4Terminator = @"aws4_request";
                 authorization = [self signS3RequestV4:request
                                          credentials:credentials];
             } else {
+                NSError *error = nil;
+                NSNumber *streamedContentLength = nil;
+                NSString *contentSha256 = [self contentSha256ForRequest:request
+                                                  streamedContentLength:&streamedContentLength
+                                                                  error:&error];
+                if (!contentSha256) {
+                    return [AWSTask taskWithError:error];
+                }
                 authorization = [self signRequestV4:request
-                                       credentials:credentials];
+                                       credentials:credentials
+                                     contentSha256:contentSha256];
+                // Without a Content-Length a body stream is sent with chunked transfer encoding, which some services reject.
+                // It is set after signing so that it is not one of the signed headers.
+                if (streamedContentLength && ![request valueForHTTPHeaderField:@"Content-Length"]) {
+                    [request setValue:[streamedContentLength stringValue] forHTTPHeaderField:@"Content-Length"];
+                }
             }
 
             if (authorization) {
@@ -221,7 +318,7 @@ NSString *const AWSSignatureV4Terminator = @"aws4_request";
         [urlRequest addValue:@"aws-chunked" forHTTPHeaderField:@"Content-Encoding"]; //add aws-chunked keyword for s3 chunk upload
         [urlRequest setValue:[NSString stringWithFormat:@"%lu", (unsigned long)contentLength] forHTTPHeaderField:@"x-amz-decoded-content-length"];
     } else {
-        contentSha256 = [AWSSignatureSignerUtility hexEncode:[[NSString alloc] initWithData:[AWSSignatureSignerUtility hash:[urlRequest HTTPBody]] encoding:NSASCIIStringEncoding]];
+        contentSha256 = [AWSSignatureSignerUtility hexEncodeData:[AWSSignatureSignerUtility hash:[urlRequest HTTPBody]]];
         //using Content-Length with value of '0' cause auth issue, remove it.
         if (contentLength == 0) {
             [urlRequest setValue:nil forHTTPHeaderField:@"Content-Length"];
@@ -258,7 +355,7 @@ NSString *const AWSSignatureV4Terminator = @"aws4_request";
                               AWSSignatureV4Algorithm,
                               [urlRequest valueForHTTPHeaderField:@"X-Amz-Date"],
                               scope,
-                              [AWSSignatureSignerUtility hexEncode:[AWSSignatureSignerUtility hashString:canonicalRequest]]];
+                              [AWSSignatureSignerUtility hexEncodeData:[AWSSignatureSignerUtility hash:[canonicalRequest dataUsingEncoding:NSUTF8StringEncoding]]]];
     AWSDDLogVerbose(@"AWS4 String to Sign: [%@]", stringToSign);
 
     NSData *kSigning  = [AWSSignatureV4Signer getV4DerivedKey:credentials.secretKey
@@ -268,8 +365,7 @@ NSString *const AWSSignatureV4Terminator = @"aws4_request";
 
     NSData *signature = [AWSSignatureSignerUtility sha256HMacWithData:[stringToSign dataUsingEncoding:NSUTF8StringEncoding]
                                                               withKey:kSigning];
-    NSString *signatureString = [AWSSignatureSignerUtility hexEncode:[[NSString alloc] initWithData:signature
-                                                                                           encoding:NSASCIIStringEncoding]];
+    NSString *signatureString = [AWSSignatureSignerUtility hexEncodeData:signature];
 
     NSString *authorization = [NSString stringWithFormat:@"%@ Credential=%@, SignedHeaders=%@, Signature=%@",
                                AWSSignatureV4Algorithm,
@@ -290,8 +386,53 @@ NSString *const AWSSignatureV4Terminator = @"aws4_request";
 }
 
 
+- (NSString *)contentSha256ForRequest:(NSMutableURLRequest *)request
+                streamedContentLength:(NSNumber **)streamedContentLength
+                                error:(NSError **)error {
+    NSInputStream *stream = request.HTTPBodyStream;
+    if (!stream) {
+        return [AWSSignatureSignerUtility hexEncodeData:[AWSSignatureSignerUtility hash:request.HTTPBody]];
+    }
+
+    // A body stream can be read only once, so it is hashed from the data or file it was made from when the serializer recorded one.
+    id payloadSource = [NSURLProtocol propertyForKey:AWSSignatureV4PayloadSourceKey inRequest:request];
+    if ([payloadSource isKindOfClass:[NSData class]]) {
+        *streamedContentLength = @([payloadSource length]);
+        return [AWSSignatureSignerUtility hexEncodeData:[AWSSignatureSignerUtility hash:payloadSource]];
+    }
+    if ([payloadSource isKindOfClass:[NSString class]]) {
+        NSURL *fileURL = [NSURL fileURLWithPath:payloadSource];
+        NSData *hash = [AWSSignatureSignerUtility hashFileAtURL:fileURL error:error];
+        if (!hash) {
+            return nil;
+        }
+        NSNumber *fileSize = nil;
+        if ([fileURL getResourceValue:&fileSize forKey:NSURLFileSizeKey error:nil]) {
+            *streamedContentLength = fileSize;
+        }
+        return [AWSSignatureSignerUtility hexEncodeData:hash];
+    }
+
+    if (self.allowsUnsignedPayload) {
+        [request setValue:AWSSignatureV4UnsignedPayload forHTTPHeaderField:@"x-amz-content-sha256"];
+        return AWSSignatureV4UnsignedPayload;
+    }
+
+    // Any other stream is read once, hashing as it goes, and the request is sent from what was read.
+    NSMutableData *body = [NSMutableData new];
+    NSData *hash = AWSSignatureHashStream(stream, body, error);
+    if (!hash) {
+        return nil;
+    }
+    request.HTTPBodyStream = [NSInputStream inputStreamWithData:body];
+    [NSURLProtocol setProperty:body forKey:AWSSignatureV4PayloadSourceKey inRequest:request];
+    *streamedContentLength = @([body length]);
+    return [AWSSignatureSignerUtility hexEncodeData:hash];
+}
+
 - (NSString *)signRequestV4:(NSMutableURLRequest *)request
-                credentials:(AWSCredentials *)credentials {
+                credentials:(AWSCredentials *)credentials
+              contentSha256:(NSString *)contentSha256 {
     
     NSString *absoluteString = [request.URL absoluteString];
     if ([absoluteString hasSuffix:@"/"]) {
@@ -314,8 +455,6 @@ NSString *const AWSSignatureV4Terminator = @"aws4_request";
         query = [NSString stringWithFormat:@""];
     }
 
-    NSString *contentSha256 = [AWSSignatureSignerUtility hexEncode:[[NSString alloc] initWithData:[AWSSignatureSignerUtility hash:request.HTTPBody] encoding:NSASCIIStringEncoding]];
-
     NSString *canonicalRequest = [AWSSignatureV4Signer getCanonicalizedRequest:request.HTTPMethod
                                                                           path:path
                                                                          query:query
@@ -337,7 +476,7 @@ NSString *const AWSSignatureV4Terminator = @"aws4_request";
                               AWSSignatureV4Algorithm,
                               [request valueForHTTPHeaderField:@"X-Amz-Date"],
                               scope,
-                              [AWSSignatureSignerUtility hexEncode:[AWSSignatureSignerUtility hashString:canonicalRequest]]];
+                              [AWSSignatureSignerUtility hexEncodeData:[AWSSignatureSignerUtility hash:[canonicalRequest dataUsingEncoding:NSUTF8StringEncoding]]]];
 
     AWSDDLogVerbose(@"AWS4 String to Sign: [%@]", stringToSign);
 
@@ -350,7 +489,7 @@ NSString *const AWSSignatureV4Terminator = @"aws4_request";
 
     NSString *credentialsAuthorizationHeader = [NSString stringWithFormat:@"Credential=%@", signingCredentials];
     NSString *signedHeadersAuthorizationHeader = [NSString stringWithFormat:@"SignedHeaders=%@", [AWSSignatureV4Signer getSignedHeadersString:request.allHTTPHeaderFields]];
-    NSString *signatureAuthorizationHeader = [NSString stringWithFormat:@"Signature=%@", [AWSSignatureSignerUtility hexEncode:[[NSString alloc] initWithData:signature encoding:NSASCIIStringEncoding]]];
+    NSString *signatureAuthorizationHeader = [NSString stringWithFormat:@"Signature=%@", [AWSSignatureSignerUtility hexEncodeData:signature]];
 
     NSString *authorization = [NSString stringWithFormat:@"%@ %@, %@, %@",
                                AWSSignatureV4Algorithm,
@@ -456,9 +595,9 @@ NSString *const AWSSignatureV4Terminator = @"aws4_request";
         NSString *contentSha256;
         if(signBody && httpMethod == AWSHTTPMethodGET){
             //in case of http get we sign the body as an empty string only if the sign body flag is set to true
-            contentSha256 = [AWSSignatureSignerUtility hexEncode:[[NSString alloc] initWithData:[AWSSignatureSignerUtility hash:[@"" dataUsingEncoding:NSUTF8StringEncoding]] encoding:NSASCIIStringEncoding]];
+            contentSha256 = [AWSSignatureSignerUtility hexEncodeData:[AWSSignatureSignerUtility hash:[@"" dataUsingEncoding:NSUTF8StringEncoding]]];
         }else{
-            contentSha256 = @"UNSIGNED-PAYLOAD";
+            contentSha256 = AWSSignatureV4UnsignedPayload;
         }
         //Generate Canonical Request
         NSString *canonicalRequest = [AWSSignatureV4Signer getCanonicalizedRequest:httpMethodString
@@ -473,7 +612,7 @@ NSString *const AWSSignatureV4Terminator = @"aws4_request";
                                   AWSSignatureV4Algorithm,
                                   [currentDate aws_stringValue:AWSDateISO8601DateFormat2],
                                   scope,
-                                  [AWSSignatureSignerUtility hexEncode:[AWSSignatureSignerUtility hashString:canonicalRequest]]];
+                                  [AWSSignatureSignerUtility hexEncodeData:[AWSSignatureSignerUtility hash:[canonicalRequest dataUsingEncoding:NSUTF8StringEncoding]]]];
         
         AWSDDLogVerbose(@"AWS4 PresignedURL String to Sign: [%@]", stringToSign);
         
@@ -484,14 +623,14 @@ NSString *const AWSSignatureV4Terminator = @"aws4_request";
                                                           service:endpoint.serviceName];
         NSData *signature = [AWSSignatureSignerUtility sha256HMacWithData:[stringToSign dataUsingEncoding:NSUTF8StringEncoding]
                                                                   withKey:kSigning];
-        NSString *signatureString = [AWSSignatureSignerUtility hexEncode:[[NSString alloc] initWithData:signature
-                                                                                               encoding:NSASCIIStringEncoding]];
+        NSString *signatureString = [AWSSignatureSignerUtility hexEncodeData:signature];
         
         // ============  generate v4 signature string (END) ===================
         
         [queryString appendFormat:@"%@=%@", @"X-Amz-Signature", signatureString];
         
-        NSString *urlString = [NSString stringWithFormat:@"%@://%@/%@?%@", endpoint.URL.scheme, endpoint.hostName, keyPath, queryString];
+        NSString *host = endpoint.URL.port ? [NSString stringWithFormat:@"%@:%@", endpoint.hostName, endpoint.URL.port] : endpoint.hostName;
+        NSString *urlString = [NSString stringWithFormat:@"%@://%@/%@?%@", endpoint.URL.scheme, host, keyPath, queryString];
         
         return [NSURL URLWithString:urlString];
     }];
@@ -846,8 +985,7 @@ static NSString *const emptyStringSha256 = @"e3b0c44298fc1c149afbf4c8996fb92427a
 }
 
 - (NSString *)dataToHexString:(NSData *) data {
-    return [AWSSignatureSignerUtility hexEncode:[[NSString alloc] initWithData:data
-                                                                      encoding:NSASCIIStringEncoding]];
+    return [AWSSignatureSignerUtility hexEncodeData:data];
 }
 
 #pragma mark NSInputStream methods
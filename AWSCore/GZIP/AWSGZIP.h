@@ -29,6 +29,9 @@
 //
 //  3. This notice may not be removed or altered from any source distribution.
 //
+//  Modified by Amazon Web Services: zlib contexts are pooled and reused,
+//  and AWSGZIPInputStream compresses a body stream while it is being read.
+//
 
 
 #import <Foundation/Foundation.h>
@@ -42,3 +45,38 @@ void awsgzip_loadGZIP(void);
 - (NSData *)awsgzip_gunzippedData;
 
 @end
+
+/**
+ * An input stream that gzip compresses the bytes of another input stream as they are read,
+ * so the uncompressed body never has to be held in memory as a whole.
+ *
+ * The zlib context comes from the same pool used by the `NSData (AWSGZIP)` category
+ * and is returned to it once the stream reaches its end or is closed.
+ * The compressed length is not known up front, so requests using this stream as
+ * `HTTPBodyStream` must not set a `Content-Length` header.
+ **/
+@interface AWSGZIPInputStream : NSInputStream <NSStreamDelegate>
+
+/**
+ * The number of uncompressed bytes consumed from the wrapped stream so far.
+ **/
+@property (atomic, assign, readonly) int64_t totalBytesIn;
+
+/**
+ * The number of compressed bytes produced so far.
+ **/
+@property (atomic, assign, readonly) int64_t totalBytesOut;
+
+/**
+ * Wraps `stream` using the default zlib compression level.
+ **/
+- (instancetype)initWithInputStream:(NSInputStream *)stream;
+
+/**
+ * Wraps `stream`. `level` uses the same scale as `awsgzip_gzippedDataWithCompressionLevel:`:
+ * 0.0 (no compression) to 1.0 (best compression), or a negative value for the zlib default.
+ **/
+- (instancetype)initWithInputStream:(NSInputStream *)stream
+                   compressionLevel:(float)level;
+
+@end
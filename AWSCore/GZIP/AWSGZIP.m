@@ -29,16 +29,154 @@
 //
 //  3. This notice may not be removed or altered from any source distribution.
 //
+//  Modified by Amazon Web Services: zlib contexts are pooled and reused,
+//  and AWSGZIPInputStream compresses a body stream while it is being read.
+//
 
 
 #import "AWSGZIP.h"
 #import <zlib.h>
+#import <pthread.h>
 
 void awsgzip_loadGZIP(){
 }
 
 static const NSUInteger ChunkSize = 16384;
 
+// Deflate cannot compress better than about 1032:1, and a size hint from the input never allocates more than this up front.
+static const NSUInteger MaximumDeflateRatio = 1032;
+static const NSUInteger MaximumInitialInflateLength = 16 * 1024 * 1024;
+
+// Enough for a few concurrent requests; surplus contexts are freed when released.
+enum { ContextPoolSize = 4 };
+
+// 15 window bits, plus 16 to write a gzip wrapper, plus 32 to auto-detect gzip or zlib when inflating.
+static const int GZIPWindowBits = 15 + 16;
+static const int GUNZIPWindowBits = 15 + 32;
+
+typedef struct {
+    z_stream stream;
+    int level;
+} AWSGZIPDeflateContext;
+
+static pthread_mutex_t poolLock = PTHREAD_MUTEX_INITIALIZER;
+static AWSGZIPDeflateContext *deflatePool[ContextPoolSize];
+static NSUInteger deflatePoolCount = 0;
+static z_stream *inflatePool[ContextPoolSize];
+static NSUInteger inflatePoolCount = 0;
+
+static int awsgzip_zlibCompressionLevel(float level) {
+    if (level < 0.0f) {
+        return Z_DEFAULT_COMPRESSION;
+    }
+    return (int)(roundf(MIN(level, 1.0f) * 9));
+}
+
+// deflateInit2 allocates and initializes ~260 KB of state, so contexts are reset and reused instead.
+static AWSGZIPDeflateContext *awsgzip_acquireDeflateContext(int level) {
+    AWSGZIPDeflateContext *context = NULL;
+
+    pthread_mutex_lock(&poolLock);
+    for (NSUInteger i = deflatePoolCount; i > 0; i--) {
+        if (deflatePool[i - 1]->level == level) {
+            context = deflatePool[i - 1];
+            deflatePool[i - 1] = deflatePool[deflatePoolCount - 1];
+            deflatePoolCount--;
+            break;
+        }
+    }
+    if (context == NULL && deflatePoolCount > 0) {
+        context = deflatePool[--deflatePoolCount];
+    }
+    pthread_mutex_unlock(&poolLock);
+
+    if (context) {
+        if (context->level == level && deflateReset(&context->stream) == Z_OK) {
+            return context;
+        }
+        deflateEnd(&context->stream);
+    } else {
+        context = malloc(sizeof(AWSGZIPDeflateContext));
+        if (context == NULL) {
+            return NULL;
+        }
+    }
+
+    memset(&context->stream, 0, sizeof(z_stream));
+    if (deflateInit2(&context->stream, level, Z_DEFLATED, GZIPWindowBits, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        free(context);
+        return NULL;
+    }
+    context->level = level;
+
+    return context;
+}
+
+static void awsgzip_releaseDeflateContext(AWSGZIPDeflateContext *context) {
+    if (context == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&poolLock);
+    if (deflatePoolCount < ContextPoolSize) {
+        deflatePool[deflatePoolCount++] = context;
+        context = NULL;
+    }
+    pthread_mutex_unlock(&poolLock);
+
+    if (context) {
+        deflateEnd(&context->stream);
+        free(context);
+    }
+}
+
+static z_stream *awsgzip_acquireInflateStream(void) {
+    z_stream *stream = NULL;
+
+    pthread_mutex_lock(&poolLock);
+    if (inflatePoolCount > 0) {
+        stream = inflatePool[--inflatePoolCount];
+    }
+    pthread_mutex_unlock(&poolLock);
+
+    if (stream) {
+        if (inflateReset(stream) == Z_OK) {
+            return stream;
+        }
+        inflateEnd(stream);
+    } else {
+        stream = malloc(sizeof(z_stream));
+        if (stream == NULL) {
+            return NULL;
+        }
+    }
+
+    memset(stream, 0, sizeof(z_stream));
+    if (inflateInit2(stream, GUNZIPWindowBits) != Z_OK) {
+        free(stream);
+        return NULL;
+    }
+
+    return stream;
+}
+
+static void awsgzip_releaseInflateStream(z_stream *stream) {
+    if (stream == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&poolLock);
+    if (inflatePoolCount < ContextPoolSize) {
+        inflatePool[inflatePoolCount++] = stream;
+        stream = NULL;
+    }
+    pthread_mutex_unlock(&poolLock);
+
+    if (stream) {
+        inflateEnd(stream);
+        free(stream);
+    }
+}
 
 @implementation NSData (AWSGZIP)
 
@@ -46,31 +184,31 @@ static const NSUInteger ChunkSize = 16384;
 {
     if ([self length])
     {
-        z_stream stream;
-        stream.zalloc = Z_NULL;
-        stream.zfree = Z_NULL;
-        stream.opaque = Z_NULL;
-        stream.avail_in = (uint)[self length];
-        stream.next_in = (Bytef *)[self bytes];
-        stream.total_out = 0;
-        stream.avail_out = 0;
-        
-        int compression = (level < 0.0f)? Z_DEFAULT_COMPRESSION: (int)(roundf(level * 9));
-        if (deflateInit2(&stream, compression, Z_DEFLATED, 31, 8, Z_DEFAULT_STRATEGY) == Z_OK)
+        AWSGZIPDeflateContext *context = awsgzip_acquireDeflateContext(awsgzip_zlibCompressionLevel(level));
+        if (context == NULL)
         {
-            NSMutableData *data = [NSMutableData dataWithLength:ChunkSize];
-            while (stream.avail_out == 0)
-            {
-                if (stream.total_out >= [data length])
-                {
-                    data.length += ChunkSize;
-                }
-                stream.next_out = (uint8_t *)[data mutableBytes] + stream.total_out;
-                stream.avail_out = (uInt)([data length] - stream.total_out);
-                deflate(&stream, Z_FINISH);
-            }
-            deflateEnd(&stream);
-            data.length = stream.total_out;
+            return nil;
+        }
+
+        z_stream *stream = &context->stream;
+
+        // deflateBound is an upper limit for the output (including the gzip wrapper),
+        // so a single allocation and a single deflate call are enough.
+        uLong bound = deflateBound(stream, (uLong)[self length]);
+        NSMutableData *data = [NSMutableData dataWithLength:bound];
+
+        stream->next_in = (Bytef *)[self bytes];
+        stream->avail_in = (uInt)[self length];
+        stream->next_out = (Bytef *)[data mutableBytes];
+        stream->avail_out = (uInt)bound;
+
+        int status = deflate(stream, Z_FINISH);
+        uLong totalOut = stream->total_out;
+        awsgzip_releaseDeflateContext(context);
+
+        if (status == Z_STREAM_END)
+        {
+            data.length = totalOut;
             return data;
         }
     }
@@ -84,41 +222,239 @@ static const NSUInteger ChunkSize = 16384;
 
 - (NSData *)awsgzip_gunzippedData
 {
-    if ([self length])
+    NSUInteger length = [self length];
+    if (length)
     {
-        z_stream stream;
-        stream.zalloc = Z_NULL;
-        stream.zfree = Z_NULL;
-        stream.avail_in = (uint)[self length];
-        stream.next_in = (Bytef *)[self bytes];
-        stream.total_out = 0;
-        stream.avail_out = 0;
-        
-        NSMutableData *data = [NSMutableData dataWithLength:(NSUInteger)([self length] * 1.5)];
-        if (inflateInit2(&stream, 47) == Z_OK)
+        // The last four bytes of a gzip member store the uncompressed size modulo 2^32.
+        // They come from the input, so they are only a hint: a size deflate could not have produced
+        // is ignored, the initial buffer is capped, and the buffer grows below if the hint is short.
+        NSUInteger expectedLength = length * 2;
+        const uint8_t *bytes = [self bytes];
+        if (length >= 18 && bytes[0] == 0x1f && bytes[1] == 0x8b)
         {
-            int status = Z_OK;
-            while (status == Z_OK)
+            uint32_t isize = (uint32_t)bytes[length - 4]
+            | ((uint32_t)bytes[length - 3] << 8)
+            | ((uint32_t)bytes[length - 2] << 16)
+            | ((uint32_t)bytes[length - 1] << 24);
+            if (isize > 0 && isize / MaximumDeflateRatio <= length)
             {
-                if (stream.total_out >= [data length])
-                {
-                    data.length += [self length] / 2;
-                }
-                stream.next_out = (uint8_t *)[data mutableBytes] + stream.total_out;
-                stream.avail_out = (uInt)([data length] - stream.total_out);
-                status = inflate (&stream, Z_SYNC_FLUSH);
+                expectedLength = MIN((NSUInteger)isize, MaximumInitialInflateLength);
             }
-            if (inflateEnd(&stream) == Z_OK)
+        }
+
+        z_stream *stream = awsgzip_acquireInflateStream();
+        if (stream == NULL)
+        {
+            return nil;
+        }
+
+        NSMutableData *data = [NSMutableData dataWithLength:expectedLength];
+        stream->avail_in = (uInt)length;
+        stream->next_in = (Bytef *)bytes;
+
+        int status = Z_OK;
+        while (status == Z_OK)
+        {
+            if (stream->total_out >= [data length])
             {
-                if (status == Z_STREAM_END)
-                {
-                    data.length = stream.total_out;
-                    return data;
-                }
+                data.length += MAX(ChunkSize, [data length] / 2);
             }
+            stream->next_out = (uint8_t *)[data mutableBytes] + stream->total_out;
+            stream->avail_out = (uInt)([data length] - stream->total_out);
+            status = inflate(stream, Z_SYNC_FLUSH);
+        }
+
+        uLong totalOut = stream->total_out;
+        awsgzip_releaseInflateStream(stream);
+
+        if (status == Z_STREAM_END)
+        {
+            data.length = totalOut;
+            return data;
         }
     }
     return nil;
 }
 
 @end
+
+#pragma mark - AWSGZIPInputStream
+
+@interface AWSGZIPInputStream()
+
+@property (atomic, assign, readwrite) int64_t totalBytesIn;
+@property (atomic, assign, readwrite) int64_t totalBytesOut;
+
+@end
+
+@implementation AWSGZIPInputStream {
+    NSInputStream *_stream;
+    int _level;
+    AWSGZIPDeflateContext *_context;
+    uint8_t *_inBuffer;
+    BOOL _sourceAtEnd;
+    BOOL _finished;
+    NSError *_error;
+}
+
+@synthesize delegate = _delegate;
+
+- (instancetype)initWithInputStream:(NSInputStream *)stream {
+    return [self initWithInputStream:stream compressionLevel:-1.0f];
+}
+
+- (instancetype)initWithInputStream:(NSInputStream *)stream
+                   compressionLevel:(float)level {
+    if (self = [super init]) {
+        _stream = stream;
+        _stream.delegate = self;
+        _level = awsgzip_zlibCompressionLevel(level);
+    }
+
+    return self;
+}
+
+- (void)dealloc {
+    [self releaseResources];
+}
+
+- (void)releaseResources {
+    awsgzip_releaseDeflateContext(_context);
+    _context = NULL;
+    free(_inBuffer);
+    _inBuffer = NULL;
+}
+
+- (void)stream:(NSStream *)aStream handleEvent:(NSStreamEvent)eventCode {
+    if (!_finished && (eventCode & NSStreamEventEndEncountered)) {
+        // The compressed stream still has the zlib trailer to deliver.
+        eventCode ^= NSStreamEventEndEncountered;
+        eventCode |= NSStreamEventHasBytesAvailable;
+    }
+    if ([self.delegate respondsToSelector:@selector(stream:handleEvent:)]) {
+        [self.delegate stream:self handleEvent:eventCode];
+    }
+}
+
+#pragma mark NSInputStream methods
+
+- (NSInteger)read:(uint8_t *)buffer maxLength:(NSUInteger)len {
+    if (_finished || len == 0) {
+        return 0;
+    }
+    if (_context == NULL || _inBuffer == NULL) {
+        return -1;
+    }
+
+    z_stream *stream = &_context->stream;
+    stream->next_out = buffer;
+    stream->avail_out = (uInt)MIN(len, (NSUInteger)UINT_MAX);
+    uInt outCapacity = stream->avail_out;
+
+    while (stream->avail_out > 0 && !_finished) {
+        if (stream->avail_in == 0 && !_sourceAtEnd) {
+            // Hand back what is compressed so far rather than blocking on a source without data.
+            if (stream->avail_out < outCapacity && ![_stream hasBytesAvailable]) {
+                break;
+            }
+
+            NSInteger read = [_stream read:_inBuffer maxLength:ChunkSize];
+            if (read < 0) {
+                _error = [_stream streamError];
+                return -1;
+            }
+            _sourceAtEnd = (read == 0);
+            stream->next_in = _inBuffer;
+            stream->avail_in = (uInt)read;
+            self.totalBytesIn += read;
+        }
+
+        int status = deflate(stream, _sourceAtEnd ? Z_FINISH : Z_NO_FLUSH);
+        if (status == Z_STREAM_END) {
+            _finished = YES;
+        } else if (status != Z_OK && status != Z_BUF_ERROR) {
+            _error = [NSError errorWithDomain:@"com.amazonaws.AWSGZIPInputStream" code:status userInfo:nil];
+            return -1;
+        }
+    }
+
+    NSInteger produced = outCapacity - stream->avail_out;
+    self.totalBytesOut += produced;
+
+    if (_finished) {
+        // Nothing else will be compressed, give the context back to the pool right away.
+        [self releaseResources];
+    }
+
+    return produced;
+}
+
+- (BOOL)hasBytesAvailable {
+    return !_finished;
+}
+
+- (BOOL)getBuffer:(uint8_t **)buffer length:(NSUInteger *)len {
+    return NO;
+}
+
+- (void)open {
+    if (_context == NULL && !_finished) {
+        _context = awsgzip_acquireDeflateContext(_level);
+        _inBuffer = malloc(ChunkSize);
+    }
+    [_stream open];
+}
+
+- (void)close {
+    [_stream close];
+    [self releaseResources];
+}
+
+- (void)setDelegate:(id<NSStreamDelegate>)delegate {
+    if (delegate == nil) {
+        _delegate = self;
+    } else {
+        _delegate = delegate;
+    }
+}
+
+- (void)scheduleInRunLoop:(NSRunLoop *)aRunLoop forMode:(NSString *)mode {
+    [_stream scheduleInRunLoop:aRunLoop forMode:mode];
+}
+
+- (void)removeFromRunLoop:(NSRunLoop *)aRunLoop forMode:(NSString *)mode {
+    [_stream removeFromRunLoop:aRunLoop forMode:mode];
+}
+
+- (id)propertyForKey:(NSString *)key {
+    return [_stream propertyForKey:key];
+}
+
+- (BOOL)setProperty:(id)property forKey:(NSString *)key {
+    return [_stream setProperty:property forKey:key];
+}
+
+- (NSStreamStatus)streamStatus {
+    if (_error) {
+        return NSStreamStatusError;
+    }
+    if (_finished) {
+        return NSStreamStatusAtEnd;
+    }
+    NSStreamStatus status = [_stream streamStatus];
+    return status == NSStreamStatusAtEnd ? NSStreamStatusOpen : status;
+}
+
+- (NSError *)streamError {
+    return _error ?: [_stream streamError];
+}
+
+- (NSMethodSignature *)methodSignatureForSelector:(SEL)aSelector {
+    return [_stream methodSignatureForSelector:aSelector];
+}
+
+- (void)forwardInvocation:(NSInvocation *)anInvocation {
+    [anInvocation invokeWithTarget:_stream];
+}
+
+@end
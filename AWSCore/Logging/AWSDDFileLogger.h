@@ -33,6 +33,7 @@
 // rollingFrequency        -> kAWSDDDefaultLogRollingFrequency
 // maximumNumberOfLogFiles -> kAWSDDDefaultLogMaxNumLogFiles
 // logFilesDiskQuota       -> kAWSDDDefaultLogFilesDiskQuota
+// flushInterval           -> kAWSDDDefaultLogFlushInterval
 //
 // You should carefully consider the proper configuration values for your application.
 
@@ -40,6 +41,25 @@ extern unsigned long long const kAWSDDDefaultLogMaxFileSize;
 extern NSTimeInterval     const kAWSDDDefaultLogRollingFrequency;
 extern NSUInteger         const kAWSDDDefaultLogMaxNumLogFiles;
 extern unsigned long long const kAWSDDDefaultLogFilesDiskQuota;
+extern NSTimeInterval     const kAWSDDDefaultLogFlushInterval;
+
+/**
+ *  Controls when `AWSDDFileLogger` asks the file system to commit written log data to stable storage.
+ */
+typedef NS_ENUM(NSInteger, AWSDDFileLoggerSyncPolicy) {
+    /**
+     *  Sync only when the log file is rolled or the logger is removed. This is the default.
+     */
+    AWSDDFileLoggerSyncPolicyOnRoll = 0,
+    /**
+     *  Sync after every flush of the write buffer (or after every message when buffering is disabled).
+     */
+    AWSDDFileLoggerSyncPolicyOnFlush,
+    /**
+     *  Never sync explicitly, the kernel writes the data back on its own schedule. This is the fastest option.
+     */
+    AWSDDFileLoggerSyncPolicyNone,
+};
 
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -248,6 +268,26 @@ extern unsigned long long const kAWSDDDefaultLogFilesDiskQuota;
  **/
 - (BOOL)isLogFile:(NSString *)fileName NS_SWIFT_NAME(isLogFile(withName:));
 
+/**
+ * When set, log files are gzip compressed on a background queue as soon as they are archived.
+ * The compressed file keeps the name of the original with a `.gz` suffix appended,
+ * and replaces it once compression has finished.
+ *
+ * Since `logFilesDiskQuota` is checked against the size of the files on disk,
+ * the quota is accounted on the compressed size of archived log files.
+ *
+ * Old log files are deleted on the same background queue, so no file is deleted while it is being compressed.
+ *
+ * Default value is NO.
+ **/
+@property (readwrite, assign, atomic) BOOL compressesArchivedLogFiles;
+
+/**
+ * The zlib compression level (0-9) used for archived log files, or -1 for the zlib default.
+ * Only used when `compressesArchivedLogFiles` is set. Default value is -1.
+ **/
+@property (readwrite, assign, atomic) NSInteger compressionLevel;
+
 /* Inherited from AWSDDLogFileManager protocol:
 
    @property (readwrite, assign, atomic) NSUInteger maximumNumberOfLogFiles;
@@ -378,6 +418,37 @@ extern unsigned long long const kAWSDDDefaultLogFilesDiskQuota;
  */
 @property (readwrite, assign, atomic) BOOL doNotReuseLogFiles;
 
+/**
+ * Log Write Buffering:
+ *
+ * `logBufferSize`
+ *   The number of bytes to accumulate in memory before they are written to the log file.
+ *   Buffering avoids one `write` system call per log statement, which matters for verbose logging.
+ *   Set it to zero (the default) to write every log statement to the file as soon as it is logged.
+ *
+ * `flushInterval`
+ *   The maximum time a buffered log statement may sit in memory before it is written to the file.
+ *   Only used when `logBufferSize` is greater than zero. Defaults to `kAWSDDDefaultLogFlushInterval`.
+ *
+ * `syncPolicy`
+ *   When written data is synced to stable storage. See `AWSDDFileLoggerSyncPolicy`.
+ *   Defaults to `AWSDDFileLoggerSyncPolicyOnRoll`.
+ *
+ * Buffered data is always written out before the log file is rolled,
+ * and when `[AWSDDLog flushLog]` is invoked.
+ **/
+@property (readwrite, assign, atomic) NSUInteger logBufferSize;
+
+/**
+ *  See description for `logBufferSize`
+ */
+@property (readwrite, assign, atomic) NSTimeInterval flushInterval;
+
+/**
+ *  See description for `logBufferSize`
+ */
+@property (readwrite, assign, atomic) AWSDDFileLoggerSyncPolicy syncPolicy;
+
 /**
  * The AWSDDLogFileManager instance can be used to retrieve the list of log files,
  * and configure the maximum number of archived log files to keep.
@@ -16,9 +16,11 @@
 #import "AWSDDFileLogger.h"
 
 #import <unistd.h>
+#import <fcntl.h>
 #import <sys/attr.h>
 #import <sys/xattr.h>
 #import <libkern/OSAtomic.h>
+#import <zlib.h>
 
 #if !__has_feature(objc_arc)
 #error This file must be compiled with ARC. Use -fobjc-arc flag (or convert project to ARC).
@@ -50,6 +52,11 @@ unsigned long long const kAWSDDDefaultLogMaxFileSize      = 1024 * 1024;      //
 NSTimeInterval     const kAWSDDDefaultLogRollingFrequency = 60 * 60 * 24;     // 24 Hours
 NSUInteger         const kAWSDDDefaultLogMaxNumLogFiles   = 5;                // 5 Files
 unsigned long long const kAWSDDDefaultLogFilesDiskQuota   = 20 * 1024 * 1024; // 20 MB
+NSTimeInterval     const kAWSDDDefaultLogFlushInterval    = 1;                // 1 Second
+
+static NSUInteger const kAWSDDLogFileCompressionChunkSize = 64 * 1024;
+
+static BOOL AWSDDGzipFileAtPath(NSString *sourcePath, NSString *destinationPath, int level);
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark -
@@ -59,12 +66,17 @@ unsigned long long const kAWSDDDefaultLogFilesDiskQuota   = 20 * 1024 * 1024; //
     NSUInteger _maximumNumberOfLogFiles;
     unsigned long long _logFilesDiskQuota;
     NSString *_logsDirectory;
+    BOOL _compressesArchivedLogFiles;
+    NSInteger _compressionLevel;
+    dispatch_queue_t _fileMaintenanceQueue;
 #if TARGET_OS_IPHONE
     NSString *_defaultFileProtectionLevel;
 #endif
 }
 
 - (void)deleteOldLogFiles;
+- (void)scheduleDeletingOldLogFiles;
+- (void)compressArchivedLogFiles;
 - (NSString *)defaultLogsDirectory;
 
 @end
@@ -73,6 +85,8 @@ unsigned long long const kAWSDDDefaultLogFilesDiskQuota   = 20 * 1024 * 1024; //
 
 @synthesize maximumNumberOfLogFiles = _maximumNumberOfLogFiles;
 @synthesize logFilesDiskQuota = _logFilesDiskQuota;
+@synthesize compressesArchivedLogFiles = _compressesArchivedLogFiles;
+@synthesize compressionLevel = _compressionLevel;
 
 
 - (instancetype)init {
@@ -83,6 +97,11 @@ unsigned long long const kAWSDDDefaultLogFilesDiskQuota   = 20 * 1024 * 1024; //
     if ((self = [super init])) {
         _maximumNumberOfLogFiles = kAWSDDDefaultLogMaxNumLogFiles;
         _logFilesDiskQuota = kAWSDDDefaultLogFilesDiskQuota;
+        _compressionLevel = Z_DEFAULT_COMPRESSION;
+
+        // Compressing and deleting log files both happen on this queue, so a file is never deleted while it is being compressed.
+        _fileMaintenanceQueue = dispatch_queue_create("cocoa.lumberjack.logFileMaintenance", DISPATCH_QUEUE_SERIAL);
+        dispatch_set_target_queue(_fileMaintenanceQueue, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_BACKGROUND, 0));
 
         if (aLogsDirectory) {
             _logsDirectory = [aLogsDirectory copy];
@@ -159,9 +178,7 @@ unsigned long long const kAWSDDDefaultLogFilesDiskQuota   = 20 * 1024 * 1024; //
         [keyPath isEqualToString:NSStringFromSelector(@selector(logFilesDiskQuota))]) {
         NSLogInfo(@"AWSDDFileLogManagerDefault: Responding to configuration change: %@", keyPath);
 
-        dispatch_async([AWSDDLog loggingQueue], ^{ @autoreleasepool {
-                                                    [self deleteOldLogFiles];
-                                                } });
+        [self scheduleDeletingOldLogFiles];
     }
 }
 
@@ -169,8 +186,18 @@ unsigned long long const kAWSDDDefaultLogFilesDiskQuota   = 20 * 1024 * 1024; //
 #pragma mark File Deleting
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+/**
+ * Deletes old log files on the file maintenance queue.
+ **/
+- (void)scheduleDeletingOldLogFiles {
+    dispatch_async(_fileMaintenanceQueue, ^{ @autoreleasepool {
+        [self deleteOldLogFiles];
+    } });
+}
+
 /**
  * Deletes archived log files that exceed the maximumNumberOfLogFiles or logFilesDiskQuota configuration values.
+ * Must be called on the file maintenance queue.
  **/
 - (void)deleteOldLogFiles {
     NSLogVerbose(@"AWSDDLogFileManagerDefault: deleteOldLogFiles");
@@ -277,6 +304,11 @@ unsigned long long const kAWSDDDefaultLogFilesDiskQuota   = 20 * 1024 * 1024; //
 }
 
 - (BOOL)isLogFile:(NSString *)fileName {
+    // Archived log files may have been compressed, see compressArchivedLogFiles.
+    if ([fileName hasSuffix:@".gz"]) {
+        fileName = [fileName stringByDeletingPathExtension];
+    }
+
     NSString *appName = [self applicationName];
 
     BOOL hasProperPrefix = [fileName hasPrefix:appName];
@@ -478,7 +510,7 @@ unsigned long long const kAWSDDDefaultLogFilesDiskQuota   = 20 * 1024 * 1024; //
             [[NSFileManager defaultManager] createFileAtPath:filePath contents:nil attributes:attributes];
 
             // Since we just created a new log file, we may need to delete some old log files
-            [self deleteOldLogFiles];
+            [self scheduleDeletingOldLogFiles];
 
             return filePath;
         } else {
@@ -487,6 +519,177 @@ unsigned long long const kAWSDDDefaultLogFilesDiskQuota   = 20 * 1024 * 1024; //
     } while (YES);
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Compression
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)didArchiveLogFile:(NSString *)logFilePath {
+    if (self.compressesArchivedLogFiles) {
+        [self compressArchivedLogFiles];
+    }
+}
+
+- (void)didRollAndArchiveLogFile:(NSString *)logFilePath {
+    if (self.compressesArchivedLogFiles) {
+        [self compressArchivedLogFiles];
+    }
+}
+
+/**
+ * Compresses every archived log file that isn't compressed yet, on the file maintenance queue.
+ * This also picks up files left uncompressed by a previous run of the application.
+ **/
+- (void)compressArchivedLogFiles {
+    dispatch_async(_fileMaintenanceQueue, ^{ @autoreleasepool {
+        BOOL didCompress = NO;
+
+        for (AWSDDLogFileInfo *logFileInfo in [self unsortedLogFileInfos]) {
+            if (logFileInfo.isArchived && ![logFileInfo.filePath hasSuffix:@".gz"]) {
+                didCompress |= [self compressLogFile:logFileInfo];
+            }
+        }
+
+        if (didCompress) {
+            // The disk quota is accounted on the compressed sizes, so older files may fit again (or not).
+            [self deleteOldLogFiles];
+        }
+    } });
+}
+
+- (BOOL)compressLogFile:(AWSDDLogFileInfo *)logFileInfo {
+    NSString *sourcePath = logFileInfo.filePath;
+    NSString *compressedPath = [sourcePath stringByAppendingPathExtension:@"gz"];
+    // The temporary name does not pass isLogFile:, so a partially written file is never picked up as a log file.
+    NSString *temporaryPath = [compressedPath stringByAppendingPathExtension:@"tmp"];
+
+    NSDictionary *sourceAttributes = logFileInfo.fileAttributes;
+    NSDate *creationDate = logFileInfo.creationDate;
+
+    NSLogVerbose(@"AWSDDLogFileManagerDefault: Compressing log file: %@", logFileInfo.fileName);
+
+    if (!AWSDDGzipFileAtPath(sourcePath, temporaryPath, (int)self.compressionLevel)) {
+        NSLogError(@"AWSDDLogFileManagerDefault: Failed to compress log file: %@", logFileInfo.fileName);
+        [[NSFileManager defaultManager] removeItemAtPath:temporaryPath error:nil];
+        return NO;
+    }
+
+    // Keep the original creation date so the compressed file retains its place in sortedLogFileInfos.
+    NSMutableDictionary *attributes = [NSMutableDictionary dictionary];
+    if (creationDate) {
+        attributes[NSFileCreationDate] = creationDate;
+    }
+#if TARGET_OS_IPHONE
+    if (sourceAttributes[NSFileProtectionKey]) {
+        attributes[NSFileProtectionKey] = sourceAttributes[NSFileProtectionKey];
+    }
+#endif
+    [[NSFileManager defaultManager] setAttributes:attributes ofItemAtPath:temporaryPath error:nil];
+
+    NSError *error = nil;
+    [[NSFileManager defaultManager] removeItemAtPath:compressedPath error:nil];
+    if (![[NSFileManager defaultManager] moveItemAtPath:temporaryPath toPath:compressedPath error:&error]) {
+        NSLogError(@"AWSDDLogFileManagerDefault: Error renaming compressed log file (%@): %@", logFileInfo.fileName, error);
+        [[NSFileManager defaultManager] removeItemAtPath:temporaryPath error:nil];
+        return NO;
+    }
+
+    [[NSFileManager defaultManager] removeItemAtPath:sourcePath error:nil];
+
+    return YES;
+}
+
+/**
+ * Streams the file at sourcePath through zlib into a gzip file at destinationPath.
+ * Only one chunk of each file is held in memory at a time.
+ **/
+static BOOL AWSDDGzipFileAtPath(NSString *sourcePath, NSString *destinationPath, int level) {
+    int sourceFd = open([sourcePath fileSystemRepresentation], O_RDONLY);
+    if (sourceFd < 0) {
+        return NO;
+    }
+
+    int destinationFd = open([destinationPath fileSystemRepresentation], O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (destinationFd < 0) {
+        close(sourceFd);
+        return NO;
+    }
+
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+
+    if (level < Z_DEFAULT_COMPRESSION || level > Z_BEST_COMPRESSION) {
+        level = Z_DEFAULT_COMPRESSION;
+    }
+
+    // windowBits of 15 + 16 makes zlib write a gzip header and trailer.
+    if (deflateInit2(&stream, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        close(sourceFd);
+        close(destinationFd);
+        return NO;
+    }
+
+    Bytef *inBuffer = malloc(kAWSDDLogFileCompressionChunkSize);
+    Bytef *outBuffer = malloc(kAWSDDLogFileCompressionChunkSize);
+    BOOL success = (inBuffer != NULL && outBuffer != NULL);
+    int flush = Z_NO_FLUSH;
+
+    while (success && flush != Z_FINISH) {
+        ssize_t bytesRead = read(sourceFd, inBuffer, kAWSDDLogFileCompressionChunkSize);
+        if (bytesRead < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            success = NO;
+            break;
+        }
+
+        stream.next_in = inBuffer;
+        stream.avail_in = (uInt)bytesRead;
+        flush = (bytesRead == 0) ? Z_FINISH : Z_NO_FLUSH;
+
+        do {
+            stream.next_out = outBuffer;
+            stream.avail_out = (uInt)kAWSDDLogFileCompressionChunkSize;
+
+            if (deflate(&stream, flush) == Z_STREAM_ERROR) {
+                success = NO;
+                break;
+            }
+
+            size_t pending = kAWSDDLogFileCompressionChunkSize - stream.avail_out;
+            const Bytef *cursor = outBuffer;
+            while (pending > 0) {
+                ssize_t written = write(destinationFd, cursor, pending);
+                if (written < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    success = NO;
+                    break;
+                }
+                cursor += written;
+                pending -= (size_t)written;
+            }
+        } while (success && stream.avail_out == 0);
+    }
+
+    deflateEnd(&stream);
+    free(inBuffer);
+    free(outBuffer);
+
+    // Make sure the compressed data is on disk before the original file gets deleted.
+    if (success && fsync(destinationFd) != 0) {
+        success = NO;
+    }
+
+    close(sourceFd);
+    if (close(destinationFd) != 0) {
+        success = NO;
+    }
+
+    return success;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark Utility
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -561,12 +764,16 @@ unsigned long long const kAWSDDDefaultLogFilesDiskQuota   = 20 * 1024 * 1024; //
     
     dispatch_source_t _currentLogFileVnode;
     dispatch_source_t _rollingTimer;
+    dispatch_source_t _flushTimer;
+    
+    NSMutableData *_writeBuffer;
     
     unsigned long long _maximumFileSize;
     NSTimeInterval _rollingFrequency;
 }
 
 - (void)rollLogFileNow;
+- (void)flushWriteBuffer;
 - (void)maybeRollLogFileDueToAge;
 - (void)maybeRollLogFileDueToSize;
 
@@ -584,6 +791,7 @@ unsigned long long const kAWSDDDefaultLogFilesDiskQuota   = 20 * 1024 * 1024; //
     if ((self = [super init])) {
         _maximumFileSize = kAWSDDDefaultLogMaxFileSize;
         _rollingFrequency = kAWSDDDefaultLogRollingFrequency;
+        _flushInterval = kAWSDDDefaultLogFlushInterval;
         _automaticallyAppendNewlineForCustomFormatters = YES;
 
         logFileManager = aLogFileManager;
@@ -595,9 +803,22 @@ unsigned long long const kAWSDDDefaultLogFilesDiskQuota   = 20 * 1024 * 1024; //
 }
 
 - (void)dealloc {
+    if (_writeBuffer.length > 0) {
+        @try {
+            [_currentLogFileHandle writeData:_writeBuffer];
+        } @catch (NSException *exception) {
+            NSLogError(@"AWSDDFileLogger: Failed to write buffered log data: %@", exception);
+        }
+    }
+
     [_currentLogFileHandle synchronizeFile];
     [_currentLogFileHandle closeFile];
 
+    if (_flushTimer) {
+        dispatch_source_cancel(_flushTimer);
+        _flushTimer = NULL;
+    }
+
     if (_currentLogFileVnode) {
         dispatch_source_cancel(_currentLogFileVnode);
         _currentLogFileVnode = NULL;
@@ -614,6 +835,9 @@ unsigned long long const kAWSDDDefaultLogFilesDiskQuota   = 20 * 1024 * 1024; //
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 @synthesize logFileManager;
+@synthesize logBufferSize = _logBufferSize;
+@synthesize flushInterval = _flushInterval;
+@synthesize syncPolicy = _syncPolicy;
 
 - (unsigned long long)maximumFileSize {
     __block unsigned long long result;
@@ -817,7 +1041,11 @@ unsigned long long const kAWSDDDefaultLogFilesDiskQuota   = 20 * 1024 * 1024; //
         return;
     }
 
-    [_currentLogFileHandle synchronizeFile];
+    [self flushWriteBuffer];
+
+    if (_syncPolicy != AWSDDFileLoggerSyncPolicyNone) {
+        [_currentLogFileHandle synchronizeFile];
+    }
     [_currentLogFileHandle closeFile];
     _currentLogFileHandle = nil;
 
@@ -838,6 +1066,11 @@ unsigned long long const kAWSDDDefaultLogFilesDiskQuota   = 20 * 1024 * 1024; //
         dispatch_source_cancel(_rollingTimer);
         _rollingTimer = NULL;
     }
+
+    if (_flushTimer) {
+        dispatch_source_cancel(_flushTimer);
+        _flushTimer = NULL;
+    }
 }
 
 - (void)maybeRollLogFileDueToAge {
@@ -857,7 +1090,9 @@ unsigned long long const kAWSDDDefaultLogFilesDiskQuota   = 20 * 1024 * 1024; //
     // Note: Use direct access to maximumFileSize variable.
     // We specifically wrote our own getter/setter method to allow us to do this (for performance reasons).
 
-    if (_maximumFileSize > 0) {
+    // While log statements are buffered the file doesn't grow, so there is no need to ask for its size.
+    // The check runs again right after the buffer is written out.
+    if (_maximumFileSize > 0 && _writeBuffer.length == 0) {
         unsigned long long fileSize = [_currentLogFileHandle offsetInFile];
 
         if (fileSize >= _maximumFileSize) {
@@ -983,6 +1218,82 @@ unsigned long long const kAWSDDDefaultLogFilesDiskQuota   = 20 * 1024 * 1024; //
     return _currentLogFileHandle;
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Write Buffering
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)appendToWriteBuffer:(NSString *)message {
+    // This method is called from logMessage.
+    // Keep it FAST.
+
+    if (_writeBuffer == nil) {
+        _writeBuffer = [[NSMutableData alloc] initWithCapacity:_logBufferSize];
+    }
+
+    // Open the file (and start the rolling timer) with the first message, exactly as the unbuffered path does.
+    [self currentLogFileHandle];
+
+    const char *bytes = [message UTF8String];
+    if (bytes) {
+        [_writeBuffer appendBytes:bytes length:strlen(bytes)];
+    }
+
+    if (_writeBuffer.length >= _logBufferSize) {
+        [self flushWriteBuffer];
+    } else {
+        [self scheduleTimerToFlushWriteBuffer];
+    }
+}
+
+- (void)flushWriteBuffer {
+    if (_writeBuffer.length == 0) {
+        return;
+    }
+
+    @try {
+        [[self currentLogFileHandle] writeData:_writeBuffer];
+
+        if (_syncPolicy == AWSDDFileLoggerSyncPolicyOnFlush) {
+            [_currentLogFileHandle synchronizeFile];
+        }
+    } @catch (NSException *exception) {
+        NSLogError(@"AWSDDFileLogger: Failed to write buffered log data: %@", exception);
+    }
+
+    // Keeps the allocated capacity around for the next batch.
+    [_writeBuffer setLength:0];
+}
+
+- (void)scheduleTimerToFlushWriteBuffer {
+    if (_flushTimer || _flushInterval <= 0.0) {
+        return;
+    }
+
+    // A one-shot timer, armed only while there is buffered data, so an idle logger never wakes up.
+    _flushTimer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, self.loggerQueue);
+
+    dispatch_source_set_event_handler(_flushTimer, ^{ @autoreleasepool {
+                                                         if (_flushTimer) {
+                                                             dispatch_source_cancel(_flushTimer);
+                                                             _flushTimer = NULL;
+                                                         }
+
+                                                         [self flushWriteBuffer];
+                                                         [self maybeRollLogFileDueToSize];
+                                                     } });
+
+    #if !OS_OBJECT_USE_OBJC
+    dispatch_source_t theFlushTimer = _flushTimer;
+    dispatch_source_set_cancel_handler(_flushTimer, ^{
+        dispatch_release(theFlushTimer);
+    });
+    #endif
+
+    uint64_t interval = (uint64_t)(_flushInterval * (NSTimeInterval) NSEC_PER_SEC);
+    dispatch_source_set_timer(_flushTimer, dispatch_time(DISPATCH_TIME_NOW, interval), DISPATCH_TIME_FOREVER, interval / 10);
+    dispatch_resume(_flushTimer);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark AWSDDLogger Protocol
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1003,12 +1314,23 @@ static int exception_count = 0;
             message = [message stringByAppendingString:@"\n"];
         }
 
-        NSData *logData = [message dataUsingEncoding:NSUTF8StringEncoding];
-
         @try {
             [self willLogMessage];
-			
-            [[self currentLogFileHandle] writeData:logData];
+
+            if (_logBufferSize > 0) {
+                [self appendToWriteBuffer:message];
+            } else {
+                // Buffering may just have been turned off, keep the statements in order.
+                [self flushWriteBuffer];
+
+                NSData *logData = [message dataUsingEncoding:NSUTF8StringEncoding];
+
+                [[self currentLogFileHandle] writeData:logData];
+
+                if (_syncPolicy == AWSDDFileLoggerSyncPolicyOnFlush) {
+                    [_currentLogFileHandle synchronizeFile];
+                }
+            }
 
             [self didLogMessage];
         } @catch (NSException *exception) {
@@ -1025,6 +1347,13 @@ static int exception_count = 0;
     }
 }
 
+- (void)flush {
+    // This method is invoked by [AWSDDLog flushLog] on our logger queue.
+
+    [self flushWriteBuffer];
+    [self maybeRollLogFileDueToSize];
+}
+
 - (void)willLogMessage {
 	
 }
@@ -1166,6 +1495,12 @@ static int exception_count = 0;
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 - (BOOL)isArchived {
+    // Only archived log files are compressed, so compressed files need no archived attribute (which would rename
+    // them on the simulator).
+    if ([self.filePath hasSuffix:@".gz"]) {
+        return YES;
+    }
+
 #if TARGET_IPHONE_SIMULATOR
 
     // Extended attributes don't work properly on the simulator.
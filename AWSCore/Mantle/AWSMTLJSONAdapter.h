@@ -67,6 +67,9 @@ extern const NSInteger AWSMTLJSONAdapterErrorInvalidJSONDictionary;
 // does not actually exist in +propertyKeys.
 extern const NSInteger AWSMTLJSONAdapterErrorInvalidJSONMapping;
 
+// A value of the model cannot be represented in JSON.
+extern const NSInteger AWSMTLJSONAdapterErrorInvalidJSONValue;
+
 // Converts a MTLModel object to and from a JSON dictionary.
 @interface AWSMTLJSONAdapter : NSObject
 
@@ -123,6 +126,22 @@ extern const NSInteger AWSMTLJSONAdapterErrorInvalidJSONMapping;
 // model.
 + (NSArray *)JSONArrayFromModels:(NSArray *)models;
 
+// Serializes a model straight into JSON data, without building a JSON
+// dictionary first.
+//
+// Properties whose JSON value is nil or NSNull are left out, and so are NSNull
+// values of nested dictionaries, which matches removing null values from
+// +JSONDictionaryFromModel:. Properties holding other <MTLJSONSerializing>
+// models, or arrays of them, are written recursively rather than through their
+// transformers.
+//
+// model - The model to serialize. This argument must not be nil.
+// error - If not NULL, this may be set to an error if a value cannot be
+//         represented in JSON.
+//
+// Returns UTF-8 encoded JSON data, or nil if a serialization error occurred.
++ (NSData *)JSONDataFromModel:(AWSMTLModel<AWSMTLJSONSerializing> *)model error:(NSError **)error;
+
 // Initializes the receiver by attempting to parse a JSON dictionary into
 // a model object.
 //
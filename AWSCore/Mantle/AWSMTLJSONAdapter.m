@@ -9,11 +9,14 @@
 #import "AWSMTLJSONAdapter.h"
 #import "AWSMTLModel.h"
 #import "AWSMTLReflection.h"
+#import "AWSEXTRuntimeExtensions.h"
+#import <objc/runtime.h>
 
 NSString * const AWSMTLJSONAdapterErrorDomain = @"AWSMTLJSONAdapterErrorDomain";
 const NSInteger AWSMTLJSONAdapterErrorNoClassFound = 2;
 const NSInteger AWSMTLJSONAdapterErrorInvalidJSONDictionary = 3;
 const NSInteger AWSMTLJSONAdapterErrorInvalidJSONMapping = 4;
+const NSInteger AWSMTLJSONAdapterErrorInvalidJSONValue = 5;
 
 // An exception was thrown and caught.
 const NSInteger AWSMTLJSONAdapterErrorExceptionThrown = 1;
@@ -21,6 +24,64 @@ const NSInteger AWSMTLJSONAdapterErrorExceptionThrown = 1;
 // Associated with the NSException that was caught.
 static NSString * const AWSMTLJSONAdapterThrownExceptionErrorKey = @"AWSMTLJSONAdapterThrownException";
 
+// Used to cache the AWSMTLJSONAdapterPlan of a model class.
+static void *AWSMTLJSONAdapterCachedPlanKey = &AWSMTLJSONAdapterCachedPlanKey;
+
+// Everything needed to map one property, resolved once per model class.
+@interface AWSMTLJSONAdapterPropertyPlan : NSObject {
+@public
+	NSString *_propertyKey;
+	NSString *_JSONKeyPath;
+
+	// YES if the JSON key path has more than one component (or starts with a
+	// collection operator), and has to go through -valueForKeyPath:.
+	BOOL _isKeyPath;
+
+	// The transformer for the property, or nil to not transform it.
+	NSValueTransformer *_transformer;
+
+	// The setter of an object property without custom validation, or NULL if
+	// the value has to be validated and set through KVC.
+	SEL _setter;
+	IMP _setterIMP;
+}
+
+@end
+
+@implementation AWSMTLJSONAdapterPropertyPlan
+
+@end
+
+// The result of validating +JSONKeyPathsByPropertyKey and resolving key
+// paths, transformers and setters of a model class.
+@interface AWSMTLJSONAdapterPlan : NSObject {
+@public
+	NSDictionary *_JSONKeyPathsByPropertyKey;
+
+	// AWSMTLJSONAdapterPropertyPlan for every property mapped to a JSON key path.
+	NSArray *_properties;
+
+	// AWSMTLJSONAdapterPropertyPlan (or NSNull for unmapped properties) by
+	// property key.
+	NSDictionary *_propertiesByKey;
+
+	// YES if instances can be created with -init and populated property by
+	// property, because the model class does not customize
+	// +modelWithDictionary:error:, -initWithDictionary:error: or
+	// -validateValue:forKey:error:.
+	BOOL _populatesDirectly;
+
+	// YES if any property maps to a JSON key path with more than one
+	// component.
+	BOOL _hasKeyPaths;
+}
+
+@end
+
+@implementation AWSMTLJSONAdapterPlan
+
+@end
+
 @interface AWSMTLJSONAdapter ()
 
 // The MTLModel subclass being parsed, or the class of `model` if parsing has
@@ -30,6 +91,9 @@ static NSString * const AWSMTLJSONAdapterThrownExceptionErrorKey = @"AWSMTLJSONA
 // A cached copy of the return value of +JSONKeyPathsByPropertyKey.
 @property (nonatomic, copy, readonly) NSDictionary *JSONKeyPathsByPropertyKey;
 
+// The plan for `modelClass`.
+@property (nonatomic, strong, readonly) AWSMTLJSONAdapterPlan *plan;
+
 // Looks up the NSValueTransformer that should be used for the given key.
 //
 // key - The property key to transform from or to. This argument must not be nil.
@@ -37,8 +101,153 @@ static NSString * const AWSMTLJSONAdapterThrownExceptionErrorKey = @"AWSMTLJSONA
 // Returns a transformer to use, or nil to not transform the property.
 - (NSValueTransformer *)JSONTransformerForKey:(NSString *)key;
 
+// Writes the JSON representation of `model` to the end of `data`.
+//
+// Returns whether every value could be represented in JSON.
+- (BOOL)writeJSONToData:(NSMutableData *)data error:(NSError **)error;
+
 @end
 
+#pragma mark JSON writing
+
+static BOOL AWSMTLJSONAdapterIsSerializableModel(id value) {
+	return [value isKindOfClass:AWSMTLModel.class] && [value conformsToProtocol:@protocol(AWSMTLJSONSerializing)];
+}
+
+static BOOL AWSMTLJSONAdapterInvalidValue(id value, NSError **error) {
+	if (error != NULL) {
+		NSDictionary *userInfo = @{
+			NSLocalizedDescriptionKey: NSLocalizedString(@"Invalid JSON value", @""),
+			NSLocalizedFailureReasonErrorKey: [NSString stringWithFormat:NSLocalizedString(@"%@ cannot be represented in JSON", @""), [value class]],
+		};
+		*error = [NSError errorWithDomain:AWSMTLJSONAdapterErrorDomain code:AWSMTLJSONAdapterErrorInvalidJSONValue userInfo:userInfo];
+	}
+	return NO;
+}
+
+static void AWSMTLJSONAdapterWriteString(NSMutableData *data, NSString *string) {
+	static const char hexDigits[] = "0123456789abcdef";
+	uint8_t buffer[1024];
+	NSRange remainingRange = NSMakeRange(0, string.length);
+
+	[data appendBytes:"\"" length:1];
+	while (remainingRange.length > 0) {
+		NSUInteger usedLength = 0;
+		if (![string getBytes:buffer maxLength:sizeof(buffer) usedLength:&usedLength encoding:NSUTF8StringEncoding options:NSStringEncodingConversionAllowLossy range:remainingRange remainingRange:&remainingRange] || usedLength == 0) {
+			break;
+		}
+
+		// Copy runs of characters that need no escaping in one go.
+		NSUInteger runStart = 0;
+		for (NSUInteger i = 0; i < usedLength; i++) {
+			uint8_t c = buffer[i];
+			if (c >= 0x20 && c != '"' && c != '\\') continue;
+
+			[data appendBytes:buffer + runStart length:i - runStart];
+			switch (c) {
+				case '"': [data appendBytes:"\\\"" length:2]; break;
+				case '\\': [data appendBytes:"\\\\" length:2]; break;
+				case '\n': [data appendBytes:"\\n" length:2]; break;
+				case '\r': [data appendBytes:"\\r" length:2]; break;
+				case '\t': [data appendBytes:"\\t" length:2]; break;
+				default: {
+					char escape[6] = { '\\', 'u', '0', '0', hexDigits[c >> 4], hexDigits[c & 0xf] };
+					[data appendBytes:escape length:sizeof(escape)];
+					break;
+				}
+			}
+			runStart = i + 1;
+		}
+		[data appendBytes:buffer + runStart length:usedLength - runStart];
+	}
+	[data appendBytes:"\"" length:1];
+}
+
+static BOOL AWSMTLJSONAdapterWriteNumber(NSMutableData *data, NSNumber *number, NSError **error) {
+	if (CFGetTypeID((__bridge CFTypeRef)number) == CFBooleanGetTypeID()) {
+		if (number.boolValue) {
+			[data appendBytes:"true" length:4];
+		} else {
+			[data appendBytes:"false" length:5];
+		}
+		return YES;
+	}
+
+	char buffer[32];
+	int length = 0;
+	switch (number.objCType[0]) {
+		case 'c': case 's': case 'i': case 'l': case 'q':
+			length = snprintf(buffer, sizeof(buffer), "%lld", number.longLongValue);
+			break;
+		case 'C': case 'S': case 'I': case 'L': case 'Q':
+			length = snprintf(buffer, sizeof(buffer), "%llu", number.unsignedLongLongValue);
+			break;
+		default: {
+			if (!isfinite(number.doubleValue)) return AWSMTLJSONAdapterInvalidValue(number, error);
+
+			NSString *stringValue = number.stringValue;
+			[data appendBytes:stringValue.UTF8String length:[stringValue lengthOfBytesUsingEncoding:NSUTF8StringEncoding]];
+			return YES;
+		}
+	}
+	[data appendBytes:buffer length:(NSUInteger)length];
+	return YES;
+}
+
+static BOOL AWSMTLJSONAdapterWriteValue(NSMutableData *data, id value, NSError **error) {
+	if ([value isKindOfClass:NSString.class]) {
+		AWSMTLJSONAdapterWriteString(data, value);
+		return YES;
+	}
+
+	if ([value isKindOfClass:NSNumber.class]) {
+		return AWSMTLJSONAdapterWriteNumber(data, value, error);
+	}
+
+	if ([value isKindOfClass:NSDictionary.class]) {
+		BOOL first = YES;
+		[data appendBytes:"{" length:1];
+		for (id key in (NSDictionary *)value) {
+			if (![key isKindOfClass:NSString.class]) return AWSMTLJSONAdapterInvalidValue(key, error);
+
+			id object = [(NSDictionary *)value objectForKey:key];
+			if ([object isEqual:NSNull.null]) continue;
+
+			if (!first) [data appendBytes:"," length:1];
+			first = NO;
+			AWSMTLJSONAdapterWriteString(data, key);
+			[data appendBytes:":" length:1];
+			if (!AWSMTLJSONAdapterWriteValue(data, object, error)) return NO;
+		}
+		[data appendBytes:"}" length:1];
+		return YES;
+	}
+
+	if ([value isKindOfClass:NSArray.class]) {
+		BOOL first = YES;
+		[data appendBytes:"[" length:1];
+		for (id object in (NSArray *)value) {
+			if (!first) [data appendBytes:"," length:1];
+			first = NO;
+			if (!AWSMTLJSONAdapterWriteValue(data, object, error)) return NO;
+		}
+		[data appendBytes:"]" length:1];
+		return YES;
+	}
+
+	if ([value isEqual:NSNull.null]) {
+		[data appendBytes:"null" length:4];
+		return YES;
+	}
+
+	if (AWSMTLJSONAdapterIsSerializableModel(value)) {
+		AWSMTLJSONAdapter *adapter = [[AWSMTLJSONAdapter alloc] initWithModel:value];
+		return [adapter writeJSONToData:data error:error];
+	}
+
+	return AWSMTLJSONAdapterInvalidValue(value, error);
+}
+
 @implementation AWSMTLJSONAdapter
 
 #pragma mark Convenience methods
@@ -92,6 +301,14 @@ static NSString * const AWSMTLJSONAdapterThrownExceptionErrorKey = @"AWSMTLJSONA
 	return JSONArray;
 }
 
++ (NSData *)JSONDataFromModel:(AWSMTLModel<AWSMTLJSONSerializing> *)model error:(NSError **)error {
+	AWSMTLJSONAdapter *adapter = [[self alloc] initWithModel:model];
+	NSMutableData *data = [NSMutableData dataWithCapacity:256];
+	if (![adapter writeJSONToData:data error:error]) return nil;
+
+	return data;
+}
+
 #pragma mark Lifecycle
 
 - (id)init {
@@ -138,51 +355,47 @@ static NSString * const AWSMTLJSONAdapterThrownExceptionErrorKey = @"AWSMTLJSONA
 	if (self == nil) return nil;
 
 	_modelClass = modelClass;
-	_JSONKeyPathsByPropertyKey = [[modelClass JSONKeyPathsByPropertyKey] copy];
-
-	NSMutableDictionary *dictionaryValue = [[NSMutableDictionary alloc] initWithCapacity:JSONDictionary.count];
-
-	NSSet *propertyKeys = [self.modelClass propertyKeys];
-
-	for (NSString *mappedPropertyKey in self.JSONKeyPathsByPropertyKey) {
-		if (![propertyKeys containsObject:mappedPropertyKey]) {
-			NSAssert(NO, @"%@ is not a property of %@.", mappedPropertyKey, modelClass);
-			return nil;
-		}
+	if (![self preparePlan]) return nil;
 
-		id value = self.JSONKeyPathsByPropertyKey[mappedPropertyKey];
+	AWSMTLModel *model = nil;
+	NSMutableDictionary *dictionaryValue = nil;
 
-		if (![value isKindOfClass:NSString.class] && value != NSNull.null) {
-			NSAssert(NO, @"%@ must either map to a JSON key path or NSNull, got: %@.",mappedPropertyKey, value);
-			return nil;
-		}
+	if (_plan->_populatesDirectly) {
+		model = [[modelClass alloc] init];
+		if (model == nil) return nil;
+	} else {
+		dictionaryValue = [[NSMutableDictionary alloc] initWithCapacity:JSONDictionary.count];
 	}
 
-	for (NSString *propertyKey in propertyKeys) {
-		NSString *JSONKeyPath = [self JSONKeyPathForPropertyKey:propertyKey];
-		if (JSONKeyPath == nil) continue;
+	for (AWSMTLJSONAdapterPropertyPlan *property in _plan->_properties) {
+		NSString *propertyKey = property->_propertyKey;
+		NSString *JSONKeyPath = property->_JSONKeyPath;
 
 		id value;
-		@try {
-			value = [JSONDictionary valueForKeyPath:JSONKeyPath];
-		} @catch (NSException *ex) {
-			if (error != NULL) {
-				NSDictionary *userInfo = @{
-					NSLocalizedDescriptionKey: NSLocalizedString(@"Invalid JSON dictionary", nil),
-					NSLocalizedFailureReasonErrorKey: [NSString stringWithFormat:NSLocalizedString(@"%1$@ could not be parsed because an invalid JSON dictionary was provided for key path \"%2$@\"", nil), modelClass, JSONKeyPath],
-					AWSMTLJSONAdapterThrownExceptionErrorKey: ex
-				};
-
-				*error = [NSError errorWithDomain:AWSMTLJSONAdapterErrorDomain code:AWSMTLJSONAdapterErrorInvalidJSONDictionary userInfo:userInfo];
+		if (property->_isKeyPath) {
+			@try {
+				value = [JSONDictionary valueForKeyPath:JSONKeyPath];
+			} @catch (NSException *ex) {
+				if (error != NULL) {
+					NSDictionary *userInfo = @{
+						NSLocalizedDescriptionKey: NSLocalizedString(@"Invalid JSON dictionary", nil),
+						NSLocalizedFailureReasonErrorKey: [NSString stringWithFormat:NSLocalizedString(@"%1$@ could not be parsed because an invalid JSON dictionary was provided for key path \"%2$@\"", nil), modelClass, JSONKeyPath],
+						AWSMTLJSONAdapterThrownExceptionErrorKey: ex
+					};
+
+					*error = [NSError errorWithDomain:AWSMTLJSONAdapterErrorDomain code:AWSMTLJSONAdapterErrorInvalidJSONDictionary userInfo:userInfo];
+				}
+
+				return nil;
 			}
-
-			return nil;
+		} else {
+			value = [JSONDictionary objectForKey:JSONKeyPath];
 		}
 
 		if (value == nil) continue;
 
 		@try {
-			NSValueTransformer *transformer = [self JSONTransformerForKey:propertyKey];
+			NSValueTransformer *transformer = property->_transformer;
 			if (transformer != nil) {
 				// Map NSNull -> nil for the transformer, and then back for the
 				// dictionary we're going to insert into.
@@ -190,7 +403,22 @@ static NSString * const AWSMTLJSONAdapterThrownExceptionErrorKey = @"AWSMTLJSONA
 				value = [transformer transformedValue:value] ?: NSNull.null;
 			}
 
-			dictionaryValue[propertyKey] = value;
+			if (model == nil) {
+				dictionaryValue[propertyKey] = value;
+				continue;
+			}
+
+			if ([value isEqual:NSNull.null]) value = nil;
+
+			if (property->_setterIMP != NULL) {
+				((void (*)(id, SEL, id))property->_setterIMP)(model, property->_setter, value);
+			} else {
+				// Same as -[AWSMTLModel initWithDictionary:error:].
+				__autoreleasing id validatedValue = value;
+				if (![model validateValue:&validatedValue forKey:propertyKey error:error]) return nil;
+
+				[model setValue:validatedValue forKey:propertyKey];
+			}
 		} @catch (NSException *ex) {
 			NSLog(@"*** Caught exception %@ parsing JSON key path \"%@\" from: %@", ex, JSONKeyPath, JSONDictionary);
 
@@ -213,8 +441,12 @@ static NSString * const AWSMTLJSONAdapterThrownExceptionErrorKey = @"AWSMTLJSONA
 		}
 	}
 
-	_model = [self.modelClass modelWithDictionary:dictionaryValue error:error];
-	if (_model == nil) return nil;
+	if (model != nil) {
+		_model = model;
+	} else {
+		_model = [self.modelClass modelWithDictionary:dictionaryValue error:error];
+		if (_model == nil) return nil;
+	}
 
 	return self;
 }
@@ -227,11 +459,109 @@ static NSString * const AWSMTLJSONAdapterThrownExceptionErrorKey = @"AWSMTLJSONA
 
 	_model = model;
 	_modelClass = model.class;
-	_JSONKeyPathsByPropertyKey = [[model.class JSONKeyPathsByPropertyKey] copy];
+	[self preparePlan];
 
 	return self;
 }
 
+#pragma mark Plans
+
+// Sets up `plan` and `JSONKeyPathsByPropertyKey` for `modelClass`, reusing
+// the plan cached on the model class if there is one.
+//
+// Returns whether +JSONKeyPathsByPropertyKey of the model class is valid.
+- (BOOL)preparePlan {
+	Class modelClass = self.modelClass;
+
+	// Subclasses may customize the key paths and transformers, so only plans
+	// built by this class are shared.
+	BOOL cacheable = (self.class == AWSMTLJSONAdapter.class);
+	if (cacheable) {
+		AWSMTLJSONAdapterPlan *cachedPlan = objc_getAssociatedObject(modelClass, AWSMTLJSONAdapterCachedPlanKey);
+		if (cachedPlan != nil) {
+			_plan = cachedPlan;
+			_JSONKeyPathsByPropertyKey = cachedPlan->_JSONKeyPathsByPropertyKey;
+			return YES;
+		}
+	}
+
+	_JSONKeyPathsByPropertyKey = [[modelClass JSONKeyPathsByPropertyKey] copy];
+
+	AWSMTLJSONAdapterPlan *plan = [[AWSMTLJSONAdapterPlan alloc] init];
+	plan->_JSONKeyPathsByPropertyKey = _JSONKeyPathsByPropertyKey;
+
+	NSSet *propertyKeys = [modelClass propertyKeys];
+
+	for (NSString *mappedPropertyKey in plan->_JSONKeyPathsByPropertyKey) {
+		if (![propertyKeys containsObject:mappedPropertyKey]) {
+			NSAssert(NO, @"%@ is not a property of %@.", mappedPropertyKey, modelClass);
+			return NO;
+		}
+
+		id value = plan->_JSONKeyPathsByPropertyKey[mappedPropertyKey];
+
+		if (![value isKindOfClass:NSString.class] && value != NSNull.null) {
+			NSAssert(NO, @"%@ must either map to a JSON key path or NSNull, got: %@.",mappedPropertyKey, value);
+			return NO;
+		}
+	}
+
+	SEL validateValueSelector = @selector(validateValue:forKey:error:);
+	plan->_populatesDirectly = class_getMethodImplementation(object_getClass(modelClass), @selector(modelWithDictionary:error:)) == class_getMethodImplementation(object_getClass(AWSMTLModel.class), @selector(modelWithDictionary:error:))
+		&& class_getMethodImplementation(modelClass, @selector(initWithDictionary:error:)) == class_getMethodImplementation(AWSMTLModel.class, @selector(initWithDictionary:error:))
+		&& class_getMethodImplementation(modelClass, validateValueSelector) == class_getMethodImplementation(AWSMTLModel.class, validateValueSelector);
+
+	NSMutableArray *properties = [NSMutableArray arrayWithCapacity:propertyKeys.count];
+	NSMutableDictionary *propertiesByKey = [NSMutableDictionary dictionaryWithCapacity:propertyKeys.count];
+
+	for (NSString *propertyKey in propertyKeys) {
+		NSString *JSONKeyPath = [self JSONKeyPathForPropertyKey:propertyKey];
+		if (JSONKeyPath == nil) {
+			propertiesByKey[propertyKey] = NSNull.null;
+			continue;
+		}
+
+		AWSMTLJSONAdapterPropertyPlan *property = [[AWSMTLJSONAdapterPropertyPlan alloc] init];
+		property->_propertyKey = propertyKey;
+		property->_JSONKeyPath = JSONKeyPath;
+		property->_isKeyPath = [JSONKeyPath rangeOfString:@"."].location != NSNotFound || [JSONKeyPath hasPrefix:@"@"];
+		plan->_hasKeyPaths = plan->_hasKeyPaths || property->_isKeyPath;
+		property->_transformer = [self JSONTransformerForKey:propertyKey];
+
+		// Object properties without a validate<Key>:error: method can be set
+		// straight through their setter, which is what KVC would end up doing.
+		objc_property_t objcProperty = class_getProperty(modelClass, propertyKey.UTF8String);
+		awsmtl_propertyAttributes *attributes = objcProperty != NULL ? awsmtl_copyPropertyAttributes(objcProperty) : NULL;
+		if (attributes != NULL) {
+			SEL validateSelector = AWSMTLSelectorWithCapitalizedKeyPattern("validate", propertyKey, ":error:");
+			if (!attributes->readonly
+				&& attributes->type[0] == '@'
+				&& attributes->setter != NULL
+				&& [modelClass instancesRespondToSelector:attributes->setter]
+				&& ![modelClass instancesRespondToSelector:validateSelector]) {
+				property->_setter = attributes->setter;
+				property->_setterIMP = class_getMethodImplementation(modelClass, attributes->setter);
+			}
+			free(attributes);
+		}
+
+		[properties addObject:property];
+		propertiesByKey[propertyKey] = property;
+	}
+
+	plan->_properties = [properties copy];
+	plan->_propertiesByKey = [propertiesByKey copy];
+
+	if (cacheable) {
+		// It doesn't really matter if we replace another thread's work, since we do
+		// it atomically and the result should be the same.
+		objc_setAssociatedObject(modelClass, AWSMTLJSONAdapterCachedPlanKey, plan, OBJC_ASSOCIATION_RETAIN);
+	}
+
+	_plan = plan;
+	return YES;
+}
+
 #pragma mark Serialization
 
 - (NSDictionary *)JSONDictionary {
@@ -270,13 +600,52 @@ static NSString * const AWSMTLJSONAdapterThrownExceptionErrorKey = @"AWSMTLJSONA
 	return JSONDictionary;
 }
 
+- (BOOL)writeJSONToData:(NSMutableData *)data error:(NSError **)error {
+	// Key paths nest values in dictionaries, so build the dictionary.
+	if (self.plan->_hasKeyPaths) {
+		return AWSMTLJSONAdapterWriteValue(data, self.JSONDictionary, error);
+	}
+
+	AWSMTLModel *model = self.model;
+	BOOL first = YES;
+	[data appendBytes:"{" length:1];
+	for (AWSMTLJSONAdapterPropertyPlan *property in self.plan->_properties) {
+		id value = [model valueForKey:property->_propertyKey];
+		if ([value isEqual:NSNull.null]) value = nil;
+
+		BOOL isModel = AWSMTLJSONAdapterIsSerializableModel(value)
+			|| ([value isKindOfClass:NSArray.class] && AWSMTLJSONAdapterIsSerializableModel([value firstObject]));
+		NSValueTransformer *transformer = property->_transformer;
+		if (!isModel && [transformer.class allowsReverseTransformation]) {
+			value = [transformer reverseTransformedValue:value];
+		}
+		if (value == nil || [value isEqual:NSNull.null]) continue;
+
+		if (!first) [data appendBytes:"," length:1];
+		first = NO;
+		AWSMTLJSONAdapterWriteString(data, property->_JSONKeyPath);
+		[data appendBytes:":" length:1];
+		if (!AWSMTLJSONAdapterWriteValue(data, value, error)) return NO;
+	}
+	[data appendBytes:"}" length:1];
+
+	return YES;
+}
+
 - (NSValueTransformer *)JSONTransformerForKey:(NSString *)key {
 	NSParameterAssert(key != nil);
 
+	// Use the plan once it has been built.
+	id property = self.plan != nil ? self.plan->_propertiesByKey[key] : nil;
+	if (property != nil) {
+		return property == NSNull.null ? nil : ((AWSMTLJSONAdapterPropertyPlan *)property)->_transformer;
+	}
+
+	Class modelClass = self.modelClass;
 	SEL selector = AWSMTLSelectorWithKeyPattern(key, "JSONTransformer");
-	if ([self.modelClass respondsToSelector:selector]) {
-		NSInvocation *invocation = [NSInvocation invocationWithMethodSignature:[self.modelClass methodSignatureForSelector:selector]];
-		invocation.target = self.modelClass;
+	if ([modelClass respondsToSelector:selector]) {
+		NSInvocation *invocation = [NSInvocation invocationWithMethodSignature:[modelClass methodSignatureForSelector:selector]];
+		invocation.target = modelClass;
 		invocation.selector = selector;
 		[invocation invoke];
 
@@ -285,8 +654,8 @@ static NSString * const AWSMTLJSONAdapterThrownExceptionErrorKey = @"AWSMTLJSONA
 		return result;
 	}
 
-	if ([self.modelClass respondsToSelector:@selector(JSONTransformerForKey:)]) {
-		return [self.modelClass JSONTransformerForKey:key];
+	if ([modelClass respondsToSelector:@selector(JSONTransformerForKey:)]) {
+		return [modelClass JSONTransformerForKey:key];
 	}
 
 	return nil;
@@ -295,6 +664,12 @@ static NSString * const AWSMTLJSONAdapterThrownExceptionErrorKey = @"AWSMTLJSONA
 - (NSString *)JSONKeyPathForPropertyKey:(NSString *)key {
 	NSParameterAssert(key != nil);
 
+	// Use the plan once it has been built.
+	id property = self.plan != nil ? self.plan->_propertiesByKey[key] : nil;
+	if (property != nil) {
+		return property == NSNull.null ? nil : ((AWSMTLJSONAdapterPropertyPlan *)property)->_JSONKeyPath;
+	}
+
 	id JSONKeyPath = self.JSONKeyPathsByPropertyKey[key];
 	if ([JSONKeyPath isEqual:NSNull.null]) return nil;
 
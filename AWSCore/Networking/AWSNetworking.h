@@ -37,6 +37,7 @@ typedef NS_ENUM(NSInteger, AWSNetworkingRetryType) {
 
 typedef void (^AWSNetworkingUploadProgressBlock) (int64_t bytesSent, int64_t totalBytesSent, int64_t totalBytesExpectedToSend);
 typedef void (^AWSNetworkingDownloadProgressBlock) (int64_t bytesWritten, int64_t totalBytesWritten, int64_t totalBytesExpectedToWrite);
+typedef void (^AWSNetworkingDataHandlerBlock) (NSData *data);
 
 #pragma mark - AWSHTTPMethod
 
@@ -182,6 +183,11 @@ typedef NS_ENUM(NSInteger, AWSHTTPMethod) {
 @property (nonatomic, copy) AWSNetworkingUploadProgressBlock uploadProgress;
 @property (nonatomic, copy) AWSNetworkingDownloadProgressBlock downloadProgress;
 
+/**
+ If set, the body of a successful (2xx) response is passed to this block piece by piece as it arrives, on the session's delegate queue, instead of being kept in memory. The response serializer then sees no body. A request that has passed data to the block is not retried, so the block never sees the same bytes twice. Ignored when `downloadingFileURL` is set.
+ */
+@property (nonatomic, copy) AWSNetworkingDataHandlerBlock dataHandler;
+
 @property (readonly, nonatomic, strong) NSURLSessionTask *task;
 @property (readonly, nonatomic, assign, getter = isCancelled) BOOL cancelled;
 
@@ -195,6 +201,7 @@ typedef NS_ENUM(NSInteger, AWSHTTPMethod) {
 
 @property (nonatomic, copy) AWSNetworkingUploadProgressBlock uploadProgress;
 @property (nonatomic, copy) AWSNetworkingDownloadProgressBlock downloadProgress;
+@property (nonatomic, copy) AWSNetworkingDataHandlerBlock dataHandler;
 @property (nonatomic, assign, readonly, getter = isCancelled) BOOL cancelled;
 @property (nonatomic, strong) NSURL *downloadingFileURL;
 
@@ -277,6 +277,10 @@ NSString *const AWSNetworkingErrorDomain = @"com.amazonaws.AWSNetworkingErrorDom
     self.internalRequest.downloadProgress = downloadProgress;
 }
 
+- (void)setDataHandler:(AWSNetworkingDataHandlerBlock)dataHandler {
+    self.internalRequest.dataHandler = dataHandler;
+}
+
 - (BOOL)isCancelled {
     return [self.internalRequest isCancelled];
 }
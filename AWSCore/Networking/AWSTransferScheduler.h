@@ -0,0 +1,178 @@
+//
+// Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+
+#import <Foundation/Foundation.h>
+#import <SystemConfiguration/SystemConfiguration.h>
+
+@class AWSTask<__covariant ResultType>;
+
+NS_ASSUME_NONNULL_BEGIN
+
+FOUNDATION_EXPORT NSString *const AWSTransferSchedulerErrorDomain;
+
+typedef NS_ENUM(NSInteger, AWSTransferSchedulerErrorType) {
+    AWSTransferSchedulerErrorUnknown,
+    AWSTransferSchedulerErrorDeferred,
+};
+
+typedef NS_ENUM(NSInteger, AWSTransferSchedulerLinkType) {
+    AWSTransferSchedulerLinkTypeUnknown,
+    AWSTransferSchedulerLinkTypeNotReachable,
+    AWSTransferSchedulerLinkTypeWiFi,
+    AWSTransferSchedulerLinkTypeCellular,
+};
+
+typedef NS_ENUM(NSInteger, AWSTransferSchedulerPriority) {
+    AWSTransferSchedulerPriorityLow = -1,
+    AWSTransferSchedulerPriorityDefault = 0,
+    AWSTransferSchedulerPriorityHigh = 1,
+};
+
+typedef NS_ENUM(NSInteger, AWSTransferSchedulerPolicy) {
+    /**
+     Transfers on any reachable link, including before the link type is known.
+     */
+    AWSTransferSchedulerPolicyAnyNetwork,
+    /**
+     Transfers only on Wi-Fi.
+     */
+    AWSTransferSchedulerPolicyWiFiOnly,
+    /**
+     Transfers only on a link that is known and not weak, and only while no other transfer is in flight.
+     */
+    AWSTransferSchedulerPolicyDeferredBulk,
+};
+
+/**
+ A component that transfers data through the scheduler, such as a recorder.
+ */
+@interface AWSTransferSchedulerClient : NSObject
+
+@property (nonatomic, readonly) NSString *name;
+
+/**
+ Waiting requests of clients with a higher priority are granted first.
+ */
+@property (atomic, assign) AWSTransferSchedulerPriority priority;
+
+@property (atomic, assign) AWSTransferSchedulerPolicy policy;
+
+/**
+ Called on a background queue when the link allows the client to transfer again after one of its requests was deferred, so that it can flush what it holds.
+ */
+@property (atomic, copy, nullable) void (^flushWindowHandler)(void);
+
+@end
+
+/**
+ Permission to transfer a number of bytes. Call `- finish` once the transfer is done, whether it succeeded or not.
+ */
+@interface AWSTransferSchedulerGrant : NSObject
+
+@property (nonatomic, readonly) AWSTransferSchedulerClient *client;
+
+@property (nonatomic, readonly) int64_t bytes;
+
+- (void)finish;
+
+@end
+
+/**
+ Coordinates transfers of the clients that share the network, so that they do not all hit a weak link at once.
+
+ The scheduler tracks the link type from the reachability flags and estimates the throughput and round trip time from the requests `AWSURLSessionManager` completes. Clients ask for a grant before each transfer. Requests that the client's policy does not allow on the current link fail right away with `AWSTransferSchedulerErrorDeferred`; the others wait, in order of priority, until the bytes in flight leave room for them. On a weak link only one transfer is in flight at a time.
+ */
+@interface AWSTransferScheduler : NSObject
+
+/**
+ The scheduler shared by the SDK. It monitors the reachability of the internet.
+ */
++ (instancetype)sharedScheduler;
+
+/**
+ Creates a scheduler that does not monitor reachability; the link is updated with `- updateReachabilityFlags:`.
+ */
+- (instancetype)init;
+
+@property (atomic, readonly) AWSTransferSchedulerLinkType linkType;
+
+@property (atomic, readonly) SCNetworkReachabilityFlags reachabilityFlags;
+
+/**
+ The estimated throughput of the link in bytes per second, or 0 if unknown.
+ */
+@property (atomic, readonly) double estimatedThroughput;
+
+/**
+ The estimated round trip time of the link, or 0 if unknown.
+ */
+@property (atomic, readonly) NSTimeInterval estimatedRoundTripTime;
+
+/**
+ YES if the estimated throughput is below `weakLinkThroughput` or the estimated round trip time is above `weakLinkRoundTripTime`.
+ */
+@property (atomic, readonly, getter=isWeakLink) BOOL weakLink;
+
+/**
+ The default is 16 KB per second.
+ */
+@property (atomic, assign) double weakLinkThroughput;
+
+/**
+ The default is 1.5 seconds.
+ */
+@property (atomic, assign) NSTimeInterval weakLinkRoundTripTime;
+
+/**
+ How long the bytes in flight should take at the estimated throughput. The default is 2 seconds.
+ */
+@property (atomic, assign) NSTimeInterval grantWindow;
+
+/**
+ The bytes allowed in flight when the throughput is low or, on cellular, unknown. The default is 64 KB.
+ */
+@property (atomic, assign) int64_t minimumByteBudget;
+
+/**
+ Registers a client. The scheduler holds clients weakly.
+ */
+- (AWSTransferSchedulerClient *)registerClientWithName:(NSString *)name
+                                              priority:(AWSTransferSchedulerPriority)priority
+                                                policy:(AWSTransferSchedulerPolicy)policy;
+
+/**
+ Asks for permission to transfer `bytes`. The task is already completed when the grant is available right away.
+
+ @return A task whose result is an `AWSTransferSchedulerGrant`, or whose error is `AWSTransferSchedulerErrorDeferred` if the client's policy does not allow transferring on the current link.
+ */
+- (AWSTask<AWSTransferSchedulerGrant *> *)requestGrantForClient:(AWSTransferSchedulerClient *)client
+                                                          bytes:(int64_t)bytes;
+
+- (void)updateReachabilityFlags:(SCNetworkReachabilityFlags)flags;
+
+/**
+ Adds a completed request to the throughput and round trip time estimates.
+
+ @param bytes         The bytes sent and received.
+ @param duration      The time from the start of the request to its completion.
+ @param roundTripTime The time from the start of the request to the response, or 0 if unknown.
+ */
+- (void)recordTransferWithBytes:(int64_t)bytes
+                       duration:(NSTimeInterval)duration
+                  roundTripTime:(NSTimeInterval)roundTripTime;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,351 @@
+//
+// Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+
+#import "AWSTransferScheduler.h"
+#import "AWSBolts.h"
+#import "AWSCocoaLumberjack.h"
+#import "AWSKSReachability.h"
+
+NSString *const AWSTransferSchedulerErrorDomain = @"com.amazonaws.AWSTransferSchedulerErrorDomain";
+
+// Requests smaller than this mostly measure latency.
+static int64_t const AWSTransferSchedulerThroughputSampleMinimumBytes = 16 * 1024;
+static double const AWSTransferSchedulerEstimateWeight = 0.3;
+
+@interface AWSTransferSchedulerClient()
+
+@property (nonatomic, strong) NSString *name;
+// A request of the client was deferred since the link last allowed it to transfer.
+@property (nonatomic, assign) BOOL deferred;
+
+@end
+
+@implementation AWSTransferSchedulerClient
+
+@end
+
+@interface AWSTransferSchedulerGrant()
+
+@property (nonatomic, weak) AWSTransferScheduler *scheduler;
+@property (nonatomic, strong) AWSTransferSchedulerClient *client;
+@property (nonatomic, assign) int64_t bytes;
+@property (nonatomic, assign) NSUInteger sequenceNumber;
+@property (nonatomic, strong) AWSTaskCompletionSource<AWSTransferSchedulerGrant *> *taskCompletionSource;
+@property (nonatomic, assign, getter=isFinished) BOOL finished;
+
+@end
+
+@interface AWSTransferScheduler()
+
+@property (atomic, assign) AWSTransferSchedulerLinkType linkType;
+@property (atomic, assign) SCNetworkReachabilityFlags reachabilityFlags;
+@property (atomic, assign) double estimatedThroughput;
+@property (atomic, assign) NSTimeInterval estimatedRoundTripTime;
+
+@property (nonatomic, strong) AWSKSReachability *reachability;
+@property (nonatomic, strong) NSHashTable<AWSTransferSchedulerClient *> *clients;
+// Requests waiting for a grant, in the order they were made.
+@property (nonatomic, strong) NSMutableArray<AWSTransferSchedulerGrant *> *waitingGrants;
+@property (nonatomic, strong) NSMutableArray<AWSTransferSchedulerGrant *> *activeGrants;
+@property (nonatomic, assign) int64_t bytesInFlight;
+@property (nonatomic, assign) NSUInteger nextSequenceNumber;
+
+- (void)finishGrant:(AWSTransferSchedulerGrant *)grant;
+
+@end
+
+@implementation AWSTransferSchedulerGrant
+
+- (void)finish {
+    [self.scheduler finishGrant:self];
+}
+
+@end
+
+@implementation AWSTransferScheduler
+
++ (instancetype)sharedScheduler {
+    static AWSTransferScheduler *_sharedScheduler = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        _sharedScheduler = [AWSTransferScheduler new];
+        [_sharedScheduler startMonitoringReachability];
+    });
+
+    return _sharedScheduler;
+}
+
+- (instancetype)init {
+    if (self = [super init]) {
+        _linkType = AWSTransferSchedulerLinkTypeUnknown;
+        _weakLinkThroughput = 16 * 1024;
+        _weakLinkRoundTripTime = 1.5;
+        _grantWindow = 2.0;
+        _minimumByteBudget = 64 * 1024;
+        _clients = [NSHashTable weakObjectsHashTable];
+        _waitingGrants = [NSMutableArray new];
+        _activeGrants = [NSMutableArray new];
+    }
+    return self;
+}
+
+- (void)startMonitoringReachability {
+    self.reachability = [AWSKSReachability reachabilityToInternet];
+    __weak AWSTransferScheduler *weakSelf = self;
+    AWSKSReachabilityCallback callback = ^(AWSKSReachability *reachability) {
+        [weakSelf updateReachabilityFlags:reachability.flags];
+    };
+    self.reachability.onInitializationComplete = callback;
+    self.reachability.onReachabilityChanged = callback;
+}
+
+- (BOOL)isWeakLink {
+    @synchronized(self) {
+        return [self isWeakLinkLocked];
+    }
+}
+
+#pragma mark - Clients
+
+- (AWSTransferSchedulerClient *)registerClientWithName:(NSString *)name
+                                              priority:(AWSTransferSchedulerPriority)priority
+                                                policy:(AWSTransferSchedulerPolicy)policy {
+    AWSTransferSchedulerClient *client = [AWSTransferSchedulerClient new];
+    client.name = name;
+    client.priority = priority;
+    client.policy = policy;
+    @synchronized(self) {
+        [self.clients addObject:client];
+    }
+    return client;
+}
+
+- (AWSTask<AWSTransferSchedulerGrant *> *)requestGrantForClient:(AWSTransferSchedulerClient *)client
+                                                          bytes:(int64_t)bytes {
+    AWSTransferSchedulerGrant *grant = [AWSTransferSchedulerGrant new];
+    grant.scheduler = self;
+    grant.client = client;
+    grant.bytes = MAX(bytes, 0);
+    grant.taskCompletionSource = [AWSTaskCompletionSource taskCompletionSource];
+
+    NSMutableArray<AWSTransferSchedulerGrant *> *grantedGrants = [NSMutableArray new];
+    NSMutableArray<AWSTransferSchedulerGrant *> *deferredGrants = [NSMutableArray new];
+    @synchronized(self) {
+        grant.sequenceNumber = self.nextSequenceNumber++;
+        [self.waitingGrants addObject:grant];
+        [self scheduleGrantsLockedGranted:grantedGrants deferred:deferredGrants];
+    }
+    [self completeGranted:grantedGrants deferred:deferredGrants];
+
+    return grant.taskCompletionSource.task;
+}
+
+- (void)finishGrant:(AWSTransferSchedulerGrant *)grant {
+    NSMutableArray<AWSTransferSchedulerGrant *> *grantedGrants = [NSMutableArray new];
+    NSMutableArray<AWSTransferSchedulerGrant *> *deferredGrants = [NSMutableArray new];
+    @synchronized(self) {
+        if (grant.isFinished) {
+            return;
+        }
+        grant.finished = YES;
+        [self.activeGrants removeObjectIdenticalTo:grant];
+        self.bytesInFlight -= grant.bytes;
+        [self scheduleGrantsLockedGranted:grantedGrants deferred:deferredGrants];
+    }
+    [self completeGranted:grantedGrants deferred:deferredGrants];
+}
+
+#pragma mark - Network state
+
+- (void)updateReachabilityFlags:(SCNetworkReachabilityFlags)flags {
+    AWSTransferSchedulerLinkType linkType = AWSTransferSchedulerLinkTypeWiFi;
+    BOOL connectionRequired = (flags & kSCNetworkReachabilityFlagsConnectionRequired)
+    && !(flags & (kSCNetworkReachabilityFlagsConnectionOnTraffic | kSCNetworkReachabilityFlagsConnectionOnDemand));
+    if (!(flags & kSCNetworkReachabilityFlagsReachable) || connectionRequired) {
+        linkType = AWSTransferSchedulerLinkTypeNotReachable;
+    }
+#if TARGET_OS_IPHONE
+    else if (flags & kSCNetworkReachabilityFlagsIsWWAN) {
+        linkType = AWSTransferSchedulerLinkTypeCellular;
+    }
+#endif
+
+    NSMutableArray<AWSTransferSchedulerGrant *> *grantedGrants = [NSMutableArray new];
+    NSMutableArray<AWSTransferSchedulerGrant *> *deferredGrants = [NSMutableArray new];
+    NSMutableArray<AWSTransferSchedulerClient *> *flushingClients = [NSMutableArray new];
+    @synchronized(self) {
+        self.reachabilityFlags = flags;
+        if (linkType != self.linkType) {
+            AWSDDLogDebug(@"The network link changed from %ld to %ld.", (long)self.linkType, (long)linkType);
+            // The estimates were made on the previous link.
+            self.linkType = linkType;
+            self.estimatedThroughput = 0;
+            self.estimatedRoundTripTime = 0;
+        }
+        [self scheduleGrantsLockedGranted:grantedGrants deferred:deferredGrants];
+        [self collectFlushingClientsLocked:flushingClients];
+    }
+    [self completeGranted:grantedGrants deferred:deferredGrants];
+    [self notifyFlushingClients:flushingClients];
+}
+
+- (void)recordTransferWithBytes:(int64_t)bytes
+                       duration:(NSTimeInterval)duration
+                  roundTripTime:(NSTimeInterval)roundTripTime {
+    NSMutableArray<AWSTransferSchedulerGrant *> *grantedGrants = [NSMutableArray new];
+    NSMutableArray<AWSTransferSchedulerGrant *> *deferredGrants = [NSMutableArray new];
+    NSMutableArray<AWSTransferSchedulerClient *> *flushingClients = [NSMutableArray new];
+    @synchronized(self) {
+        if (bytes >= AWSTransferSchedulerThroughputSampleMinimumBytes && duration > 0) {
+            self.estimatedThroughput = [self estimateByAddingSample:bytes / duration toEstimate:self.estimatedThroughput];
+        }
+        if (roundTripTime > 0) {
+            self.estimatedRoundTripTime = [self estimateByAddingSample:roundTripTime toEstimate:self.estimatedRoundTripTime];
+        }
+        [self scheduleGrantsLockedGranted:grantedGrants deferred:deferredGrants];
+        [self collectFlushingClientsLocked:flushingClients];
+    }
+    [self completeGranted:grantedGrants deferred:deferredGrants];
+    [self notifyFlushingClients:flushingClients];
+}
+
+#pragma mark - Scheduling
+
+- (double)estimateByAddingSample:(double)sample toEstimate:(double)estimate {
+    if (estimate <= 0) {
+        return sample;
+    }
+    return estimate + AWSTransferSchedulerEstimateWeight * (sample - estimate);
+}
+
+- (BOOL)isWeakLinkLocked {
+    return (self.estimatedThroughput > 0 && self.estimatedThroughput < self.weakLinkThroughput)
+    || self.estimatedRoundTripTime > self.weakLinkRoundTripTime;
+}
+
+- (BOOL)allowsPolicyLocked:(AWSTransferSchedulerPolicy)policy {
+    AWSTransferSchedulerLinkType linkType = self.linkType;
+    if (linkType == AWSTransferSchedulerLinkTypeNotReachable) {
+        return NO;
+    }
+    switch (policy) {
+        case AWSTransferSchedulerPolicyAnyNetwork:
+            return YES;
+        case AWSTransferSchedulerPolicyWiFiOnly:
+            return linkType == AWSTransferSchedulerLinkTypeWiFi;
+        case AWSTransferSchedulerPolicyDeferredBulk:
+            return linkType != AWSTransferSchedulerLinkTypeUnknown && ![self isWeakLinkLocked];
+    }
+    return YES;
+}
+
+- (int64_t)byteBudgetLocked {
+    if (self.estimatedThroughput > 0) {
+        return MAX(self.minimumByteBudget, (int64_t)(self.estimatedThroughput * self.grantWindow));
+    }
+    if (self.linkType == AWSTransferSchedulerLinkTypeCellular) {
+        return self.minimumByteBudget;
+    }
+    return INT64_MAX;
+}
+
+/**
+ Grants the waiting requests that fit, highest priority first. A request that does not fit holds back the requests
+ after it, so that a large transfer of an important client is not starved by small ones.
+ */
+- (void)scheduleGrantsLockedGranted:(NSMutableArray<AWSTransferSchedulerGrant *> *)grantedGrants
+                           deferred:(NSMutableArray<AWSTransferSchedulerGrant *> *)deferredGrants {
+    if ([self.waitingGrants count] == 0) {
+        return;
+    }
+
+    NSArray<AWSTransferSchedulerGrant *> *waitingGrants = [self.waitingGrants sortedArrayUsingComparator:^NSComparisonResult(AWSTransferSchedulerGrant *grant1, AWSTransferSchedulerGrant *grant2) {
+        if (grant1.client.priority != grant2.client.priority) {
+            return grant1.client.priority > grant2.client.priority ? NSOrderedAscending : NSOrderedDescending;
+        }
+        return grant1.sequenceNumber < grant2.sequenceNumber ? NSOrderedAscending : NSOrderedDescending;
+    }];
+
+    BOOL weakLink = [self isWeakLinkLocked];
+    int64_t byteBudget = [self byteBudgetLocked];
+    BOOL blocked = NO;
+    for (AWSTransferSchedulerGrant *grant in waitingGrants) {
+        AWSTransferSchedulerPolicy policy = grant.client.policy;
+        if (![self allowsPolicyLocked:policy]) {
+            grant.client.deferred = YES;
+            [self.waitingGrants removeObjectIdenticalTo:grant];
+            [deferredGrants addObject:grant];
+            continue;
+        }
+        if (blocked) {
+            continue;
+        }
+
+        BOOL fits = NO;
+        if ([self.activeGrants count] == 0) {
+            fits = YES;
+        } else if (!weakLink && policy != AWSTransferSchedulerPolicyDeferredBulk) {
+            fits = self.bytesInFlight <= byteBudget - grant.bytes;
+        }
+        if (!fits) {
+            blocked = YES;
+            continue;
+        }
+
+        [self.waitingGrants removeObjectIdenticalTo:grant];
+        [self.activeGrants addObject:grant];
+        self.bytesInFlight += grant.bytes;
+        [grantedGrants addObject:grant];
+    }
+}
+
+- (void)collectFlushingClientsLocked:(NSMutableArray<AWSTransferSchedulerClient *> *)flushingClients {
+    for (AWSTransferSchedulerClient *client in self.clients) {
+        if (client.deferred && [self allowsPolicyLocked:client.policy]) {
+            client.deferred = NO;
+            [flushingClients addObject:client];
+        }
+    }
+    [flushingClients sortUsingComparator:^NSComparisonResult(AWSTransferSchedulerClient *client1, AWSTransferSchedulerClient *client2) {
+        if (client1.priority == client2.priority) {
+            return NSOrderedSame;
+        }
+        return client1.priority > client2.priority ? NSOrderedAscending : NSOrderedDescending;
+    }];
+}
+
+- (void)completeGranted:(NSArray<AWSTransferSchedulerGrant *> *)grantedGrants
+               deferred:(NSArray<AWSTransferSchedulerGrant *> *)deferredGrants {
+    for (AWSTransferSchedulerGrant *grant in deferredGrants) {
+        AWSDDLogDebug(@"Deferred a transfer of %lld bytes for %@.", grant.bytes, grant.client.name);
+        [grant.taskCompletionSource setError:[NSError errorWithDomain:AWSTransferSchedulerErrorDomain
+                                                                 code:AWSTransferSchedulerErrorDeferred
+                                                             userInfo:@{NSLocalizedDescriptionKey: @"The transfer policy does not allow transferring on the current network link."}]];
+    }
+    for (AWSTransferSchedulerGrant *grant in grantedGrants) {
+        [grant.taskCompletionSource setResult:grant];
+    }
+}
+
+- (void)notifyFlushingClients:(NSArray<AWSTransferSchedulerClient *> *)flushingClients {
+    for (AWSTransferSchedulerClient *client in flushingClients) {
+        void (^flushWindowHandler)(void) = client.flushWindowHandler;
+        if (flushWindowHandler) {
+            dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), flushWindowHandler);
+        }
+    }
+}
+
+@end
@@ -20,6 +20,7 @@
 #import "AWSSignature.h"
 #import "AWSBolts.h"
 #import "AWSCredentialsProvider.h"
+#import "AWSTransferScheduler.h"
 
 #pragma mark - AWSURLSessionManagerDelegate
 
@@ -48,10 +49,15 @@ typedef NS_ENUM(NSInteger, AWSURLSessionTaskType) {
 @property (nonatomic, strong) NSURL *tempDownloadedFileURL;
 @property (nonatomic, assign) BOOL shouldWriteDirectly;
 @property (nonatomic, assign) BOOL shouldWriteToFile;
+@property (nonatomic, assign) BOOL shouldPassDataToHandler;
+@property (nonatomic, assign) BOOL hasPassedDataToHandler;
 
 @property (atomic, assign) int64_t lastTotalLengthOfChunkSignatureSent;
 @property (atomic, assign) int64_t payloadTotalBytesWritten;
 
+@property (atomic, assign) CFAbsoluteTime startTime;
+@property (atomic, assign) CFAbsoluteTime responseTime;
+
 @end
 
 @implementation AWSURLSessionManagerDelegate
@@ -140,6 +146,7 @@ typedef NS_ENUM(NSInteger, AWSURLSessionTaskType) {
     delegate.responseData = nil;
     delegate.responseObject = nil;
     delegate.error = nil;
+    delegate.shouldPassDataToHandler = NO;
     NSMutableURLRequest *mutableRequest = [NSMutableURLRequest requestWithURL:delegate.request.URL];
     mutableRequest.cachePolicy = NSURLRequestReloadIgnoringLocalCacheData;
 
@@ -186,6 +193,8 @@ typedef NS_ENUM(NSInteger, AWSURLSessionTaskType) {
 
             [self printHTTPHeadersAndBodyForRequest:delegate.request.task.originalRequest];
 
+            delegate.startTime = CFAbsoluteTimeGetCurrent();
+            delegate.responseTime = 0;
             [delegate.request.task resume];
         } else {
             AWSDDLogError(@"Invalid AWSURLSessionTaskType.");
@@ -212,6 +221,7 @@ typedef NS_ENUM(NSInteger, AWSURLSessionTaskType) {
     }
 
     [self printHTTPHeadersForResponse:sessionTask.response];
+    [self recordTransferOfSessionTask:sessionTask error:error];
 
     [[[AWSTask taskWithResult:nil] continueWithSuccessBlock:^id(AWSTask *task) {
         AWSURLSessionManagerDelegate *delegate = [self.sessionManagerDelegates objectForKey:@(sessionTask.taskIdentifier)];
@@ -288,9 +298,11 @@ typedef NS_ENUM(NSInteger, AWSURLSessionTaskType) {
             }
         }
 
+        // Data already passed to the data handler cannot be taken back, so such a request is not retried.
         if (delegate.error
             && ([sessionTask.response isKindOfClass:[NSHTTPURLResponse class]] || sessionTask.response == nil)
-            && delegate.request.retryHandler) {
+            && delegate.request.retryHandler
+            && !delegate.hasPassedDataToHandler) {
             AWSNetworkingRetryType retryType = [delegate.request.retryHandler shouldRetry:delegate.currentRetryCount
                                                                           originalRequest:delegate.request
                                                                                  response:(NSHTTPURLResponse *)sessionTask.response
@@ -409,6 +421,9 @@ typedef NS_ENUM(NSInteger, AWSURLSessionTaskType) {
 - (void)URLSession:(NSURLSession *)session dataTask:(NSURLSessionDataTask *)dataTask didReceiveResponse:(NSURLResponse *)response
  completionHandler:(void (^)(NSURLSessionResponseDisposition disposition))completionHandler {
     AWSURLSessionManagerDelegate *delegate = [self.sessionManagerDelegates objectForKey:@(dataTask.taskIdentifier)];
+    if (delegate.responseTime == 0) {
+        delegate.responseTime = CFAbsoluteTimeGetCurrent();
+    }
     
     //If the response code is not 2xx, avoid write data to disk
     if ([response isKindOfClass:[NSHTTPURLResponse class]]) {
@@ -416,6 +431,7 @@ typedef NS_ENUM(NSInteger, AWSURLSessionTaskType) {
         
         if (httpResponse.statusCode >= 200 && httpResponse.statusCode < 300 ) {
             // status is good, we can keep value of shouldWriteToFile
+            delegate.shouldPassDataToHandler = !delegate.shouldWriteToFile && delegate.request.dataHandler != nil;
         } else {
             // got error status code, avoid write data to disk
             delegate.shouldWriteToFile = NO;
@@ -499,6 +515,9 @@ typedef NS_ENUM(NSInteger, AWSURLSessionTaskType) {
     
     if (delegate.responseFilehandle) {
         [delegate.responseFilehandle writeData:data];
+    } else if (delegate.shouldPassDataToHandler) {
+        delegate.hasPassedDataToHandler = YES;
+        delegate.request.dataHandler(data);
     } else {
         if (!delegate.responseData) {
             delegate.responseData = [NSMutableData dataWithData:data];
@@ -565,4 +584,17 @@ typedef NS_ENUM(NSInteger, AWSURLSessionTaskType) {
     }
 }
 
+// Feeds the throughput and round trip time estimates of the transfer scheduler.
+- (void)recordTransferOfSessionTask:(NSURLSessionTask *)sessionTask error:(NSError *)error {
+    AWSURLSessionManagerDelegate *delegate = [self.sessionManagerDelegates objectForKey:@(sessionTask.taskIdentifier)];
+    if (!delegate || delegate.startTime == 0 || ([error.domain isEqualToString:NSURLErrorDomain] && error.code == NSURLErrorCancelled)) {
+        return;
+    }
+    CFAbsoluteTime endTime = CFAbsoluteTimeGetCurrent();
+    NSTimeInterval roundTripTime = delegate.responseTime > 0 ? delegate.responseTime - delegate.startTime : 0;
+    [[AWSTransferScheduler sharedScheduler] recordTransferWithBytes:sessionTask.countOfBytesSent + sessionTask.countOfBytesReceived
+                                                           duration:endTime - delegate.startTime
+                                                      roundTripTime:roundTripTime];
+}
+
 @end
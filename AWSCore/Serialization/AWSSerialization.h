@@ -116,6 +116,15 @@ typedef NS_ENUM(NSInteger, AWSJSONParserErrorType) {
                serviceDefinitionRule:(NSDictionary *)serviceDefinitionRule
                                error:(NSError *__autoreleasing *)error;
 
+/**
+ Writes the XML body to `outputStream`, which must be open, without keeping the document in memory.
+ */
++ (BOOL)writeXMLForDictionary:(NSDictionary *)params
+                   actionName:(NSString *)actionName
+        serviceDefinitionRule:(NSDictionary *)serviceDefinitionRule
+               toOutputStream:(NSOutputStream *)outputStream
+                        error:(NSError *__autoreleasing *)error;
+
 @end
 
 @interface AWSXMLParser : NSObject
@@ -14,6 +14,7 @@
 //
 #import "AWSSerialization.h"
 #import "AWSXMLWriter.h"
+#import "AWSXMLByteWriter.h"
 #import "AWSCategory.h"
 #import "AWSCocoaLumberjack.h"
 #import "AWSXMLDictionary.h"
@@ -104,7 +105,11 @@ NSString *const AWSJSONParserErrorDomain = @"com.amazonaws.AWSJSONParserErrorDom
 }
 
 + (NSString *)xmlStringForDictionary:(NSDictionary *)params actionName:(NSString *)actionName serviceDefinitionRule:(NSDictionary *)serviceDefinitionRule error:(NSError *__autoreleasing *)error {
-    return [[self xmlBuildForDictionary:params actionName:actionName serviceDefinitionRule:serviceDefinitionRule error:error] toString];
+    AWSXMLByteWriter *xmlWriter = [AWSXMLByteWriter new];
+    if (![self xmlBuildForDictionary:params actionName:actionName serviceDefinitionRule:serviceDefinitionRule xmlWriter:xmlWriter error:error]) {
+        return nil;
+    }
+    return [xmlWriter toString];
 }
 
 + (NSData *)xmlDataForDictionary:(NSDictionary *)params actionName:(NSString *)actionName serviceDefinitionRule:(NSDictionary *)serviceDefinitionRule error:(NSError *__autoreleasing *)error {
@@ -112,30 +117,53 @@ NSString *const AWSJSONParserErrorDomain = @"com.amazonaws.AWSJSONParserErrorDom
     if ([params count] == 0) {
         return nil;
     }
-    NSData *resultData = [[self xmlBuildForDictionary:params actionName:actionName serviceDefinitionRule:serviceDefinitionRule  error:error] toData];
+    AWSXMLByteWriter *xmlWriter = [AWSXMLByteWriter new];
+    if (![self xmlBuildForDictionary:params actionName:actionName serviceDefinitionRule:serviceDefinitionRule xmlWriter:xmlWriter error:error]) {
+        return nil;
+    }
 
-    return resultData;
+    return [xmlWriter toData];
 }
 
-+ (AWSXMLWriter *)xmlBuildForDictionary:(NSDictionary *)params actionName:(NSString *)actionName serviceDefinitionRule:(NSDictionary *)serviceDefinitionRule error:(NSError *__autoreleasing *)error {
++ (BOOL)writeXMLForDictionary:(NSDictionary *)params actionName:(NSString *)actionName serviceDefinitionRule:(NSDictionary *)serviceDefinitionRule toOutputStream:(NSOutputStream *)outputStream error:(NSError *__autoreleasing *)error {
+    AWSXMLByteWriter *xmlWriter = [[AWSXMLByteWriter alloc] initWithOutputStream:outputStream];
+    NSError *buildError = nil;
+    BOOL built = [self xmlBuildForDictionary:params actionName:actionName serviceDefinitionRule:serviceDefinitionRule xmlWriter:xmlWriter error:&buildError];
+    [xmlWriter close];
+
+    if (!built || buildError) {
+        if (error) {
+            *error = buildError;
+        }
+        return NO;
+    }
+    if (xmlWriter.streamError) {
+        if (error) {
+            *error = xmlWriter.streamError;
+        }
+        return NO;
+    }
+    return YES;
+}
+
++ (BOOL)xmlBuildForDictionary:(NSDictionary *)params actionName:(NSString *)actionName serviceDefinitionRule:(NSDictionary *)serviceDefinitionRule xmlWriter:(id<AWSXMLStreamWriter>)xmlWriter error:(NSError *__autoreleasing *)error {
 
     NSDictionary *actionRule = [[[serviceDefinitionRule objectForKey:@"operations"] objectForKey:actionName] objectForKey:@"input"];
     NSDictionary *definitionRules = [serviceDefinitionRule objectForKey:@"shapes"];
 
     if (definitionRules == (id)[NSNull null] ||  [definitionRules count] == 0) {
         [self failWithCode:AWSXMLBuilderDefinitionFileIsEmpty description:@"JSON definition File is empty or can not be found" error:error];
-        return nil;
+        return NO;
     }
 
 
 
     if ([actionRule count] == 0) {
         [self failWithCode:AWSXMLBuilderUndefinedActionRule description:@"Invalid argument: actionRule is Empty" error:error];
-        return nil;
+        return NO;
     }
 
 
-    AWSXMLWriter* xmlWriter = [[AWSXMLWriter alloc]init];
     AWSJSONDictionary *rules = [[AWSJSONDictionary alloc] initWithDictionary:actionRule JSONDefinitionRule:definitionRules];
 
     NSString *xmlElementName = rules[@"locationName"];
@@ -150,10 +178,10 @@ NSString *const AWSJSONParserErrorDomain = @"com.amazonaws.AWSJSONParserErrorDom
         [xmlWriter writeEndElement:xmlElementName];
     }
 
-    return xmlWriter;
+    return YES;
 }
 
-+ (BOOL)serializeStructure:(NSDictionary *)params rules:(AWSJSONDictionary *)rules xmlWriter:(AWSXMLWriter *)xmlWriter error:(NSError *__autoreleasing *)error isRootRule:(BOOL)isRootRule {
++ (BOOL)serializeStructure:(NSDictionary *)params rules:(AWSJSONDictionary *)rules xmlWriter:(id<AWSXMLStreamWriter>)xmlWriter error:(NSError *__autoreleasing *)error isRootRule:(BOOL)isRootRule {
 
     AWSJSONDictionary *structureMembersRule = rules[@"members"]?rules[@"members"]:@{};
 
@@ -203,7 +231,7 @@ NSString *const AWSJSONParserErrorDomain = @"com.amazonaws.AWSJSONParserErrorDom
     return isValid;
 }
 
-+ (BOOL)serializeList:(NSArray *)list name:(NSString *)name rules:(AWSJSONDictionary *)rules xmlWriter:(AWSXMLWriter *)xmlWriter error:(NSError *__autoreleasing *)error {
++ (BOOL)serializeList:(NSArray *)list name:(NSString *)name rules:(AWSJSONDictionary *)rules xmlWriter:(id<AWSXMLStreamWriter>)xmlWriter error:(NSError *__autoreleasing *)error {
 
     AWSJSONDictionary *memberRules = rules[@"member"]?rules[@"member"]:@{};
     NSString *xmlListName = rules[@"locationName"]?rules[@"locationName"]:name;
@@ -241,7 +269,7 @@ NSString *const AWSJSONParserErrorDomain = @"com.amazonaws.AWSJSONParserErrorDom
     return isValid;
 }
 
-+ (BOOL)serializeMember:(id)params name:(NSString *)memberName rules:(AWSJSONDictionary *)rules isPayloadType:(Boolean)isPayloadType xmlWriter:(AWSXMLWriter *)xmlWriter error:(NSError *__autoreleasing *)error {
++ (BOOL)serializeMember:(id)params name:(NSString *)memberName rules:(AWSJSONDictionary *)rules isPayloadType:(Boolean)isPayloadType xmlWriter:(id<AWSXMLStreamWriter>)xmlWriter error:(NSError *__autoreleasing *)error {
     NSString *xmlElementName = rules[@"locationName"]?rules[@"locationName"]:memberName;
     NSString *rulesType = rules[@"type"];
     if ([rulesType isEqualToString:@"structure"]) {
@@ -333,7 +361,7 @@ NSString *const AWSJSONParserErrorDomain = @"com.amazonaws.AWSJSONParserErrorDom
     return YES;
 }
 
-+ (void)applyNamespacesAndAttributesByRules:(NSDictionary *)rules params:(id)params xmlWriter:(AWSXMLWriter *)xmlWriter {
++ (void)applyNamespacesAndAttributesByRules:(NSDictionary *)rules params:(id)params xmlWriter:(id<AWSXMLStreamWriter>)xmlWriter {
     id xmlNamespaceValue = rules[@"xmlNamespace"];
     if (xmlNamespaceValue) {
         if ([xmlNamespaceValue isKindOfClass:[NSDictionary class]]) {
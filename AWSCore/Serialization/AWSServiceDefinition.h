@@ -0,0 +1,52 @@
+//
+// Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+FOUNDATION_EXPORT NSString *const AWSServiceDefinitionErrorDomain;
+
+typedef NS_ENUM(NSInteger, AWSServiceDefinitionErrorType) {
+    AWSServiceDefinitionErrorUnknown,
+    AWSServiceDefinitionErrorInvalidJSON,
+};
+
+/**
+ Loads the JSON service definitions embedded in the `*Resources` classes.
+ */
+@interface AWSServiceDefinition : NSObject
+
+/**
+ Returns the service definition in the given JSON string without parsing its operations and shapes up front.
+
+ Only the opening brace is checked up front. A lookup scans forward from where the previous one stopped only until it finds its key,
+ and the `operations` and `shapes` values index their entries the same way, so a client that calls two operations
+ only scans as far as the entries it uses and only parses those entries. Reaching a later top-level value skips over
+ the bytes of the earlier ones without indexing them. `count`, enumeration and equality scan the whole object.
+ A string literal with only ASCII characters, such as the one a `*Resources` class returns, is read in place and
+ retained; any other string is copied as UTF-8 once. Either way the string may be released or mutated after the call.
+
+ @param JSONString The service definition, usually the string literal returned by a `*Resources` class.
+ @param error On failure, an error in `AWSServiceDefinitionErrorDomain` describing the problem.
+
+ @return The definition, or `nil` if the string does not start with a JSON object. Problems further into the string
+         are logged when a lookup first reaches them, and the members after them are treated as missing.
+ */
++ (nullable NSDictionary *)definitionWithJSONString:(NSString *)JSONString error:(NSError **)error;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,348 @@
+//
+// Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+
+#import "AWSServiceDefinition.h"
+#import <pthread.h>
+#import "AWSCocoaLumberjack.h"
+
+NSString *const AWSServiceDefinitionErrorDomain = @"com.amazonaws.AWSServiceDefinitionErrorDomain";
+
+// The top-level members whose entries are parsed on demand.
+static NSString *const AWSServiceDefinitionOperationsKey = @"operations";
+static NSString *const AWSServiceDefinitionShapesKey = @"shapes";
+
+#pragma mark - Scanner
+
+// A minimal JSON scanner: it finds where values start and end without building them.
+typedef struct {
+    const uint8_t *bytes;
+    NSUInteger length;
+    NSUInteger position;
+} AWSServiceDefinitionScanner;
+
+static void AWSServiceDefinitionSkipWhitespace(AWSServiceDefinitionScanner *scanner) {
+    while (scanner->position < scanner->length) {
+        uint8_t c = scanner->bytes[scanner->position];
+        if (c != ' ' && c != '\n' && c != '\r' && c != '\t') {
+            return;
+        }
+        scanner->position++;
+    }
+}
+
+static BOOL AWSServiceDefinitionScanByte(AWSServiceDefinitionScanner *scanner, uint8_t byte) {
+    AWSServiceDefinitionSkipWhitespace(scanner);
+    if (scanner->position < scanner->length && scanner->bytes[scanner->position] == byte) {
+        scanner->position++;
+        return YES;
+    }
+    return NO;
+}
+
+// Expects the scanner on an opening quote and leaves it after the closing one.
+static BOOL AWSServiceDefinitionSkipString(AWSServiceDefinitionScanner *scanner, BOOL *escaped) {
+    scanner->position++;
+    while (scanner->position < scanner->length) {
+        uint8_t c = scanner->bytes[scanner->position++];
+        if (c == '"') {
+            return YES;
+        }
+        if (c == '\\') {
+            if (escaped) {
+                *escaped = YES;
+            }
+            scanner->position++;
+        }
+    }
+    return NO;
+}
+
+static BOOL AWSServiceDefinitionSkipValue(AWSServiceDefinitionScanner *scanner) {
+    AWSServiceDefinitionSkipWhitespace(scanner);
+    if (scanner->position >= scanner->length) {
+        return NO;
+    }
+
+    uint8_t c = scanner->bytes[scanner->position];
+    if (c == '"') {
+        return AWSServiceDefinitionSkipString(scanner, NULL);
+    }
+
+    if (c == '{' || c == '[') {
+        NSUInteger depth = 0;
+        while (scanner->position < scanner->length) {
+            c = scanner->bytes[scanner->position];
+            if (c == '"') {
+                if (!AWSServiceDefinitionSkipString(scanner, NULL)) {
+                    return NO;
+                }
+                continue;
+            }
+            scanner->position++;
+            if (c == '{' || c == '[') {
+                depth++;
+            } else if (c == '}' || c == ']') {
+                if (--depth == 0) {
+                    return YES;
+                }
+            }
+        }
+        return NO;
+    }
+
+    // A number, true, false or null.
+    NSUInteger start = scanner->position;
+    while (scanner->position < scanner->length) {
+        c = scanner->bytes[scanner->position];
+        if (c == ',' || c == '}' || c == ']' || c == ' ' || c == '\n' || c == '\r' || c == '\t') {
+            break;
+        }
+        scanner->position++;
+    }
+    return scanner->position > start;
+}
+
+static NSString *AWSServiceDefinitionScanKey(AWSServiceDefinitionScanner *scanner) {
+    AWSServiceDefinitionSkipWhitespace(scanner);
+    if (scanner->position >= scanner->length || scanner->bytes[scanner->position] != '"') {
+        return nil;
+    }
+
+    NSUInteger start = scanner->position;
+    BOOL escaped = NO;
+    if (!AWSServiceDefinitionSkipString(scanner, &escaped)) {
+        return nil;
+    }
+
+    if (escaped) {
+        NSData *data = [NSData dataWithBytes:scanner->bytes + start length:scanner->position - start];
+        return [NSJSONSerialization JSONObjectWithData:data options:NSJSONReadingAllowFragments error:nil];
+    }
+    return [[NSString alloc] initWithBytes:scanner->bytes + start + 1
+                                    length:scanner->position - start - 2
+                                  encoding:NSUTF8StringEncoding];
+}
+
+#pragma mark - AWSLazyServiceDefinitionDictionary
+
+// An immutable dictionary over the members of one JSON object. Members are located by scanning forward from the
+// opening brace only as far as a lookup needs, and each value is parsed the first time it is looked up.
+@interface AWSLazyServiceDefinitionDictionary : NSDictionary {
+    NSData *_data;
+    BOOL _root;
+    AWSServiceDefinitionScanner _scanner;
+    BOOL _scannedMember;
+    BOOL _skipsValue;
+    BOOL _complete;
+    NSMutableOrderedSet<NSString *> *_keys;
+    NSMutableDictionary<NSString *, NSValue *> *_ranges;
+    NSMutableDictionary<NSString *, id> *_parsedValues;
+    pthread_mutex_t _lock;
+}
+
+// `location` is the offset of the object's opening brace. The root object keeps its `operations` and `shapes` as
+// lazy dictionaries of their own and checks that nothing but whitespace follows its closing brace.
+- (instancetype)initWithData:(NSData *)data location:(NSUInteger)location root:(BOOL)root;
+
+@end
+
+@implementation AWSLazyServiceDefinitionDictionary
+
+- (instancetype)initWithData:(NSData *)data location:(NSUInteger)location root:(BOOL)root {
+    if (self = [super init]) {
+        _data = data;
+        _root = root;
+        _scanner = (AWSServiceDefinitionScanner){[data bytes], [data length], location + 1};
+        _keys = [NSMutableOrderedSet new];
+        _ranges = [[NSMutableDictionary alloc] initWithCapacity:16];
+        _parsedValues = [[NSMutableDictionary alloc] initWithCapacity:16];
+        pthread_mutex_init(&_lock, NULL);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    pthread_mutex_destroy(&_lock);
+}
+
+// Must be called with the lock held. Returns the key of the next member, or nil once the object is exhausted.
+- (NSString *)scanNextMember {
+    AWSServiceDefinitionScanner *scanner = &_scanner;
+    while (!_complete) {
+        // A nested lazy dictionary does not move this scanner, so its value is skipped only when a later member is needed.
+        if (_skipsValue) {
+            _skipsValue = NO;
+            if (!AWSServiceDefinitionSkipValue(scanner)) {
+                break;
+            }
+        }
+
+        BOOL hasMember = _scannedMember ? AWSServiceDefinitionScanByte(scanner, ',') : !AWSServiceDefinitionScanByte(scanner, '}');
+        if (!hasMember) {
+            if (_scannedMember && !AWSServiceDefinitionScanByte(scanner, '}')) {
+                break;
+            }
+            AWSServiceDefinitionSkipWhitespace(scanner);
+            if (_root && scanner->position != scanner->length) {
+                break;
+            }
+            _complete = YES;
+            return nil;
+        }
+        _scannedMember = YES;
+
+        NSString *key = AWSServiceDefinitionScanKey(scanner);
+        if (!key || !AWSServiceDefinitionScanByte(scanner, ':')) {
+            break;
+        }
+
+        // The first of two members with the same key wins, whichever order they are looked up in.
+        AWSServiceDefinitionSkipWhitespace(scanner);
+        NSUInteger start = scanner->position;
+        BOOL isObject = start < scanner->length && scanner->bytes[start] == '{';
+        if (_root && isObject
+            && ([key isEqualToString:AWSServiceDefinitionOperationsKey] || [key isEqualToString:AWSServiceDefinitionShapesKey])) {
+            _skipsValue = YES;
+            if ([_keys containsObject:key]) {
+                continue;
+            }
+            [_parsedValues setObject:[[AWSLazyServiceDefinitionDictionary alloc] initWithData:_data location:start root:NO]
+                              forKey:key];
+        } else {
+            if (!AWSServiceDefinitionSkipValue(scanner)) {
+                break;
+            }
+            if ([_keys containsObject:key]) {
+                continue;
+            }
+            [_ranges setObject:[NSValue valueWithRange:NSMakeRange(start, scanner->position - start)] forKey:key];
+        }
+        [_keys addObject:key];
+        return key;
+    }
+
+    if (!_complete) {
+        _complete = YES;
+        AWSDDLogError(@"The JSON service definition is invalid near byte %lu; the members after it are ignored.", (unsigned long)scanner->position);
+    }
+    return nil;
+}
+
+- (void)scanAllMembers {
+    pthread_mutex_lock(&_lock);
+    while ([self scanNextMember]) {
+    }
+    pthread_mutex_unlock(&_lock);
+}
+
+- (NSUInteger)count {
+    [self scanAllMembers];
+    return [_keys count];
+}
+
+- (id)objectForKey:(id)aKey {
+    pthread_mutex_lock(&_lock);
+    id value = [_parsedValues objectForKey:aKey];
+    NSValue *rangeValue = value ? nil : [_ranges objectForKey:aKey];
+    if (!value && !rangeValue && ![_keys containsObject:aKey]) {
+        NSString *key = nil;
+        do {
+            key = [self scanNextMember];
+        } while (key && ![key isEqual:aKey]);
+        value = [_parsedValues objectForKey:aKey];
+        rangeValue = [_ranges objectForKey:aKey];
+    }
+    pthread_mutex_unlock(&_lock);
+    if (value || !rangeValue) {
+        return value;
+    }
+
+    // Parse outside the lock; if two threads race, both results are equal and the first one is kept.
+    NSRange range = [rangeValue rangeValue];
+    NSData *fragment = [NSData dataWithBytesNoCopy:(void *)((const uint8_t *)[_data bytes] + range.location)
+                                            length:range.length
+                                      freeWhenDone:NO];
+    NSError *error = nil;
+    value = [NSJSONSerialization JSONObjectWithData:fragment options:NSJSONReadingAllowFragments error:&error];
+    if (!value) {
+        AWSDDLogError(@"Failed to parse '%@' in the JSON service definition: %@", aKey, error);
+        return nil;
+    }
+
+    pthread_mutex_lock(&_lock);
+    id parsedValue = [_parsedValues objectForKey:aKey];
+    if (parsedValue) {
+        value = parsedValue;
+    } else {
+        [_parsedValues setObject:value forKey:aKey];
+    }
+    pthread_mutex_unlock(&_lock);
+
+    return value;
+}
+
+- (NSEnumerator *)keyEnumerator {
+    [self scanAllMembers];
+    return [_keys objectEnumerator];
+}
+
+// Immutable; copying must not turn the dictionary into an eagerly parsed one.
+- (id)copyWithZone:(NSZone *)zone {
+    return self;
+}
+
+@end
+
+#pragma mark - AWSServiceDefinition
+
+@implementation AWSServiceDefinition
+
+// The lazy dictionaries read from this buffer long after the call returns, so it must own or retain its bytes.
++ (NSData *)UTF8DataWithString:(NSString *)JSONString {
+    // Copying an immutable string, such as the literal a `*Resources` class returns, only retains it.
+    NSString *string = [JSONString copy];
+
+    // A literal with only ASCII characters is stored as its UTF-8 bytes, which can be read in place.
+    const char *bytes = CFStringGetCStringPtr((__bridge CFStringRef)string, kCFStringEncodingUTF8);
+    if (!bytes) {
+        return [string dataUsingEncoding:NSUTF8StringEncoding];
+    }
+
+    CFTypeRef owner = CFBridgingRetain(string);
+    return [[NSData alloc] initWithBytesNoCopy:(void *)bytes
+                                        length:[string length]
+                                   deallocator:^(void *deallocatedBytes, NSUInteger length) {
+                                       CFRelease(owner);
+                                   }];
+}
+
++ (NSDictionary *)definitionWithJSONString:(NSString *)JSONString error:(NSError *__autoreleasing *)error {
+    NSData *data = [self UTF8DataWithString:JSONString];
+
+    AWSServiceDefinitionScanner scanner = {[data bytes], [data length], 0};
+    AWSServiceDefinitionSkipWhitespace(&scanner);
+    if (scanner.position >= scanner.length || scanner.bytes[scanner.position] != '{') {
+        if (error) {
+            *error = [NSError errorWithDomain:AWSServiceDefinitionErrorDomain
+                                         code:AWSServiceDefinitionErrorInvalidJSON
+                                     userInfo:@{NSLocalizedDescriptionKey : @"The service definition is not a JSON object."}];
+        }
+        return nil;
+    }
+
+    return [[AWSLazyServiceDefinitionDictionary alloc] initWithData:data location:scanner.position root:YES];
+}
+
+@end
@@ -23,6 +23,20 @@
 - (instancetype)initWithJSONDefinition:(NSDictionary *)JSONDefinition
                             actionName:(NSString *)actionName;
 
+/**
+ The gzip compression level used when the `Content-Encoding` header includes `gzip`,
+ from 0.0 (no compression) to 1.0 (best compression). A negative value, the default, selects the zlib default level.
+ */
+@property (nonatomic, assign) float compressionLevel;
+
+/**
+ Whether a streaming payload is compressed while it is uploaded when the `Content-Encoding` header includes `gzip`.
+ Its compressed hash is then unknown when the request is signed, so set it only when the signer sends
+ `UNSIGNED-PAYLOAD`, see `AWSSignatureV4Signer.allowsUnsignedPayload`; otherwise the signer reads the whole compressed
+ stream into memory to hash it. The default is `NO`, which compresses the payload into memory before signing.
+ */
+@property (nonatomic, assign) BOOL streamsCompressedBodies;
+
 @end
 
 @interface AWSXMLRequestSerializer : NSObject <AWSURLRequestSerializer>
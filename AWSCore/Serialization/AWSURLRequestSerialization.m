@@ -22,6 +22,7 @@
 #import "AWSCategory.h"
 #import "AWSCocoaLumberjack.h"
 #import "AWSClientContext.h"
+#import "AWSSignature.h"
 
 @interface NSMutableURLRequest (AWSRequestSerializer)
 
@@ -65,6 +66,7 @@
             return nil;
         }
         _actionName = actionName;
+        _compressionLevel = -1.0f;
     }
 
     return self;
@@ -104,17 +106,31 @@
         return [AWSTask taskWithError:error];
     }
 
+    BOOL gzipBody = headers[@"Content-Encoding"] && [headers[@"Content-Encoding"] rangeOfString:@"gzip"].location != NSNotFound;
+
     //construct HTTPBody only if HTTPBodyStream is nil
     if (!request.HTTPBodyStream) {
         NSData *bodyData = [AWSJSONBuilder jsonDataForDictionary:parameters actionName:self.actionName serviceDefinitionRule:self.serviceDefinitionJSON error:&error];
         if (!error) {
-            if (headers[@"Content-Encoding"] && [headers[@"Content-Encoding"] rangeOfString:@"gzip"].location != NSNotFound) {
-                //gzip the body
-                request.HTTPBody = [bodyData awsgzip_gzippedData];
+            if (gzipBody) {
+                //gzip the body. The signer hashes the compressed payload, so it is compressed up front in a single pass.
+                request.HTTPBody = [bodyData awsgzip_gzippedDataWithCompressionLevel:self.compressionLevel];
             } else {
                 request.HTTPBody = bodyData;
             }
         }
+    } else if (gzipBody) {
+        if (self.streamsCompressedBodies) {
+            //compress a streaming payload while it is uploaded; its compressed length is unknown until then.
+            request.HTTPBodyStream = [[AWSGZIPInputStream alloc] initWithInputStream:request.HTTPBodyStream
+                                                                    compressionLevel:self.compressionLevel];
+        } else {
+            //the signer hashes the compressed payload, so compress it up front like an in-memory body.
+            request.HTTPBody = [self gzippedBodyOfRequest:request error:&error];
+        }
+        [request setValue:nil forHTTPHeaderField:@"Content-Length"];
+        //the recorded payload is the uncompressed one.
+        [NSURLProtocol removePropertyForKey:AWSSignatureV4PayloadSourceKey inRequest:request];
     }
 
     [request aws_validateHTTPMethodAndBody];
@@ -140,6 +156,31 @@
 
 }
 
+- (NSData *)gzippedBodyOfRequest:(NSURLRequest *)request error:(NSError *__autoreleasing *)error {
+    id payloadSource = [NSURLProtocol propertyForKey:AWSSignatureV4PayloadSourceKey inRequest:request];
+    if ([payloadSource isKindOfClass:[NSData class]]) {
+        return [payloadSource awsgzip_gzippedDataWithCompressionLevel:self.compressionLevel];
+    }
+
+    AWSGZIPInputStream *stream = [[AWSGZIPInputStream alloc] initWithInputStream:request.HTTPBodyStream
+                                                                compressionLevel:self.compressionLevel];
+    NSMutableData *data = [NSMutableData new];
+    uint8_t buffer[16 * 1024];
+    NSInteger read = 0;
+    [stream open];
+    while ((read = [stream read:buffer maxLength:sizeof(buffer)]) > 0) {
+        [data appendBytes:buffer length:(NSUInteger)read];
+    }
+    [stream close];
+    if (read < 0) {
+        if (error) {
+            *error = [stream streamError];
+        }
+        return nil;
+    }
+    return data;
+}
+
 @end
 
 @interface AWSXMLRequestSerializer()
@@ -330,6 +371,7 @@
                 if ([value isKindOfClass:[NSURL class]]) {
                     if ([value checkResourceIsReachableAndReturnError:&blockErr]) {
                         request.HTTPBodyStream = [NSInputStream inputStreamWithURL:value];
+                        [NSURLProtocol setProperty:[value path] forKey:AWSSignatureV4PayloadSourceKey inRequest:request];
                     } else {
                         //URL is not reachable, stop enumeration
                         isValid = NO;
@@ -341,6 +383,7 @@
                     }
                     if ([value isKindOfClass:[NSData class]]) {
                         request.HTTPBodyStream = [NSInputStream inputStreamWithData:value];
+                        [NSURLProtocol setProperty:value forKey:AWSSignatureV4PayloadSourceKey inRequest:request];
                     }
                 }
             }
@@ -350,12 +393,14 @@
                 AWSDDLogVerbose(@"value type = %@", [value class]);
                 if([value isKindOfClass:[NSInputStream class]]){
                     request.HTTPBodyStream = value;
+                    [NSURLProtocol removePropertyForKey:AWSSignatureV4PayloadSourceKey inRequest:request];
                 }else{
                     if ([value isKindOfClass:[NSString class]]) {
                         value = [value dataUsingEncoding:NSUTF8StringEncoding];
                     }
                     if ([value isKindOfClass:[NSData class]]) {
                         request.HTTPBodyStream = [NSInputStream inputStreamWithData:value];
+                        [NSURLProtocol setProperty:value forKey:AWSSignatureV4PayloadSourceKey inRequest:request];
                     }
                 }
             }
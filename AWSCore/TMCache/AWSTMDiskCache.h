@@ -21,6 +21,11 @@
 
  All access to the cache is dated so the that the least-used objects can be trimmed first. Setting an optional
  <ageLimit> will trigger a GCD timer to periodically to trim the cache with <trimToDate:>.
+
+ The key, size, access date and class of every object are kept in a small SQLite index inside the cache directory.
+ Launching, trimming and enumerating read the index instead of the attributes of every file. Objects are written
+ to a temporary file and moved into place, and an interrupted write is reconciled with the index on the next launch.
+ A cache created before the index existed is indexed once from its files.
  */
 
 #import <Foundation/Foundation.h>
@@ -30,6 +35,7 @@
 
 typedef void (^AWSTMDiskCacheBlock)(AWSTMDiskCache *cache);
 typedef void (^AWSTMDiskCacheObjectBlock)(AWSTMDiskCache *cache, NSString *key, id <NSCoding> object, NSURL *fileURL);
+typedef void (^AWSTMDiskCacheKeysBlock)(AWSTMDiskCache *cache, NSArray<NSString *> *keys);
 
 @interface AWSTMDiskCache : NSObject
 
@@ -254,6 +260,16 @@ typedef void (^AWSTMDiskCacheObjectBlock)(AWSTMDiskCache *cache, NSString *key,
  */
 - (void)enumerateObjectsWithBlock:(AWSTMDiskCacheObjectBlock)block completionBlock:(AWSTMDiskCacheBlock)completionBlock;
 
+/**
+ Retrieves the keys of the objects that are instances of the given classes or their subclasses, least recently used
+ first, without reading any object from disk. Objects stored before the cache kept an index have no recorded class
+ and are always included. This method returns immediately and executes the passed block on the serial <sharedQueue>.
+
+ @param classes The classes of the objects whose keys are requested.
+ @param block A block to be executed serially with the keys.
+ */
+- (void)keysForObjectsOfClasses:(NSArray<Class> *)classes block:(AWSTMDiskCacheKeysBlock)block;
+
 #pragma mark -
 /// @name Synchronous Methods
 
@@ -337,6 +353,16 @@ typedef void (^AWSTMDiskCacheObjectBlock)(AWSTMDiskCache *cache, NSString *key,
  */
 - (void)enumerateObjectsWithBlock:(AWSTMDiskCacheObjectBlock)block;
 
+/**
+ Retrieves the keys of the objects that are instances of the given classes or their subclasses, least recently used
+ first. This method blocks the calling thread until the keys are available.
+
+ @see keysForObjectsOfClasses:block:
+ @param classes The classes of the objects whose keys are requested.
+ @result The keys of the matching objects.
+ */
+- (NSArray<NSString *> *)keysForObjectsOfClasses:(NSArray<Class> *)classes;
+
 #pragma mark -
 /// @name Background Tasks
 
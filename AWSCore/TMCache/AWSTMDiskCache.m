@@ -1,5 +1,6 @@
 #import "AWSTMDiskCache.h"
 #import "AWSTMCacheBackgroundTaskManager.h"
+#import "AWSFMDB.h"
 
 #if __IPHONE_OS_VERSION_MIN_REQUIRED >= __IPHONE_4_0
 #import <UIKit/UIKit.h>
@@ -14,12 +15,25 @@ static id <AWSTMCacheBackgroundTaskManager> AWSTMCacheBackgroundTaskManager;
 NSString * const AWSTMDiskCachePrefix = @"com.tumblr.TMDiskCache";
 NSString * const AWSTMDiskCacheSharedName = @"TMDiskCacheShared";
 
+// Hidden, like its -wal and -shm companions, so it is never mistaken for a cached object.
+static NSString * const AWSTMDiskCacheIndexName = @".AWSTMDiskCacheIndex.sqlite";
+static int const AWSTMDiskCacheIndexVersion = 1;
+
+// An entry with a NULL byte_count is being written; type is the class name of the archived object, when known.
+static NSString * const AWSTMDiskCacheIndexCreateStatements =
+    @"CREATE TABLE IF NOT EXISTS entries ("
+    @"key TEXT PRIMARY KEY NOT NULL, "
+    @"byte_count INTEGER, "
+    @"access_date REAL NOT NULL, "
+    @"type TEXT);"
+    @"CREATE INDEX IF NOT EXISTS entries_access_date ON entries (access_date);"
+    @"CREATE INDEX IF NOT EXISTS entries_byte_count ON entries (byte_count);";
+
 @interface AWSTMDiskCache ()
 @property (assign) NSUInteger byteCount;
 @property (strong, nonatomic) NSURL *cacheURL;
 @property (assign, nonatomic) dispatch_queue_t queue;
-@property (strong, nonatomic) NSMutableDictionary *dates;
-@property (strong, nonatomic) NSMutableDictionary *sizes;
+@property (strong, nonatomic) AWSFMDatabase *index;
 @end
 
 @implementation AWSTMDiskCache
@@ -60,9 +74,6 @@ NSString * const AWSTMDiskCacheSharedName = @"TMDiskCacheShared";
         _byteLimit = 0;
         _ageLimit = 0.0;
 
-        _dates = [[NSMutableDictionary alloc] init];
-        _sizes = [[NSMutableDictionary alloc] init];
-
         NSString *pathComponent = [[NSString alloc] initWithFormat:@"%@.%@", AWSTMDiskCachePrefix, _name];
         _cacheURL = [NSURL fileURLWithPathComponents:@[ rootPath, pathComponent ]];
 
@@ -248,7 +259,35 @@ NSString * const AWSTMDiskCacheSharedName = @"TMDiskCacheShared";
 
 - (void)initializeDiskProperties
 {
-    NSUInteger byteCount = 0;
+    NSURL *indexURL = [_cacheURL URLByAppendingPathComponent:AWSTMDiskCacheIndexName];
+    BOOL indexExists = [[NSFileManager defaultManager] fileExistsAtPath:[indexURL path]];
+
+    _index = [AWSFMDatabase databaseWithPath:[indexURL path]];
+    if (![_index open]) {
+        NSLog(@"%@ ERROR: unable to open the index, keeping it in memory: %@", [self description], [_index lastErrorMessage]);
+        _index = [AWSFMDatabase databaseWithPath:nil];
+        [_index open];
+        indexExists = NO;
+    }
+
+    // WAL without full syncs: a crash can lose the last few access dates, never the consistency of the index.
+    [_index executeStatements:@"PRAGMA journal_mode = WAL; PRAGMA synchronous = NORMAL;"];
+    [_index executeStatements:AWSTMDiskCacheIndexCreateStatements];
+    [_index setShouldCacheStatements:YES];
+
+    if (!indexExists || [_index intForQuery:@"PRAGMA user_version"] != AWSTMDiskCacheIndexVersion) {
+        [self rebuildIndexFromCacheDirectory];
+    } else {
+        [self reconcilePendingIndexEntries];
+    }
+
+    self.byteCount = (NSUInteger)[_index longForQuery:@"SELECT IFNULL(SUM(byte_count), 0) FROM entries"]; // atomic
+}
+
+// Builds the index the way the cache used to find its objects: by reading the attributes of every file.
+// This only happens for a cache created before the index existed, or after the index was lost.
+- (void)rebuildIndexFromCacheDirectory
+{
     NSArray *keys = @[ NSURLContentModificationDateKey, NSURLTotalFileAllocatedSizeKey ];
 
     NSError *error = nil;
@@ -258,56 +297,164 @@ NSString * const AWSTMDiskCacheSharedName = @"TMDiskCacheShared";
                                                                         error:&error];
     AWSTMDiskCacheError(error);
 
+    [_index beginTransaction];
+    [_index executeUpdate:@"DELETE FROM entries"];
+
     for (NSURL *fileURL in files) {
         NSString *key = [self keyForEncodedFileURL:fileURL];
+        if (!key)
+            continue;
 
         error = nil;
         NSDictionary *dictionary = [fileURL resourceValuesForKeys:keys error:&error];
         AWSTMDiskCacheError(error);
 
-        NSDate *date = [dictionary objectForKey:NSURLContentModificationDateKey];
-        if (date && key)
-            [_dates setObject:date forKey:key];
+        NSDate *date = [dictionary objectForKey:NSURLContentModificationDateKey] ?: [NSDate date];
+        NSNumber *fileSize = [dictionary objectForKey:NSURLTotalFileAllocatedSizeKey] ?: @0;
 
-        NSNumber *fileSize = [dictionary objectForKey:NSURLTotalFileAllocatedSizeKey];
-        if (fileSize) {
-            [_sizes setObject:fileSize forKey:key];
-            byteCount += [fileSize unsignedIntegerValue];
-        }
+        [_index executeUpdate:@"INSERT OR REPLACE INTO entries (key, byte_count, access_date, type) VALUES (?, ?, ?, NULL)",
+         key, fileSize, date];
     }
 
-    if (byteCount > 0)
-        self.byteCount = byteCount; // atomic
+    [_index executeUpdate:[NSString stringWithFormat:@"PRAGMA user_version = %d", AWSTMDiskCacheIndexVersion]];
+    [_index commit];
 }
 
-- (BOOL)setFileModificationDate:(NSDate *)date forURL:(NSURL *)fileURL
+// Entries without a byte count were being written when the app last stopped.
+- (void)reconcilePendingIndexEntries
 {
-    if (!date || !fileURL) {
-        return NO;
+    NSMutableArray *keys = [[NSMutableArray alloc] init];
+    AWSFMResultSet *resultSet = [_index executeQuery:@"SELECT key FROM entries WHERE byte_count IS NULL"];
+    while ([resultSet next]) {
+        [keys addObject:[resultSet stringForColumnIndex:0]];
     }
-    
+    [resultSet close];
+
+    for (NSString *key in keys) {
+        [self reconcileIndexEntryForKey:key];
+    }
+}
+
+// Makes the entry for the key match its file: records the file's size, or drops the entry when there is no file.
+// Returns the recorded size.
+- (NSUInteger)reconcileIndexEntryForKey:(NSString *)key
+{
+    NSURL *fileURL = [self encodedFileURLForKey:key];
+
     NSError *error = nil;
-    BOOL success = [[NSFileManager defaultManager] setAttributes:@{ NSFileModificationDate: date }
-                                                    ofItemAtPath:[fileURL path]
-                                                           error:&error];
-    AWSTMDiskCacheError(error);
+    NSDictionary *values = [fileURL resourceValuesForKeys:@[ NSURLTotalFileAllocatedSizeKey ] error:&error];
+    NSNumber *fileSize = [values objectForKey:NSURLTotalFileAllocatedSizeKey];
 
-    if (success) {
-        NSString *key = [self keyForEncodedFileURL:fileURL];
-        if (key) {
-            [_dates setObject:date forKey:key];
+    if (!fileSize) {
+        [_index executeUpdate:@"DELETE FROM entries WHERE key = ?", key];
+        return 0;
+    }
+
+    [_index executeUpdate:@"UPDATE entries SET byte_count = ? WHERE key = ?", fileSize, key];
+    if ([_index changes] == 0) {
+        [_index executeUpdate:@"INSERT INTO entries (key, byte_count, access_date, type) VALUES (?, ?, ?, NULL)",
+         key, fileSize, [NSDate date]];
+    }
+
+    return [fileSize unsignedIntegerValue];
+}
+
+- (NSUInteger)indexedByteCountForKey:(NSString *)key
+{
+    return (NSUInteger)[_index longForQuery:@"SELECT IFNULL(byte_count, 0) FROM entries WHERE key = ?", key];
+}
+
+- (void)updateAccessDate:(NSDate *)date forKey:(NSString *)key
+{
+    [_index executeUpdate:@"UPDATE entries SET access_date = ? WHERE key = ?", date, key];
+
+    if ([_index changes] == 0) { // a file the index does not know about yet
+        NSUInteger byteSize = [self reconcileIndexEntryForKey:key];
+        self.byteCount = _byteCount + byteSize; // atomic
+        [_index executeUpdate:@"UPDATE entries SET access_date = ? WHERE key = ?", date, key];
+    }
+}
+
+// Returns the keys of the first entries in the given order, up to the point where removing them brings the byte count
+// down to the limit. Only the index is read.
+- (NSArray *)keysToTrimToSize:(NSUInteger)trimByteCount orderedBy:(NSString *)orderingTerm
+{
+    NSMutableArray *keys = [[NSMutableArray alloc] init];
+    NSUInteger byteCount = _byteCount;
+
+    NSString *query = [NSString stringWithFormat:@"SELECT key, byte_count FROM entries WHERE byte_count IS NOT NULL ORDER BY %@", orderingTerm];
+    AWSFMResultSet *resultSet = [_index executeQuery:query];
+    while (byteCount > trimByteCount && [resultSet next]) {
+        [keys addObject:[resultSet stringForColumnIndex:0]];
+        NSUInteger byteSize = (NSUInteger)[resultSet longLongIntForColumnIndex:1];
+        byteCount -= MIN(byteCount, byteSize);
+    }
+    [resultSet close];
+
+    return keys;
+}
+
+- (NSArray *)keysSortedByDateBefore:(NSDate *)date
+{
+    NSMutableArray *keys = [[NSMutableArray alloc] init];
+
+    AWSFMResultSet *resultSet = nil;
+    if (date) {
+        resultSet = [_index executeQuery:@"SELECT key FROM entries WHERE byte_count IS NOT NULL AND access_date < ? ORDER BY access_date", date];
+    } else {
+        resultSet = [_index executeQuery:@"SELECT key FROM entries WHERE byte_count IS NOT NULL ORDER BY access_date"];
+    }
+    while ([resultSet next]) {
+        [keys addObject:[resultSet stringForColumnIndex:0]];
+    }
+    [resultSet close];
+
+    return keys;
+}
+
+- (NSArray *)indexedKeysForObjectsOfClasses:(NSArray<Class> *)classes
+{
+    NSMutableSet *typeNames = [[NSMutableSet alloc] init];
+    AWSFMResultSet *resultSet = [_index executeQuery:@"SELECT DISTINCT type FROM entries WHERE type IS NOT NULL"];
+    while ([resultSet next]) {
+        NSString *typeName = [resultSet stringForColumnIndex:0];
+        Class type = NSClassFromString(typeName);
+        for (Class class in classes) {
+            if ([type isSubclassOfClass:class]) {
+                [typeNames addObject:typeName];
+                break;
+            }
         }
     }
+    [resultSet close];
+
+    NSMutableArray *keys = [[NSMutableArray alloc] init];
+    resultSet = [_index executeQuery:@"SELECT key, type FROM entries WHERE byte_count IS NOT NULL ORDER BY access_date"];
+    while ([resultSet next]) {
+        NSString *typeName = [resultSet stringForColumnIndex:1];
+        if (!typeName || [typeNames containsObject:typeName]) // the type of objects set before the index existed is unknown
+            [keys addObject:[resultSet stringForColumnIndex:0]];
+    }
+    [resultSet close];
 
-    return success;
+    return keys;
 }
 
 - (BOOL)removeFileAndExecuteBlocksForKey:(NSString *)key
 {
     NSURL *fileURL = [self encodedFileURLForKey:key];
-    if (!fileURL || ![[NSFileManager defaultManager] fileExistsAtPath:[fileURL path]])
+    if (!fileURL)
         return NO;
 
+    NSUInteger byteSize = [self indexedByteCountForKey:key];
+
+    if (![[NSFileManager defaultManager] fileExistsAtPath:[fileURL path]]) {
+        [_index executeUpdate:@"DELETE FROM entries WHERE key = ?", key];
+        if ([_index changes] > 0)
+            self.byteCount = _byteCount - MIN(_byteCount, byteSize); // atomic
+        return NO;
+    }
+
     if (_willRemoveObjectBlock)
         _willRemoveObjectBlock(self, key, nil, fileURL);
 
@@ -317,12 +464,8 @@ NSString * const AWSTMDiskCacheSharedName = @"TMDiskCacheShared";
     
     [AWSTMDiskCache emptyTrash];
 
-    NSNumber *byteSize = [_sizes objectForKey:key];
-    if (byteSize)
-        self.byteCount = _byteCount - [byteSize unsignedIntegerValue]; // atomic
-
-    [_sizes removeObjectForKey:key];
-    [_dates removeObjectForKey:key];
+    [_index executeUpdate:@"DELETE FROM entries WHERE key = ?", key];
+    self.byteCount = _byteCount - MIN(_byteCount, byteSize); // atomic
 
     if (_didRemoveObjectBlock)
         _didRemoveObjectBlock(self, key, nil, fileURL);
@@ -335,9 +478,7 @@ NSString * const AWSTMDiskCacheSharedName = @"TMDiskCacheShared";
     if (_byteCount <= trimByteCount)
         return;
 
-    NSArray *keysSortedBySize = [_sizes keysSortedByValueUsingSelector:@selector(compare:)];
-
-    for (NSString *key in [keysSortedBySize reverseObjectEnumerator]) { // largest objects first
+    for (NSString *key in [self keysToTrimToSize:trimByteCount orderedBy:@"byte_count DESC"]) { // largest objects first
         [self removeFileAndExecuteBlocksForKey:key];
 
         if (_byteCount <= trimByteCount)
@@ -350,9 +491,7 @@ NSString * const AWSTMDiskCacheSharedName = @"TMDiskCacheShared";
     if (_byteCount <= trimByteCount)
         return;
 
-    NSArray *keysSortedByDate = [_dates keysSortedByValueUsingSelector:@selector(compare:)];
-
-    for (NSString *key in keysSortedByDate) { // oldest objects first
+    for (NSString *key in [self keysToTrimToSize:trimByteCount orderedBy:@"access_date"]) { // oldest objects first
         [self removeFileAndExecuteBlocksForKey:key];
 
         if (_byteCount <= trimByteCount)
@@ -362,18 +501,8 @@ NSString * const AWSTMDiskCacheSharedName = @"TMDiskCacheShared";
 
 - (void)trimDiskToDate:(NSDate *)trimDate
 {
-    NSArray *keysSortedByDate = [_dates keysSortedByValueUsingSelector:@selector(compare:)];
-    
-    for (NSString *key in keysSortedByDate) { // oldest files first
-        NSDate *accessDate = [_dates objectForKey:key];
-        if (!accessDate)
-            continue;
-        
-        if ([accessDate compare:trimDate] == NSOrderedAscending) { // older than trim date
-            [self removeFileAndExecuteBlocksForKey:key];
-        } else {
-            break;
-        }
+    for (NSString *key in [self keysSortedByDateBefore:trimDate]) { // oldest files first
+        [self removeFileAndExecuteBlocksForKey:key];
     }
 }
 
@@ -423,7 +552,13 @@ NSString * const AWSTMDiskCacheSharedName = @"TMDiskCacheShared";
                 AWSTMDiskCacheError(error);
             }
 
-            [strongSelf setFileModificationDate:now forURL:fileURL];
+            if (object) {
+                [strongSelf updateAccessDate:now forKey:key];
+            } else {
+                NSUInteger byteSize = [strongSelf indexedByteCountForKey:key];
+                NSUInteger reconciledByteSize = [strongSelf reconcileIndexEntryForKey:key];
+                strongSelf.byteCount = strongSelf->_byteCount - MIN(strongSelf->_byteCount, byteSize) + reconciledByteSize; // atomic
+            }
         }
 
         block(strongSelf, key, object, fileURL);
@@ -447,7 +582,7 @@ NSString * const AWSTMDiskCacheSharedName = @"TMDiskCacheShared";
         NSURL *fileURL = [strongSelf encodedFileURLForKey:key];
 
         if ([[NSFileManager defaultManager] fileExistsAtPath:[fileURL path]]) {
-            [strongSelf setFileModificationDate:now forURL:fileURL];
+            [strongSelf updateAccessDate:now forKey:key];
         } else {
             fileURL = nil;
         }
@@ -479,27 +614,21 @@ NSString * const AWSTMDiskCacheSharedName = @"TMDiskCacheShared";
         if (strongSelf->_willAddObjectBlock)
             strongSelf->_willAddObjectBlock(strongSelf, key, object, fileURL);
 
-        BOOL written = [NSKeyedArchiver archiveRootObject:object toFile:[fileURL path]];
+        // The entry is marked as pending (no byte count) until the file is in place, so an interrupted write is
+        // reconciled on the next launch. The file itself is replaced atomically.
+        NSUInteger oldByteSize = [strongSelf indexedByteCountForKey:key];
+        [strongSelf->_index executeUpdate:@"INSERT OR REPLACE INTO entries (key, byte_count, access_date, type) VALUES (?, NULL, ?, ?)",
+         key, now, NSStringFromClass([(NSObject *)object class])];
 
-        if (written) {
-            [strongSelf setFileModificationDate:now forURL:fileURL];
+        NSError *error = nil;
+        NSData *data = [NSKeyedArchiver archivedDataWithRootObject:object];
+        BOOL written = [data writeToURL:fileURL options:NSDataWritingAtomic error:&error];
+        AWSTMDiskCacheError(error);
 
-            NSError *error = nil;
-            NSDictionary *values = [fileURL resourceValuesForKeys:@[ NSURLTotalFileAllocatedSizeKey ] error:&error];
-            AWSTMDiskCacheError(error);
+        NSUInteger byteSize = [strongSelf reconcileIndexEntryForKey:key];
+        strongSelf.byteCount = strongSelf->_byteCount - MIN(strongSelf->_byteCount, oldByteSize) + byteSize; // atomic
 
-            NSNumber *diskFileSize = [values objectForKey:NSURLTotalFileAllocatedSizeKey];
-            if (diskFileSize) {
-                NSNumber *oldEntry = [strongSelf->_sizes objectForKey:key];
-                
-                if ([oldEntry isKindOfClass:[NSNumber class]]){
-                    strongSelf.byteCount = strongSelf->_byteCount - [oldEntry unsignedIntegerValue];
-                }
-                
-                [strongSelf->_sizes setObject:diskFileSize forKey:key];
-                strongSelf.byteCount = strongSelf->_byteCount + [diskFileSize unsignedIntegerValue]; // atomic
-            }
-            
+        if (written) {
             if (strongSelf->_byteLimit > 0 && strongSelf->_byteCount > strongSelf->_byteLimit)
                 [strongSelf trimToSizeByDate:strongSelf->_byteLimit block:nil];
         } else {
@@ -641,15 +770,14 @@ NSString * const AWSTMDiskCacheSharedName = @"TMDiskCacheShared";
 
         if (strongSelf->_willRemoveAllObjectsBlock)
             strongSelf->_willRemoveAllObjectsBlock(strongSelf);
-        
+
+        [strongSelf->_index close]; // the index lives in the cache directory and goes to the trash with it
+
         [AWSTMDiskCache moveItemAtURLToTrash:strongSelf->_cacheURL];
         [AWSTMDiskCache emptyTrash];
 
         [strongSelf createCacheDirectory];
-
-        [strongSelf->_dates removeAllObjects];
-        [strongSelf->_sizes removeAllObjects];
-        strongSelf.byteCount = 0; // atomic
+        [strongSelf initializeDiskProperties];
 
         if (strongSelf->_didRemoveAllObjectsBlock)
             strongSelf->_didRemoveAllObjectsBlock(strongSelf);
@@ -677,7 +805,7 @@ NSString * const AWSTMDiskCacheSharedName = @"TMDiskCacheShared";
             return;
         }
 
-        NSArray *keysSortedByDate = [strongSelf->_dates keysSortedByValueUsingSelector:@selector(compare:)];
+        NSArray *keysSortedByDate = [strongSelf keysSortedByDateBefore:nil];
 
         for (NSString *key in keysSortedByDate) {
             NSURL *fileURL = [strongSelf encodedFileURLForKey:key];
@@ -691,6 +819,22 @@ NSString * const AWSTMDiskCacheSharedName = @"TMDiskCacheShared";
     });
 }
 
+- (void)keysForObjectsOfClasses:(NSArray<Class> *)classes block:(AWSTMDiskCacheKeysBlock)block
+{
+    if (!block)
+        return;
+
+    __weak AWSTMDiskCache *weakSelf = self;
+
+    dispatch_async(_queue, ^{
+        AWSTMDiskCache *strongSelf = weakSelf;
+        if (!strongSelf)
+            return;
+
+        block(strongSelf, [strongSelf indexedKeysForObjectsOfClasses:classes]);
+    });
+}
+
 #pragma mark - Public Synchronous Methods -
 
 - (id <NSCoding>)objectForKey:(NSString *)key
@@ -861,6 +1005,26 @@ NSString * const AWSTMDiskCacheSharedName = @"TMDiskCacheShared";
     #endif
 }
 
+- (NSArray<NSString *> *)keysForObjectsOfClasses:(NSArray<Class> *)classes
+{
+    __block NSArray *keysForObjects = nil;
+
+    dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+
+    [self keysForObjectsOfClasses:classes block:^(AWSTMDiskCache *cache, NSArray<NSString *> *keys) {
+        keysForObjects = keys;
+        dispatch_semaphore_signal(semaphore);
+    }];
+
+    dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER);
+
+    #if !OS_OBJECT_USE_OBJC
+    dispatch_release(semaphore);
+    #endif
+
+    return keysForObjects;
+}
+
 #pragma mark - Public Thread Safe Accessors -
 
 - (AWSTMDiskCacheObjectBlock)willAddObjectBlock
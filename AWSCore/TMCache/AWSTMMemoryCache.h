@@ -3,10 +3,14 @@
  automatically to reduce memory usage when the app receives a memory warning or goes into the background.
 
  Access is natively asynchronous. Every method accepts a callback block that runs on a concurrent
- <queue>, with cache writes protected by GCD barriers. Synchronous variations are provided.
+ <queue>. Keys are spread over a power-of-two number of shards, each protected by its own lock, so reads
+ and writes of different keys rarely wait on each other. Only <removeAllObjects:>, enumeration and changes
+ to the cache's settings use GCD barriers. Synchronous variations are provided.
  
- All access to the cache is dated so the that the least-used objects can be trimmed first. Setting an
- optional <ageLimit> will trigger a GCD timer to periodically to trim the cache to that age.
+ All access to the cache is dated so the that the least-used objects can be trimmed first. Each shard keeps
+ its objects in a least recently used list and in a heap ordered by cost, so trimming takes objects from the
+ ends of the lists or the tops of the heaps without sorting. Setting an optional <ageLimit> will trigger a
+ GCD timer to periodically to trim the cache to that age.
  
  Objects can optionally be set with a "cost", which could be a byte count or any other meaningful integer.
  Setting a <costLimit> will automatically keep the cache below that value with <trimToCostByDate:>.
@@ -66,14 +70,14 @@ typedef void (^AWSTMMemoryCacheObjectBlock)(AWSTMMemoryCache *cache, NSString *k
 /// @name Event Blocks
 
 /**
- A block to be executed just before an object is added to the cache. This block will be excuted within
- a barrier, i.e. all reads and writes are suspended for the duration of the block.
+ A block to be executed just before an object is added to the cache. This block will be excuted
+ concurrently and outside the lock of the object's shard, so it may read from and write to the cache.
  */
 @property (copy) AWSTMMemoryCacheObjectBlock willAddObjectBlock;
 
 /**
  A block to be executed just before an object is removed from the cache. This block will be excuted
- within a barrier, i.e. all reads and writes are suspended for the duration of the block.
+ concurrently and outside the lock of the object's shard, so it may read from and write to the cache.
  */
 @property (copy) AWSTMMemoryCacheObjectBlock willRemoveObjectBlock;
 
@@ -84,14 +88,14 @@ typedef void (^AWSTMMemoryCacheObjectBlock)(AWSTMMemoryCache *cache, NSString *k
 @property (copy) AWSTMMemoryCacheBlock willRemoveAllObjectsBlock;
 
 /**
- A block to be executed just after an object is added to the cache. This block will be excuted within
- a barrier, i.e. all reads and writes are suspended for the duration of the block.
+ A block to be executed just after an object is added to the cache. This block will be excuted
+ concurrently and outside the lock of the object's shard, so it may read from and write to the cache.
  */
 @property (copy) AWSTMMemoryCacheObjectBlock didAddObjectBlock;
 
 /**
  A block to be executed just after an object is removed from the cache. This block will be excuted
- within a barrier, i.e. all reads and writes are suspended for the duration of the block.
+ concurrently and outside the lock of the object's shard, so it may read from and write to the cache.
  */
 @property (copy) AWSTMMemoryCacheObjectBlock didRemoveObjectBlock;
 
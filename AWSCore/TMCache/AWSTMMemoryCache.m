@@ -1,27 +1,209 @@
 #import "AWSTMMemoryCache.h"
 
+#import <pthread.h>
+#import <stdatomic.h>
+
 #if __IPHONE_OS_VERSION_MIN_REQUIRED >= __IPHONE_4_0
 #import <UIKit/UIKit.h>
 #endif
 
 NSString * const AWSTMMemoryCachePrefix = @"com.tumblr.TMMemoryCache";
 
-@interface AWSTMMemoryCache ()
+static NSUInteger const AWSTMMemoryCacheMinimumShardCount = 4;
+static NSUInteger const AWSTMMemoryCacheMaximumShardCount = 64;
+
+/**
+ A cache entry. The node is both the value stored in its shard's dictionary, a link in the shard's LRU
+ list and an element of the shard's cost heap, so refreshing or evicting it never has to search either.
+ */
+@interface AWSTMMemoryCacheNode : NSObject {
+@package
+    NSString *_key;
+    id _object;
+    NSUInteger _cost;
+    CFAbsoluteTime _accessTime;
+    __unsafe_unretained AWSTMMemoryCacheNode *_previous; // more recently used
+    __unsafe_unretained AWSTMMemoryCacheNode *_next; // less recently used
+    NSUInteger _heapIndex;
+}
+@end
+
+@implementation AWSTMMemoryCacheNode
+@end
+
+/**
+ A slice of the key space guarded by its own lock. Nodes are kept from most (`_head`) to least (`_tail`)
+ recently used, so the oldest object of the shard is always at the tail, and in a binary max-heap by cost,
+ so the costliest object of the shard is always `_heap[0]`. The dictionary owns the nodes.
+ */
+@interface AWSTMMemoryCacheShard : NSObject {
+@package
+    pthread_mutex_t _lock;
+    NSMutableDictionary *_nodes;
+    __unsafe_unretained AWSTMMemoryCacheNode *_head;
+    __unsafe_unretained AWSTMMemoryCacheNode *_tail;
+    AWSTMMemoryCacheNode * __unsafe_unretained *_heap;
+    NSUInteger _heapCount;
+    NSUInteger _heapCapacity;
+}
+@end
+
+@implementation AWSTMMemoryCacheShard
+
+- (instancetype)init
+{
+    if (self = [super init]) {
+        pthread_mutex_init(&_lock, NULL);
+        _nodes = [[NSMutableDictionary alloc] init];
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    free(_heap);
+    pthread_mutex_destroy(&_lock);
+}
+
+- (void)insertNodeAtHead:(AWSTMMemoryCacheNode *)node
+{
+    node->_previous = nil;
+    node->_next = _head;
+
+    if (_head)
+        _head->_previous = node;
+
+    _head = node;
+
+    if (!_tail)
+        _tail = node;
+}
+
+- (void)unlinkNode:(AWSTMMemoryCacheNode *)node
+{
+    if (node->_previous)
+        node->_previous->_next = node->_next;
+    else
+        _head = node->_next;
+
+    if (node->_next)
+        node->_next->_previous = node->_previous;
+    else
+        _tail = node->_previous;
+
+    node->_previous = nil;
+    node->_next = nil;
+}
+
+- (void)moveNodeToHead:(AWSTMMemoryCacheNode *)node
+{
+    if (_head == node)
+        return;
+
+    [self unlinkNode:node];
+    [self insertNodeAtHead:node];
+}
+
+- (void)placeNode:(AWSTMMemoryCacheNode *)node inHeapAtIndex:(NSUInteger)index
+{
+    _heap[index] = node;
+    node->_heapIndex = index;
+}
+
+- (void)siftUpHeapFromIndex:(NSUInteger)index
+{
+    AWSTMMemoryCacheNode *node = _heap[index];
+
+    while (index > 0) {
+        NSUInteger parent = (index - 1) / 2;
+        if (_heap[parent]->_cost >= node->_cost)
+            break;
+
+        [self placeNode:_heap[parent] inHeapAtIndex:index];
+        index = parent;
+    }
+
+    [self placeNode:node inHeapAtIndex:index];
+}
+
+- (void)siftDownHeapFromIndex:(NSUInteger)index
+{
+    AWSTMMemoryCacheNode *node = _heap[index];
+
+    while (YES) {
+        NSUInteger child = 2 * index + 1;
+        if (child >= _heapCount)
+            break;
+
+        if (child + 1 < _heapCount && _heap[child + 1]->_cost > _heap[child]->_cost)
+            child++;
+
+        if (_heap[child]->_cost <= node->_cost)
+            break;
+
+        [self placeNode:_heap[child] inHeapAtIndex:index];
+        index = child;
+    }
+
+    [self placeNode:node inHeapAtIndex:index];
+}
+
+- (void)insertNodeIntoHeap:(AWSTMMemoryCacheNode *)node
+{
+    if (_heapCount == _heapCapacity) {
+        _heapCapacity = _heapCapacity ? 2 * _heapCapacity : 16;
+        _heap = (AWSTMMemoryCacheNode * __unsafe_unretained *)realloc(_heap, _heapCapacity * sizeof(*_heap));
+    }
+
+    [self placeNode:node inHeapAtIndex:_heapCount++];
+    [self siftUpHeapFromIndex:node->_heapIndex];
+}
+
+- (void)removeNodeFromHeap:(AWSTMMemoryCacheNode *)node
+{
+    NSUInteger index = node->_heapIndex;
+    AWSTMMemoryCacheNode *last = _heap[--_heapCount];
+    if (last == node)
+        return;
+
+    [self placeNode:last inHeapAtIndex:index];
+    [self siftUpHeapFromIndex:index];
+    [self siftDownHeapFromIndex:last->_heapIndex];
+}
+
+// Restores the heap order after the node's cost has changed.
+- (void)updateNodeInHeap:(AWSTMMemoryCacheNode *)node
+{
+    [self siftUpHeapFromIndex:node->_heapIndex];
+    [self siftDownHeapFromIndex:node->_heapIndex];
+}
+
+- (void)removeAllNodes
+{
+    _head = nil;
+    _tail = nil;
+    _heapCount = 0;
+    [_nodes removeAllObjects];
+}
+
+@end
+
+@interface AWSTMMemoryCache () {
+    NSArray *_shards;
+    NSUInteger _shardMask;
+    _Atomic(NSUInteger) _totalCost;
+}
 #if OS_OBJECT_USE_OBJC
 @property (strong, nonatomic) dispatch_queue_t queue;
 #else
 @property (assign, nonatomic) dispatch_queue_t queue;
 #endif
-@property (strong, nonatomic) NSMutableDictionary *dictionary;
-@property (strong, nonatomic) NSMutableDictionary *dates;
-@property (strong, nonatomic) NSMutableDictionary *costs;
 @end
 
 @implementation AWSTMMemoryCache
 
 @synthesize ageLimit = _ageLimit;
 @synthesize costLimit = _costLimit;
-@synthesize totalCost = _totalCost;
 @synthesize willAddObjectBlock = _willAddObjectBlock;
 @synthesize willRemoveObjectBlock = _willRemoveObjectBlock;
 @synthesize willRemoveAllObjectsBlock = _willRemoveAllObjectsBlock;
@@ -49,9 +231,17 @@ NSString * const AWSTMMemoryCachePrefix = @"com.tumblr.TMMemoryCache";
         NSString *queueName = [[NSString alloc] initWithFormat:@"%@.%p", AWSTMMemoryCachePrefix, self];
         _queue = dispatch_queue_create([queueName UTF8String], DISPATCH_QUEUE_CONCURRENT);
 
-        _dictionary = [[NSMutableDictionary alloc] init];
-        _dates = [[NSMutableDictionary alloc] init];
-        _costs = [[NSMutableDictionary alloc] init];
+        // A power of two, so a key's shard is a mask of its hash, with about two shards per core.
+        NSUInteger shardCount = AWSTMMemoryCacheMinimumShardCount;
+        while (shardCount < 2 * [[NSProcessInfo processInfo] activeProcessorCount] && shardCount < AWSTMMemoryCacheMaximumShardCount)
+            shardCount <<= 1;
+
+        NSMutableArray *shards = [[NSMutableArray alloc] initWithCapacity:shardCount];
+        for (NSUInteger i = 0; i < shardCount; i++)
+            [shards addObject:[[AWSTMMemoryCacheShard alloc] init]];
+
+        _shards = [shards copy];
+        _shardMask = shardCount - 1;
 
         _willAddObjectBlock = nil;
         _willRemoveObjectBlock = nil;
@@ -66,7 +256,7 @@ NSString * const AWSTMMemoryCachePrefix = @"com.tumblr.TMMemoryCache";
 
         _ageLimit = 0.0;
         _costLimit = 0;
-        _totalCost = 0;
+        atomic_init(&_totalCost, 0);
 
         _removeAllObjectsOnMemoryWarning = YES;
         _removeAllObjectsOnEnteringBackground = YES;
@@ -142,70 +332,272 @@ NSString * const AWSTMMemoryCachePrefix = @"com.tumblr.TMMemoryCache";
 #endif
 }
 
+// The private methods below run on the queue, either concurrently with each other or inside a barrier.
+// Each shard's lock guards its nodes; the event blocks and limits are only written inside barriers.
+
+- (AWSTMMemoryCacheShard *)shardForKey:(NSString *)key
+{
+    NSUInteger hash = [key hash];
+    hash ^= hash >> 16; // fold the high bits in before masking
+
+    return [_shards objectAtIndex:hash & _shardMask];
+}
+
+- (id)objectAndUpdateAccessTimeForKey:(NSString *)key
+{
+    AWSTMMemoryCacheShard *shard = [self shardForKey:key];
+    id object = nil;
+
+    pthread_mutex_lock(&shard->_lock);
+
+    AWSTMMemoryCacheNode *node = [shard->_nodes objectForKey:key];
+    if (node) {
+        node->_accessTime = CFAbsoluteTimeGetCurrent();
+        [shard moveNodeToHead:node];
+        object = node->_object;
+    }
+
+    pthread_mutex_unlock(&shard->_lock);
+
+    return object;
+}
+
+- (void)setObjectAndExecuteBlocks:(id)object forKey:(NSString *)key withCost:(NSUInteger)cost
+{
+    AWSTMMemoryCacheShard *shard = [self shardForKey:key];
+
+    if (_willAddObjectBlock)
+        _willAddObjectBlock(self, key, object);
+
+    pthread_mutex_lock(&shard->_lock);
+
+    AWSTMMemoryCacheNode *node = [shard->_nodes objectForKey:key];
+    if (node) {
+        atomic_fetch_sub(&_totalCost, node->_cost);
+        node->_object = object;
+        node->_cost = cost;
+        [shard updateNodeInHeap:node];
+        [shard moveNodeToHead:node];
+    } else {
+        node = [[AWSTMMemoryCacheNode alloc] init];
+        node->_key = [key copy];
+        node->_object = object;
+        node->_cost = cost;
+        [shard->_nodes setObject:node forKey:node->_key];
+        [shard insertNodeAtHead:node];
+        [shard insertNodeIntoHeap:node];
+    }
+
+    node->_accessTime = CFAbsoluteTimeGetCurrent();
+
+    atomic_fetch_add(&_totalCost, cost);
+
+    pthread_mutex_unlock(&shard->_lock);
+
+    if (_didAddObjectBlock)
+        _didAddObjectBlock(self, key, object);
+
+    if (_costLimit > 0)
+        [self trimToCostLimitByDate:_costLimit];
+}
+
+// Expects the shard's lock to be held. The event blocks are left to the caller, to run once the lock is released.
+- (void)detachNode:(AWSTMMemoryCacheNode *)node fromShard:(AWSTMMemoryCacheShard *)shard
+{
+    NSString *key = node->_key;
+
+    atomic_fetch_sub(&_totalCost, node->_cost);
+    [shard unlinkNode:node];
+    [shard removeNodeFromHeap:node];
+    [shard->_nodes removeObjectForKey:key];
+}
+
+// The event blocks below run without the shard's lock, so they may read from and write to the cache.
+
 - (void)removeObjectAndExecuteBlocksForKey:(NSString *)key
 {
-    id object = [_dictionary objectForKey:key];
-    NSNumber *cost = [_costs objectForKey:key];
+    AWSTMMemoryCacheShard *shard = [self shardForKey:key];
+    AWSTMMemoryCacheNode *node = nil;
+
+    if (_willRemoveObjectBlock) {
+        pthread_mutex_lock(&shard->_lock);
+        node = [shard->_nodes objectForKey:key];
+        id object = node ? node->_object : nil;
+        pthread_mutex_unlock(&shard->_lock);
 
-    if (_willRemoveObjectBlock)
         _willRemoveObjectBlock(self, key, object);
+    }
 
-    if (cost)
-        _totalCost -= [cost unsignedIntegerValue];
+    pthread_mutex_lock(&shard->_lock);
 
-    [_dictionary removeObjectForKey:key];
-    [_dates removeObjectForKey:key];
-    [_costs removeObjectForKey:key];
+    node = [shard->_nodes objectForKey:key];
+    if (node)
+        [self detachNode:node fromShard:shard];
+
+    pthread_mutex_unlock(&shard->_lock);
 
     if (_didRemoveObjectBlock)
         _didRemoveObjectBlock(self, key, nil);
 }
 
+// Removes a node picked by a trim, unless it has been removed or replaced since it was picked.
+- (void)evictNode:(AWSTMMemoryCacheNode *)node fromShard:(AWSTMMemoryCacheShard *)shard
+{
+    NSString *key = node->_key;
+
+    if (_willRemoveObjectBlock) {
+        pthread_mutex_lock(&shard->_lock);
+        id object = [shard->_nodes objectForKey:key] == node ? node->_object : nil;
+        pthread_mutex_unlock(&shard->_lock);
+
+        if (!object)
+            return;
+
+        _willRemoveObjectBlock(self, key, object);
+    }
+
+    pthread_mutex_lock(&shard->_lock);
+
+    BOOL removed = [shard->_nodes objectForKey:key] == node;
+    if (removed)
+        [self detachNode:node fromShard:shard];
+
+    pthread_mutex_unlock(&shard->_lock);
+
+    if (removed && _didRemoveObjectBlock)
+        _didRemoveObjectBlock(self, key, nil);
+}
+
 - (void)trimMemoryToDate:(NSDate *)trimDate
 {
-    NSArray *keysSortedByDate = [_dates keysSortedByValueUsingSelector:@selector(compare:)];
-    
-    for (NSString *key in keysSortedByDate) { // oldest objects first
-        NSDate *accessDate = [_dates objectForKey:key];
-        if (!accessDate)
-            continue;
-        
-        if ([accessDate compare:trimDate] == NSOrderedAscending) { // older than trim date
-            [self removeObjectAndExecuteBlocksForKey:key];
-        } else {
-            break;
+    CFAbsoluteTime trimTime = [trimDate timeIntervalSinceReferenceDate];
+
+    for (AWSTMMemoryCacheShard *shard in _shards) {
+        while (YES) {
+            pthread_mutex_lock(&shard->_lock);
+            AWSTMMemoryCacheNode *node = shard->_tail; // oldest objects first
+            if (node && node->_accessTime >= trimTime)
+                node = nil;
+            pthread_mutex_unlock(&shard->_lock);
+
+            if (!node)
+                break;
+
+            [self evictNode:node fromShard:shard];
         }
     }
 }
 
+// The two cost trims below look at the end of every shard's list or heap for each object they evict, so an
+// eviction costs O(shards) (plus O(log n) to re-order the heap), however many objects the cache holds. A single
+// order across all shards would make it O(1), but every hit would then take that order's lock again.
+
 - (void)trimToCostLimit:(NSUInteger)limit
 {
-    if (_totalCost <= limit)
-        return;
+    while (atomic_load(&_totalCost) > limit) {
+        // The costliest object is at the top of one of the shards' heaps.
+        AWSTMMemoryCacheShard *costliestShard = nil;
+        AWSTMMemoryCacheNode *costliestNode = nil;
+        NSUInteger highestCost = 0;
+
+        for (AWSTMMemoryCacheShard *shard in _shards) {
+            pthread_mutex_lock(&shard->_lock);
+            AWSTMMemoryCacheNode *top = shard->_heapCount ? shard->_heap[0] : nil;
+            if (top && (!costliestNode || top->_cost > highestCost)) {
+                costliestShard = shard;
+                costliestNode = top;
+                highestCost = top->_cost;
+            }
+            pthread_mutex_unlock(&shard->_lock);
+        }
 
-    NSArray *keysSortedByCost = [_costs keysSortedByValueUsingSelector:@selector(compare:)];
+        if (!costliestNode)
+            break;
 
-    for (NSString *key in [keysSortedByCost reverseObjectEnumerator]) { // costliest objects first
-        [self removeObjectAndExecuteBlocksForKey:key];
+        [self evictNode:costliestNode fromShard:costliestShard];
+    }
+}
+
+- (void)trimToCostLimitByDate:(NSUInteger)limit
+{
+    while (atomic_load(&_totalCost) > limit) {
+        // The least recently used object is at the tail of one of the shards.
+        AWSTMMemoryCacheShard *oldestShard = nil;
+        AWSTMMemoryCacheNode *oldestNode = nil;
+        CFAbsoluteTime oldestAccessTime = 0.0;
+
+        for (AWSTMMemoryCacheShard *shard in _shards) {
+            pthread_mutex_lock(&shard->_lock);
+            AWSTMMemoryCacheNode *tail = shard->_tail;
+            if (tail && (!oldestNode || tail->_accessTime < oldestAccessTime)) {
+                oldestShard = shard;
+                oldestNode = tail;
+                oldestAccessTime = tail->_accessTime;
+            }
+            pthread_mutex_unlock(&shard->_lock);
+        }
 
-        if (_totalCost <= limit)
+        if (!oldestNode)
             break;
+
+        [self evictNode:oldestNode fromShard:oldestShard];
     }
 }
 
-- (void)trimToCostLimitByDate:(NSUInteger)limit
+- (void)removeAllObjectsAndExecuteBlocks
 {
-    if (_totalCost <= limit)
-        return;
+    if (_willRemoveAllObjectsBlock)
+        _willRemoveAllObjectsBlock(self);
 
-    NSArray *keysSortedByDate = [_dates keysSortedByValueUsingSelector:@selector(compare:)];
+    for (AWSTMMemoryCacheShard *shard in _shards) {
+        pthread_mutex_lock(&shard->_lock);
+        [shard removeAllNodes];
+        pthread_mutex_unlock(&shard->_lock);
+    }
 
-    for (NSString *key in keysSortedByDate) { // oldest objects first
-        [self removeObjectAndExecuteBlocksForKey:key];
+    atomic_store(&_totalCost, 0);
+
+    if (_didRemoveAllObjectsBlock)
+        _didRemoveAllObjectsBlock(self);
+}
+
+- (void)enumerateObjectsByDateWithBlock:(AWSTMMemoryCacheObjectBlock)block
+{
+    // Each shard's list is already in date order, so the lists are merged instead of sorted.
+    NSUInteger shardCount = [_shards count];
+    NSMutableArray *lists = [[NSMutableArray alloc] initWithCapacity:shardCount];
+    for (AWSTMMemoryCacheShard *shard in _shards) {
+        NSMutableArray *nodes = [[NSMutableArray alloc] initWithCapacity:[shard->_nodes count]];
+        pthread_mutex_lock(&shard->_lock);
+        for (AWSTMMemoryCacheNode *node = shard->_tail; node; node = node->_previous) // oldest objects first
+            [nodes addObject:node];
+        pthread_mutex_unlock(&shard->_lock);
+        [lists addObject:nodes];
+    }
+
+    NSUInteger *positions = calloc(shardCount, sizeof(NSUInteger));
+    while (YES) {
+        AWSTMMemoryCacheNode *oldestNode = nil;
+        NSUInteger oldestList = 0;
+        for (NSUInteger i = 0; i < shardCount; i++) {
+            NSArray *nodes = [lists objectAtIndex:i];
+            if (positions[i] == [nodes count])
+                continue;
+
+            AWSTMMemoryCacheNode *node = [nodes objectAtIndex:positions[i]];
+            if (!oldestNode || node->_accessTime < oldestNode->_accessTime) {
+                oldestNode = node;
+                oldestList = i;
+            }
+        }
 
-        if (_totalCost <= limit)
+        if (!oldestNode)
             break;
+
+        positions[oldestList]++;
+        block(self, oldestNode->_key, oldestNode->_object);
     }
+    free(positions);
 }
 
 - (void)trimToAgeLimitRecursively
@@ -221,15 +613,7 @@ NSString * const AWSTMMemoryCachePrefix = @"com.tumblr.TMMemoryCache";
     dispatch_time_t time = dispatch_time(DISPATCH_TIME_NOW, (int64_t)(_ageLimit * NSEC_PER_SEC));
     dispatch_after(time, _queue, ^(void){
         AWSTMMemoryCache *strongSelf = weakSelf;
-        if (!strongSelf)
-            return;
-        
-        __weak AWSTMMemoryCache *weakSelf = strongSelf;
-        
-        dispatch_barrier_async(strongSelf->_queue, ^{
-            AWSTMMemoryCache *strongSelf = weakSelf;
-            [strongSelf trimToAgeLimitRecursively];
-        });
+        [strongSelf trimToAgeLimitRecursively];
     });
 }
 
@@ -237,8 +621,6 @@ NSString * const AWSTMMemoryCachePrefix = @"com.tumblr.TMMemoryCache";
 
 - (void)objectForKey:(NSString *)key block:(AWSTMMemoryCacheObjectBlock)block
 {
-    NSDate *now = [[NSDate alloc] init];
-    
     if (!key || !block)
         return;
 
@@ -249,16 +631,7 @@ NSString * const AWSTMMemoryCachePrefix = @"com.tumblr.TMMemoryCache";
         if (!strongSelf)
             return;
 
-        id object = [strongSelf->_dictionary objectForKey:key];
-
-        if (object) {
-            __weak AWSTMMemoryCache *weakSelf = strongSelf;
-            dispatch_barrier_async(strongSelf->_queue, ^{
-                AWSTMMemoryCache *strongSelf = weakSelf;
-                if (strongSelf)
-                    [strongSelf->_dates setObject:now forKey:key];
-            });
-        }
+        id object = [strongSelf objectAndUpdateAccessTimeForKey:key];
 
         block(strongSelf, key, object);
     });
@@ -271,41 +644,20 @@ NSString * const AWSTMMemoryCachePrefix = @"com.tumblr.TMMemoryCache";
 
 - (void)setObject:(id)object forKey:(NSString *)key withCost:(NSUInteger)cost block:(AWSTMMemoryCacheObjectBlock)block
 {
-    NSDate *now = [[NSDate alloc] init];
-
     if (!key || !object)
         return;
 
     __weak AWSTMMemoryCache *weakSelf = self;
 
-    dispatch_barrier_async(_queue, ^{
+    dispatch_async(_queue, ^{
         AWSTMMemoryCache *strongSelf = weakSelf;
         if (!strongSelf)
             return;
 
-        if (strongSelf->_willAddObjectBlock)
-            strongSelf->_willAddObjectBlock(strongSelf, key, object);
-
-        [strongSelf->_dictionary setObject:object forKey:key];
-        [strongSelf->_dates setObject:now forKey:key];
-        [strongSelf->_costs setObject:@(cost) forKey:key];
-
-        _totalCost += cost;
+        [strongSelf setObjectAndExecuteBlocks:object forKey:key withCost:cost];
 
-        if (strongSelf->_didAddObjectBlock)
-            strongSelf->_didAddObjectBlock(strongSelf, key, object);
-
-        if (strongSelf->_costLimit > 0)
-            [strongSelf trimToCostByDate:strongSelf->_costLimit block:nil];
-
-        if (block) {
-            __weak AWSTMMemoryCache *weakSelf = strongSelf;
-            dispatch_async(strongSelf->_queue, ^{
-                AWSTMMemoryCache *strongSelf = weakSelf;
-                if (strongSelf)
-                    block(strongSelf, key, object);
-            });
-        }
+        if (block)
+            block(strongSelf, key, object);
     });
 }
 
@@ -316,21 +668,15 @@ NSString * const AWSTMMemoryCachePrefix = @"com.tumblr.TMMemoryCache";
 
     __weak AWSTMMemoryCache *weakSelf = self;
 
-    dispatch_barrier_async(_queue, ^{
+    dispatch_async(_queue, ^{
         AWSTMMemoryCache *strongSelf = weakSelf;
         if (!strongSelf)
             return;
 
         [strongSelf removeObjectAndExecuteBlocksForKey:key];
 
-        if (block) {
-            __weak AWSTMMemoryCache *weakSelf = strongSelf;
-            dispatch_async(strongSelf->_queue, ^{
-                AWSTMMemoryCache *strongSelf = weakSelf;
-                if (strongSelf)
-                    block(strongSelf, key, nil);
-            });
-        }
+        if (block)
+            block(strongSelf, key, nil);
     });
 }
 
@@ -346,21 +692,15 @@ NSString * const AWSTMMemoryCachePrefix = @"com.tumblr.TMMemoryCache";
 
     __weak AWSTMMemoryCache *weakSelf = self;
 
-    dispatch_barrier_async(_queue, ^{
+    dispatch_async(_queue, ^{
         AWSTMMemoryCache *strongSelf = weakSelf;
         if (!strongSelf)
             return;
 
         [strongSelf trimMemoryToDate:trimDate];
 
-        if (block) {
-            __weak AWSTMMemoryCache *weakSelf = strongSelf;
-            dispatch_async(strongSelf->_queue, ^{
-                AWSTMMemoryCache *strongSelf = weakSelf;
-                if (strongSelf)
-                    block(strongSelf);
-            });
-        }
+        if (block)
+            block(strongSelf);
     });
 }
 
@@ -368,21 +708,15 @@ NSString * const AWSTMMemoryCachePrefix = @"com.tumblr.TMMemoryCache";
 {
     __weak AWSTMMemoryCache *weakSelf = self;
 
-    dispatch_barrier_async(_queue, ^{
+    dispatch_async(_queue, ^{
         AWSTMMemoryCache *strongSelf = weakSelf;
         if (!strongSelf)
             return;
 
         [strongSelf trimToCostLimit:cost];
 
-        if (block) {
-            __weak AWSTMMemoryCache *weakSelf = strongSelf;
-            dispatch_async(strongSelf->_queue, ^{
-                AWSTMMemoryCache *strongSelf = weakSelf;
-                if (strongSelf)
-                    block(strongSelf);
-            });
-        }
+        if (block)
+            block(strongSelf);
     });
 }
 
@@ -390,21 +724,15 @@ NSString * const AWSTMMemoryCachePrefix = @"com.tumblr.TMMemoryCache";
 {
     __weak AWSTMMemoryCache *weakSelf = self;
 
-    dispatch_barrier_async(_queue, ^{
+    dispatch_async(_queue, ^{
         AWSTMMemoryCache *strongSelf = weakSelf;
         if (!strongSelf)
             return;
 
         [strongSelf trimToCostLimitByDate:cost];
 
-        if (block) {
-            __weak AWSTMMemoryCache *weakSelf = strongSelf;
-            dispatch_async(strongSelf->_queue, ^{
-                AWSTMMemoryCache *strongSelf = weakSelf;
-                if (strongSelf)
-                    block(strongSelf);
-            });
-        }
+        if (block)
+            block(strongSelf);
     });
 }
 
@@ -417,17 +745,7 @@ NSString * const AWSTMMemoryCachePrefix = @"com.tumblr.TMMemoryCache";
         if (!strongSelf)
             return;
 
-        if (strongSelf->_willRemoveAllObjectsBlock)
-            strongSelf->_willRemoveAllObjectsBlock(strongSelf);
-
-        [strongSelf->_dictionary removeAllObjects];
-        [strongSelf->_dates removeAllObjects];
-        [strongSelf->_costs removeAllObjects];
-        
-        strongSelf->_totalCost = 0;
-
-        if (strongSelf->_didRemoveAllObjectsBlock)
-            strongSelf->_didRemoveAllObjectsBlock(strongSelf);
+        [strongSelf removeAllObjectsAndExecuteBlocks];
 
         if (block) {
             __weak AWSTMMemoryCache *weakSelf = strongSelf;
@@ -452,11 +770,7 @@ NSString * const AWSTMMemoryCachePrefix = @"com.tumblr.TMMemoryCache";
         if (!strongSelf)
             return;
 
-        NSArray *keysSortedByDate = [strongSelf->_dates keysSortedByValueUsingSelector:@selector(compare:)];
-        
-        for (NSString *key in keysSortedByDate) {
-            block(strongSelf, key, [strongSelf->_dictionary objectForKey:key]);
-        }
+        [strongSelf enumerateObjectsByDateWithBlock:block];
 
         if (completionBlock) {
             __weak AWSTMMemoryCache *weakSelf = strongSelf;
@@ -471,6 +785,9 @@ NSString * const AWSTMMemoryCachePrefix = @"com.tumblr.TMMemoryCache";
 
 #pragma mark - Public Synchronous Methods -
 
+// dispatch_sync on the concurrent queue runs the work on the calling thread, so a synchronous hit costs
+// one shard lock instead of a thread hop and a semaphore.
+
 - (id)objectForKey:(NSString *)key
 {
     if (!key)
@@ -478,18 +795,9 @@ NSString * const AWSTMMemoryCachePrefix = @"com.tumblr.TMMemoryCache";
 
     __block id objectForKey = nil;
 
-    dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
-
-    [self objectForKey:key block:^(AWSTMMemoryCache *cache, NSString *key, id object) {
-        objectForKey = object;
-        dispatch_semaphore_signal(semaphore);
-    }];
-
-    dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER);
-
-    #if !OS_OBJECT_USE_OBJC
-    dispatch_release(semaphore);
-    #endif
+    dispatch_sync(_queue, ^{
+        objectForKey = [self objectAndUpdateAccessTimeForKey:key];
+    });
 
     return objectForKey;
 }
@@ -504,35 +812,19 @@ NSString * const AWSTMMemoryCachePrefix = @"com.tumblr.TMMemoryCache";
     if (!object || !key)
         return;
 
-    dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
-
-    [self setObject:object forKey:key withCost:cost block:^(AWSTMMemoryCache *cache, NSString *key, id object) {
-        dispatch_semaphore_signal(semaphore);
-    }];
-
-    dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER);
-
-    #if !OS_OBJECT_USE_OBJC
-    dispatch_release(semaphore);
-    #endif
+    dispatch_sync(_queue, ^{
+        [self setObjectAndExecuteBlocks:object forKey:key withCost:cost];
+    });
 }
 
 - (void)removeObjectForKey:(NSString *)key
 {
     if (!key)
         return;
-    
-    dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
-
-    [self removeObjectForKey:key block:^(AWSTMMemoryCache *cache, NSString *key, id object) {
-        dispatch_semaphore_signal(semaphore);
-    }];
 
-    dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER);
-
-    #if !OS_OBJECT_USE_OBJC
-    dispatch_release(semaphore);
-    #endif
+    dispatch_sync(_queue, ^{
+        [self removeObjectAndExecuteBlocksForKey:key];
+    });
 }
 
 - (void)trimToDate:(NSDate *)date
@@ -544,63 +836,31 @@ NSString * const AWSTMMemoryCachePrefix = @"com.tumblr.TMMemoryCache";
         [self removeAllObjects];
         return;
     }
-    
-    dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
-
-    [self trimToDate:date block:^(AWSTMMemoryCache *cache) {
-        dispatch_semaphore_signal(semaphore);
-    }];
 
-    dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER);
-
-    #if !OS_OBJECT_USE_OBJC
-    dispatch_release(semaphore);
-    #endif
+    dispatch_sync(_queue, ^{
+        [self trimMemoryToDate:date];
+    });
 }
 
 - (void)trimToCost:(NSUInteger)cost
 {
-    dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
-
-    [self trimToCost:cost block:^(AWSTMMemoryCache *cache) {
-        dispatch_semaphore_signal(semaphore);
-    }];
-
-    dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER);
-
-    #if !OS_OBJECT_USE_OBJC
-    dispatch_release(semaphore);
-    #endif
+    dispatch_sync(_queue, ^{
+        [self trimToCostLimit:cost];
+    });
 }
 
 - (void)trimToCostByDate:(NSUInteger)cost
 {
-    dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
-
-    [self trimToCostByDate:cost block:^(AWSTMMemoryCache *cache) {
-        dispatch_semaphore_signal(semaphore);
-    }];
-
-    dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER);
-
-    #if !OS_OBJECT_USE_OBJC
-    dispatch_release(semaphore);
-    #endif
+    dispatch_sync(_queue, ^{
+        [self trimToCostLimitByDate:cost];
+    });
 }
 
 - (void)removeAllObjects
 {
-    dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
-
-    [self removeAllObjects:^(AWSTMMemoryCache *cache) {
-        dispatch_semaphore_signal(semaphore);
-    }];
-
-    dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER);
-
-    #if !OS_OBJECT_USE_OBJC
-    dispatch_release(semaphore);
-    #endif
+    dispatch_barrier_sync(_queue, ^{
+        [self removeAllObjectsAndExecuteBlocks];
+    });
 }
 
 - (void)enumerateObjectsWithBlock:(AWSTMMemoryCacheObjectBlock)block
@@ -608,17 +868,9 @@ NSString * const AWSTMMemoryCachePrefix = @"com.tumblr.TMMemoryCache";
     if (!block)
         return;
 
-    dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
-
-    [self enumerateObjectsWithBlock:block completionBlock:^(AWSTMMemoryCache *cache) {
-        dispatch_semaphore_signal(semaphore);
-    }];
-
-    dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER);
-
-    #if !OS_OBJECT_USE_OBJC
-    dispatch_release(semaphore);
-    #endif
+    dispatch_barrier_sync(_queue, ^{
+        [self enumerateObjectsByDateWithBlock:block];
+    });
 }
 
 #pragma mark - Public Thread Safe Accessors -
@@ -870,13 +1122,7 @@ NSString * const AWSTMMemoryCachePrefix = @"com.tumblr.TMMemoryCache";
 
 - (NSUInteger)totalCost
 {
-    __block NSUInteger cost = 0;
-    
-    dispatch_sync(_queue, ^{
-        cost = _totalCost;
-    });
-    
-    return cost;
+    return atomic_load(&_totalCost);
 }
 
 @end
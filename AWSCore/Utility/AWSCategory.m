@@ -46,6 +46,336 @@ NSString *const AWSDateShortDateFormat2 = @"yyyy-MM-dd";
 
 @end
 
+//
+// The formats the SDK uses are parsed and formatted without NSDateFormatter. Only dates in years 1583 through 9999
+// take this path: NSDateFormatter switches to the Julian calendar before the Gregorian reform, and years outside four
+// digits are written differently. Anything else goes to the formatters, which accept more variations.
+//
+typedef NS_ENUM(NSInteger, AWSDateFixedFormat) {
+    AWSDateFixedFormatUnknown,
+    AWSDateFixedFormatRFC822Date1,
+    AWSDateFixedFormatISO8601Date1,
+    AWSDateFixedFormatISO8601Date2,
+    AWSDateFixedFormatISO8601Date3,
+    AWSDateFixedFormatShortDate1,
+    AWSDateFixedFormatShortDate2,
+};
+
+static int64_t const AWSDateFixedFormatMinimumYear = 1583;
+static int64_t const AWSDateFixedFormatMaximumYear = 9999;
+// Longer than any fixed format.
+#define AWSDateFixedFormatBufferSize 32
+
+static const char AWSDateWeekdayNames[7][4] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+static const char AWSDateMonthNames[12][4] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+
+static AWSDateFixedFormat AWSDateFixedFormatFromString(NSString *dateFormat) {
+    if ([dateFormat isEqualToString:AWSDateRFC822DateFormat1]) {
+        return AWSDateFixedFormatRFC822Date1;
+    }
+    if ([dateFormat isEqualToString:AWSDateISO8601DateFormat1]) {
+        return AWSDateFixedFormatISO8601Date1;
+    }
+    if ([dateFormat isEqualToString:AWSDateISO8601DateFormat2]) {
+        return AWSDateFixedFormatISO8601Date2;
+    }
+    if ([dateFormat isEqualToString:AWSDateISO8601DateFormat3]) {
+        return AWSDateFixedFormatISO8601Date3;
+    }
+    if ([dateFormat isEqualToString:AWSDateShortDateFormat1]) {
+        return AWSDateFixedFormatShortDate1;
+    }
+    if ([dateFormat isEqualToString:AWSDateShortDateFormat2]) {
+        return AWSDateFixedFormatShortDate2;
+    }
+    return AWSDateFixedFormatUnknown;
+}
+
+static int64_t AWSDateFloorDivide(int64_t dividend, int64_t divisor) {
+    int64_t quotient = dividend / divisor;
+    if ((dividend % divisor != 0) && ((dividend < 0) != (divisor < 0))) {
+        quotient -= 1;
+    }
+    return quotient;
+}
+
+// Days since 1970-01-01 in the proleptic Gregorian calendar.
+static int64_t AWSDateDaysFromCivil(int64_t year, int64_t month, int64_t day) {
+    year -= month <= 2;
+    int64_t era = AWSDateFloorDivide(year, 400);
+    int64_t yearOfEra = year - era * 400;
+    int64_t dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    int64_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+static void AWSDateCivilFromDays(int64_t days, int64_t *year, int64_t *month, int64_t *day) {
+    days += 719468;
+    int64_t era = AWSDateFloorDivide(days, 146097);
+    int64_t dayOfEra = days - era * 146097;
+    int64_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    int64_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    int64_t monthIndex = (5 * dayOfYear + 2) / 153;
+    *day = dayOfYear - (153 * monthIndex + 2) / 5 + 1;
+    *month = monthIndex < 10 ? monthIndex + 3 : monthIndex - 9;
+    *year = yearOfEra + era * 400 + (*month <= 2);
+}
+
+// 0 is Sunday; 1970-01-01 was a Thursday.
+static int64_t AWSDateWeekdayFromDays(int64_t days) {
+    return days - AWSDateFloorDivide(days + 4, 7) * 7 + 4;
+}
+
+static int64_t AWSDateDaysInMonth(int64_t year, int64_t month) {
+    static const int64_t daysInMonth[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    if (month == 2 && (year % 4 == 0) && ((year % 100 != 0) || (year % 400 == 0))) {
+        return 29;
+    }
+    return daysInMonth[month - 1];
+}
+
+static BOOL AWSDateParseDigits(const char *characters, int count, int64_t *value) {
+    int64_t result = 0;
+    for (int i = 0; i < count; i++) {
+        char c = characters[i];
+        if (c < '0' || c > '9') {
+            return NO;
+        }
+        result = result * 10 + (c - '0');
+    }
+    *value = result;
+    return YES;
+}
+
+static int AWSDateIndexOfName(const char *characters, const char names[][4], int count) {
+    for (int i = 0; i < count; i++) {
+        if (memcmp(characters, names[i], 3) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void AWSDateWriteDigits(char *characters, int count, int64_t value) {
+    for (int i = count - 1; i >= 0; i--) {
+        characters[i] = '0' + (char)(value % 10);
+        value /= 10;
+    }
+}
+
+/**
+ Parses `characters` in a fixed format. Returns NO if they do not match the format exactly.
+ */
+static BOOL AWSDateParseFixedFormat(const char *characters, size_t length, AWSDateFixedFormat format, NSTimeInterval *timeInterval) {
+    int64_t year = 0, month = 0, day = 0, hour = 0, minute = 0, second = 0, millisecond = 0;
+    int weekday = -1;
+    switch (format) {
+        case AWSDateFixedFormatRFC822Date1: {
+            // Mon, 01 Jan 2018 00:00:00 GMT
+            if (length != 29
+                || characters[3] != ',' || characters[4] != ' ' || characters[7] != ' ' || characters[11] != ' '
+                || characters[16] != ' ' || characters[19] != ':' || characters[22] != ':' || characters[25] != ' '
+                || (memcmp(characters + 26, "GMT", 3) != 0 && memcmp(characters + 26, "UTC", 3) != 0)) {
+                return NO;
+            }
+            weekday = AWSDateIndexOfName(characters, AWSDateWeekdayNames, 7);
+            month = AWSDateIndexOfName(characters + 8, AWSDateMonthNames, 12) + 1;
+            if (weekday < 0 || month <= 0
+                || !AWSDateParseDigits(characters + 5, 2, &day)
+                || !AWSDateParseDigits(characters + 12, 4, &year)
+                || !AWSDateParseDigits(characters + 17, 2, &hour)
+                || !AWSDateParseDigits(characters + 20, 2, &minute)
+                || !AWSDateParseDigits(characters + 23, 2, &second)) {
+                return NO;
+            }
+            break;
+        }
+        case AWSDateFixedFormatISO8601Date1:
+        case AWSDateFixedFormatISO8601Date3: {
+            // 2018-01-01T00:00:00Z or 2018-01-01T00:00:00.000Z
+            size_t expectedLength = format == AWSDateFixedFormatISO8601Date1 ? 20 : 24;
+            if (length != expectedLength
+                || characters[4] != '-' || characters[7] != '-' || characters[10] != 'T'
+                || characters[13] != ':' || characters[16] != ':' || characters[length - 1] != 'Z'
+                || !AWSDateParseDigits(characters, 4, &year)
+                || !AWSDateParseDigits(characters + 5, 2, &month)
+                || !AWSDateParseDigits(characters + 8, 2, &day)
+                || !AWSDateParseDigits(characters + 11, 2, &hour)
+                || !AWSDateParseDigits(characters + 14, 2, &minute)
+                || !AWSDateParseDigits(characters + 17, 2, &second)) {
+                return NO;
+            }
+            if (format == AWSDateFixedFormatISO8601Date3
+                && (characters[19] != '.' || !AWSDateParseDigits(characters + 20, 3, &millisecond))) {
+                return NO;
+            }
+            break;
+        }
+        case AWSDateFixedFormatISO8601Date2: {
+            // 20180101T000000Z
+            if (length != 16 || characters[8] != 'T' || characters[15] != 'Z'
+                || !AWSDateParseDigits(characters, 4, &year)
+                || !AWSDateParseDigits(characters + 4, 2, &month)
+                || !AWSDateParseDigits(characters + 6, 2, &day)
+                || !AWSDateParseDigits(characters + 9, 2, &hour)
+                || !AWSDateParseDigits(characters + 11, 2, &minute)
+                || !AWSDateParseDigits(characters + 13, 2, &second)) {
+                return NO;
+            }
+            break;
+        }
+        case AWSDateFixedFormatShortDate1: {
+            // 20180101
+            if (length != 8
+                || !AWSDateParseDigits(characters, 4, &year)
+                || !AWSDateParseDigits(characters + 4, 2, &month)
+                || !AWSDateParseDigits(characters + 6, 2, &day)) {
+                return NO;
+            }
+            break;
+        }
+        case AWSDateFixedFormatShortDate2: {
+            // 2018-01-01
+            if (length != 10 || characters[4] != '-' || characters[7] != '-'
+                || !AWSDateParseDigits(characters, 4, &year)
+                || !AWSDateParseDigits(characters + 5, 2, &month)
+                || !AWSDateParseDigits(characters + 8, 2, &day)) {
+                return NO;
+            }
+            break;
+        }
+        default:
+            return NO;
+    }
+
+    if (year < AWSDateFixedFormatMinimumYear || year > AWSDateFixedFormatMaximumYear
+        || month < 1 || month > 12 || day < 1 || day > AWSDateDaysInMonth(year, month)
+        || hour > 23 || minute > 59 || second > 59) {
+        return NO;
+    }
+    int64_t days = AWSDateDaysFromCivil(year, month, day);
+    if (weekday >= 0 && weekday != AWSDateWeekdayFromDays(days)) {
+        return NO;
+    }
+
+    *timeInterval = (NSTimeInterval)(days * 86400 + hour * 3600 + minute * 60 + second) + millisecond / 1000.0;
+    return YES;
+}
+
+/**
+ Writes `timeInterval`, in seconds since 1970, in a fixed format and returns the length, or 0 if the date is out of
+ range.
+ */
+static size_t AWSDateFormatFixedFormat(NSTimeInterval timeInterval, AWSDateFixedFormat format, char characters[AWSDateFixedFormatBufferSize]) {
+    if (!isfinite(timeInterval)) {
+        return 0;
+    }
+    // Round to microseconds first so that dates made from milliseconds keep them.
+    int64_t milliseconds = AWSDateFloorDivide(llround(timeInterval * 1000000.0), 1000);
+    int64_t days = AWSDateFloorDivide(milliseconds, 86400000);
+    int64_t millisecondOfDay = milliseconds - days * 86400000;
+    int64_t year = 0, month = 0, day = 0;
+    AWSDateCivilFromDays(days, &year, &month, &day);
+    if (year < AWSDateFixedFormatMinimumYear || year > AWSDateFixedFormatMaximumYear) {
+        return 0;
+    }
+    int64_t hour = millisecondOfDay / 3600000;
+    int64_t minute = millisecondOfDay / 60000 % 60;
+    int64_t second = millisecondOfDay / 1000 % 60;
+    int64_t millisecond = millisecondOfDay % 1000;
+
+    switch (format) {
+        case AWSDateFixedFormatRFC822Date1:
+            memcpy(characters, AWSDateWeekdayNames[AWSDateWeekdayFromDays(days)], 3);
+            memcpy(characters + 3, ", ", 2);
+            AWSDateWriteDigits(characters + 5, 2, day);
+            characters[7] = ' ';
+            memcpy(characters + 8, AWSDateMonthNames[month - 1], 3);
+            characters[11] = ' ';
+            AWSDateWriteDigits(characters + 12, 4, year);
+            characters[16] = ' ';
+            AWSDateWriteDigits(characters + 17, 2, hour);
+            characters[19] = ':';
+            AWSDateWriteDigits(characters + 20, 2, minute);
+            characters[22] = ':';
+            AWSDateWriteDigits(characters + 23, 2, second);
+            memcpy(characters + 25, " GMT", 4);
+            return 29;
+        case AWSDateFixedFormatISO8601Date1:
+        case AWSDateFixedFormatISO8601Date3:
+            AWSDateWriteDigits(characters, 4, year);
+            characters[4] = '-';
+            AWSDateWriteDigits(characters + 5, 2, month);
+            characters[7] = '-';
+            AWSDateWriteDigits(characters + 8, 2, day);
+            characters[10] = 'T';
+            AWSDateWriteDigits(characters + 11, 2, hour);
+            characters[13] = ':';
+            AWSDateWriteDigits(characters + 14, 2, minute);
+            characters[16] = ':';
+            AWSDateWriteDigits(characters + 17, 2, second);
+            if (format == AWSDateFixedFormatISO8601Date1) {
+                characters[19] = 'Z';
+                return 20;
+            }
+            characters[19] = '.';
+            AWSDateWriteDigits(characters + 20, 3, millisecond);
+            characters[23] = 'Z';
+            return 24;
+        case AWSDateFixedFormatISO8601Date2:
+            AWSDateWriteDigits(characters, 4, year);
+            AWSDateWriteDigits(characters + 4, 2, month);
+            AWSDateWriteDigits(characters + 6, 2, day);
+            characters[8] = 'T';
+            AWSDateWriteDigits(characters + 9, 2, hour);
+            AWSDateWriteDigits(characters + 11, 2, minute);
+            AWSDateWriteDigits(characters + 13, 2, second);
+            characters[15] = 'Z';
+            return 16;
+        case AWSDateFixedFormatShortDate1:
+            AWSDateWriteDigits(characters, 4, year);
+            AWSDateWriteDigits(characters + 4, 2, month);
+            AWSDateWriteDigits(characters + 6, 2, day);
+            return 8;
+        case AWSDateFixedFormatShortDate2:
+            AWSDateWriteDigits(characters, 4, year);
+            characters[4] = '-';
+            AWSDateWriteDigits(characters + 5, 2, month);
+            characters[7] = '-';
+            AWSDateWriteDigits(characters + 8, 2, day);
+            return 10;
+        default:
+            return 0;
+    }
+}
+
+/**
+ Returns the ASCII characters of `string`, copied into `buffer` if CFString does not store them as ASCII, or NULL if
+ the string is too long for any fixed format or is not ASCII.
+ */
+static const char *AWSDateCharactersOfString(NSString *string, char buffer[AWSDateFixedFormatBufferSize], size_t *length) {
+    if (![string isKindOfClass:[NSString class]]) {
+        return NULL;
+    }
+    CFStringRef cfString = (__bridge CFStringRef)string;
+    CFIndex stringLength = CFStringGetLength(cfString);
+    if (stringLength >= (CFIndex)AWSDateFixedFormatBufferSize) {
+        return NULL;
+    }
+    *length = (size_t)stringLength;
+    const char *characters = CFStringGetCStringPtr(cfString, kCFStringEncodingASCII);
+    if (characters) {
+        return characters;
+    }
+    CFIndex usedLength = 0;
+    CFIndex convertedLength = CFStringGetBytes(cfString, CFRangeMake(0, stringLength), kCFStringEncodingASCII, 0, false,
+                                               (UInt8 *)buffer, AWSDateFixedFormatBufferSize, &usedLength);
+    if (convertedLength != stringLength) {
+        return NULL;
+    }
+    return buffer;
+}
+
 @implementation NSDate (AWS)
 
 static NSTimeInterval _clockskew = 0.0;
@@ -55,6 +385,22 @@ static NSTimeInterval _clockskew = 0.0;
 }
 
 + (NSDate *)aws_dateFromString:(NSString *)string {
+    static const AWSDateFixedFormat fixedFormats[] = {AWSDateFixedFormatRFC822Date1,
+                                                      AWSDateFixedFormatISO8601Date1,
+                                                      AWSDateFixedFormatISO8601Date2,
+                                                      AWSDateFixedFormatISO8601Date3};
+    char buffer[AWSDateFixedFormatBufferSize];
+    size_t length = 0;
+    const char *characters = AWSDateCharactersOfString(string, buffer, &length);
+    if (characters) {
+        NSTimeInterval timeInterval = 0;
+        for (size_t i = 0; i < sizeof(fixedFormats) / sizeof(fixedFormats[0]); i++) {
+            if (AWSDateParseFixedFormat(characters, length, fixedFormats[i], &timeInterval)) {
+                return [NSDate dateWithTimeIntervalSince1970:timeInterval];
+            }
+        }
+    }
+
     NSDate *parsedDate = nil;
     NSArray *arrayOfDateFormat = @[AWSDateRFC822DateFormat1,
                                    AWSDateISO8601DateFormat1,
@@ -63,7 +409,7 @@ static NSTimeInterval _clockskew = 0.0;
 
     for (NSString *dateFormat in arrayOfDateFormat) {
         if (!parsedDate) {
-            parsedDate = [NSDate aws_dateFromString:string format:dateFormat];
+            parsedDate = [[NSDate aws_dateFormatterWithFormat:dateFormat] dateFromString:string];
         } else {
             break;
         }
@@ -73,59 +419,69 @@ static NSTimeInterval _clockskew = 0.0;
 }
 
 + (NSDate *)aws_dateFromString:(NSString *)string format:(NSString *)dateFormat {
-    if ([dateFormat isEqualToString:AWSDateRFC822DateFormat1]) {
-        return [[NSDate aws_RFC822Date1Formatter] dateFromString:string];
-    }
-    if ([dateFormat isEqualToString:AWSDateISO8601DateFormat1]) {
-        return [[NSDate aws_ISO8601Date1Formatter] dateFromString:string];
-    }
-    if ([dateFormat isEqualToString:AWSDateISO8601DateFormat2]) {
-        return [[NSDate aws_ISO8601Date2Formatter] dateFromString:string];
-    }
-    if ([dateFormat isEqualToString:AWSDateISO8601DateFormat3]) {
-        return [[NSDate aws_ISO8601Date3Formatter] dateFromString:string];
-    }
-    if ([dateFormat isEqualToString:AWSDateShortDateFormat1]) {
-        return [[NSDate aws_ShortDateFormat1Formatter] dateFromString:string];
-    }
-    if ([dateFormat isEqualToString:AWSDateShortDateFormat2]) {
-        return [[NSDate aws_ShortDateFormat2Formatter] dateFromString:string];
+    AWSDateFixedFormat fixedFormat = AWSDateFixedFormatFromString(dateFormat);
+    if (fixedFormat != AWSDateFixedFormatUnknown) {
+        char buffer[AWSDateFixedFormatBufferSize];
+        size_t length = 0;
+        const char *characters = AWSDateCharactersOfString(string, buffer, &length);
+        NSTimeInterval timeInterval = 0;
+        if (characters && AWSDateParseFixedFormat(characters, length, fixedFormat, &timeInterval)) {
+            return [NSDate dateWithTimeIntervalSince1970:timeInterval];
+        }
     }
 
-    NSDateFormatter *dateFormatter = [NSDateFormatter new];
-    dateFormatter.timeZone = [NSTimeZone timeZoneWithName:@"GMT"];
-    dateFormatter.locale = [NSLocale localeWithLocaleIdentifier:@"en_US_POSIX"];
-    dateFormatter.dateFormat = dateFormat;
-
-    return [dateFormatter dateFromString:string];
+    return [[NSDate aws_dateFormatterWithFormat:dateFormat] dateFromString:string];
 }
 
 - (NSString *)aws_stringValue:(NSString *)dateFormat {
-    if ([dateFormat isEqualToString:AWSDateRFC822DateFormat1]) {
-        return [[NSDate aws_RFC822Date1Formatter] stringFromDate:self];
-    }
-    if ([dateFormat isEqualToString:AWSDateISO8601DateFormat1]) {
-        return [[NSDate aws_ISO8601Date1Formatter] stringFromDate:self];
-    }
-    if ([dateFormat isEqualToString:AWSDateISO8601DateFormat2]) {
-        return [[NSDate aws_ISO8601Date2Formatter] stringFromDate:self];
-    }
-    if ([dateFormat isEqualToString:AWSDateISO8601DateFormat3]) {
-        return [[NSDate aws_ISO8601Date3Formatter] stringFromDate:self];
-    }
-    if ([dateFormat isEqualToString:AWSDateShortDateFormat1]) {
-        return [[NSDate aws_ShortDateFormat1Formatter] stringFromDate:self];
-    }
-    if ([dateFormat isEqualToString:AWSDateShortDateFormat2]) {
-        return [[NSDate aws_ShortDateFormat2Formatter] stringFromDate:self];
+    AWSDateFixedFormat fixedFormat = AWSDateFixedFormatFromString(dateFormat);
+    if (fixedFormat != AWSDateFixedFormatUnknown) {
+        char characters[AWSDateFixedFormatBufferSize];
+        size_t length = AWSDateFormatFixedFormat([self timeIntervalSince1970], fixedFormat, characters);
+        if (length > 0) {
+            return [[NSString alloc] initWithBytes:characters length:length encoding:NSASCIIStringEncoding];
+        }
     }
 
-    NSDateFormatter *dateFormatter = [NSDateFormatter new];
-    dateFormatter.timeZone = [NSTimeZone timeZoneWithName:@"GMT"];
-    dateFormatter.locale = [NSLocale localeWithLocaleIdentifier:@"en_US_POSIX"];
-    dateFormatter.dateFormat = dateFormat;
+    return [[NSDate aws_dateFormatterWithFormat:dateFormat] stringFromDate:self];
+}
+
++ (NSDateFormatter *)aws_dateFormatterWithFormat:(NSString *)dateFormat {
+    switch (AWSDateFixedFormatFromString(dateFormat)) {
+        case AWSDateFixedFormatRFC822Date1:
+            return [NSDate aws_RFC822Date1Formatter];
+        case AWSDateFixedFormatISO8601Date1:
+            return [NSDate aws_ISO8601Date1Formatter];
+        case AWSDateFixedFormatISO8601Date2:
+            return [NSDate aws_ISO8601Date2Formatter];
+        case AWSDateFixedFormatISO8601Date3:
+            return [NSDate aws_ISO8601Date3Formatter];
+        case AWSDateFixedFormatShortDate1:
+            return [NSDate aws_ShortDateFormat1Formatter];
+        case AWSDateFixedFormatShortDate2:
+            return [NSDate aws_ShortDateFormat2Formatter];
+        case AWSDateFixedFormatUnknown:
+            break;
+    }
 
-    return [dateFormatter stringFromDate:self];
+    // Formatters for other formats are kept per thread, so they are neither shared nor created for every call.
+    static NSString *const AWSDateFormattersKey = @"com.amazonaws.AWSCategory.dateFormatters";
+    NSMutableDictionary *threadDictionary = [[NSThread currentThread] threadDictionary];
+    NSMutableDictionary<NSString *, NSDateFormatter *> *dateFormatters = threadDictionary[AWSDateFormattersKey];
+    if (!dateFormatters) {
+        dateFormatters = [NSMutableDictionary new];
+        threadDictionary[AWSDateFormattersKey] = dateFormatters;
+    }
+    NSString *key = dateFormat ?: @"";
+    NSDateFormatter *dateFormatter = dateFormatters[key];
+    if (!dateFormatter) {
+        dateFormatter = [NSDateFormatter new];
+        dateFormatter.timeZone = [NSTimeZone timeZoneWithName:@"GMT"];
+        dateFormatter.locale = [NSLocale localeWithLocaleIdentifier:@"en_US_POSIX"];
+        dateFormatter.dateFormat = dateFormat;
+        dateFormatters[[key copy]] = dateFormatter;
+    }
+    return dateFormatter;
 }
 
 + (NSDateFormatter *)aws_RFC822Date1Formatter {
@@ -0,0 +1,80 @@
+//
+// Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+
+#import <Foundation/Foundation.h>
+#import "AWSXMLWriter.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ An XML stream writer that encodes straight to UTF-8.
+
+ The output is byte for byte the UTF-8 encoding of what `AWSXMLWriter` writes with the same calls, including the
+ characters it drops as invalid in XML. Processing instructions are the exception: they are written as `<?target data?>`
+ rather than as CDATA. Text is escaped with a lookup table and written into a pooled chunk buffer,
+ which is appended to the document data or, when the writer has an output stream, written to the stream whenever it
+ fills up. No intermediate strings are built.
+
+ Only UTF-8 documents are supported. Namespaces are written as plain `xmlns` attributes.
+ */
+@interface AWSXMLByteWriter : NSObject <AWSXMLStreamWriter>
+
+/**
+ The indentation written before each start element, once per level. The default is a tab.
+ */
+@property (nonatomic, strong, nullable) NSString *indentation;
+
+/**
+ The line break written before each start element. The default is a newline.
+ */
+@property (nonatomic, strong, nullable) NSString *lineBreak;
+
+/**
+ If YES, elements without children are written as `<start />`. The default is YES.
+ */
+@property (nonatomic, assign) BOOL automaticEmptyElements;
+
+@property (nonatomic, readonly) int level;
+
+/**
+ The number of bytes written so far, including the bytes still in the chunk buffer.
+ */
+@property (nonatomic, readonly) uint64_t byteCount;
+
+/**
+ The error of the output stream, if writing to it failed. Nothing more is written after an error.
+ */
+@property (nonatomic, readonly, nullable) NSError *streamError;
+
+/**
+ Creates a writer that keeps the document in memory. `- toData` returns it.
+ */
+- (instancetype)init;
+
+/**
+ Creates a writer that writes the document to `outputStream`, which must be open. Writes block until the stream
+ accepts the bytes. Call `- flush` or `- close` to write the bytes still in the chunk buffer.
+ */
+- (instancetype)initWithOutputStream:(NSOutputStream *)outputStream;
+
+/**
+ Returns the document written so far. The data is the writer's buffer and is not copied; do not write to the writer
+ after taking it. Returns nil for a writer with an output stream.
+ */
+- (nullable NSData *)toData;
+
+@end
+
+NS_ASSUME_NONNULL_END
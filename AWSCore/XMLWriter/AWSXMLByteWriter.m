@@ -0,0 +1,499 @@
+//
+// Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+
+#import "AWSXMLByteWriter.h"
+
+static NSUInteger const AWSXMLByteWriterChunkSize = 16 * 1024;
+static NSUInteger const AWSXMLByteWriterMaximumPooledChunks = 4;
+// The longest output of a single UTF-16 code unit, "&quot;".
+static NSUInteger const AWSXMLByteWriterMaximumCharacterLength = 6;
+
+//
+// What to write for each ASCII character of escaped text: 0 writes the character, 1 drops it as invalid in XML and
+// the other values are indexes into AWSXMLByteWriterEntities. Apostrophes are not escaped since attribute values are
+// always quoted with double quotes.
+//
+static const uint8_t AWSXMLByteWriterEscapeTable[128] = {
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 1, 1, 0, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    0, 0, 2, 0, 0, 0, 3, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 4, 0, 5, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+};
+
+static const char *const AWSXMLByteWriterEntities[] = {NULL, NULL, "&quot;", "&amp;", "&lt;", "&gt;"};
+static const NSUInteger AWSXMLByteWriterEntityLengths[] = {0, 0, 6, 5, 4, 4};
+
+@interface AWSXMLByteWriter() {
+    NSMutableData *_data;
+    NSOutputStream *_outputStream;
+
+    // The pooled buffer the output is collected in before it is appended to the data or written to the stream.
+    NSMutableData *_chunk;
+    uint8_t *_chunkBytes;
+    NSUInteger _chunkLength;
+    uint64_t _flushedByteCount;
+
+    NSMutableArray<NSString *> *_elementLocalNames;
+    // is the element open, i.e. the end bracket has not been written yet
+    BOOL _openElement;
+    // does the element contain characters, cdata, comments
+    BOOL _emptyElement;
+}
+
+@property (nonatomic, strong, nullable) NSError *streamError;
+
+@end
+
+@implementation AWSXMLByteWriter
+
+#pragma mark - Chunk pool
+
++ (NSMutableArray<NSMutableData *> *)chunkPool {
+    static NSMutableArray<NSMutableData *> *_chunkPool = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        _chunkPool = [NSMutableArray new];
+    });
+    return _chunkPool;
+}
+
++ (NSMutableData *)dequeueChunk {
+    NSMutableArray<NSMutableData *> *chunkPool = [self chunkPool];
+    @synchronized(chunkPool) {
+        NSMutableData *chunk = [chunkPool lastObject];
+        if (chunk) {
+            [chunkPool removeLastObject];
+            return chunk;
+        }
+    }
+    return [NSMutableData dataWithLength:AWSXMLByteWriterChunkSize];
+}
+
++ (void)enqueueChunk:(NSMutableData *)chunk {
+    NSMutableArray<NSMutableData *> *chunkPool = [self chunkPool];
+    @synchronized(chunkPool) {
+        if ([chunkPool count] < AWSXMLByteWriterMaximumPooledChunks) {
+            [chunkPool addObject:chunk];
+        }
+    }
+}
+
+#pragma mark - Lifecycle
+
+- (instancetype)init {
+    if (self = [super init]) {
+        _data = [NSMutableData new];
+        [self commonInit];
+    }
+    return self;
+}
+
+- (instancetype)initWithOutputStream:(NSOutputStream *)outputStream {
+    if (self = [super init]) {
+        _outputStream = outputStream;
+        [self commonInit];
+    }
+    return self;
+}
+
+- (void)commonInit {
+    _elementLocalNames = [NSMutableArray new];
+    _indentation = @"\t";
+    _lineBreak = @"\n";
+    _automaticEmptyElements = YES;
+}
+
+- (void)dealloc {
+    if (_chunk) {
+        [AWSXMLByteWriter enqueueChunk:_chunk];
+    }
+}
+
+- (uint64_t)byteCount {
+    return _flushedByteCount + _chunkLength;
+}
+
+#pragma mark - Output
+
+- (void)flushChunk {
+    if (_chunkLength > 0) {
+        if (_outputStream) {
+            NSUInteger offset = 0;
+            while (!self.streamError && offset < _chunkLength) {
+                NSInteger written = [_outputStream write:_chunkBytes + offset maxLength:_chunkLength - offset];
+                if (written <= 0) {
+                    self.streamError = _outputStream.streamError ?: [NSError errorWithDomain:NSPOSIXErrorDomain
+                                                                                         code:EPIPE
+                                                                                     userInfo:@{NSLocalizedDescriptionKey : @"The output stream did not accept the XML document."}];
+                } else {
+                    offset += written;
+                }
+            }
+        } else {
+            [_data appendBytes:_chunkBytes length:_chunkLength];
+        }
+        _flushedByteCount += _chunkLength;
+        _chunkLength = 0;
+    }
+    if (!_chunk) {
+        _chunk = [AWSXMLByteWriter dequeueChunk];
+        _chunkBytes = [_chunk mutableBytes];
+    }
+}
+
+- (void)reserveLength:(NSUInteger)length {
+    if (!_chunkBytes || _chunkLength + length > AWSXMLByteWriterChunkSize) {
+        [self flushChunk];
+    }
+}
+
+- (void)writeBytes:(const uint8_t *)bytes length:(NSUInteger)length {
+    while (length > 0) {
+        [self reserveLength:1];
+        NSUInteger count = MIN(length, AWSXMLByteWriterChunkSize - _chunkLength);
+        memcpy(_chunkBytes + _chunkLength, bytes, count);
+        _chunkLength += count;
+        bytes += count;
+        length -= count;
+    }
+}
+
+- (void)writeLiteral:(const char *)literal {
+    [self writeBytes:(const uint8_t *)literal length:strlen(literal)];
+}
+
+/**
+ Writes the ASCII prefix of `bytes` and returns its length, which is less than `length` if a non-ASCII byte was found.
+ */
+- (NSUInteger)writeASCIIBytes:(const uint8_t *)bytes length:(NSUInteger)length escape:(BOOL)escape {
+    NSUInteger runStart = 0;
+    NSUInteger index = 0;
+    for (; index < length; index++) {
+        uint8_t c = bytes[index];
+        if (c >= 0x80) {
+            break;
+        }
+        uint8_t action = escape ? AWSXMLByteWriterEscapeTable[c] : 0;
+        if (action == 0) {
+            continue;
+        }
+        [self writeBytes:bytes + runStart length:index - runStart];
+        if (action > 1) {
+            [self writeBytes:(const uint8_t *)AWSXMLByteWriterEntities[action] length:AWSXMLByteWriterEntityLengths[action]];
+        }
+        runStart = index + 1;
+    }
+    [self writeBytes:bytes + runStart length:index - runStart];
+    return index;
+}
+
+- (void)writeString:(NSString *)value escape:(BOOL)escape {
+    CFStringRef string = (__bridge CFStringRef)value;
+    CFIndex length = string ? CFStringGetLength(string) : 0;
+    if (length == 0) {
+        return;
+    }
+
+    // Most names and values are stored as ASCII and can be written as they are.
+    CFIndex index = 0;
+    const char *ascii = CFStringGetCStringPtr(string, kCFStringEncodingASCII);
+    if (ascii) {
+        index = [self writeASCIIBytes:(const uint8_t *)ascii length:length escape:escape];
+        if (index == length) {
+            return;
+        }
+    }
+
+    CFStringInlineBuffer buffer;
+    CFStringInitInlineBuffer(string, &buffer, CFRangeMake(0, length));
+    for (; index < length; index++) {
+        UniChar c = CFStringGetCharacterFromInlineBuffer(&buffer, index);
+        [self reserveLength:AWSXMLByteWriterMaximumCharacterLength];
+        uint8_t *output = _chunkBytes + _chunkLength;
+        if (c < 0x80) {
+            uint8_t action = escape ? AWSXMLByteWriterEscapeTable[c] : 0;
+            if (action == 0) {
+                output[0] = (uint8_t)c;
+                _chunkLength += 1;
+            } else if (action > 1) {
+                memcpy(output, AWSXMLByteWriterEntities[action], AWSXMLByteWriterEntityLengths[action]);
+                _chunkLength += AWSXMLByteWriterEntityLengths[action];
+            }
+        } else if (c < 0x800) {
+            output[0] = (uint8_t)(0xC0 | (c >> 6));
+            output[1] = (uint8_t)(0x80 | (c & 0x3F));
+            _chunkLength += 2;
+        } else if (c >= 0xD800 && c <= 0xDFFF) {
+            if (escape) {
+                // AWSXMLWriter drops surrogates from escaped text.
+                continue;
+            }
+            UniChar low = index + 1 < length ? CFStringGetCharacterFromInlineBuffer(&buffer, index + 1) : 0;
+            if (c <= 0xDBFF && low >= 0xDC00 && low <= 0xDFFF) {
+                UTF32Char codePoint = 0x10000 + (((UTF32Char)c - 0xD800) << 10) + (low - 0xDC00);
+                output[0] = (uint8_t)(0xF0 | (codePoint >> 18));
+                output[1] = (uint8_t)(0x80 | ((codePoint >> 12) & 0x3F));
+                output[2] = (uint8_t)(0x80 | ((codePoint >> 6) & 0x3F));
+                output[3] = (uint8_t)(0x80 | (codePoint & 0x3F));
+                _chunkLength += 4;
+                index++;
+            } else {
+                // An unpaired surrogate cannot be encoded; write U+FFFD instead.
+                output[0] = 0xEF;
+                output[1] = 0xBF;
+                output[2] = 0xBD;
+                _chunkLength += 3;
+            }
+        } else if (escape && c >= 0xFFFE) {
+            // Not a character in XML.
+            continue;
+        } else {
+            output[0] = (uint8_t)(0xE0 | (c >> 12));
+            output[1] = (uint8_t)(0x80 | ((c >> 6) & 0x3F));
+            output[2] = (uint8_t)(0x80 | (c & 0x3F));
+            _chunkLength += 3;
+        }
+    }
+}
+
+- (void)write:(NSString *)value {
+    [self writeString:value escape:NO];
+}
+
+- (void)writeEscape:(NSString *)value {
+    [self writeString:value escape:YES];
+}
+
+- (void)writeLinebreak {
+    if (self.lineBreak) {
+        [self write:self.lineBreak];
+    }
+}
+
+- (void)writeIndentation {
+    NSString *indentation = self.indentation;
+    if (indentation) {
+        for (int i = 0; i < _level; i++) {
+            [self write:indentation];
+        }
+    }
+}
+
+#pragma mark - AWSXMLStreamWriter
+
+- (void)writeStartDocument {
+    [self writeStartDocumentWithEncodingAndVersion:nil version:nil];
+}
+
+- (void)writeStartDocumentWithVersion:(NSString *)version {
+    [self writeStartDocumentWithEncodingAndVersion:nil version:version];
+}
+
+- (void)writeStartDocumentWithEncodingAndVersion:(NSString *)encoding version:(NSString *)version {
+    if (self.byteCount != 0) {
+        @throw([NSException exceptionWithName:@"XMLWriterException" reason:@"Document has already been started" userInfo:nil]);
+    }
+    if (encoding && [encoding caseInsensitiveCompare:@"UTF-8"] != NSOrderedSame) {
+        @throw([NSException exceptionWithName:@"XMLWriterException" reason:[NSString stringWithFormat:@"Unsupported encoding %@", encoding] userInfo:nil]);
+    }
+
+    [self writeLiteral:"<?xml version=\""];
+    [self write:version ?: @"1.0"];
+    [self writeLiteral:"\""];
+    if (encoding) {
+        [self writeLiteral:" encoding=\""];
+        [self write:encoding];
+        [self writeLiteral:"\""];
+    }
+    [self writeLiteral:" ?>"];
+}
+
+- (void)writeEndDocument {
+    while (_level > 0) {
+        [self writeEndElement];
+    }
+}
+
+- (void)writeCloseElement:(BOOL)empty {
+    if (empty) {
+        [self writeLiteral:" />"];
+    } else {
+        [self writeLiteral:">"];
+    }
+    _openElement = NO;
+}
+
+- (void)writeStartElement:(NSString *)localName {
+    if (_openElement) {
+        [self writeCloseElement:NO];
+    }
+
+    [self writeLinebreak];
+    [self writeIndentation];
+
+    [self writeLiteral:"<"];
+    [self write:localName];
+
+    [_elementLocalNames addObject:localName];
+
+    _openElement = YES;
+    _emptyElement = YES;
+    _level += 1;
+}
+
+- (void)writeEndElement {
+    if (_openElement && self.automaticEmptyElements) {
+        // go for <START />
+        [self writeCloseElement:YES];
+        [_elementLocalNames removeLastObject];
+
+        _emptyElement = YES;
+        _level -= 1;
+    } else {
+        [self writeEndElement:[_elementLocalNames lastObject]];
+    }
+}
+
+- (void)writeEndElement:(NSString *)localName {
+    if (_level <= 0) {
+        @throw([NSException exceptionWithName:@"XMLWriterException" reason:@"Cannot write more end elements than start elements." userInfo:nil]);
+    }
+
+    _level -= 1;
+
+    if (_openElement) {
+        // go for <START><END>
+        [self writeCloseElement:NO];
+    } else if (_emptyElement) {
+        // go for linebreak + indentation + <END>
+        [self writeLinebreak];
+        [self writeIndentation];
+    }
+
+    [self writeLiteral:"</"];
+    [self write:localName];
+    [self writeLiteral:">"];
+
+    [_elementLocalNames removeLastObject];
+
+    _emptyElement = YES;
+    _openElement = NO;
+}
+
+- (void)writeEmptyElement:(NSString *)localName {
+    if (_openElement) {
+        [self writeCloseElement:NO];
+    }
+
+    [self writeLinebreak];
+    [self writeIndentation];
+
+    [self writeLiteral:"<"];
+    [self write:localName];
+    [self writeLiteral:" />"];
+
+    _emptyElement = YES;
+    _openElement = NO;
+}
+
+- (void)writeAttribute:(NSString *)localName value:(NSString *)value {
+    if (!_openElement) {
+        @throw([NSException exceptionWithName:@"XMLWriterException" reason:@"No open start element" userInfo:nil]);
+    }
+
+    [self writeLiteral:" "];
+    [self write:localName];
+    [self writeLiteral:"=\""];
+    [self writeEscape:value];
+    [self writeLiteral:"\""];
+}
+
+- (void)writeCharacters:(NSString *)text {
+    if (_openElement) {
+        [self writeCloseElement:NO];
+    }
+
+    [self writeEscape:text];
+
+    _emptyElement = NO;
+}
+
+- (void)writeComment:(NSString *)comment {
+    if (_openElement) {
+        [self writeCloseElement:NO];
+    }
+    [self writeLiteral:"<!--"];
+    [self write:comment];
+    [self writeLiteral:"-->"];
+
+    _emptyElement = NO;
+}
+
+- (void)writeProcessingInstruction:(NSString *)target data:(NSString *)data {
+    if (_openElement) {
+        [self writeCloseElement:NO];
+    }
+    [self writeLiteral:"<?"];
+    [self write:target];
+    [self writeLiteral:" "];
+    [self write:data];
+    [self writeLiteral:"?>"];
+
+    _emptyElement = NO;
+}
+
+- (void)writeCData:(NSString *)cdata {
+    if (_openElement) {
+        [self writeCloseElement:NO];
+    }
+    [self writeLiteral:"<![CDATA["];
+    [self write:cdata];
+    [self writeLiteral:"]]>"];
+
+    _emptyElement = NO;
+}
+
+- (NSMutableString *)toString {
+    NSData *data = [self toData];
+    if (!data) {
+        return nil;
+    }
+    return [[NSMutableString alloc] initWithData:data encoding:NSUTF8StringEncoding];
+}
+
+- (NSData *)toData {
+    if (!_data) {
+        return nil;
+    }
+    [self flushChunk];
+    return _data;
+}
+
+- (void)flush {
+    [self flushChunk];
+}
+
+- (void)close {
+    [self flushChunk];
+    [AWSXMLByteWriter enqueueChunk:_chunk];
+    _chunk = nil;
+    _chunkBytes = NULL;
+}
+
+@end
@@ -0,0 +1,120 @@
+//
+// Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ A request received by `AWSTestHTTPServer`.
+ */
+@interface AWSTestHTTPRequest : NSObject
+
+@property (nonatomic, readonly) NSString *method;
+
+/**
+ The request target, including the query string.
+ */
+@property (nonatomic, readonly) NSString *path;
+
+/**
+ The header fields, keyed by lowercased name.
+ */
+@property (nonatomic, readonly) NSDictionary<NSString *, NSString *> *headers;
+
+/**
+ The body, read by `Content-Length` or chunked transfer encoding.
+ */
+@property (nonatomic, readonly) NSData *body;
+
+@end
+
+/**
+ A response of `AWSTestHTTPServer`.
+ */
+@interface AWSTestHTTPResponse : NSObject
+
+/**
+ The status line of the response. The default is `200 OK`.
+ */
+@property (nonatomic, copy) NSString *status;
+
+/**
+ The header fields. `Content-Length` is added from the body unless it is set here or the body is chunked.
+ */
+@property (nonatomic, copy) NSDictionary<NSString *, NSString *> *headers;
+
+@property (nonatomic, copy) NSData *body;
+
+/**
+ Whether the body is sent with chunked transfer encoding. The default is `NO`.
+ */
+@property (nonatomic, assign) BOOL chunked;
+
+/**
+ When greater than 0, the body is sent in pieces of this size, or HTTP chunks of this size when `chunked` is set. The default is 0, the whole body at once.
+ */
+@property (nonatomic, assign) NSUInteger chunkSize;
+
+/**
+ The pause before the header is sent.
+ */
+@property (nonatomic, assign) NSTimeInterval headerDelay;
+
+/**
+ The pause before each piece of the body.
+ */
+@property (nonatomic, assign) NSTimeInterval chunkDelay;
+
+/**
+ When not `NSNotFound`, the connection is closed after this many bytes of the body, without completing the response. The default is `NSNotFound`.
+ */
+@property (nonatomic, assign) NSUInteger dropConnectionAfterLength;
+
++ (instancetype)responseWithStatus:(NSString *)status
+                           headers:(nullable NSDictionary<NSString *, NSString *> *)headers
+                              body:(nullable NSData *)body;
+
+@end
+
+/**
+ A minimal HTTP/1.1 server on 127.0.0.1 for unit tests. Each connection carries one request, which is answered with the response the handler returns for it.
+ */
+@interface AWSTestHTTPServer : NSObject
+
+/**
+ The base URL of the server, e.g. `http://127.0.0.1:51234`. Only valid after `- start`.
+ */
+@property (nonatomic, readonly) NSURL *URL;
+
+/**
+ Returns the response to a request. Called on a background queue, once for each request, possibly for several requests at the same time. It may block to hold a request. Without a handler every request gets an empty `200 OK`.
+ */
+@property (atomic, copy, nullable) AWSTestHTTPResponse *(^responseHandler)(AWSTestHTTPRequest *request);
+
+/**
+ The requests received so far, in order of arrival.
+ */
+@property (atomic, readonly) NSArray<AWSTestHTTPRequest *> *requestLog;
+
+- (BOOL)start;
+
+- (void)stop;
+
+- (void)resetRequestLog;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,316 @@
+//
+// Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+
+#import "AWSTestHTTPServer.h"
+
+#import <arpa/inet.h>
+#import <netinet/in.h>
+#import <sys/socket.h>
+#import <unistd.h>
+
+@interface AWSTestHTTPRequest()
+
+@property (nonatomic, strong) NSString *method;
+@property (nonatomic, strong) NSString *path;
+@property (nonatomic, strong) NSDictionary<NSString *, NSString *> *headers;
+@property (nonatomic, strong) NSData *body;
+
+@end
+
+@implementation AWSTestHTTPRequest
+
+@end
+
+@implementation AWSTestHTTPResponse
+
+- (instancetype)init {
+    if (self = [super init]) {
+        _status = @"200 OK";
+        _headers = @{};
+        _body = [NSData new];
+        _dropConnectionAfterLength = NSNotFound;
+    }
+    return self;
+}
+
++ (instancetype)responseWithStatus:(NSString *)status
+                           headers:(NSDictionary<NSString *, NSString *> *)headers
+                              body:(NSData *)body {
+    AWSTestHTTPResponse *response = [self new];
+    response.status = status;
+    response.headers = headers ?: @{};
+    response.body = body ?: [NSData new];
+    return response;
+}
+
+@end
+
+@interface AWSTestHTTPServer()
+
+@property (nonatomic, strong) NSURL *URL;
+@property (nonatomic, strong) NSMutableArray<AWSTestHTTPRequest *> *internalRequestLog;
+@property (nonatomic, strong) dispatch_source_t acceptSource;
+
+@end
+
+@implementation AWSTestHTTPServer
+
+- (instancetype)init {
+    if (self = [super init]) {
+        _internalRequestLog = [NSMutableArray new];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [self stop];
+}
+
+- (BOOL)start {
+    int listenSocket = socket(AF_INET, SOCK_STREAM, 0);
+    if (listenSocket < 0) {
+        return NO;
+    }
+    int yes = 1;
+    setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+    struct sockaddr_in address = {0};
+    address.sin_len = sizeof(address);
+    address.sin_family = AF_INET;
+    address.sin_port = 0;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addressLength = sizeof(address);
+    if (bind(listenSocket, (struct sockaddr *)&address, sizeof(address)) != 0
+        || listen(listenSocket, 64) != 0
+        || getsockname(listenSocket, (struct sockaddr *)&address, &addressLength) != 0) {
+        close(listenSocket);
+        return NO;
+    }
+
+    self.URL = [NSURL URLWithString:[NSString stringWithFormat:@"http://127.0.0.1:%d", ntohs(address.sin_port)]];
+
+    dispatch_queue_t acceptQueue = dispatch_queue_create("com.amazonaws.AWSTestHTTPServer.accept", DISPATCH_QUEUE_SERIAL);
+    self.acceptSource = dispatch_source_create(DISPATCH_SOURCE_TYPE_READ, listenSocket, 0, acceptQueue);
+    __weak AWSTestHTTPServer *weakSelf = self;
+    dispatch_source_set_event_handler(self.acceptSource, ^{
+        int connection = accept(listenSocket, NULL, NULL);
+        if (connection < 0) {
+            return;
+        }
+        int noSigPipe = 1;
+        setsockopt(connection, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe));
+        // A client that stops reading must not block the connection forever.
+        struct timeval timeout = {.tv_sec = 30, .tv_usec = 0};
+        setsockopt(connection, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+            [weakSelf handleConnection:connection];
+            close(connection);
+        });
+    });
+    dispatch_source_set_cancel_handler(self.acceptSource, ^{
+        close(listenSocket);
+    });
+    dispatch_resume(self.acceptSource);
+    return YES;
+}
+
+- (void)stop {
+    if (self.acceptSource) {
+        dispatch_source_cancel(self.acceptSource);
+        self.acceptSource = nil;
+    }
+}
+
+- (NSArray<AWSTestHTTPRequest *> *)requestLog {
+    @synchronized(self) {
+        return [self.internalRequestLog copy];
+    }
+}
+
+- (void)resetRequestLog {
+    @synchronized(self) {
+        [self.internalRequestLog removeAllObjects];
+    }
+}
+
+#pragma mark - Connection handling
+
+- (void)handleConnection:(int)connection {
+    AWSTestHTTPRequest *request = [self readRequestFromConnection:connection];
+    if (!request) {
+        return;
+    }
+
+    @synchronized(self) {
+        [self.internalRequestLog addObject:request];
+    }
+
+    AWSTestHTTPResponse *(^responseHandler)(AWSTestHTTPRequest *request) = self.responseHandler;
+    AWSTestHTTPResponse *response = responseHandler ? responseHandler(request) : [AWSTestHTTPResponse new];
+    [self sendResponse:response toConnection:connection];
+}
+
+- (AWSTestHTTPRequest *)readRequestFromConnection:(int)connection {
+    NSMutableData *buffer = [NSMutableData new];
+    NSData *terminator = [@"\r\n\r\n" dataUsingEncoding:NSASCIIStringEncoding];
+    NSRange terminatorRange = NSMakeRange(NSNotFound, 0);
+    while ((terminatorRange = [buffer rangeOfData:terminator options:0 range:NSMakeRange(0, [buffer length])]).location == NSNotFound) {
+        if (![self receiveFromConnection:connection intoData:buffer]) {
+            return nil;
+        }
+    }
+
+    NSString *head = [[NSString alloc] initWithData:[buffer subdataWithRange:NSMakeRange(0, terminatorRange.location)]
+                                           encoding:NSASCIIStringEncoding];
+    NSArray<NSString *> *lines = [head componentsSeparatedByString:@"\r\n"];
+    NSArray<NSString *> *requestLine = [[lines firstObject] componentsSeparatedByString:@" "];
+    if ([requestLine count] < 2) {
+        return nil;
+    }
+    NSMutableDictionary<NSString *, NSString *> *headers = [NSMutableDictionary new];
+    for (NSString *line in [lines subarrayWithRange:NSMakeRange(1, [lines count] - 1)]) {
+        NSRange separator = [line rangeOfString:@":"];
+        if (separator.location == NSNotFound) {
+            continue;
+        }
+        NSString *name = [[line substringToIndex:separator.location] lowercaseString];
+        NSString *value = [[line substringFromIndex:separator.location + 1] stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+        headers[name] = value;
+    }
+    [buffer replaceBytesInRange:NSMakeRange(0, NSMaxRange(terminatorRange)) withBytes:NULL length:0];
+
+    NSData *body = nil;
+    if ([[headers[@"transfer-encoding"] lowercaseString] isEqualToString:@"chunked"]) {
+        body = [self readChunkedBodyFromConnection:connection buffer:buffer];
+    } else {
+        NSUInteger contentLength = (NSUInteger)[headers[@"content-length"] longLongValue];
+        while ([buffer length] < contentLength) {
+            if (![self receiveFromConnection:connection intoData:buffer]) {
+                return nil;
+            }
+        }
+        body = [buffer subdataWithRange:NSMakeRange(0, contentLength)];
+    }
+    if (!body) {
+        return nil;
+    }
+
+    AWSTestHTTPRequest *request = [AWSTestHTTPRequest new];
+    request.method = requestLine[0];
+    request.path = requestLine[1];
+    request.headers = headers;
+    request.body = body;
+    return request;
+}
+
+- (NSData *)readChunkedBodyFromConnection:(int)connection buffer:(NSMutableData *)buffer {
+    NSMutableData *body = [NSMutableData new];
+    NSData *lineEnd = [@"\r\n" dataUsingEncoding:NSASCIIStringEncoding];
+    while (YES) {
+        NSRange lineEndRange = NSMakeRange(NSNotFound, 0);
+        while ((lineEndRange = [buffer rangeOfData:lineEnd options:0 range:NSMakeRange(0, [buffer length])]).location == NSNotFound) {
+            if (![self receiveFromConnection:connection intoData:buffer]) {
+                return nil;
+            }
+        }
+        NSString *sizeLine = [[NSString alloc] initWithData:[buffer subdataWithRange:NSMakeRange(0, lineEndRange.location)]
+                                                   encoding:NSASCIIStringEncoding];
+        NSUInteger chunkSize = (NSUInteger)strtoul([sizeLine UTF8String], NULL, 16);
+        [buffer replaceBytesInRange:NSMakeRange(0, NSMaxRange(lineEndRange)) withBytes:NULL length:0];
+
+        // The chunk and its trailing CRLF; the last chunk is followed by an empty trailer.
+        while ([buffer length] < chunkSize + 2) {
+            if (![self receiveFromConnection:connection intoData:buffer]) {
+                return nil;
+            }
+        }
+        [body appendData:[buffer subdataWithRange:NSMakeRange(0, chunkSize)]];
+        [buffer replaceBytesInRange:NSMakeRange(0, chunkSize + 2) withBytes:NULL length:0];
+        if (chunkSize == 0) {
+            return body;
+        }
+    }
+}
+
+- (BOOL)receiveFromConnection:(int)connection intoData:(NSMutableData *)data {
+    char buffer[16 * 1024];
+    ssize_t count = recv(connection, buffer, sizeof(buffer), 0);
+    if (count <= 0) {
+        return NO;
+    }
+    [data appendBytes:buffer length:(NSUInteger)count];
+    return YES;
+}
+
+- (void)sendResponse:(AWSTestHTTPResponse *)response toConnection:(int)connection {
+    if (response.headerDelay > 0) {
+        [NSThread sleepForTimeInterval:response.headerDelay];
+    }
+
+    NSData *body = response.body;
+    NSMutableString *head = [NSMutableString stringWithFormat:@"HTTP/1.1 %@\r\nConnection: close\r\n", response.status];
+    [response.headers enumerateKeysAndObjectsUsingBlock:^(NSString *name, NSString *value, BOOL *stop) {
+        [head appendFormat:@"%@: %@\r\n", name, value];
+    }];
+    if (response.chunked) {
+        [head appendString:@"Transfer-Encoding: chunked\r\n"];
+    } else if (!response.headers[@"Content-Length"]) {
+        [head appendFormat:@"Content-Length: %lu\r\n", (unsigned long)[body length]];
+    }
+    [head appendString:@"\r\n"];
+    if (![self sendData:[head dataUsingEncoding:NSASCIIStringEncoding] toConnection:connection]) {
+        return;
+    }
+
+    NSUInteger length = MIN([body length], response.dropConnectionAfterLength);
+    NSUInteger chunkSize = response.chunkSize > 0 ? response.chunkSize : MAX([body length], 1);
+    for (NSUInteger offset = 0; offset < length; offset += chunkSize) {
+        if (response.chunkDelay > 0) {
+            [NSThread sleepForTimeInterval:response.chunkDelay];
+        }
+        NSRange range = NSMakeRange(offset, MIN(chunkSize, length - offset));
+        NSMutableData *piece = [NSMutableData new];
+        if (response.chunked) {
+            [piece appendData:[[NSString stringWithFormat:@"%lx\r\n", (unsigned long)range.length] dataUsingEncoding:NSASCIIStringEncoding]];
+        }
+        [piece appendData:[body subdataWithRange:range]];
+        if (response.chunked) {
+            [piece appendData:[@"\r\n" dataUsingEncoding:NSASCIIStringEncoding]];
+        }
+        if (![self sendData:piece toConnection:connection]) {
+            return;
+        }
+    }
+    if (response.chunked && length == [body length]) {
+        [self sendData:[@"0\r\n\r\n" dataUsingEncoding:NSASCIIStringEncoding] toConnection:connection];
+    }
+    shutdown(connection, SHUT_WR);
+}
+
+- (BOOL)sendData:(NSData *)data toConnection:(int)connection {
+    const uint8_t *bytes = [data bytes];
+    NSUInteger remaining = [data length];
+    while (remaining > 0) {
+        ssize_t count = send(connection, bytes, remaining, 0);
+        if (count <= 0) {
+            return NO;
+        }
+        bytes += count;
+        remaining -= (NSUInteger)count;
+    }
+    return YES;
+}
+
+@end
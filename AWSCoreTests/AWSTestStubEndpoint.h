@@ -0,0 +1,49 @@
+//
+// Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+
+#import <Foundation/Foundation.h>
+#import "AWSCore.h"
+#import "AWSTestHTTPServer.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Serves the requests of a service client in process. Attached to a client in place of its `AWSNetworking`, it runs each
+ request through the client's request serializer, asks `- responseForRequest:parameters:` for the response and runs that
+ through the client's response serializer, so tests exercise the real wire format without a socket. Subclasses
+ implement a service. Use `AWSTestHTTPServer` to exercise the networking stack as well.
+ */
+@interface AWSTestStubEndpoint : NSObject
+
+/**
+ Routes the requests of the service client, for example an `AWSSQS`, to this endpoint.
+ */
+- (void)attachToServiceClient:(id)serviceClient;
+
+/**
+ Returns the response to a serialized request. Called once for each request, on the thread that sent it and possibly
+ for several requests at the same time. Only the status, headers and body of the response are used; return a delayed
+ task to simulate a round trip, or a failed task to simulate a network error. The default is an empty `200 OK`.
+
+ @param request    The serialized request.
+ @param parameters The parameters the request was serialized from.
+ */
+- (AWSTask<AWSTestHTTPResponse *> *)responseForRequest:(NSURLRequest *)request parameters:(NSDictionary *)parameters;
+
+- (AWSTask *)sendRequest:(AWSNetworkingRequest *)request;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,67 @@
+//
+// Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+
+#import "AWSTestStubEndpoint.h"
+
+@interface AWSTestStubEndpoint()
+
+@property (nonatomic, strong) AWSNetworkingConfiguration *configuration;
+
+@end
+
+@implementation AWSTestStubEndpoint
+
+- (void)attachToServiceClient:(id)serviceClient {
+    self.configuration = [serviceClient valueForKey:@"configuration"];
+    [serviceClient setValue:self forKey:@"networking"];
+}
+
+- (AWSTask<AWSTestHTTPResponse *> *)responseForRequest:(NSURLRequest *)request parameters:(NSDictionary *)parameters {
+    return [AWSTask taskWithResult:[AWSTestHTTPResponse new]];
+}
+
+- (AWSTask *)sendRequest:(AWSNetworkingRequest *)request {
+    [request assignProperties:self.configuration];
+
+    NSMutableURLRequest *URLRequest = [NSMutableURLRequest requestWithURL:request.URL];
+    URLRequest.HTTPMethod = [NSString aws_stringWithHTTPMethod:request.HTTPMethod];
+    AWSTask *serializeTask = [request.requestSerializer serializeRequest:URLRequest
+                                                                 headers:request.headers
+                                                              parameters:request.parameters];
+    [serializeTask waitUntilFinished];
+    if (serializeTask.error) {
+        return serializeTask;
+    }
+
+    return [[self responseForRequest:URLRequest parameters:request.parameters ?: @{}] continueWithSuccessBlock:^id(AWSTask<AWSTestHTTPResponse *> *task) {
+        AWSTestHTTPResponse *stubResponse = task.result;
+        NSHTTPURLResponse *response = [[NSHTTPURLResponse alloc] initWithURL:URLRequest.URL
+                                                                  statusCode:[stubResponse.status integerValue]
+                                                                 HTTPVersion:@"HTTP/1.1"
+                                                                headerFields:stubResponse.headers];
+        NSError *error = nil;
+        id responseObject = [request.responseSerializer responseObjectForResponse:response
+                                                                  originalRequest:URLRequest
+                                                                   currentRequest:URLRequest
+                                                                             data:stubResponse.body
+                                                                            error:&error];
+        if (error) {
+            return [AWSTask taskWithError:error];
+        }
+        return responseObject;
+    }];
+}
+
+@end
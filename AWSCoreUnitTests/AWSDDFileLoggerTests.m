@@ -0,0 +1,216 @@
+//
+// Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+
+#import <XCTest/XCTest.h>
+#import <sys/resource.h>
+#import "AWSCore.h"
+
+static NSUInteger const AWSDDFileLoggerTestsMessageCount = 20000;
+
+@interface AWSDDFileLoggerTests : XCTestCase
+
+@property (nonatomic, strong) NSString *logsDirectory;
+@property (nonatomic, strong) AWSDDLog *log;
+
+@end
+
+@implementation AWSDDFileLoggerTests
+
+- (void)setUp {
+    [super setUp];
+    self.logsDirectory = [NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+    self.log = [AWSDDLog new];
+}
+
+- (void)tearDown {
+    [self.log removeAllLoggers];
+    [[NSFileManager defaultManager] removeItemAtPath:self.logsDirectory error:nil];
+    [super tearDown];
+}
+
+- (AWSDDFileLogger *)fileLoggerWithManager:(AWSDDLogFileManagerDefault *)manager {
+    AWSDDFileLogger *fileLogger = [[AWSDDFileLogger alloc] initWithLogFileManager:manager];
+    fileLogger.logFormatter = nil;
+    [self.log addLogger:fileLogger];
+    return fileLogger;
+}
+
+- (void)logMessages:(NSUInteger)count {
+    for (NSUInteger i = 0; i < count; i++) {
+        [self.log log:YES
+              message:[[AWSDDLogMessage alloc] initWithMessage:[NSString stringWithFormat:@"message %lu with a representative amount of payload text", (unsigned long)i]
+                                                         level:AWSDDLogLevelVerbose
+                                                          flag:AWSDDLogFlagVerbose
+                                                       context:0
+                                                          file:@(__FILE__)
+                                                      function:@(__PRETTY_FUNCTION__)
+                                                          line:__LINE__
+                                                           tag:nil
+                                                       options:0
+                                                     timestamp:nil]];
+    }
+}
+
+- (NSString *)contentsOfLogFiles:(AWSDDLogFileManagerDefault *)manager {
+    NSMutableString *contents = [NSMutableString string];
+    for (NSString *path in [[manager sortedLogFilePaths] reverseObjectEnumerator]) {
+        NSData *data = [NSData dataWithContentsOfFile:path];
+        if ([path hasSuffix:@".gz"]) {
+            data = [data awsgzip_gunzippedData];
+        }
+        [contents appendString:[[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding]];
+    }
+    return contents;
+}
+
+- (void)testBufferedWritesAreFlushedOnFlushLog {
+    AWSDDLogFileManagerDefault *manager = [[AWSDDLogFileManagerDefault alloc] initWithLogsDirectory:self.logsDirectory];
+    AWSDDFileLogger *fileLogger = [self fileLoggerWithManager:manager];
+    fileLogger.logBufferSize = 64 * 1024;
+    fileLogger.flushInterval = 60;
+
+    [self logMessages:10];
+    [self.log flushLog];
+
+    NSArray<NSString *> *lines = [[self contentsOfLogFiles:manager] componentsSeparatedByString:@"\n"];
+    XCTAssertEqual(lines.count, 11);
+    XCTAssertTrue([lines[0] hasPrefix:@"message 0 "]);
+    XCTAssertTrue([lines[9] hasPrefix:@"message 9 "]);
+}
+
+- (void)testBufferedWritesAreFlushedOnInterval {
+    AWSDDLogFileManagerDefault *manager = [[AWSDDLogFileManagerDefault alloc] initWithLogsDirectory:self.logsDirectory];
+    AWSDDFileLogger *fileLogger = [self fileLoggerWithManager:manager];
+    fileLogger.logBufferSize = 64 * 1024;
+    fileLogger.flushInterval = 0.1;
+
+    [self logMessages:1];
+    [NSThread sleepForTimeInterval:0.5];
+
+    XCTAssertTrue([[self contentsOfLogFiles:manager] hasPrefix:@"message 0 "]);
+}
+
+- (void)testRolledFilesAreCompressed {
+    AWSDDLogFileManagerDefault *manager = [[AWSDDLogFileManagerDefault alloc] initWithLogsDirectory:self.logsDirectory];
+    manager.compressesArchivedLogFiles = YES;
+    manager.maximumNumberOfLogFiles = 0;
+    manager.logFilesDiskQuota = 0;
+    AWSDDFileLogger *fileLogger = [self fileLoggerWithManager:manager];
+    fileLogger.logBufferSize = 4 * 1024;
+    fileLogger.maximumFileSize = 16 * 1024;
+
+    [self logMessages:2000];
+    [self.log flushLog];
+
+    __block BOOL compressed = NO;
+    for (NSUInteger attempt = 0; attempt < 50 && !compressed; attempt++) {
+        [NSThread sleepForTimeInterval:0.1];
+        NSArray<AWSDDLogFileInfo *> *infos = [manager sortedLogFileInfos];
+        compressed = infos.count > 1;
+        for (AWSDDLogFileInfo *info in infos) {
+            if (info.isArchived && ![info.filePath hasSuffix:@".gz"]) {
+                compressed = NO;
+            }
+        }
+    }
+    XCTAssertTrue(compressed);
+
+    // Compressed files count as archived and keep the name of the original, also on the simulator.
+    for (AWSDDLogFileInfo *info in [manager sortedLogFileInfos]) {
+        if ([info.filePath hasSuffix:@".gz"]) {
+            XCTAssertTrue(info.isArchived);
+            XCTAssertEqual([info.fileName rangeOfString:@".archived"].location, NSNotFound);
+            XCTAssertTrue([manager isLogFile:info.fileName]);
+        }
+    }
+
+    // Every statement survives rolling and compression, in order.
+    NSArray<NSString *> *lines = [[self contentsOfLogFiles:manager] componentsSeparatedByString:@"\n"];
+    XCTAssertEqual(lines.count, 2001);
+    for (NSUInteger i = 0; i < 2000; i++) {
+        XCTAssertTrue([lines[i] hasPrefix:[NSString stringWithFormat:@"message %lu ", (unsigned long)i]]);
+    }
+}
+
+- (void)testDiskQuotaUsesCompressedSize {
+    AWSDDLogFileManagerDefault *manager = [[AWSDDLogFileManagerDefault alloc] initWithLogsDirectory:self.logsDirectory];
+    manager.compressesArchivedLogFiles = YES;
+    manager.maximumNumberOfLogFiles = 0;
+    manager.logFilesDiskQuota = 64 * 1024;
+    AWSDDFileLogger *fileLogger = [self fileLoggerWithManager:manager];
+    fileLogger.logBufferSize = 4 * 1024;
+    fileLogger.maximumFileSize = 32 * 1024;
+
+    // Roughly 10 files worth of uncompressed data, which would not fit the quota uncompressed.
+    [self logMessages:5000];
+    [self.log flushLog];
+    [NSThread sleepForTimeInterval:2.0];
+
+    unsigned long long archivedSize = 0;
+    NSUInteger archivedCount = 0;
+    for (AWSDDLogFileInfo *info in [manager sortedLogFileInfos]) {
+        if (info.isArchived) {
+            archivedSize += info.fileSize;
+            archivedCount++;
+        }
+    }
+    XCTAssertGreaterThan(archivedCount, 2);
+    XCTAssertLessThanOrEqual(archivedSize, 64 * 1024);
+}
+
+#pragma mark - Benchmarks
+
+- (void)measureLoggingWithBufferSize:(NSUInteger)bufferSize {
+    [self measureMetrics:[[self class] defaultPerformanceMetrics] automaticallyStartMeasuring:NO forBlock:^{
+        NSString *directory = [self.logsDirectory stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+        AWSDDLogFileManagerDefault *manager = [[AWSDDLogFileManagerDefault alloc] initWithLogsDirectory:directory];
+        manager.compressesArchivedLogFiles = YES;
+        AWSDDFileLogger *fileLogger = [self fileLoggerWithManager:manager];
+        fileLogger.logBufferSize = bufferSize;
+
+        struct rusage before, after;
+        getrusage(RUSAGE_SELF, &before);
+        CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+
+        [self startMeasuring];
+        [self logMessages:AWSDDFileLoggerTestsMessageCount];
+        [self.log flushLog];
+        [self stopMeasuring];
+
+        CFAbsoluteTime elapsed = CFAbsoluteTimeGetCurrent() - start;
+        getrusage(RUSAGE_SELF, &after);
+
+        unsigned long long bytes = 0;
+        for (AWSDDLogFileInfo *info in [manager unsortedLogFileInfos]) {
+            bytes += info.fileSize;
+        }
+        double cpu = (after.ru_utime.tv_sec - before.ru_utime.tv_sec) + (after.ru_stime.tv_sec - before.ru_stime.tv_sec)
+        + ((after.ru_utime.tv_usec - before.ru_utime.tv_usec) + (after.ru_stime.tv_usec - before.ru_stime.tv_usec)) / 1e6;
+        NSLog(@"AWSDDFileLogger buffer %lu: %.0f bytes/sec on disk, %.2f us CPU per message",
+              (unsigned long)bufferSize, bytes / elapsed, cpu * 1e6 / AWSDDFileLoggerTestsMessageCount);
+
+        [self.log removeLogger:fileLogger];
+    }];
+}
+
+- (void)testPerformanceUnbufferedLogging {
+    [self measureLoggingWithBufferSize:0];
+}
+
+- (void)testPerformanceBufferedLogging {
+    [self measureLoggingWithBufferSize:64 * 1024];
+}
+
+@end
@@ -0,0 +1,218 @@
+//
+// Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+
+#import <XCTest/XCTest.h>
+#import "AWSCore.h"
+
+static NSUInteger const AWSDateFormattingTestsTimestampCount = 100000;
+// 1583-01-01T00:00:00Z and 10000-01-01T00:00:00Z.
+static NSTimeInterval const AWSDateFormattingTestsMinimumTimeInterval = -12212553600.0;
+static NSTimeInterval const AWSDateFormattingTestsMaximumTimeInterval = 253402300800.0;
+static NSTimeInterval const AWSDateFormattingTestsSecondsPerDay = 86400.0;
+
+@interface AWSDateFormattingTests : XCTestCase
+
+@end
+
+@implementation AWSDateFormattingTests
+
+- (NSArray<NSString *> *)dateFormats {
+    return @[AWSDateRFC822DateFormat1,
+             AWSDateISO8601DateFormat1,
+             AWSDateISO8601DateFormat2,
+             AWSDateISO8601DateFormat3,
+             AWSDateShortDateFormat1,
+             AWSDateShortDateFormat2];
+}
+
+- (NSDateFormatter *)referenceFormatterWithFormat:(NSString *)dateFormat {
+    NSDateFormatter *dateFormatter = [NSDateFormatter new];
+    dateFormatter.timeZone = [NSTimeZone timeZoneWithName:@"GMT"];
+    dateFormatter.locale = [NSLocale localeWithLocaleIdentifier:@"en_US_POSIX"];
+    dateFormatter.dateFormat = dateFormat;
+    return dateFormatter;
+}
+
+- (NSArray<NSString *> *)timestamps {
+    NSMutableArray<NSString *> *timestamps = [NSMutableArray arrayWithCapacity:AWSDateFormattingTestsTimestampCount];
+    NSTimeInterval timeInterval = 1500000000.0;
+    for (NSUInteger i = 0; i < AWSDateFormattingTestsTimestampCount; i++) {
+        NSDate *date = [NSDate dateWithTimeIntervalSince1970:timeInterval + i * 7919];
+        [timestamps addObject:[date aws_stringValue:i % 2 ? AWSDateISO8601DateFormat1 : AWSDateRFC822DateFormat1]];
+    }
+    return timestamps;
+}
+
+// Every day the fast path covers, at a different time of day each day.
+- (void)testRoundTripEveryDay {
+    NSUInteger day = 0;
+    for (NSTimeInterval midnight = AWSDateFormattingTestsMinimumTimeInterval;
+         midnight < AWSDateFormattingTestsMaximumTimeInterval;
+         midnight += AWSDateFormattingTestsSecondsPerDay, day++) {
+        @autoreleasepool {
+            NSTimeInterval timeInterval = midnight + (day * 7919) % 86400;
+            NSDate *date = [NSDate dateWithTimeIntervalSince1970:timeInterval];
+            NSString *string = [date aws_stringValue:AWSDateISO8601DateFormat1];
+            NSDate *parsedDate = [NSDate aws_dateFromString:string format:AWSDateISO8601DateFormat1];
+            if (![parsedDate isEqualToDate:date]) {
+                XCTFail(@"%@ parsed as %@, expected %f", string, parsedDate, timeInterval);
+                return;
+            }
+        }
+    }
+}
+
+- (void)testRoundTripAllFormats {
+    for (NSString *dateFormat in [self dateFormats]) {
+        BOOL hasTime = ![dateFormat isEqualToString:AWSDateShortDateFormat1] && ![dateFormat isEqualToString:AWSDateShortDateFormat2];
+        BOOL hasMilliseconds = [dateFormat isEqualToString:AWSDateISO8601DateFormat3];
+        NSUInteger day = 0;
+        for (NSTimeInterval midnight = AWSDateFormattingTestsMinimumTimeInterval;
+             midnight < AWSDateFormattingTestsMaximumTimeInterval;
+             midnight += 37 * AWSDateFormattingTestsSecondsPerDay, day++) {
+            @autoreleasepool {
+                NSTimeInterval timeInterval = midnight;
+                if (hasTime) {
+                    timeInterval += (day * 7919) % 86400;
+                }
+                if (hasMilliseconds) {
+                    timeInterval += (day % 1000) / 1000.0;
+                }
+                NSDate *date = [NSDate dateWithTimeIntervalSince1970:timeInterval];
+                NSString *string = [date aws_stringValue:dateFormat];
+                NSDate *parsedDate = [NSDate aws_dateFromString:string format:dateFormat];
+                if (fabs([parsedDate timeIntervalSince1970] - timeInterval) > 0.0005) {
+                    XCTFail(@"%@ parsed as %@, expected %f", string, parsedDate, timeInterval);
+                    return;
+                }
+            }
+        }
+    }
+}
+
+- (void)testMatchesDateFormatter {
+    for (NSString *dateFormat in [self dateFormats]) {
+        NSDateFormatter *referenceFormatter = [self referenceFormatterWithFormat:dateFormat];
+        NSUInteger day = 0;
+        for (NSTimeInterval midnight = AWSDateFormattingTestsMinimumTimeInterval;
+             midnight < AWSDateFormattingTestsMaximumTimeInterval;
+             midnight += 997 * AWSDateFormattingTestsSecondsPerDay, day++) {
+            @autoreleasepool {
+                // Whole seconds, so NSDateFormatter's own millisecond rounding does not matter.
+                NSDate *date = [NSDate dateWithTimeIntervalSince1970:midnight + (day * 7919) % 86400];
+                NSString *expected = [referenceFormatter stringFromDate:date];
+                XCTAssertEqualObjects([date aws_stringValue:dateFormat], expected);
+                XCTAssertEqualObjects([NSDate aws_dateFromString:expected format:dateFormat],
+                                      [referenceFormatter dateFromString:expected]);
+            }
+        }
+    }
+}
+
+- (void)testKnownDates {
+    NSDate *date = [NSDate dateWithTimeIntervalSince1970:1516233600.25];
+    XCTAssertEqualObjects([date aws_stringValue:AWSDateRFC822DateFormat1], @"Thu, 18 Jan 2018 00:00:00 GMT");
+    XCTAssertEqualObjects([date aws_stringValue:AWSDateISO8601DateFormat1], @"2018-01-18T00:00:00Z");
+    XCTAssertEqualObjects([date aws_stringValue:AWSDateISO8601DateFormat2], @"20180118T000000Z");
+    XCTAssertEqualObjects([date aws_stringValue:AWSDateISO8601DateFormat3], @"2018-01-18T00:00:00.250Z");
+    XCTAssertEqualObjects([date aws_stringValue:AWSDateShortDateFormat1], @"20180118");
+    XCTAssertEqualObjects([date aws_stringValue:AWSDateShortDateFormat2], @"2018-01-18");
+
+    XCTAssertEqualObjects([NSDate aws_dateFromString:@"Thu, 18 Jan 2018 00:00:00 GMT"], [NSDate dateWithTimeIntervalSince1970:1516233600]);
+    XCTAssertEqualObjects([NSDate aws_dateFromString:@"2018-01-18T00:00:00Z"], [NSDate dateWithTimeIntervalSince1970:1516233600]);
+    XCTAssertEqualObjects([NSDate aws_dateFromString:@"20180118T000000Z"], [NSDate dateWithTimeIntervalSince1970:1516233600]);
+    XCTAssertEqualObjects([NSDate aws_dateFromString:@"2018-01-18T00:00:00.250Z"], date);
+    XCTAssertEqualObjects([NSDate aws_dateFromString:@"2000-02-29" format:AWSDateShortDateFormat2], [NSDate dateWithTimeIntervalSince1970:951782400]);
+}
+
+- (void)testInvalidStrings {
+    NSArray<NSString *> *strings = @[@"",
+                                     @"2018-01-18 00:00:00Z",
+                                     @"2018-01-18T00:00:00",
+                                     @"Xyz, 18 Jan 2018 00:00:00 GMT",
+                                     @"Thu, 18 Foo 2018 00:00:00 GMT",
+                                     @"not a date"];
+    for (NSString *string in strings) {
+        XCTAssertNil([NSDate aws_dateFromString:string], @"%@", string);
+    }
+    XCTAssertNil([NSDate aws_dateFromString:@"2018-01-18T00:00:00Z" format:AWSDateShortDateFormat2]);
+}
+
+- (void)testFallsBackToDateFormatter {
+    // A weekday that does not match the date is left to NSDateFormatter to accept or reject.
+    NSString *mismatchedWeekday = @"Mon, 18 Jan 2018 00:00:00 GMT";
+    XCTAssertEqualObjects([NSDate aws_dateFromString:mismatchedWeekday],
+                          [[self referenceFormatterWithFormat:AWSDateRFC822DateFormat1] dateFromString:mismatchedWeekday]);
+
+    // Before the Gregorian reform.
+    NSDate *earlyDate = [NSDate dateWithTimeIntervalSince1970:-15000000000.0];
+    for (NSString *dateFormat in [self dateFormats]) {
+        NSDateFormatter *referenceFormatter = [self referenceFormatterWithFormat:dateFormat];
+        NSString *expected = [referenceFormatter stringFromDate:earlyDate];
+        XCTAssertEqualObjects([earlyDate aws_stringValue:dateFormat], expected);
+        XCTAssertEqualObjects([NSDate aws_dateFromString:expected format:dateFormat], [referenceFormatter dateFromString:expected]);
+    }
+
+    // Formats other than the SDK's.
+    NSDate *date = [NSDate dateWithTimeIntervalSince1970:1516233600.25];
+    XCTAssertEqualObjects([date aws_stringValue:@"HHmmssSSS"], @"000000250");
+    XCTAssertEqualObjects([NSDate aws_dateFromString:@"18/01/2018" format:@"dd/MM/yyyy"], [NSDate dateWithTimeIntervalSince1970:1516233600]);
+}
+
+- (void)testConcurrentUse {
+    dispatch_apply(16, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t iteration) {
+        for (NSUInteger i = 0; i < 1000; i++) {
+            NSDate *date = [NSDate dateWithTimeIntervalSince1970:1500000000 + iteration * 100000 + i];
+            NSString *dateFormat = i % 2 ? AWSDateISO8601DateFormat1 : @"yyyy.MM.dd HH:mm:ss";
+            XCTAssertEqualObjects([NSDate aws_dateFromString:[date aws_stringValue:dateFormat] format:dateFormat], date);
+        }
+    });
+}
+
+- (void)testPerformanceParseAndFormat {
+    NSArray<NSString *> *timestamps = [self timestamps];
+    [self measureBlock:^{
+        for (NSString *timestamp in timestamps) {
+            @autoreleasepool {
+                NSDate *date = [NSDate aws_dateFromString:timestamp];
+                XCTAssertNotNil([date aws_stringValue:AWSDateISO8601DateFormat2]);
+            }
+        }
+    }];
+}
+
+// The baseline: the same timestamps through NSDateFormatter, trying the formats in turn like the fallback does.
+- (void)testPerformanceParseAndFormatDateFormatter {
+    NSArray<NSString *> *timestamps = [self timestamps];
+    NSArray<NSDateFormatter *> *parsers = @[[self referenceFormatterWithFormat:AWSDateRFC822DateFormat1],
+                                            [self referenceFormatterWithFormat:AWSDateISO8601DateFormat1]];
+    NSDateFormatter *formatter = [self referenceFormatterWithFormat:AWSDateISO8601DateFormat2];
+    [self measureBlock:^{
+        for (NSString *timestamp in timestamps) {
+            @autoreleasepool {
+                NSDate *date = nil;
+                for (NSDateFormatter *parser in parsers) {
+                    date = [parser dateFromString:timestamp];
+                    if (date) {
+                        break;
+                    }
+                }
+                XCTAssertNotNil([formatter stringFromDate:date]);
+            }
+        }
+    }];
+}
+
+@end
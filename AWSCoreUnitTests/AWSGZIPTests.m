@@ -0,0 +1,239 @@
+//
+// Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+
+#import <XCTest/XCTest.h>
+#import <sys/resource.h>
+#import "AWSCore.h"
+#import "AWSURLRequestSerialization.h"
+
+static NSUInteger const AWSGZIPTestsPayloadSize = 8 * 1024 * 1024;
+
+@interface AWSGZIPTests : XCTestCase
+
+@end
+
+@implementation AWSGZIPTests
+
+// Log-like payload: compressible, but not trivially so.
++ (NSData *)payloadWithLength:(NSUInteger)length {
+    NSMutableData *data = [NSMutableData dataWithCapacity:length];
+    NSUInteger i = 0;
+    while (data.length < length) {
+        NSString *line = [NSString stringWithFormat:@"{\"timestamp\":%lu,\"message\":\"event %lu from device %lu\",\"value\":%u}\n",
+                          (unsigned long)(1500000000 + i), (unsigned long)i, (unsigned long)(i % 97), arc4random_uniform(100000)];
+        [data appendData:[line dataUsingEncoding:NSUTF8StringEncoding]];
+        i++;
+    }
+    data.length = length;
+    return data;
+}
+
++ (NSData *)drainStream:(NSInputStream *)stream readSize:(NSUInteger)readSize {
+    NSMutableData *output = [NSMutableData data];
+    uint8_t *buffer = malloc(readSize);
+    [stream open];
+    NSInteger read;
+    while ((read = [stream read:buffer maxLength:readSize]) > 0) {
+        [output appendBytes:buffer length:read];
+    }
+    [stream close];
+    free(buffer);
+    return read < 0 ? nil : output;
+}
+
+- (void)testRoundTrip {
+    for (NSNumber *length in @[@1, @100, @16384, @16385, @(1024 * 1024 + 7)]) {
+        NSData *payload = [AWSGZIPTests payloadWithLength:[length unsignedIntegerValue]];
+        NSData *compressed = [payload awsgzip_gzippedData];
+        XCTAssertNotNil(compressed);
+        XCTAssertEqualObjects([compressed awsgzip_gunzippedData], payload);
+    }
+}
+
+- (void)testEmptyData {
+    XCTAssertNil([[NSData data] awsgzip_gzippedData]);
+    XCTAssertNil([[NSData data] awsgzip_gunzippedData]);
+}
+
+- (void)testContextReuseAcrossLevels {
+    NSData *payload = [AWSGZIPTests payloadWithLength:64 * 1024];
+    NSData *defaultLevel = [payload awsgzip_gzippedData];
+    for (NSUInteger i = 0; i < 20; i++) {
+        float level = (i % 3 == 0) ? -1.0f : (i % 3) / 2.0f;
+        NSData *compressed = [payload awsgzip_gzippedDataWithCompressionLevel:level];
+        XCTAssertEqualObjects([compressed awsgzip_gunzippedData], payload);
+    }
+    // A reused context must produce exactly what a fresh one does.
+    XCTAssertEqualObjects([payload awsgzip_gzippedData], defaultLevel);
+}
+
+- (void)testConcurrentCompression {
+    NSData *payload = [AWSGZIPTests payloadWithLength:256 * 1024];
+    NSData *expected = [payload awsgzip_gzippedData];
+    __block NSUInteger mismatches = 0;
+    NSObject *lock = [NSObject new];
+    dispatch_apply(64, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t iteration) {
+        NSData *compressed = [payload awsgzip_gzippedData];
+        if (![compressed isEqualToData:expected] || ![[compressed awsgzip_gunzippedData] isEqualToData:payload]) {
+            @synchronized(lock) {
+                mismatches++;
+            }
+        }
+    });
+    XCTAssertEqual(mismatches, 0);
+}
+
+- (void)testGunzipRejectsCorruptedTrailer {
+    NSData *payload = [AWSGZIPTests payloadWithLength:100000];
+    NSData *compressed = [payload awsgzip_gzippedData];
+    NSMutableData *corrupted = [compressed mutableCopy];
+    uint8_t zero[4] = {0, 0, 0, 0};
+    [corrupted replaceBytesInRange:NSMakeRange(corrupted.length - 4, 4) withBytes:zero];
+
+    // Without a usable size hint the output buffer has to grow, and zlib still validates the trailer.
+    XCTAssertNil([corrupted awsgzip_gunzippedData]);
+    XCTAssertEqualObjects([compressed awsgzip_gunzippedData], payload);
+}
+
+- (void)testGunzipTreatsTrailerSizeAsHint {
+    NSData *payload = [AWSGZIPTests payloadWithLength:100];
+    NSData *compressed = [payload awsgzip_gzippedData];
+    NSMutableData *forged = [compressed mutableCopy];
+    uint8_t huge[4] = {0xff, 0xff, 0xff, 0xff};
+    [forged replaceBytesInRange:NSMakeRange(forged.length - 4, 4) withBytes:huge];
+
+    // A 4 GB size from a tiny input must not be allocated; zlib then rejects the mismatched trailer.
+    XCTAssertNil([forged awsgzip_gunzippedData]);
+
+    // Output larger than the initial cap still inflates by growing the buffer.
+    NSData *zeros = [NSMutableData dataWithLength:40 * 1024 * 1024];
+    XCTAssertEqualObjects([[zeros awsgzip_gzippedData] awsgzip_gunzippedData], zeros);
+}
+
+- (void)testInputStreamMatchesPayload {
+    NSData *payload = [AWSGZIPTests payloadWithLength:3 * 1024 * 1024 + 11];
+    for (NSNumber *readSize in @[@1, @7, @4096, @(32 * 1024), @(1024 * 1024)]) {
+        if ([readSize unsignedIntegerValue] == 1 && payload.length > 64 * 1024) {
+            // Byte-at-a-time reads over a large payload only slow the test down.
+            NSData *small = [payload subdataWithRange:NSMakeRange(0, 64 * 1024)];
+            AWSGZIPInputStream *stream = [[AWSGZIPInputStream alloc] initWithInputStream:[NSInputStream inputStreamWithData:small]];
+            XCTAssertEqualObjects([[AWSGZIPTests drainStream:stream readSize:1] awsgzip_gunzippedData], small);
+            continue;
+        }
+        AWSGZIPInputStream *stream = [[AWSGZIPInputStream alloc] initWithInputStream:[NSInputStream inputStreamWithData:payload]];
+        NSData *compressed = [AWSGZIPTests drainStream:stream readSize:[readSize unsignedIntegerValue]];
+        XCTAssertEqualObjects([compressed awsgzip_gunzippedData], payload);
+        XCTAssertEqual(stream.totalBytesIn, (int64_t)payload.length);
+        XCTAssertEqual(stream.totalBytesOut, (int64_t)compressed.length);
+        XCTAssertEqual(stream.streamStatus, NSStreamStatusAtEnd);
+    }
+}
+
+- (void)testInputStreamWithEmptySource {
+    AWSGZIPInputStream *stream = [[AWSGZIPInputStream alloc] initWithInputStream:[NSInputStream inputStreamWithData:[NSData data]]];
+    NSData *compressed = [AWSGZIPTests drainStream:stream readSize:1024];
+    // An empty payload still produces a valid gzip member.
+    XCTAssertGreaterThan(compressed.length, 0);
+    XCTAssertEqual(stream.totalBytesIn, 0);
+}
+
+- (void)testJSONRequestSerializerStreamsGzipBodies {
+    NSDictionary *definition = @{@"operations" : @{@"Upload" : @{@"http" : @{@"method" : @"POST", @"requestUri" : @"/"},
+                                                                  @"input" : @{@"shape" : @"UploadInput"}}},
+                                 @"shapes" : @{@"UploadInput" : @{@"type" : @"structure",
+                                                                   @"members" : @{@"body" : @{@"shape" : @"Body"}},
+                                                                   @"payload" : @"body"},
+                                               @"Body" : @{@"type" : @"blob", @"streaming" : @YES}}};
+    AWSJSONRequestSerializer *serializer = [[AWSJSONRequestSerializer alloc] initWithJSONDefinition:definition actionName:@"Upload"];
+    serializer.compressionLevel = 1.0f;
+    NSData *payload = [AWSGZIPTests payloadWithLength:512 * 1024];
+
+    // By default the payload is compressed before signing, so SigV4 can hash it.
+    NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:[NSURL URLWithString:@"https://example.com/"]];
+    request.HTTPMethod = @"POST";
+    [[serializer serializeRequest:request
+                          headers:@{@"Content-Encoding" : @"gzip"}
+                       parameters:@{@"body" : payload}] waitUntilFinished];
+
+    XCTAssertNotNil(request.HTTPBody);
+    XCTAssertNil(request.HTTPBodyStream);
+    XCTAssertEqualObjects([request.HTTPBody awsgzip_gunzippedData], payload);
+
+    // Signers that send UNSIGNED-PAYLOAD can have it compressed while it is uploaded.
+    serializer.streamsCompressedBodies = YES;
+    request = [NSMutableURLRequest requestWithURL:[NSURL URLWithString:@"https://example.com/"]];
+    request.HTTPMethod = @"POST";
+    [[serializer serializeRequest:request
+                          headers:@{@"Content-Encoding" : @"gzip"}
+                       parameters:@{@"body" : payload}] waitUntilFinished];
+
+    XCTAssertTrue([request.HTTPBodyStream isKindOfClass:[AWSGZIPInputStream class]]);
+    XCTAssertNil([request valueForHTTPHeaderField:@"Content-Length"]);
+    XCTAssertEqualObjects([[AWSGZIPTests drainStream:request.HTTPBodyStream readSize:32 * 1024] awsgzip_gunzippedData], payload);
+}
+
+#pragma mark - Benchmarks
+
++ (long)peakResidentSize {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+- (void)testPerformanceGzippedData {
+    NSData *payload = [AWSGZIPTests payloadWithLength:AWSGZIPTestsPayloadSize];
+    long peakBefore = [AWSGZIPTests peakResidentSize];
+    [self measureBlock:^{
+        CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+        NSData *compressed = [payload awsgzip_gzippedData];
+        CFAbsoluteTime elapsed = CFAbsoluteTimeGetCurrent() - start;
+        NSLog(@"awsgzip_gzippedData: %.1f MB/s, ratio %.2f, peak RSS grew by %ld",
+              payload.length / elapsed / 1e6, (double)compressed.length / payload.length, [AWSGZIPTests peakResidentSize] - peakBefore);
+    }];
+}
+
+- (void)testPerformanceGunzippedData {
+    NSData *payload = [AWSGZIPTests payloadWithLength:AWSGZIPTestsPayloadSize];
+    NSData *compressed = [payload awsgzip_gzippedData];
+    long peakBefore = [AWSGZIPTests peakResidentSize];
+    [self measureBlock:^{
+        CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+        NSData *decompressed = [compressed awsgzip_gunzippedData];
+        CFAbsoluteTime elapsed = CFAbsoluteTimeGetCurrent() - start;
+        NSLog(@"awsgzip_gunzippedData: %.1f MB/s, peak RSS grew by %ld",
+              decompressed.length / elapsed / 1e6, [AWSGZIPTests peakResidentSize] - peakBefore);
+    }];
+}
+
+- (void)testPerformanceGZIPInputStream {
+    NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+    [[AWSGZIPTests payloadWithLength:AWSGZIPTestsPayloadSize] writeToFile:path atomically:YES];
+    long peakBefore = [AWSGZIPTests peakResidentSize];
+    [self measureBlock:^{
+        CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+        AWSGZIPInputStream *stream = [[AWSGZIPInputStream alloc] initWithInputStream:[NSInputStream inputStreamWithFileAtPath:path]];
+        uint8_t buffer[32 * 1024];
+        [stream open];
+        while ([stream read:buffer maxLength:sizeof(buffer)] > 0) {
+        }
+        [stream close];
+        CFAbsoluteTime elapsed = CFAbsoluteTimeGetCurrent() - start;
+        NSLog(@"AWSGZIPInputStream: %.1f MB/s, peak RSS grew by %ld",
+              stream.totalBytesIn / elapsed / 1e6, [AWSGZIPTests peakResidentSize] - peakBefore);
+    }];
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+}
+
+@end
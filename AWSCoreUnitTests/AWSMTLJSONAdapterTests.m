@@ -0,0 +1,276 @@
+//
+// Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+
+#import <XCTest/XCTest.h>
+#import "AWSCore.h"
+
+@interface AWSMTLJSONAdapterTestsChild : AWSModel
+
+@property (nonatomic, strong) NSString *name;
+
+@end
+
+@implementation AWSMTLJSONAdapterTestsChild
+
++ (NSDictionary *)JSONKeyPathsByPropertyKey {
+    return @{@"name" : @"Name"};
+}
+
+@end
+
+@interface AWSMTLJSONAdapterTestsModel : AWSModel
+
+@property (nonatomic, strong) NSString *identifier;
+@property (nonatomic, strong) NSString *nested;
+@property (nonatomic, strong) NSDate *date;
+@property (nonatomic, strong) AWSMTLJSONAdapterTestsChild *child;
+@property (nonatomic, strong) NSArray *children;
+@property (nonatomic, assign) NSInteger count;
+@property (nonatomic, strong) NSString *validated;
+@property (nonatomic, strong) NSString *unmapped;
+
+@end
+
+@implementation AWSMTLJSONAdapterTestsModel
+
++ (NSDictionary *)JSONKeyPathsByPropertyKey {
+    return @{@"identifier" : @"Id",
+             @"nested" : @"Outer.Inner",
+             @"date" : @"Date",
+             @"child" : @"Child",
+             @"children" : @"Children",
+             @"count" : @"Count",
+             @"validated" : @"Validated",
+             @"unmapped" : [NSNull null]};
+}
+
++ (NSValueTransformer *)dateJSONTransformer {
+    return [AWSMTLValueTransformer reversibleTransformerWithForwardBlock:^id(NSNumber *number) {
+        return [NSDate dateWithTimeIntervalSince1970:[number doubleValue]];
+    } reverseBlock:^id(NSDate *date) {
+        return @([date timeIntervalSince1970]);
+    }];
+}
+
++ (NSValueTransformer *)childJSONTransformer {
+    return [NSValueTransformer awsmtl_JSONDictionaryTransformerWithModelClass:[AWSMTLJSONAdapterTestsChild class]];
+}
+
++ (NSValueTransformer *)childrenJSONTransformer {
+    return [NSValueTransformer awsmtl_JSONArrayTransformerWithModelClass:[AWSMTLJSONAdapterTestsChild class]];
+}
+
+- (BOOL)validateValidated:(id *)ioValue error:(NSError **)error {
+    if ([*ioValue isEqual:@"invalid"]) {
+        if (error != NULL) {
+            *error = [NSError errorWithDomain:@"AWSMTLJSONAdapterTests" code:1 userInfo:nil];
+        }
+        return NO;
+    }
+    *ioValue = [*ioValue uppercaseString];
+    return YES;
+}
+
+@end
+
+// Customizes construction, so it has to go through +modelWithDictionary:error:.
+@interface AWSMTLJSONAdapterTestsCustomModel : AWSMTLJSONAdapterTestsModel
+
+@property (nonatomic, strong) NSDictionary *receivedDictionary;
+
+@end
+
+@implementation AWSMTLJSONAdapterTestsCustomModel
+
+- (instancetype)initWithDictionary:(NSDictionary *)dictionaryValue error:(NSError **)error {
+    self = [super initWithDictionary:dictionaryValue error:error];
+    if (self) {
+        _receivedDictionary = dictionaryValue;
+    }
+    return self;
+}
+
+@end
+
+@interface AWSMTLJSONAdapterTestsSubclassedAdapter : AWSMTLJSONAdapter
+
+@end
+
+@implementation AWSMTLJSONAdapterTestsSubclassedAdapter
+
+- (NSString *)JSONKeyPathForPropertyKey:(NSString *)key {
+    if ([key isEqualToString:@"identifier"]) {
+        return @"OtherId";
+    }
+    return [super JSONKeyPathForPropertyKey:key];
+}
+
+@end
+
+@interface AWSMTLJSONAdapterTests : XCTestCase
+
+@end
+
+@implementation AWSMTLJSONAdapterTests
+
++ (NSDictionary *)JSONDictionary {
+    return @{@"Id" : @"id-1",
+             @"Outer" : @{@"Inner" : @"inner"},
+             @"Date" : @1500000000,
+             @"Child" : @{@"Name" : @"child"},
+             @"Children" : @[@{@"Name" : @"a"}, @{@"Name" : @"b"}],
+             @"Count" : @42,
+             @"Validated" : @"lower",
+             @"unmapped" : @"ignored",
+             @"Unknown" : @"ignored"};
+}
+
+- (void)testDecodesAllPropertyKinds {
+    NSError *error = nil;
+    AWSMTLJSONAdapterTestsModel *model = [AWSMTLJSONAdapter modelOfClass:[AWSMTLJSONAdapterTestsModel class]
+                                                      fromJSONDictionary:[AWSMTLJSONAdapterTests JSONDictionary]
+                                                                   error:&error];
+    XCTAssertNil(error);
+    XCTAssertEqualObjects(model.identifier, @"id-1");
+    XCTAssertEqualObjects(model.nested, @"inner");
+    XCTAssertEqualObjects(model.date, [NSDate dateWithTimeIntervalSince1970:1500000000]);
+    XCTAssertEqualObjects(model.child.name, @"child");
+    XCTAssertEqual(model.children.count, 2);
+    XCTAssertEqualObjects([model.children[1] name], @"b");
+    XCTAssertEqual(model.count, 42);
+    XCTAssertEqualObjects(model.validated, @"LOWER");
+    XCTAssertNil(model.unmapped);
+}
+
+- (void)testRepeatedDecodingIsStable {
+    AWSMTLJSONAdapterTestsModel *first = [AWSMTLJSONAdapter modelOfClass:[AWSMTLJSONAdapterTestsModel class]
+                                                      fromJSONDictionary:[AWSMTLJSONAdapterTests JSONDictionary]
+                                                                   error:nil];
+    for (NSUInteger i = 0; i < 10; i++) {
+        AWSMTLJSONAdapterTestsModel *model = [AWSMTLJSONAdapter modelOfClass:[AWSMTLJSONAdapterTestsModel class]
+                                                          fromJSONDictionary:[AWSMTLJSONAdapterTests JSONDictionary]
+                                                                       error:nil];
+        XCTAssertEqualObjects(model, first);
+    }
+}
+
+- (void)testNullValues {
+    NSDictionary *JSONDictionary = @{@"Id" : [NSNull null], @"Date" : [NSNull null], @"Count" : @1};
+    AWSMTLJSONAdapterTestsModel *model = [AWSMTLJSONAdapter modelOfClass:[AWSMTLJSONAdapterTestsModel class]
+                                                      fromJSONDictionary:JSONDictionary
+                                                                   error:nil];
+    XCTAssertNotNil(model);
+    XCTAssertNil(model.identifier);
+    XCTAssertNil(model.date);
+    XCTAssertEqual(model.count, 1);
+}
+
+- (void)testCustomValidationFailure {
+    NSMutableDictionary *JSONDictionary = [[AWSMTLJSONAdapterTests JSONDictionary] mutableCopy];
+    JSONDictionary[@"Validated"] = @"invalid";
+    NSError *error = nil;
+    XCTAssertNil([AWSMTLJSONAdapter modelOfClass:[AWSMTLJSONAdapterTestsModel class] fromJSONDictionary:JSONDictionary error:&error]);
+    XCTAssertEqualObjects(error.domain, @"AWSMTLJSONAdapterTests");
+}
+
+- (void)testInvalidKeyPath {
+    NSError *error = nil;
+    XCTAssertNil([AWSMTLJSONAdapter modelOfClass:[AWSMTLJSONAdapterTestsModel class] fromJSONDictionary:@{@"Outer" : @"not a dictionary"} error:&error]);
+    XCTAssertEqualObjects(error.domain, AWSMTLJSONAdapterErrorDomain);
+    XCTAssertEqual(error.code, AWSMTLJSONAdapterErrorInvalidJSONDictionary);
+}
+
+- (void)testCustomInitializerReceivesDictionary {
+    AWSMTLJSONAdapterTestsCustomModel *model = [AWSMTLJSONAdapter modelOfClass:[AWSMTLJSONAdapterTestsCustomModel class]
+                                                            fromJSONDictionary:[AWSMTLJSONAdapterTests JSONDictionary]
+                                                                         error:nil];
+    XCTAssertEqualObjects(model.identifier, @"id-1");
+    XCTAssertEqualObjects(model.receivedDictionary[@"identifier"], @"id-1");
+    XCTAssertEqualObjects(model.receivedDictionary[@"count"], @42);
+    XCTAssertNil(model.receivedDictionary[@"unmapped"]);
+}
+
+- (void)testAdapterSubclassIsNotServedCachedPlan {
+    NSMutableDictionary *JSONDictionary = [[AWSMTLJSONAdapterTests JSONDictionary] mutableCopy];
+    JSONDictionary[@"OtherId"] = @"other";
+
+    // Warm up the plan of the base adapter first.
+    AWSMTLJSONAdapterTestsModel *model = [AWSMTLJSONAdapter modelOfClass:[AWSMTLJSONAdapterTestsModel class] fromJSONDictionary:JSONDictionary error:nil];
+    XCTAssertEqualObjects(model.identifier, @"id-1");
+
+    model = [AWSMTLJSONAdapterTestsSubclassedAdapter modelOfClass:[AWSMTLJSONAdapterTestsModel class] fromJSONDictionary:JSONDictionary error:nil];
+    XCTAssertEqualObjects(model.identifier, @"other");
+
+    model = [AWSMTLJSONAdapter modelOfClass:[AWSMTLJSONAdapterTestsModel class] fromJSONDictionary:JSONDictionary error:nil];
+    XCTAssertEqualObjects(model.identifier, @"id-1");
+}
+
+- (void)testRoundTrip {
+    AWSMTLJSONAdapterTestsModel *model = [AWSMTLJSONAdapter modelOfClass:[AWSMTLJSONAdapterTestsModel class]
+                                                      fromJSONDictionary:[AWSMTLJSONAdapterTests JSONDictionary]
+                                                                   error:nil];
+    NSDictionary *JSONDictionary = [AWSMTLJSONAdapter JSONDictionaryFromModel:model];
+    XCTAssertEqualObjects(JSONDictionary[@"Id"], @"id-1");
+    XCTAssertEqualObjects(JSONDictionary[@"Outer"], @{@"Inner" : @"inner"});
+    XCTAssertEqualObjects(JSONDictionary[@"Date"], @1500000000);
+    XCTAssertEqualObjects(JSONDictionary[@"Children"], (@[@{@"Name" : @"a"}, @{@"Name" : @"b"}]));
+    XCTAssertNil(JSONDictionary[@"unmapped"]);
+
+    AWSMTLJSONAdapterTestsModel *decoded = [AWSMTLJSONAdapter modelOfClass:[AWSMTLJSONAdapterTestsModel class]
+                                                        fromJSONDictionary:JSONDictionary
+                                                                     error:nil];
+    XCTAssertEqualObjects(decoded.child, model.child);
+    XCTAssertEqualObjects(decoded.date, model.date);
+}
+
+- (void)testJSONDataFromModel {
+    AWSMTLJSONAdapterTestsModel *model = [AWSMTLJSONAdapter modelOfClass:[AWSMTLJSONAdapterTestsModel class]
+                                                      fromJSONDictionary:[AWSMTLJSONAdapterTests JSONDictionary]
+                                                                   error:nil];
+    model.identifier = nil;
+    NSError *error = nil;
+    NSData *data = [AWSMTLJSONAdapter JSONDataFromModel:model error:&error];
+    XCTAssertNil(error);
+    XCTAssertEqualObjects([NSJSONSerialization JSONObjectWithData:data options:0 error:nil],
+                          [[AWSMTLJSONAdapter JSONDictionaryFromModel:model] aws_removeNullValues]);
+
+    // Without key paths the model is written property by property.
+    AWSMTLJSONAdapterTestsChild *child = [AWSMTLJSONAdapterTestsChild new];
+    child.name = @"quote \" backslash \\ newline \n tab \t control \x01 unicode \u00e9 \U0001F600";
+    data = [AWSMTLJSONAdapter JSONDataFromModel:child error:&error];
+    XCTAssertNil(error);
+    XCTAssertEqualObjects([NSJSONSerialization JSONObjectWithData:data options:0 error:nil], @{@"Name" : child.name});
+
+    child.name = nil;
+    XCTAssertEqualObjects([[NSString alloc] initWithData:[AWSMTLJSONAdapter JSONDataFromModel:child error:nil] encoding:NSUTF8StringEncoding], @"{}");
+}
+
+- (void)testConcurrentDecoding {
+    __block NSUInteger failures = 0;
+    NSObject *lock = [NSObject new];
+    dispatch_apply(200, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t iteration) {
+        AWSMTLJSONAdapterTestsModel *model = [AWSMTLJSONAdapter modelOfClass:[AWSMTLJSONAdapterTestsModel class]
+                                                          fromJSONDictionary:[AWSMTLJSONAdapterTests JSONDictionary]
+                                                                       error:nil];
+        if (![model.nested isEqualToString:@"inner"] || model.children.count != 2) {
+            @synchronized(lock) {
+                failures++;
+            }
+        }
+    });
+    XCTAssertEqual(failures, 0);
+}
+
+@end
@@ -0,0 +1,216 @@
+//
+// Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+
+#import <XCTest/XCTest.h>
+#import <mach/mach.h>
+#import "AWSServiceDefinition.h"
+#import "AWSSTSResources.h"
+#import "AWSCognitoIdentityResources.h"
+
+@interface AWSSTSResources (AWSServiceDefinitionTests)
+
+- (NSString *)definitionString;
+
+@end
+
+@interface AWSCognitoIdentityResources (AWSServiceDefinitionTests)
+
+- (NSString *)definitionString;
+
+@end
+
+@interface AWSServiceDefinitionTests : XCTestCase
+
+@end
+
+@implementation AWSServiceDefinitionTests
+
++ (uint64_t)physicalFootprint {
+    task_vm_info_data_t info;
+    mach_msg_type_number_t count = TASK_VM_INFO_COUNT;
+    if (task_info(mach_task_self(), TASK_VM_INFO, (task_info_t)&info, &count) != KERN_SUCCESS) {
+        return 0;
+    }
+    return info.phys_footprint;
+}
+
+// Reads every operation and shape through the lazy dictionaries and compares them with a full parse.
+- (void)assertDefinitionString:(NSString *)definitionString matchesJSONSerialization:(NSString *)name {
+    NSError *error = nil;
+    NSDictionary *definition = [AWSServiceDefinition definitionWithJSONString:definitionString error:&error];
+    XCTAssertNil(error, @"%@", name);
+    NSDictionary *expectedDefinition = [NSJSONSerialization JSONObjectWithData:[definitionString dataUsingEncoding:NSUTF8StringEncoding]
+                                                                       options:kNilOptions
+                                                                         error:nil];
+    XCTAssertNotNil(expectedDefinition, @"%@", name);
+
+    XCTAssertEqualObjects([NSSet setWithArray:[definition allKeys]], [NSSet setWithArray:[expectedDefinition allKeys]], @"%@", name);
+    for (NSString *key in @[@"operations", @"shapes"]) {
+        NSDictionary *members = definition[key];
+        NSDictionary *expectedMembers = expectedDefinition[key];
+        XCTAssertEqual([members count], [expectedMembers count], @"%@ %@", name, key);
+        for (NSString *memberKey in expectedMembers) {
+            XCTAssertEqualObjects(members[memberKey], expectedMembers[memberKey], @"%@ %@ %@", name, key, memberKey);
+        }
+    }
+    XCTAssertEqualObjects(definition, expectedDefinition, @"%@", name);
+}
+
+- (void)testDefinitionsMatchJSONSerialization {
+    [self assertDefinitionString:[[AWSSTSResources sharedInstance] definitionString] matchesJSONSerialization:@"STS"];
+    [self assertDefinitionString:[[AWSCognitoIdentityResources sharedInstance] definitionString] matchesJSONSerialization:@"CognitoIdentity"];
+}
+
+- (void)testMembersAreParsedOnceAndSurviveCopies {
+    NSDictionary *definition = [AWSServiceDefinition definitionWithJSONString:@"{\"version\":\"2.0\",\"shapes\":{\"String\":{\"type\":\"string\"},\"Escaped\\\"Key\":{\"type\":\"list\",\"member\":{\"shape\":\"String\"}}}}"
+                                                                        error:nil];
+    NSDictionary *shapes = definition[@"shapes"];
+
+    XCTAssertEqualObjects(definition[@"version"], @"2.0");
+    XCTAssertEqual([shapes count], 2);
+    XCTAssertEqualObjects(shapes[@"String"], @{@"type" : @"string"});
+    XCTAssertTrue(shapes[@"String"] == shapes[@"String"]);
+    XCTAssertEqualObjects(shapes[@"Escaped\"Key"][@"member"], @{@"shape" : @"String"});
+    XCTAssertNil(shapes[@"Missing"]);
+    XCTAssertTrue([shapes copy] == shapes);
+}
+
+- (void)testNonASCIIDefinition {
+    NSDictionary *definition = [AWSServiceDefinition definitionWithJSONString:@"{\"operations\":{\"Get\":{\"documentation\":\"caf\u00e9 \u2014 \\u00e9\"}},\"metadata\":{\"serviceFullName\":\"S\u00e9rvice\"}}"
+                                                                        error:nil];
+
+    XCTAssertEqualObjects(definition[@"operations"][@"Get"][@"documentation"], @"caf\u00e9 \u2014 \u00e9");
+    XCTAssertEqualObjects(definition[@"metadata"][@"serviceFullName"], @"S\u00e9rvice");
+}
+
+- (void)testDefinitionOutlivesString {
+    NSDictionary *definition = nil;
+    @autoreleasepool {
+        NSData *JSONData = [@"{\"operations\":{\"Get\":{\"name\":\"Get\"}},\"shapes\":{\"String\":{\"type\":\"string\"}}}" dataUsingEncoding:NSUTF8StringEncoding];
+        NSMutableString *JSONString = [[NSMutableString alloc] initWithData:JSONData encoding:NSUTF8StringEncoding];
+        definition = [AWSServiceDefinition definitionWithJSONString:JSONString error:nil];
+        [JSONString setString:@"{\"operations\":{\"Xxx\":{\"name\":\"Xxx\"}},\"shapes\":{\"Xxxxxx\":{\"type\":\"xxxxxx\"}}}"];
+        JSONString = nil;
+    }
+
+    XCTAssertEqualObjects(definition[@"operations"][@"Get"], @{@"name" : @"Get"});
+    XCTAssertEqualObjects(definition[@"shapes"][@"String"], @{@"type" : @"string"});
+}
+
+- (void)testLookupsInAnyOrder {
+    NSString *JSONString = @"{\"version\":\"2.0\",\"operations\":{\"Get\":{\"name\":\"Get\"},\"Put\":{\"name\":\"Put\"}},\"shapes\":{\"A\":{\"type\":\"string\"},\"B\":{\"type\":\"integer\"}},\"metadata\":{\"protocol\":\"json\"}}";
+    NSDictionary *definition = [AWSServiceDefinition definitionWithJSONString:JSONString error:nil];
+
+    XCTAssertEqualObjects(definition[@"metadata"][@"protocol"], @"json");
+    XCTAssertEqualObjects(definition[@"shapes"][@"B"], @{@"type" : @"integer"});
+    XCTAssertEqualObjects(definition[@"operations"][@"Put"], @{@"name" : @"Put"});
+    XCTAssertEqualObjects(definition[@"shapes"][@"A"], @{@"type" : @"string"});
+    XCTAssertEqualObjects(definition[@"operations"][@"Get"], @{@"name" : @"Get"});
+    XCTAssertEqualObjects(definition[@"version"], @"2.0");
+    XCTAssertNil(definition[@"documentation"]);
+    XCTAssertEqual([definition count], 4);
+}
+
+- (void)testInvalidDefinitions {
+    for (NSString *JSONString in @[@"", @" ", @"[]", @"\"{}\""]) {
+        NSError *error = nil;
+        XCTAssertNil([AWSServiceDefinition definitionWithJSONString:JSONString error:&error], @"%@", JSONString);
+        XCTAssertEqualObjects(error.domain, AWSServiceDefinitionErrorDomain);
+        XCTAssertEqual(error.code, AWSServiceDefinitionErrorInvalidJSON);
+    }
+}
+
+- (void)testInvalidMembersAreMissing {
+    NSDictionary *definition = [AWSServiceDefinition definitionWithJSONString:@"{\"operations\":{\"Get\":{},\"Put\":},\"shapes\":{\"String\":{\"type\":\"string\"},\"Integer\":}}" error:nil];
+    XCTAssertEqualObjects(definition[@"operations"][@"Get"], @{});
+    XCTAssertNil(definition[@"operations"][@"Put"]);
+    XCTAssertEqual([definition[@"operations"] count], 1);
+    XCTAssertEqualObjects(definition[@"shapes"][@"String"], @{@"type" : @"string"});
+    XCTAssertNil(definition[@"shapes"][@"Integer"]);
+
+    definition = [AWSServiceDefinition definitionWithJSONString:@"{\"version\":\"2.0\"" error:nil];
+    XCTAssertEqualObjects(definition[@"version"], @"2.0");
+    XCTAssertNil(definition[@"shapes"]);
+
+    definition = [AWSServiceDefinition definitionWithJSONString:@"{\"version\":\"2.0\"} {}" error:nil];
+    XCTAssertEqualObjects(definition[@"version"], @"2.0");
+    XCTAssertEqual([definition count], 1);
+}
+
+#pragma mark - Performance
+
+// The work before a client's first request: load the definition, then read one operation and its input shape.
+- (void)testColdStartComparison {
+    NSString *definitionString = [[AWSCognitoIdentityResources sharedInstance] definitionString];
+    NSUInteger iterations = 50;
+
+    uint64_t footprint = [AWSServiceDefinitionTests physicalFootprint];
+    NSMutableArray *eagerDefinitions = [NSMutableArray arrayWithCapacity:iterations];
+    CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+    for (NSUInteger i = 0; i < iterations; i++) {
+        NSDictionary *definition = [NSJSONSerialization JSONObjectWithData:[definitionString dataUsingEncoding:NSUTF8StringEncoding]
+                                                                   options:kNilOptions
+                                                                     error:nil];
+        NSString *inputShape = definition[@"operations"][@"GetId"][@"input"][@"shape"];
+        XCTAssertNotNil(definition[@"shapes"][inputShape]);
+        [eagerDefinitions addObject:definition];
+    }
+    CFTimeInterval eagerTime = (CFAbsoluteTimeGetCurrent() - start) / iterations;
+    int64_t eagerFootprint = ((int64_t)[AWSServiceDefinitionTests physicalFootprint] - (int64_t)footprint) / (int64_t)iterations;
+    [eagerDefinitions removeAllObjects];
+
+    footprint = [AWSServiceDefinitionTests physicalFootprint];
+    NSMutableArray *lazyDefinitions = [NSMutableArray arrayWithCapacity:iterations];
+    start = CFAbsoluteTimeGetCurrent();
+    for (NSUInteger i = 0; i < iterations; i++) {
+        NSDictionary *definition = [AWSServiceDefinition definitionWithJSONString:definitionString error:nil];
+        NSString *inputShape = definition[@"operations"][@"GetId"][@"input"][@"shape"];
+        XCTAssertNotNil(definition[@"shapes"][inputShape]);
+        [lazyDefinitions addObject:definition];
+    }
+    CFTimeInterval lazyTime = (CFAbsoluteTimeGetCurrent() - start) / iterations;
+    int64_t lazyFootprint = ((int64_t)[AWSServiceDefinitionTests physicalFootprint] - (int64_t)footprint) / (int64_t)iterations;
+
+    NSLog(@"CognitoIdentity time to first request: %.3f ms eager, %.3f ms lazy; resident memory: %lld KB eager, %lld KB lazy",
+          eagerTime * 1000, lazyTime * 1000, eagerFootprint / 1024, lazyFootprint / 1024);
+}
+
+- (void)testPerformanceLazyDefinition {
+    NSString *definitionString = [[AWSCognitoIdentityResources sharedInstance] definitionString];
+
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 50; i++) {
+            NSDictionary *definition = [AWSServiceDefinition definitionWithJSONString:definitionString error:nil];
+            NSString *inputShape = definition[@"operations"][@"GetId"][@"input"][@"shape"];
+            XCTAssertNotNil(definition[@"shapes"][inputShape]);
+        }
+    }];
+}
+
+- (void)testPerformanceJSONSerializationDefinition {
+    NSString *definitionString = [[AWSCognitoIdentityResources sharedInstance] definitionString];
+
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 50; i++) {
+            NSDictionary *definition = [NSJSONSerialization JSONObjectWithData:[definitionString dataUsingEncoding:NSUTF8StringEncoding]
+                                                                       options:kNilOptions
+                                                                         error:nil];
+            NSString *inputShape = definition[@"operations"][@"GetId"][@"input"][@"shape"];
+            XCTAssertNotNil(definition[@"shapes"][inputShape]);
+        }
+    }];
+}
+
+@end
@@ -0,0 +1,244 @@
+//
+// Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+
+#import <XCTest/XCTest.h>
+#import "AWSCore.h"
+#import "AWSSignature.h"
+
+// Credentials, scope and date of the AWS Signature Version 4 test suite.
+static NSString *const AWSSignatureV4TestSuiteAccessKey = @"AKIDEXAMPLE";
+static NSString *const AWSSignatureV4TestSuiteSecretKey = @"wJalrXUtnFEMI/K7MDENG+bPxRfiCYEXAMPLEKEY";
+static NSString *const AWSSignatureV4TestSuiteDate = @"20150830T123600Z";
+static NSString *const AWSSignatureV4TestSuiteCredential = @"AKIDEXAMPLE/20150830/us-east-1/service/aws4_request";
+static NSString *const AWSSignatureV4TestSuiteFormBody = @"Param1=value1";
+static NSString *const AWSSignatureV4TestSuiteFormSignature = @"ff11897932ad3f4e8b18135d722051e5ac45fc38421b1da7b9d196a0fe09473a";
+
+@interface AWSSignatureV4TestSuiteTests : XCTestCase
+
+@property (nonatomic, strong) AWSSignatureV4Signer *signer;
+
+@end
+
+@implementation AWSSignatureV4TestSuiteTests
+
+- (void)setUp {
+    [super setUp];
+    AWSStaticCredentialsProvider *credentialsProvider = [[AWSStaticCredentialsProvider alloc] initWithAccessKey:AWSSignatureV4TestSuiteAccessKey
+                                                                                                      secretKey:AWSSignatureV4TestSuiteSecretKey];
+    AWSEndpoint *endpoint = [[AWSEndpoint alloc] initWithRegion:AWSRegionUSEast1
+                                                    serviceName:@"service"
+                                                            URL:[NSURL URLWithString:@"https://example.amazonaws.com"]];
+    self.signer = [[AWSSignatureV4Signer alloc] initWithCredentialsProvider:credentialsProvider
+                                                                   endpoint:endpoint];
+}
+
+- (NSMutableURLRequest *)requestWithMethod:(NSString *)method URLString:(NSString *)URLString {
+    NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:[NSURL URLWithString:URLString]];
+    request.HTTPMethod = method;
+    [request setValue:AWSSignatureV4TestSuiteDate forHTTPHeaderField:@"X-Amz-Date"];
+    return request;
+}
+
+- (NSMutableURLRequest *)formRequest {
+    NSMutableURLRequest *request = [self requestWithMethod:@"POST" URLString:@"https://example.amazonaws.com/"];
+    [request setValue:@"application/x-www-form-urlencoded" forHTTPHeaderField:@"Content-Type"];
+    return request;
+}
+
+- (NSString *)authorizationForRequest:(NSMutableURLRequest *)request {
+    AWSTask *task = [self.signer interceptRequest:request];
+    [task waitUntilFinished];
+    XCTAssertNil(task.error);
+    return [request valueForHTTPHeaderField:@"Authorization"];
+}
+
+- (NSString *)expectedAuthorizationWithSignedHeaders:(NSString *)signedHeaders signature:(NSString *)signature {
+    return [NSString stringWithFormat:@"AWS4-HMAC-SHA256 Credential=%@, SignedHeaders=%@, Signature=%@",
+            AWSSignatureV4TestSuiteCredential, signedHeaders, signature];
+}
+
+- (NSData *)dataFromStream:(NSInputStream *)stream {
+    NSMutableData *data = [NSMutableData new];
+    uint8_t buffer[1024];
+    [stream open];
+    NSInteger bytesRead;
+    while ((bytesRead = [stream read:buffer maxLength:sizeof(buffer)]) > 0) {
+        [data appendBytes:buffer length:bytesRead];
+    }
+    [stream close];
+    return data;
+}
+
+#pragma mark - Test suite vectors
+
+- (void)testGetVanilla {
+    NSMutableURLRequest *request = [self requestWithMethod:@"GET" URLString:@"https://example.amazonaws.com/"];
+    XCTAssertEqualObjects([self authorizationForRequest:request],
+                          [self expectedAuthorizationWithSignedHeaders:@"host;x-amz-date"
+                                                             signature:@"5fa00fa31553b73ebf1942676e86291e8372ff2a2260956d9b8aae1d763fbf31"]);
+}
+
+- (void)testGetVanillaQueryOrderKeyCase {
+    NSMutableURLRequest *request = [self requestWithMethod:@"GET" URLString:@"https://example.amazonaws.com/?Param2=value2&Param1=value1"];
+    XCTAssertEqualObjects([self authorizationForRequest:request],
+                          [self expectedAuthorizationWithSignedHeaders:@"host;x-amz-date"
+                                                             signature:@"b97d918cfa904a5beff61c982a1b6f458b799221646efd99d3219ec94cdf2500"]);
+}
+
+- (void)testPostVanilla {
+    NSMutableURLRequest *request = [self requestWithMethod:@"POST" URLString:@"https://example.amazonaws.com/"];
+    XCTAssertEqualObjects([self authorizationForRequest:request],
+                          [self expectedAuthorizationWithSignedHeaders:@"host;x-amz-date"
+                                                             signature:@"5da7c1a2acd57cee7505fc6676e4e544621c30862966e37dddb68e92efbe5d6b"]);
+}
+
+- (void)testPostXWWWFormURLEncoded {
+    NSMutableURLRequest *request = [self formRequest];
+    request.HTTPBody = [AWSSignatureV4TestSuiteFormBody dataUsingEncoding:NSUTF8StringEncoding];
+    XCTAssertEqualObjects([self authorizationForRequest:request],
+                          [self expectedAuthorizationWithSignedHeaders:@"content-type;host;x-amz-date"
+                                                             signature:AWSSignatureV4TestSuiteFormSignature]);
+}
+
+#pragma mark - Streamed payloads
+
+- (void)testStreamedPayloadFromData {
+    NSData *body = [AWSSignatureV4TestSuiteFormBody dataUsingEncoding:NSUTF8StringEncoding];
+    NSMutableURLRequest *request = [self formRequest];
+    NSInputStream *stream = [NSInputStream inputStreamWithData:body];
+    request.HTTPBodyStream = stream;
+    [NSURLProtocol setProperty:body forKey:AWSSignatureV4PayloadSourceKey inRequest:request];
+
+    XCTAssertEqualObjects([self authorizationForRequest:request],
+                          [self expectedAuthorizationWithSignedHeaders:@"content-type;host;x-amz-date"
+                                                             signature:AWSSignatureV4TestSuiteFormSignature]);
+    XCTAssertEqual(request.HTTPBodyStream, stream);
+    XCTAssertEqual(stream.streamStatus, NSStreamStatusNotOpen);
+    XCTAssertEqualObjects([request valueForHTTPHeaderField:@"Content-Length"], @"13");
+}
+
+- (void)testStreamedPayloadFromFile {
+    NSURL *fileURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]]];
+    XCTAssertTrue([[AWSSignatureV4TestSuiteFormBody dataUsingEncoding:NSUTF8StringEncoding] writeToURL:fileURL atomically:YES]);
+
+    NSMutableURLRequest *request = [self formRequest];
+    NSInputStream *stream = [NSInputStream inputStreamWithURL:fileURL];
+    request.HTTPBodyStream = stream;
+    [NSURLProtocol setProperty:[fileURL path] forKey:AWSSignatureV4PayloadSourceKey inRequest:request];
+
+    XCTAssertEqualObjects([self authorizationForRequest:request],
+                          [self expectedAuthorizationWithSignedHeaders:@"content-type;host;x-amz-date"
+                                                             signature:AWSSignatureV4TestSuiteFormSignature]);
+    XCTAssertEqual(request.HTTPBodyStream, stream);
+    XCTAssertEqualObjects([request valueForHTTPHeaderField:@"Content-Length"], @"13");
+
+    [[NSFileManager defaultManager] removeItemAtURL:fileURL error:nil];
+}
+
+- (void)testStreamedPayloadFromFileFailsWhenFileIsMissing {
+    NSMutableURLRequest *request = [self formRequest];
+    NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+    request.HTTPBodyStream = [NSInputStream inputStreamWithFileAtPath:path];
+    [NSURLProtocol setProperty:path forKey:AWSSignatureV4PayloadSourceKey inRequest:request];
+
+    AWSTask *task = [self.signer interceptRequest:request];
+    [task waitUntilFinished];
+    XCTAssertNotNil(task.error);
+    XCTAssertNil([request valueForHTTPHeaderField:@"Authorization"]);
+}
+
+- (void)testStreamedPayloadWithoutSourceIsReadOnce {
+    NSMutableURLRequest *request = [self formRequest];
+    request.HTTPBodyStream = [NSInputStream inputStreamWithData:[AWSSignatureV4TestSuiteFormBody dataUsingEncoding:NSUTF8StringEncoding]];
+
+    XCTAssertEqualObjects([self authorizationForRequest:request],
+                          [self expectedAuthorizationWithSignedHeaders:@"content-type;host;x-amz-date"
+                                                             signature:AWSSignatureV4TestSuiteFormSignature]);
+    XCTAssertEqualObjects([self dataFromStream:request.HTTPBodyStream],
+                          [AWSSignatureV4TestSuiteFormBody dataUsingEncoding:NSUTF8StringEncoding]);
+}
+
+- (void)testStreamedPayloadUnsigned {
+    self.signer.allowsUnsignedPayload = YES;
+    NSMutableURLRequest *request = [self requestWithMethod:@"POST" URLString:@"https://example.amazonaws.com/"];
+    NSInputStream *stream = [NSInputStream inputStreamWithData:[NSData data]];
+    request.HTTPBodyStream = stream;
+
+    XCTAssertEqualObjects([self authorizationForRequest:request],
+                          [self expectedAuthorizationWithSignedHeaders:@"host;x-amz-content-sha256;x-amz-date"
+                                                             signature:@"05e1b307416f2cbcf15dd86269efd55537182ee4416101af58762e96bba470bb"]);
+    XCTAssertEqualObjects([request valueForHTTPHeaderField:@"x-amz-content-sha256"], AWSSignatureV4UnsignedPayload);
+    XCTAssertEqual(request.HTTPBodyStream, stream);
+    XCTAssertEqual(stream.streamStatus, NSStreamStatusNotOpen);
+}
+
+#pragma mark - Hashing and hex encoding
+
+- (void)testHashOfEmptyPayload {
+    XCTAssertEqualObjects([AWSSignatureSignerUtility hexEncodeData:[AWSSignatureSignerUtility hash:[NSData data]]],
+                          @"e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+    XCTAssertEqualObjects([AWSSignatureSignerUtility hexEncodeData:[AWSSignatureSignerUtility hash:nil]],
+                          @"e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+}
+
+- (void)testHashStreamMatchesHash {
+    NSMutableData *payload = [NSMutableData new];
+    for (NSUInteger i = 0; i < 4096; i++) {
+        for (NSUInteger byte = 0; byte < 256; byte++) {
+            uint8_t value = (uint8_t)byte;
+            [payload appendBytes:&value length:1];
+        }
+    }
+
+    NSError *error = nil;
+    NSData *streamHash = [AWSSignatureSignerUtility hashStream:[NSInputStream inputStreamWithData:payload] error:&error];
+    XCTAssertNil(error);
+    XCTAssertEqualObjects(streamHash, [AWSSignatureSignerUtility hash:payload]);
+    XCTAssertEqualObjects([AWSSignatureSignerUtility hexEncodeData:streamHash],
+                          @"fbbab289f7f94b25736c58be46a994c441fd02552cc6022352e3d86d2fab7c83");
+}
+
+- (void)testHexEncodeDataMatchesHexEncode {
+    uint8_t bytes[256];
+    for (NSUInteger i = 0; i < 256; i++) {
+        bytes[i] = (uint8_t)i;
+    }
+    NSData *data = [NSData dataWithBytes:bytes length:sizeof(bytes)];
+    NSString *hex = [AWSSignatureSignerUtility hexEncodeData:data];
+
+    XCTAssertEqual([hex length], 512);
+    XCTAssertTrue([hex hasPrefix:@"000102030405060708090a0b0c0d0e0f10"]);
+    XCTAssertTrue([hex hasSuffix:@"fcfdfeff"]);
+    XCTAssertEqualObjects([AWSSignatureSignerUtility hexEncode:[[NSString alloc] initWithData:data encoding:NSISOLatin1StringEncoding]], hex);
+    XCTAssertEqualObjects([AWSSignatureSignerUtility hexEncodeData:[NSData data]], @"");
+}
+
+- (void)testHashFilePerformance {
+    NSURL *fileURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]]];
+    NSMutableData *payload = [NSMutableData dataWithLength:32 * 1024 * 1024];
+    arc4random_buf([payload mutableBytes], [payload length]);
+    XCTAssertTrue([payload writeToURL:fileURL atomically:YES]);
+    NSData *expectedHash = [AWSSignatureSignerUtility hash:payload];
+
+    [self measureBlock:^{
+        NSError *error = nil;
+        XCTAssertEqualObjects([AWSSignatureSignerUtility hashFileAtURL:fileURL error:&error], expectedHash);
+        XCTAssertNil(error);
+    }];
+
+    [[NSFileManager defaultManager] removeItemAtURL:fileURL error:nil];
+}
+
+@end
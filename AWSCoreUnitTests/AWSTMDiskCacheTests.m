@@ -0,0 +1,228 @@
+//
+// Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+
+#import <XCTest/XCTest.h>
+#import "AWSTMDiskCache.h"
+#import "AWSFMDB.h"
+
+static NSUInteger const AWSTMDiskCacheTestsEntryCount = 10000;
+static NSString *const AWSTMDiskCacheTestsName = @"AWSTMDiskCacheTests";
+static NSString *const AWSTMDiskCacheTestsIndexName = @".AWSTMDiskCacheIndex.sqlite";
+
+@interface AWSTMDiskCacheTests : XCTestCase
+
+@property (nonatomic, strong) NSString *rootPath;
+
+@end
+
+@implementation AWSTMDiskCacheTests
+
++ (NSString *)temporaryRootPath {
+    return [NSTemporaryDirectory() stringByAppendingPathComponent:[NSString stringWithFormat:@"%@-%@", AWSTMDiskCacheTestsName, [[NSUUID UUID] UUIDString]]];
+}
+
+// A cache directory holding AWSTMDiskCacheTestsEntryCount small objects, built once and copied by the benchmarks.
++ (NSString *)populatedRootPath {
+    static NSString *rootPath = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        rootPath = [self temporaryRootPath];
+        AWSTMDiskCache *cache = [[AWSTMDiskCache alloc] initWithName:AWSTMDiskCacheTestsName rootPath:rootPath];
+        for (NSUInteger i = 0; i < AWSTMDiskCacheTestsEntryCount; i++) {
+            NSDictionary *object = @{@"bucket" : @"bucket",
+                                     @"key" : [NSString stringWithFormat:@"folder/object-%lu", (unsigned long)i],
+                                     @"uploadId" : [[NSUUID UUID] UUIDString]};
+            [cache setObject:object forKey:[NSString stringWithFormat:@"request-%lu", (unsigned long)i] block:nil];
+        }
+        [AWSTMDiskCacheTests waitForCache];
+    });
+    return rootPath;
+}
+
+// Every cache works on the shared serial queue, so an empty synchronous block waits for all queued work.
++ (void)waitForCache {
+    dispatch_sync([AWSTMDiskCache sharedQueue], ^{});
+}
+
+- (void)setUp {
+    [super setUp];
+    self.rootPath = [AWSTMDiskCacheTests temporaryRootPath];
+}
+
+- (void)tearDown {
+    [AWSTMDiskCacheTests waitForCache];
+    [[NSFileManager defaultManager] removeItemAtPath:self.rootPath error:nil];
+    [super tearDown];
+}
+
+- (AWSTMDiskCache *)cache {
+    return [[AWSTMDiskCache alloc] initWithName:AWSTMDiskCacheTestsName rootPath:self.rootPath];
+}
+
+- (NSArray<NSString *> *)keysOfCache:(AWSTMDiskCache *)cache {
+    NSMutableArray<NSString *> *keys = [NSMutableArray new];
+    [cache enumerateObjectsWithBlock:^(AWSTMDiskCache *cache, NSString *key, id<NSCoding> object, NSURL *fileURL) {
+        [keys addObject:key];
+    }];
+    return keys;
+}
+
+- (void)testIndexSurvivesRelaunch {
+    AWSTMDiskCache *cache = [self cache];
+    [cache setObject:@"one" forKey:@"a"];
+    [cache setObject:@"two" forKey:@"b"];
+    [cache setObject:@"three" forKey:@"c"];
+    [cache objectForKey:@"a"];
+    NSUInteger byteCount = cache.byteCount;
+    XCTAssertGreaterThan(byteCount, 0);
+
+    AWSTMDiskCache *relaunchedCache = [self cache];
+    [AWSTMDiskCacheTests waitForCache];
+
+    XCTAssertEqual(relaunchedCache.byteCount, byteCount);
+    NSArray<NSString *> *expectedKeys = @[@"b", @"c", @"a"];
+    XCTAssertEqualObjects([self keysOfCache:relaunchedCache], expectedKeys);
+    XCTAssertEqualObjects([relaunchedCache objectForKey:@"b"], @"two");
+}
+
+- (void)testInterruptedWritesAreReconciledOnLaunch {
+    AWSTMDiskCache *cache = [self cache];
+    [cache setObject:@"one" forKey:@"a"];
+    NSUInteger byteCount = cache.byteCount;
+
+    // As if the app stopped while writing "a" again and while writing "b" for the first time.
+    AWSFMDatabase *index = [AWSFMDatabase databaseWithPath:[[cache.cacheURL path] stringByAppendingPathComponent:AWSTMDiskCacheTestsIndexName]];
+    XCTAssertTrue([index open]);
+    XCTAssertTrue([index executeUpdate:@"UPDATE entries SET byte_count = NULL WHERE key = 'a'"]);
+    XCTAssertTrue([index executeUpdate:@"INSERT INTO entries (key, byte_count, access_date, type) VALUES ('b', NULL, ?, 'NSString')", [NSDate date]]);
+    [index close];
+
+    AWSTMDiskCache *relaunchedCache = [self cache];
+    [AWSTMDiskCacheTests waitForCache];
+
+    XCTAssertEqual(relaunchedCache.byteCount, byteCount);
+    XCTAssertEqualObjects([self keysOfCache:relaunchedCache], @[@"a"]);
+    XCTAssertEqualObjects([relaunchedCache objectForKey:@"a"], @"one");
+}
+
+- (void)testCacheWithoutIndexIsIndexedFromItsFiles {
+    AWSTMDiskCache *cache = [self cache];
+    [cache setObject:@"one" forKey:@"a"];
+    [cache setObject:@2 forKey:@"b"];
+    NSUInteger byteCount = cache.byteCount;
+    [AWSTMDiskCacheTests waitForCache];
+
+    NSArray<NSString *> *files = [[NSFileManager defaultManager] contentsOfDirectoryAtPath:[cache.cacheURL path] error:nil];
+    for (NSString *file in files) {
+        if ([file hasPrefix:AWSTMDiskCacheTestsIndexName]) {
+            XCTAssertTrue([[NSFileManager defaultManager] removeItemAtPath:[[cache.cacheURL path] stringByAppendingPathComponent:file] error:nil]);
+        }
+    }
+
+    AWSTMDiskCache *relaunchedCache = [self cache];
+    [AWSTMDiskCacheTests waitForCache];
+
+    XCTAssertEqual(relaunchedCache.byteCount, byteCount);
+    XCTAssertEqualObjects([NSSet setWithArray:[self keysOfCache:relaunchedCache]], ([NSSet setWithObjects:@"a", @"b", nil]));
+    // The classes of objects written before the index existed are unknown, so they are always returned.
+    XCTAssertEqual([[relaunchedCache keysForObjectsOfClasses:@[[NSNumber class]]] count], 2);
+}
+
+- (void)testKeysForObjectsOfClasses {
+    AWSTMDiskCache *cache = [self cache];
+    [cache setObject:@"one" forKey:@"string"];
+    [cache setObject:@2 forKey:@"number"];
+    [cache setObject:[NSMutableArray arrayWithObject:@"three"] forKey:@"array"];
+
+    XCTAssertEqualObjects([cache keysForObjectsOfClasses:@[[NSNumber class]]], @[@"number"]);
+    NSArray<NSString *> *expectedKeys = @[@"string", @"array"];
+    XCTAssertEqualObjects([cache keysForObjectsOfClasses:(@[[NSString class], [NSArray class]])], expectedKeys);
+    XCTAssertEqualObjects([cache keysForObjectsOfClasses:@[[NSDate class]]], @[]);
+}
+
+- (void)testTrimToSizeByDateRemovesLeastRecentlyUsed {
+    AWSTMDiskCache *cache = [self cache];
+    for (NSUInteger i = 0; i < 10; i++) {
+        [cache setObject:@(i) forKey:[NSString stringWithFormat:@"%lu", (unsigned long)i]];
+    }
+    [cache objectForKey:@"0"];
+    NSUInteger byteCount = cache.byteCount;
+
+    [cache trimToSizeByDate:byteCount / 2];
+
+    XCTAssertLessThanOrEqual(cache.byteCount, byteCount / 2);
+    NSArray<NSString *> *keys = [self keysOfCache:cache];
+    XCTAssertEqualObjects([keys lastObject], @"0");
+    XCTAssertFalse([keys containsObject:@"1"]);
+    XCTAssertNil([cache objectForKey:@"1"]);
+}
+
+- (void)testRemoveAllObjectsResetsIndex {
+    AWSTMDiskCache *cache = [self cache];
+    [cache setObject:@"one" forKey:@"a"];
+    [cache removeAllObjects];
+
+    XCTAssertEqual(cache.byteCount, 0);
+    XCTAssertEqualObjects([self keysOfCache:cache], @[]);
+
+    [cache setObject:@"two" forKey:@"b"];
+    AWSTMDiskCache *relaunchedCache = [self cache];
+    [AWSTMDiskCacheTests waitForCache];
+    XCTAssertEqualObjects([self keysOfCache:relaunchedCache], @[@"b"]);
+}
+
+#pragma mark - Performance
+
+- (void)copyPopulatedCache {
+    [[NSFileManager defaultManager] removeItemAtPath:self.rootPath error:nil];
+    XCTAssertTrue([[NSFileManager defaultManager] copyItemAtPath:[AWSTMDiskCacheTests populatedRootPath] toPath:self.rootPath error:nil]);
+}
+
+- (void)testPerformanceColdStart {
+    [self copyPopulatedCache];
+
+    [self measureBlock:^{
+        AWSTMDiskCache *cache = [self cache];
+        [AWSTMDiskCacheTests waitForCache];
+        XCTAssertGreaterThan(cache.byteCount, 0);
+    }];
+}
+
+- (void)testPerformanceEnumeration {
+    [self copyPopulatedCache];
+    AWSTMDiskCache *cache = [self cache];
+    [AWSTMDiskCacheTests waitForCache];
+
+    [self measureBlock:^{
+        XCTAssertEqual([[self keysOfCache:cache] count], AWSTMDiskCacheTestsEntryCount);
+    }];
+}
+
+- (void)testPerformanceTrimToSizeByDate {
+    [self measureMetrics:[[self class] defaultPerformanceMetrics] automaticallyStartMeasuring:NO forBlock:^{
+        [self copyPopulatedCache];
+        AWSTMDiskCache *cache = [self cache];
+        [AWSTMDiskCacheTests waitForCache];
+        NSUInteger byteCount = cache.byteCount;
+
+        [self startMeasuring];
+        [cache trimToSizeByDate:byteCount * 9 / 10];
+        [self stopMeasuring];
+
+        XCTAssertLessThanOrEqual(cache.byteCount, byteCount * 9 / 10);
+    }];
+}
+
+@end
@@ -0,0 +1,313 @@
+//
+// Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+
+#import <XCTest/XCTest.h>
+#import "AWSTMMemoryCache.h"
+
+static NSUInteger const AWSTMMemoryCacheTestsKeyCount = 10000;
+static NSUInteger const AWSTMMemoryCacheTestsOperationCount = 200000;
+
+@interface AWSTMMemoryCacheTests : XCTestCase
+
+@end
+
+@implementation AWSTMMemoryCacheTests
+
++ (NSArray<NSString *> *)keysWithCount:(NSUInteger)count {
+    NSMutableArray<NSString *> *keys = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger i = 0; i < count; i++) {
+        [keys addObject:[NSString stringWithFormat:@"key-%lu", (unsigned long)i]];
+    }
+    return keys;
+}
+
+- (void)testCostLimitEvictsLeastRecentlyUsed {
+    AWSTMMemoryCache *cache = [AWSTMMemoryCache new];
+    cache.costLimit = 3;
+
+    // Shards are compared by access time, so keep the accesses apart.
+    [cache setObject:@"a" forKey:@"a" withCost:1];
+    [NSThread sleepForTimeInterval:0.001];
+    [cache setObject:@"b" forKey:@"b" withCost:1];
+    [NSThread sleepForTimeInterval:0.001];
+    [cache setObject:@"c" forKey:@"c" withCost:1];
+    [NSThread sleepForTimeInterval:0.001];
+    XCTAssertEqualObjects([cache objectForKey:@"a"], @"a"); // b is now the least recently used
+    [NSThread sleepForTimeInterval:0.001];
+    [cache setObject:@"d" forKey:@"d" withCost:1];
+
+    XCTAssertNil([cache objectForKey:@"b"]);
+    XCTAssertEqualObjects([cache objectForKey:@"a"], @"a");
+    XCTAssertEqualObjects([cache objectForKey:@"c"], @"c");
+    XCTAssertEqualObjects([cache objectForKey:@"d"], @"d");
+    XCTAssertEqual(cache.totalCost, 3);
+}
+
+- (void)testReplacingAnObjectReplacesItsCost {
+    AWSTMMemoryCache *cache = [AWSTMMemoryCache new];
+
+    [cache setObject:@"a" forKey:@"a" withCost:5];
+    [cache setObject:@"a2" forKey:@"a" withCost:2];
+    XCTAssertEqual(cache.totalCost, 2);
+    XCTAssertEqualObjects([cache objectForKey:@"a"], @"a2");
+
+    [cache removeObjectForKey:@"a"];
+    XCTAssertEqual(cache.totalCost, 0);
+    XCTAssertNil([cache objectForKey:@"a"]);
+}
+
+- (void)testTrimToDateKeepsRecentlyReadObjects {
+    AWSTMMemoryCache *cache = [AWSTMMemoryCache new];
+    NSArray<NSString *> *keys = [AWSTMMemoryCacheTests keysWithCount:100];
+    for (NSString *key in keys) {
+        [cache setObject:key forKey:key];
+    }
+
+    [NSThread sleepForTimeInterval:0.05];
+    NSDate *trimDate = [NSDate date];
+    for (NSUInteger i = 0; i < [keys count]; i += 10) {
+        [cache objectForKey:keys[i]];
+    }
+    [cache trimToDate:trimDate];
+
+    __block NSUInteger count = 0;
+    [cache enumerateObjectsWithBlock:^(AWSTMMemoryCache *cache, NSString *key, id object) {
+        count++;
+    }];
+    XCTAssertEqual(count, 10);
+    for (NSUInteger i = 0; i < [keys count]; i++) {
+        if (i % 10 == 0) {
+            XCTAssertEqualObjects([cache objectForKey:keys[i]], keys[i]);
+        } else {
+            XCTAssertNil([cache objectForKey:keys[i]]);
+        }
+    }
+}
+
+- (void)testTrimToCostRemovesCostliestFirst {
+    AWSTMMemoryCache *cache = [AWSTMMemoryCache new];
+    [cache setObject:@"small" forKey:@"small" withCost:1];
+    [cache setObject:@"large" forKey:@"large" withCost:10];
+    [cache setObject:@"medium" forKey:@"medium" withCost:5];
+    [cache objectForKey:@"large"]; // medium is now the least recently used
+
+    [cache trimToCost:6];
+
+    XCTAssertNil([cache objectForKey:@"large"]);
+    XCTAssertNotNil([cache objectForKey:@"medium"]);
+    XCTAssertNotNil([cache objectForKey:@"small"]);
+    XCTAssertEqual(cache.totalCost, 6);
+
+    [cache trimToCost:1];
+
+    XCTAssertNil([cache objectForKey:@"medium"]);
+    XCTAssertNotNil([cache objectForKey:@"small"]);
+    XCTAssertEqual(cache.totalCost, 1);
+}
+
+- (void)testTrimToCostUsesReplacedCosts {
+    AWSTMMemoryCache *cache = [AWSTMMemoryCache new];
+    NSArray<NSString *> *keys = [AWSTMMemoryCacheTests keysWithCount:100];
+    for (NSUInteger i = 0; i < [keys count]; i++) {
+        [cache setObject:keys[i] forKey:keys[i] withCost:i + 1];
+    }
+    [cache setObject:keys[99] forKey:keys[99] withCost:1];
+    [cache setObject:keys[0] forKey:keys[0] withCost:1000];
+
+    [cache trimToCost:cache.totalCost - 1000];
+
+    XCTAssertNil([cache objectForKey:keys[0]]);
+    XCTAssertNotNil([cache objectForKey:keys[98]]);
+    XCTAssertNotNil([cache objectForKey:keys[99]]);
+
+    [cache trimToCost:cache.totalCost - 99];
+
+    XCTAssertNil([cache objectForKey:keys[98]]);
+    XCTAssertNotNil([cache objectForKey:keys[99]]);
+    XCTAssertNotNil([cache objectForKey:keys[97]]);
+}
+
+- (void)testEventBlocksMayUseTheCache {
+    AWSTMMemoryCache *cache = [AWSTMMemoryCache new];
+    NSMutableArray<NSString *> *removedKeys = [NSMutableArray new];
+    cache.willAddObjectBlock = ^(AWSTMMemoryCache *cache, NSString *key, id object) {
+        [cache objectForKey:key];
+    };
+    cache.didAddObjectBlock = ^(AWSTMMemoryCache *cache, NSString *key, id object) {
+        [cache objectForKey:key];
+    };
+    cache.willRemoveObjectBlock = ^(AWSTMMemoryCache *cache, NSString *key, id object) {
+        XCTAssertEqualObjects([cache objectForKey:key], object);
+    };
+    cache.didRemoveObjectBlock = ^(AWSTMMemoryCache *cache, NSString *key, id object) {
+        [removedKeys addObject:key];
+        XCTAssertNil([cache objectForKey:key]);
+        [cache setObject:@"tombstone" forKey:[key stringByAppendingString:@"-removed"]];
+    };
+
+    [cache setObject:@"a" forKey:@"a" withCost:1];
+    [cache setObject:@"b" forKey:@"b" withCost:2];
+    [cache removeObjectForKey:@"a"];
+    [cache trimToCost:0];
+
+    XCTAssertEqualObjects(removedKeys, (@[@"a", @"b"]));
+    XCTAssertEqualObjects([cache objectForKey:@"a-removed"], @"tombstone");
+    XCTAssertEqualObjects([cache objectForKey:@"b-removed"], @"tombstone");
+}
+
+- (void)testEnumerationIsOrderedByDate {
+    AWSTMMemoryCache *cache = [AWSTMMemoryCache new];
+    NSArray<NSString *> *keys = [AWSTMMemoryCacheTests keysWithCount:40];
+    NSMutableArray<NSString *> *expectedKeys = [NSMutableArray new];
+
+    // Shards are merged by access time, so keep the accesses apart.
+    for (NSString *key in keys) {
+        [cache setObject:key forKey:key];
+        [NSThread sleepForTimeInterval:0.001];
+    }
+    for (NSUInteger i = 0; i < [keys count]; i += 2) {
+        [expectedKeys addObject:keys[i + 1]];
+    }
+    for (NSUInteger i = 0; i < [keys count]; i += 2) {
+        [cache objectForKey:keys[i]];
+        [NSThread sleepForTimeInterval:0.001];
+        [expectedKeys addObject:keys[i]];
+    }
+
+    NSMutableArray<NSString *> *enumeratedKeys = [NSMutableArray new];
+    [cache enumerateObjectsWithBlock:^(AWSTMMemoryCache *cache, NSString *key, id object) {
+        [enumeratedKeys addObject:key];
+    }];
+    XCTAssertEqualObjects(enumeratedKeys, expectedKeys);
+}
+
+- (void)testEnumerationAndEventBlocks {
+    AWSTMMemoryCache *cache = [AWSTMMemoryCache new];
+    __block NSUInteger removedCount = 0;
+    cache.didRemoveObjectBlock = ^(AWSTMMemoryCache *cache, NSString *key, id object) {
+        removedCount++;
+    };
+
+    NSArray<NSString *> *keys = [AWSTMMemoryCacheTests keysWithCount:50];
+    for (NSString *key in keys) {
+        [cache setObject:key forKey:key];
+    }
+
+    NSMutableSet<NSString *> *enumeratedKeys = [NSMutableSet new];
+    [cache enumerateObjectsWithBlock:^(AWSTMMemoryCache *cache, NSString *key, id object) {
+        XCTAssertEqualObjects(key, object);
+        [enumeratedKeys addObject:key];
+    }];
+    XCTAssertEqualObjects(enumeratedKeys, [NSSet setWithArray:keys]);
+
+    [cache trimToCostByDate:0];
+    XCTAssertEqual(removedCount, 0); // objects without a cost never push the total over a limit
+
+    for (NSString *key in keys) {
+        [cache removeObjectForKey:key];
+    }
+    XCTAssertEqual(removedCount, [keys count]);
+}
+
+- (void)testConcurrentAccessKeepsCostConsistent {
+    AWSTMMemoryCache *cache = [AWSTMMemoryCache new];
+    cache.costLimit = 500;
+    NSArray<NSString *> *keys = [AWSTMMemoryCacheTests keysWithCount:1000];
+
+    dispatch_apply(8, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t thread) {
+        for (NSUInteger i = 0; i < 20000; i++) {
+            NSString *key = keys[arc4random_uniform((uint32_t)[keys count])];
+            switch (i % 4) {
+                case 0:
+                    [cache setObject:key forKey:key withCost:1 + i % 3];
+                    break;
+                case 1:
+                    [cache removeObjectForKey:key];
+                    break;
+                default:
+                    [cache objectForKey:key];
+                    break;
+            }
+        }
+    });
+
+    // Every object costs one to three.
+    __block NSUInteger count = 0;
+    [cache enumerateObjectsWithBlock:^(AWSTMMemoryCache *cache, NSString *key, id object) {
+        count++;
+    }];
+    XCTAssertLessThanOrEqual(cache.totalCost, 500);
+    XCTAssertGreaterThanOrEqual(cache.totalCost, count);
+    XCTAssertLessThanOrEqual(cache.totalCost, 3 * count);
+}
+
+#pragma mark - Performance
+
+// Runs a read-mostly workload (one write per eight operations) on the given number of threads and
+// returns the operations per second. With sharded locks the rate should grow with the thread count.
+- (double)operationsPerSecondOnCache:(AWSTMMemoryCache *)cache keys:(NSArray<NSString *> *)keys threadCount:(NSUInteger)threadCount {
+    NSUInteger operationsPerThread = AWSTMMemoryCacheTestsOperationCount / threadCount;
+    CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+    dispatch_apply(threadCount, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_HIGH, 0), ^(size_t thread) {
+        uint32_t seed = (uint32_t)thread * 2654435761u + 1;
+        for (NSUInteger i = 0; i < operationsPerThread; i++) {
+            seed = seed * 1664525u + 1013904223u;
+            NSString *key = keys[seed % [keys count]];
+            if (i % 8 == 0) {
+                [cache setObject:key forKey:key withCost:1];
+            } else {
+                [cache objectForKey:key];
+            }
+        }
+    });
+    return (double)(operationsPerThread * threadCount) / (CFAbsoluteTimeGetCurrent() - start);
+}
+
+- (void)testContentionScaling {
+    AWSTMMemoryCache *cache = [AWSTMMemoryCache new];
+    cache.costLimit = AWSTMMemoryCacheTestsKeyCount / 2; // keeps the eviction path busy
+    NSArray<NSString *> *keys = [AWSTMMemoryCacheTests keysWithCount:AWSTMMemoryCacheTestsKeyCount];
+
+    NSUInteger processorCount = [[NSProcessInfo processInfo] activeProcessorCount];
+    for (NSUInteger threadCount = 1; threadCount <= MAX(processorCount, 1); threadCount *= 2) {
+        double rate = [self operationsPerSecondOnCache:cache keys:keys threadCount:threadCount];
+        NSLog(@"AWSTMMemoryCache: %lu threads, %.0f operations per second", (unsigned long)threadCount, rate);
+    }
+}
+
+- (void)testPerformanceContendedReadsAndWrites {
+    AWSTMMemoryCache *cache = [AWSTMMemoryCache new];
+    cache.costLimit = AWSTMMemoryCacheTestsKeyCount / 2;
+    NSArray<NSString *> *keys = [AWSTMMemoryCacheTests keysWithCount:AWSTMMemoryCacheTestsKeyCount];
+    NSUInteger threadCount = MAX([[NSProcessInfo processInfo] activeProcessorCount], 2);
+
+    [self measureBlock:^{
+        [self operationsPerSecondOnCache:cache keys:keys threadCount:threadCount];
+    }];
+}
+
+- (void)testPerformanceEvictionByDate {
+    NSArray<NSString *> *keys = [AWSTMMemoryCacheTests keysWithCount:AWSTMMemoryCacheTestsKeyCount * 5];
+
+    [self measureBlock:^{
+        AWSTMMemoryCache *cache = [AWSTMMemoryCache new];
+        cache.costLimit = AWSTMMemoryCacheTestsKeyCount;
+        for (NSString *key in keys) {
+            [cache setObject:key forKey:key withCost:1]; // every insert past the limit evicts the oldest object
+        }
+    }];
+}
+
+@end
@@ -0,0 +1,398 @@
+//
+// Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+
+#import <XCTest/XCTest.h>
+#import "AWSCore.h"
+
+static SCNetworkReachabilityFlags const AWSTransferSchedulerTestsWiFiFlags = kSCNetworkReachabilityFlagsReachable;
+static SCNetworkReachabilityFlags const AWSTransferSchedulerTestsCellularFlags = kSCNetworkReachabilityFlagsReachable | kSCNetworkReachabilityFlagsIsWWAN;
+
+typedef NS_ENUM(NSInteger, AWSTransferSchedulerTestsTransferState) {
+    AWSTransferSchedulerTestsTransferStateWaiting,
+    AWSTransferSchedulerTestsTransferStateRunning,
+    AWSTransferSchedulerTestsTransferStateCompleted,
+    AWSTransferSchedulerTestsTransferStateTimedOut,
+    AWSTransferSchedulerTestsTransferStateDeferred,
+};
+
+@interface AWSTransferSchedulerTestsTransfer : NSObject
+
+@property (nonatomic, strong) AWSTransferSchedulerClient *client;
+@property (nonatomic, assign) int64_t bytes;
+@property (nonatomic, assign) double remainingBytes;
+@property (nonatomic, strong) AWSTask<AWSTransferSchedulerGrant *> *grantTask;
+@property (nonatomic, assign) AWSTransferSchedulerTestsTransferState state;
+@property (nonatomic, assign) NSTimeInterval startTime;
+@property (nonatomic, assign) NSTimeInterval finishTime;
+
+@end
+
+@implementation AWSTransferSchedulerTestsTransfer
+
+@end
+
+/**
+ * A simulated network link on a virtual clock. Each transfer waits one latency for the response and then shares
+ * the bandwidth equally with the other transfers receiving data. Transfers that take longer than the timeout fail.
+ * Completed transfers are reported to the scheduler the way AWSURLSessionManager reports them.
+ */
+@interface AWSTransferSchedulerTestsLink : NSObject
+
+@property (nonatomic, assign) double bandwidth;
+@property (nonatomic, assign) NSTimeInterval latency;
+@property (nonatomic, assign) NSTimeInterval timeout;
+// Without a scheduler every transfer starts right away.
+@property (nonatomic, strong) AWSTransferScheduler *scheduler;
+@property (nonatomic, assign) NSTimeInterval now;
+@property (nonatomic, strong) NSMutableArray<AWSTransferSchedulerTestsTransfer *> *transfers;
+// The transfers in the order they started.
+@property (nonatomic, strong) NSMutableArray<AWSTransferSchedulerTestsTransfer *> *startedTransfers;
+@property (nonatomic, assign) NSUInteger maximumConcurrentTransfers;
+
+@end
+
+@implementation AWSTransferSchedulerTestsLink
+
+- (instancetype)initWithBandwidth:(double)bandwidth
+                          latency:(NSTimeInterval)latency
+                          timeout:(NSTimeInterval)timeout
+                        scheduler:(AWSTransferScheduler *)scheduler {
+    if (self = [super init]) {
+        _bandwidth = bandwidth;
+        _latency = latency;
+        _timeout = timeout;
+        _scheduler = scheduler;
+        _transfers = [NSMutableArray new];
+        _startedTransfers = [NSMutableArray new];
+    }
+    return self;
+}
+
+- (AWSTransferSchedulerTestsTransfer *)addTransferForClient:(AWSTransferSchedulerClient *)client bytes:(int64_t)bytes {
+    AWSTransferSchedulerTestsTransfer *transfer = [AWSTransferSchedulerTestsTransfer new];
+    transfer.client = client;
+    transfer.bytes = bytes;
+    transfer.remainingBytes = bytes;
+    transfer.state = AWSTransferSchedulerTestsTransferStateWaiting;
+    [self.transfers addObject:transfer];
+    if (self.scheduler) {
+        transfer.grantTask = [self.scheduler requestGrantForClient:client bytes:bytes];
+    }
+    [self startGrantedTransfers];
+    return transfer;
+}
+
+- (NSArray<AWSTransferSchedulerTestsTransfer *> *)transfersInState:(AWSTransferSchedulerTestsTransferState)state {
+    return [self.transfers filteredArrayUsingPredicate:[NSPredicate predicateWithBlock:^BOOL(AWSTransferSchedulerTestsTransfer *transfer, NSDictionary *bindings) {
+        return transfer.state == state;
+    }]];
+}
+
+// The scheduler completes grant tasks synchronously, so polling them after each event is deterministic.
+- (void)startGrantedTransfers {
+    for (AWSTransferSchedulerTestsTransfer *transfer in [self transfersInState:AWSTransferSchedulerTestsTransferStateWaiting]) {
+        if (transfer.grantTask && !transfer.grantTask.completed) {
+            continue;
+        }
+        if (transfer.grantTask.error) {
+            transfer.state = AWSTransferSchedulerTestsTransferStateDeferred;
+            continue;
+        }
+        transfer.state = AWSTransferSchedulerTestsTransferStateRunning;
+        transfer.startTime = self.now;
+        [self.startedTransfers addObject:transfer];
+    }
+    self.maximumConcurrentTransfers = MAX(self.maximumConcurrentTransfers,
+                                          [[self transfersInState:AWSTransferSchedulerTestsTransferStateRunning] count]);
+}
+
+- (void)run {
+    while (YES) {
+        NSArray<AWSTransferSchedulerTestsTransfer *> *runningTransfers = [self transfersInState:AWSTransferSchedulerTestsTransferStateRunning];
+        if ([runningTransfers count] == 0) {
+            return;
+        }
+
+        NSUInteger receivingCount = 0;
+        for (AWSTransferSchedulerTestsTransfer *transfer in runningTransfers) {
+            if (self.now >= transfer.startTime + self.latency) {
+                receivingCount++;
+            }
+        }
+        double rate = receivingCount > 0 ? self.bandwidth / receivingCount : 0;
+
+        NSTimeInterval nextTime = DBL_MAX;
+        for (AWSTransferSchedulerTestsTransfer *transfer in runningTransfers) {
+            NSTimeInterval responseTime = transfer.startTime + self.latency;
+            if (self.now < responseTime) {
+                nextTime = MIN(nextTime, responseTime);
+            } else {
+                nextTime = MIN(nextTime, self.now + transfer.remainingBytes / rate);
+            }
+            nextTime = MIN(nextTime, transfer.startTime + self.timeout);
+        }
+
+        for (AWSTransferSchedulerTestsTransfer *transfer in runningTransfers) {
+            if (self.now >= transfer.startTime + self.latency) {
+                transfer.remainingBytes = MAX(0, transfer.remainingBytes - rate * (nextTime - self.now));
+            }
+        }
+        self.now = nextTime;
+
+        for (AWSTransferSchedulerTestsTransfer *transfer in runningTransfers) {
+            BOOL completed = self.now >= transfer.startTime + self.latency && transfer.remainingBytes < 0.001;
+            BOOL timedOut = !completed && self.now >= transfer.startTime + self.timeout;
+            if (!completed && !timedOut) {
+                continue;
+            }
+            transfer.state = completed ? AWSTransferSchedulerTestsTransferStateCompleted : AWSTransferSchedulerTestsTransferStateTimedOut;
+            transfer.finishTime = self.now;
+            [self.scheduler recordTransferWithBytes:(int64_t)(transfer.bytes - transfer.remainingBytes)
+                                           duration:transfer.finishTime - transfer.startTime
+                                      roundTripTime:MIN(self.latency, self.timeout)];
+            [transfer.grantTask.result finish];
+        }
+        [self startGrantedTransfers];
+    }
+}
+
+@end
+
+@interface AWSTransferSchedulerTests : XCTestCase
+
+@end
+
+@implementation AWSTransferSchedulerTests
+
+- (AWSTransferScheduler *)weakCellularScheduler {
+    AWSTransferScheduler *scheduler = [AWSTransferScheduler new];
+    [scheduler updateReachabilityFlags:AWSTransferSchedulerTestsCellularFlags];
+    [scheduler recordTransferWithBytes:32 * 1024 duration:4.0 roundTripTime:0.5];
+    return scheduler;
+}
+
+- (void)testLinkType {
+    AWSTransferScheduler *scheduler = [AWSTransferScheduler new];
+    XCTAssertEqual(AWSTransferSchedulerLinkTypeUnknown, scheduler.linkType);
+
+    [scheduler updateReachabilityFlags:AWSTransferSchedulerTestsWiFiFlags];
+    XCTAssertEqual(AWSTransferSchedulerLinkTypeWiFi, scheduler.linkType);
+    XCTAssertEqual(AWSTransferSchedulerTestsWiFiFlags, scheduler.reachabilityFlags);
+
+    [scheduler updateReachabilityFlags:AWSTransferSchedulerTestsCellularFlags];
+    XCTAssertEqual(AWSTransferSchedulerLinkTypeCellular, scheduler.linkType);
+
+    [scheduler updateReachabilityFlags:kSCNetworkReachabilityFlagsReachable | kSCNetworkReachabilityFlagsConnectionRequired];
+    XCTAssertEqual(AWSTransferSchedulerLinkTypeNotReachable, scheduler.linkType);
+
+    [scheduler updateReachabilityFlags:0];
+    XCTAssertEqual(AWSTransferSchedulerLinkTypeNotReachable, scheduler.linkType);
+}
+
+- (void)testEstimates {
+    AWSTransferScheduler *scheduler = [AWSTransferScheduler new];
+    [scheduler updateReachabilityFlags:AWSTransferSchedulerTestsWiFiFlags];
+
+    // Small requests measure only the round trip time.
+    [scheduler recordTransferWithBytes:8 * 1024 duration:1.0 roundTripTime:0.2];
+    XCTAssertEqual(0, scheduler.estimatedThroughput);
+    XCTAssertEqualWithAccuracy(0.2, scheduler.estimatedRoundTripTime, 0.0001);
+    XCTAssertFalse(scheduler.isWeakLink);
+
+    [scheduler recordTransferWithBytes:64 * 1024 duration:2.0 roundTripTime:0];
+    XCTAssertEqualWithAccuracy(32 * 1024, scheduler.estimatedThroughput, 0.0001);
+    [scheduler recordTransferWithBytes:32 * 1024 duration:2.0 roundTripTime:0];
+    XCTAssertEqualWithAccuracy(32 * 1024 + 0.3 * (16 * 1024 - 32 * 1024), scheduler.estimatedThroughput, 0.0001);
+    XCTAssertFalse(scheduler.isWeakLink);
+
+    [scheduler recordTransferWithBytes:0 duration:5.0 roundTripTime:5.0];
+    XCTAssertTrue(scheduler.isWeakLink);
+
+    // The estimates do not carry over to another link.
+    [scheduler updateReachabilityFlags:AWSTransferSchedulerTestsCellularFlags];
+    XCTAssertEqual(0, scheduler.estimatedThroughput);
+    XCTAssertEqual(0, scheduler.estimatedRoundTripTime);
+    XCTAssertFalse(scheduler.isWeakLink);
+}
+
+- (void)testWeakLinkWithoutSchedulerTimesOut {
+    AWSTransferSchedulerTestsLink *link = [[AWSTransferSchedulerTestsLink alloc] initWithBandwidth:8 * 1024
+                                                                                           latency:0.5
+                                                                                           timeout:10.0
+                                                                                         scheduler:nil];
+    for (int i = 0; i < 8; i++) {
+        [link addTransferForClient:[AWSTransferSchedulerClient new] bytes:16 * 1024];
+    }
+    [link run];
+
+    XCTAssertEqual(8, link.maximumConcurrentTransfers);
+    XCTAssertEqual(8, [[link transfersInState:AWSTransferSchedulerTestsTransferStateTimedOut] count]);
+}
+
+- (void)testWeakLinkWithSchedulerCompletes {
+    AWSTransferScheduler *scheduler = [self weakCellularScheduler];
+    XCTAssertTrue(scheduler.isWeakLink);
+    AWSTransferSchedulerClient *client = [scheduler registerClientWithName:@"client"
+                                                                  priority:AWSTransferSchedulerPriorityDefault
+                                                                    policy:AWSTransferSchedulerPolicyAnyNetwork];
+
+    AWSTransferSchedulerTestsLink *link = [[AWSTransferSchedulerTestsLink alloc] initWithBandwidth:8 * 1024
+                                                                                           latency:0.5
+                                                                                           timeout:10.0
+                                                                                         scheduler:scheduler];
+    for (int i = 0; i < 8; i++) {
+        [link addTransferForClient:client bytes:16 * 1024];
+    }
+    [link run];
+
+    XCTAssertEqual(1, link.maximumConcurrentTransfers);
+    XCTAssertEqual(8, [[link transfersInState:AWSTransferSchedulerTestsTransferStateCompleted] count]);
+    XCTAssertEqualWithAccuracy(8 * 2.5, link.now, 0.001);
+}
+
+- (void)testPriority {
+    AWSTransferScheduler *scheduler = [self weakCellularScheduler];
+    AWSTransferSchedulerClient *lowClient = [scheduler registerClientWithName:@"low"
+                                                                     priority:AWSTransferSchedulerPriorityLow
+                                                                       policy:AWSTransferSchedulerPolicyAnyNetwork];
+    AWSTransferSchedulerClient *highClient = [scheduler registerClientWithName:@"high"
+                                                                      priority:AWSTransferSchedulerPriorityHigh
+                                                                        policy:AWSTransferSchedulerPolicyAnyNetwork];
+
+    AWSTransferSchedulerTestsLink *link = [[AWSTransferSchedulerTestsLink alloc] initWithBandwidth:8 * 1024
+                                                                                           latency:0.5
+                                                                                           timeout:10.0
+                                                                                         scheduler:scheduler];
+    AWSTransferSchedulerTestsTransfer *low1 = [link addTransferForClient:lowClient bytes:16 * 1024];
+    AWSTransferSchedulerTestsTransfer *low2 = [link addTransferForClient:lowClient bytes:16 * 1024];
+    AWSTransferSchedulerTestsTransfer *high = [link addTransferForClient:highClient bytes:16 * 1024];
+    [link run];
+
+    XCTAssertEqualObjects((@[low1, high, low2]), link.startedTransfers);
+}
+
+- (void)testByteBudget {
+    AWSTransferScheduler *scheduler = [AWSTransferScheduler new];
+    [scheduler updateReachabilityFlags:AWSTransferSchedulerTestsWiFiFlags];
+    [scheduler recordTransferWithBytes:200 * 1024 duration:2.0 roundTripTime:0.1];
+    AWSTransferSchedulerClient *client = [scheduler registerClientWithName:@"client"
+                                                                  priority:AWSTransferSchedulerPriorityDefault
+                                                                    policy:AWSTransferSchedulerPolicyAnyNetwork];
+
+    // 100 KB per second for 2 seconds.
+    AWSTask<AWSTransferSchedulerGrant *> *task1 = [scheduler requestGrantForClient:client bytes:80 * 1024];
+    AWSTask<AWSTransferSchedulerGrant *> *task2 = [scheduler requestGrantForClient:client bytes:80 * 1024];
+    AWSTask<AWSTransferSchedulerGrant *> *task3 = [scheduler requestGrantForClient:client bytes:80 * 1024];
+    XCTAssertNotNil(task1.result);
+    XCTAssertNotNil(task2.result);
+    XCTAssertFalse(task3.completed);
+
+    [task1.result finish];
+    XCTAssertNotNil(task3.result);
+
+    // Finishing twice does not free the budget twice.
+    [task1.result finish];
+    AWSTask<AWSTransferSchedulerGrant *> *task4 = [scheduler requestGrantForClient:client bytes:80 * 1024];
+    XCTAssertFalse(task4.completed);
+}
+
+- (void)testWiFiOnlyIsDeferredOnCellular {
+    AWSTransferScheduler *scheduler = [AWSTransferScheduler new];
+    [scheduler updateReachabilityFlags:AWSTransferSchedulerTestsCellularFlags];
+    AWSTransferSchedulerClient *client = [scheduler registerClientWithName:@"client"
+                                                                  priority:AWSTransferSchedulerPriorityDefault
+                                                                    policy:AWSTransferSchedulerPolicyWiFiOnly];
+    XCTestExpectation *expectation = [self expectationWithDescription:@"The flush window opens on Wi-Fi."];
+    client.flushWindowHandler = ^{
+        [expectation fulfill];
+    };
+
+    AWSTask<AWSTransferSchedulerGrant *> *task = [scheduler requestGrantForClient:client bytes:1024];
+    XCTAssertEqualObjects(AWSTransferSchedulerErrorDomain, task.error.domain);
+    XCTAssertEqual(AWSTransferSchedulerErrorDeferred, task.error.code);
+
+    [scheduler updateReachabilityFlags:AWSTransferSchedulerTestsWiFiFlags];
+    [self waitForExpectationsWithTimeout:5 handler:nil];
+
+    task = [scheduler requestGrantForClient:client bytes:1024];
+    XCTAssertNotNil(task.result);
+}
+
+- (void)testDeferredBulkWaitsForOtherTransfers {
+    AWSTransferScheduler *scheduler = [AWSTransferScheduler new];
+    AWSTransferSchedulerClient *client = [scheduler registerClientWithName:@"client"
+                                                                  priority:AWSTransferSchedulerPriorityDefault
+                                                                    policy:AWSTransferSchedulerPolicyAnyNetwork];
+    AWSTransferSchedulerClient *bulkClient = [scheduler registerClientWithName:@"bulk"
+                                                                      priority:AWSTransferSchedulerPriorityDefault
+                                                                        policy:AWSTransferSchedulerPolicyDeferredBulk];
+
+    // The link is not known yet.
+    XCTAssertEqual(AWSTransferSchedulerErrorDeferred, [scheduler requestGrantForClient:bulkClient bytes:1024].error.code);
+
+    [scheduler updateReachabilityFlags:AWSTransferSchedulerTestsWiFiFlags];
+    AWSTask<AWSTransferSchedulerGrant *> *task = [scheduler requestGrantForClient:client bytes:1024];
+    AWSTask<AWSTransferSchedulerGrant *> *bulkTask = [scheduler requestGrantForClient:bulkClient bytes:1024];
+    XCTAssertNotNil(task.result);
+    XCTAssertFalse(bulkTask.completed);
+
+    [task.result finish];
+    XCTAssertNotNil(bulkTask.result);
+    [bulkTask.result finish];
+}
+
+- (void)testDeferredBulkWaitsForStrongLink {
+    AWSTransferScheduler *scheduler = [AWSTransferScheduler new];
+    [scheduler updateReachabilityFlags:AWSTransferSchedulerTestsWiFiFlags];
+    [scheduler recordTransferWithBytes:0 duration:3.0 roundTripTime:3.0];
+    AWSTransferSchedulerClient *bulkClient = [scheduler registerClientWithName:@"bulk"
+                                                                      priority:AWSTransferSchedulerPriorityDefault
+                                                                        policy:AWSTransferSchedulerPolicyDeferredBulk];
+    XCTestExpectation *expectation = [self expectationWithDescription:@"The flush window opens on a strong link."];
+    bulkClient.flushWindowHandler = ^{
+        [expectation fulfill];
+    };
+
+    XCTAssertEqual(AWSTransferSchedulerErrorDeferred, [scheduler requestGrantForClient:bulkClient bytes:1024].error.code);
+
+    while (scheduler.isWeakLink) {
+        [scheduler recordTransferWithBytes:0 duration:0.1 roundTripTime:0.1];
+    }
+    [self waitForExpectationsWithTimeout:5 handler:nil];
+}
+
+- (void)testNotReachable {
+    AWSTransferScheduler *scheduler = [AWSTransferScheduler new];
+    [scheduler updateReachabilityFlags:AWSTransferSchedulerTestsWiFiFlags];
+    AWSTransferSchedulerClient *client = [scheduler registerClientWithName:@"client"
+                                                                  priority:AWSTransferSchedulerPriorityDefault
+                                                                    policy:AWSTransferSchedulerPolicyAnyNetwork];
+    AWSTransferSchedulerClient *bulkClient = [scheduler registerClientWithName:@"bulk"
+                                                                      priority:AWSTransferSchedulerPriorityDefault
+                                                                        policy:AWSTransferSchedulerPolicyDeferredBulk];
+
+    AWSTask<AWSTransferSchedulerGrant *> *task = [scheduler requestGrantForClient:client bytes:1024];
+    AWSTask<AWSTransferSchedulerGrant *> *bulkTask = [scheduler requestGrantForClient:bulkClient bytes:1024];
+    XCTAssertNotNil(task.result);
+    XCTAssertFalse(bulkTask.completed);
+
+    // Waiting requests fail when the link goes down.
+    [scheduler updateReachabilityFlags:0];
+    XCTAssertEqual(AWSTransferSchedulerErrorDeferred, bulkTask.error.code);
+    XCTAssertEqual(AWSTransferSchedulerErrorDeferred, [scheduler requestGrantForClient:client bytes:1024].error.code);
+    [task.result finish];
+}
+
+@end
@@ -0,0 +1,260 @@
+//
+// Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+
+#import <XCTest/XCTest.h>
+#import "AWSCore.h"
+#import "AWSXMLWriter.h"
+#import "AWSXMLByteWriter.h"
+
+static NSUInteger const AWSXMLByteWriterTestsPartCount = 10000;
+
+@interface AWSXMLBuilder()
+
++ (BOOL)xmlBuildForDictionary:(NSDictionary *)params
+                   actionName:(NSString *)actionName
+        serviceDefinitionRule:(NSDictionary *)serviceDefinitionRule
+                    xmlWriter:(id<AWSXMLStreamWriter>)xmlWriter
+                        error:(NSError *__autoreleasing *)error;
+
+@end
+
+@interface AWSXMLByteWriterTests : XCTestCase
+
+@end
+
+@implementation AWSXMLByteWriterTests
+
+// The parts of the Amazon S3 definition CompleteMultipartUpload uses.
+- (NSDictionary *)serviceDefinition {
+    return @{@"operations" : @{@"CompleteMultipartUpload" : @{@"input" : @{@"shape" : @"CompleteMultipartUploadRequest"}}},
+             @"shapes" : @{@"CompleteMultipartUploadRequest" : @{@"type" : @"structure",
+                                                                  @"members" : @{@"Bucket" : @{@"shape" : @"BucketName",
+                                                                                               @"location" : @"uri",
+                                                                                               @"locationName" : @"Bucket"},
+                                                                                 @"MultipartUpload" : @{@"shape" : @"CompletedMultipartUpload",
+                                                                                                        @"locationName" : @"CompleteMultipartUpload",
+                                                                                                        @"xmlNamespace" : @{@"uri" : @"http://s3.amazonaws.com/doc/2006-03-01/"}}},
+                                                                  @"payload" : @"MultipartUpload"},
+                           @"CompletedMultipartUpload" : @{@"type" : @"structure",
+                                                           @"members" : @{@"Parts" : @{@"shape" : @"CompletedPartList",
+                                                                                       @"locationName" : @"Part"}}},
+                           @"CompletedPartList" : @{@"type" : @"list",
+                                                    @"member" : @{@"shape" : @"CompletedPart"},
+                                                    @"flattened" : @YES},
+                           @"CompletedPart" : @{@"type" : @"structure",
+                                                @"members" : @{@"ETag" : @{@"shape" : @"ETag"},
+                                                               @"PartNumber" : @{@"shape" : @"PartNumber"}}},
+                           @"BucketName" : @{@"type" : @"string"},
+                           @"ETag" : @{@"type" : @"string"},
+                           @"PartNumber" : @{@"type" : @"integer"}}};
+}
+
+- (NSDictionary *)completeMultipartUploadParameters {
+    NSMutableArray *parts = [NSMutableArray arrayWithCapacity:AWSXMLByteWriterTestsPartCount];
+    for (NSUInteger i = 1; i <= AWSXMLByteWriterTestsPartCount; i++) {
+        [parts addObject:@{@"ETag" : [NSString stringWithFormat:@"\"%032lx\"", (unsigned long)(i * 2654435761u)],
+                           @"PartNumber" : @(i)}];
+    }
+    return @{@"Bucket" : @"bucket",
+             @"MultipartUpload" : @{@"Parts" : parts}};
+}
+
+- (void)assertEquivalentOutput:(void (^)(id<AWSXMLStreamWriter> writer))block {
+    AWSXMLWriter *xmlWriter = [AWSXMLWriter new];
+    block(xmlWriter);
+    AWSXMLByteWriter *byteWriter = [AWSXMLByteWriter new];
+    block(byteWriter);
+
+    NSData *expected = [xmlWriter toData];
+    NSData *actual = [byteWriter toData];
+    XCTAssertNotNil(expected);
+    XCTAssertEqualObjects(expected, actual, @"\n%@\n%@",
+                          [[NSString alloc] initWithData:expected encoding:NSUTF8StringEncoding],
+                          [[NSString alloc] initWithData:actual encoding:NSUTF8StringEncoding]);
+    XCTAssertEqual([actual length], byteWriter.byteCount);
+}
+
+- (void)testElementsAndAttributes {
+    [self assertEquivalentOutput:^(id<AWSXMLStreamWriter> writer) {
+        [writer writeStartDocumentWithEncodingAndVersion:@"UTF-8" version:@"1.0"];
+        [writer writeStartElement:@"Delete"];
+        [writer writeAttribute:@"xmlns" value:@"http://s3.amazonaws.com/doc/2006-03-01/"];
+        [writer writeAttribute:@"note" value:@"\"quoted\" & <angled>"];
+        [writer writeStartElement:@"Quiet"];
+        [writer writeCharacters:@"true"];
+        [writer writeEndElement:@"Quiet"];
+        [writer writeStartElement:@"Object"];
+        [writer writeStartElement:@"Key"];
+        [writer writeCharacters:@"photos/2018/<a&b>.jpg"];
+        [writer writeEndElement:@"Key"];
+        [writer writeStartElement:@"VersionId"];
+        [writer writeEndElement];
+        [writer writeEndElement:@"Object"];
+        [writer writeStartElement:@"Empty"];
+        [writer writeEndElement:@"Empty"];
+        [writer writeEmptyElement:@"Marker"];
+        [writer writeComment:@"comment"];
+        [writer writeCData:@"<raw & unescaped>"];
+        [writer writeEndDocument];
+    }];
+}
+
+- (void)testEscapedCharacters {
+    UniChar invalidCharacters[] = {'a', 0xFFFE, 'b', 0xFFFF, 'c', 0xD83D, 'd', 0xDE00, 'e'};
+    NSString *invalid = [NSString stringWithCharacters:invalidCharacters length:sizeof(invalidCharacters) / sizeof(UniChar)];
+    NSArray<NSString *> *values = @[@"",
+                                    @"plain ascii",
+                                    @"tab\tnewline\ncarriage return\rcontrol\x01\x1F end",
+                                    @"apostrophe ' stays",
+                                    @"café naïve",
+                                    @"日本語 & é",
+                                    @"private use \uE000 and \uFFFD",
+                                    @"emoji \U0001F600 dropped",
+                                    invalid];
+    for (NSString *value in values) {
+        [self assertEquivalentOutput:^(id<AWSXMLStreamWriter> writer) {
+            [writer writeStartElement:@"Element"];
+            [writer writeAttribute:@"attribute" value:value];
+            [writer writeCharacters:value];
+            [writer writeEndElement:@"Element"];
+        }];
+    }
+}
+
+- (void)testNonASCIINames {
+    [self assertEquivalentOutput:^(id<AWSXMLStreamWriter> writer) {
+        [writer writeStartElement:@"élément"];
+        [writer writeAttribute:@"日本" value:@"語"];
+        [writer writeEndElement:@"élément"];
+    }];
+}
+
+- (void)testOutputLargerThanChunk {
+    NSMutableString *value = [NSMutableString new];
+    for (int i = 0; i < 4096; i++) {
+        [value appendString:@"<é&\"x"];
+    }
+    [self assertEquivalentOutput:^(id<AWSXMLStreamWriter> writer) {
+        [writer writeStartElement:@"Large"];
+        for (int i = 0; i < 8; i++) {
+            [writer writeStartElement:@"Value"];
+            [writer writeCharacters:value];
+            [writer writeEndElement:@"Value"];
+        }
+        [writer writeEndElement:@"Large"];
+    }];
+}
+
+- (void)testOutputStream {
+    NSString *value = [@"" stringByPaddingToLength:40000 withString:@"a&é" startingAtIndex:0];
+
+    AWSXMLByteWriter *memoryWriter = [AWSXMLByteWriter new];
+    NSOutputStream *outputStream = [NSOutputStream outputStreamToMemory];
+    [outputStream open];
+    AWSXMLByteWriter *streamWriter = [[AWSXMLByteWriter alloc] initWithOutputStream:outputStream];
+    for (AWSXMLByteWriter *writer in @[memoryWriter, streamWriter]) {
+        [writer writeStartElement:@"Value"];
+        [writer writeCharacters:value];
+        [writer writeEndElement:@"Value"];
+        [writer close];
+    }
+    [outputStream close];
+
+    XCTAssertNil(streamWriter.streamError);
+    XCTAssertNil([streamWriter toData]);
+    XCTAssertEqualObjects([memoryWriter toData], [outputStream propertyForKey:NSStreamDataWrittenToMemoryStreamKey]);
+    XCTAssertEqual(memoryWriter.byteCount, streamWriter.byteCount);
+}
+
+- (void)testOutputStreamError {
+    NSOutputStream *outputStream = [NSOutputStream outputStreamToMemory];
+    AWSXMLByteWriter *writer = [[AWSXMLByteWriter alloc] initWithOutputStream:outputStream];
+    [writer writeStartElement:@"Value"];
+    [writer writeEndElement:@"Value"];
+    // The stream was never opened.
+    [writer close];
+    XCTAssertNotNil(writer.streamError);
+}
+
+- (void)testCompleteMultipartUpload {
+    NSDictionary *serviceDefinition = [self serviceDefinition];
+    NSDictionary *parameters = [self completeMultipartUploadParameters];
+
+    AWSXMLWriter *xmlWriter = [AWSXMLWriter new];
+    NSError *error = nil;
+    XCTAssertTrue([AWSXMLBuilder xmlBuildForDictionary:parameters
+                                            actionName:@"CompleteMultipartUpload"
+                                 serviceDefinitionRule:serviceDefinition
+                                             xmlWriter:xmlWriter
+                                                 error:&error]);
+    XCTAssertNil(error);
+    NSData *expected = [xmlWriter toData];
+    XCTAssertTrue([[[NSString alloc] initWithData:expected encoding:NSUTF8StringEncoding] hasPrefix:@"\n<CompleteMultipartUpload xmlns=\"http://s3.amazonaws.com/doc/2006-03-01/\">\n\t<Part>"]);
+
+    NSData *data = [AWSXMLBuilder xmlDataForDictionary:parameters
+                                            actionName:@"CompleteMultipartUpload"
+                                 serviceDefinitionRule:serviceDefinition
+                                                 error:&error];
+    XCTAssertNil(error);
+    XCTAssertEqualObjects(expected, data);
+
+    NSString *string = [AWSXMLBuilder xmlStringForDictionary:parameters
+                                                  actionName:@"CompleteMultipartUpload"
+                                       serviceDefinitionRule:serviceDefinition
+                                                       error:&error];
+    XCTAssertNil(error);
+    XCTAssertEqualObjects([xmlWriter toString], string);
+
+    NSOutputStream *outputStream = [NSOutputStream outputStreamToMemory];
+    [outputStream open];
+    XCTAssertTrue([AWSXMLBuilder writeXMLForDictionary:parameters
+                                            actionName:@"CompleteMultipartUpload"
+                                 serviceDefinitionRule:serviceDefinition
+                                        toOutputStream:outputStream
+                                                 error:&error]);
+    XCTAssertNil(error);
+    XCTAssertEqualObjects(expected, [outputStream propertyForKey:NSStreamDataWrittenToMemoryStreamKey]);
+    [outputStream close];
+}
+
+- (void)testPerformanceCompleteMultipartUploadByteWriter {
+    NSDictionary *serviceDefinition = [self serviceDefinition];
+    NSDictionary *parameters = [self completeMultipartUploadParameters];
+    [self measureBlock:^{
+        NSData *data = [AWSXMLBuilder xmlDataForDictionary:parameters
+                                                actionName:@"CompleteMultipartUpload"
+                                     serviceDefinitionRule:serviceDefinition
+                                                     error:nil];
+        XCTAssertGreaterThan([data length], 0);
+    }];
+}
+
+// The baseline: the same document written as an NSString and converted to UTF-8 afterwards.
+- (void)testPerformanceCompleteMultipartUploadXMLWriter {
+    NSDictionary *serviceDefinition = [self serviceDefinition];
+    NSDictionary *parameters = [self completeMultipartUploadParameters];
+    [self measureBlock:^{
+        AWSXMLWriter *xmlWriter = [AWSXMLWriter new];
+        [AWSXMLBuilder xmlBuildForDictionary:parameters
+                                  actionName:@"CompleteMultipartUpload"
+                       serviceDefinitionRule:serviceDefinition
+                                   xmlWriter:xmlWriter
+                                       error:nil];
+        NSData *data = [xmlWriter toData];
+        XCTAssertGreaterThan([data length], 0);
+    }];
+}
+
+@end
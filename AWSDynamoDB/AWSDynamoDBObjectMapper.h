@@ -18,6 +18,27 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+FOUNDATION_EXPORT NSString *const AWSDynamoDBObjectMapperErrorDomain;
+typedef NS_ENUM(NSInteger, AWSDynamoDBObjectMapperErrorType) {
+    AWSDynamoDBObjectMapperErrorUnknown,
+    /**
+     DynamoDB kept returning some items of a batch request as unprocessed
+     until `batchRetryTimeout` passed. The items are in the `userInfo` under
+     `AWSDynamoDBObjectMapperUnprocessedItemsKey`.
+     */
+    AWSDynamoDBObjectMapperErrorUnprocessedItems,
+    /**
+     The key models passed to a batch load for one table were of more than
+     one class.
+     */
+    AWSDynamoDBObjectMapperErrorConflictingModelClasses,
+};
+
+/**
+ The `userInfo` key of the unprocessed write requests or keys, keyed by table name.
+ */
+FOUNDATION_EXPORT NSString *const AWSDynamoDBObjectMapperUnprocessedItemsKey;
+
 /**
  Enumeration of behaviors for the save operation.
  */
@@ -67,6 +88,7 @@ typedef NS_ENUM(NSInteger, AWSDynamoDBObjectMapperSaveBehavior) {
 @class AWSDynamoDBQueryExpression;
 @class AWSDynamoDBScanExpression;
 @class AWSDynamoDBPaginatedOutput;
+@class AWSDynamoDBParallelScanOutput;
 
 /**
  A DynamoDB Modeling protocol. All objects mapped to an Amazon DynamoDB table row need to conform to this protocol.
@@ -362,6 +384,136 @@ completionHandler:(void (^ _Nullable)(NSError * _Nullable error))completionHandl
  configuration:(nullable AWSDynamoDBObjectMapperConfiguration *)configuration
 completionHandler:(void (^ _Nullable)(NSError * _Nullable error))completionHandler;
 
+/**
+ Saves the model objects using the default configuration. The models are written with `BatchWriteItem`, 25 to a request, and may belong to different tables.
+
+ `BatchWriteItem` can only replace whole items, so the models are saved as with `AWSDynamoDBObjectMapperSaveBehaviorClobber` whatever the configured save behavior is. Two models with the same key must not be passed in the same call.
+
+ @param models The models to save.
+
+ @return AWSTask. `task.error` is set if a request failed, or if some models were still unprocessed after `batchRetryTimeout`.
+ */
+- (AWSTask *)batchSave:(NSArray<AWSDynamoDBObjectModel<AWSDynamoDBModeling> *> *)models;
+
+/**
+ Saves the model objects using the default configuration.
+
+ @param models            The models to save.
+ @param completionHandler The completion handler to call when the save request is complete.
+                          `error`: An error object that indicates why the request failed, or `nil` if the request was successful.
+ */
+- (void)batchSave:(NSArray<AWSDynamoDBObjectModel<AWSDynamoDBModeling> *> *)models
+completionHandler:(void (^ _Nullable)(NSError * _Nullable error))completionHandler;
+
+/**
+ Saves the model objects using the specified configuration. The configuration supplies `maxConcurrentBatchRequests` and `batchRetryTimeout`.
+
+ @param models        The models to save.
+ @param configuration A configuration.
+
+ @return AWSTask.
+ */
+- (AWSTask *)batchSave:(NSArray<AWSDynamoDBObjectModel<AWSDynamoDBModeling> *> *)models
+         configuration:(nullable AWSDynamoDBObjectMapperConfiguration *)configuration;
+
+/**
+ Saves the model objects using the specified configuration.
+
+ @param models            The models to save.
+ @param configuration     A configuration.
+ @param completionHandler The completion handler to call when the save request is complete.
+                          `error`: An error object that indicates why the request failed, or `nil` if the request was successful.
+ */
+- (void)batchSave:(NSArray<AWSDynamoDBObjectModel<AWSDynamoDBModeling> *> *)models
+    configuration:(nullable AWSDynamoDBObjectMapperConfiguration *)configuration
+completionHandler:(void (^ _Nullable)(NSError * _Nullable error))completionHandler;
+
+/**
+ Removes the model objects using the default configuration. The models are deleted with `BatchWriteItem`, 25 to a request, and may belong to different tables.
+
+ @param models The models to delete.
+
+ @return AWSTask. `task.error` is set if a request failed, or if some models were still unprocessed after `batchRetryTimeout`.
+ */
+- (AWSTask *)batchRemove:(NSArray<AWSDynamoDBObjectModel<AWSDynamoDBModeling> *> *)models;
+
+/**
+ Removes the model objects using the default configuration.
+
+ @param models            The models to delete.
+ @param completionHandler The completion handler to call when the remove request is complete.
+                          `error`: An error object that indicates why the request failed, or `nil` if the request was successful.
+ */
+- (void)batchRemove:(NSArray<AWSDynamoDBObjectModel<AWSDynamoDBModeling> *> *)models
+  completionHandler:(void (^ _Nullable)(NSError * _Nullable error))completionHandler;
+
+/**
+ Removes the model objects using the specified configuration.
+
+ @param models        The models to delete.
+ @param configuration A configuration.
+
+ @return AWSTask.
+ */
+- (AWSTask *)batchRemove:(NSArray<AWSDynamoDBObjectModel<AWSDynamoDBModeling> *> *)models
+           configuration:(nullable AWSDynamoDBObjectMapperConfiguration *)configuration;
+
+/**
+ Removes the model objects using the specified configuration.
+
+ @param models            The models to delete.
+ @param configuration     A configuration.
+ @param completionHandler The completion handler to call when the remove request is complete.
+                          `error`: An error object that indicates why the request failed, or `nil` if the request was successful.
+ */
+- (void)batchRemove:(NSArray<AWSDynamoDBObjectModel<AWSDynamoDBModeling> *> *)models
+      configuration:(nullable AWSDynamoDBObjectMapperConfiguration *)configuration
+  completionHandler:(void (^ _Nullable)(NSError * _Nullable error))completionHandler;
+
+/**
+ Loads the items with the keys of the given model objects using the default configuration. Only the key attributes of the models need to be set. The items are read with `BatchGetItem`, 100 keys to a request, and may belong to different tables.
+
+ @param keyModels Models holding the keys to load. The models for one table must all be of the same class. A key passed more than once is loaded once.
+
+ @return AWSTask. `task.result` is an array of the loaded models in no particular order. Keys with no item are left out. If the models for one table are of more than one class, the task fails with `AWSDynamoDBObjectMapperErrorConflictingModelClasses` before any request is sent.
+ */
+- (AWSTask<NSArray<AWSDynamoDBObjectModel<AWSDynamoDBModeling> *> *> *)batchLoad:(NSArray<AWSDynamoDBObjectModel<AWSDynamoDBModeling> *> *)keyModels;
+
+/**
+ Loads the items with the keys of the given model objects using the default configuration.
+
+ @param keyModels         Models holding the keys to load.
+ @param completionHandler The completion handler to call when the load request is complete.
+                          `response`: The loaded models in no particular order.
+                          `error`: An error object that indicates why the request failed, or `nil` if the request was successful.
+ */
+- (void)batchLoad:(NSArray<AWSDynamoDBObjectModel<AWSDynamoDBModeling> *> *)keyModels
+completionHandler:(void (^ _Nullable)(NSArray<AWSDynamoDBObjectModel<AWSDynamoDBModeling> *> * _Nullable response, NSError * _Nullable error))completionHandler;
+
+/**
+ Loads the items with the keys of the given model objects using the specified configuration.
+
+ @param keyModels     Models holding the keys to load.
+ @param configuration A configuration.
+
+ @return AWSTask.
+ */
+- (AWSTask<NSArray<AWSDynamoDBObjectModel<AWSDynamoDBModeling> *> *> *)batchLoad:(NSArray<AWSDynamoDBObjectModel<AWSDynamoDBModeling> *> *)keyModels
+                                                                    configuration:(nullable AWSDynamoDBObjectMapperConfiguration *)configuration;
+
+/**
+ Loads the items with the keys of the given model objects using the specified configuration.
+
+ @param keyModels         Models holding the keys to load.
+ @param configuration     A configuration.
+ @param completionHandler The completion handler to call when the load request is complete.
+                          `response`: The loaded models in no particular order.
+                          `error`: An error object that indicates why the request failed, or `nil` if the request was successful.
+ */
+- (void)batchLoad:(NSArray<AWSDynamoDBObjectModel<AWSDynamoDBModeling> *> *)keyModels
+    configuration:(nullable AWSDynamoDBObjectMapperConfiguration *)configuration
+completionHandler:(void (^ _Nullable)(NSArray<AWSDynamoDBObjectModel<AWSDynamoDBModeling> *> * _Nullable response, NSError * _Nullable error))completionHandler;
+
 /**
  Returns an object with the given hash key and the range key (if it exists), or `nil` if no such object exists.
 
@@ -526,6 +678,38 @@ completionHandler:(void (^ _Nullable)(AWSDynamoDBPaginatedOutput * _Nullable res
 configuration:(nullable AWSDynamoDBObjectMapperConfiguration *)configuration
 completionHandler:(void (^ _Nullable)(AWSDynamoDBPaginatedOutput * _Nullable response, NSError * _Nullable error))completionHandler;
 
+/**
+ Scans through an Amazon DynamoDB table with `totalSegments` segments scanned in parallel, using the default configuration.
+
+ @param resultClass   The class of the result object.
+ @param expression    An expression object. Its `exclusiveStartKey` is ignored.
+ @param totalSegments The number of segments to divide the table into. Values below 1 are treated as 1 and values above 1,000,000 as 1,000,000.
+
+ @return An enumerator of model objects. Requests start right away.
+
+ @see AWSDynamoDBParallelScanOutput
+ */
+- (AWSDynamoDBParallelScanOutput *)parallelScan:(Class)resultClass
+                                     expression:(AWSDynamoDBScanExpression *)expression
+                                  totalSegments:(NSUInteger)totalSegments;
+
+/**
+ Scans through an Amazon DynamoDB table with `totalSegments` segments scanned in parallel.
+
+ @param resultClass   The class of the result object.
+ @param expression    An expression object. Its `exclusiveStartKey` is ignored.
+ @param totalSegments The number of segments to divide the table into. Values below 1 are treated as 1 and values above 1,000,000 as 1,000,000.
+ @param configuration A configuration. `maxBufferedScanPages` bounds how many pages are held at once.
+
+ @return An enumerator of model objects. Requests start right away.
+
+ @see AWSDynamoDBParallelScanOutput
+ */
+- (AWSDynamoDBParallelScanOutput *)parallelScan:(Class)resultClass
+                                     expression:(AWSDynamoDBScanExpression *)expression
+                                  totalSegments:(NSUInteger)totalSegments
+                                  configuration:(nullable AWSDynamoDBObjectMapperConfiguration *)configuration;
+
 @end
 
 /**
@@ -543,6 +727,21 @@ completionHandler:(void (^ _Nullable)(AWSDynamoDBPaginatedOutput * _Nullable res
  */
 @property (nonatomic, strong, nullable) NSNumber *consistentRead;
 
+/**
+ The maximum number of requests a batch save, remove or load keeps in flight at once. The default is 4.
+ */
+@property (nonatomic, assign) NSUInteger maxConcurrentBatchRequests;
+
+/**
+ How long, in seconds, a batch save, remove or load keeps resubmitting the items DynamoDB returns as unprocessed before it fails. The default is 60 seconds.
+ */
+@property (nonatomic, assign) NSTimeInterval batchRetryTimeout;
+
+/**
+ The maximum number of pages a parallel scan holds at once, counting pages being fetched and pages waiting to be enumerated, but not the page being enumerated. Segments wait for room before fetching their next page, so this also bounds the number of requests in flight. The default is 16.
+ */
+@property (nonatomic, assign) NSUInteger maxBufferedScanPages;
+
 @end
 
 /**
@@ -720,4 +919,47 @@ completionHandler:(void (^ _Nullable)(AWSDynamoDBPaginatedOutput * _Nullable res
 
 @end
 
+/**
+ The output of a parallel scan.
+
+ Each segment fetches its next page while earlier pages are being enumerated, and items are returned in the order their pages arrive, so the order is not stable between scans. `nextObject` and `nextPage` block until an item is available, so don't call them on the main thread. Enumerating from more than one thread at a time is not supported.
+ */
+@interface AWSDynamoDBParallelScanOutput : NSEnumerator
+
+/**
+ The number of segments the table is divided into.
+ */
+@property (nonatomic, assign, readonly) NSUInteger totalSegments;
+
+/**
+ The error that stopped the scan, or `nil`. Check it once the enumerator returns `nil`.
+ */
+@property (nonatomic, strong, readonly, nullable) NSError *error;
+
+/**
+ Whether `cancel` has been called.
+ */
+@property (nonatomic, assign, readonly, getter=isCancelled) BOOL cancelled;
+
+/**
+ Returns the next item, waiting for a page to arrive if needed.
+
+ @return The next model object, or `nil` when all segments are done, the scan failed or it was cancelled.
+ */
+- (nullable id)nextObject;
+
+/**
+ Returns the items of the next page, or what is left of it if some were already returned by `nextObject`, waiting for a page to arrive if needed.
+
+ @return A non-empty array of model objects, or `nil` when all segments are done, the scan failed or it was cancelled.
+ */
+- (nullable NSArray<__kindof AWSDynamoDBObjectModel<AWSDynamoDBModeling> *> *)nextPage;
+
+/**
+ Stops the scan. Pages already buffered are dropped, responses still in flight are discarded, and enumeration ends.
+ */
+- (void)cancel;
+
+@end
+
 NS_ASSUME_NONNULL_END
@@ -19,11 +19,29 @@
 #import "AWSCocoaLumberjack.h"
 #import "AWSSynchronizedMutableDictionary.h"
 #import "AWSCategory.h"
+#import <objc/runtime.h>
 
 static NSString *const AWSInfoDynamoDBObjectMapper = @"DynamoDBObjectMapper";
 
 static const NSString *AWSDynamoDBObjectMapperHashKeyAttributePlaceHolder = @":awsddbomhashvalueplaceholder";
 NSString *const AWSDynamoDBObjectMapperUserAgent = @"mapper";
+NSString *const AWSDynamoDBObjectMapperErrorDomain = @"com.amazonaws.AWSDynamoDBObjectMapperErrorDomain";
+NSString *const AWSDynamoDBObjectMapperUnprocessedItemsKey = @"UnprocessedItems";
+
+// Service limits of BatchWriteItem and BatchGetItem.
+static NSUInteger const AWSDynamoDBObjectMapperMaxBatchWriteRequests = 25;
+static NSUInteger const AWSDynamoDBObjectMapperMaxBatchGetKeys = 100;
+
+static NSUInteger const AWSDynamoDBObjectMapperDefaultMaxConcurrentBatchRequests = 4;
+static NSTimeInterval const AWSDynamoDBObjectMapperDefaultBatchRetryTimeout = 60;
+
+// Service limit of Scan.
+static NSUInteger const AWSDynamoDBObjectMapperMaxScanSegments = 1000000;
+static NSUInteger const AWSDynamoDBObjectMapperDefaultMaxBufferedScanPages = 16;
+
+// Backoff before resubmitting unprocessed items, in milliseconds.
+static uint32_t const AWSDynamoDBObjectMapperBatchBackoffBase = 50;
+static uint32_t const AWSDynamoDBObjectMapperBatchBackoffCap = 5000;
 
 @interface NSString (AWSDynamoDBObjectMapperSaveBehavior)
 
@@ -103,8 +121,9 @@ NSString *const AWSDynamoDBObjectMapperUserAgent = @"mapper";
 
 @interface AWSDynamoDBObjectModel ()
 
-- (NSDictionary *)itemForPutItemInput;
-- (NSDictionary *)itemForUpdateItemInput:(AWSDynamoDBObjectMapperSaveBehavior)behavior;
+- (NSDictionary *)JSONItemForPutItemInput;
+- (NSDictionary *)JSONAttributeUpdatesForUpdateItemInput:(AWSDynamoDBObjectMapperSaveBehavior)behavior;
+- (NSDictionary *)JSONKey;
 - (NSDictionary *)key;
 
 @end
@@ -121,9 +140,312 @@ NSString *const AWSDynamoDBObjectMapperUserAgent = @"mapper";
 
 @end
 
+@interface AWSDynamoDBParallelScanOutput()
+
+- (instancetype)initWithObjectMapper:(AWSDynamoDBObjectMapper *)dynamoDBObjectMapper
+                         resultClass:(Class)resultClass
+                       segmentInputs:(NSArray<AWSDynamoDBScanInput *> *)segmentInputs
+                    maxBufferedPages:(NSUInteger)maxBufferedPages;
+- (void)start;
+
+@end
+
 @interface AWSDynamoDB()
 
 - (instancetype)initWithConfiguration:(AWSServiceConfiguration *)configuration;
+- (AWSTask *)invokeRequest:(AWSRequest *)request
+               HTTPMethod:(AWSHTTPMethod)HTTPMethod
+                URLString:(NSString *)URLString
+             targetPrefix:(NSString *)targetPrefix
+            operationName:(NSString *)operationName
+              outputClass:(Class)outputClass;
+
+@end
+
+#pragma mark - JSON items
+
+/*
+ The request and response models below keep items in the JSON form the
+ serializers work with, e.g. @{@"title" : @{@"S" : @"a"}}, instead of
+ transforming them to and from AWSDynamoDBAttributeValue objects. The mapper
+ converts between that form and model values directly.
+ */
+
+@interface AWSDynamoDBObjectMapperPutItemInput : AWSDynamoDBPutItemInput
+
+@end
+
+@implementation AWSDynamoDBObjectMapperPutItemInput
+
++ (NSValueTransformer *)itemJSONTransformer {
+    return nil;
+}
+
+@end
+
+@interface AWSDynamoDBObjectMapperUpdateItemInput : AWSDynamoDBUpdateItemInput
+
+@end
+
+@implementation AWSDynamoDBObjectMapperUpdateItemInput
+
++ (NSValueTransformer *)attributeUpdatesJSONTransformer {
+    return nil;
+}
+
++ (NSValueTransformer *)keyJSONTransformer {
+    return nil;
+}
+
+@end
+
+@interface AWSDynamoDBObjectMapperPutRequest : AWSDynamoDBPutRequest
+
+@end
+
+@implementation AWSDynamoDBObjectMapperPutRequest
+
++ (NSValueTransformer *)itemJSONTransformer {
+    return nil;
+}
+
+@end
+
+@interface AWSDynamoDBObjectMapperGetItemOutput : AWSDynamoDBGetItemOutput
+
+@end
+
+@implementation AWSDynamoDBObjectMapperGetItemOutput
+
++ (NSValueTransformer *)itemJSONTransformer {
+    return nil;
+}
+
+@end
+
+@interface AWSDynamoDBObjectMapperQueryOutput : AWSDynamoDBQueryOutput
+
+@end
+
+@implementation AWSDynamoDBObjectMapperQueryOutput
+
++ (NSValueTransformer *)itemsJSONTransformer {
+    return nil;
+}
+
+@end
+
+@interface AWSDynamoDBObjectMapperScanOutput : AWSDynamoDBScanOutput
+
+@end
+
+@implementation AWSDynamoDBObjectMapperScanOutput
+
++ (NSValueTransformer *)itemsJSONTransformer {
+    return nil;
+}
+
+@end
+
+@interface AWSDynamoDBObjectMapperBatchGetItemOutput : AWSDynamoDBBatchGetItemOutput
+
+@end
+
+@implementation AWSDynamoDBObjectMapperBatchGetItemOutput
+
++ (NSValueTransformer *)responsesJSONTransformer {
+    return nil;
+}
+
+@end
+
+// The JSON form of a model value, matching what -aws_setAttributeValue: sets.
+static NSDictionary *AWSDynamoDBObjectMapperJSONAttributeValue(id value) {
+    //doesn't support NULL type yet.
+    //must be ahead of [value isKindOfClass:[NSNumber class]]
+    if ([value isKindOfClass:[[NSNumber numberWithBool:YES] class]]) {
+        return @{@"BOOL" : value};
+    } else if ([value isKindOfClass:[NSString class]]) {
+        return @{@"S" : value};
+    } else if ([value isKindOfClass:[NSNumber class]]) {
+        return @{@"N" : [value stringValue]};
+    } else if ([value isKindOfClass:[NSData class]]) {
+        return @{@"B" : value};
+    } else if ([value isKindOfClass:[NSSet class]] && [(NSSet *)value count] > 0) {
+        id anyObject = [value anyObject];
+        if ([anyObject isKindOfClass:[NSString class]]) {
+            return @{@"SS" : [value allObjects]};
+        } else if ([anyObject isKindOfClass:[NSNumber class]]) {
+            NSMutableArray *NS = [NSMutableArray arrayWithCapacity:[(NSSet *)value count]];
+            for (NSNumber *number in value) {
+                [NS addObject:[number stringValue]];
+            }
+            return @{@"NS" : NS};
+        } else if ([anyObject isKindOfClass:[NSData class]]) {
+            return @{@"BS" : [value allObjects]};
+        }
+    } else if ([value isKindOfClass:[NSArray class]] && [(NSArray *)value count] > 0) {
+        NSMutableArray *list = [NSMutableArray arrayWithCapacity:[(NSArray *)value count]];
+        for (id listItem in value) {
+            [list addObject:AWSDynamoDBObjectMapperJSONAttributeValue(listItem)];
+        }
+        return @{@"L" : list};
+    } else if ([value isKindOfClass:[NSDictionary class]] && [(NSDictionary *)value count] > 0) {
+        NSMutableDictionary *map = [NSMutableDictionary dictionaryWithCapacity:[(NSDictionary *)value count]];
+        for (NSString *mapItemKey in value) {
+            map[mapItemKey] = AWSDynamoDBObjectMapperJSONAttributeValue(value[mapItemKey]);
+        }
+        return @{@"M" : map};
+    }
+
+    return @{};
+}
+
+// The model value of an attribute value in JSON form, matching what -aws_getAttributeValue returns.
+static id AWSDynamoDBObjectMapperValueFromJSONAttributeValue(NSDictionary *JSONAttributeValue) {
+    if (![JSONAttributeValue isKindOfClass:[NSDictionary class]]) {
+        return nil;
+    }
+
+    //Does not support NULL yet.
+    id value = nil;
+    if ((value = JSONAttributeValue[@"BOOL"])) {
+        return value;
+    } else if ((value = JSONAttributeValue[@"S"])) {
+        return value;
+    } else if ((value = JSONAttributeValue[@"N"])) {
+        return [NSNumber aws_numberFromString:value];
+    } else if ((value = JSONAttributeValue[@"B"])) {
+        return value;
+    } else if ((value = JSONAttributeValue[@"SS"])) {
+        return [NSSet setWithArray:value];
+    } else if ((value = JSONAttributeValue[@"NS"])) {
+        NSMutableSet *mutableSet = [NSMutableSet setWithCapacity:[(NSArray *)value count]];
+        for (NSString *number in value) {
+            [mutableSet addObject:[NSNumber aws_numberFromString:number]];
+        }
+        return mutableSet;
+    } else if ((value = JSONAttributeValue[@"BS"])) {
+        return [NSSet setWithArray:value];
+    } else if ((value = JSONAttributeValue[@"L"])) {
+        NSMutableArray *list = [NSMutableArray arrayWithCapacity:[(NSArray *)value count]];
+        for (NSDictionary *listItem in value) {
+            id listItemValue = AWSDynamoDBObjectMapperValueFromJSONAttributeValue(listItem);
+            if (listItemValue) {
+                [list addObject:listItemValue];
+            }
+        }
+        return list;
+    } else if ((value = JSONAttributeValue[@"M"])) {
+        NSMutableDictionary *map = [NSMutableDictionary dictionaryWithCapacity:[(NSDictionary *)value count]];
+        for (NSString *entryKey in value) {
+            id entryValue = AWSDynamoDBObjectMapperValueFromJSONAttributeValue(value[entryKey]);
+            if (entryValue) {
+                map[entryKey] = entryValue;
+            }
+        }
+        return map;
+    }
+
+    return nil;
+}
+
+/**
+ The key and ignored attributes of a model class, worked out once per class.
+ */
+@interface AWSDynamoDBObjectMapperModelPlan : NSObject
+
+@property (nonatomic, strong, readonly) NSString *hashKeyAttribute;
+@property (nonatomic, strong, readonly) NSString *rangeKeyAttribute;
+@property (nonatomic, strong, readonly) NSSet<NSString *> *ignoredAttributes;
+
++ (instancetype)planForClass:(Class)modelClass;
+
+@end
+
+// Used to cache the AWSDynamoDBObjectMapperModelPlan of a model class.
+static void *AWSDynamoDBObjectMapperModelPlanKey = &AWSDynamoDBObjectMapperModelPlanKey;
+
+@implementation AWSDynamoDBObjectMapperModelPlan
+
++ (instancetype)planForClass:(Class)modelClass {
+    AWSDynamoDBObjectMapperModelPlan *plan = objc_getAssociatedObject(modelClass, AWSDynamoDBObjectMapperModelPlanKey);
+    if (plan) {
+        return plan;
+    }
+
+    plan = [AWSDynamoDBObjectMapperModelPlan new];
+    plan->_hashKeyAttribute = [plan aws_hashKeyAttributeForClass:modelClass];
+    plan->_rangeKeyAttribute = [plan aws_rangeKeyAttributeForClass:modelClass];
+    if ([modelClass respondsToSelector:@selector(ignoreAttributes)]) {
+        plan->_ignoredAttributes = [NSSet setWithArray:[modelClass performSelector:@selector(ignoreAttributes)]];
+    }
+
+    // Another thread may have built the same plan meanwhile, either one will do.
+    objc_setAssociatedObject(modelClass, AWSDynamoDBObjectMapperModelPlanKey, plan, OBJC_ASSOCIATION_RETAIN);
+
+    return plan;
+}
+
+@end
+
+/**
+ Runs batches through a block with at most a given number in flight. Stops
+ handing out batches after the first failure.
+ */
+@interface AWSDynamoDBObjectMapperBatchRun : NSObject
+
+@property (nonatomic, strong) NSArray *batches;
+@property (nonatomic, copy) AWSTask *(^batchBlock)(id batch);
+@property (nonatomic, assign) NSUInteger nextBatchIndex;
+@property (nonatomic, strong) NSError *error;
+
+@end
+
+@implementation AWSDynamoDBObjectMapperBatchRun
+
+- (AWSTask *)runWithMaxConcurrency:(NSUInteger)maxConcurrency {
+    NSUInteger laneCount = MIN(MAX(maxConcurrency, 1), self.batches.count);
+    NSMutableArray *lanes = [NSMutableArray arrayWithCapacity:laneCount];
+    for (NSUInteger i = 0; i < laneCount; i++) {
+        [lanes addObject:[self runNextBatch]];
+    }
+
+    return [[AWSTask taskForCompletionOfAllTasks:lanes] continueWithBlock:^id(AWSTask *task) {
+        if (self.error) {
+            return [AWSTask taskWithError:self.error];
+        }
+        return nil;
+    }];
+}
+
+- (id)nextBatch {
+    @synchronized(self) {
+        if (self.error || self.nextBatchIndex >= self.batches.count) {
+            return nil;
+        }
+        return self.batches[self.nextBatchIndex++];
+    }
+}
+
+- (AWSTask *)runNextBatch {
+    id batch = [self nextBatch];
+    if (!batch) {
+        return [AWSTask taskWithResult:nil];
+    }
+
+    return [self.batchBlock(batch) continueWithBlock:^id(AWSTask *task) {
+        if (task.error) {
+            @synchronized(self) {
+                if (!self.error) {
+                    self.error = task.error;
+                }
+            }
+            return nil;
+        }
+        return [self runNextBatch];
+    }];
+}
 
 @end
 
@@ -232,6 +554,9 @@ NSString *const AWSDynamoDBObjectMapperUserAgent = @"mapper";
                                       queryInput:(AWSDynamoDBQueryInput *)queryInput;
 - (AWSTask<AWSDynamoDBPaginatedOutput *> *)scan:(Class)resultClass
                                       scanInput:(AWSDynamoDBScanInput *)scanInput;
+- (NSMutableArray *)models:(Class)resultClass
+             fromJSONItems:(NSArray<NSDictionary *> *)JSONItems
+                     error:(NSError **)error;
 
 @end
 
@@ -350,9 +675,9 @@ completionHandler:(void (^ _Nullable)(NSError * _Nullable error))completionHandl
     switch (configuration.saveBehavior) {
         case AWSDynamoDBObjectMapperSaveBehaviorClobber: {
 
-            AWSDynamoDBPutItemInput *putItemInput = [AWSDynamoDBPutItemInput new];
+            AWSDynamoDBPutItemInput *putItemInput = [AWSDynamoDBObjectMapperPutItemInput new];
             putItemInput.tableName = [[model class] performSelector:@selector(dynamoDBTableName)];
-            putItemInput.item = [model itemForPutItemInput];
+            putItemInput.item = [model JSONItemForPutItemInput];
 
             return [self.dynamoDB putItem:putItemInput];
             break;
@@ -361,10 +686,10 @@ completionHandler:(void (^ _Nullable)(NSError * _Nullable error))completionHandl
         case AWSDynamoDBObjectMapperSaveBehaviorUpdateSkipNullAttributes:
         case AWSDynamoDBObjectMapperSaveBehaviorUpdate: {
 
-            AWSDynamoDBUpdateItemInput *updateItemInput = [AWSDynamoDBUpdateItemInput new];
+            AWSDynamoDBUpdateItemInput *updateItemInput = [AWSDynamoDBObjectMapperUpdateItemInput new];
             updateItemInput.tableName = [[model class] performSelector:@selector(dynamoDBTableName)];
-            updateItemInput.attributeUpdates = [model itemForUpdateItemInput:configuration.saveBehavior];
-            updateItemInput.key = [model key];
+            updateItemInput.attributeUpdates = [model JSONAttributeUpdatesForUpdateItemInput:configuration.saveBehavior];
+            updateItemInput.key = [model JSONKey];
 
             return [self.dynamoDB updateItem:updateItemInput];
             break;
@@ -424,6 +749,338 @@ completionHandler:(void (^ _Nullable)(NSError * _Nullable error))completionHandl
     }];
 }
 
+#pragma mark - Batch operations
+
+- (AWSTask *)batchSave:(NSArray<AWSDynamoDBObjectModel<AWSDynamoDBModeling> *> *)models {
+    return [self batchSave:models
+             configuration:self.objectMapperConfiguration];
+}
+
+- (void)batchSave:(NSArray<AWSDynamoDBObjectModel<AWSDynamoDBModeling> *> *)models
+completionHandler:(void (^ _Nullable)(NSError * _Nullable error))completionHandler {
+    [self batchSave:models configuration:self.objectMapperConfiguration completionHandler:completionHandler];
+}
+
+- (AWSTask *)batchSave:(NSArray<AWSDynamoDBObjectModel<AWSDynamoDBModeling> *> *)models
+         configuration:(AWSDynamoDBObjectMapperConfiguration *)configuration {
+    NSMutableArray *tableNames = [NSMutableArray arrayWithCapacity:models.count];
+    NSMutableArray *writeRequests = [NSMutableArray arrayWithCapacity:models.count];
+    for (AWSDynamoDBObjectModel<AWSDynamoDBModeling> *model in models) {
+        AWSDynamoDBPutRequest *putRequest = [AWSDynamoDBObjectMapperPutRequest new];
+        putRequest.item = [model JSONItemForPutItemInput];
+        AWSDynamoDBWriteRequest *writeRequest = [AWSDynamoDBWriteRequest new];
+        writeRequest.putRequest = putRequest;
+
+        [tableNames addObject:[[model class] performSelector:@selector(dynamoDBTableName)]];
+        [writeRequests addObject:writeRequest];
+    }
+
+    return [self batchWriteRequests:writeRequests
+                         tableNames:tableNames
+                      configuration:configuration];
+}
+
+- (void)batchSave:(NSArray<AWSDynamoDBObjectModel<AWSDynamoDBModeling> *> *)models
+    configuration:(AWSDynamoDBObjectMapperConfiguration *)configuration
+completionHandler:(void (^ _Nullable)(NSError * _Nullable error))completionHandler {
+    [[self batchSave:models
+       configuration:configuration] continueWithBlock:^id _Nullable(AWSTask * _Nonnull task) {
+        NSError *error = task.error;
+
+        if (completionHandler) {
+            completionHandler(error);
+        }
+        return nil;
+    }];
+}
+
+- (AWSTask *)batchRemove:(NSArray<AWSDynamoDBObjectModel<AWSDynamoDBModeling> *> *)models {
+    return [self batchRemove:models
+               configuration:self.objectMapperConfiguration];
+}
+
+- (void)batchRemove:(NSArray<AWSDynamoDBObjectModel<AWSDynamoDBModeling> *> *)models
+  completionHandler:(void (^ _Nullable)(NSError * _Nullable error))completionHandler {
+    [self batchRemove:models configuration:self.objectMapperConfiguration completionHandler:completionHandler];
+}
+
+- (AWSTask *)batchRemove:(NSArray<AWSDynamoDBObjectModel<AWSDynamoDBModeling> *> *)models
+           configuration:(AWSDynamoDBObjectMapperConfiguration *)configuration {
+    NSMutableArray *tableNames = [NSMutableArray arrayWithCapacity:models.count];
+    NSMutableArray *writeRequests = [NSMutableArray arrayWithCapacity:models.count];
+    for (AWSDynamoDBObjectModel<AWSDynamoDBModeling> *model in models) {
+        AWSDynamoDBDeleteRequest *deleteRequest = [AWSDynamoDBDeleteRequest new];
+        deleteRequest.key = [model key];
+        AWSDynamoDBWriteRequest *writeRequest = [AWSDynamoDBWriteRequest new];
+        writeRequest.deleteRequest = deleteRequest;
+
+        [tableNames addObject:[[model class] performSelector:@selector(dynamoDBTableName)]];
+        [writeRequests addObject:writeRequest];
+    }
+
+    return [self batchWriteRequests:writeRequests
+                         tableNames:tableNames
+                      configuration:configuration];
+}
+
+- (void)batchRemove:(NSArray<AWSDynamoDBObjectModel<AWSDynamoDBModeling> *> *)models
+      configuration:(AWSDynamoDBObjectMapperConfiguration *)configuration
+  completionHandler:(void (^ _Nullable)(NSError * _Nullable error))completionHandler {
+    [[self batchRemove:models
+         configuration:configuration] continueWithBlock:^id _Nullable(AWSTask * _Nonnull task) {
+        NSError *error = task.error;
+
+        if (completionHandler) {
+            completionHandler(error);
+        }
+        return nil;
+    }];
+}
+
+- (AWSTask<NSArray<AWSDynamoDBObjectModel<AWSDynamoDBModeling> *> *> *)batchLoad:(NSArray<AWSDynamoDBObjectModel<AWSDynamoDBModeling> *> *)keyModels {
+    return [self batchLoad:keyModels
+             configuration:self.objectMapperConfiguration];
+}
+
+- (void)batchLoad:(NSArray<AWSDynamoDBObjectModel<AWSDynamoDBModeling> *> *)keyModels
+completionHandler:(void (^ _Nullable)(NSArray<AWSDynamoDBObjectModel<AWSDynamoDBModeling> *> * _Nullable response, NSError * _Nullable error))completionHandler {
+    [self batchLoad:keyModels configuration:self.objectMapperConfiguration completionHandler:completionHandler];
+}
+
+- (AWSTask<NSArray<AWSDynamoDBObjectModel<AWSDynamoDBModeling> *> *> *)batchLoad:(NSArray<AWSDynamoDBObjectModel<AWSDynamoDBModeling> *> *)keyModels
+                                                                    configuration:(AWSDynamoDBObjectMapperConfiguration *)configuration {
+    if (!configuration) {
+        configuration = self.objectMapperConfiguration;
+    }
+
+    NSMutableArray *tableNames = [NSMutableArray arrayWithCapacity:keyModels.count];
+    NSMutableArray *keys = [NSMutableArray arrayWithCapacity:keyModels.count];
+    NSMutableSet *tableKeys = [NSMutableSet setWithCapacity:keyModels.count];
+    NSMutableDictionary<NSString *, Class> *resultClasses = [NSMutableDictionary new];
+    for (AWSDynamoDBObjectModel<AWSDynamoDBModeling> *keyModel in keyModels) {
+        NSString *tableName = [[keyModel class] performSelector:@selector(dynamoDBTableName)];
+        // The response does not say which key an item was loaded for, so each table maps to one class.
+        Class resultClass = resultClasses[tableName];
+        if (!resultClass) {
+            resultClasses[tableName] = [keyModel class];
+        } else if (resultClass != [keyModel class]) {
+            NSString *description = [NSString stringWithFormat:@"The models for table %@ are of more than one class: %@ and %@.",
+                                     tableName, NSStringFromClass(resultClass), NSStringFromClass([keyModel class])];
+            return [AWSTask taskWithError:[NSError errorWithDomain:AWSDynamoDBObjectMapperErrorDomain
+                                                              code:AWSDynamoDBObjectMapperErrorConflictingModelClasses
+                                                          userInfo:@{NSLocalizedDescriptionKey : description}]];
+        }
+
+        // BatchGetItem rejects a request that repeats a key, so each key is loaded once.
+        NSDictionary *key = [keyModel key];
+        NSArray *tableKey = @[tableName, key];
+        if ([tableKeys containsObject:tableKey]) {
+            continue;
+        }
+        [tableKeys addObject:tableKey];
+
+        [tableNames addObject:tableName];
+        [keys addObject:key];
+    }
+
+    NSMutableArray *results = [NSMutableArray arrayWithCapacity:keyModels.count];
+    NSDate *deadline = [NSDate dateWithTimeIntervalSinceNow:configuration.batchRetryTimeout];
+    AWSDynamoDBObjectMapperBatchRun *batchRun = [AWSDynamoDBObjectMapperBatchRun new];
+    batchRun.batches = [self batchesOfRequests:keys
+                                    tableNames:tableNames
+                                     batchSize:AWSDynamoDBObjectMapperMaxBatchGetKeys];
+    batchRun.batchBlock = ^AWSTask *(NSDictionary<NSString *, NSArray *> *batch) {
+        NSMutableDictionary *requestItems = [NSMutableDictionary dictionaryWithCapacity:batch.count];
+        for (NSString *tableName in batch) {
+            AWSDynamoDBKeysAndAttributes *keysAndAttributes = [AWSDynamoDBKeysAndAttributes new];
+            keysAndAttributes.keys = batch[tableName];
+            keysAndAttributes.consistentRead = configuration.consistentRead;
+            requestItems[tableName] = keysAndAttributes;
+        }
+        return [self batchGetRequestItems:requestItems
+                            resultClasses:resultClasses
+                                  results:results
+                                  attempt:0
+                                 deadline:deadline];
+    };
+
+    return [[batchRun runWithMaxConcurrency:configuration.maxConcurrentBatchRequests] continueWithSuccessBlock:^id(AWSTask *task) {
+        @synchronized(results) {
+            return [results copy];
+        }
+    }];
+}
+
+- (void)batchLoad:(NSArray<AWSDynamoDBObjectModel<AWSDynamoDBModeling> *> *)keyModels
+    configuration:(AWSDynamoDBObjectMapperConfiguration *)configuration
+completionHandler:(void (^ _Nullable)(NSArray<AWSDynamoDBObjectModel<AWSDynamoDBModeling> *> * _Nullable response, NSError * _Nullable error))completionHandler {
+    [[self batchLoad:keyModels
+       configuration:configuration] continueWithBlock:^id _Nullable(AWSTask * _Nonnull task) {
+        NSArray *response = task.result;
+        NSError *error = task.error;
+
+        if (completionHandler) {
+            completionHandler(response, error);
+        }
+        return nil;
+    }];
+}
+
+// Internal method
+- (AWSTask *)batchWriteRequests:(NSArray<AWSDynamoDBWriteRequest *> *)writeRequests
+                     tableNames:(NSArray<NSString *> *)tableNames
+                  configuration:(AWSDynamoDBObjectMapperConfiguration *)configuration {
+    if (!configuration) {
+        configuration = self.objectMapperConfiguration;
+    }
+
+    NSDate *deadline = [NSDate dateWithTimeIntervalSinceNow:configuration.batchRetryTimeout];
+    AWSDynamoDBObjectMapperBatchRun *batchRun = [AWSDynamoDBObjectMapperBatchRun new];
+    batchRun.batches = [self batchesOfRequests:writeRequests
+                                    tableNames:tableNames
+                                     batchSize:AWSDynamoDBObjectMapperMaxBatchWriteRequests];
+    batchRun.batchBlock = ^AWSTask *(NSDictionary<NSString *, NSArray *> *batch) {
+        return [self batchWriteRequestItems:batch
+                                    attempt:0
+                                   deadline:deadline];
+    };
+
+    return [batchRun runWithMaxConcurrency:configuration.maxConcurrentBatchRequests];
+}
+
+// Internal method
+// Splits the requests, in order, into batches of at most batchSize requests,
+// each keyed by table name.
+- (NSArray<NSDictionary<NSString *, NSArray *> *> *)batchesOfRequests:(NSArray *)requests
+                                                           tableNames:(NSArray<NSString *> *)tableNames
+                                                            batchSize:(NSUInteger)batchSize {
+    NSMutableArray *batches = [NSMutableArray arrayWithCapacity:(requests.count + batchSize - 1) / batchSize];
+    for (NSUInteger start = 0; start < requests.count; start += batchSize) {
+        NSMutableDictionary<NSString *, NSMutableArray *> *batch = [NSMutableDictionary new];
+        for (NSUInteger i = start; i < MIN(start + batchSize, requests.count); i++) {
+            NSMutableArray *tableRequests = batch[tableNames[i]];
+            if (!tableRequests) {
+                tableRequests = [NSMutableArray new];
+                batch[tableNames[i]] = tableRequests;
+            }
+            [tableRequests addObject:requests[i]];
+        }
+        [batches addObject:batch];
+    }
+
+    return batches;
+}
+
+// Internal method
+- (AWSTask *)batchWriteRequestItems:(NSDictionary<NSString *, NSArray<AWSDynamoDBWriteRequest *> *> *)requestItems
+                            attempt:(uint32_t)attempt
+                           deadline:(NSDate *)deadline {
+    AWSDynamoDBBatchWriteItemInput *batchWriteItemInput = [AWSDynamoDBBatchWriteItemInput new];
+    batchWriteItemInput.requestItems = requestItems;
+
+    return [[self.dynamoDB batchWriteItem:batchWriteItemInput] continueWithSuccessBlock:^id(AWSTask<AWSDynamoDBBatchWriteItemOutput *> *task) {
+        NSDictionary<NSString *, NSArray<AWSDynamoDBWriteRequest *> *> *unprocessedItems = [self nonEmptyRequestItems:task.result.unprocessedItems];
+        if ([unprocessedItems count] == 0) {
+            return nil;
+        }
+
+        return [[self backoffForAttempt:attempt
+                               deadline:deadline
+                       unprocessedItems:unprocessedItems] continueWithSuccessBlock:^id(AWSTask *task) {
+            return [self batchWriteRequestItems:unprocessedItems
+                                        attempt:attempt + 1
+                                       deadline:deadline];
+        }];
+    }];
+}
+
+// Internal method
+- (AWSTask *)batchGetRequestItems:(NSDictionary<NSString *, AWSDynamoDBKeysAndAttributes *> *)requestItems
+                    resultClasses:(NSDictionary<NSString *, Class> *)resultClasses
+                          results:(NSMutableArray *)results
+                          attempt:(uint32_t)attempt
+                         deadline:(NSDate *)deadline {
+    AWSDynamoDBBatchGetItemInput *batchGetItemInput = [AWSDynamoDBBatchGetItemInput new];
+    batchGetItemInput.requestItems = requestItems;
+
+    return [[self.dynamoDB invokeRequest:batchGetItemInput
+                              HTTPMethod:AWSHTTPMethodPOST
+                               URLString:@""
+                            targetPrefix:@"DynamoDB_20120810"
+                           operationName:@"BatchGetItem"
+                             outputClass:[AWSDynamoDBObjectMapperBatchGetItemOutput class]] continueWithSuccessBlock:^id(AWSTask<AWSDynamoDBBatchGetItemOutput *> *task) {
+        AWSDynamoDBBatchGetItemOutput *batchGetItemOutput = task.result;
+
+        NSMutableArray *models = [NSMutableArray new];
+        NSError *error = nil;
+        for (NSString *tableName in batchGetItemOutput.responses) {
+            NSArray *tableModels = [self models:resultClasses[tableName]
+                                  fromJSONItems:batchGetItemOutput.responses[tableName]
+                                          error:&error];
+            if (error) {
+                return [AWSTask taskWithError:error];
+            }
+            [models addObjectsFromArray:tableModels];
+        }
+        @synchronized(results) {
+            [results addObjectsFromArray:models];
+        }
+
+        NSMutableDictionary<NSString *, AWSDynamoDBKeysAndAttributes *> *unprocessedKeys = [NSMutableDictionary new];
+        [batchGetItemOutput.unprocessedKeys enumerateKeysAndObjectsUsingBlock:^(NSString *tableName, AWSDynamoDBKeysAndAttributes *keysAndAttributes, BOOL *stop) {
+            if ([keysAndAttributes.keys count] > 0) {
+                unprocessedKeys[tableName] = keysAndAttributes;
+            }
+        }];
+        if ([unprocessedKeys count] == 0) {
+            return nil;
+        }
+
+        return [[self backoffForAttempt:attempt
+                               deadline:deadline
+                       unprocessedItems:unprocessedKeys] continueWithSuccessBlock:^id(AWSTask *task) {
+            return [self batchGetRequestItems:unprocessedKeys
+                                resultClasses:resultClasses
+                                      results:results
+                                      attempt:attempt + 1
+                                     deadline:deadline];
+        }];
+    }];
+}
+
+// Internal method
+- (NSDictionary *)nonEmptyRequestItems:(NSDictionary<NSString *, NSArray *> *)requestItems {
+    NSMutableDictionary *nonEmptyRequestItems = [NSMutableDictionary new];
+    [requestItems enumerateKeysAndObjectsUsingBlock:^(NSString *tableName, NSArray *requests, BOOL *stop) {
+        if ([requests count] > 0) {
+            nonEmptyRequestItems[tableName] = requests;
+        }
+    }];
+
+    return nonEmptyRequestItems;
+}
+
+// Internal method
+// Exponential backoff with jitter before resubmitting unprocessed items. Fails
+// with the unprocessed items if the wait would run past the deadline.
+- (AWSTask *)backoffForAttempt:(uint32_t)attempt
+                      deadline:(NSDate *)deadline
+              unprocessedItems:(NSDictionary *)unprocessedItems {
+    uint32_t backoff = MIN(AWSDynamoDBObjectMapperBatchBackoffCap, AWSDynamoDBObjectMapperBatchBackoffBase << MIN(attempt, 16));
+    uint32_t delay = backoff / 2 + arc4random_uniform(backoff / 2 + 1);
+
+    if ([deadline timeIntervalSinceNow] * 1000 < delay) {
+        AWSDDLogError(@"Items were still unprocessed when the batch retry timeout passed: %@", unprocessedItems);
+        return [AWSTask taskWithError:[NSError errorWithDomain:AWSDynamoDBObjectMapperErrorDomain
+                                                          code:AWSDynamoDBObjectMapperErrorUnprocessedItems
+                                                      userInfo:@{NSLocalizedDescriptionKey : @"Items were still unprocessed when the batch retry timeout passed.",
+                                                                 AWSDynamoDBObjectMapperUnprocessedItemsKey : unprocessedItems}]];
+    }
+
+    AWSDDLogDebug(@"Resubmitting unprocessed items in %u ms.", delay);
+    return [AWSTask taskWithDelay:(int)delay];
+}
+
 - (AWSTask *)load:(Class)resultClass
           hashKey:(id)hashKey
          rangeKey:(id)rangeKey {
@@ -468,11 +1125,16 @@ completionHandler:completionHandler];
     }
     getItemInput.key = key;
 
-    return [[self.dynamoDB getItem:getItemInput] continueWithSuccessBlock:^id(AWSTask *task) {
+    return [[self.dynamoDB invokeRequest:getItemInput
+                              HTTPMethod:AWSHTTPMethodPOST
+                               URLString:@""
+                            targetPrefix:@"DynamoDB_20120810"
+                           operationName:@"GetItem"
+                             outputClass:[AWSDynamoDBObjectMapperGetItemOutput class]] continueWithSuccessBlock:^id(AWSTask *task) {
         AWSDynamoDBGetItemOutput *getItemOutput = task.result;
 
         NSError *error = nil;
-        NSDictionary *itemsDictionary = [self removeAttributes:getItemOutput.item];
+        NSDictionary *itemsDictionary = [self modelDictionaryFromJSONItem:getItemOutput.item];
 
         id responseObject = nil;
         if ([itemsDictionary count] > 0) {
@@ -586,22 +1248,20 @@ completionHandler:completionHandler];
 // Internal class
 - (AWSTask<AWSDynamoDBPaginatedOutput *> *)query:(Class)resultClass
                                       queryInput:(AWSDynamoDBQueryInput *)queryInput {
-    return [[self.dynamoDB query:queryInput] continueWithSuccessBlock:^id(AWSTask *task) {
+    return [[self.dynamoDB invokeRequest:queryInput
+                              HTTPMethod:AWSHTTPMethodPOST
+                               URLString:@""
+                            targetPrefix:@"DynamoDB_20120810"
+                           operationName:@"Query"
+                             outputClass:[AWSDynamoDBObjectMapperQueryOutput class]] continueWithSuccessBlock:^id(AWSTask *task) {
         AWSDynamoDBQueryOutput *queryOutput = task.result;
 
-        NSMutableArray *items = [NSMutableArray new];
         NSError *error = nil;
-        for (id item in queryOutput.items) {
-
-            NSDictionary *itemsDictionary = [self removeAttributes:item];
-
-            id responseObject = [AWSMTLJSONAdapter modelOfClass:resultClass
-                                             fromJSONDictionary:itemsDictionary
-                                                          error:&error];
-            if (error) {
-                return [AWSTask taskWithError:error];
-            }
-            [items addObject:responseObject];
+        NSMutableArray *items = [self models:resultClass
+                               fromJSONItems:queryOutput.items
+                                       error:&error];
+        if (error) {
+            return [AWSTask taskWithError:error];
         }
 
         AWSDynamoDBPaginatedOutput *paginatedOutput = [AWSDynamoDBPaginatedOutput new];
@@ -651,6 +1311,14 @@ completionHandler:completionHandler];
 - (AWSTask<AWSDynamoDBPaginatedOutput *> *)scan:(Class)resultClass
                                      expression:(AWSDynamoDBScanExpression *)expression
                                   configuration:(AWSDynamoDBObjectMapperConfiguration *)configuration {
+    return [self scan:resultClass
+            scanInput:[self scanInput:resultClass
+                           expression:expression]];
+}
+
+// Internal method
+- (AWSDynamoDBScanInput *)scanInput:(Class)resultClass
+                         expression:(AWSDynamoDBScanExpression *)expression {
     AWSDynamoDBScanInput *scanInput = [AWSDynamoDBScanInput new];
     scanInput.tableName = [resultClass performSelector:@selector(dynamoDBTableName)];
     scanInput.limit = expression.limit;
@@ -676,28 +1344,26 @@ completionHandler:completionHandler];
     scanInput.projectionExpression = expression.projectionExpression;
     scanInput.expressionAttributeNames = expression.expressionAttributeNames;
 
-    return [self scan:resultClass
-            scanInput:scanInput];
+    return scanInput;
 }
 
 // Internal class
 - (AWSTask<AWSDynamoDBPaginatedOutput *> *)scan:(Class)resultClass
                                       scanInput:(AWSDynamoDBScanInput *)scanInput {
-    return [[self.dynamoDB scan:scanInput] continueWithSuccessBlock:^id(AWSTask *task) {
+    return [[self.dynamoDB invokeRequest:scanInput
+                              HTTPMethod:AWSHTTPMethodPOST
+                               URLString:@""
+                            targetPrefix:@"DynamoDB_20120810"
+                           operationName:@"Scan"
+                             outputClass:[AWSDynamoDBObjectMapperScanOutput class]] continueWithSuccessBlock:^id(AWSTask *task) {
         AWSDynamoDBScanOutput *scanOutput = task.result;
 
-        NSMutableArray *items = [NSMutableArray new];
         NSError *error = nil;
-        for (id item in scanOutput.items) {
-
-            NSDictionary *itemsDictionary = [self removeAttributes:item];
-            id responseObject = [AWSMTLJSONAdapter modelOfClass:resultClass
-                                             fromJSONDictionary:itemsDictionary
-                                                          error:&error];
-            if (error) {
-                return [AWSTask taskWithError:error];
-            }
-            [items addObject:responseObject];
+        NSMutableArray *items = [self models:resultClass
+                               fromJSONItems:scanOutput.items
+                                       error:&error];
+        if (error) {
+            return [AWSTask taskWithError:error];
         }
 
         AWSDynamoDBPaginatedOutput *paginatedOutput = [AWSDynamoDBPaginatedOutput new];
@@ -728,124 +1394,156 @@ completionHandler:(void (^ _Nullable)(AWSDynamoDBPaginatedOutput * _Nullable res
     }];
 }
 
-#pragma mark - Utility
+- (AWSDynamoDBParallelScanOutput *)parallelScan:(Class)resultClass
+                                     expression:(AWSDynamoDBScanExpression *)expression
+                                  totalSegments:(NSUInteger)totalSegments {
+    return [self parallelScan:resultClass
+                   expression:expression
+                totalSegments:totalSegments
+                configuration:self.objectMapperConfiguration];
+}
 
-- (NSDictionary *)removeAttributes:(NSDictionary *)item {
-    NSMutableDictionary *mutableItem = [NSMutableDictionary new];
-    [item enumerateKeysAndObjectsUsingBlock:^(id key, id obj, BOOL *stop) {
-        if ([obj respondsToSelector:@selector(aws_getAttributeValue)]) {
-            id value = [obj aws_getAttributeValue];
-            if (value) {
-                [mutableItem setObject:value
-                                forKey:key];
-            }
+- (AWSDynamoDBParallelScanOutput *)parallelScan:(Class)resultClass
+                                     expression:(AWSDynamoDBScanExpression *)expression
+                                  totalSegments:(NSUInteger)totalSegments
+                                  configuration:(AWSDynamoDBObjectMapperConfiguration *)configuration {
+    if (!configuration) {
+        configuration = self.objectMapperConfiguration;
+    }
+
+    AWSDynamoDBScanInput *scanInput = [self scanInput:resultClass
+                                           expression:expression];
+    scanInput.exclusiveStartKey = nil;
+    totalSegments = MIN(MAX(totalSegments, 1), AWSDynamoDBObjectMapperMaxScanSegments);
+    NSMutableArray<AWSDynamoDBScanInput *> *segmentInputs = [NSMutableArray arrayWithCapacity:totalSegments];
+    for (NSUInteger segment = 0; segment < totalSegments; segment++) {
+        AWSDynamoDBScanInput *segmentInput = [scanInput copy];
+        if (totalSegments > 1) {
+            segmentInput.segment = @(segment);
+            segmentInput.totalSegments = @(totalSegments);
         }
-    }];
+        [segmentInputs addObject:segmentInput];
+    }
 
-    return mutableItem;
+    AWSDynamoDBParallelScanOutput *parallelScanOutput = [[AWSDynamoDBParallelScanOutput alloc] initWithObjectMapper:self
+                                                                                                         resultClass:resultClass
+                                                                                                       segmentInputs:segmentInputs
+                                                                                                    maxBufferedPages:configuration.maxBufferedScanPages];
+    [parallelScanOutput start];
+
+    return parallelScanOutput;
 }
 
-@end
+#pragma mark - Utility
 
-@implementation AWSDynamoDBObjectModel
+- (NSMutableArray *)models:(Class)resultClass
+             fromJSONItems:(NSArray<NSDictionary *> *)JSONItems
+                     error:(NSError **)error {
+    NSMutableArray *models = [NSMutableArray arrayWithCapacity:[JSONItems count]];
+    for (NSDictionary *JSONItem in JSONItems) {
+        id model = nil;
+        NSError *modelError = nil;
+        @autoreleasepool {
+            model = [AWSMTLJSONAdapter modelOfClass:resultClass
+                                 fromJSONDictionary:[self modelDictionaryFromJSONItem:JSONItem]
+                                              error:&modelError];
+        }
+        if (!model) {
+            if (error) {
+                *error = modelError;
+            }
+            return nil;
+        }
+        [models addObject:model];
+    }
 
-+ (NSDictionary *)JSONKeyPathsByPropertyKey {
-    return nil;
+    return models;
 }
 
-- (NSDictionary *)removeIgnoredAttributesFromJSONDictionary:(NSDictionary *)JSONDictionary {
-    if ([[self class] respondsToSelector:@selector(ignoreAttributes)] == NO) {
-        return JSONDictionary;
+- (NSDictionary *)modelDictionaryFromJSONItem:(NSDictionary *)JSONItem {
+    NSMutableDictionary *modelDictionary = [NSMutableDictionary dictionaryWithCapacity:[JSONItem count]];
+    for (NSString *attributeName in JSONItem) {
+        id value = AWSDynamoDBObjectMapperValueFromJSONAttributeValue(JSONItem[attributeName]);
+        if (value) {
+            modelDictionary[attributeName] = value;
+        }
     }
 
-    NSArray *ignoredAttrArray = [[self class] performSelector:@selector(ignoreAttributes)];
-    NSMutableDictionary *resultDictionary = [JSONDictionary mutableCopy];
-    [resultDictionary removeObjectsForKeys:ignoredAttrArray];
-    return resultDictionary;
+    return modelDictionary;
 }
 
-- (NSDictionary *)itemForPutItemInput {
-    NSMutableDictionary *item = [NSMutableDictionary new];
-    NSMutableArray *keyArray = [NSMutableArray new];
+@end
 
-    NSString *hashKeyAttribute = [self aws_hashKeyAttributeForClass:[self class]];
-    [keyArray addObject:hashKeyAttribute];
+@implementation AWSDynamoDBObjectModel
 
-    NSString *rangeKeyAttribute = [self aws_rangeKeyAttributeForClass:[self class]];
-    if (rangeKeyAttribute) {
-        [keyArray addObject:rangeKeyAttribute];
-    }
++ (NSDictionary *)JSONKeyPathsByPropertyKey {
+    return nil;
+}
 
+- (NSDictionary *)JSONItemForPutItemInput {
+    AWSDynamoDBObjectMapperModelPlan *plan = [AWSDynamoDBObjectMapperModelPlan planForClass:[self class]];
     NSDictionary *dictionaryValue = [AWSMTLJSONAdapter JSONDictionaryFromModel:self];
-    dictionaryValue = [self removeIgnoredAttributesFromJSONDictionary:dictionaryValue];
+    NSMutableDictionary *item = [NSMutableDictionary dictionaryWithCapacity:[dictionaryValue count]];
 
-    for (id key in dictionaryValue) {
-        if ([keyArray containsObject:key]) {
+    for (NSString *key in dictionaryValue) {
+        if ([plan.ignoredAttributes containsObject:key]) {
+            continue;
+        }
+        if ([key isEqualToString:plan.hashKeyAttribute] || [key isEqualToString:plan.rangeKeyAttribute]) {
             // For key attributes
-            AWSDynamoDBAttributeValue *keyAttributeValue = [AWSDynamoDBAttributeValue new];
-            [keyAttributeValue aws_setAttributeValue:dictionaryValue[key]];
-            item[key] = keyAttributeValue;
-        } else if (dictionaryValue[key]) {
+            item[key] = AWSDynamoDBObjectMapperJSONAttributeValue(dictionaryValue[key]);
+        } else if (dictionaryValue[key] == [NSNull null]) {
+            //when doing a putItem, we can safely ignore the null-valvued attributes
+        } else {
             // For other attributes
-            if (dictionaryValue[key] == [NSNull null]) {
-                //when doing a putItem, we can safely ignore the null-valvued attributes
-            } else {
-                AWSDynamoDBAttributeValue *attributeValue = [AWSDynamoDBAttributeValue new];
-                [attributeValue aws_setAttributeValue:dictionaryValue[key]];
-                item[key] = attributeValue;
-            }
+            item[key] = AWSDynamoDBObjectMapperJSONAttributeValue(dictionaryValue[key]);
         }
     }
 
     return item;
 }
 
-- (NSDictionary *)itemForUpdateItemInput:(AWSDynamoDBObjectMapperSaveBehavior)behavior {
-    // TODO: update this method to use UpdateExpression instead of AWSDynamoDBAttributeValueUpdate.
-    NSMutableDictionary *item = [NSMutableDictionary new];
-    NSArray *keyArray = [[self key] allKeys];
+- (NSDictionary *)JSONAttributeUpdatesForUpdateItemInput:(AWSDynamoDBObjectMapperSaveBehavior)behavior {
+    // TODO: update this method to use UpdateExpression instead of AttributeUpdates.
+    AWSDynamoDBObjectMapperModelPlan *plan = [AWSDynamoDBObjectMapperModelPlan planForClass:[self class]];
     NSDictionary *dictionaryValue = [AWSMTLJSONAdapter JSONDictionaryFromModel:self];
-    dictionaryValue = [self removeIgnoredAttributesFromJSONDictionary:dictionaryValue];
-
-    for (id key in dictionaryValue) {
-        if (![keyArray containsObject:key]) {
-            // For other attributes
+    NSMutableDictionary *item = [NSMutableDictionary dictionaryWithCapacity:[dictionaryValue count]];
 
-            if (dictionaryValue[key] == [NSNull null]) {
-                //If attribute value is null
-                if (behavior == AWSDynamoDBObjectMapperSaveBehaviorUpdateSkipNullAttributes
-                    || behavior == AWSDynamoDBObjectMapperSaveBehaviorAppendSet) {
-                    /*
-                     * If UPDATE_SKIP_NULL_ATTRIBUTES or APPEND_SET is
-                     * configured, we don't delete null value attributes.
-                     */
-                } else {
-                    /* Delete attributes that are set as null in the object. */
-                    AWSDynamoDBAttributeValueUpdate *attributeValueUpdate = [AWSDynamoDBAttributeValueUpdate new];
-                    attributeValueUpdate.action = AWSDynamoDBAttributeActionDelete;
-
-                    item[key] = attributeValueUpdate;
-                }
+    for (NSString *key in dictionaryValue) {
+        if ([plan.ignoredAttributes containsObject:key]
+            || [key isEqualToString:plan.hashKeyAttribute]
+            || [key isEqualToString:plan.rangeKeyAttribute]) {
+            continue;
+        }
 
+        // For other attributes
+        if (dictionaryValue[key] == [NSNull null]) {
+            //If attribute value is null
+            if (behavior == AWSDynamoDBObjectMapperSaveBehaviorUpdateSkipNullAttributes
+                || behavior == AWSDynamoDBObjectMapperSaveBehaviorAppendSet) {
+                /*
+                 * If UPDATE_SKIP_NULL_ATTRIBUTES or APPEND_SET is
+                 * configured, we don't delete null value attributes.
+                 */
             } else {
-                //If attribute value is not null
-                AWSDynamoDBAttributeValueUpdate *attributeValueUpdate = [AWSDynamoDBAttributeValueUpdate new];
-                AWSDynamoDBAttributeValue *attributeValue = [AWSDynamoDBAttributeValue new];
-                [attributeValue aws_setAttributeValue:dictionaryValue[key]];
-                attributeValueUpdate.value = attributeValue;
-                if (behavior == AWSDynamoDBObjectMapperSaveBehaviorAppendSet &&
-                    (attributeValue.BS != nil || attributeValue.NS != nil || attributeValue.SS != nil)) {
-
-                    /* If it's a set attribute and the mapper is configured with APPEND_SET,
-                     * we do an "ADD" update instead of the default "PUT".
-                     */
-                    attributeValueUpdate.action = AWSDynamoDBAttributeActionAdd;
-                } else {
-                    /* Otherwise, we do the default "PUT" update. */
-                    attributeValueUpdate.action = AWSDynamoDBAttributeActionPut;
-                }
-
-                item[key] = attributeValueUpdate;
+                /* Delete attributes that are set as null in the object. */
+                item[key] = @{@"Action" : @"DELETE"};
+            }
+        } else {
+            //If attribute value is not null
+            NSDictionary *attributeValue = AWSDynamoDBObjectMapperJSONAttributeValue(dictionaryValue[key]);
+            if (behavior == AWSDynamoDBObjectMapperSaveBehaviorAppendSet &&
+                (attributeValue[@"BS"] != nil || attributeValue[@"NS"] != nil || attributeValue[@"SS"] != nil)) {
+
+                /* If it's a set attribute and the mapper is configured with APPEND_SET,
+                 * we do an "ADD" update instead of the default "PUT".
+                 */
+                item[key] = @{@"Action" : @"ADD",
+                              @"Value" : attributeValue};
+            } else {
+                /* Otherwise, we do the default "PUT" update. */
+                item[key] = @{@"Action" : @"PUT",
+                              @"Value" : attributeValue};
             }
         }
     }
@@ -853,6 +1551,19 @@ completionHandler:(void (^ _Nullable)(AWSDynamoDBPaginatedOutput * _Nullable res
     return item;
 }
 
+- (NSDictionary *)JSONKey {
+    AWSDynamoDBObjectMapperModelPlan *plan = [AWSDynamoDBObjectMapperModelPlan planForClass:[self class]];
+    NSDictionary *dictionaryValue = [AWSMTLJSONAdapter JSONDictionaryFromModel:self];
+    NSMutableDictionary *keyDictionary = [NSMutableDictionary dictionaryWithCapacity:2];
+
+    keyDictionary[plan.hashKeyAttribute] = AWSDynamoDBObjectMapperJSONAttributeValue(dictionaryValue[plan.hashKeyAttribute]);
+    if (plan.rangeKeyAttribute) {
+        keyDictionary[plan.rangeKeyAttribute] = AWSDynamoDBObjectMapperJSONAttributeValue(dictionaryValue[plan.rangeKeyAttribute]);
+    }
+
+    return keyDictionary;
+}
+
 - (NSDictionary *)key {
     NSMutableDictionary *keyDictionary = [NSMutableDictionary new];
     NSMutableArray *keyArray = [NSMutableArray new];
@@ -884,6 +1595,9 @@ completionHandler:(void (^ _Nullable)(AWSDynamoDBPaginatedOutput * _Nullable res
 - (instancetype)init {
     if (self = [super init]) {
         _saveBehavior = AWSDynamoDBObjectMapperSaveBehaviorUpdate;
+        _maxConcurrentBatchRequests = AWSDynamoDBObjectMapperDefaultMaxConcurrentBatchRequests;
+        _batchRetryTimeout = AWSDynamoDBObjectMapperDefaultBatchRetryTimeout;
+        _maxBufferedScanPages = AWSDynamoDBObjectMapperDefaultMaxBufferedScanPages;
     }
 
     return self;
@@ -893,6 +1607,9 @@ completionHandler:(void (^ _Nullable)(AWSDynamoDBPaginatedOutput * _Nullable res
     AWSDynamoDBObjectMapperConfiguration *configuration = [[[self class] allocWithZone:zone] init];
     configuration.saveBehavior = self.saveBehavior;
     configuration.consistentRead = [self.consistentRead copy];
+    configuration.maxConcurrentBatchRequests = self.maxConcurrentBatchRequests;
+    configuration.batchRetryTimeout = self.batchRetryTimeout;
+    configuration.maxBufferedScanPages = self.maxBufferedScanPages;
     
     return configuration;
 }
@@ -973,3 +1690,187 @@ completionHandler:(void (^ _Nullable)(AWSDynamoDBPaginatedOutput * _Nullable res
 }
 
 @end
+
+@implementation AWSDynamoDBParallelScanOutput {
+    AWSDynamoDBObjectMapper *_dynamoDBObjectMapper;
+    Class _resultClass;
+    NSArray<AWSDynamoDBScanInput *> *_segmentInputs;
+    NSUInteger _maxBufferedPages;
+
+    // Guards everything below, and is signaled whenever a page arrives or the scan stops.
+    NSCondition *_condition;
+    NSError *_error;
+    BOOL _cancelled;
+    // Pages loaded and not yet enumerated, in the order they arrived.
+    NSMutableArray<NSArray *> *_readyPages;
+    // Segments with more pages, waiting for room in the buffer.
+    NSMutableArray<NSNumber *> *_waitingSegments;
+    NSUInteger _inFlightCount;
+    NSUInteger _unfinishedSegmentCount;
+
+    // Only touched by the enumerating thread.
+    NSArray *_currentPage;
+    NSUInteger _currentIndex;
+}
+
+- (instancetype)initWithObjectMapper:(AWSDynamoDBObjectMapper *)dynamoDBObjectMapper
+                         resultClass:(Class)resultClass
+                       segmentInputs:(NSArray<AWSDynamoDBScanInput *> *)segmentInputs
+                    maxBufferedPages:(NSUInteger)maxBufferedPages {
+    if (self = [super init]) {
+        _dynamoDBObjectMapper = dynamoDBObjectMapper;
+        _resultClass = resultClass;
+        _segmentInputs = segmentInputs;
+        _maxBufferedPages = MAX(maxBufferedPages, 1);
+        _condition = [NSCondition new];
+        _readyPages = [NSMutableArray new];
+        _waitingSegments = [NSMutableArray arrayWithCapacity:segmentInputs.count];
+        for (NSUInteger segment = 0; segment < segmentInputs.count; segment++) {
+            [_waitingSegments addObject:@(segment)];
+        }
+        _unfinishedSegmentCount = segmentInputs.count;
+    }
+
+    return self;
+}
+
+- (NSUInteger)totalSegments {
+    return _segmentInputs.count;
+}
+
+- (NSError *)error {
+    [_condition lock];
+    NSError *error = _error;
+    [_condition unlock];
+
+    return error;
+}
+
+- (BOOL)isCancelled {
+    [_condition lock];
+    BOOL cancelled = _cancelled;
+    [_condition unlock];
+
+    return cancelled;
+}
+
+- (void)start {
+    [_condition lock];
+    NSArray<NSNumber *> *segments = [self segmentsToFetchLocked];
+    [_condition unlock];
+
+    [self fetchSegments:segments];
+}
+
+- (id)nextObject {
+    while (_currentIndex >= _currentPage.count) {
+        NSArray *page = [self nextPage];
+        if (!page) {
+            return nil;
+        }
+        _currentPage = page;
+        _currentIndex = 0;
+    }
+
+    return _currentPage[_currentIndex++];
+}
+
+- (NSArray *)nextPage {
+    NSArray *page = nil;
+    if (_currentIndex < _currentPage.count && !self.isCancelled) {
+        page = [_currentPage subarrayWithRange:NSMakeRange(_currentIndex, _currentPage.count - _currentIndex)];
+    }
+    _currentPage = nil;
+    _currentIndex = 0;
+    if (page) {
+        return page;
+    }
+
+    [_condition lock];
+    while ([_readyPages count] == 0 && _unfinishedSegmentCount > 0 && !_error && !_cancelled) {
+        [_condition wait];
+    }
+    if ([_readyPages count] > 0) {
+        page = _readyPages[0];
+        [_readyPages removeObjectAtIndex:0];
+    }
+    // Taking a page makes room for the next prefetch.
+    NSArray<NSNumber *> *segments = [self segmentsToFetchLocked];
+    [_condition unlock];
+
+    [self fetchSegments:segments];
+
+    return page;
+}
+
+- (void)cancel {
+    [_condition lock];
+    _cancelled = YES;
+    [_readyPages removeAllObjects];
+    [_waitingSegments removeAllObjects];
+    [_condition broadcast];
+    [_condition unlock];
+}
+
+// Internal method
+// Hands out waiting segments while the buffer, counting requests in flight, has room.
+- (NSArray<NSNumber *> *)segmentsToFetchLocked {
+    NSMutableArray<NSNumber *> *segments = [NSMutableArray new];
+    while ([_waitingSegments count] > 0
+           && _inFlightCount + [_readyPages count] < _maxBufferedPages
+           && !_error
+           && !_cancelled) {
+        [segments addObject:_waitingSegments[0]];
+        [_waitingSegments removeObjectAtIndex:0];
+        _inFlightCount++;
+    }
+
+    return segments;
+}
+
+// Internal method
+- (void)fetchSegments:(NSArray<NSNumber *> *)segments {
+    for (NSNumber *segment in segments) {
+        [[_dynamoDBObjectMapper scan:_resultClass
+                           scanInput:_segmentInputs[[segment unsignedIntegerValue]]] continueWithBlock:^id _Nullable(AWSTask<AWSDynamoDBPaginatedOutput *> * _Nonnull task) {
+            [self segment:segment
+              didLoadPage:task.result
+                    error:task.error];
+            return nil;
+        }];
+    }
+}
+
+// Internal method
+- (void)segment:(NSNumber *)segment
+    didLoadPage:(AWSDynamoDBPaginatedOutput *)paginatedOutput
+          error:(NSError *)error {
+    [_condition lock];
+    _inFlightCount--;
+    if (!_error && !_cancelled) {
+        if (error) {
+            AWSDDLogError(@"Segment %@ of the parallel scan failed: %@", segment, error);
+            _error = error;
+            [_readyPages removeAllObjects];
+            [_waitingSegments removeAllObjects];
+        } else {
+            if ([paginatedOutput.items count] > 0) {
+                [_readyPages addObject:paginatedOutput.items];
+            }
+            if (paginatedOutput.lastEvaluatedKey) {
+                // The next request of this segment is only sent once this response is handled.
+                _segmentInputs[[segment unsignedIntegerValue]].exclusiveStartKey = paginatedOutput.lastEvaluatedKey;
+                [_waitingSegments addObject:segment];
+            } else {
+                _unfinishedSegmentCount--;
+            }
+        }
+    }
+    NSArray<NSNumber *> *segments = [self segmentsToFetchLocked];
+    [_condition broadcast];
+    [_condition unlock];
+
+    [self fetchSegments:segments];
+}
+
+@end
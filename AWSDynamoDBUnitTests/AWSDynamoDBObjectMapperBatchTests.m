@@ -0,0 +1,242 @@
+//
+// Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+
+#import <XCTest/XCTest.h>
+#import "AWSDynamoDB.h"
+#import "AWSDynamoDBStubEndpoint.h"
+
+static NSString *const AWSDynamoDBObjectMapperBatchTestsKey = @"AWSDynamoDBObjectMapperBatchTests";
+
+// Another model class for the table of AWSDynamoDBStubEndpointItem.
+@interface AWSDynamoDBObjectMapperBatchTestsOtherItem : AWSDynamoDBStubEndpointItem
+
+@end
+
+@implementation AWSDynamoDBObjectMapperBatchTestsOtherItem
+
+@end
+
+@interface AWSDynamoDBObjectMapperBatchTests : XCTestCase
+
+@property (nonatomic, strong) AWSDynamoDBStubEndpoint *endpoint;
+
+@end
+
+@implementation AWSDynamoDBObjectMapperBatchTests
+
+- (void)setUp {
+    [super setUp];
+    self.endpoint = [[AWSDynamoDBStubEndpoint alloc] initWithKeyAttributes:@{[AWSDynamoDBStubEndpointItem dynamoDBTableName] : @[@"hashKey", @"rangeKey"]}];
+}
+
+- (void)tearDown {
+    [AWSDynamoDBObjectMapper removeDynamoDBObjectMapperForKey:AWSDynamoDBObjectMapperBatchTestsKey];
+    [super tearDown];
+}
+
+- (AWSDynamoDBObjectMapper *)objectMapperWithConfiguration:(AWSDynamoDBObjectMapperConfiguration *)objectMapperConfiguration {
+    AWSServiceConfiguration *configuration = [[AWSServiceConfiguration alloc] initWithRegion:AWSRegionUSEast1
+                                                                         credentialsProvider:nil];
+    [AWSDynamoDBObjectMapper registerDynamoDBObjectMapperWithConfiguration:configuration
+                                                 objectMapperConfiguration:objectMapperConfiguration
+                                                                    forKey:AWSDynamoDBObjectMapperBatchTestsKey];
+    AWSDynamoDBObjectMapper *objectMapper = [AWSDynamoDBObjectMapper DynamoDBObjectMapperForKey:AWSDynamoDBObjectMapperBatchTestsKey];
+    [self.endpoint attachToObjectMapper:objectMapper];
+    return objectMapper;
+}
+
++ (NSArray<AWSDynamoDBStubEndpointItem *> *)itemsWithCount:(NSUInteger)count {
+    NSMutableArray *items = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger i = 0; i < count; i++) {
+        [items addObject:[AWSDynamoDBStubEndpointItem itemWithIndex:i]];
+    }
+    return items;
+}
+
++ (NSArray<AWSDynamoDBStubEndpointItem *> *)keyModelsForItems:(NSArray<AWSDynamoDBStubEndpointItem *> *)items {
+    NSMutableArray *keyModels = [NSMutableArray arrayWithCapacity:items.count];
+    for (AWSDynamoDBStubEndpointItem *item in items) {
+        AWSDynamoDBStubEndpointItem *keyModel = [AWSDynamoDBStubEndpointItem new];
+        keyModel.hashKey = item.hashKey;
+        keyModel.rangeKey = item.rangeKey;
+        [keyModels addObject:keyModel];
+    }
+    return keyModels;
+}
+
+- (void)testBatchSaveChunksAndBoundsConcurrency {
+    AWSDynamoDBObjectMapperConfiguration *configuration = [AWSDynamoDBObjectMapperConfiguration new];
+    configuration.maxConcurrentBatchRequests = 3;
+    AWSDynamoDBObjectMapper *objectMapper = [self objectMapperWithConfiguration:configuration];
+    self.endpoint.latency = 0.005;
+
+    NSArray *items = [AWSDynamoDBObjectMapperBatchTests itemsWithCount:1000];
+    AWSTask *task = [objectMapper batchSave:items];
+    [task waitUntilFinished];
+
+    XCTAssertNil(task.error);
+    NSString *tableName = [AWSDynamoDBStubEndpointItem dynamoDBTableName];
+    XCTAssertEqual([self.endpoint itemCountInTable:tableName], 1000);
+    XCTAssertEqual([self.endpoint requestCountForOperation:@"BatchWriteItem"], 40);
+    XCTAssertGreaterThan(self.endpoint.maxConcurrentRequests, 1);
+    XCTAssertLessThanOrEqual(self.endpoint.maxConcurrentRequests, 3);
+
+    NSDictionary *stored = [self.endpoint itemInTable:tableName key:@{@"hashKey" : @{@"S" : @"hash-5"},
+                                                                        @"rangeKey" : @{@"N" : @"5"}}];
+    XCTAssertEqualObjects(stored[@"title"][@"S"], [items[5] title]);
+    XCTAssertEqualObjects([NSSet setWithArray:stored[@"tags"][@"SS"]], [items[5] tags]);
+}
+
+- (void)testBatchSaveResubmitsUnprocessedItems {
+    AWSDynamoDBObjectMapper *objectMapper = [self objectMapperWithConfiguration:[AWSDynamoDBObjectMapperConfiguration new]];
+    self.endpoint.unprocessedFraction = 0.3;
+    self.endpoint.latency = 0.001;
+
+    AWSTask *task = [objectMapper batchSave:[AWSDynamoDBObjectMapperBatchTests itemsWithCount:1000]];
+    [task waitUntilFinished];
+
+    XCTAssertNil(task.error);
+    XCTAssertEqual([self.endpoint itemCountInTable:[AWSDynamoDBStubEndpointItem dynamoDBTableName]], 1000);
+    XCTAssertGreaterThan([self.endpoint requestCountForOperation:@"BatchWriteItem"], 40);
+    XCTAssertLessThanOrEqual(self.endpoint.maxConcurrentRequests, 4);
+}
+
+- (void)testBatchRemove {
+    AWSDynamoDBObjectMapper *objectMapper = [self objectMapperWithConfiguration:[AWSDynamoDBObjectMapperConfiguration new]];
+    NSArray *items = [AWSDynamoDBObjectMapperBatchTests itemsWithCount:300];
+    [[objectMapper batchSave:items] waitUntilFinished];
+    self.endpoint.unprocessedFraction = 0.5;
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"batchRemove"];
+    [objectMapper batchRemove:[items subarrayWithRange:NSMakeRange(0, 250)] completionHandler:^(NSError *error) {
+        XCTAssertNil(error);
+        [expectation fulfill];
+    }];
+    [self waitForExpectationsWithTimeout:30 handler:nil];
+
+    XCTAssertEqual([self.endpoint itemCountInTable:[AWSDynamoDBStubEndpointItem dynamoDBTableName]], 50);
+}
+
+- (void)testBatchLoad {
+    AWSDynamoDBObjectMapper *objectMapper = [self objectMapperWithConfiguration:[AWSDynamoDBObjectMapperConfiguration new]];
+    NSArray<AWSDynamoDBStubEndpointItem *> *items = [AWSDynamoDBObjectMapperBatchTests itemsWithCount:450];
+    [[objectMapper batchSave:items] waitUntilFinished];
+    self.endpoint.unprocessedFraction = 0.2;
+
+    // Keys for items that were never saved are left out of the result.
+    NSMutableArray *keyModels = [[AWSDynamoDBObjectMapperBatchTests keyModelsForItems:items] mutableCopy];
+    [keyModels addObjectsFromArray:[AWSDynamoDBObjectMapperBatchTests keyModelsForItems:@[[AWSDynamoDBStubEndpointItem itemWithIndex:1000],
+                                                                                         [AWSDynamoDBStubEndpointItem itemWithIndex:1001]]]];
+
+    AWSTask<NSArray *> *task = [objectMapper batchLoad:keyModels];
+    [task waitUntilFinished];
+
+    XCTAssertNil(task.error);
+    XCTAssertEqual(task.result.count, 450);
+    XCTAssertGreaterThanOrEqual([self.endpoint requestCountForOperation:@"BatchGetItem"], 5);
+
+    NSMutableDictionary<NSNumber *, AWSDynamoDBStubEndpointItem *> *loadedByRangeKey = [NSMutableDictionary new];
+    for (AWSDynamoDBStubEndpointItem *item in task.result) {
+        XCTAssertTrue([item isKindOfClass:[AWSDynamoDBStubEndpointItem class]]);
+        loadedByRangeKey[item.rangeKey] = item;
+    }
+    XCTAssertEqual(loadedByRangeKey.count, 450);
+    AWSDynamoDBStubEndpointItem *loaded = loadedByRangeKey[@123];
+    XCTAssertEqualObjects(loaded.hashKey, items[123].hashKey);
+    XCTAssertEqualObjects(loaded.title, items[123].title);
+    XCTAssertEqualObjects(loaded.price, items[123].price);
+    XCTAssertEqualObjects(loaded.tags, items[123].tags);
+}
+
+- (void)testBatchLoadSendsEachKeyOnce {
+    AWSDynamoDBObjectMapper *objectMapper = [self objectMapperWithConfiguration:[AWSDynamoDBObjectMapperConfiguration new]];
+    NSArray<AWSDynamoDBStubEndpointItem *> *items = [AWSDynamoDBObjectMapperBatchTests itemsWithCount:60];
+    [[objectMapper batchSave:items] waitUntilFinished];
+
+    // Each key is passed twice, and both copies would fall in the same request.
+    NSArray *keyModels = [AWSDynamoDBObjectMapperBatchTests keyModelsForItems:items];
+    keyModels = [keyModels arrayByAddingObjectsFromArray:[AWSDynamoDBObjectMapperBatchTests keyModelsForItems:items]];
+
+    AWSTask<NSArray *> *task = [objectMapper batchLoad:keyModels];
+    [task waitUntilFinished];
+
+    XCTAssertNil(task.error);
+    XCTAssertEqual(task.result.count, 60);
+    XCTAssertEqual([self.endpoint requestCountForOperation:@"BatchGetItem"], 1);
+}
+
+- (void)testBatchLoadRejectsConflictingModelClasses {
+    AWSDynamoDBObjectMapper *objectMapper = [self objectMapperWithConfiguration:[AWSDynamoDBObjectMapperConfiguration new]];
+    AWSDynamoDBObjectMapperBatchTestsOtherItem *otherKeyModel = [AWSDynamoDBObjectMapperBatchTestsOtherItem new];
+    otherKeyModel.hashKey = @"hash-1";
+    otherKeyModel.rangeKey = @1;
+    NSArray *keyModels = [[AWSDynamoDBObjectMapperBatchTests keyModelsForItems:@[[AWSDynamoDBStubEndpointItem itemWithIndex:0]]] arrayByAddingObject:otherKeyModel];
+
+    AWSTask<NSArray *> *task = [objectMapper batchLoad:keyModels];
+    [task waitUntilFinished];
+
+    XCTAssertEqualObjects(task.error.domain, AWSDynamoDBObjectMapperErrorDomain);
+    XCTAssertEqual(task.error.code, AWSDynamoDBObjectMapperErrorConflictingModelClasses);
+    XCTAssertEqual(self.endpoint.requestCount, 0);
+}
+
+- (void)testBatchSaveGivesUpAfterRetryTimeout {
+    AWSDynamoDBObjectMapperConfiguration *configuration = [AWSDynamoDBObjectMapperConfiguration new];
+    configuration.batchRetryTimeout = 0.2;
+    AWSDynamoDBObjectMapper *objectMapper = [self objectMapperWithConfiguration:configuration];
+    // One request of each call goes through, which is far too slow to finish in time.
+    self.endpoint.unprocessedFraction = 0.99;
+    self.endpoint.latency = 0.01;
+
+    AWSTask *task = [objectMapper batchSave:[AWSDynamoDBObjectMapperBatchTests itemsWithCount:200]];
+    [task waitUntilFinished];
+
+    XCTAssertNotNil(task.error);
+    XCTAssertEqualObjects(task.error.domain, AWSDynamoDBObjectMapperErrorDomain);
+    XCTAssertEqual(task.error.code, AWSDynamoDBObjectMapperErrorUnprocessedItems);
+    NSDictionary<NSString *, NSArray *> *unprocessedItems = task.error.userInfo[AWSDynamoDBObjectMapperUnprocessedItemsKey];
+    XCTAssertGreaterThan([unprocessedItems[[AWSDynamoDBStubEndpointItem dynamoDBTableName]] count], 0);
+    XCTAssertLessThan([self.endpoint itemCountInTable:[AWSDynamoDBStubEndpointItem dynamoDBTableName]], 200);
+}
+
+- (void)testBatchSaveReturnsServiceError {
+    AWSDynamoDBObjectMapper *objectMapper = [self objectMapperWithConfiguration:[AWSDynamoDBObjectMapperConfiguration new]];
+    self.endpoint.failingOperation = @"BatchWriteItem";
+
+    AWSTask *task = [objectMapper batchSave:[AWSDynamoDBObjectMapperBatchTests itemsWithCount:500]];
+    [task waitUntilFinished];
+
+    XCTAssertEqualObjects(task.error.domain, AWSDynamoDBErrorDomain);
+    XCTAssertEqual(task.error.code, AWSDynamoDBErrorResourceNotFound);
+    // Lanes stop picking up batches once one has failed.
+    XCTAssertLessThan([self.endpoint requestCountForOperation:@"BatchWriteItem"], 20);
+}
+
+- (void)testBatchOperationsWithNoModels {
+    AWSDynamoDBObjectMapper *objectMapper = [self objectMapperWithConfiguration:[AWSDynamoDBObjectMapperConfiguration new]];
+
+    AWSTask *saveTask = [objectMapper batchSave:@[]];
+    AWSTask *removeTask = [objectMapper batchRemove:@[]];
+    AWSTask<NSArray *> *loadTask = [objectMapper batchLoad:@[]];
+    [[AWSTask taskForCompletionOfAllTasks:@[saveTask, removeTask, loadTask]] waitUntilFinished];
+
+    XCTAssertNil(saveTask.error);
+    XCTAssertNil(removeTask.error);
+    XCTAssertNil(loadTask.error);
+    XCTAssertEqual(loadTask.result.count, 0);
+    XCTAssertEqual(self.endpoint.requestCount, 0);
+}
+
+@end
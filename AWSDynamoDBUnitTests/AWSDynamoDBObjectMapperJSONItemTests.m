@@ -0,0 +1,158 @@
+//
+// Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+
+#import <XCTest/XCTest.h>
+#import "AWSDynamoDB.h"
+#import "AWSDynamoDBStubEndpoint.h"
+
+static NSString *const AWSDynamoDBObjectMapperJSONItemTestsKey = @"AWSDynamoDBObjectMapperJSONItemTests";
+
+@interface AWSDynamoDBObjectMapperJSONItemTests : XCTestCase
+
+@property (nonatomic, strong) AWSDynamoDBStubEndpoint *endpoint;
+@property (nonatomic, strong) AWSDynamoDBObjectMapper *objectMapper;
+@property (nonatomic, strong) NSString *tableName;
+
+@end
+
+@implementation AWSDynamoDBObjectMapperJSONItemTests
+
+- (void)setUp {
+    [super setUp];
+    self.tableName = [AWSDynamoDBStubEndpointItem dynamoDBTableName];
+    self.endpoint = [[AWSDynamoDBStubEndpoint alloc] initWithKeyAttributes:@{self.tableName : @[@"hashKey", @"rangeKey"]}];
+
+    AWSServiceConfiguration *configuration = [[AWSServiceConfiguration alloc] initWithRegion:AWSRegionUSEast1
+                                                                         credentialsProvider:nil];
+    [AWSDynamoDBObjectMapper registerDynamoDBObjectMapperWithConfiguration:configuration
+                                                 objectMapperConfiguration:[AWSDynamoDBObjectMapperConfiguration new]
+                                                                    forKey:AWSDynamoDBObjectMapperJSONItemTestsKey];
+    self.objectMapper = [AWSDynamoDBObjectMapper DynamoDBObjectMapperForKey:AWSDynamoDBObjectMapperJSONItemTestsKey];
+    [self.endpoint attachToObjectMapper:self.objectMapper];
+}
+
+- (void)tearDown {
+    [AWSDynamoDBObjectMapper removeDynamoDBObjectMapperForKey:AWSDynamoDBObjectMapperJSONItemTestsKey];
+    [super tearDown];
+}
+
+- (AWSDynamoDBObjectMapperConfiguration *)configurationWithSaveBehavior:(AWSDynamoDBObjectMapperSaveBehavior)saveBehavior {
+    AWSDynamoDBObjectMapperConfiguration *configuration = [AWSDynamoDBObjectMapperConfiguration new];
+    configuration.saveBehavior = saveBehavior;
+    return configuration;
+}
+
+- (AWSDynamoDBStubEndpointItem *)loadItem:(AWSDynamoDBStubEndpointItem *)item {
+    AWSTask *task = [self.objectMapper load:[AWSDynamoDBStubEndpointItem class]
+                                    hashKey:item.hashKey
+                                   rangeKey:item.rangeKey];
+    [task waitUntilFinished];
+    XCTAssertNil(task.error);
+    return task.result;
+}
+
+- (void)testSaveWritesJSONAttributeValues {
+    AWSDynamoDBStubEndpointItem *item = [AWSDynamoDBStubEndpointItem itemWithIndex:4];
+    AWSTask *task = [self.objectMapper save:item
+                              configuration:[self configurationWithSaveBehavior:AWSDynamoDBObjectMapperSaveBehaviorClobber]];
+    [task waitUntilFinished];
+    XCTAssertNil(task.error);
+
+    NSDictionary *stored = [self.endpoint itemInTable:self.tableName key:@{@"hashKey" : @{@"S" : @"hash-4"},
+                                                                           @"rangeKey" : @{@"N" : @"4"}}];
+    XCTAssertEqualObjects(stored[@"title"], @{@"S" : item.title});
+    XCTAssertEqualObjects(stored[@"price"], @{@"N" : @"1"});
+    XCTAssertEqualObjects(stored[@"inStock"], @{@"BOOL" : @YES});
+    XCTAssertEqualObjects([NSSet setWithArray:stored[@"tags"][@"SS"]], item.tags);
+    XCTAssertEqualObjects(stored[@"dimensions"][@"M"][@"packaging"], (@{@"M" : @{@"weight" : @{@"N" : @"1.5"},
+                                                                                @"fragile" : @{@"BOOL" : @NO}}}));
+    XCTAssertEqualObjects(stored[@"history"][@"L"][0], @{@"S" : @"created"});
+    XCTAssertEqualObjects(stored[@"history"][@"L"][2], (@{@"L" : @[@{@"N" : @"1"}, @{@"N" : @"2"}, @{@"N" : @"3"}]}));
+}
+
+- (void)testSaveAndLoadRoundTrip {
+    AWSDynamoDBStubEndpointItem *item = [AWSDynamoDBStubEndpointItem itemWithIndex:7];
+    [[self.objectMapper save:item] waitUntilFinished];
+
+    AWSDynamoDBStubEndpointItem *loaded = [self loadItem:item];
+    XCTAssertEqualObjects(loaded.hashKey, item.hashKey);
+    XCTAssertEqualObjects(loaded.rangeKey, item.rangeKey);
+    XCTAssertEqualObjects(loaded.title, item.title);
+    XCTAssertEqualObjects(loaded.price, item.price);
+    XCTAssertEqualObjects(loaded.inStock, item.inStock);
+    XCTAssertEqualObjects(loaded.tags, item.tags);
+    XCTAssertEqualObjects(loaded.dimensions, item.dimensions);
+    XCTAssertEqualObjects(loaded.history, item.history);
+}
+
+- (void)testUpdateRemovesNullAttributes {
+    AWSDynamoDBStubEndpointItem *item = [AWSDynamoDBStubEndpointItem itemWithIndex:9];
+    [[self.objectMapper save:item] waitUntilFinished];
+
+    item.title = nil;
+    item.price = @42;
+    [[self.objectMapper save:item
+               configuration:[self configurationWithSaveBehavior:AWSDynamoDBObjectMapperSaveBehaviorUpdateSkipNullAttributes]] waitUntilFinished];
+    AWSDynamoDBStubEndpointItem *loaded = [self loadItem:item];
+    XCTAssertNotNil(loaded.title);
+    XCTAssertEqualObjects(loaded.price, @42);
+
+    [[self.objectMapper save:item
+               configuration:[self configurationWithSaveBehavior:AWSDynamoDBObjectMapperSaveBehaviorUpdate]] waitUntilFinished];
+    loaded = [self loadItem:item];
+    XCTAssertNil(loaded.title);
+    XCTAssertEqualObjects(loaded.dimensions, item.dimensions);
+}
+
+- (void)testLoadMissingItem {
+    XCTAssertNil([self loadItem:[AWSDynamoDBStubEndpointItem itemWithIndex:1]]);
+}
+
+- (void)testQueryPages {
+    NSMutableArray *items = [NSMutableArray new];
+    for (NSUInteger i = 0; i < 97 * 30; i++) {
+        [items addObject:[AWSDynamoDBStubEndpointItem itemWithIndex:i]];
+    }
+    [[self.objectMapper batchSave:items] waitUntilFinished];
+
+    AWSDynamoDBQueryExpression *queryExpression = [AWSDynamoDBQueryExpression new];
+    queryExpression.keyConditionExpression = @"hashKey = :hashKey";
+    queryExpression.expressionAttributeValues = @{@":hashKey" : @"hash-5"};
+    queryExpression.limit = @20;
+
+    AWSTask<AWSDynamoDBPaginatedOutput *> *task = [self.objectMapper query:[AWSDynamoDBStubEndpointItem class]
+                                                                expression:queryExpression];
+    [task waitUntilFinished];
+    XCTAssertNil(task.error);
+    AWSDynamoDBPaginatedOutput *output = task.result;
+    XCTAssertEqual(output.items.count, 20);
+    XCTAssertEqualObjects(output.lastEvaluatedKey[@"hashKey"].S, @"hash-5");
+
+    NSMutableSet *rangeKeys = [NSMutableSet new];
+    for (AWSDynamoDBStubEndpointItem *item in output.items) {
+        XCTAssertEqualObjects(item.hashKey, @"hash-5");
+        XCTAssertEqualObjects(item.dimensions[@"packaging"][@"fragile"], @NO);
+        [rangeKeys addObject:item.rangeKey];
+    }
+    [[output loadNextPage] waitUntilFinished];
+    for (AWSDynamoDBStubEndpointItem *item in output.items) {
+        [rangeKeys addObject:item.rangeKey];
+    }
+    XCTAssertEqual(output.items.count, 10);
+    XCTAssertNil(output.lastEvaluatedKey);
+    XCTAssertEqual(rangeKeys.count, 30);
+}
+
+@end
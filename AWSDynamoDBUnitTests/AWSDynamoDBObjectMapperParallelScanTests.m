@@ -0,0 +1,170 @@
+//
+// Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+
+#import <XCTest/XCTest.h>
+#import "AWSDynamoDB.h"
+#import "AWSDynamoDBStubEndpoint.h"
+
+static NSString *const AWSDynamoDBObjectMapperParallelScanTestsKey = @"AWSDynamoDBObjectMapperParallelScanTests";
+static NSUInteger const AWSDynamoDBObjectMapperParallelScanTestsItemCount = 1000;
+
+@interface AWSDynamoDBObjectMapperParallelScanTests : XCTestCase
+
+@property (nonatomic, strong) AWSDynamoDBStubEndpoint *endpoint;
+@property (nonatomic, strong) AWSDynamoDBObjectMapper *objectMapper;
+
+@end
+
+@implementation AWSDynamoDBObjectMapperParallelScanTests
+
+- (void)setUp {
+    [super setUp];
+    self.endpoint = [[AWSDynamoDBStubEndpoint alloc] initWithKeyAttributes:@{[AWSDynamoDBStubEndpointItem dynamoDBTableName] : @[@"hashKey", @"rangeKey"]}];
+
+    AWSServiceConfiguration *configuration = [[AWSServiceConfiguration alloc] initWithRegion:AWSRegionUSEast1
+                                                                         credentialsProvider:nil];
+    [AWSDynamoDBObjectMapper registerDynamoDBObjectMapperWithConfiguration:configuration
+                                                 objectMapperConfiguration:[AWSDynamoDBObjectMapperConfiguration new]
+                                                                    forKey:AWSDynamoDBObjectMapperParallelScanTestsKey];
+    self.objectMapper = [AWSDynamoDBObjectMapper DynamoDBObjectMapperForKey:AWSDynamoDBObjectMapperParallelScanTestsKey];
+    [self.endpoint attachToObjectMapper:self.objectMapper];
+
+    NSMutableArray *items = [NSMutableArray arrayWithCapacity:AWSDynamoDBObjectMapperParallelScanTestsItemCount];
+    for (NSUInteger i = 0; i < AWSDynamoDBObjectMapperParallelScanTestsItemCount; i++) {
+        [items addObject:[AWSDynamoDBStubEndpointItem itemWithIndex:i]];
+    }
+    [[self.objectMapper batchSave:items] waitUntilFinished];
+}
+
+- (void)tearDown {
+    [AWSDynamoDBObjectMapper removeDynamoDBObjectMapperForKey:AWSDynamoDBObjectMapperParallelScanTestsKey];
+    [super tearDown];
+}
+
++ (AWSDynamoDBScanExpression *)scanExpressionWithLimit:(NSUInteger)limit {
+    AWSDynamoDBScanExpression *scanExpression = [AWSDynamoDBScanExpression new];
+    scanExpression.limit = @(limit);
+    return scanExpression;
+}
+
+- (void)testParallelScanReturnsEveryItemOnce {
+    self.endpoint.latency = 0.002;
+    NSUInteger scanRequestCount = [self.endpoint requestCountForOperation:@"Scan"];
+    AWSDynamoDBParallelScanOutput *output = [self.objectMapper parallelScan:[AWSDynamoDBStubEndpointItem class]
+                                                                 expression:[AWSDynamoDBObjectMapperParallelScanTests scanExpressionWithLimit:50]
+                                                              totalSegments:4];
+    XCTAssertEqual(output.totalSegments, 4);
+
+    NSMutableSet<NSNumber *> *rangeKeys = [NSMutableSet new];
+    NSUInteger count = 0;
+    for (AWSDynamoDBStubEndpointItem *item in output) {
+        XCTAssertTrue([item isKindOfClass:[AWSDynamoDBStubEndpointItem class]]);
+        [rangeKeys addObject:item.rangeKey];
+        count++;
+    }
+
+    XCTAssertNil(output.error);
+    XCTAssertEqual(count, AWSDynamoDBObjectMapperParallelScanTestsItemCount);
+    XCTAssertEqual(rangeKeys.count, AWSDynamoDBObjectMapperParallelScanTestsItemCount);
+    // One page of up to 50 items per request, plus the request that finds each segment's end.
+    XCTAssertGreaterThanOrEqual([self.endpoint requestCountForOperation:@"Scan"] - scanRequestCount, 20);
+    XCTAssertGreaterThan(self.endpoint.maxConcurrentRequests, 1);
+    XCTAssertNil([output nextObject]);
+}
+
+- (void)testNextPage {
+    AWSDynamoDBParallelScanOutput *output = [self.objectMapper parallelScan:[AWSDynamoDBStubEndpointItem class]
+                                                                 expression:[AWSDynamoDBObjectMapperParallelScanTests scanExpressionWithLimit:100]
+                                                              totalSegments:3];
+
+    // What is left of a page started with nextObject comes back first.
+    XCTAssertNotNil([output nextObject]);
+    NSArray *rest = [output nextPage];
+    XCTAssertGreaterThan(rest.count, 0);
+    XCTAssertLessThan(rest.count, 100);
+
+    NSUInteger count = 1 + rest.count;
+    NSArray *page = nil;
+    while ((page = [output nextPage])) {
+        XCTAssertGreaterThan(page.count, 0);
+        XCTAssertLessThanOrEqual(page.count, 100);
+        count += page.count;
+    }
+    XCTAssertEqual(count, AWSDynamoDBObjectMapperParallelScanTestsItemCount);
+}
+
+- (void)testSingleSegmentOmitsSegmentParameters {
+    AWSDynamoDBParallelScanOutput *output = [self.objectMapper parallelScan:[AWSDynamoDBStubEndpointItem class]
+                                                                 expression:[AWSDynamoDBObjectMapperParallelScanTests scanExpressionWithLimit:200]
+                                                              totalSegments:0];
+
+    XCTAssertEqual(output.totalSegments, 1);
+    XCTAssertEqual([[output allObjects] count], AWSDynamoDBObjectMapperParallelScanTestsItemCount);
+}
+
+- (void)testBufferedPagesAreBounded {
+    AWSDynamoDBObjectMapperConfiguration *configuration = [AWSDynamoDBObjectMapperConfiguration new];
+    configuration.maxBufferedScanPages = 2;
+    NSUInteger scanRequestCount = [self.endpoint requestCountForOperation:@"Scan"];
+    AWSDynamoDBParallelScanOutput *output = [self.objectMapper parallelScan:[AWSDynamoDBStubEndpointItem class]
+                                                                 expression:[AWSDynamoDBObjectMapperParallelScanTests scanExpressionWithLimit:10]
+                                                              totalSegments:8
+                                                              configuration:configuration];
+
+    XCTAssertNotNil([output nextObject]);
+    // A slow consumer: one page taken, two buffered, nothing more is fetched.
+    [NSThread sleepForTimeInterval:0.2];
+    XCTAssertLessThanOrEqual([self.endpoint requestCountForOperation:@"Scan"] - scanRequestCount, 3);
+    XCTAssertLessThanOrEqual(self.endpoint.maxConcurrentRequests, 4);
+
+    NSUInteger count = 1;
+    while ([output nextObject]) {
+        count++;
+    }
+    XCTAssertEqual(count, AWSDynamoDBObjectMapperParallelScanTestsItemCount);
+}
+
+- (void)testCancel {
+    self.endpoint.latency = 0.005;
+    AWSDynamoDBParallelScanOutput *output = [self.objectMapper parallelScan:[AWSDynamoDBStubEndpointItem class]
+                                                                 expression:[AWSDynamoDBObjectMapperParallelScanTests scanExpressionWithLimit:10]
+                                                              totalSegments:4];
+    XCTAssertNotNil([output nextObject]);
+
+    [output cancel];
+    XCTAssertTrue(output.isCancelled);
+    XCTAssertNil([output nextObject]);
+    XCTAssertNil([output nextPage]);
+
+    // Responses in flight land, and no further requests go out.
+    [NSThread sleepForTimeInterval:0.1];
+    NSUInteger requestCount = [self.endpoint requestCountForOperation:@"Scan"];
+    [NSThread sleepForTimeInterval:0.1];
+    XCTAssertEqual([self.endpoint requestCountForOperation:@"Scan"], requestCount);
+    XCTAssertNil(output.error);
+}
+
+- (void)testServiceErrorEndsEnumeration {
+    self.endpoint.failingOperation = @"Scan";
+    AWSDynamoDBParallelScanOutput *output = [self.objectMapper parallelScan:[AWSDynamoDBStubEndpointItem class]
+                                                                 expression:[AWSDynamoDBObjectMapperParallelScanTests scanExpressionWithLimit:10]
+                                                              totalSegments:4];
+
+    XCTAssertNil([output nextObject]);
+    XCTAssertEqualObjects(output.error.domain, AWSDynamoDBErrorDomain);
+    XCTAssertEqual(output.error.code, AWSDynamoDBErrorResourceNotFound);
+}
+
+@end
@@ -0,0 +1,397 @@
+//
+// Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+#import <XCTest/XCTest.h>
+#import <malloc/malloc.h>
+#import <objc/runtime.h>
+#import <stdatomic.h>
+#import "AWSDynamoDBService.h"
+#import "AWSDynamoDBObjectMapper.h"
+#import "AWSDynamoDBStubEndpoint.h"
+
+@interface AWSDynamoDBResources (AWSDynamoDBPerformanceTests)
+
+- (NSString *)definitionString;
+
+@end
+
+static NSUInteger const AWSDynamoDBPerformanceTestsItemCount = 1000;
+static NSUInteger const AWSDynamoDBPerformanceTestsWriteCount = 10000;
+static NSUInteger const AWSDynamoDBPerformanceTestsScanItemCount = 5000;
+static NSString *const AWSDynamoDBPerformanceTestsObjectMapperKey = @"AWSDynamoDBPerformanceTests";
+
+// Builds a fresh mapping plan on every use, like the adapter did before plans
+// were cached per model class.
+@interface AWSDynamoDBPerformanceTestsUncachedAdapter : AWSMTLJSONAdapter
+
+@end
+
+@implementation AWSDynamoDBPerformanceTestsUncachedAdapter
+
+@end
+
+// The conversions the object mapper used before items were kept in JSON form, and the one it uses now.
+@interface AWSDynamoDBAttributeValue (AWSDynamoDBObjectMapper)
+
+- (id)aws_getAttributeValue;
+
+@end
+
+@interface AWSDynamoDBObjectMapper (AWSDynamoDBPerformanceTests)
+
+- (NSMutableArray *)models:(Class)resultClass
+             fromJSONItems:(NSArray<NSDictionary *> *)JSONItems
+                     error:(NSError **)error;
+
+@end
+
+// Counts AWSDynamoDBAttributeValue allocations once +setUp installs the counter.
+static _Atomic int64_t AWSDynamoDBPerformanceTestsAttributeValueAllocations = 0;
+static IMP AWSDynamoDBPerformanceTestsAllocWithZone = NULL;
+
+static id AWSDynamoDBPerformanceTestsCountingAllocWithZone(id self, SEL _cmd, NSZone *zone) {
+    atomic_fetch_add(&AWSDynamoDBPerformanceTestsAttributeValueAllocations, 1);
+    return ((id (*)(id, SEL, NSZone *))AWSDynamoDBPerformanceTestsAllocWithZone)(self, _cmd, zone);
+}
+
+@interface AWSDynamoDBPerformanceTests : XCTestCase
+
+@end
+
+@implementation AWSDynamoDBPerformanceTests
+
++ (void)setUp {
+    [super setUp];
+
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        Class metaClass = object_getClass([AWSDynamoDBAttributeValue class]);
+        Method allocWithZone = class_getInstanceMethod(metaClass, @selector(allocWithZone:));
+        AWSDynamoDBPerformanceTestsAllocWithZone = method_getImplementation(allocWithZone);
+        class_addMethod(metaClass, @selector(allocWithZone:), (IMP)AWSDynamoDBPerformanceTestsCountingAllocWithZone, method_getTypeEncoding(allocWithZone));
+    });
+}
+
+// A ScanOutput as the JSON response serializer hands it to the adapter.
++ (NSDictionary *)scanOutputJSONWithItemCount:(NSUInteger)count {
+    NSMutableArray *items = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger i = 0; i < count; i++) {
+        [items addObject:@{@"hashKey" : @{@"S" : [NSString stringWithFormat:@"hash-%lu", (unsigned long)i]},
+                           @"rangeKey" : @{@"N" : [NSString stringWithFormat:@"%lu", (unsigned long)i]},
+                           @"title" : @{@"S" : @"A reasonably long title attribute for a scanned item"},
+                           @"price" : @{@"N" : @"19.99"},
+                           @"inStock" : @{@"BOOL" : @YES},
+                           @"tags" : @{@"SS" : @[@"red", @"green", @"blue"]},
+                           @"dimensions" : @{@"M" : @{@"width" : @{@"N" : @"10"},
+                                                      @"height" : @{@"N" : @"20"}}},
+                           @"history" : @{@"L" : @[@{@"S" : @"created"}, @{@"S" : @"updated"}]}}];
+    }
+    return @{@"Count" : @(count),
+             @"ScannedCount" : @(count),
+             @"Items" : items,
+             @"LastEvaluatedKey" : @{@"hashKey" : @{@"S" : @"hash-last"}},
+             @"ConsumedCapacity" : @{@"TableName" : @"Table", @"CapacityUnits" : @128.5}};
+}
+
+- (void)testScanOutputDecoding {
+    NSDictionary *JSONDictionary = [AWSDynamoDBPerformanceTests scanOutputJSONWithItemCount:10];
+    NSError *error = nil;
+    AWSDynamoDBScanOutput *output = [AWSMTLJSONAdapter modelOfClass:[AWSDynamoDBScanOutput class] fromJSONDictionary:JSONDictionary error:&error];
+    AWSDynamoDBScanOutput *uncachedOutput = [AWSDynamoDBPerformanceTestsUncachedAdapter modelOfClass:[AWSDynamoDBScanOutput class] fromJSONDictionary:JSONDictionary error:nil];
+
+    XCTAssertNil(error);
+    XCTAssertEqualObjects(output, uncachedOutput);
+    XCTAssertEqual(output.items.count, 10);
+    XCTAssertEqualObjects(output.items[3][@"hashKey"].S, @"hash-3");
+    XCTAssertEqualObjects(output.items[3][@"inStock"].BOOLEAN, @YES);
+    XCTAssertEqualObjects(output.items[3][@"dimensions"].M[@"height"].N, @"20");
+    XCTAssertEqualObjects(output.lastEvaluatedKey[@"hashKey"].S, @"hash-last");
+    XCTAssertEqualObjects(output.consumedCapacity.capacityUnits, @128.5);
+    XCTAssertEqualObjects([AWSMTLJSONAdapter JSONDictionaryFromModel:output][@"Items"], JSONDictionary[@"Items"]);
+}
+
+- (void)measureScanOutputDecodingWithAdapterClass:(Class)adapterClass {
+    NSDictionary *JSONDictionary = [AWSDynamoDBPerformanceTests scanOutputJSONWithItemCount:AWSDynamoDBPerformanceTestsItemCount];
+    [self measureBlock:^{
+        CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+        AWSDynamoDBScanOutput *output = [adapterClass modelOfClass:[AWSDynamoDBScanOutput class] fromJSONDictionary:JSONDictionary error:nil];
+        CFAbsoluteTime elapsed = CFAbsoluteTimeGetCurrent() - start;
+        XCTAssertEqual(output.items.count, AWSDynamoDBPerformanceTestsItemCount);
+        NSLog(@"%@ ScanOutput: %.0f items/sec", adapterClass, AWSDynamoDBPerformanceTestsItemCount / elapsed);
+    }];
+}
+
+- (void)testPerformanceScanOutputDecoding {
+    [self measureScanOutputDecodingWithAdapterClass:[AWSMTLJSONAdapter class]];
+}
+
+- (void)testPerformanceScanOutputDecodingWithoutCachedPlan {
+    [self measureScanOutputDecodingWithAdapterClass:[AWSDynamoDBPerformanceTestsUncachedAdapter class]];
+}
+
+#pragma mark - Batch writes
+
+- (void)measureWritesWithBlock:(AWSTask *(^)(AWSDynamoDBObjectMapper *objectMapper, NSArray *items))writeBlock {
+    NSMutableArray *items = [NSMutableArray arrayWithCapacity:AWSDynamoDBPerformanceTestsWriteCount];
+    for (NSUInteger i = 0; i < AWSDynamoDBPerformanceTestsWriteCount; i++) {
+        [items addObject:[AWSDynamoDBStubEndpointItem itemWithIndex:i]];
+    }
+
+    AWSServiceConfiguration *configuration = [[AWSServiceConfiguration alloc] initWithRegion:AWSRegionUSEast1
+                                                                         credentialsProvider:nil];
+    AWSDynamoDBObjectMapperConfiguration *objectMapperConfiguration = [AWSDynamoDBObjectMapperConfiguration new];
+    objectMapperConfiguration.saveBehavior = AWSDynamoDBObjectMapperSaveBehaviorClobber;
+    [AWSDynamoDBObjectMapper registerDynamoDBObjectMapperWithConfiguration:configuration
+                                                 objectMapperConfiguration:objectMapperConfiguration
+                                                                    forKey:AWSDynamoDBPerformanceTestsObjectMapperKey];
+    AWSDynamoDBObjectMapper *objectMapper = [AWSDynamoDBObjectMapper DynamoDBObjectMapperForKey:AWSDynamoDBPerformanceTestsObjectMapperKey];
+
+    [self measureBlock:^{
+        AWSDynamoDBStubEndpoint *endpoint = [[AWSDynamoDBStubEndpoint alloc] initWithKeyAttributes:@{[AWSDynamoDBStubEndpointItem dynamoDBTableName] : @[@"hashKey", @"rangeKey"]}];
+        // A round trip within a region, with a tenth of every batch throttled.
+        endpoint.latency = 0.005;
+        endpoint.unprocessedFraction = 0.1;
+        [endpoint attachToObjectMapper:objectMapper];
+
+        CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+        AWSTask *task = writeBlock(objectMapper, items);
+        [task waitUntilFinished];
+        CFAbsoluteTime elapsed = CFAbsoluteTimeGetCurrent() - start;
+
+        XCTAssertNil(task.error);
+        XCTAssertEqual([endpoint itemCountInTable:[AWSDynamoDBStubEndpointItem dynamoDBTableName]], AWSDynamoDBPerformanceTestsWriteCount);
+        NSLog(@"%.0f items/sec in %lu requests", AWSDynamoDBPerformanceTestsWriteCount / elapsed, (unsigned long)endpoint.requestCount);
+    }];
+
+    [AWSDynamoDBObjectMapper removeDynamoDBObjectMapperForKey:AWSDynamoDBPerformanceTestsObjectMapperKey];
+}
+
+- (void)testPerformanceBatchSave {
+    [self measureWritesWithBlock:^AWSTask *(AWSDynamoDBObjectMapper *objectMapper, NSArray *items) {
+        return [objectMapper batchSave:items];
+    }];
+}
+
+- (void)testPerformanceSaveOneByOne {
+    [self measureWritesWithBlock:^AWSTask *(AWSDynamoDBObjectMapper *objectMapper, NSArray *items) {
+        NSMutableArray *tasks = [NSMutableArray arrayWithCapacity:items.count];
+        for (AWSDynamoDBStubEndpointItem *item in items) {
+            [tasks addObject:[objectMapper save:item]];
+        }
+        return [AWSTask taskForCompletionOfAllTasks:tasks];
+    }];
+}
+
+#pragma mark - Parallel scans
+
+- (void)measureScanWithTotalSegments:(NSUInteger)totalSegments {
+    AWSServiceConfiguration *configuration = [[AWSServiceConfiguration alloc] initWithRegion:AWSRegionUSEast1
+                                                                         credentialsProvider:nil];
+    [AWSDynamoDBObjectMapper registerDynamoDBObjectMapperWithConfiguration:configuration
+                                                 objectMapperConfiguration:[AWSDynamoDBObjectMapperConfiguration new]
+                                                                    forKey:AWSDynamoDBPerformanceTestsObjectMapperKey];
+    AWSDynamoDBObjectMapper *objectMapper = [AWSDynamoDBObjectMapper DynamoDBObjectMapperForKey:AWSDynamoDBPerformanceTestsObjectMapperKey];
+    AWSDynamoDBStubEndpoint *endpoint = [[AWSDynamoDBStubEndpoint alloc] initWithKeyAttributes:@{[AWSDynamoDBStubEndpointItem dynamoDBTableName] : @[@"hashKey", @"rangeKey"]}];
+    [endpoint attachToObjectMapper:objectMapper];
+
+    NSMutableArray *items = [NSMutableArray arrayWithCapacity:AWSDynamoDBPerformanceTestsScanItemCount];
+    for (NSUInteger i = 0; i < AWSDynamoDBPerformanceTestsScanItemCount; i++) {
+        [items addObject:[AWSDynamoDBStubEndpointItem itemWithIndex:i]];
+    }
+    [[objectMapper batchSave:items] waitUntilFinished];
+    endpoint.latency = 0.01;
+
+    AWSDynamoDBScanExpression *scanExpression = [AWSDynamoDBScanExpression new];
+    scanExpression.limit = @100;
+    [self measureBlock:^{
+        CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+        AWSDynamoDBParallelScanOutput *output = [objectMapper parallelScan:[AWSDynamoDBStubEndpointItem class]
+                                                                expression:scanExpression
+                                                             totalSegments:totalSegments];
+        NSUInteger count = 0;
+        while ([output nextObject]) {
+            count++;
+        }
+        CFAbsoluteTime elapsed = CFAbsoluteTimeGetCurrent() - start;
+
+        XCTAssertNil(output.error);
+        XCTAssertEqual(count, AWSDynamoDBPerformanceTestsScanItemCount);
+        NSLog(@"%lu segments: %.0f items/sec", (unsigned long)totalSegments, count / elapsed);
+    }];
+
+    [AWSDynamoDBObjectMapper removeDynamoDBObjectMapperForKey:AWSDynamoDBPerformanceTestsObjectMapperKey];
+}
+
+- (void)testPerformanceScanOneSegment {
+    [self measureScanWithTotalSegments:1];
+}
+
+- (void)testPerformanceScanFourSegments {
+    [self measureScanWithTotalSegments:4];
+}
+
+- (void)testPerformanceScanSixteenSegments {
+    [self measureScanWithTotalSegments:16];
+}
+
+#pragma mark - Item decoding
+
+// The AWSDynamoDBAttributeValue tree the response serializer used to build, converted item by item.
++ (NSArray *)modelsThroughAttributeValuesFromQueryOutputJSON:(NSDictionary *)JSONDictionary {
+    AWSDynamoDBQueryOutput *queryOutput = [AWSMTLJSONAdapter modelOfClass:[AWSDynamoDBQueryOutput class] fromJSONDictionary:JSONDictionary error:nil];
+    NSMutableArray *models = [NSMutableArray arrayWithCapacity:queryOutput.items.count];
+    for (NSDictionary<NSString *, AWSDynamoDBAttributeValue *> *item in queryOutput.items) {
+        NSMutableDictionary *modelDictionary = [NSMutableDictionary dictionaryWithCapacity:item.count];
+        for (NSString *attributeName in item) {
+            modelDictionary[attributeName] = [item[attributeName] aws_getAttributeValue];
+        }
+        [models addObject:[AWSMTLJSONAdapter modelOfClass:[AWSDynamoDBStubEndpointItem class] fromJSONDictionary:modelDictionary error:nil]];
+    }
+    return models;
+}
+
+// Items kept in JSON form by the response serializer and converted straight to models, as the mapper does now.
++ (NSArray *)modelsFromQueryOutputJSON:(NSDictionary *)JSONDictionary objectMapper:(AWSDynamoDBObjectMapper *)objectMapper {
+    AWSDynamoDBQueryOutput *queryOutput = [AWSMTLJSONAdapter modelOfClass:NSClassFromString(@"AWSDynamoDBObjectMapperQueryOutput") fromJSONDictionary:JSONDictionary error:nil];
+    return [objectMapper models:[AWSDynamoDBStubEndpointItem class] fromJSONItems:queryOutput.items error:nil];
+}
+
+- (AWSDynamoDBObjectMapper *)registerObjectMapper {
+    AWSServiceConfiguration *configuration = [[AWSServiceConfiguration alloc] initWithRegion:AWSRegionUSEast1
+                                                                         credentialsProvider:nil];
+    [AWSDynamoDBObjectMapper registerDynamoDBObjectMapperWithConfiguration:configuration
+                                                 objectMapperConfiguration:[AWSDynamoDBObjectMapperConfiguration new]
+                                                                    forKey:AWSDynamoDBPerformanceTestsObjectMapperKey];
+    return [AWSDynamoDBObjectMapper DynamoDBObjectMapperForKey:AWSDynamoDBPerformanceTestsObjectMapperKey];
+}
+
+- (void)testQueryItemDecodingMatchesAttributeValuePath {
+    AWSDynamoDBObjectMapper *objectMapper = [self registerObjectMapper];
+    NSDictionary *JSONDictionary = [AWSDynamoDBPerformanceTests scanOutputJSONWithItemCount:10];
+
+    NSArray *expected = [AWSDynamoDBPerformanceTests modelsThroughAttributeValuesFromQueryOutputJSON:JSONDictionary];
+    int64_t allocations = AWSDynamoDBPerformanceTestsAttributeValueAllocations;
+    NSArray *models = [AWSDynamoDBPerformanceTests modelsFromQueryOutputJSON:JSONDictionary objectMapper:objectMapper];
+
+    XCTAssertEqual(AWSDynamoDBPerformanceTestsAttributeValueAllocations, allocations);
+    XCTAssertEqual(models.count, 10);
+    XCTAssertEqualObjects(models, expected);
+    AWSDynamoDBStubEndpointItem *item = models[3];
+    XCTAssertEqualObjects(item.dimensions[@"height"], @20);
+    XCTAssertEqualObjects(item.history, (@[@"created", @"updated"]));
+    XCTAssertEqualObjects(item.inStock, @YES);
+
+    [AWSDynamoDBObjectMapper removeDynamoDBObjectMapperForKey:AWSDynamoDBPerformanceTestsObjectMapperKey];
+}
+
+- (void)measureQueryItemDecodingWithBlock:(NSArray *(^)(NSDictionary *JSONDictionary))decodeBlock {
+    NSDictionary *JSONDictionary = [AWSDynamoDBPerformanceTests scanOutputJSONWithItemCount:AWSDynamoDBPerformanceTestsItemCount];
+    [self measureBlock:^{
+        int64_t allocations = AWSDynamoDBPerformanceTestsAttributeValueAllocations;
+        malloc_statistics_t before;
+        malloc_statistics_t after;
+        malloc_zone_statistics(NULL, &before);
+        CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+        @autoreleasepool {
+            NSArray *models = decodeBlock(JSONDictionary);
+            XCTAssertEqual(models.count, AWSDynamoDBPerformanceTestsItemCount);
+            // Sampled before the pool drains, so temporary objects still count.
+            malloc_zone_statistics(NULL, &after);
+        }
+        CFAbsoluteTime elapsed = CFAbsoluteTimeGetCurrent() - start;
+        NSLog(@"%.0f items/sec, %lld AWSDynamoDBAttributeValue allocations, %ld KB in use after decoding",
+              AWSDynamoDBPerformanceTestsItemCount / elapsed,
+              AWSDynamoDBPerformanceTestsAttributeValueAllocations - allocations,
+              ((long)after.size_in_use - (long)before.size_in_use) / 1024);
+    }];
+}
+
+- (void)testPerformanceQueryItemDecoding {
+    AWSDynamoDBObjectMapper *objectMapper = [self registerObjectMapper];
+    [self measureQueryItemDecodingWithBlock:^NSArray *(NSDictionary *JSONDictionary) {
+        return [AWSDynamoDBPerformanceTests modelsFromQueryOutputJSON:JSONDictionary objectMapper:objectMapper];
+    }];
+    [AWSDynamoDBObjectMapper removeDynamoDBObjectMapperForKey:AWSDynamoDBPerformanceTestsObjectMapperKey];
+}
+
+- (void)testPerformanceQueryItemDecodingThroughAttributeValues {
+    [self measureQueryItemDecodingWithBlock:^NSArray *(NSDictionary *JSONDictionary) {
+        return [AWSDynamoDBPerformanceTests modelsThroughAttributeValuesFromQueryOutputJSON:JSONDictionary];
+    }];
+}
+
+- (void)testPerformanceQueryThroughStubEndpoint {
+    AWSDynamoDBObjectMapper *objectMapper = [self registerObjectMapper];
+    AWSDynamoDBStubEndpoint *endpoint = [[AWSDynamoDBStubEndpoint alloc] initWithKeyAttributes:@{[AWSDynamoDBStubEndpointItem dynamoDBTableName] : @[@"hashKey", @"rangeKey"]}];
+    [endpoint attachToObjectMapper:objectMapper];
+
+    // 97 hash keys, so every 97th item shares a hash key.
+    NSUInteger itemCount = 97 * AWSDynamoDBPerformanceTestsItemCount;
+    NSMutableArray *items = [NSMutableArray arrayWithCapacity:AWSDynamoDBPerformanceTestsItemCount];
+    for (NSUInteger i = 5; i < itemCount; i += 97) {
+        [items addObject:[AWSDynamoDBStubEndpointItem itemWithIndex:i]];
+    }
+    [[objectMapper batchSave:items] waitUntilFinished];
+
+    AWSDynamoDBQueryExpression *queryExpression = [AWSDynamoDBQueryExpression new];
+    queryExpression.keyConditionExpression = @"hashKey = :hashKey";
+    queryExpression.expressionAttributeValues = @{@":hashKey" : @"hash-5"};
+    queryExpression.limit = @(AWSDynamoDBPerformanceTestsItemCount);
+    [self measureBlock:^{
+        int64_t allocations = AWSDynamoDBPerformanceTestsAttributeValueAllocations;
+        CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+        AWSTask<AWSDynamoDBPaginatedOutput *> *task = [objectMapper query:[AWSDynamoDBStubEndpointItem class]
+                                                               expression:queryExpression];
+        [task waitUntilFinished];
+        CFAbsoluteTime elapsed = CFAbsoluteTimeGetCurrent() - start;
+
+        XCTAssertEqual(task.result.items.count, AWSDynamoDBPerformanceTestsItemCount);
+        NSLog(@"%.0f items/sec, %lld AWSDynamoDBAttributeValue allocations",
+              AWSDynamoDBPerformanceTestsItemCount / elapsed,
+              AWSDynamoDBPerformanceTestsAttributeValueAllocations - allocations);
+    }];
+
+    [AWSDynamoDBObjectMapper removeDynamoDBObjectMapperForKey:AWSDynamoDBPerformanceTestsObjectMapperKey];
+}
+
+#pragma mark - Service definition
+
+// The work before a client's first request: load the definition, then read one operation and its input shape.
+- (void)measureFirstRequestWithDefinitionLoader:(NSDictionary *(^)(NSString *definitionString))loader {
+    NSString *definitionString = [[AWSDynamoDBResources sharedInstance] definitionString];
+
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 10; i++) {
+            NSDictionary *definition = loader(definitionString);
+            NSString *inputShape = definition[@"operations"][@"GetItem"][@"input"][@"shape"];
+            XCTAssertNotNil(definition[@"shapes"][inputShape]);
+        }
+    }];
+}
+
+- (void)testPerformanceFirstRequestWithLazyDefinition {
+    [self measureFirstRequestWithDefinitionLoader:^NSDictionary *(NSString *definitionString) {
+        return [AWSServiceDefinition definitionWithJSONString:definitionString error:nil];
+    }];
+}
+
+- (void)testPerformanceFirstRequestWithJSONSerializationDefinition {
+    [self measureFirstRequestWithDefinitionLoader:^NSDictionary *(NSString *definitionString) {
+        return [NSJSONSerialization JSONObjectWithData:[definitionString dataUsingEncoding:NSUTF8StringEncoding]
+                                               options:kNilOptions
+                                                 error:nil];
+    }];
+}
+
+@end
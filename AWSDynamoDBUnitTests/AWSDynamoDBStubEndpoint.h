@@ -0,0 +1,85 @@
+//
+// Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+
+#import <Foundation/Foundation.h>
+#import "AWSDynamoDB.h"
+#import "AWSTestStubEndpoint.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ A table row model used with the stub endpoint, with a string hash key, a numeric range key, and map and list attributes.
+ */
+@interface AWSDynamoDBStubEndpointItem : AWSDynamoDBObjectModel <AWSDynamoDBModeling>
+
+@property (nonatomic, strong, nullable) NSString *hashKey;
+@property (nonatomic, strong, nullable) NSNumber *rangeKey;
+@property (nonatomic, strong, nullable) NSString *title;
+@property (nonatomic, strong, nullable) NSNumber *price;
+@property (nonatomic, strong, nullable) NSSet<NSString *> *tags;
+@property (nonatomic, strong, nullable) NSNumber *inStock;
+@property (nonatomic, strong, nullable) NSDictionary<NSString *, id> *dimensions;
+@property (nonatomic, strong, nullable) NSArray *history;
+
++ (instancetype)itemWithIndex:(NSUInteger)index;
+
+@end
+
+/**
+ An in-process DynamoDB endpoint that serves requests from in-memory tables.
+ */
+@interface AWSDynamoDBStubEndpoint : AWSTestStubEndpoint
+
+/**
+ The fraction of the requests in each BatchWriteItem and BatchGetItem call
+ returned as unprocessed, taken from the end of the request. At least one
+ request of each call is always processed.
+ */
+@property (atomic, assign) double unprocessedFraction;
+
+/**
+ Simulated round-trip time of every request, in seconds.
+ */
+@property (atomic, assign) NSTimeInterval latency;
+
+/**
+ An operation, for example `BatchWriteItem`, that fails with `ResourceNotFoundException`.
+ */
+@property (atomic, strong, nullable) NSString *failingOperation;
+
+@property (atomic, readonly) NSUInteger requestCount;
+@property (atomic, readonly) NSUInteger maxConcurrentRequests;
+
+- (instancetype)initWithKeyAttributes:(NSDictionary<NSString *, NSArray<NSString *> *> *)keyAttributesByTableName;
+
+/**
+ Routes the requests of the service client behind the object mapper to this endpoint.
+ */
+- (void)attachToObjectMapper:(AWSDynamoDBObjectMapper *)objectMapper;
+
+- (NSUInteger)requestCountForOperation:(NSString *)operationName;
+
+- (NSUInteger)itemCountInTable:(NSString *)tableName;
+
+/**
+ Returns the stored item in wire format, for example `@{@"hashKey" : @{@"S" : @"a"}}`.
+ */
+- (nullable NSDictionary *)itemInTable:(NSString *)tableName key:(NSDictionary *)key;
+
+- (void)putItem:(NSDictionary *)item inTable:(NSString *)tableName;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,355 @@
+//
+// Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+
+#import "AWSDynamoDBStubEndpoint.h"
+
+@implementation AWSDynamoDBStubEndpointItem
+
++ (NSString *)dynamoDBTableName {
+    return @"AWSDynamoDBStubEndpointTable";
+}
+
++ (NSString *)hashKeyAttribute {
+    return @"hashKey";
+}
+
++ (NSString *)rangeKeyAttribute {
+    return @"rangeKey";
+}
+
++ (instancetype)itemWithIndex:(NSUInteger)index {
+    AWSDynamoDBStubEndpointItem *item = [AWSDynamoDBStubEndpointItem new];
+    item.hashKey = [NSString stringWithFormat:@"hash-%lu", (unsigned long)(index % 97)];
+    item.rangeKey = @(index);
+    item.title = [NSString stringWithFormat:@"A reasonably long title attribute for item %lu", (unsigned long)index];
+    item.price = @(index * 0.25);
+    item.tags = [NSSet setWithObjects:@"red", @"green", [NSString stringWithFormat:@"tag-%lu", (unsigned long)(index % 7)], nil];
+    item.inStock = index % 3 != 0 ? @YES : @NO;
+    item.dimensions = @{@"width" : @(10 + index % 5),
+                        @"height" : @20,
+                        @"unit" : @"cm",
+                        @"packaging" : @{@"weight" : @1.5, @"fragile" : @NO}};
+    item.history = @[@"created", @{@"event" : @"updated", @"version" : @(index)}, @[@1, @2, @3]];
+    return item;
+}
+
+@end
+
+@interface AWSDynamoDBStubEndpoint()
+
+@property (nonatomic, strong) NSDictionary<NSString *, NSArray<NSString *> *> *keyAttributesByTableName;
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSMutableDictionary<NSString *, NSDictionary *> *> *tables;
+@property (nonatomic, strong) NSCountedSet<NSString *> *operationCounts;
+@property (nonatomic, assign) NSUInteger concurrentRequests;
+@property (atomic, readwrite) NSUInteger requestCount;
+@property (atomic, readwrite) NSUInteger maxConcurrentRequests;
+
+@end
+
+@implementation AWSDynamoDBStubEndpoint
+
+- (instancetype)initWithKeyAttributes:(NSDictionary<NSString *, NSArray<NSString *> *> *)keyAttributesByTableName {
+    if (self = [super init]) {
+        _keyAttributesByTableName = [keyAttributesByTableName copy];
+        _tables = [NSMutableDictionary new];
+        _operationCounts = [NSCountedSet new];
+    }
+    return self;
+}
+
+- (void)attachToObjectMapper:(AWSDynamoDBObjectMapper *)objectMapper {
+    [self attachToServiceClient:[objectMapper valueForKey:@"dynamoDB"]];
+}
+
+- (NSUInteger)requestCountForOperation:(NSString *)operationName {
+    @synchronized(self) {
+        return [self.operationCounts countForObject:operationName];
+    }
+}
+
+- (NSUInteger)itemCountInTable:(NSString *)tableName {
+    @synchronized(self) {
+        return [self.tables[tableName] count];
+    }
+}
+
+- (NSDictionary *)itemInTable:(NSString *)tableName key:(NSDictionary *)key {
+    @synchronized(self) {
+        return self.tables[tableName][[self storageKeyForTable:tableName attributes:key]];
+    }
+}
+
+- (void)putItem:(NSDictionary *)item inTable:(NSString *)tableName {
+    @synchronized(self) {
+        [self putItemLocked:item inTable:tableName];
+    }
+}
+
+#pragma mark - Request handling
+
+- (AWSTask<AWSTestHTTPResponse *> *)responseForRequest:(NSURLRequest *)request parameters:(NSDictionary *)parameters {
+    NSString *operationName = [[[request valueForHTTPHeaderField:@"X-Amz-Target"] componentsSeparatedByString:@"."] lastObject];
+    NSDictionary *body = [NSJSONSerialization JSONObjectWithData:request.HTTPBody options:0 error:nil];
+
+    NSString *status = @"200 OK";
+    NSDictionary *responseBody = nil;
+    @synchronized(self) {
+        self.requestCount++;
+        [self.operationCounts addObject:operationName];
+        self.concurrentRequests++;
+        self.maxConcurrentRequests = MAX(self.maxConcurrentRequests, self.concurrentRequests);
+
+        if ([operationName isEqualToString:self.failingOperation]) {
+            status = @"400 Bad Request";
+            responseBody = @{@"__type" : @"com.amazonaws.dynamodb.v20120810#ResourceNotFoundException",
+                             @"message" : @"Requested resource not found"};
+        } else if ([operationName isEqualToString:@"BatchGetItem"] && [self hasDuplicateKeys:body]) {
+            status = @"400 Bad Request";
+            responseBody = @{@"__type" : @"com.amazon.coral.validate#ValidationException",
+                             @"message" : @"Provided list of item keys contains duplicates"};
+        } else {
+            responseBody = [self responseForOperation:operationName body:body];
+        }
+    }
+
+    AWSTestHTTPResponse *response = [AWSTestHTTPResponse responseWithStatus:status
+                                                                    headers:@{@"Content-Type" : @"application/x-amz-json-1.0"}
+                                                                       body:[NSJSONSerialization dataWithJSONObject:responseBody options:0 error:nil]];
+    AWSTaskCompletionSource *completionSource = [AWSTaskCompletionSource taskCompletionSource];
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(self.latency * NSEC_PER_SEC)), dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        @synchronized(self) {
+            self.concurrentRequests--;
+        }
+        [completionSource setResult:response];
+    });
+
+    return completionSource.task;
+}
+
+- (NSDictionary *)responseForOperation:(NSString *)operationName body:(NSDictionary *)body {
+    if ([operationName isEqualToString:@"BatchWriteItem"]) {
+        return [self batchWriteItem:body];
+    }
+    if ([operationName isEqualToString:@"BatchGetItem"]) {
+        return [self batchGetItem:body];
+    }
+    if ([operationName isEqualToString:@"PutItem"]) {
+        [self putItemLocked:body[@"Item"] inTable:body[@"TableName"]];
+        return @{};
+    }
+    if ([operationName isEqualToString:@"UpdateItem"]) {
+        return [self updateItem:body];
+    }
+    if ([operationName isEqualToString:@"DeleteItem"]) {
+        [self.tables[body[@"TableName"]] removeObjectForKey:[self storageKeyForTable:body[@"TableName"] attributes:body[@"Key"]]];
+        return @{};
+    }
+    if ([operationName isEqualToString:@"Scan"]) {
+        return [self scan:body];
+    }
+    if ([operationName isEqualToString:@"Query"]) {
+        return [self query:body];
+    }
+    if ([operationName isEqualToString:@"GetItem"]) {
+        NSDictionary *item = self.tables[body[@"TableName"]][[self storageKeyForTable:body[@"TableName"] attributes:body[@"Key"]]];
+        return item ? @{@"Item" : item} : @{};
+    }
+
+    return @{};
+}
+
+- (NSDictionary *)batchWriteItem:(NSDictionary *)body {
+    NSDictionary<NSString *, NSArray *> *requestItems = body[@"RequestItems"];
+    NSUInteger total = 0;
+    for (NSString *tableName in requestItems) {
+        total += [requestItems[tableName] count];
+    }
+    NSUInteger processedCount = total - (NSUInteger)floor(total * self.unprocessedFraction);
+    processedCount = MAX(processedCount, 1);
+
+    NSMutableDictionary *unprocessedItems = [NSMutableDictionary new];
+    NSUInteger handled = 0;
+    for (NSString *tableName in [[requestItems allKeys] sortedArrayUsingSelector:@selector(compare:)]) {
+        for (NSDictionary *writeRequest in requestItems[tableName]) {
+            if (handled++ >= processedCount) {
+                NSMutableArray *tableItems = unprocessedItems[tableName] ?: [NSMutableArray new];
+                [tableItems addObject:writeRequest];
+                unprocessedItems[tableName] = tableItems;
+                continue;
+            }
+            if (writeRequest[@"PutRequest"]) {
+                [self putItemLocked:writeRequest[@"PutRequest"][@"Item"] inTable:tableName];
+            } else if (writeRequest[@"DeleteRequest"]) {
+                [self.tables[tableName] removeObjectForKey:[self storageKeyForTable:tableName attributes:writeRequest[@"DeleteRequest"][@"Key"]]];
+            }
+        }
+    }
+
+    return @{@"UnprocessedItems" : unprocessedItems};
+}
+
+- (NSDictionary *)batchGetItem:(NSDictionary *)body {
+    NSDictionary<NSString *, NSDictionary *> *requestItems = body[@"RequestItems"];
+    NSUInteger total = 0;
+    for (NSString *tableName in requestItems) {
+        total += [requestItems[tableName][@"Keys"] count];
+    }
+    NSUInteger processedCount = total - (NSUInteger)floor(total * self.unprocessedFraction);
+    processedCount = MAX(processedCount, 1);
+
+    NSMutableDictionary *responses = [NSMutableDictionary new];
+    NSMutableDictionary *unprocessedKeys = [NSMutableDictionary new];
+    NSUInteger handled = 0;
+    for (NSString *tableName in [[requestItems allKeys] sortedArrayUsingSelector:@selector(compare:)]) {
+        NSMutableArray *tableResponses = [NSMutableArray new];
+        NSMutableArray *tableUnprocessedKeys = [NSMutableArray new];
+        for (NSDictionary *key in requestItems[tableName][@"Keys"]) {
+            if (handled++ >= processedCount) {
+                [tableUnprocessedKeys addObject:key];
+                continue;
+            }
+            NSDictionary *item = self.tables[tableName][[self storageKeyForTable:tableName attributes:key]];
+            if (item) {
+                [tableResponses addObject:item];
+            }
+        }
+        responses[tableName] = tableResponses;
+        if (tableUnprocessedKeys.count > 0) {
+            NSMutableDictionary *keysAndAttributes = [requestItems[tableName] mutableCopy];
+            keysAndAttributes[@"Keys"] = tableUnprocessedKeys;
+            unprocessedKeys[tableName] = keysAndAttributes;
+        }
+    }
+
+    return @{@"Responses" : responses,
+             @"UnprocessedKeys" : unprocessedKeys};
+}
+
+- (BOOL)hasDuplicateKeys:(NSDictionary *)body {
+    NSDictionary<NSString *, NSDictionary *> *requestItems = body[@"RequestItems"];
+    for (NSString *tableName in requestItems) {
+        NSMutableSet<NSString *> *storageKeys = [NSMutableSet new];
+        for (NSDictionary *key in requestItems[tableName][@"Keys"]) {
+            NSString *storageKey = [self storageKeyForTable:tableName attributes:key];
+            if ([storageKeys containsObject:storageKey]) {
+                return YES;
+            }
+            [storageKeys addObject:storageKey];
+        }
+    }
+    return NO;
+}
+
+- (NSDictionary *)updateItem:(NSDictionary *)body {
+    NSString *tableName = body[@"TableName"];
+    NSString *storageKey = [self storageKeyForTable:tableName attributes:body[@"Key"]];
+    NSMutableDictionary *item = [self.tables[tableName][storageKey] mutableCopy] ?: [body[@"Key"] mutableCopy];
+    NSDictionary<NSString *, NSDictionary *> *attributeUpdates = body[@"AttributeUpdates"];
+    for (NSString *attributeName in attributeUpdates) {
+        NSDictionary *update = attributeUpdates[attributeName];
+        if ([update[@"Action"] isEqualToString:@"DELETE"]) {
+            [item removeObjectForKey:attributeName];
+        } else {
+            item[attributeName] = update[@"Value"];
+        }
+    }
+    [self putItemLocked:item inTable:tableName];
+
+    return @{};
+}
+
+// Items are split into segments by key, and each segment is returned in key order.
+- (NSDictionary *)scan:(NSDictionary *)body {
+    NSUInteger segment = [body[@"Segment"] unsignedIntegerValue];
+    NSUInteger totalSegments = MAX([body[@"TotalSegments"] unsignedIntegerValue], 1);
+
+    return [self pageOfItemsForRequest:body passingTest:^BOOL(NSString *storageKey, NSDictionary *item) {
+        return [storageKey hash] % totalSegments == segment;
+    }];
+}
+
+// Only key conditions of the form `hashKey = :value` are supported, anything after ` AND ` is ignored.
+- (NSDictionary *)query:(NSDictionary *)body {
+    NSString *hashKeyCondition = [[body[@"KeyConditionExpression"] componentsSeparatedByString:@" AND "] firstObject];
+    NSArray<NSString *> *operands = [hashKeyCondition componentsSeparatedByString:@" = "];
+    NSString *attributeName = [operands firstObject];
+    if (body[@"ExpressionAttributeNames"][attributeName]) {
+        attributeName = body[@"ExpressionAttributeNames"][attributeName];
+    }
+    NSDictionary *hashKeyValue = body[@"ExpressionAttributeValues"][[operands lastObject]];
+
+    return [self pageOfItemsForRequest:body passingTest:^BOOL(NSString *storageKey, NSDictionary *item) {
+        return [item[attributeName] isEqual:hashKeyValue];
+    }];
+}
+
+- (NSDictionary *)pageOfItemsForRequest:(NSDictionary *)body
+                            passingTest:(BOOL (^)(NSString *storageKey, NSDictionary *item))test {
+    NSString *tableName = body[@"TableName"];
+    NSDictionary<NSString *, NSDictionary *> *table = self.tables[tableName];
+    NSUInteger limit = [body[@"Limit"] unsignedIntegerValue] ?: 100;
+    NSString *startKey = body[@"ExclusiveStartKey"] ? [self storageKeyForTable:tableName attributes:body[@"ExclusiveStartKey"]] : nil;
+
+    NSMutableArray<NSString *> *matchingKeys = [NSMutableArray new];
+    for (NSString *storageKey in table) {
+        if ((!startKey || [storageKey compare:startKey] == NSOrderedDescending)
+            && test(storageKey, table[storageKey])) {
+            [matchingKeys addObject:storageKey];
+        }
+    }
+    [matchingKeys sortUsingSelector:@selector(compare:)];
+
+    NSArray<NSString *> *pageKeys = [matchingKeys subarrayWithRange:NSMakeRange(0, MIN(limit, matchingKeys.count))];
+    NSMutableArray *items = [NSMutableArray arrayWithCapacity:pageKeys.count];
+    for (NSString *storageKey in pageKeys) {
+        [items addObject:table[storageKey]];
+    }
+
+    NSMutableDictionary *response = [@{@"Items" : items,
+                                       @"Count" : @(items.count),
+                                       @"ScannedCount" : @(items.count)} mutableCopy];
+    if (matchingKeys.count > pageKeys.count) {
+        NSMutableDictionary *lastEvaluatedKey = [NSMutableDictionary new];
+        for (NSString *keyAttribute in self.keyAttributesByTableName[tableName]) {
+            lastEvaluatedKey[keyAttribute] = [items lastObject][keyAttribute];
+        }
+        response[@"LastEvaluatedKey"] = lastEvaluatedKey;
+    }
+
+    return response;
+}
+
+#pragma mark - Storage
+
+- (void)putItemLocked:(NSDictionary *)item inTable:(NSString *)tableName {
+    NSMutableDictionary *table = self.tables[tableName];
+    if (!table) {
+        table = [NSMutableDictionary new];
+        self.tables[tableName] = table;
+    }
+    table[[self storageKeyForTable:tableName attributes:item]] = item;
+}
+
+- (NSString *)storageKeyForTable:(NSString *)tableName attributes:(NSDictionary *)attributes {
+    NSMutableArray *keyValues = [NSMutableArray new];
+    for (NSString *keyAttribute in self.keyAttributesByTableName[tableName]) {
+        [keyValues addObject:attributes[keyAttribute] ?: [NSNull null]];
+    }
+    // Each value is a single-entry dictionary such as {"S": "a"}, so the JSON is stable.
+    NSData *data = [NSJSONSerialization dataWithJSONObject:keyValues options:0 error:nil];
+    return [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
+}
+
+@end
@@ -0,0 +1,146 @@
+//
+// Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+#import <XCTest/XCTest.h>
+#import "AWSEC2Service.h"
+
+@interface AWSEC2Resources (AWSEC2PerformanceTests)
+
+- (NSString *)definitionString;
+
+@end
+
+static NSUInteger const AWSEC2PerformanceTestsReservationCount = 200;
+
+// Builds a fresh mapping plan on every use, like the adapter did before plans
+// were cached per model class.
+@interface AWSEC2PerformanceTestsUncachedAdapter : AWSMTLJSONAdapter
+
+@end
+
+@implementation AWSEC2PerformanceTestsUncachedAdapter
+
+@end
+
+@interface AWSEC2PerformanceTests : XCTestCase
+
+@end
+
+@implementation AWSEC2PerformanceTests
+
+// A DescribeInstancesResult as the XML response serializer hands it to the adapter.
++ (NSDictionary *)describeInstancesJSONWithReservationCount:(NSUInteger)count {
+    NSMutableArray *reservations = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger i = 0; i < count; i++) {
+        NSMutableArray *instances = [NSMutableArray array];
+        for (NSUInteger j = 0; j < 4; j++) {
+            [instances addObject:@{@"InstanceId" : [NSString stringWithFormat:@"i-%08lx%lu", (unsigned long)i, (unsigned long)j],
+                                   @"ImageId" : @"ami-12345678",
+                                   @"InstanceType" : @"t2.micro",
+                                   @"Architecture" : @"x86_64",
+                                   @"Hypervisor" : @"xen",
+                                   @"LaunchTime" : @"2018-01-02T03:04:05.000Z",
+                                   @"PrivateDnsName" : @"ip-10-0-0-1.ec2.internal",
+                                   @"PrivateIpAddress" : @"10.0.0.1",
+                                   @"PublicDnsName" : @"ec2-54-0-0-1.compute-1.amazonaws.com",
+                                   @"PublicIpAddress" : @"54.0.0.1",
+                                   @"RootDeviceName" : @"/dev/xvda",
+                                   @"RootDeviceType" : @"ebs",
+                                   @"SubnetId" : @"subnet-12345678",
+                                   @"VpcId" : @"vpc-12345678",
+                                   @"VirtualizationType" : @"hvm",
+                                   @"EbsOptimized" : @NO,
+                                   @"SourceDestCheck" : @YES,
+                                   @"State" : @{@"Code" : @16, @"Name" : @"running"},
+                                   @"Placement" : @{@"AvailabilityZone" : @"us-east-1a", @"Tenancy" : @"default"},
+                                   @"Monitoring" : @{@"State" : @"disabled"},
+                                   @"SecurityGroups" : @[@{@"GroupId" : @"sg-12345678", @"GroupName" : @"default"}],
+                                   @"Tags" : @[@{@"Key" : @"Name", @"Value" : @"web"},
+                                               @{@"Key" : @"Stage", @"Value" : @"prod"}]}];
+        }
+        [reservations addObject:@{@"ReservationId" : [NSString stringWithFormat:@"r-%08lx", (unsigned long)i],
+                                  @"OwnerId" : @"123456789012",
+                                  @"Groups" : @[@{@"GroupId" : @"sg-12345678", @"GroupName" : @"default"}],
+                                  @"Instances" : instances}];
+    }
+    return @{@"Reservations" : reservations, @"NextToken" : @"token"};
+}
+
+- (void)testDescribeInstancesDecoding {
+    NSDictionary *JSONDictionary = [AWSEC2PerformanceTests describeInstancesJSONWithReservationCount:3];
+    NSError *error = nil;
+    AWSEC2DescribeInstancesResult *result = [AWSMTLJSONAdapter modelOfClass:[AWSEC2DescribeInstancesResult class] fromJSONDictionary:JSONDictionary error:&error];
+    AWSEC2DescribeInstancesResult *uncachedResult = [AWSEC2PerformanceTestsUncachedAdapter modelOfClass:[AWSEC2DescribeInstancesResult class] fromJSONDictionary:JSONDictionary error:nil];
+
+    XCTAssertNil(error);
+    XCTAssertEqualObjects(result, uncachedResult);
+    XCTAssertEqualObjects(result.nextToken, @"token");
+    XCTAssertEqual(result.reservations.count, 3);
+    AWSEC2Instance *instance = result.reservations[1].instances[2];
+    XCTAssertEqualObjects(instance.instanceId, @"i-000000012");
+    XCTAssertEqual(instance.instanceType, AWSEC2InstanceTypeT2_micro);
+    XCTAssertEqual(instance.state.name, AWSEC2InstanceStateNameRunning);
+    XCTAssertEqualObjects(instance.tags[1].value, @"prod");
+    XCTAssertNotNil(instance.launchTime);
+}
+
+- (void)measureDescribeInstancesDecodingWithAdapterClass:(Class)adapterClass {
+    NSDictionary *JSONDictionary = [AWSEC2PerformanceTests describeInstancesJSONWithReservationCount:AWSEC2PerformanceTestsReservationCount];
+    [self measureBlock:^{
+        CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+        AWSEC2DescribeInstancesResult *result = [adapterClass modelOfClass:[AWSEC2DescribeInstancesResult class] fromJSONDictionary:JSONDictionary error:nil];
+        CFAbsoluteTime elapsed = CFAbsoluteTimeGetCurrent() - start;
+        XCTAssertEqual(result.reservations.count, AWSEC2PerformanceTestsReservationCount);
+        NSLog(@"%@ DescribeInstancesResult: %.0f instances/sec", adapterClass, AWSEC2PerformanceTestsReservationCount * 4 / elapsed);
+    }];
+}
+
+- (void)testPerformanceDescribeInstancesDecoding {
+    [self measureDescribeInstancesDecodingWithAdapterClass:[AWSMTLJSONAdapter class]];
+}
+
+- (void)testPerformanceDescribeInstancesDecodingWithoutCachedPlan {
+    [self measureDescribeInstancesDecodingWithAdapterClass:[AWSEC2PerformanceTestsUncachedAdapter class]];
+}
+
+#pragma mark - Service definition
+
+// The work before a client's first request: load the definition, then read one operation and its input shape.
+- (void)measureFirstRequestWithDefinitionLoader:(NSDictionary *(^)(NSString *definitionString))loader {
+    NSString *definitionString = [[AWSEC2Resources sharedInstance] definitionString];
+
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 10; i++) {
+            NSDictionary *definition = loader(definitionString);
+            NSString *inputShape = definition[@"operations"][@"DescribeInstances"][@"input"][@"shape"];
+            XCTAssertNotNil(definition[@"shapes"][inputShape]);
+        }
+    }];
+}
+
+- (void)testPerformanceFirstRequestWithLazyDefinition {
+    [self measureFirstRequestWithDefinitionLoader:^NSDictionary *(NSString *definitionString) {
+        return [AWSServiceDefinition definitionWithJSONString:definitionString error:nil];
+    }];
+}
+
+- (void)testPerformanceFirstRequestWithJSONSerializationDefinition {
+    [self measureFirstRequestWithDefinitionLoader:^NSDictionary *(NSString *definitionString) {
+        return [NSJSONSerialization JSONObjectWithData:[definitionString dataUsingEncoding:NSUTF8StringEncoding]
+                                               options:kNilOptions
+                                                 error:nil];
+    }];
+}
+
+@end
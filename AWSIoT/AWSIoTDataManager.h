@@ -554,6 +554,7 @@ enableStaleDiscards: BOOL, set to NO to disable discarding stale updates (defaul
 enableIgnoreDeltas: BOOL, set to YES to disable delta updates (default NO)
 QoS: AWSIoTMQTTQoS (default AWSIoTMQTTQoSMessageDeliveryAttemptedAtMostOnce)
 shadowOperationTimeoutSeconds: double, device shadow operation timeout (default 10.0)
+shadowUpdateCoalescingWindowSeconds: double, publish the updates made within this many seconds as a single update containing only the changed state; updates that change nothing are not published (default 0.0, each update is published as made)
  
  @param callback The function to call when updates are received for the device shadow.
  
@@ -594,6 +595,10 @@ shadowOperationTimeoutSeconds: double, device shadow operation timeout (default
  If the json data is not valid, it returns false, and no update message
  will be published. If the json data is valid, it publishes the data on
  $aws/things/thingName/shadow/update topic, then return true.
+ If the device shadow was registered with a shadowUpdateCoalescingWindowSeconds
+ option, the update is merged into the local state and published with the
+ other updates made within the window; the client token of the last update
+ that specifies one is used.
 
  @param name The name of the device shadow to be updated
 
@@ -610,6 +615,19 @@ shadowOperationTimeoutSeconds: double, device shadow operation timeout (default
            jsonString:(NSString *)jsonString
           clientToken:(NSString  * _Nullable)clientToken;
 
+/**
+ Get the local state of a device shadow
+
+ The state is kept up to date from the delta, documents and accepted messages received for the device shadow.
+ If the device shadow coalesces updates, it also includes the updates that have not been published yet.
+
+ @param name The device shadow to get the local state of.
+
+ @return The `desired` and `reported` state of the device shadow, or nil if it is not registered.
+
+ */
+- (nullable NSDictionary *) localStateForShadow:(NSString *)name;
+
 /**
  Get a device shadow
  
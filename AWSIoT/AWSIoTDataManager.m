@@ -16,6 +16,7 @@
 #import "AWSSignature.h"
 #import "AWSIoTDataManager.h"
 #import "AWSIoTMQTTClient.h"
+#import "AWSIoTShadowEngine.h"
 #import "AWSSynchronizedMutableDictionary.h"
 #import "AWSIoTModel.h"
 #import "AWSCocoaLumberjack.h"
@@ -56,6 +57,10 @@
 @property(nonatomic, strong) NSTimer *timer;
 @property(atomic, assign) NSTimeInterval operationTimeout;
 @property(atomic, assign) AWSIoTShadowOperationType operation;
+@property(nonatomic, strong) AWSIoTShadowEngine *engine;
+@property(atomic, assign) NSTimeInterval updateCoalescingWindow;
+@property(nonatomic, strong) NSTimer *coalescingTimer;
+@property(nonatomic, strong) NSString *coalescedClientToken;
 @end
 
 @implementation AWSIoTDataShadow
@@ -94,6 +99,10 @@
         _timer = nil;
         _clientToken = nil;
         _operation = AWSIoTShadowOperationTypeNone;
+        _engine = [AWSIoTShadowEngine new];
+        _updateCoalescingWindow = 0;
+        _coalescingTimer = nil;
+        _coalescedClientToken = nil;
     }
 
     return self;
@@ -602,8 +611,12 @@ static NSString * const AWSIoTShadowOperationStatusTypeStrings[] = {
                  name, (long)operation, (long)status);
     BOOL rc = NO;
     NSError *error;
-    NSDictionary *jsonDictionary = [NSJSONSerialization JSONObjectWithData:payload options:NSJSONReadingMutableContainers error:&error];
-    if (jsonDictionary == nil){
+    //
+    // The shadow engine copies only the objects a message changes, so the
+    // payload does not need mutable containers.
+    //
+    NSDictionary *jsonDictionary = [NSJSONSerialization JSONObjectWithData:payload options:0 error:&error];
+    if (![jsonDictionary isKindOfClass:[NSDictionary class]]){
         AWSDDLogError(@"Failed to deserialize payload into json dictionanry. Error:%@",
                       [error localizedDescription]);
         return rc;
@@ -666,6 +679,7 @@ static NSString * const AWSIoTShadowOperationStatusTypeStrings[] = {
     //
     if (status == AWSIoTShadowOperationStatusTypeDelta
         || status == AWSIoTShadowOperationStatusTypeDocuments) {
+        [self updateEngineOfShadow:shadow operation:operation status:status document:jsonDictionary ownOperation:NO];
         shadow.callback( shadow.name, operation, status, shadow.clientToken, payload );
     }
     else {
@@ -679,6 +693,7 @@ static NSString * const AWSIoTShadowOperationStatusTypeStrings[] = {
         //
         if ((shadow.timer == nil) || ![shadowModel.clientToken isEqualToString:shadow.clientToken] ) {
             AWSDDLogDebug(@" timer is nil or shadow token mismatch.");
+            [self updateEngineOfShadow:shadow operation:operation status:status document:jsonDictionary ownOperation:NO];
             if (status == AWSIoTShadowOperationStatusTypeAccepted &&
                 operation != AWSIoTShadowOperationTypeGet &&
                 shadow.enableForeignStateUpdateNotifications == YES) {
@@ -695,16 +710,68 @@ static NSString * const AWSIoTShadowOperationStatusTypeStrings[] = {
             //
             [shadow.timer invalidate];
             shadow.timer = nil;
+            [self updateEngineOfShadow:shadow operation:operation status:status document:jsonDictionary ownOperation:YES];
             //
             // Invoke the user's callback.
             //
             shadow.callback( shadow.name, operation, status, shadowModel.clientToken, payload );
+            //
+            // Publish the updates coalesced while this operation was in progress.
+            //
+            [self scheduleCoalescedUpdateForShadow:shadow];
         }
     }
 
     return rc;
 }
 
+- (void)updateEngineOfShadow:(AWSIoTDataShadow *)shadow
+                   operation:(AWSIoTShadowOperationType)operation
+                      status:(AWSIoTShadowOperationStatusType)status
+                    document:(NSDictionary *)document
+                ownOperation:(BOOL)ownOperation {
+    NSDictionary *state = [document[@"state"] isKindOfClass:[NSDictionary class]] ? document[@"state"] : nil;
+    UInt32 version = (UInt32)[document[@"version"] integerValue];
+
+    if (status == AWSIoTShadowOperationStatusTypeDelta) {
+        if (state != nil) {
+            [shadow.engine applyDeltaState:state version:version];
+        }
+    }
+    else if (status == AWSIoTShadowOperationStatusTypeDocuments) {
+        //
+        // Documents messages carry the complete shadow state after an update.
+        //
+        NSDictionary *current = document[@"current"];
+        if ([current isKindOfClass:[NSDictionary class]] && [current[@"state"] isKindOfClass:[NSDictionary class]]) {
+            [shadow.engine replaceState:current[@"state"] version:(UInt32)[current[@"version"] integerValue]];
+        }
+    }
+    else if (status == AWSIoTShadowOperationStatusTypeAccepted) {
+        if (operation == AWSIoTShadowOperationTypeUpdate) {
+            if (ownOperation == YES) {
+                [shadow.engine publishAcceptedWithState:state version:version];
+            }
+            else if (state != nil) {
+                [shadow.engine applyAcceptedState:state version:version];
+            }
+        }
+        else if (operation == AWSIoTShadowOperationTypeGet) {
+            if (state != nil) {
+                [shadow.engine replaceState:state version:version];
+            }
+        }
+        else if (operation == AWSIoTShadowOperationTypeDelete) {
+            [shadow.engine reset];
+        }
+    }
+    else if (status == AWSIoTShadowOperationStatusTypeRejected) {
+        if (ownOperation == YES && operation == AWSIoTShadowOperationTypeUpdate) {
+            [shadow.engine publishRejected];
+        }
+    }
+}
+
 static void (^shadowMqttMessageHandler)(NSObject *mqttClient, NSString *topic, NSData *data) = ^(NSObject *mqttClient, NSString *topic, NSData *data) {
     AWSIoTDataManager *iotDataManager = (AWSIoTDataManager *)(((AWSIoTMQTTClient *)mqttClient).associatedObject);
     //
@@ -784,6 +851,13 @@ static void (^shadowMqttMessageHandler)(NSObject *mqttClient, NSString *topic, N
     
     shadow.callback( shadow.name, shadow.operation, AWSIoTShadowOperationStatusTypeTimeout, shadow.clientToken, payloadData );
     //
+    // A timed out update may or may not have been applied; publish it again
+    // with the next coalesced update.
+    //
+    if (shadow.operation == AWSIoTShadowOperationTypeUpdate) {
+        [shadow.engine cancelPublish];
+    }
+    //
     // Indicate that no operation is currently active.
     //
     shadow.operation = AWSIoTShadowOperationTypeNone;
@@ -792,6 +866,57 @@ static void (^shadowMqttMessageHandler)(NSObject *mqttClient, NSString *topic, N
     //
     [shadow.timer invalidate];
     shadow.timer = nil;
+
+    [self scheduleCoalescedUpdateForShadow:shadow];
+}
+
+- (void)scheduleCoalescedUpdateForShadow:(AWSIoTDataShadow *)shadow {
+    @synchronized(shadow) {
+        if (shadow.updateCoalescingWindow > 0 &&
+            shadow.coalescingTimer == nil &&
+            shadow.engine.hasPendingUpdate == YES) {
+            shadow.coalescingTimer = [NSTimer timerWithTimeInterval:shadow.updateCoalescingWindow
+                                                             target:self
+                                                           selector:@selector(publishCoalescedUpdateOnTimer:)
+                                                           userInfo:shadow.name
+                                                            repeats:NO];
+            [[NSRunLoop mainRunLoop] addTimer:shadow.coalescingTimer forMode:NSRunLoopCommonModes];
+        }
+    }
+}
+
+- (void) publishCoalescedUpdateOnTimer:(NSTimer *)timer {
+    NSString *shadowName = (NSString *)[timer userInfo];
+    AWSIoTDataShadow *shadow = [self.shadows objectForKey:shadowName];
+    if (shadow == nil) {
+        return;
+    }
+
+    NSString *clientToken = nil;
+    @synchronized(shadow) {
+        shadow.coalescingTimer = nil;
+        //
+        // Wait for the operation in progress; its response schedules the
+        // next coalesced update.
+        //
+        if (shadow.timer != nil) {
+            return;
+        }
+        clientToken = shadow.coalescedClientToken;
+        shadow.coalescedClientToken = nil;
+    }
+
+    NSDictionary *patch = [shadow.engine beginPublish];
+    if (patch == nil) {
+        return;
+    }
+    NSMutableDictionary *stateDictionary = [NSMutableDictionary dictionaryWithObject:patch forKey:@"state"];
+    if (clientToken != nil) {
+        [stateDictionary setValue:clientToken forKey:@"clientToken"];
+    }
+    if ([self operationWithShadow:shadowName operation:AWSIoTShadowOperationTypeUpdate stateDictionary:stateDictionary] == NO) {
+        [shadow.engine cancelPublish];
+    }
 }
 
 - (BOOL) operationWithShadow:(NSString *)name
@@ -926,6 +1051,10 @@ static void (^shadowMqttMessageHandler)(NSObject *mqttClient, NSString *topic, N
                 if (numberOptionValue != nil) {
                     shadow.operationTimeout = [numberOptionValue doubleValue];
                 }
+                numberOptionValue = [options valueForKey:@"shadowUpdateCoalescingWindowSeconds"];
+                if (numberOptionValue != nil) {
+                    shadow.updateCoalescingWindow = [numberOptionValue doubleValue];
+                }
             }
             if (shadow.enableIgnoreDeltas == NO) {
                 [self createSubscriptionsForShadow:shadow
@@ -975,6 +1104,10 @@ static void (^shadowMqttMessageHandler)(NSObject *mqttClient, NSString *topic, N
         //invalidate the timer as the shadow is being unregistered.
         [shadow.timer invalidate];
         shadow.timer = nil;
+        @synchronized(shadow) {
+            [shadow.coalescingTimer invalidate];
+            shadow.coalescingTimer = nil;
+        }
         //
         // Remove the shadow from the dictionary
         //
@@ -995,30 +1128,43 @@ static void (^shadowMqttMessageHandler)(NSObject *mqttClient, NSString *topic, N
            jsonString:(NSString *)jsonString
           clientToken:(NSString *)clientToken {
     NSError *error;
-    NSMutableDictionary *jsonDictionary =
+    NSDictionary *jsonDictionary =
         [NSJSONSerialization JSONObjectWithData:[jsonString dataUsingEncoding:NSUTF8StringEncoding]
-                                        options:NSJSONReadingMutableContainers
+                                        options:0
                                           error:&error];
     
     BOOL rc = NO;
     
-    if (error == nil) {
+    if ([jsonDictionary isKindOfClass:[NSDictionary class]]) {
         //
         // Verify that the JSON state doesn't contain a "version" property,
         // as this property is reserved for use within this class and the
         // service.
         //
         if ([jsonDictionary objectForKey:@"version"] == nil) {
-            //
-            // If the caller has specified a client token to use, add it to the dictionary.
-            //
-            if (clientToken != nil) {
-                [jsonDictionary setValue:clientToken forKey:@"clientToken"];
+            AWSIoTDataShadow *shadow = [self.shadows objectForKey:name];
+            if (shadow.updateCoalescingWindow > 0) {
+                //
+                // Merge the update into the local shadow state; it is published
+                // together with the other updates made within the window.
+                //
+                rc = [self coalesceUpdateForShadow:shadow
+                                    jsonDictionary:jsonDictionary
+                                       clientToken:clientToken];
+            }
+            else {
+                NSMutableDictionary *stateDictionary = [jsonDictionary mutableCopy];
+                //
+                // If the caller has specified a client token to use, add it to the dictionary.
+                //
+                if (clientToken != nil) {
+                    [stateDictionary setValue:clientToken forKey:@"clientToken"];
+                }
+                //
+                // Perform the shadow update operation.
+                //
+                rc = [self operationWithShadow:name operation:AWSIoTShadowOperationTypeUpdate stateDictionary:stateDictionary];
             }
-            //
-            // Perform the shadow update operation.
-            //
-            rc = [self operationWithShadow:name operation:AWSIoTShadowOperationTypeUpdate stateDictionary:jsonDictionary];
         }
         else {
             AWSDDLogError(@"json for (%@) cannot contain a version property", name);
@@ -1030,6 +1176,36 @@ static void (^shadowMqttMessageHandler)(NSObject *mqttClient, NSString *topic, N
     return rc;
 }
 
+- (BOOL) coalesceUpdateForShadow:(AWSIoTDataShadow *)shadow
+                  jsonDictionary:(NSDictionary *)jsonDictionary
+                     clientToken:(NSString *)clientToken {
+    NSDictionary *state = [jsonDictionary objectForKey:@"state"];
+    if (![state isKindOfClass:[NSDictionary class]]) {
+        AWSDDLogError(@"json for (%@) must contain a state object", shadow.name);
+        return NO;
+    }
+    if (clientToken == nil) {
+        clientToken = [jsonDictionary objectForKey:@"clientToken"];
+    }
+    @synchronized(shadow) {
+        if (clientToken != nil) {
+            shadow.coalescedClientToken = clientToken;
+        }
+    }
+    //
+    // Updates that do not change the local state are not published.
+    //
+    if ([shadow.engine mergeState:state] == YES) {
+        [self scheduleCoalescedUpdateForShadow:shadow];
+    }
+    return YES;
+}
+
+- (NSDictionary *) localStateForShadow:(NSString *)name {
+    AWSIoTDataShadow *shadow = [self.shadows objectForKey:name];
+    return shadow.engine.state;
+}
+
 - (BOOL) getShadow:(NSString *)name {
     return [self getShadow:name clientToken:nil];
 }
@@ -0,0 +1,116 @@
+//
+// Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Applies a JSON merge patch (RFC 7386) to `target` and returns the result. Objects along the changed paths are
+ copied; everything else, and `target` itself when the patch changes nothing, is returned as is.
+ */
+FOUNDATION_EXPORT id _Nullable AWSIoTShadowApplyMergePatch(id _Nullable target, id patch);
+
+/**
+ Returns the smallest JSON merge patch that turns `source` into `target`, or nil if the two are equal.
+ */
+FOUNDATION_EXPORT NSDictionary * _Nullable AWSIoTShadowCreateMergePatch(NSDictionary *source, NSDictionary *target);
+
+/**
+ The local copy of a device shadow's `desired` and `reported` state.
+
+ The engine keeps three views of the state: the state last confirmed by AWS IoT, the state AWS IoT will have once
+ the update in flight is accepted, and the local state including updates that have not been published yet. Local
+ updates are merged into the local state; `beginPublish` returns the minimal merge patch between the local state
+ and what AWS IoT already has or is about to have. Incoming messages are merged into the confirmed state, and
+ updates that have not been published yet are replayed on top of it.
+
+ The engine is thread safe.
+ */
+@interface AWSIoTShadowEngine : NSObject
+
+/**
+ The local state of the shadow, including updates that have not been published yet.
+ */
+@property (nonatomic, readonly) NSDictionary *state;
+
+/**
+ The version of the last state received from AWS IoT, or 0 if unknown.
+ */
+@property (nonatomic, readonly) UInt32 version;
+
+/**
+ YES if the local state may differ from the state AWS IoT has or is about to have.
+ */
+@property (nonatomic, readonly) BOOL hasPendingUpdate;
+
+/**
+ Merges `state`, the `state` object of a shadow update document, into the local state.
+
+ @return YES if the local state changed.
+ */
+- (BOOL)mergeState:(NSDictionary *)state;
+
+/**
+ Marks the pending updates as in flight and returns them as a single merge patch for the `state` object of a
+ shadow update document. Returns nil if there is nothing to publish or an update is already in flight.
+ */
+- (nullable NSDictionary *)beginPublish;
+
+/**
+ Puts the update in flight back with the pending updates, e.g. when it could not be sent or timed out.
+ Merge patches are idempotent, so publishing it again is safe.
+ */
+- (void)cancelPublish;
+
+/**
+ Completes the update in flight with the `state` echoed by AWS IoT in the `update/accepted` message.
+ */
+- (BOOL)publishAcceptedWithState:(nullable NSDictionary *)state version:(UInt32)version;
+
+/**
+ Drops the update in flight after AWS IoT rejected it.
+ */
+- (void)publishRejected;
+
+/**
+ Merges an `update/delta` message's `state` into the desired state.
+
+ @return NO if `version` is older than the local version and the message was ignored.
+ */
+- (BOOL)applyDeltaState:(NSDictionary *)state version:(UInt32)version;
+
+/**
+ Merges the `state` of an update accepted for another client.
+
+ @return NO if `version` is older than the local version and the message was ignored.
+ */
+- (BOOL)applyAcceptedState:(NSDictionary *)state version:(UInt32)version;
+
+/**
+ Replaces the confirmed state with the complete `state` of an `update/documents` or `get/accepted` message.
+
+ @return NO if `version` is older than the local version and the message was ignored.
+ */
+- (BOOL)replaceState:(NSDictionary *)state version:(UInt32)version;
+
+/**
+ Clears the confirmed state and version after the shadow was deleted.
+ */
+- (void)reset;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,300 @@
+//
+// Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+
+#import "AWSIoTShadowEngine.h"
+#import "AWSCocoaLumberjack.h"
+
+static NSString *const AWSIoTShadowEngineDesiredKey = @"desired";
+static NSString *const AWSIoTShadowEngineReportedKey = @"reported";
+
+static BOOL AWSIoTShadowIsObject(id value) {
+    return [value isKindOfClass:[NSDictionary class]];
+}
+
+//
+// NSNumber considers @YES equal to @1, but JSON does not.
+//
+static BOOL AWSIoTShadowValuesEqual(id value1, id value2) {
+    if (value1 == value2) {
+        return YES;
+    }
+    if (value1 == nil || value2 == nil) {
+        return NO;
+    }
+    if ([value1 isKindOfClass:[NSNumber class]] && [value2 isKindOfClass:[NSNumber class]]) {
+        BOOL isBoolean1 = CFGetTypeID((__bridge CFTypeRef)value1) == CFBooleanGetTypeID();
+        BOOL isBoolean2 = CFGetTypeID((__bridge CFTypeRef)value2) == CFBooleanGetTypeID();
+        if (isBoolean1 != isBoolean2) {
+            return NO;
+        }
+    }
+    return [value1 isEqual:value2];
+}
+
+id AWSIoTShadowApplyMergePatch(id target, id patch) {
+    if (!AWSIoTShadowIsObject(patch)) {
+        return patch;
+    }
+    NSDictionary *targetObject = AWSIoTShadowIsObject(target) ? target : @{};
+    NSMutableDictionary *result = nil;
+    for (NSString *key in (NSDictionary *)patch) {
+        id patchValue = patch[key];
+        id currentValue = targetObject[key];
+        if (patchValue == [NSNull null]) {
+            if (currentValue != nil) {
+                if (result == nil) {
+                    result = [targetObject mutableCopy];
+                }
+                [result removeObjectForKey:key];
+            }
+            continue;
+        }
+        id newValue = AWSIoTShadowApplyMergePatch(currentValue, patchValue);
+        if (newValue != currentValue && !AWSIoTShadowValuesEqual(newValue, currentValue)) {
+            if (result == nil) {
+                result = [targetObject mutableCopy];
+            }
+            result[key] = newValue;
+        }
+    }
+    return result != nil ? [result copy] : targetObject;
+}
+
+NSDictionary *AWSIoTShadowCreateMergePatch(NSDictionary *source, NSDictionary *target) {
+    if (source == target) {
+        return nil;
+    }
+    NSMutableDictionary *patch = nil;
+    for (NSString *key in source) {
+        if (target[key] == nil) {
+            if (patch == nil) {
+                patch = [NSMutableDictionary new];
+            }
+            patch[key] = [NSNull null];
+        }
+    }
+    for (NSString *key in target) {
+        id sourceValue = source[key];
+        id targetValue = target[key];
+        //
+        // The engine copies only the objects it changes, so most unchanged
+        // subtrees are the very same object in both documents.
+        //
+        if (sourceValue == targetValue) {
+            continue;
+        }
+        id value = nil;
+        if (AWSIoTShadowIsObject(sourceValue) && AWSIoTShadowIsObject(targetValue)) {
+            value = AWSIoTShadowCreateMergePatch(sourceValue, targetValue);
+        } else if (!AWSIoTShadowValuesEqual(sourceValue, targetValue)) {
+            value = targetValue;
+        }
+        if (value != nil) {
+            if (patch == nil) {
+                patch = [NSMutableDictionary new];
+            }
+            patch[key] = value;
+        }
+    }
+    return [patch copy];
+}
+
+@interface AWSIoTShadowEngine()
+
+// The state last confirmed by AWS IoT.
+@property (nonatomic, strong) NSDictionary *confirmedState;
+// The merge patch published but not yet accepted or rejected.
+@property (nonatomic, strong) NSDictionary *inFlightPatch;
+// The confirmed state with the in-flight patch applied.
+@property (nonatomic, strong) NSDictionary *publishedState;
+// The published state with the local updates applied.
+@property (nonatomic, strong) NSDictionary *localState;
+@property (nonatomic, assign) UInt32 currentVersion;
+
+@end
+
+@implementation AWSIoTShadowEngine
+
+- (instancetype)init {
+    if (self = [super init]) {
+        _confirmedState = @{};
+        _publishedState = _confirmedState;
+        _localState = _confirmedState;
+        _currentVersion = 0;
+    }
+    return self;
+}
+
+- (NSDictionary *)state {
+    @synchronized(self) {
+        return self.localState;
+    }
+}
+
+- (UInt32)version {
+    @synchronized(self) {
+        return self.currentVersion;
+    }
+}
+
+- (BOOL)hasPendingUpdate {
+    @synchronized(self) {
+        return self.localState != self.publishedState;
+    }
+}
+
+- (BOOL)mergeState:(NSDictionary *)state {
+    @synchronized(self) {
+        NSDictionary *localState = AWSIoTShadowApplyMergePatch(self.localState, state);
+        if (localState == self.localState) {
+            return NO;
+        }
+        self.localState = localState;
+        return YES;
+    }
+}
+
+- (NSDictionary *)beginPublish {
+    @synchronized(self) {
+        if (self.inFlightPatch != nil) {
+            return nil;
+        }
+        NSDictionary *patch = AWSIoTShadowCreateMergePatch(self.publishedState, self.localState);
+        if (patch == nil) {
+            //
+            // The local updates cancelled each other out.
+            //
+            self.localState = self.publishedState;
+            return nil;
+        }
+        self.inFlightPatch = patch;
+        self.publishedState = self.localState;
+        return patch;
+    }
+}
+
+- (void)cancelPublish {
+    @synchronized(self) {
+        if (self.inFlightPatch != nil) {
+            //
+            // The local state already includes the patch, so it becomes
+            // pending again.
+            //
+            self.inFlightPatch = nil;
+            self.publishedState = self.confirmedState;
+        }
+    }
+}
+
+- (BOOL)publishAcceptedWithState:(NSDictionary *)state version:(UInt32)version {
+    @synchronized(self) {
+        self.inFlightPatch = nil;
+        if (![self acceptVersion:version]) {
+            [self rebaseOnConfirmedState:self.confirmedState];
+            return NO;
+        }
+        [self rebaseOnConfirmedState:AWSIoTShadowIsObject(state) ? AWSIoTShadowApplyMergePatch(self.confirmedState, state) : self.confirmedState];
+        return YES;
+    }
+}
+
+- (void)publishRejected {
+    @synchronized(self) {
+        if (self.inFlightPatch != nil) {
+            //
+            // Replay only the updates made after the rejected patch was
+            // published.
+            //
+            NSDictionary *pendingPatch = AWSIoTShadowCreateMergePatch(self.publishedState, self.localState);
+            self.inFlightPatch = nil;
+            self.publishedState = self.confirmedState;
+            self.localState = pendingPatch != nil ? AWSIoTShadowApplyMergePatch(self.publishedState, pendingPatch) : self.publishedState;
+        }
+    }
+}
+
+- (BOOL)applyDeltaState:(NSDictionary *)state version:(UInt32)version {
+    @synchronized(self) {
+        if (![self acceptVersion:version]) {
+            return NO;
+        }
+        [self rebaseOnConfirmedState:AWSIoTShadowApplyMergePatch(self.confirmedState, @{AWSIoTShadowEngineDesiredKey : state})];
+        return YES;
+    }
+}
+
+- (BOOL)applyAcceptedState:(NSDictionary *)state version:(UInt32)version {
+    @synchronized(self) {
+        if (![self acceptVersion:version]) {
+            return NO;
+        }
+        [self rebaseOnConfirmedState:AWSIoTShadowApplyMergePatch(self.confirmedState, state)];
+        return YES;
+    }
+}
+
+- (BOOL)replaceState:(NSDictionary *)state version:(UInt32)version {
+    @synchronized(self) {
+        if (![self acceptVersion:version]) {
+            return NO;
+        }
+        //
+        // get/accepted also carries the computed delta; keep only the
+        // sections a client can update.
+        //
+        NSMutableDictionary *confirmedState = [NSMutableDictionary new];
+        for (NSString *key in @[AWSIoTShadowEngineDesiredKey, AWSIoTShadowEngineReportedKey]) {
+            if (AWSIoTShadowIsObject(state[key])) {
+                confirmedState[key] = state[key];
+            }
+        }
+        [self rebaseOnConfirmedState:[confirmedState copy]];
+        return YES;
+    }
+}
+
+- (void)reset {
+    @synchronized(self) {
+        self.currentVersion = 0;
+        [self rebaseOnConfirmedState:@{}];
+    }
+}
+
+#pragma mark - Internal
+
+- (BOOL)acceptVersion:(UInt32)version {
+    //
+    // Messages without a version are applied as they arrive.
+    //
+    if (version == 0) {
+        return YES;
+    }
+    if (version < self.currentVersion) {
+        AWSDDLogDebug(@"Ignoring shadow state version %u older than local version %u",
+                      (unsigned int)version, (unsigned int)self.currentVersion);
+        return NO;
+    }
+    self.currentVersion = version;
+    return YES;
+}
+
+- (void)rebaseOnConfirmedState:(NSDictionary *)confirmedState {
+    NSDictionary *pendingPatch = AWSIoTShadowCreateMergePatch(self.publishedState, self.localState);
+    self.confirmedState = confirmedState;
+    self.publishedState = self.inFlightPatch != nil ? AWSIoTShadowApplyMergePatch(confirmedState, self.inFlightPatch) : confirmedState;
+    self.localState = pendingPatch != nil ? AWSIoTShadowApplyMergePatch(self.publishedState, pendingPatch) : self.publishedState;
+}
+
+@end
@@ -0,0 +1,317 @@
+//
+// Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+
+#import <UIKit/UIKit.h>
+#import <XCTest/XCTest.h>
+#import "AWSIoT.h"
+#import "AWSIoTMQTTClient.h"
+#import "AWSIoTShadowEngine.h"
+
+static NSString *const AWSIoTShadowEngineTestsThingName = @"shadowEngineTestsThing";
+
+/**
+ Stands in for the MQTT broker and the AWS IoT shadow service. Updates published on the shadow update topic are
+ applied to a single shadow document and answered with accepted, documents and delta messages on the main queue.
+ */
+@interface AWSIoTShadowEngineTestsBroker : AWSIoTMQTTClient
+
+@property (nonatomic, strong) NSMutableDictionary<NSString *, AWSIoTMQTTExtendedNewMessageBlock> *subscriptions;
+@property (nonatomic, strong) NSMutableArray<NSDictionary *> *updateDocuments;
+@property (nonatomic, strong) NSDictionary *shadowState;
+@property (nonatomic, assign) UInt32 shadowVersion;
+@property (nonatomic, assign) BOOL rejectUpdates;
+@property (nonatomic, assign) BOOL holdResponses;
+@property (nonatomic, strong) NSMutableArray<dispatch_block_t> *heldResponses;
+
+- (void)deliverDocument:(NSDictionary *)document onTopic:(NSString *)topic;
+- (void)releaseResponses;
+
+@end
+
+@implementation AWSIoTShadowEngineTestsBroker
+
+- (instancetype)init {
+    if (self = [super init]) {
+        _subscriptions = [NSMutableDictionary new];
+        _updateDocuments = [NSMutableArray new];
+        _shadowState = @{};
+        _shadowVersion = 0;
+        _heldResponses = [NSMutableArray new];
+        self.clientId = @"shadowEngineTestsClient";
+    }
+    return self;
+}
+
+- (void)subscribeToTopic:(NSString *)topic qos:(UInt8)qos extendedCallback:(AWSIoTMQTTExtendedNewMessageBlock)callback {
+    self.subscriptions[topic] = callback;
+}
+
+- (void)unsubscribeTopic:(NSString *)topic {
+    [self.subscriptions removeObjectForKey:topic];
+}
+
+- (void)publishData:(NSData *)data qos:(UInt8)qos onTopic:(NSString *)topic {
+    NSString *shadowTopic = [NSString stringWithFormat:@"$aws/things/%@/shadow/", AWSIoTShadowEngineTestsThingName];
+    if (![topic isEqualToString:[shadowTopic stringByAppendingString:@"update"]]) {
+        return;
+    }
+    NSDictionary *document = [NSJSONSerialization JSONObjectWithData:data options:0 error:nil];
+    [self.updateDocuments addObject:document];
+
+    if (self.rejectUpdates) {
+        [self deliverDocument:@{@"code" : @400, @"message" : @"Rejected", @"clientToken" : document[@"clientToken"]}
+                      onTopic:[shadowTopic stringByAppendingString:@"update/rejected"]];
+        return;
+    }
+
+    NSDictionary *previousState = self.shadowState;
+    UInt32 previousVersion = self.shadowVersion;
+    self.shadowState = AWSIoTShadowApplyMergePatch(self.shadowState, document[@"state"]);
+    self.shadowVersion++;
+
+    [self deliverDocument:@{@"state" : document[@"state"], @"clientToken" : document[@"clientToken"], @"version" : @(self.shadowVersion)}
+                  onTopic:[shadowTopic stringByAppendingString:@"update/accepted"]];
+    [self deliverDocument:@{@"previous" : @{@"state" : previousState, @"version" : @(previousVersion)},
+                            @"current" : @{@"state" : self.shadowState, @"version" : @(self.shadowVersion)}}
+                  onTopic:[shadowTopic stringByAppendingString:@"update/documents"]];
+}
+
+- (void)deliverDocument:(NSDictionary *)document onTopic:(NSString *)topic {
+    NSData *data = [NSJSONSerialization dataWithJSONObject:document options:0 error:nil];
+    dispatch_block_t delivery = ^{
+        AWSIoTMQTTExtendedNewMessageBlock callback = self.subscriptions[topic];
+        if (callback != nil) {
+            callback(self, topic, data);
+        }
+    };
+    if (self.holdResponses) {
+        [self.heldResponses addObject:delivery];
+    } else {
+        dispatch_async(dispatch_get_main_queue(), delivery);
+    }
+}
+
+- (void)releaseResponses {
+    self.holdResponses = NO;
+    for (dispatch_block_t delivery in self.heldResponses) {
+        dispatch_async(dispatch_get_main_queue(), delivery);
+    }
+    [self.heldResponses removeAllObjects];
+}
+
+@end
+
+@interface AWSIoTShadowEngineTests : XCTestCase
+
+@property (nonatomic, strong) AWSIoTDataManager *dataManager;
+@property (nonatomic, strong) AWSIoTShadowEngineTestsBroker *broker;
+@property (nonatomic, strong) NSMutableArray<NSNumber *> *statuses;
+@property (nonatomic, strong) XCTestExpectation *responseExpectation;
+
+@end
+
+@implementation AWSIoTShadowEngineTests
+
+- (void)setUp {
+    [super setUp];
+    AWSServiceConfiguration *configuration =
+        [[AWSServiceConfiguration alloc] initWithRegion:AWSRegionUSEast1
+                                               endpoint:[[AWSEndpoint alloc] initWithURLString:@"https://TESTENDPOINT.iot.us-east-1.amazonaws.com"]
+                                    credentialsProvider:[[AWSStaticCredentialsProvider alloc] initWithAccessKey:@"testAccessKey"
+                                                                                                      secretKey:@"testSecretKey"]];
+    [AWSIoTDataManager registerIoTDataManagerWithConfiguration:configuration forKey:NSStringFromClass(self.class)];
+    self.dataManager = [AWSIoTDataManager IoTDataManagerForKey:NSStringFromClass(self.class)];
+
+    self.broker = [AWSIoTShadowEngineTestsBroker new];
+    self.broker.associatedObject = self.dataManager;
+    [self.dataManager setValue:self.broker forKey:@"mqttClient"];
+    self.statuses = [NSMutableArray new];
+}
+
+- (void)tearDown {
+    [self.dataManager unregisterFromShadow:AWSIoTShadowEngineTestsThingName];
+    [AWSIoTDataManager removeIoTDataManagerForKey:NSStringFromClass(self.class)];
+    [super tearDown];
+}
+
+- (void)registerWithCoalescingWindow:(double)window {
+    __weak AWSIoTShadowEngineTests *weakSelf = self;
+    XCTAssertTrue([self.dataManager registerWithShadow:AWSIoTShadowEngineTestsThingName
+                                               options:@{@"shadowUpdateCoalescingWindowSeconds" : @(window)}
+                                         eventCallback:^(NSString *name, AWSIoTShadowOperationType operation, AWSIoTShadowOperationStatusType status, NSString *clientToken, NSData *payload) {
+        [weakSelf.statuses addObject:@(status)];
+        if (status == AWSIoTShadowOperationStatusTypeAccepted || status == AWSIoTShadowOperationStatusTypeRejected) {
+            [weakSelf.responseExpectation fulfill];
+        }
+    }]);
+}
+
+- (void)update:(NSString *)jsonString {
+    XCTAssertTrue([self.dataManager updateShadow:AWSIoTShadowEngineTestsThingName jsonString:jsonString]);
+}
+
+- (void)waitForResponses:(NSUInteger)count {
+    self.responseExpectation = [self expectationWithDescription:@"shadow responses"];
+    self.responseExpectation.expectedFulfillmentCount = count;
+    [self waitForExpectationsWithTimeout:5 handler:nil];
+    // Let the documents messages that follow the responses arrive.
+    [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.05]];
+}
+
+- (void)testMergePatchRoundTrip {
+    NSDictionary *source = @{@"desired" : @{@"color" : @"red", @"led" : @{@"on" : @YES, @"level" : @3}},
+                             @"reported" : @{@"color" : @"red"}};
+    NSDictionary *target = @{@"desired" : @{@"color" : @"red", @"led" : @{@"on" : @1}},
+                             @"reported" : @{@"color" : @"blue", @"uptime" : @12}};
+
+    NSDictionary *patch = AWSIoTShadowCreateMergePatch(source, target);
+    NSDictionary *expectedPatch = @{@"desired" : @{@"led" : @{@"on" : @1, @"level" : [NSNull null]}},
+                                    @"reported" : @{@"color" : @"blue", @"uptime" : @12}};
+    XCTAssertEqualObjects(expectedPatch, patch);
+    XCTAssertEqualObjects(target, AWSIoTShadowApplyMergePatch(source, patch));
+
+    XCTAssertNil(AWSIoTShadowCreateMergePatch(source, [source copy]));
+    // A patch that changes nothing returns the very same document, and unchanged subtrees are shared.
+    XCTAssertTrue(AWSIoTShadowApplyMergePatch(source, @{@"desired" : @{@"color" : @"red"}, @"gone" : [NSNull null]}) == source);
+    NSDictionary *updated = AWSIoTShadowApplyMergePatch(source, @{@"reported" : @{@"color" : @"green"}});
+    XCTAssertTrue(updated[@"desired"] == source[@"desired"]);
+}
+
+- (void)testEngineReplaysPendingUpdatesOnIncomingState {
+    AWSIoTShadowEngine *engine = [AWSIoTShadowEngine new];
+    XCTAssertTrue([engine replaceState:@{@"desired" : @{@"mode" : @"eco"}, @"reported" : @{@"mode" : @"eco"}, @"delta" : @{}} version:4]);
+    XCTAssertEqualObjects((@{@"desired" : @{@"mode" : @"eco"}, @"reported" : @{@"mode" : @"eco"}}), engine.state);
+
+    XCTAssertTrue([engine mergeState:@{@"reported" : @{@"temperature" : @20}}]);
+    XCTAssertEqualObjects((@{@"reported" : @{@"temperature" : @20}}), [engine beginPublish]);
+    XCTAssertNil([engine beginPublish]);
+    XCTAssertTrue([engine mergeState:@{@"reported" : @{@"temperature" : @21}}]);
+
+    // A delta from another client lands beneath the local updates.
+    XCTAssertTrue([engine applyDeltaState:@{@"mode" : @"boost"} version:5]);
+    XCTAssertFalse([engine applyDeltaState:@{@"mode" : @"off"} version:3]);
+    XCTAssertEqual(5, engine.version);
+    XCTAssertEqualObjects((@{@"desired" : @{@"mode" : @"boost"}, @"reported" : @{@"mode" : @"eco", @"temperature" : @21}}), engine.state);
+
+    // A timed out patch is published again together with the later updates.
+    [engine cancelPublish];
+    XCTAssertEqualObjects((@{@"reported" : @{@"temperature" : @21}}), [engine beginPublish]);
+    XCTAssertTrue([engine publishAcceptedWithState:@{@"reported" : @{@"temperature" : @21}} version:6]);
+    XCTAssertFalse(engine.hasPendingUpdate);
+    XCTAssertEqualObjects((@{@"desired" : @{@"mode" : @"boost"}, @"reported" : @{@"mode" : @"eco", @"temperature" : @21}}), engine.state);
+
+    [engine reset];
+    XCTAssertEqual(0, engine.version);
+    XCTAssertEqualObjects(@{}, engine.state);
+}
+
+- (void)testUpdatesWithinWindowArePublishedAsOneMinimalPatch {
+    [self registerWithCoalescingWindow:0.1];
+
+    [self update:@"{\"state\":{\"reported\":{\"temperature\":20,\"humidity\":40,\"fan\":\"off\"}}}"];
+    [self update:@"{\"state\":{\"reported\":{\"temperature\":21}}}"];
+    [self update:@"{\"state\":{\"reported\":{\"temperature\":22,\"fan\":null}}}"];
+    XCTAssertEqual(0, self.broker.updateDocuments.count);
+    [self waitForResponses:1];
+
+    XCTAssertEqual(1, self.broker.updateDocuments.count);
+    XCTAssertEqualObjects((@{@"reported" : @{@"temperature" : @22, @"humidity" : @40}}), self.broker.updateDocuments[0][@"state"]);
+    XCTAssertNotNil(self.broker.updateDocuments[0][@"clientToken"]);
+    XCTAssertEqualObjects(self.broker.shadowState, [self.dataManager localStateForShadow:AWSIoTShadowEngineTestsThingName]);
+
+    // Only the changed value is sent next time.
+    [self update:@"{\"state\":{\"reported\":{\"temperature\":22,\"humidity\":41}}}"];
+    [self waitForResponses:1];
+    XCTAssertEqual(2, self.broker.updateDocuments.count);
+    XCTAssertEqualObjects((@{@"reported" : @{@"humidity" : @41}}), self.broker.updateDocuments[1][@"state"]);
+    XCTAssertEqual(2, self.broker.shadowVersion);
+}
+
+- (void)testRedundantUpdatesAreNotPublished {
+    [self registerWithCoalescingWindow:0.05];
+
+    [self update:@"{\"state\":{\"reported\":{\"temperature\":20}}}"];
+    [self waitForResponses:1];
+
+    [self update:@"{\"state\":{\"reported\":{\"temperature\":20}}}"];
+    [self update:@"{\"state\":{\"reported\":{\"temperature\":25}}}"];
+    [self update:@"{\"state\":{\"reported\":{\"temperature\":20}}}"];
+    [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.3]];
+
+    XCTAssertEqual(1, self.broker.updateDocuments.count);
+    XCTAssertEqual(1, self.broker.shadowVersion);
+}
+
+- (void)testUpdatesDuringOperationArePublishedAfterResponse {
+    [self registerWithCoalescingWindow:0.05];
+    self.broker.holdResponses = YES;
+
+    [self update:@"{\"state\":{\"reported\":{\"step\":1}}}"];
+    [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.1]];
+    XCTAssertEqual(1, self.broker.updateDocuments.count);
+
+    [self update:@"{\"state\":{\"reported\":{\"step\":2}}}"];
+    [self update:@"{\"state\":{\"reported\":{\"step\":3}}}"];
+    [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.1]];
+    XCTAssertEqual(1, self.broker.updateDocuments.count);
+
+    [self.broker releaseResponses];
+    [self waitForResponses:2];
+
+    XCTAssertEqual(2, self.broker.updateDocuments.count);
+    XCTAssertEqualObjects((@{@"reported" : @{@"step" : @3}}), self.broker.updateDocuments[1][@"state"]);
+    XCTAssertEqualObjects((@{@"reported" : @{@"step" : @3}}), self.broker.shadowState);
+}
+
+- (void)testRejectedUpdateIsDropped {
+    [self registerWithCoalescingWindow:0.05];
+    self.broker.rejectUpdates = YES;
+
+    [self update:@"{\"state\":{\"reported\":{\"temperature\":20}}}"];
+    [self waitForResponses:1];
+
+    XCTAssertEqualObjects(@(AWSIoTShadowOperationStatusTypeRejected), self.statuses.lastObject);
+    XCTAssertEqualObjects(@{}, [self.dataManager localStateForShadow:AWSIoTShadowEngineTestsThingName]);
+}
+
+- (void)testIncomingDeltaUpdatesLocalState {
+    [self registerWithCoalescingWindow:0.05];
+    NSString *deltaTopic = [NSString stringWithFormat:@"$aws/things/%@/shadow/update/delta", AWSIoTShadowEngineTestsThingName];
+
+    [self.broker deliverDocument:@{@"state" : @{@"light" : @{@"on" : @YES}}, @"version" : @7} onTopic:deltaTopic];
+    [self.broker deliverDocument:@{@"state" : @{@"light" : @{@"level" : @80}}, @"version" : @8} onTopic:deltaTopic];
+    [self.broker deliverDocument:@{@"state" : @{@"light" : @{@"on" : @NO}}, @"version" : @6} onTopic:deltaTopic];
+    [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.1]];
+
+    XCTAssertEqual(2, self.statuses.count);
+    XCTAssertEqualObjects((@{@"desired" : @{@"light" : @{@"on" : @YES, @"level" : @80}}}),
+                          [self.dataManager localStateForShadow:AWSIoTShadowEngineTestsThingName]);
+}
+
+- (void)testUpdatesWithoutWindowArePublishedAsMade {
+    [self registerWithCoalescingWindow:0];
+
+    [self update:@"{\"state\":{\"reported\":{\"temperature\":20}}}"];
+    [self waitForResponses:1];
+    [self update:@"{\"state\":{\"reported\":{\"temperature\":20}}}"];
+    [self waitForResponses:1];
+
+    XCTAssertEqual(2, self.broker.updateDocuments.count);
+    XCTAssertEqual(2, self.broker.shadowVersion);
+    XCTAssertEqualObjects((@{@"reported" : @{@"temperature" : @20}}),
+                          [self.dataManager localStateForShadow:AWSIoTShadowEngineTestsThingName]);
+}
+
+@end
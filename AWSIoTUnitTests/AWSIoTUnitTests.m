@@ -17,6 +17,12 @@
 #import "OCMock.h"
 #import "AWSIoT.h"
 
+@interface AWSIoTResources (AWSIoTUnitTests)
+
+- (NSString *)definitionString;
+
+@end
+
 static id mockNetworking = nil;
 
 @interface AWSIoTUnitTests : XCTestCase
@@ -927,4 +933,33 @@ static id mockNetworking = nil;
     [AWSIoT removeIoTForKey:key];
 }
 
+#pragma mark - Service definition
+
+// The work before a client's first request: load the definition, then read one operation and its input shape.
+- (void)measureFirstRequestWithDefinitionLoader:(NSDictionary *(^)(NSString *definitionString))loader {
+    NSString *definitionString = [[AWSIoTResources sharedInstance] definitionString];
+
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 10; i++) {
+            NSDictionary *definition = loader(definitionString);
+            NSString *inputShape = definition[@"operations"][@"ListThings"][@"input"][@"shape"];
+            XCTAssertNotNil(definition[@"shapes"][inputShape]);
+        }
+    }];
+}
+
+- (void)testPerformanceFirstRequestWithLazyDefinition {
+    [self measureFirstRequestWithDefinitionLoader:^NSDictionary *(NSString *definitionString) {
+        return [AWSServiceDefinition definitionWithJSONString:definitionString error:nil];
+    }];
+}
+
+- (void)testPerformanceFirstRequestWithJSONSerializationDefinition {
+    [self measureFirstRequestWithDefinitionLoader:^NSDictionary *(NSString *definitionString) {
+        return [NSJSONSerialization JSONObjectWithData:[definitionString dataUsingEncoding:NSUTF8StringEncoding]
+                                               options:kNilOptions
+                                                 error:nil];
+    }];
+}
+
 @end
@@ -15,6 +15,7 @@
 
 #import <Foundation/Foundation.h>
 #import <AWSCore/AWSService.h>
+#import <AWSCore/AWSTransferScheduler.h>
 
 /**
  `AWSAbstractKinesisRecorder` is an abstract class. You should not instantiate this class directly. Instead use its concrete subclasses `AWSKinesisRecorder` and `AWSFirehoseRecorder`.
@@ -47,6 +48,11 @@
  */
 @property (nonatomic, assign) NSUInteger batchRecordsByteLimit;
 
+/**
+ The recorder's client of the shared `AWSTransferScheduler`. Set its `priority` and `policy`, e.g. `AWSTransferSchedulerPolicyWiFiOnly`, to control when records are submitted. When the policy defers a submission, `submitAllRecords` keeps the records and the recorder submits them as soon as the network allows it.
+ */
+@property (nonatomic, strong, readonly) AWSTransferSchedulerClient *transferSchedulerClient;
+
 /**
  Saves a record to local storage to be sent later. The record will be submitted to the streamName provided with a randomly generated partition key to ensure equal distribution across shards.
 
@@ -75,6 +81,8 @@
 /**
  Submits all locally saved requests to Amazon Kinesis. Requests that are successfully sent will be deleted from the device. Requests that fail due to the device being offline will stop the submission process and be kept. Requests that fail due to other reasons (such as the request being invalid) will be deleted.
 
+ Each batch waits for a grant from the shared `AWSTransferScheduler`. If the policy of `transferSchedulerClient` does not allow submitting on the current network, the task fails with `AWSTransferSchedulerErrorDeferred` and the records are kept.
+
  @return AWSTask - task.result is always nil.
  */
 - (AWSTask *)submitAllRecords;
@@ -52,6 +52,8 @@ NSString *const AWSKinesisAbstractClientRecorderDatabasePathPrefix = @"com/amazo
 @property (nonatomic, strong) id<AWSKinesisRecorderHelper> recorderHelper;
 @property (nonatomic, strong) AWSFMDatabaseQueue *databaseQueue;
 @property (nonatomic, strong) NSString *databasePath;
+@property (nonatomic, strong) AWSTransferSchedulerClient *transferSchedulerClient;
+@property (nonatomic, strong) AWSTask *submitTask;
 
 @end
 
@@ -76,6 +78,14 @@ NSString *const AWSKinesisAbstractClientRecorderDatabasePathPrefix = @"com/amazo
         _diskAgeLimit = AWSKinesisAbstractClientAgeLimitDefault;
         _batchRecordsByteLimit = AWSKinesisAbstractClientBatchRecordByteLimitDefault;
 
+        _transferSchedulerClient = [[AWSTransferScheduler sharedScheduler] registerClientWithName:identifier
+                                                                                        priority:AWSTransferSchedulerPriorityDefault
+                                                                                          policy:AWSTransferSchedulerPolicyAnyNetwork];
+        __weak AWSAbstractKinesisRecorder *weakSelf = self;
+        _transferSchedulerClient.flushWindowHandler = ^{
+            [weakSelf submitAllRecords];
+        };
+
         // Creates a directory for storing databases if it doesn't exist.
         BOOL fileExistsAtPath = [[NSFileManager defaultManager] fileExistsAtPath:databaseDirectoryPath];
         if (!fileExistsAtPath) {
@@ -229,107 +239,130 @@ NSString *const AWSKinesisAbstractClientRecorderDatabasePathPrefix = @"com/amazo
 }
 
 - (AWSTask *)submitAllRecords {
+    // Batches are read, granted and submitted one at a time. Submissions of the same recorder are chained,
+    // because the shared queue is not held while a batch waits for its grant.
+    @synchronized(self) {
+        AWSTask *previousTask = self.submitTask ?: [AWSTask taskWithResult:nil];
+        AWSTask *submitTask = [previousTask continueWithExecutor:[AWSExecutor executorWithDispatchQueue:[AWSKinesisRecorder sharedQueue]] withBlock:^id _Nullable(AWSTask * _Nonnull task) {
+            return [self submitNextBatch];
+        }];
+        self.submitTask = submitTask;
+        return submitTask;
+    }
+}
+
+- (AWSTask *)submitNextBatch {
     AWSFMDatabaseQueue *databaseQueue = self.databaseQueue;
+    __block NSError *error = nil;
+    NSMutableArray *temporaryRecords = [NSMutableArray new];
+    NSMutableArray *partitionKeys = [NSMutableArray new];
+    __block NSUInteger batchDataSize = 0;
+
+    [databaseQueue inDatabase:^(AWSFMDatabase *db) {
+        AWSFMResultSet *rs = [db executeQuery:
+                              @"SELECT partition_key, data, retry_count, stream_name "
+                              @"FROM record "
+                              @"WHERE stream_name = (SELECT stream_name FROM record ORDER BY timestamp ASC LIMIT 1) "
+                              @"ORDER BY timestamp ASC "
+                              @"LIMIT 128"];
+        if (!rs) {
+            AWSDDLogError(@"SQLite error. [%@]", db.lastError);
+            error = db.lastError;
+            return;
+        }
 
-    return [[AWSTask taskWithResult:nil] continueWithExecutor:[AWSExecutor executorWithDispatchQueue:[AWSKinesisRecorder sharedQueue]] withSuccessBlock:^id _Nullable(AWSTask * _Nonnull task) {
-        __block NSError *error = nil;
-        __block NSUInteger batchSize = 0;
-        __block BOOL stop = NO;
+        while ([rs next]) {
+            [temporaryRecords addObject:@{
+                                          @"partition_key": [rs stringForColumn:@"partition_key"],
+                                          @"data": [rs dataForColumn:@"data"],
+                                          @"stream_name": [rs stringForColumn:@"stream_name"],
+                                          }];
 
-        do {
-            [databaseQueue inTransaction:^(AWSFMDatabase *db, BOOL *rollback) {
-                NSMutableArray *partitionKeys = nil;
-
-                AWSFMResultSet *rs = [db executeQuery:
-                                      @"SELECT partition_key, data, retry_count, stream_name "
-                                      @"FROM record "
-                                      @"WHERE stream_name = (SELECT stream_name FROM record ORDER BY timestamp ASC LIMIT 1) "
-                                      @"ORDER BY timestamp ASC "
-                                      @"LIMIT 128"];
-                if (!rs) {
-                    AWSDDLogError(@"SQLite error. Rolling back... [%@]", db.lastError);
-                    error = db.lastError;
-                    *rollback = YES;
-                    return;
-                }
+            [partitionKeys addObject:[rs stringForColumn:@"partition_key"]];
+            batchDataSize += [[rs dataForColumn:@"data"] length];
 
-                NSUInteger batchDataSize = 0;
-                NSMutableArray *temporaryRecords = [NSMutableArray new];
-                partitionKeys = [NSMutableArray new];
-                while ([rs next]) {
-                    [temporaryRecords addObject:@{
-                                                  @"partition_key": [rs stringForColumn:@"partition_key"],
-                                                  @"data": [rs dataForColumn:@"data"],
-                                                  @"stream_name": [rs stringForColumn:@"stream_name"],
-                                                  }];
+            if (batchDataSize > self.batchRecordsByteLimit) { // if the batch size exceeds `batchRecordsByteLimit`, stop there.
+                break;
+            }
+        }
+        [rs close];
+    }];
 
-                    [partitionKeys addObject:[rs stringForColumn:@"partition_key"]];
-                    batchDataSize += [[rs dataForColumn:@"data"] length];
+    if (error) {
+        return [AWSTask taskWithError:error];
+    }
+    if ([temporaryRecords count] == 0) {
+        return nil;
+    }
 
-                    if (batchDataSize > self.batchRecordsByteLimit) { // if the batch size exceeds `batchRecordsByteLimit`, stop there.
-                        break;
-                    }
-                }
-                rs = nil;
-                batchSize = [temporaryRecords count];
+    // Wait for the grant without holding the database or the shared queue; on a weak link it may take
+    // until another client's transfer finishes.
+    AWSTask<AWSTransferSchedulerGrant *> *grantTask = [[AWSTransferScheduler sharedScheduler] requestGrantForClient:self.transferSchedulerClient
+                                                                                                            bytes:batchDataSize];
+    return [grantTask continueWithExecutor:[AWSExecutor executorWithDispatchQueue:[AWSKinesisRecorder sharedQueue]] withBlock:^id _Nullable(AWSTask<AWSTransferSchedulerGrant *> * _Nonnull grantTask) {
+        if (grantTask.error) {
+            return [AWSTask taskWithError:grantTask.error];
+        }
 
-                if (batchSize > 0) {
-                    __block NSMutableArray *putPartitionKeys = [NSMutableArray new];
-                    __block NSMutableArray *retryPartitionKeys = [NSMutableArray new];
+        __block BOOL stop = NO;
+        [databaseQueue inTransaction:^(AWSFMDatabase *db, BOOL *rollback) {
+            __block NSMutableArray *putPartitionKeys = [NSMutableArray new];
+            __block NSMutableArray *retryPartitionKeys = [NSMutableArray new];
 
-                    NSString *streamName = temporaryRecords[0][@"stream_name"];
+            NSString *streamName = temporaryRecords[0][@"stream_name"];
 
-                    AWSTask *submitTask = \
-                        [self.recorderHelper submitRecordsForStream:streamName
-                                                            records:temporaryRecords
-                                                      partitionKeys:partitionKeys
-                                                   putPartitionKeys:putPartitionKeys
-                                                 retryPartitionKeys:retryPartitionKeys
-                                                               stop:&stop];
+            AWSTask *submitTask = [self.recorderHelper submitRecordsForStream:streamName
+                                                                      records:temporaryRecords
+                                                                partitionKeys:partitionKeys
+                                                             putPartitionKeys:putPartitionKeys
+                                                           retryPartitionKeys:retryPartitionKeys
+                                                                         stop:&stop];
 
-                    [submitTask waitUntilFinished];
+            [submitTask waitUntilFinished];
+            [grantTask.result finish];
 
-                    if (submitTask.error) {
-                        error = submitTask.error;
-                    }
-
-                    for (NSString *partitionKey in putPartitionKeys) {
-                        BOOL result = [db executeUpdate:@"DELETE FROM record WHERE partition_key = :partition_key"
-                                withParameterDictionary:@{
-                                                          @"partition_key" : partitionKey
-                                                          }];
-                        if (!result) {
-                            AWSDDLogError(@"SQLite error. [%@]", db.lastError);
-                            error = db.lastError;
-                        }
-                    }
+            if (submitTask.error) {
+                error = submitTask.error;
+            }
 
-                    for (NSString *partitionKey in retryPartitionKeys) {
-                        BOOL result = [db executeUpdate:@"UPDATE record SET retry_count = retry_count + 1 WHERE partition_key = :partition_key"
-                                withParameterDictionary:@{
-                                                          @"partition_key" : partitionKey
-                                                          }];
-                        if (!result) {
-                            AWSDDLogError(@"SQLite error. [%@]", db.lastError);
-                            error = db.lastError;
-                        }
-                    }
+            for (NSString *partitionKey in putPartitionKeys) {
+                BOOL result = [db executeUpdate:@"DELETE FROM record WHERE partition_key = :partition_key"
+                        withParameterDictionary:@{
+                                                  @"partition_key" : partitionKey
+                                                  }];
+                if (!result) {
+                    AWSDDLogError(@"SQLite error. [%@]", db.lastError);
+                    error = db.lastError;
                 }
+            }
 
-                // If a record failed three times, give up and delete the record.
-                BOOL result = [db executeUpdate:@"DELETE FROM record WHERE retry_count > 3"];
+            for (NSString *partitionKey in retryPartitionKeys) {
+                BOOL result = [db executeUpdate:@"UPDATE record SET retry_count = retry_count + 1 WHERE partition_key = :partition_key"
+                        withParameterDictionary:@{
+                                                  @"partition_key" : partitionKey
+                                                  }];
                 if (!result) {
                     AWSDDLogError(@"SQLite error. [%@]", db.lastError);
                     error = db.lastError;
                 }
-            }];
-        } while (!stop && !error && batchSize > 0);
+            }
+
+            // If a record failed three times, give up and delete the record.
+            BOOL result = [db executeUpdate:@"DELETE FROM record WHERE retry_count > 3"];
+            if (!result) {
+                AWSDDLogError(@"SQLite error. [%@]", db.lastError);
+                error = db.lastError;
+            }
+        }];
 
         if (error) {
             return [AWSTask taskWithError:error];
         }
+        if (stop) {
+            return nil;
+        }
 
-        return nil;
+        return [self submitNextBatch];
     }];
 }
 
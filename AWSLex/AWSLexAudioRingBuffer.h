@@ -0,0 +1,96 @@
+//
+// Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ A fixed-size buffer between the encoded audio produced by the audio source and
+ the output stream that feeds the request body.
+
+ Frames are appended whole and written to the output stream as space becomes
+ available, so memory use stays constant however long the recording runs. A
+ frame that doesn't fit in the free space is dropped whole rather than cut, so
+ the encoded stream stays decodable. All methods are thread safe.
+ */
+@interface AWSLexAudioRingBuffer : NSObject
+
+/**
+ The number of bytes the buffer can hold.
+ */
+@property (nonatomic, readonly) NSUInteger capacity;
+
+/**
+ The number of bytes buffered and not yet written to the output stream.
+ */
+@property (nonatomic, readonly) NSUInteger length;
+
+/**
+ The total number of bytes accepted into the buffer.
+ */
+@property (nonatomic, readonly) uint64_t bytesAppended;
+
+/**
+ The total number of bytes written to the output stream.
+ */
+@property (nonatomic, readonly) uint64_t bytesSent;
+
+/**
+ The total number of bytes dropped because the buffer was full.
+ */
+@property (nonatomic, readonly) uint64_t bytesDropped;
+
+/**
+ The number of frames dropped because the buffer was full.
+ */
+@property (nonatomic, readonly) NSUInteger framesDropped;
+
+/**
+ The number of times data was pending but the output stream had no space for it.
+ */
+@property (nonatomic, readonly) NSUInteger backPressureCount;
+
+/**
+ Initializes the buffer.
+
+ @param capacity     The number of bytes the buffer can hold.
+ @param outputStream The stream the buffered audio is written to. It must be opened by the caller.
+ */
+- (instancetype)initWithCapacity:(NSUInteger)capacity
+                    outputStream:(NSOutputStream *)outputStream NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ Appends a frame of audio. Call `drain` afterwards to write it to the output stream.
+
+ @param data The encoded frame.
+
+ @return `YES` if the frame was buffered, `NO` if it was dropped because the buffer was full.
+ */
+- (BOOL)appendData:(NSData *)data;
+
+/**
+ Writes as much of the buffer as the output stream accepts without blocking. Call
+ it after appending, and when the stream signals `NSStreamEventHasSpaceAvailable`.
+
+ @return The number of bytes written, or -1 if writing to the stream failed.
+ */
+- (NSInteger)drain;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,117 @@
+//
+// Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+
+#import "AWSLexAudioRingBuffer.h"
+#import <AWSCore/AWSCore.h>
+
+@implementation AWSLexAudioRingBuffer {
+    NSOutputStream *_outputStream;
+    uint8_t *_bytes;
+    // Offset of the oldest unsent byte.
+    NSUInteger _head;
+}
+
+@synthesize length = _length;
+
+- (instancetype)init {
+    @throw [NSException exceptionWithName:NSInternalInconsistencyException
+                                   reason:@"`- init` is not a valid initializer. Use `- initWithCapacity:outputStream:` instead."
+                                 userInfo:nil];
+    return nil;
+}
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity
+                    outputStream:(NSOutputStream *)outputStream {
+    if (self = [super init]) {
+        _capacity = MAX(capacity, 1);
+        _outputStream = outputStream;
+        _bytes = malloc(_capacity);
+        if (!_bytes) {
+            return nil;
+        }
+    }
+    return self;
+}
+
+- (void)dealloc {
+    free(_bytes);
+}
+
+- (NSUInteger)length {
+    @synchronized (self) {
+        return _length;
+    }
+}
+
+- (BOOL)appendData:(NSData *)data {
+    @synchronized (self) {
+        NSUInteger frameLength = data.length;
+        if (frameLength > _capacity - _length) {
+            // Make room if the stream can take some of what is buffered.
+            [self drainLocked];
+        }
+        if (frameLength > _capacity - _length) {
+            _bytesDropped += frameLength;
+            _framesDropped++;
+            AWSDDLogVerbose(@"Audio buffer full, dropped a frame of %lu bytes", (unsigned long)frameLength);
+            return NO;
+        }
+
+        // Copy in at most two pieces: up to the end of the storage, then from the start.
+        NSUInteger tail = (_head + _length) % _capacity;
+        NSUInteger firstLength = MIN(frameLength, _capacity - tail);
+        [data getBytes:_bytes + tail range:NSMakeRange(0, firstLength)];
+        if (firstLength < frameLength) {
+            [data getBytes:_bytes range:NSMakeRange(firstLength, frameLength - firstLength)];
+        }
+        _length += frameLength;
+        _bytesAppended += frameLength;
+        return YES;
+    }
+}
+
+- (NSInteger)drain {
+    @synchronized (self) {
+        return [self drainLocked];
+    }
+}
+
+- (NSInteger)drainLocked {
+    NSInteger written = 0;
+    while (_length > 0) {
+        if (![_outputStream hasSpaceAvailable]) {
+            _backPressureCount++;
+            break;
+        }
+        NSUInteger contiguousLength = MIN(_length, _capacity - _head);
+        NSInteger result = [_outputStream write:_bytes + _head maxLength:contiguousLength];
+        if (result < 0) {
+            return -1;
+        }
+        if (result == 0) {
+            break;
+        }
+        _head = (_head + result) % _capacity;
+        _length -= result;
+        _bytesSent += result;
+        written += result;
+    }
+    if (_length == 0) {
+        _head = 0;
+    }
+    return written;
+}
+
+@end
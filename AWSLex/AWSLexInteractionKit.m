@@ -19,6 +19,7 @@
 #import "BFAudioRecorder.h"
 #import "AWSLex.h"
 #import "AWSLexRequestRetryHandler.h"
+#import "AWSLexAudioRingBuffer.h"
 #import <AVFoundation/AVFoundation.h>
 
 NSString *const AWSInfoInteractionKit = @"LexInteractionKit";
@@ -47,6 +48,12 @@ const NSUInteger DefaultInteractionKitStartingPointThreshold = 9;
 const NSUInteger DefaultInteractionKitEndpointThreshold = 80;
 const float      DefaultInteractionKitLrtThreshold = 1.8f;
 
+// Encoded audio waiting for the request to read it. Two seconds of 16 kHz LPCM.
+static const NSUInteger AWSLexInteractionKitAudioBufferCapacity = 64 * 1024;
+// Audio kept for retries and the recording end callback. Beyond this the
+// request can't be replayed.
+static const NSUInteger AWSLexInteractionKitMaxRetainedAudioLength = 1024 * 1024;
+
 typedef NS_ENUM(NSInteger, AWSLexSpeechState) {
     AWSLexSpeechStateUninitialized,
     AWSLexSpeechStateStarted,
@@ -232,7 +239,6 @@ const NSUInteger MaxSpeechTimeoutInterval = 15;
 
 @implementation AWSLexInteractionKit{
     AWSLexAudioPlayer *audioPlayer;
-    NSUInteger numOfBytesSent;
     BOOL isStreaming;
     NSDate *recordingStartDate;
     AWSLexSpeechState speechState;
@@ -243,8 +249,11 @@ const NSUInteger MaxSpeechTimeoutInterval = 15;
     // the processed audio to be sent over http
     NSMutableData *consumerAudioBuffer;
     NSInputStream *consumerStream;
-    //the processed audio buffer
+    //the processed audio, kept up to AWSLexInteractionKitMaxRetainedAudioLength for retries
     NSMutableData *producerAudioBuffer;
+    BOOL isProducerAudioTruncated;
+    //the processed audio waiting to be written to the producer stream
+    AWSLexAudioRingBuffer *producerRingBuffer;
     NSOutputStream *producerStream;
     
     dispatch_queue_t interactionDelegateQueue;
@@ -615,6 +624,9 @@ static AWSSynchronizedMutableDictionary *_serviceClients = nil;
         producerStream = pStream;
         
         producerAudioBuffer = [NSMutableData new];
+        isProducerAudioTruncated = NO;
+        producerRingBuffer = [[AWSLexAudioRingBuffer alloc] initWithCapacity:AWSLexInteractionKitAudioBufferCapacity
+                                                               outputStream:producerStream];
         consumerAudioBuffer = [NSMutableData new];
         
         producerStream.delegate = self;
@@ -624,8 +636,6 @@ static AWSSynchronizedMutableDictionary *_serviceClients = nil;
                                   forMode:NSDefaultRunLoopMode];
         [producerStream open];
         
-        numOfBytesSent = 0;
-        
         [audioSource start];
         
         AWSDDLogVerbose(@"Started Listening to Audio Source");
@@ -636,6 +646,14 @@ static AWSSynchronizedMutableDictionary *_serviceClients = nil;
     if (isListening) {
         AWSDDLogVerbose(@"Stop Listening",nil);
         isListening = NO;
+        // hand over what the stream can still take before closing it.
+        [producerRingBuffer drain];
+        AWSDDLogVerbose(@"sent %llu bytes of audio, %lu left unsent, %llu dropped in %lu frames, back pressured %lu times",
+                        producerRingBuffer.bytesSent,
+                        (unsigned long)producerRingBuffer.length,
+                        producerRingBuffer.bytesDropped,
+                        (unsigned long)producerRingBuffer.framesDropped,
+                        (unsigned long)producerRingBuffer.backPressureCount);
         [producerStream close];
         producerStream.delegate = nil;
         
@@ -644,24 +662,33 @@ static AWSSynchronizedMutableDictionary *_serviceClients = nil;
 }
 
 - (void)streamAudio:(NSData *)audio{
-    [producerAudioBuffer appendBytes:audio.bytes length:audio.length];
-    if(producerAudioBuffer.length > numOfBytesSent && [producerStream hasSpaceAvailable]) {
-        NSRange range = NSMakeRange(numOfBytesSent, producerAudioBuffer.length - numOfBytesSent);
-        UInt8 chunkBuffer[range.length];
-        [producerAudioBuffer getBytes:chunkBuffer range:range];
-        NSInteger result = [producerStream write:chunkBuffer maxLength:range.length];
-        AWSDDLogVerbose(@"wrote %ld to producer stream", (long)result);
-        if (result >= 0) {
-            numOfBytesSent += result;
-            //start streaming only after we get an actual audio
-            [self startStreaming];
-        }else{
-            NSError *audioError = [NSError errorWithDomain:AWSLexInteractionKitErrorDomain code:AWSLexInteractionKitErrorCodeAudioStreaming userInfo:nil];
-            [self handleError:audioError];
-        }
+    [self retainAudio:audio];
+    [producerRingBuffer appendData:audio];
+    
+    //whatever the stream can't take now is written on NSStreamEventHasSpaceAvailable.
+    NSInteger result = [producerRingBuffer drain];
+    AWSDDLogVerbose(@"wrote %ld to producer stream", (long)result);
+    if (result >= 0) {
+        //start streaming only after we get an actual audio
+        [self startStreaming];
+    }else{
+        NSError *audioError = [NSError errorWithDomain:AWSLexInteractionKitErrorDomain code:AWSLexInteractionKitErrorCodeAudioStreaming userInfo:nil];
+        [self handleError:audioError];
     }
 }
 
+- (void)retainAudio:(NSData *)audio{
+    if (isProducerAudioTruncated) {
+        return;
+    }
+    if (producerAudioBuffer.length + audio.length > AWSLexInteractionKitMaxRetainedAudioLength) {
+        AWSDDLogVerbose(@"retained %lu bytes of audio, the request can no longer be retried", (unsigned long)producerAudioBuffer.length);
+        isProducerAudioTruncated = YES;
+        return;
+    }
+    [producerAudioBuffer appendData:audio];
+}
+
 - (void)startStreaming{
     if(!isStreaming) {
         isStreaming = YES;
@@ -694,6 +721,13 @@ static AWSSynchronizedMutableDictionary *_serviceClients = nil;
     AWSDDLogVerbose(@"stream event %lu", (unsigned long)eventCode);
     switch (eventCode)
     {
+        case NSStreamEventHasSpaceAvailable:{
+            if (aStream == producerStream && [producerRingBuffer drain] < 0) {
+                NSError *streamError = [NSError errorWithDomain:AWSLexInteractionKitErrorDomain code:AWSLexInteractionKitErrorCodeAudioStreaming userInfo:nil];
+                [self handleError:streamError];
+            }
+            break;
+        }
         case NSStreamEventErrorOccurred:{
             NSError *streamError = [NSError errorWithDomain:AWSLexInteractionKitErrorDomain code:AWSLexInteractionKitErrorCodeAudioStreaming userInfo:nil];
             [self handleError:streamError];
@@ -947,6 +981,11 @@ static AWSSynchronizedMutableDictionary *_serviceClients = nil;
 
 #pragma mark - Retry Handler
 
+- (BOOL)canResetInputStream{
+    //the audio can only be replayed if all of it was retained.
+    return self.currentState != AWSLexInteractionModeSpeech || !isProducerAudioTruncated;
+}
+
 - (NSInputStream *)resetInputStream{
     //iOS doesn't allow seeking for non file based streams.
     //So resetting the consumer stream to a new input stream.
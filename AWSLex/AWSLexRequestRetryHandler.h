@@ -20,6 +20,13 @@
 
 - (NSInputStream *)resetInputStream;
 
+@optional
+
+/**
+ Returns `NO` if the input stream can't be replayed, in which case the request isn't retried.
+ */
+- (BOOL)canResetInputStream;
+
 @end
 
 @interface AWSLexRequestRetryHandler : AWSURLRequestRetryHandler
@@ -0,0 +1,241 @@
+//
+// Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+
+#import <XCTest/XCTest.h>
+#import "AWSLexAudioRingBuffer.h"
+#import "AWSLexRequestRetryHandler.h"
+
+// 20 ms of 16 kHz, 16-bit mono LPCM.
+static NSUInteger const AWSLexAudioRingBufferTestsPCMFrameLength = 640;
+
+@interface AWSLexAudioRingBufferTestsRetryDelegate : NSObject <AWSLexRequestRetryHandlerDelegate>
+
+@property (nonatomic, assign) BOOL canReset;
+
+@end
+
+@implementation AWSLexAudioRingBufferTestsRetryDelegate
+
+- (NSInputStream *)resetInputStream {
+    return [NSInputStream inputStreamWithData:[NSData data]];
+}
+
+- (BOOL)canResetInputStream {
+    return self.canReset;
+}
+
+@end
+
+@interface AWSLexAudioRingBufferTests : XCTestCase
+
+@property (nonatomic, strong) NSInputStream *consumerStream;
+@property (nonatomic, strong) NSOutputStream *producerStream;
+
+@end
+
+@implementation AWSLexAudioRingBufferTests
+
+- (void)setUp {
+    [super setUp];
+    NSInputStream *consumerStream;
+    NSOutputStream *producerStream;
+    [NSStream getBoundStreamsWithBufferSize:4096 inputStream:&consumerStream outputStream:&producerStream];
+    self.consumerStream = consumerStream;
+    self.producerStream = producerStream;
+    [self.consumerStream open];
+    [self.producerStream open];
+}
+
+- (void)tearDown {
+    [self.producerStream close];
+    [self.consumerStream close];
+    [super tearDown];
+}
+
+// A sine tone, sample index continues across frames.
++ (NSData *)PCMFrameAtIndex:(NSUInteger)index {
+    NSUInteger sampleCount = AWSLexAudioRingBufferTestsPCMFrameLength / sizeof(int16_t);
+    int16_t samples[sampleCount];
+    for (NSUInteger i = 0; i < sampleCount; i++) {
+        double t = (index * sampleCount + i) / 16000.0;
+        samples[i] = (int16_t)(sin(2 * M_PI * 440 * t) * 12000);
+    }
+    return [NSData dataWithBytes:samples length:sizeof(samples)];
+}
+
+// Variable length packets with a length prefix, the way encoded Opus frames arrive.
++ (NSData *)opusFrameAtIndex:(NSUInteger)index {
+    uint16_t packetLength = 20 + (index * 37) % 100;
+    NSMutableData *frame = [NSMutableData dataWithBytes:&packetLength length:sizeof(packetLength)];
+    for (uint16_t i = 0; i < packetLength; i++) {
+        uint8_t byte = (uint8_t)(index + i);
+        [frame appendBytes:&byte length:1];
+    }
+    return frame;
+}
+
+- (NSData *)readAvailable {
+    NSMutableData *data = [NSMutableData data];
+    uint8_t buffer[1024];
+    while ([self.consumerStream hasBytesAvailable]) {
+        NSInteger read = [self.consumerStream read:buffer maxLength:sizeof(buffer)];
+        if (read <= 0) {
+            break;
+        }
+        [data appendBytes:buffer length:read];
+    }
+    return data;
+}
+
+- (void)testFramesArriveInOrder {
+    AWSLexAudioRingBuffer *ringBuffer = [[AWSLexAudioRingBuffer alloc] initWithCapacity:16 * 1024 outputStream:self.producerStream];
+    NSMutableData *expected = [NSMutableData data];
+    NSMutableData *received = [NSMutableData data];
+
+    for (NSUInteger i = 0; i < 2000; i++) {
+        NSData *frame = i % 2 == 0 ? [AWSLexAudioRingBufferTests PCMFrameAtIndex:i] : [AWSLexAudioRingBufferTests opusFrameAtIndex:i];
+        XCTAssertTrue([ringBuffer appendData:frame]);
+        [expected appendData:frame];
+        XCTAssertGreaterThanOrEqual([ringBuffer drain], 0);
+        // The consumer keeps up most of the time, and falls behind every so often.
+        if (i % 7 != 0) {
+            [received appendData:[self readAvailable]];
+        }
+    }
+    while (ringBuffer.length > 0) {
+        [received appendData:[self readAvailable]];
+        XCTAssertGreaterThanOrEqual([ringBuffer drain], 0);
+    }
+    [received appendData:[self readAvailable]];
+
+    XCTAssertEqualObjects(received, expected);
+    XCTAssertEqual(ringBuffer.bytesAppended, expected.length);
+    XCTAssertEqual(ringBuffer.bytesSent, expected.length);
+    XCTAssertEqual(ringBuffer.bytesDropped, 0);
+    XCTAssertEqual(ringBuffer.framesDropped, 0);
+}
+
+- (void)testDropsWholeFramesWhenConsumerStalls {
+    NSUInteger capacity = 4 * AWSLexAudioRingBufferTestsPCMFrameLength;
+    AWSLexAudioRingBuffer *ringBuffer = [[AWSLexAudioRingBuffer alloc] initWithCapacity:capacity outputStream:self.producerStream];
+    NSMutableData *accepted = [NSMutableData data];
+
+    // Nobody reads, so the stream fills up and the buffer behind it fills up.
+    NSUInteger frameCount = 50;
+    for (NSUInteger i = 0; i < frameCount; i++) {
+        NSData *frame = [AWSLexAudioRingBufferTests PCMFrameAtIndex:i];
+        if ([ringBuffer appendData:frame]) {
+            [accepted appendData:frame];
+        }
+        XCTAssertGreaterThanOrEqual([ringBuffer drain], 0);
+        XCTAssertLessThanOrEqual(ringBuffer.length, capacity);
+    }
+
+    XCTAssertGreaterThan(ringBuffer.framesDropped, 0);
+    XCTAssertGreaterThan(ringBuffer.backPressureCount, 0);
+    XCTAssertEqual(ringBuffer.bytesDropped, ringBuffer.framesDropped * AWSLexAudioRingBufferTestsPCMFrameLength);
+    XCTAssertEqual(ringBuffer.bytesAppended + ringBuffer.bytesDropped, frameCount * AWSLexAudioRingBufferTestsPCMFrameLength);
+    XCTAssertEqual(ringBuffer.bytesAppended, ringBuffer.bytesSent + ringBuffer.length);
+
+    // Once the consumer catches up, everything that was accepted arrives intact.
+    NSMutableData *received = [NSMutableData data];
+    while (ringBuffer.length > 0) {
+        [received appendData:[self readAvailable]];
+        XCTAssertGreaterThanOrEqual([ringBuffer drain], 0);
+    }
+    [received appendData:[self readAvailable]];
+    XCTAssertEqualObjects(received, accepted);
+}
+
+- (void)testOversizedFrameIsDropped {
+    AWSLexAudioRingBuffer *ringBuffer = [[AWSLexAudioRingBuffer alloc] initWithCapacity:100 outputStream:self.producerStream];
+    XCTAssertFalse([ringBuffer appendData:[AWSLexAudioRingBufferTests PCMFrameAtIndex:0]]);
+    XCTAssertEqual(ringBuffer.length, 0);
+    XCTAssertEqual(ringBuffer.bytesDropped, AWSLexAudioRingBufferTestsPCMFrameLength);
+    XCTAssertEqual(ringBuffer.framesDropped, 1);
+}
+
+- (void)testDrainFromAnotherThread {
+    AWSLexAudioRingBuffer *ringBuffer = [[AWSLexAudioRingBuffer alloc] initWithCapacity:8 * 1024 outputStream:self.producerStream];
+    NSMutableData *expected = [NSMutableData data];
+    NSUInteger frameCount = 3000;
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"consumer finished"];
+    __block NSMutableData *received = [NSMutableData data];
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        uint8_t buffer[1024];
+        while (received.length < frameCount * AWSLexAudioRingBufferTestsPCMFrameLength) {
+            if ([self.consumerStream hasBytesAvailable]) {
+                NSInteger read = [self.consumerStream read:buffer maxLength:sizeof(buffer)];
+                if (read < 0) {
+                    break;
+                }
+                [received appendBytes:buffer length:read];
+            }
+            // Plays the part of NSStreamEventHasSpaceAvailable.
+            [ringBuffer drain];
+        }
+        [expectation fulfill];
+    });
+
+    for (NSUInteger i = 0; i < frameCount; i++) {
+        NSData *frame = [AWSLexAudioRingBufferTests PCMFrameAtIndex:i];
+        while (![ringBuffer appendData:frame]) {
+            // The test wants every frame, so wait for space instead of moving on.
+            [NSThread sleepForTimeInterval:0.001];
+        }
+        [expected appendData:frame];
+        [ringBuffer drain];
+    }
+
+    [self waitForExpectationsWithTimeout:30 handler:nil];
+    XCTAssertEqualObjects(received, expected);
+}
+
+- (void)testRetryHandlerDoesNotRetryTruncatedAudio {
+    AWSLexRequestRetryHandler *retryHandler = [[AWSLexRequestRetryHandler alloc] initWithMaximumRetryCount:3];
+    AWSLexAudioRingBufferTestsRetryDelegate *delegate = [AWSLexAudioRingBufferTestsRetryDelegate new];
+    retryHandler.delegate = delegate;
+    NSHTTPURLResponse *response = [[NSHTTPURLResponse alloc] initWithURL:[NSURL URLWithString:@"https://runtime.lex.us-east-1.amazonaws.com/bot/b/alias/a/user/u/content"]
+                                                              statusCode:500
+                                                             HTTPVersion:@"HTTP/1.1"
+                                                            headerFields:nil];
+
+    delegate.canReset = YES;
+    XCTAssertEqual([retryHandler shouldRetry:0 originalRequest:nil response:response data:nil error:nil], AWSNetworkingRetryTypeResetStreamAndRetry);
+    delegate.canReset = NO;
+    XCTAssertEqual([retryHandler shouldRetry:0 originalRequest:nil response:response data:nil error:nil], AWSNetworkingRetryTypeShouldNotRetry);
+}
+
+#pragma mark - Benchmarks
+
+- (void)testPerformanceStreamLongSession {
+    // Ten minutes of 20 ms frames through a consumer that keeps up.
+    NSUInteger frameCount = 30000;
+    NSData *frame = [AWSLexAudioRingBufferTests PCMFrameAtIndex:0];
+    [self measureBlock:^{
+        AWSLexAudioRingBuffer *ringBuffer = [[AWSLexAudioRingBuffer alloc] initWithCapacity:64 * 1024 outputStream:self.producerStream];
+        uint8_t buffer[4096];
+        for (NSUInteger i = 0; i < frameCount; i++) {
+            [ringBuffer appendData:frame];
+            [ringBuffer drain];
+            while ([self.consumerStream hasBytesAvailable] && [self.consumerStream read:buffer maxLength:sizeof(buffer)] > 0) {
+            }
+        }
+        XCTAssertEqual(ringBuffer.framesDropped, 0);
+    }];
+}
+
+@end
@@ -14,23 +14,10 @@
 //
 
 #import "AWSMobileAnalyticsDateUtils.h"
-
-#define kISODateTimeFormat @"yyyy-MM-dd'T'HH:mm:ss.SSS'Z'"
-#define kDateTimeFormat @"yyyyMMdd'T'HHmmss'Z'"
-#define kDateStampFormat @"yyyyMMdd"
+#import "AWSCategory.h"
 
 @implementation AWSMobileAnalyticsDateUtils
 
-+(NSLocale *)isoTimestampLocale
-{
-    static NSLocale *_tsLoc = nil;
-    
-    if (nil == _tsLoc) {
-        _tsLoc = [[NSLocale alloc] initWithLocaleIdentifier:@"en_US"];
-    }
-    return _tsLoc;
-}
-
 + (NSString *)isoDateTimeWithTimestamp:(UTCTimeMillis) theTimeStamp
 {
     return [AWSMobileAnalyticsDateUtils isoDateTime:[NSDate dateWithTimeIntervalSince1970:((NSTimeInterval)theTimeStamp)/1000]];
@@ -38,15 +25,7 @@
 
 + (NSString *)isoDateTime:(NSDate *)theDate
 {
-    NSDateFormatter *dateFormatter = [[NSDateFormatter alloc] init];
-    
-    [dateFormatter setTimeZone:[NSTimeZone timeZoneWithName:@"GMT"]];
-    [dateFormatter setDateFormat:kISODateTimeFormat];
-    [dateFormatter setLocale:[AWSMobileAnalyticsDateUtils isoTimestampLocale]];
-    
-    NSString *formatted = [dateFormatter stringFromDate:theDate];
-    
-    return formatted;
+    return [theDate aws_stringValue:AWSDateISO8601DateFormat3];
 }
 
 + (UTCTimeMillis)utcTimeMillisNow
@@ -64,40 +43,14 @@
     return [NSDate dateWithTimeIntervalSince1970:(utcMillis/1000.0)];
 }
 
-+(NSLocale *)timestampLocale
-{
-    static NSLocale *_tsLoc = nil;
-    
-    if (nil == _tsLoc) {
-        _tsLoc = [[NSLocale alloc] initWithLocaleIdentifier:@"en_US"];
-    }
-    return _tsLoc;
-}
-
 + (NSString *)iso8061FormatDateStamp:(NSDate *)theDate
 {
-    NSDateFormatter *dateFormatter = [[NSDateFormatter alloc] init];
-    
-    [dateFormatter setTimeZone:[NSTimeZone timeZoneWithName:@"GMT"]];
-    [dateFormatter setDateFormat:kDateStampFormat];
-    [dateFormatter setLocale:[AWSMobileAnalyticsDateUtils timestampLocale]];
-    
-    NSString *formatted = [dateFormatter stringFromDate:theDate];
-    
-    return formatted;
+    return [theDate aws_stringValue:AWSDateShortDateFormat1];
 }
 
 + (NSString *)iso8061FormatDateTime:(NSDate *)theDate
 {
-    NSDateFormatter *dateFormatter = [[NSDateFormatter alloc] init];
-    
-    [dateFormatter setTimeZone:[NSTimeZone timeZoneWithName:@"GMT"]];
-    [dateFormatter setDateFormat:kDateTimeFormat];
-    [dateFormatter setLocale:[AWSMobileAnalyticsDateUtils timestampLocale]];
-    
-    NSString *formatted = [dateFormatter stringFromDate:theDate];
-    
-    return formatted;
+    return [theDate aws_stringValue:AWSDateISO8601DateFormat2];
 }
 
 @end
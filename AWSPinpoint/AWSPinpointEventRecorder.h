@@ -15,6 +15,7 @@
 
 #import <Foundation/Foundation.h>
 #import <AWSCore/AWSService.h>
+#import <AWSCore/AWSTransferScheduler.h>
 
 @class AWSPinpointEvent,AWSPinpointContext,AWSPinpointTargetingClient;
 
@@ -70,6 +71,11 @@ FOUNDATION_EXPORT NSString *const AWSPinpointEventByteThresholdReachedNotificati
  */
 @property (nonatomic, assign) NSUInteger batchRecordsByteLimit;
 
+/**
+ The recorder's client of the shared `AWSTransferScheduler`. Set its `priority` and `policy`, e.g. `AWSTransferSchedulerPolicyWiFiOnly`, to control when events are submitted. When the policy defers a submission, the events are kept and submitted as soon as the network allows it.
+ */
+@property (nonatomic, strong, readonly) AWSTransferSchedulerClient *transferSchedulerClient;
+
 /**
  Saves an event to local storage to be sent later.
  
@@ -108,7 +114,7 @@ FOUNDATION_EXPORT NSString *const AWSPinpointEventByteThresholdReachedNotificati
 - (AWSTask<NSArray<AWSPinpointEvent *> *> *) getDirtyEventsWithLimit:(NSNumber *) limit;
 
 /**
- Submits all locally saved events to Amazon Pinpoint. Events that are successfully sent will be deleted from the device. Events that fail due to the device being offline will stop the submission process and be kept. Events that fail due to other reasons (such as the event being invalid) will be marked dirty and moved to a dirty table.
+ Submits all locally saved events to Amazon Pinpoint. Events that are successfully sent will be deleted from the device. Events that fail due to the device being offline will stop the submission process and be kept. Events that fail due to other reasons (such as the event being invalid) will be marked dirty and moved to a dirty table. Each batch waits for a grant from the shared `AWSTransferScheduler`; if `transferSchedulerClient`'s policy does not allow the current network, the events are kept and the task fails with `AWSTransferSchedulerErrorDeferred`.
  
  @return AWSTask - task.result contains an array of AWSPinpointEvent objects that were submitted.
  */
@@ -23,6 +23,7 @@
 #import "AWSPinpointSessionClient.h"
 #import "AWSPinpointDateUtils.h"
 #import "AWSPinpointConfiguration.h"
+#import "AWSPinpointStateStore.h"
 
 // Pinpoint Abstract Client
 NSUInteger const AWSPinpointClientByteLimitDefault = 5 * 1024 * 1024; // 5MB
@@ -44,6 +45,7 @@ NSString *const DEFAULT_SESSION_ID = @"00000000-00000000";
 @property (nonatomic, strong) AWSPinpointContext *context;
 @property (nonatomic, strong) AWSPinpointEndpointProfile *profile;
 @property (nonatomic, strong) NSObject *lock;
+@property (nonatomic, strong) AWSTransferSchedulerClient *transferSchedulerClient;
 
 @end
 
@@ -52,6 +54,7 @@ NSString *const DEFAULT_SESSION_ID = @"00000000-00000000";
                     withStartTime:(NSDate *)startTime
                      withStopTime:(NSDate *)stopTime;
 - (UTCTimeMillis) timeDurationInMillis;
++ (instancetype)sessionWithStateData:(NSData *)stateData;
 @end
 
 @interface AWSPinpointEvent()
@@ -63,10 +66,6 @@ NSString *const DEFAULT_SESSION_ID = @"00000000-00000000";
                          metrics:(NSMutableDictionary*) metrics;
 @end
 
-@interface AWSPinpointConfiguration()
-@property (nonnull, strong) NSUserDefaults *userDefaults;
-@end
-
 @implementation AWSPinpointEventRecorder
 
 - (instancetype)init {
@@ -87,6 +86,14 @@ NSString *const DEFAULT_SESSION_ID = @"00000000-00000000";
         _diskByteLimit = AWSPinpointClientByteLimitDefault;
         _diskAgeLimit = AWSPinpointClientAgeLimitDefault;
         _batchRecordsByteLimit = AWSPinpointClientBatchRecordByteLimitDefault;
+
+        _transferSchedulerClient = [[AWSTransferScheduler sharedScheduler] registerClientWithName:@"AWSPinpointEventRecorder"
+                                                                                        priority:AWSTransferSchedulerPriorityDefault
+                                                                                          policy:AWSTransferSchedulerPolicyAnyNetwork];
+        __weak AWSPinpointEventRecorder *weakSelf = self;
+        _transferSchedulerClient.flushWindowHandler = ^{
+            [weakSelf submitAllEvents];
+        };
         
         // Creates a directory for storing databases if it doesn't exist.
         BOOL fileExistsAtPath = [[NSFileManager defaultManager] fileExistsAtPath:databaseDirectoryPath];
@@ -163,11 +170,7 @@ NSString *const DEFAULT_SESSION_ID = @"00000000-00000000";
     if (session && session.sessionId && session.sessionId.length >=1) {
         return session;
     }
-    NSData *sessionData = [self.context.configuration.userDefaults dataForKey:AWSPinpointSessionKey];
-    AWSPinpointSession *previousSession;
-    if (sessionData) {
-        previousSession = [NSKeyedUnarchiver unarchiveObjectWithData:sessionData];
-    }
+    AWSPinpointSession *previousSession = [AWSPinpointSession sessionWithStateData:[self.context.stateStore dataForKey:AWSPinpointSessionKey]];
     if(!previousSession)
     {
         previousSession = [[AWSPinpointSession alloc] initWithSessionId:DEFAULT_SESSION_ID withStartTime:[NSDate date] withStopTime:[NSDate date]];
@@ -179,14 +182,11 @@ NSString *const DEFAULT_SESSION_ID = @"00000000-00000000";
     if(sessionId && sessionId.length >= 1) {
         return sessionId;
     }
-    NSData *sessionData = [self.context.configuration.userDefaults dataForKey:AWSPinpointSessionKey];
-    if (sessionData) {
-        AWSPinpointSession *previousSession = [NSKeyedUnarchiver unarchiveObjectWithData:sessionData];
-        sessionId = previousSession.sessionId;
-        if (sessionId && sessionId.length >= 1)
-        {
-            return sessionId;
-        }
+    AWSPinpointSession *previousSession = [AWSPinpointSession sessionWithStateData:[self.context.stateStore dataForKey:AWSPinpointSessionKey]];
+    sessionId = previousSession.sessionId;
+    if (sessionId && sessionId.length >= 1)
+    {
+        return sessionId;
     }
     return DEFAULT_SESSION_ID;
 }
@@ -622,10 +622,24 @@ NSString *const DEFAULT_SESSION_ID = @"00000000-00000000";
                                              withSuccessBlock:^id _Nullable(AWSTask * _Nonnull task) {
         __block NSError *error = nil;
         __block NSMutableArray *events = [NSMutableArray new];
+
+        int64_t batchBytes = 0;
+        for (NSDictionary *eventDictionary in temporaryEvents) {
+            batchBytes += [eventDictionary[@"attributes"] length] + [eventDictionary[@"metrics"] length];
+        }
         
-        AWSTask *submitTask = [[self putEvents:temporaryEvents
-                                         error:&error
-                                      eventIDs:_eventIds]
+        AWSTask *submitTask = [[[[AWSTransferScheduler sharedScheduler] requestGrantForClient:self.transferSchedulerClient
+                                                                                       bytes:batchBytes]
+                                continueWithSuccessBlock:^id _Nullable(AWSTask<AWSTransferSchedulerGrant *> * _Nonnull grantTask) {
+                                    AWSTransferSchedulerGrant *grant = grantTask.result;
+                                    return [[self putEvents:temporaryEvents
+                                                      error:&error
+                                                   eventIDs:_eventIds]
+                                            continueWithBlock:^id _Nullable(AWSTask * _Nonnull task) {
+                                                [grant finish];
+                                                return task;
+                                            }];
+                                }]
                                continueWithBlock:^id _Nullable(AWSTask * _Nonnull task) {
                                    if (task.error) {
                                        error = task.error;
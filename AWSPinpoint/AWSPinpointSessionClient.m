@@ -21,6 +21,7 @@
 #import "AWSPinpointConfiguration.h"
 #import "AWSPinpointStringUtils.h"
 #import "AWSPinpointDateUtils.h"
+#import "AWSPinpointStateStore.h"
 
 //Event Type Constants ---------------------------
 NSString *const SESSION_START_EVENT_TYPE = @"_session.start";
@@ -40,6 +41,12 @@ static NSString *const AWSPinpointSessionBackgroundTask = @"com.amazonaws.AWSPin
 
 typedef void(^voidBlock)(void);
 
+// The stored form of a session: the times are followed by the UTF-8 session ID.
+typedef struct {
+    NSTimeInterval startTime;
+    NSTimeInterval stopTime; // NAN while the session is running
+} AWSPinpointSessionState;
+
 #pragma mark - Interfaces -
 
 @interface AWSPinpointSession()
@@ -57,6 +64,8 @@ typedef void(^voidBlock)(void);
 - (BOOL)isPaused;
 - (void)pause;
 - (void)resume;
+- (NSData *)stateData;
++ (instancetype)sessionWithStateData:(NSData *)stateData;
 
 @end
 
@@ -94,8 +103,16 @@ typedef void(^voidBlock)(void);
     NSAssert(context != nil, @"context should not have been nil");
     if (self = [super init]) {
         _context = context;
-        NSData *sessionData = [context.configuration.userDefaults dataForKey:AWSPinpointSessionKey];
-        _session = [NSKeyedUnarchiver unarchiveObjectWithData:sessionData];
+        [context.stateStore migrateObjectForKey:AWSPinpointSessionKey
+                               fromUserDefaults:context.configuration.userDefaults
+                                     usingBlock:^NSData *(id object) {
+                                         if (![object isKindOfClass:[NSData class]]) {
+                                             return nil;
+                                         }
+                                         AWSPinpointSession *session = [NSKeyedUnarchiver unarchiveObjectWithData:object];
+                                         return [session stateData];
+                                     }];
+        _session = [AWSPinpointSession sessionWithStateData:[context.stateStore dataForKey:AWSPinpointSessionKey]];
         
         //Only add observers if auto session recording is enabled
         if (context.configuration.enableAutoSessionRecording) {
@@ -122,17 +139,10 @@ typedef void(^voidBlock)(void);
 }
 
 - (void)saveSession {
-    @try {
-        @synchronized (_session) {
-            AWSPinpointSession *session = [_session copy];
-            NSData *sessionData = [NSKeyedArchiver archivedDataWithRootObject:session];
-            [self.context.configuration.userDefaults setObject:sessionData forKey:AWSPinpointSessionKey];
-            [self.context.configuration.userDefaults synchronize];
-        }
+    @synchronized (_session) {
+        [self.context.stateStore setData:[_session stateData] forKey:AWSPinpointSessionKey];
     }
-    @catch (NSException *e) {
-        AWSDDLogError(@"Unable to save session to user defaults: %@", e.reason);
-    }}
+}
 
 - (void)applicationDidEnterBackground:(NSNotification*)notification {
     [self pauseSessionWithTimeoutEnabled:YES
@@ -418,6 +428,32 @@ typedef void(^voidBlock)(void);
     return self;
 }
 
+- (NSData *)stateData {
+    @synchronized(self) {
+        AWSPinpointSessionState state = {
+            .startTime = [_startTime timeIntervalSince1970],
+            .stopTime = _stopTime ? [_stopTime timeIntervalSince1970] : NAN,
+        };
+        NSMutableData *stateData = [NSMutableData dataWithBytes:&state length:sizeof(state)];
+        [stateData appendData:[_sessionId dataUsingEncoding:NSUTF8StringEncoding]];
+        return stateData;
+    }
+}
+
++ (instancetype)sessionWithStateData:(NSData *)stateData {
+    if ([stateData length] < sizeof(AWSPinpointSessionState)) {
+        return nil;
+    }
+    AWSPinpointSessionState state;
+    [stateData getBytes:&state length:sizeof(state)];
+    NSString *sessionId = [[NSString alloc] initWithBytes:(const uint8_t *)[stateData bytes] + sizeof(state)
+                                                   length:[stateData length] - sizeof(state)
+                                                 encoding:NSUTF8StringEncoding];
+    return [[AWSPinpointSession alloc] initWithSessionId:sessionId
+                                           withStartTime:[NSDate dateWithTimeIntervalSince1970:state.startTime]
+                                            withStopTime:isnan(state.stopTime) ? nil : [NSDate dateWithTimeIntervalSince1970:state.stopTime]];
+}
+
 - (UTCTimeMillis)timeDurationInMillis {
     UTCTimeMillis start = [AWSPinpointDateUtils utcTimeMillisFromDate:self.startTime];
     UTCTimeMillis end = self.stopTime != nil ? [AWSPinpointDateUtils utcTimeMillisFromDate:self.stopTime] : [AWSPinpointDateUtils utcTimeMillisNow];
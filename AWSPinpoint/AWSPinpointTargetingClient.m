@@ -21,6 +21,7 @@
 #import "AWSPinpointContext.h"
 #import "AWSPinpointTargetingService.h"
 #import "AWSPinpointConfiguration.h"
+#import "AWSPinpointStateStore.h"
 
 NSString *const AWSPinpointEndpointAttributesKey = @"AWSPinpointEndpointAttributesKey";
 NSString *const AWSPinpointEndpointMetricsKey = @"AWSPinpointEndpointMetricsKey";
@@ -51,15 +52,58 @@ NSString *const APNS_CHANNEL_TYPE = @"APNS";
 - (instancetype)initWithContext:(AWSPinpointContext *) context {
     if (self = [super init]) {
         _context = context;
-        NSDictionary *customAttributes = [context.configuration.userDefaults objectForKey:AWSPinpointEndpointAttributesKey];
+        for (NSString *key in @[AWSPinpointEndpointAttributesKey, AWSPinpointEndpointMetricsKey]) {
+            [context.stateStore migrateObjectForKey:key
+                                   fromUserDefaults:context.configuration.userDefaults
+                                         usingBlock:^NSData *(id object) {
+                                             return [AWSPinpointTargetingClient stateDataWithDictionary:object];
+                                         }];
+        }
+        NSDictionary *customAttributes = [AWSPinpointTargetingClient dictionaryWithStateData:[context.stateStore dataForKey:AWSPinpointEndpointAttributesKey]];
         _globalAttributes = [[NSMutableDictionary alloc] initWithDictionary:customAttributes];
-        NSDictionary *customMetrics = [context.configuration.userDefaults objectForKey:AWSPinpointEndpointMetricsKey];
+        NSDictionary *customMetrics = [AWSPinpointTargetingClient dictionaryWithStateData:[context.stateStore dataForKey:AWSPinpointEndpointMetricsKey]];
         _globalMetrics = [[NSMutableDictionary alloc] initWithDictionary:customMetrics];
     }
     
     return self;
 }
 
++ (NSData *)stateDataWithDictionary:(NSDictionary *)dictionary {
+    if (![dictionary isKindOfClass:[NSDictionary class]]) {
+        return nil;
+    }
+    NSError *error = nil;
+    NSData *stateData = [NSPropertyListSerialization dataWithPropertyList:dictionary
+                                                                   format:NSPropertyListBinaryFormat_v1_0
+                                                                  options:0
+                                                                    error:&error];
+    if (!stateData) {
+        AWSDDLogError(@"Unable to encode the global endpoint attributes or metrics: %@", error);
+    }
+    return stateData;
+}
+
++ (NSDictionary *)dictionaryWithStateData:(NSData *)stateData {
+    if (!stateData) {
+        return nil;
+    }
+    id dictionary = [NSPropertyListSerialization propertyListWithData:stateData
+                                                              options:NSPropertyListImmutable
+                                                               format:NULL
+                                                                error:nil];
+    return [dictionary isKindOfClass:[NSDictionary class]] ? dictionary : nil;
+}
+
+- (void)saveGlobalAttributes {
+    [self.context.stateStore setData:[AWSPinpointTargetingClient stateDataWithDictionary:self.globalAttributes]
+                              forKey:AWSPinpointEndpointAttributesKey];
+}
+
+- (void)saveGlobalMetrics {
+    [self.context.stateStore setData:[AWSPinpointTargetingClient stateDataWithDictionary:self.globalMetrics]
+                              forKey:AWSPinpointEndpointMetricsKey];
+}
+
 - (AWSPinpointEndpointProfile *) currentEndpointProfile {
     AWSPinpointEndpointProfile *endpointProfile = [[AWSPinpointEndpointProfile alloc] initWithContext: self.context];
 
@@ -142,10 +186,12 @@ NSString *const APNS_CHANNEL_TYPE = @"APNS";
     }
     
     @synchronized(self) {
+        if ([[self.globalAttributes objectForKey:theKey] isEqual:theValue]) {
+            return;
+        }
         //Save value to disk
         [self.globalAttributes setValue:theValue forKey:theKey];
-        [self.context.configuration.userDefaults setObject:self.globalAttributes forKey:AWSPinpointEndpointAttributesKey];
-        [self.context.configuration.userDefaults synchronize];
+        [self saveGlobalAttributes];
     }
 }
 
@@ -157,9 +203,11 @@ NSString *const APNS_CHANNEL_TYPE = @"APNS";
     }
     
     @synchronized(self) {
+        if (![self.globalAttributes objectForKey:theKey]) {
+            return;
+        }
         [self.globalAttributes removeObjectForKey:theKey];
-        [self.context.configuration.userDefaults setObject:self.globalAttributes forKey:AWSPinpointEndpointAttributesKey];
-        [self.context.configuration.userDefaults synchronize];
+        [self saveGlobalAttributes];
     }
 }
 
@@ -179,9 +227,11 @@ NSString *const APNS_CHANNEL_TYPE = @"APNS";
     }
     
     @synchronized(self) {
+        if ([[self.globalMetrics objectForKey:theKey] isEqual:theValue]) {
+            return;
+        }
         [self.globalMetrics setValue:theValue forKey:theKey];
-        [self.context.configuration.userDefaults setObject:self.globalMetrics forKey:AWSPinpointEndpointMetricsKey];
-        [self.context.configuration.userDefaults synchronize];
+        [self saveGlobalMetrics];
     }
 }
 
@@ -193,9 +243,11 @@ NSString *const APNS_CHANNEL_TYPE = @"APNS";
     }
     
     @synchronized(self) {
+        if (![self.globalMetrics objectForKey:theKey]) {
+            return;
+        }
         [self.globalMetrics removeObjectForKey:theKey];
-        [self.context.configuration.userDefaults setObject:self.globalMetrics forKey:AWSPinpointEndpointMetricsKey];
-        [self.context.configuration.userDefaults synchronize];
+        [self saveGlobalMetrics];
     }
 }
 
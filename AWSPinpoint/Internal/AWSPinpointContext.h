@@ -16,7 +16,7 @@
 #import <Foundation/Foundation.h>
 #import <AWSCore/AWSCore.h>
 
-@class AWSPinpointContext, AWSPinpointConfiguration, AWSPinpointAnalytics, AWSPinpointTargeting, AWSPinpointTargetingClient, AWSPinpointAnalyticsClient, AWSPinpointSessionClient;
+@class AWSPinpointContext, AWSPinpointConfiguration, AWSPinpointAnalytics, AWSPinpointTargeting, AWSPinpointTargetingClient, AWSPinpointAnalyticsClient, AWSPinpointSessionClient, AWSPinpointStateStore;
 
 @interface AWSPinpointClientContext : AWSClientContext
 @end
@@ -27,6 +27,7 @@
 
 @property (nonatomic, readonly) AWSPinpointClientContext *clientContext;
 @property (nonatomic, readonly) NSString* uniqueId;
+@property (nonatomic, readonly) AWSPinpointStateStore *stateStore;
 @property (nonatomic, strong) AWSPinpointAnalytics *analyticsService;
 @property (nonatomic, strong) AWSPinpointTargeting *targetingService;
 @property (nonatomic, strong) AWSPinpointConfiguration *configuration;
@@ -18,6 +18,7 @@
 #import "AWSPinpointService.h"
 #import "AWSPinpointAnalytics.h"
 #import "AWSPinpointTargeting.h"
+#import "AWSPinpointStateStore.h"
 
 static NSString *const AWSMobileAnalyticsRoot = @"com.amazonaws.MobileAnalytics";
 
@@ -34,6 +35,7 @@ static NSString *const AWSPinpointContextKeychainUniqueIdKey = @"com.amazonaws.A
 @property (nonatomic, strong) AWSUICKeyChainStore *keychain;
 @property (nonatomic, strong) AWSPinpointClientContext *clientContext;
 @property (nonatomic, strong) NSString* uniqueId;
+@property (nonatomic, strong) AWSPinpointStateStore *stateStore;
 
 @end
 
@@ -166,6 +168,7 @@ static NSString *const AWSPinpointContextKeychainUniqueIdKey = @"com.amazonaws.A
         _configuration = configuration;
         _keychain = [AWSUICKeyChainStore keyChainStoreWithService:AWSPinpointContextKeychainService];
         _uniqueId = [self retrieveUniqueId];
+        _stateStore = [AWSPinpointStateStore stateStoreWithAppId:configuration.appId];
         AWSPinpointEnvironment *environment = configuration.environment;
         _clientContext = [AWSPinpointClientContext new];
         _clientContext.appVersion = environment.appVersion;
@@ -0,0 +1,78 @@
+//
+// Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ A small key-value store for the session and endpoint state of a Pinpoint app.
+
+ The values live in a memory-mapped file with two slots. A write fills the slot that is not current and then
+ makes it current, so the file always holds either the previous or the new state, even if the app is killed
+ mid-write. Writing a value equal to the stored one does nothing.
+ */
+@interface AWSPinpointStateStore : NSObject
+
+/**
+ The directory holding the state files of all Pinpoint apps.
+ */
++ (NSString *)stateStoreDirectoryPath;
+
+/**
+ Returns the store for the app, backed by a file named after the app ID in `stateStoreDirectoryPath`.
+ */
++ (instancetype)stateStoreWithAppId:(NSString *)appId;
+
+/**
+ Returns a store backed by the file at `path`, creating the file if it does not exist. If the file cannot be
+ mapped, the store keeps its values in memory only.
+ */
+- (instancetype)initWithPath:(NSString *)path NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@property (nonatomic, strong, readonly) NSString *path;
+
+/**
+ The number of writes that reached the file. Writes skipped because the value did not change are not counted.
+ */
+@property (nonatomic, assign, readonly) NSUInteger writeCount;
+
+- (nullable NSData *)dataForKey:(NSString *)key;
+
+/**
+ Stores `data` under `key`, or removes the value if `data` is nil.
+
+ @return YES if the stored state changed.
+ */
+- (BOOL)setData:(nullable NSData *)data forKey:(NSString *)key;
+
+- (BOOL)removeDataForKey:(NSString *)key;
+
+- (void)removeAllData;
+
+/**
+ Moves a value written by an earlier version of the SDK out of `userDefaults`. If the store has no value for
+ `key` yet, `block` converts the object found in `userDefaults` and its result is stored; the object is then
+ removed from `userDefaults` either way.
+ */
+- (void)migrateObjectForKey:(NSString *)key
+           fromUserDefaults:(NSUserDefaults *)userDefaults
+                 usingBlock:(NSData * _Nullable (^)(id object))block;
+
+@end
+
+NS_ASSUME_NONNULL_END
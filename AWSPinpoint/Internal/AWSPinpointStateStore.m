@@ -0,0 +1,368 @@
+//
+// Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+
+#import "AWSPinpointStateStore.h"
+#import <AWSCore/AWSCocoaLumberjack.h>
+#import <fcntl.h>
+#import <pthread.h>
+#import <stdatomic.h>
+#import <sys/mman.h>
+#import <sys/stat.h>
+#import <unistd.h>
+
+static NSString *const AWSPinpointStateStoreDirectoryPathComponent = @"com.amazonaws.AWSPinpointStateStore";
+static const uint32_t AWSPinpointStateStoreMagic = 0x50535741; // "AWSP"
+static const size_t AWSPinpointStateStoreMinimumSlotLength = 4096;
+
+// Each slot starts with this header. The checksum covers the sequence, the length and the payload, so a slot
+// whose write was interrupted is rejected and the other slot is used.
+typedef struct {
+    uint32_t magic;
+    uint32_t length;
+    uint64_t sequence;
+    uint64_t checksum;
+} AWSPinpointStateStoreSlotHeader;
+
+static uint64_t AWSPinpointStateStoreChecksum(uint64_t sequence, uint32_t length, const uint8_t *payload) {
+    // 64-bit FNV-1a
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    const uint8_t *fields[] = {(const uint8_t *)&sequence, (const uint8_t *)&length, payload};
+    const size_t lengths[] = {sizeof(sequence), sizeof(length), length};
+    for (NSUInteger field = 0; field < 3; field++) {
+        for (size_t i = 0; i < lengths[field]; i++) {
+            hash ^= fields[field][i];
+            hash *= 0x100000001b3ULL;
+        }
+    }
+    return hash;
+}
+
+@interface AWSPinpointStateStore() {
+    pthread_mutex_t _lock;
+    int _fileDescriptor;
+    uint8_t *_map;
+    size_t _slotLength;
+    NSUInteger _currentSlot;
+    uint64_t _sequence;
+    _Atomic(NSUInteger) _writeCount;
+}
+
+@property (nonatomic, strong) NSString *path;
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSData *> *values;
+
+@end
+
+@implementation AWSPinpointStateStore
+
++ (NSString *)stateStoreDirectoryPath {
+    NSString *applicationSupportDirectory = [NSSearchPathForDirectoriesInDomains(NSApplicationSupportDirectory, NSUserDomainMask, YES) firstObject];
+    return [applicationSupportDirectory stringByAppendingPathComponent:AWSPinpointStateStoreDirectoryPathComponent];
+}
+
++ (instancetype)stateStoreWithAppId:(NSString *)appId {
+    NSString *directoryPath = [self stateStoreDirectoryPath];
+    NSError *error = nil;
+    if (![[NSFileManager defaultManager] createDirectoryAtPath:directoryPath
+                                   withIntermediateDirectories:YES
+                                                    attributes:nil
+                                                         error:&error]) {
+        AWSDDLogError(@"Failed to create a directory for the Pinpoint state. [%@]", error);
+    }
+    return [[self alloc] initWithPath:[directoryPath stringByAppendingPathComponent:appId]];
+}
+
+- (instancetype)init {
+    @throw [NSException exceptionWithName:NSInternalInconsistencyException
+                                   reason:@"`- init` is not a valid initializer. Use `- initWithPath:` instead."
+                                 userInfo:nil];
+}
+
+- (instancetype)initWithPath:(NSString *)path {
+    if (self = [super init]) {
+        pthread_mutex_init(&_lock, NULL);
+        _path = path;
+        _values = [NSMutableDictionary new];
+        _fileDescriptor = -1;
+        // With no valid slot, the first write goes to slot 0.
+        _currentSlot = 1;
+        [self openFile];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [self closeFile];
+    pthread_mutex_destroy(&_lock);
+}
+
+- (NSUInteger)writeCount {
+    return atomic_load(&_writeCount);
+}
+
+#pragma mark - Public
+
+- (NSData *)dataForKey:(NSString *)key {
+    pthread_mutex_lock(&_lock);
+    NSData *data = self.values[key];
+    pthread_mutex_unlock(&_lock);
+    return data;
+}
+
+- (BOOL)setData:(NSData *)data forKey:(NSString *)key {
+    pthread_mutex_lock(&_lock);
+    NSData *current = self.values[key];
+    if (current == data || [current isEqualToData:data]) {
+        pthread_mutex_unlock(&_lock);
+        return NO;
+    }
+    if (data) {
+        self.values[key] = [data copy];
+    } else {
+        [self.values removeObjectForKey:key];
+    }
+    [self writeLocked];
+    pthread_mutex_unlock(&_lock);
+    return YES;
+}
+
+- (BOOL)removeDataForKey:(NSString *)key {
+    return [self setData:nil forKey:key];
+}
+
+- (void)removeAllData {
+    pthread_mutex_lock(&_lock);
+    if ([self.values count] > 0) {
+        [self.values removeAllObjects];
+        [self writeLocked];
+    }
+    pthread_mutex_unlock(&_lock);
+}
+
+- (void)migrateObjectForKey:(NSString *)key
+           fromUserDefaults:(NSUserDefaults *)userDefaults
+                 usingBlock:(NSData * (^)(id object))block {
+    id object = [userDefaults objectForKey:key];
+    if (!object) {
+        return;
+    }
+    if (![self dataForKey:key]) {
+        NSData *data = block(object);
+        if (data) {
+            [self setData:data forKey:key];
+            AWSDDLogVerbose(@"Migrated [%@] from NSUserDefaults to the Pinpoint state store.", key);
+        }
+    }
+    [userDefaults removeObjectForKey:key];
+}
+
+#pragma mark - Encoding
+
+// Entries are laid out as [uint32 key length][key][uint32 value length][value], in host byte order.
+- (NSData *)encodedValuesLocked {
+    NSMutableData *payload = [NSMutableData new];
+    [self.values enumerateKeysAndObjectsUsingBlock:^(NSString *key, NSData *value, BOOL *stop) {
+        NSData *keyData = [key dataUsingEncoding:NSUTF8StringEncoding];
+        uint32_t keyLength = (uint32_t)[keyData length];
+        uint32_t valueLength = (uint32_t)[value length];
+        [payload appendBytes:&keyLength length:sizeof(keyLength)];
+        [payload appendData:keyData];
+        [payload appendBytes:&valueLength length:sizeof(valueLength)];
+        [payload appendData:value];
+    }];
+    return payload;
+}
+
+- (BOOL)decodeValues:(const uint8_t *)payload length:(uint32_t)length {
+    NSMutableDictionary *values = [NSMutableDictionary new];
+    size_t offset = 0;
+    while (offset < length) {
+        uint32_t keyLength, valueLength;
+        if (length - offset < sizeof(keyLength)) {
+            return NO;
+        }
+        memcpy(&keyLength, payload + offset, sizeof(keyLength));
+        offset += sizeof(keyLength);
+        if (length - offset < (size_t)keyLength + sizeof(valueLength)) {
+            return NO;
+        }
+        NSString *key = [[NSString alloc] initWithBytes:payload + offset length:keyLength encoding:NSUTF8StringEncoding];
+        offset += keyLength;
+        memcpy(&valueLength, payload + offset, sizeof(valueLength));
+        offset += sizeof(valueLength);
+        if (!key || length - offset < valueLength) {
+            return NO;
+        }
+        values[key] = [NSData dataWithBytes:payload + offset length:valueLength];
+        offset += valueLength;
+    }
+    self.values = values;
+    return YES;
+}
+
+#pragma mark - File
+
+- (void)openFile {
+    int fileDescriptor = open([self.path fileSystemRepresentation], O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
+    if (fileDescriptor < 0) {
+        AWSDDLogError(@"Failed to open the Pinpoint state file [%@]. errno: %d", self.path, errno);
+        return;
+    }
+
+    struct stat fileStat;
+    if (fstat(fileDescriptor, &fileStat) != 0) {
+        close(fileDescriptor);
+        return;
+    }
+    size_t fileLength = (size_t)fileStat.st_size;
+    if (fileLength < AWSPinpointStateStoreMinimumSlotLength * 2 || fileLength % 2 != 0) {
+        // A new file, or one not written by this store.
+        fileLength = AWSPinpointStateStoreMinimumSlotLength * 2;
+        if (ftruncate(fileDescriptor, 0) != 0 || ftruncate(fileDescriptor, fileLength) != 0) {
+            AWSDDLogError(@"Failed to size the Pinpoint state file [%@]. errno: %d", self.path, errno);
+            close(fileDescriptor);
+            return;
+        }
+    }
+
+    if (![self mapFileDescriptor:fileDescriptor length:fileLength]) {
+        close(fileDescriptor);
+        return;
+    }
+
+    // Load the valid slot with the highest sequence number.
+    BOOL loaded = NO;
+    for (NSUInteger slot = 0; slot < 2; slot++) {
+        const AWSPinpointStateStoreSlotHeader *header = [self headerOfSlot:slot];
+        if (header->magic != AWSPinpointStateStoreMagic
+            || header->length > _slotLength - sizeof(AWSPinpointStateStoreSlotHeader)
+            || (loaded && header->sequence <= _sequence)) {
+            continue;
+        }
+        const uint8_t *payload = (const uint8_t *)(header + 1);
+        if (header->checksum != AWSPinpointStateStoreChecksum(header->sequence, header->length, payload)) {
+            AWSDDLogWarn(@"Ignoring an incomplete write in slot %lu of the Pinpoint state file.", (unsigned long)slot);
+            continue;
+        }
+        if ([self decodeValues:payload length:header->length]) {
+            _currentSlot = slot;
+            _sequence = header->sequence;
+            loaded = YES;
+        }
+    }
+}
+
+- (BOOL)mapFileDescriptor:(int)fileDescriptor length:(size_t)fileLength {
+    void *map = mmap(NULL, fileLength, PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, 0);
+    if (map == MAP_FAILED) {
+        AWSDDLogError(@"Failed to map the Pinpoint state file [%@]. errno: %d", self.path, errno);
+        return NO;
+    }
+    _map = map;
+    _slotLength = fileLength / 2;
+    _fileDescriptor = fileDescriptor;
+    return YES;
+}
+
+- (void)closeFile {
+    if (_map) {
+        munmap(_map, _slotLength * 2);
+        _map = NULL;
+    }
+    if (_fileDescriptor >= 0) {
+        close(_fileDescriptor);
+        _fileDescriptor = -1;
+    }
+}
+
+- (AWSPinpointStateStoreSlotHeader *)headerOfSlot:(NSUInteger)slot {
+    return (AWSPinpointStateStoreSlotHeader *)(_map + slot * _slotLength);
+}
+
+- (void)writeLocked {
+    if (!_map) {
+        return;
+    }
+
+    NSData *payload = [self encodedValuesLocked];
+    size_t requiredLength = sizeof(AWSPinpointStateStoreSlotHeader) + [payload length];
+    if (requiredLength > _slotLength) {
+        [self writeGrownFileLocked:payload];
+        return;
+    }
+
+    NSUInteger slot = _currentSlot ^ 1;
+    AWSPinpointStateStoreSlotHeader *header = [self headerOfSlot:slot];
+    uint64_t sequence = _sequence + 1;
+    uint32_t length = (uint32_t)[payload length];
+
+    // Invalidate the slot first, then fill in the payload, then publish the header.
+    header->magic = 0;
+    atomic_thread_fence(memory_order_release);
+    memcpy(header + 1, [payload bytes], length);
+    header->length = length;
+    header->sequence = sequence;
+    header->checksum = AWSPinpointStateStoreChecksum(sequence, length, [payload bytes]);
+    atomic_thread_fence(memory_order_release);
+    header->magic = AWSPinpointStateStoreMagic;
+
+    // The page cache outlives the process, so the write survives a crash as soon as the header is published.
+    // The asynchronous flush only starts the write to disk, keeping lifecycle transitions off the I/O path.
+    msync(header, sizeof(AWSPinpointStateStoreSlotHeader) + length, MS_ASYNC);
+
+    _currentSlot = slot;
+    _sequence = sequence;
+    atomic_fetch_add(&_writeCount, 1);
+}
+
+// The slots are resized by writing a complete new file and renaming it over the old one.
+- (void)writeGrownFileLocked:(NSData *)payload {
+    size_t slotLength = _slotLength;
+    while (slotLength < sizeof(AWSPinpointStateStoreSlotHeader) + [payload length]) {
+        slotLength *= 2;
+    }
+
+    uint64_t sequence = _sequence + 1;
+    uint32_t length = (uint32_t)[payload length];
+    AWSPinpointStateStoreSlotHeader header = {
+        .magic = AWSPinpointStateStoreMagic,
+        .length = length,
+        .sequence = sequence,
+        .checksum = AWSPinpointStateStoreChecksum(sequence, length, [payload bytes]),
+    };
+    NSMutableData *file = [NSMutableData dataWithLength:slotLength * 2];
+    memcpy([file mutableBytes], &header, sizeof(header));
+    memcpy((uint8_t *)[file mutableBytes] + sizeof(header), [payload bytes], length);
+
+    NSError *error = nil;
+    if (![file writeToFile:self.path options:NSDataWritingAtomic error:&error]) {
+        AWSDDLogError(@"Failed to write the Pinpoint state file [%@]. [%@]", self.path, error);
+        return;
+    }
+
+    [self closeFile];
+    int fileDescriptor = open([self.path fileSystemRepresentation], O_RDWR);
+    if (fileDescriptor < 0 || ![self mapFileDescriptor:fileDescriptor length:slotLength * 2]) {
+        if (fileDescriptor >= 0) {
+            close(fileDescriptor);
+        }
+        AWSDDLogError(@"Failed to reopen the Pinpoint state file [%@]. Values are kept in memory only.", self.path);
+        return;
+    }
+    _currentSlot = 0;
+    _sequence = sequence;
+    atomic_fetch_add(&_writeCount, 1);
+}
+
+@end
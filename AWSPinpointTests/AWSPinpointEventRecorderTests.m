@@ -20,6 +20,7 @@
 #import "AWSPinpoint.h"
 #import "AWSTestUtility.h"
 #import "AWSPinpointContext.h"
+#import "AWSPinpointStateStore.h"
 
 NSString *const AWSKinesisRecorderTestStream = @"AWSSDKForiOSv2Test";
 NSString *const AWSPinpointSessionKey = @"com.amazonaws.AWSPinpointSessionKey";
@@ -63,6 +64,7 @@ NSUInteger const AWSPinpointClientInvalidEvent = 1;
 - (instancetype)initWithSessionId:(NSString *)sessionId
                     withStartTime:(NSDate *)startTime
                      withStopTime:(NSDate *)stopTime;
++ (instancetype)sessionWithStateData:(NSData *)stateData;
 @end
 
 @interface AWSPinpointAnalyticsClient()
@@ -113,6 +115,7 @@ NSUInteger const AWSPinpointClientInvalidEvent = 1;
     AWSPinpoint *pinpoint = [AWSPinpoint pinpointWithConfiguration:config];
     [config.userDefaults setObject:nil forKey:AWSPinpointSessionKey];
     [config.userDefaults removeObjectForKey:AWSPinpointSessionKey];
+    [pinpoint.pinpointContext.stateStore removeDataForKey:AWSPinpointSessionKey];
     [config.userDefaults synchronize];
     [[pinpoint.analyticsClient.eventRecorder removeAllEvents] waitUntilFinished];
     
@@ -159,11 +162,10 @@ NSUInteger const AWSPinpointClientInvalidEvent = 1;
         XCTAssertEqual([stopEvent.allMetrics count], 0);
         return nil;
     }] waitUntilFinished];
-    NSUserDefaults *userDefaults = [[NSUserDefaults alloc] initWithSuiteName:@"testEventsWithNoSessionId"];
-    //Tests that session info is not deleted from userdefaults
-    XCTAssertNotNil([userDefaults dataForKey:AWSPinpointSessionKey]);
-    NSData *sessionData = [userDefaults dataForKey:AWSPinpointSessionKey];
-    AWSPinpointSession *previousSession = [NSKeyedUnarchiver unarchiveObjectWithData:sessionData];
+    //Tests that session info is not deleted from the state store
+    XCTAssertNotNil([pinpoint.pinpointContext.stateStore dataForKey:AWSPinpointSessionKey]);
+    NSData *sessionData = [pinpoint.pinpointContext.stateStore dataForKey:AWSPinpointSessionKey];
+    AWSPinpointSession *previousSession = [AWSPinpointSession sessionWithStateData:sessionData];
     NSString *sessionId = previousSession.sessionId;
     
     AWSPinpointEvent *event2 = [[AWSPinpointEvent alloc] initWithEventType:@"TEST"
@@ -275,16 +277,17 @@ NSUInteger const AWSPinpointClientInvalidEvent = 1;
     
     
     AWSPinpoint *pinpoint = [AWSPinpoint pinpointWithConfiguration:config];
+    [pinpoint.pinpointContext.stateStore removeDataForKey:AWSPinpointSessionKey];
     [pinpoint.sessionClient stopSession];
     [pinpoint.analyticsClient removeAllGlobalCampaignAttributes];
     [[pinpoint.analyticsClient.eventRecorder removeAllEvents] waitUntilFinished];
     
-    NSData *data = [pinpoint.pinpointContext.configuration.userDefaults dataForKey:AWSPinpointSessionKey];
-    AWSPinpointSession *session = [NSKeyedUnarchiver unarchiveObjectWithData:data];
+    NSData *data = [pinpoint.pinpointContext.stateStore dataForKey:AWSPinpointSessionKey];
+    AWSPinpointSession *session = [AWSPinpointSession sessionWithStateData:data];
     
     AWSDDLogError(@"Session Object Should be Empty: %@",session.description);
     
-    XCTAssertNil([pinpoint.pinpointContext.configuration.userDefaults dataForKey:AWSPinpointSessionKey]);
+    XCTAssertNil([pinpoint.pinpointContext.stateStore dataForKey:AWSPinpointSessionKey]);
     
     [[pinpoint.sessionClient startSession] continueWithBlock:^id _Nullable(AWSTask * _Nonnull task) {
         [[pinpoint.analyticsClient.eventRecorder getCurrentSession:pinpoint.sessionClient.session] continueWithBlock:^id _Nullable(AWSTask * _Nonnull task) {
@@ -435,6 +438,7 @@ NSUInteger const AWSPinpointClientInvalidEvent = 1;
     AWSPinpoint *pinpoint = [AWSPinpoint pinpointWithConfiguration:config];
     [config.userDefaults setObject:nil forKey:AWSPinpointSessionKey];
     [config.userDefaults removeObjectForKey:AWSPinpointSessionKey];
+    [pinpoint.pinpointContext.stateStore removeDataForKey:AWSPinpointSessionKey];
     [config.userDefaults synchronize];
     [[pinpoint.analyticsClient.eventRecorder removeAllEvents] waitUntilFinished];
     [pinpoint.analyticsClient.eventRecorder setBatchRecordsByteLimit:DEFAULT_BATCH_LIMIT];
@@ -514,6 +518,7 @@ NSUInteger const AWSPinpointClientInvalidEvent = 1;
     AWSPinpoint *pinpoint = [AWSPinpoint pinpointWithConfiguration:config];
     [config.userDefaults setObject:nil forKey:AWSPinpointSessionKey];
     [config.userDefaults removeObjectForKey:AWSPinpointSessionKey];
+    [pinpoint.pinpointContext.stateStore removeDataForKey:AWSPinpointSessionKey];
     [config.userDefaults synchronize];
     [[pinpoint.analyticsClient.eventRecorder removeAllEvents] waitUntilFinished];
     [pinpoint.analyticsClient.eventRecorder setBatchRecordsByteLimit:DEFAULT_BATCH_LIMIT];
@@ -1134,6 +1139,7 @@ NSUInteger const AWSPinpointClientInvalidEvent = 1;
     AWSPinpoint *pinpoint = [AWSPinpoint pinpointWithConfiguration:config];
     [config.userDefaults setObject:nil forKey:AWSPinpointSessionKey];
     [config.userDefaults removeObjectForKey:AWSPinpointSessionKey];
+    [pinpoint.pinpointContext.stateStore removeDataForKey:AWSPinpointSessionKey];
     [config.userDefaults synchronize];
     [[pinpoint.analyticsClient.eventRecorder removeAllEvents] waitUntilFinished];
     [pinpoint.analyticsClient.eventRecorder setBatchRecordsByteLimit:DEFAULT_BATCH_LIMIT];
@@ -1236,6 +1242,7 @@ NSUInteger const AWSPinpointClientInvalidEvent = 1;
     AWSPinpoint *pinpoint = [AWSPinpoint pinpointWithConfiguration:config];
     [config.userDefaults setObject:nil forKey:AWSPinpointSessionKey];
     [config.userDefaults removeObjectForKey:AWSPinpointSessionKey];
+    [pinpoint.pinpointContext.stateStore removeDataForKey:AWSPinpointSessionKey];
     [config.userDefaults synchronize];
     [[pinpoint.analyticsClient.eventRecorder removeAllEvents] waitUntilFinished];
     [pinpoint.analyticsClient.eventRecorder setBatchRecordsByteLimit:DEFAULT_BATCH_LIMIT];
@@ -1340,6 +1347,7 @@ NSUInteger const AWSPinpointClientInvalidEvent = 1;
     AWSPinpoint *pinpoint = [AWSPinpoint pinpointWithConfiguration:config];
     [config.userDefaults setObject:nil forKey:AWSPinpointSessionKey];
     [config.userDefaults removeObjectForKey:AWSPinpointSessionKey];
+    [pinpoint.pinpointContext.stateStore removeDataForKey:AWSPinpointSessionKey];
     [config.userDefaults synchronize];
     [[pinpoint.analyticsClient.eventRecorder removeAllEvents] waitUntilFinished];
     [pinpoint.analyticsClient.eventRecorder setBatchRecordsByteLimit:DEFAULT_BATCH_LIMIT];
@@ -1498,6 +1506,7 @@ NSUInteger const AWSPinpointClientInvalidEvent = 1;
     AWSPinpoint *pinpoint = [AWSPinpoint pinpointWithConfiguration:config];
     [config.userDefaults setObject:nil forKey:AWSPinpointSessionKey];
     [config.userDefaults removeObjectForKey:AWSPinpointSessionKey];
+    [pinpoint.pinpointContext.stateStore removeDataForKey:AWSPinpointSessionKey];
     [config.userDefaults synchronize];
     [[pinpoint.analyticsClient.eventRecorder removeAllEvents] waitUntilFinished];
     [pinpoint.analyticsClient.eventRecorder setBatchRecordsByteLimit:10];
@@ -1604,6 +1613,7 @@ NSUInteger const AWSPinpointClientInvalidEvent = 1;
     AWSPinpoint *pinpoint = [AWSPinpoint pinpointWithConfiguration:config];
     [config.userDefaults setObject:nil forKey:AWSPinpointSessionKey];
     [config.userDefaults removeObjectForKey:AWSPinpointSessionKey];
+    [pinpoint.pinpointContext.stateStore removeDataForKey:AWSPinpointSessionKey];
     [config.userDefaults synchronize];
     [[pinpoint.analyticsClient.eventRecorder removeAllEvents] waitUntilFinished];
     [pinpoint.analyticsClient.eventRecorder setBatchRecordsByteLimit:10]; //Each batch will contain 1 event
@@ -1712,6 +1722,7 @@ NSUInteger const AWSPinpointClientInvalidEvent = 1;
     AWSPinpoint *pinpoint = [AWSPinpoint pinpointWithConfiguration:config];
     [config.userDefaults setObject:nil forKey:AWSPinpointSessionKey];
     [config.userDefaults removeObjectForKey:AWSPinpointSessionKey];
+    [pinpoint.pinpointContext.stateStore removeDataForKey:AWSPinpointSessionKey];
     [config.userDefaults synchronize];
     [[pinpoint.analyticsClient.eventRecorder removeAllEvents] waitUntilFinished];
     [pinpoint.analyticsClient.eventRecorder setBatchRecordsByteLimit:10];
@@ -1875,6 +1886,7 @@ NSUInteger const AWSPinpointClientInvalidEvent = 1;
     AWSPinpoint *pinpoint = [AWSPinpoint pinpointWithConfiguration:config];
     [config.userDefaults setObject:nil forKey:AWSPinpointSessionKey];
     [config.userDefaults removeObjectForKey:AWSPinpointSessionKey];
+    [pinpoint.pinpointContext.stateStore removeDataForKey:AWSPinpointSessionKey];
     [config.userDefaults synchronize];
     [[pinpoint.analyticsClient.eventRecorder removeAllEvents] waitUntilFinished];
     [pinpoint.analyticsClient.eventRecorder setBatchRecordsByteLimit:10];
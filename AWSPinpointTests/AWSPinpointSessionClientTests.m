@@ -19,6 +19,7 @@
 #import <AWSCore/AWSCore.h>
 #import "AWSTask.h"
 #import "AWSPinpointContext.h"
+#import "AWSPinpointStateStore.h"
 
 @class AWSPinpointSession;
 
@@ -66,6 +67,9 @@ static NSString *const AWSPinpointSessionKey = @"com.amazonaws.AWSPinpointSessio
     NSLog(@"Session Object Should be Empty: %@",session.description);
     
     XCTAssertNil([self.userDefaults dataForKey:AWSPinpointSessionKey]);
+
+    //Sessions are kept in the state store, with a file for each app ID.
+    [[NSFileManager defaultManager] removeItemAtPath:[AWSPinpointStateStore stateStoreDirectoryPath] error:nil];
 }
 
 - (void)testConstructors {
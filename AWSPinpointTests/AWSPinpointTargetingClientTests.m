@@ -18,6 +18,7 @@
 #import "AWSPinpoint.h"
 #import "OCMock.h"
 #import "AWSPinpointContext.h"
+#import "AWSPinpointStateStore.h"
 
 NSString *const AWSPinpointTargetingClientErrorDomain = @"com.amazonaws.AWSPinpointAnalyticsClientErrorDomain";
 
@@ -33,6 +34,10 @@ NSString *const AWSPinpointTargetingClientErrorDomain = @"com.amazonaws.AWSPinpo
 - (AWSPinpointTargetingUpdateEndpointRequest*) updateEndpointRequestForEndpoint:(AWSPinpointEndpointProfile *) endpoint;
 @end
 
+@interface AWSPinpoint()
+@property (nonatomic, strong) AWSPinpointContext *pinpointContext;
+@end
+
 @interface AWSPinpointConfiguration()
 @property (nonnull, strong) NSUserDefaults *userDefaults;
 @end
@@ -51,6 +56,8 @@ NSString *const AWSPinpointTargetingClientErrorDomain = @"com.amazonaws.AWSPinpo
     [self.userDefaults removeObjectForKey:@"AWSPinpointEndpointAttributesKey"];
     [self.userDefaults removeObjectForKey:@"AWSPinpointEndpointMetricsKey"];
     [self.userDefaults synchronize];
+    [self.pinpoint.pinpointContext.stateStore removeDataForKey:@"AWSPinpointEndpointAttributesKey"];
+    [self.pinpoint.pinpointContext.stateStore removeDataForKey:@"AWSPinpointEndpointMetricsKey"];
 }
 
 - (AWSPinpointConfiguration *)getDefaultAWSPinpointConfiguration {
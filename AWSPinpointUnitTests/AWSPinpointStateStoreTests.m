@@ -0,0 +1,248 @@
+//
+// Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+
+#import <XCTest/XCTest.h>
+#import "AWSPinpoint.h"
+#import "AWSPinpointStateStore.h"
+
+static NSString *const AWSPinpointStateStoreTestsSessionKey = @"com.amazonaws.AWSPinpointSessionKey";
+static NSUInteger const AWSPinpointStateStoreTestsTransitionCount = 1000;
+
+@interface AWSPinpointSession()
+
+- (instancetype)initWithSessionId:(NSString *)sessionId
+                    withStartTime:(NSDate *)startTime
+                     withStopTime:(NSDate *)stopTime;
+- (void)pause;
+- (void)resume;
+- (NSData *)stateData;
++ (instancetype)sessionWithStateData:(NSData *)stateData;
+
+@end
+
+@interface AWSPinpointStateStoreTests : XCTestCase
+
+@property (nonatomic, strong) NSString *path;
+
+@end
+
+@implementation AWSPinpointStateStoreTests
+
+- (void)setUp {
+    [super setUp];
+    self.path = [NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+}
+
+- (void)tearDown {
+    [[NSFileManager defaultManager] removeItemAtPath:self.path error:nil];
+    [super tearDown];
+}
+
+- (NSData *)dataWithString:(NSString *)string {
+    return [string dataUsingEncoding:NSUTF8StringEncoding];
+}
+
+// Overwrites bytes of the state file, as a write cut short by a crash would leave them.
+- (void)writeBytes:(NSData *)bytes atOffset:(unsigned long long)offset {
+    NSFileHandle *fileHandle = [NSFileHandle fileHandleForUpdatingAtPath:self.path];
+    [fileHandle seekToFileOffset:offset];
+    [fileHandle writeData:bytes];
+    [fileHandle synchronizeFile];
+    [fileHandle closeFile];
+}
+
+- (unsigned long long)slotLength {
+    return [[[NSFileManager defaultManager] attributesOfItemAtPath:self.path error:nil] fileSize] / 2;
+}
+
+- (void)testValuesPersistAcrossInstances {
+    @autoreleasepool {
+        AWSPinpointStateStore *store = [[AWSPinpointStateStore alloc] initWithPath:self.path];
+        XCTAssertNil([store dataForKey:@"a"]);
+        XCTAssertTrue([store setData:[self dataWithString:@"1"] forKey:@"a"]);
+        XCTAssertTrue([store setData:[self dataWithString:@"2"] forKey:@"b"]);
+        XCTAssertTrue([store removeDataForKey:@"b"]);
+        XCTAssertTrue([store setData:[NSData data] forKey:@"empty"]);
+    }
+
+    AWSPinpointStateStore *store = [[AWSPinpointStateStore alloc] initWithPath:self.path];
+    XCTAssertEqualObjects([store dataForKey:@"a"], [self dataWithString:@"1"]);
+    XCTAssertNil([store dataForKey:@"b"]);
+    XCTAssertEqualObjects([store dataForKey:@"empty"], [NSData data]);
+
+    [store removeAllData];
+    XCTAssertNil([[[AWSPinpointStateStore alloc] initWithPath:self.path] dataForKey:@"a"]);
+}
+
+- (void)testIdenticalWritesAreSkipped {
+    AWSPinpointStateStore *store = [[AWSPinpointStateStore alloc] initWithPath:self.path];
+    XCTAssertTrue([store setData:[self dataWithString:@"value"] forKey:@"key"]);
+    XCTAssertEqual(store.writeCount, 1);
+
+    XCTAssertFalse([store setData:[self dataWithString:@"value"] forKey:@"key"]);
+    XCTAssertFalse([store removeDataForKey:@"missing"]);
+    XCTAssertEqual(store.writeCount, 1);
+
+    XCTAssertTrue([store setData:[self dataWithString:@"other"] forKey:@"key"]);
+    XCTAssertEqual(store.writeCount, 2);
+}
+
+- (void)testInterruptedWriteKeepsPreviousState {
+    @autoreleasepool {
+        AWSPinpointStateStore *store = [[AWSPinpointStateStore alloc] initWithPath:self.path];
+        // The first write goes to slot 0 and the second to slot 1.
+        [store setData:[self dataWithString:@"first"] forKey:@"key"];
+        [store setData:[self dataWithString:@"second"] forKey:@"key"];
+    }
+    XCTAssertEqualObjects([[[AWSPinpointStateStore alloc] initWithPath:self.path] dataForKey:@"key"], [self dataWithString:@"second"]);
+
+    // A payload only partly written: the checksum no longer matches, so slot 0 is used.
+    unsigned long long slotLength = [self slotLength];
+    [self writeBytes:[self dataWithString:@"XXXX"] atOffset:slotLength + 32];
+    AWSPinpointStateStore *store = [[AWSPinpointStateStore alloc] initWithPath:self.path];
+    XCTAssertEqualObjects([store dataForKey:@"key"], [self dataWithString:@"first"]);
+
+    // The next write replaces the damaged slot and is read back.
+    [store setData:[self dataWithString:@"third"] forKey:@"key"];
+    store = nil;
+    XCTAssertEqualObjects([[[AWSPinpointStateStore alloc] initWithPath:self.path] dataForKey:@"key"], [self dataWithString:@"third"]);
+}
+
+- (void)testUnpublishedHeaderKeepsPreviousState {
+    @autoreleasepool {
+        AWSPinpointStateStore *store = [[AWSPinpointStateStore alloc] initWithPath:self.path];
+        [store setData:[self dataWithString:@"first"] forKey:@"key"];
+        [store setData:[self dataWithString:@"second"] forKey:@"key"];
+    }
+
+    // A crash before the header of slot 1 is published leaves its magic number cleared.
+    [self writeBytes:[NSMutableData dataWithLength:4] atOffset:[self slotLength]];
+    XCTAssertEqualObjects([[[AWSPinpointStateStore alloc] initWithPath:self.path] dataForKey:@"key"], [self dataWithString:@"first"]);
+
+    // With both slots damaged, the store starts empty.
+    [self writeBytes:[NSMutableData dataWithLength:4] atOffset:0];
+    XCTAssertNil([[[AWSPinpointStateStore alloc] initWithPath:self.path] dataForKey:@"key"]);
+}
+
+- (void)testLargeValuesGrowTheFile {
+    NSMutableData *largeValue = [NSMutableData dataWithLength:64 * 1024];
+    arc4random_buf([largeValue mutableBytes], [largeValue length]);
+
+    @autoreleasepool {
+        AWSPinpointStateStore *store = [[AWSPinpointStateStore alloc] initWithPath:self.path];
+        [store setData:[self dataWithString:@"small"] forKey:@"small"];
+        [store setData:largeValue forKey:@"large"];
+        [store setData:[self dataWithString:@"after"] forKey:@"small"];
+    }
+
+    AWSPinpointStateStore *store = [[AWSPinpointStateStore alloc] initWithPath:self.path];
+    XCTAssertEqualObjects([store dataForKey:@"large"], largeValue);
+    XCTAssertEqualObjects([store dataForKey:@"small"], [self dataWithString:@"after"]);
+}
+
+- (void)testMigrationFromUserDefaults {
+    NSString *suiteName = @"AWSPinpointStateStoreTests";
+    [[NSUserDefaults standardUserDefaults] removePersistentDomainForName:suiteName];
+    NSUserDefaults *userDefaults = [[NSUserDefaults alloc] initWithSuiteName:suiteName];
+    AWSPinpointSession *legacySession = [[AWSPinpointSession alloc] initWithSessionId:@"legacy-session"
+                                                                        withStartTime:[NSDate dateWithTimeIntervalSince1970:1500000000]
+                                                                         withStopTime:nil];
+    [userDefaults setObject:[NSKeyedArchiver archivedDataWithRootObject:legacySession] forKey:AWSPinpointStateStoreTestsSessionKey];
+
+    AWSPinpointStateStore *store = [[AWSPinpointStateStore alloc] initWithPath:self.path];
+    [store migrateObjectForKey:AWSPinpointStateStoreTestsSessionKey
+              fromUserDefaults:userDefaults
+                    usingBlock:^NSData *(id object) {
+                        return [[NSKeyedUnarchiver unarchiveObjectWithData:object] stateData];
+                    }];
+
+    XCTAssertNil([userDefaults objectForKey:AWSPinpointStateStoreTestsSessionKey]);
+    AWSPinpointSession *session = [AWSPinpointSession sessionWithStateData:[store dataForKey:AWSPinpointStateStoreTestsSessionKey]];
+    XCTAssertEqualObjects(session.sessionId, @"legacy-session");
+    XCTAssertEqualObjects(session.startTime, legacySession.startTime);
+    XCTAssertNil(session.stopTime);
+
+    // A value already in the store is not replaced by a stale one left in the defaults.
+    [userDefaults setObject:[NSKeyedArchiver archivedDataWithRootObject:@"stale"] forKey:AWSPinpointStateStoreTestsSessionKey];
+    [store migrateObjectForKey:AWSPinpointStateStoreTestsSessionKey
+              fromUserDefaults:userDefaults
+                    usingBlock:^NSData *(id object) {
+                        XCTFail(@"The stored value should be kept.");
+                        return nil;
+                    }];
+    XCTAssertNil([userDefaults objectForKey:AWSPinpointStateStoreTestsSessionKey]);
+    XCTAssertEqualObjects([AWSPinpointSession sessionWithStateData:[store dataForKey:AWSPinpointStateStoreTestsSessionKey]].sessionId, @"legacy-session");
+
+    [[NSUserDefaults standardUserDefaults] removePersistentDomainForName:suiteName];
+}
+
+- (void)testSessionStateRoundTrip {
+    AWSPinpointSession *paused = [[AWSPinpointSession alloc] initWithSessionId:@"abcdefgh-ijklmnop-20180101-000000000"
+                                                                 withStartTime:[NSDate dateWithTimeIntervalSince1970:1514764800.125]
+                                                                  withStopTime:[NSDate dateWithTimeIntervalSince1970:1514764900.5]];
+    AWSPinpointSession *decoded = [AWSPinpointSession sessionWithStateData:[paused stateData]];
+    XCTAssertEqualObjects(decoded.sessionId, paused.sessionId);
+    XCTAssertEqualObjects(decoded.startTime, paused.startTime);
+    XCTAssertEqualObjects(decoded.stopTime, paused.stopTime);
+
+    [paused resume];
+    XCTAssertNil([AWSPinpointSession sessionWithStateData:[paused stateData]].stopTime);
+    XCTAssertNil([AWSPinpointSession sessionWithStateData:[NSData data]]);
+}
+
+#pragma mark - Benchmarks
+
+- (AWSPinpointSession *)benchmarkSession {
+    return [[AWSPinpointSession alloc] initWithSessionId:@"abcdefgh-ijklmnop-20180101-000000000"
+                                           withStartTime:[NSDate date]
+                                            withStopTime:nil];
+}
+
+// A pause and a resume per iteration, each persisting the session the way the session client does.
+- (void)testLifecycleTransitionPerformance {
+    AWSPinpointStateStore *store = [[AWSPinpointStateStore alloc] initWithPath:self.path];
+    AWSPinpointSession *session = [self benchmarkSession];
+
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < AWSPinpointStateStoreTestsTransitionCount; i++) {
+            [session pause];
+            [store setData:[session stateData] forKey:AWSPinpointStateStoreTestsSessionKey];
+            [session resume];
+            [store setData:[session stateData] forKey:AWSPinpointStateStoreTestsSessionKey];
+        }
+    }];
+}
+
+// The same transitions persisted with NSKeyedArchiver and NSUserDefaults, as before the state store.
+- (void)testLifecycleTransitionUserDefaultsBaselinePerformance {
+    NSString *suiteName = @"AWSPinpointStateStoreTestsBaseline";
+    NSUserDefaults *userDefaults = [[NSUserDefaults alloc] initWithSuiteName:suiteName];
+    AWSPinpointSession *session = [self benchmarkSession];
+
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < AWSPinpointStateStoreTestsTransitionCount; i++) {
+            [session pause];
+            [userDefaults setObject:[NSKeyedArchiver archivedDataWithRootObject:session] forKey:AWSPinpointStateStoreTestsSessionKey];
+            [userDefaults synchronize];
+            [session resume];
+            [userDefaults setObject:[NSKeyedArchiver archivedDataWithRootObject:session] forKey:AWSPinpointStateStoreTestsSessionKey];
+            [userDefaults synchronize];
+        }
+    }];
+
+    [[NSUserDefaults standardUserDefaults] removePersistentDomainForName:suiteName];
+}
+
+@end
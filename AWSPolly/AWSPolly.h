@@ -24,4 +24,5 @@ FOUNDATION_EXPORT const unsigned char AWSPollyVersionString[];
 #import <AWSCore/AWSCore.h>
 #import "AWSPollyService.h"
 #import "AWSPollySynthesizeSpeechURLBuilder.h"
+#import "AWSPollySynthesizeSpeechStream.h"
 #import "AWSPollyEnumTranslatorUtility.h"
@@ -0,0 +1,125 @@
+//
+// Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+
+#import <Foundation/Foundation.h>
+#import <AWSCore/AWSCore.h>
+#import "AWSPollyService.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+FOUNDATION_EXPORT NSString *const AWSPollySynthesizeSpeechStreamErrorDomain;
+
+typedef NS_ENUM(NSInteger, AWSPollySynthesizeSpeechStreamErrorType) {
+    AWSPollySynthesizeSpeechStreamErrorUnknown,
+    AWSPollySynthesizeSpeechStreamErrorCancelled,
+};
+
+/**
+ Synthesizes speech for a text of any length and hands out the audio while it is still being synthesized.
+
+ The text is split at sentence boundaries, or for SSML at sentence, paragraph and break boundaries, into segments that each become one `SynthesizeSpeech` request. The first segment is a single sentence, so that audio starts as soon as possible. A few segments are synthesized at a time, and the audio of each is read as it arrives from the network rather than when the response completes. `- readChunk` returns the audio in the order of the text.
+
+ Audio that has arrived but has not been read yet is buffered up to `maximumBufferedBytes`. Beyond that, receiving is suspended until the reader catches up, and no further segments are started.
+
+ Set the properties before the first call to `- start` or `- readChunk`. Later changes have no effect.
+
+ *Objective-C*
+
+    AWSPollySynthesizeSpeechInput *input = [AWSPollySynthesizeSpeechInput new];
+    input.text = longText;
+    input.outputFormat = AWSPollyOutputFormatPcm;
+    input.voiceId = AWSPollyVoiceIdJoanna;
+
+    AWSPollySynthesizeSpeechStream *stream = [[AWSPollySynthesizeSpeechStream alloc] initWithPolly:[AWSPolly defaultPolly]
+                                                                                            request:input];
+    [[stream readChunk] continueWithBlock:^id(AWSTask<NSData *> *task) {
+        // Play task.result and read the next chunk. A nil result without an error is the end of the audio.
+        return nil;
+    }];
+ */
+@interface AWSPollySynthesizeSpeechStream : NSObject
+
+/**
+ The Polly client that synthesizes the segments.
+ */
+@property (nonatomic, readonly) AWSPolly *polly;
+
+/**
+ The maximum length of the text of a segment, in UTF-16 code units and including the SSML tags repeated in each segment. A sentence longer than this is split between words, and plain text without spaces between characters. The default is 1500.
+ */
+@property (nonatomic, assign) NSUInteger maximumSegmentLength;
+
+/**
+ The maximum number of segments synthesized at the same time. The default is 2.
+ */
+@property (nonatomic, assign) NSUInteger maximumConcurrentRequests;
+
+/**
+ The number of bytes of audio that may wait to be read before receiving is suspended. Receiving resumes when half of them have been read. The default is 256 KB.
+ */
+@property (nonatomic, assign) NSUInteger maximumBufferedBytes;
+
+/**
+ The number of bytes of audio received but not read yet.
+ */
+@property (nonatomic, readonly) NSUInteger bufferedBytes;
+
+/**
+ The number of segments the text was split into. 0 before the stream is started.
+ */
+@property (nonatomic, readonly) NSUInteger segmentCount;
+
+/**
+ Creates a stream for `request`. The text of the request is split into segments. The other parameters are the same for every segment.
+
+ @param polly   The Polly client to synthesize the segments with.
+ @param request The synthesis request. It is copied when the stream starts.
+ */
+- (instancetype)initWithPolly:(AWSPolly *)polly
+                      request:(AWSPollySynthesizeSpeechInput *)request;
+
+/**
+ Starts synthesizing the first segments without waiting for the first read. Calling it again has no effect.
+ */
+- (void)start;
+
+/**
+ Returns the next piece of audio, in the order of the text. The task's result is nil, without an error, once all the audio has been read. If synthesizing a segment fails, the audio of the segments before it is still returned, followed by the error. Reads may be issued before earlier ones complete; they complete in order. Starts the stream if it is not started.
+
+ @return A task with the next piece of audio.
+ */
+- (AWSTask<NSData *> *)readChunk;
+
+/**
+ Cancels the requests in progress. Reads that are pending or issued later fail with `AWSPollySynthesizeSpeechStreamErrorCancelled`.
+ */
+- (void)cancel;
+
+/**
+ Splits `text` the way the stream does.
+
+ @param text          The text to split.
+ @param textType      `AWSPollyTextTypeSsml` for SSML. Every segment is then a complete SSML document with the root element and the elements open at the split repeated. Anything else is plain text.
+ @param maximumLength The maximum length of a segment. See `maximumSegmentLength`.
+
+ @return The segments, in order. Segments of only white space are left out.
+ */
++ (NSArray<NSString *> *)segmentsForText:(NSString *)text
+                                textType:(AWSPollyTextType)textType
+                           maximumLength:(NSUInteger)maximumLength;
+
+@end
+
+NS_ASSUME_NONNULL_END
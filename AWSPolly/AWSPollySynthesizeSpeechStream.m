@@ -0,0 +1,691 @@
+//
+// Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+
+#import "AWSPollySynthesizeSpeechStream.h"
+
+NSString *const AWSPollySynthesizeSpeechStreamErrorDomain = @"com.amazonaws.AWSPollySynthesizeSpeechStreamErrorDomain";
+
+static NSUInteger const AWSPollySynthesizeSpeechStreamDefaultMaximumSegmentLength = 1500;
+static NSUInteger const AWSPollySynthesizeSpeechStreamDefaultMaximumConcurrentRequests = 2;
+static NSUInteger const AWSPollySynthesizeSpeechStreamDefaultMaximumBufferedBytes = 256 * 1024;
+
+// Where a segment may end. Lower levels are preferred.
+typedef NS_ENUM(NSInteger, AWSPollySegmentBoundaryLevel) {
+    AWSPollySegmentBoundaryLevelEnd = -1,
+    AWSPollySegmentBoundaryLevelSentence,
+    AWSPollySegmentBoundaryLevelWord,
+};
+
+@interface AWSPollySegmentBoundary : NSObject
+
+@property (nonatomic, assign) NSUInteger location;
+@property (nonatomic, assign) AWSPollySegmentBoundaryLevel level;
+// The start tags and names of the SSML elements open at the boundary, outermost first.
+@property (nonatomic, strong) NSArray<NSString *> *openStartTags;
+@property (nonatomic, strong) NSArray<NSString *> *openNames;
+@property (nonatomic, assign) NSUInteger openStartTagsLength;
+@property (nonatomic, assign) NSUInteger endTagsLength;
+
+@end
+
+@implementation AWSPollySegmentBoundary
+
++ (instancetype)boundaryWithLocation:(NSUInteger)location
+                               level:(AWSPollySegmentBoundaryLevel)level
+                       openStartTags:(NSArray<NSString *> *)openStartTags
+                           openNames:(NSArray<NSString *> *)openNames {
+    AWSPollySegmentBoundary *boundary = [AWSPollySegmentBoundary new];
+    boundary.location = location;
+    boundary.level = level;
+    boundary.openStartTags = openStartTags ?: @[];
+    boundary.openNames = openNames ?: @[];
+    for (NSString *startTag in boundary.openStartTags) {
+        boundary.openStartTagsLength += [startTag length];
+    }
+    for (NSString *name in boundary.openNames) {
+        // </name>
+        boundary.endTagsLength += [name length] + 3;
+    }
+    return boundary;
+}
+
+@end
+
+@interface AWSPollySynthesizeSpeechStreamSegment : NSObject
+
+@property (nonatomic, assign) NSUInteger index;
+@property (nonatomic, strong) AWSPollySynthesizeSpeechInput *request;
+@property (nonatomic, strong) NSMutableArray<NSData *> *chunks;
+@property (nonatomic, strong) NSURLSessionTask *suspendedTask;
+@property (nonatomic, assign, getter = isStarted) BOOL started;
+@property (nonatomic, assign, getter = isFinished) BOOL finished;
+@property (nonatomic, strong) NSError *error;
+
+- (BOOL)isInProgress;
+
+@end
+
+@implementation AWSPollySynthesizeSpeechStreamSegment
+
+- (BOOL)isInProgress {
+    return self.started && !self.finished && !self.error;
+}
+
+@end
+
+@interface AWSRequest()
+
+@property (nonatomic, strong) AWSNetworkingRequest *internalRequest;
+
+@end
+
+@interface AWSPollySynthesizeSpeechStream()
+
+@property (nonatomic, strong) AWSPolly *polly;
+@property (nonatomic, strong) AWSPollySynthesizeSpeechInput *request;
+@property (nonatomic, strong) NSArray<AWSPollySynthesizeSpeechStreamSegment *> *segments;
+@property (nonatomic, strong) NSMutableArray<AWSTaskCompletionSource<NSData *> *> *pendingReads;
+@property (nonatomic, assign) NSUInteger nextSegmentIndex;
+@property (nonatomic, assign) NSUInteger readSegmentIndex;
+@property (nonatomic, assign) NSUInteger activeRequestCount;
+@property (nonatomic, assign) NSUInteger bufferedBytes;
+@property (nonatomic, assign) NSUInteger bufferLimit;
+@property (nonatomic, assign) NSUInteger requestLimit;
+@property (nonatomic, assign, getter = isCancelled) BOOL cancelled;
+
+@end
+
+@implementation AWSPollySynthesizeSpeechStream
+
+- (instancetype)initWithPolly:(AWSPolly *)polly
+                      request:(AWSPollySynthesizeSpeechInput *)request {
+    if (self = [super init]) {
+        _polly = polly;
+        _request = request;
+        _maximumSegmentLength = AWSPollySynthesizeSpeechStreamDefaultMaximumSegmentLength;
+        _maximumConcurrentRequests = AWSPollySynthesizeSpeechStreamDefaultMaximumConcurrentRequests;
+        _maximumBufferedBytes = AWSPollySynthesizeSpeechStreamDefaultMaximumBufferedBytes;
+        _pendingReads = [NSMutableArray new];
+    }
+
+    return self;
+}
+
+- (void)dealloc {
+    for (AWSPollySynthesizeSpeechStreamSegment *segment in _segments) {
+        if ([segment isInProgress]) {
+            [segment.request cancel];
+        }
+    }
+}
+
+- (NSUInteger)bufferedBytes {
+    @synchronized(self) {
+        return _bufferedBytes;
+    }
+}
+
+- (NSUInteger)segmentCount {
+    @synchronized(self) {
+        return [self.segments count];
+    }
+}
+
+- (void)start {
+    @synchronized(self) {
+        if (!self.segments) {
+            NSArray<NSString *> *texts = [AWSPollySynthesizeSpeechStream segmentsForText:self.request.text
+                                                                                 textType:self.request.textType
+                                                                            maximumLength:self.maximumSegmentLength];
+            NSMutableArray<AWSPollySynthesizeSpeechStreamSegment *> *segments = [NSMutableArray new];
+            for (NSString *text in texts) {
+                [segments addObject:[self segmentWithText:text index:[segments count]]];
+            }
+            if ([segments count] == 0) {
+                // Leave it to the service to report what is wrong with the text.
+                [segments addObject:[self segmentWithText:self.request.text index:0]];
+            }
+            self.segments = segments;
+            self.bufferLimit = MAX(self.maximumBufferedBytes, 1);
+            self.requestLimit = MAX(self.maximumConcurrentRequests, 1);
+        }
+    }
+
+    [self update];
+}
+
+- (AWSTask<NSData *> *)readChunk {
+    AWSTaskCompletionSource<NSData *> *source = [AWSTaskCompletionSource taskCompletionSource];
+    @synchronized(self) {
+        [self.pendingReads addObject:source];
+    }
+    [self start];
+
+    return source.task;
+}
+
+- (void)cancel {
+    @synchronized(self) {
+        if (self.isCancelled) {
+            return;
+        }
+        self.cancelled = YES;
+        for (AWSPollySynthesizeSpeechStreamSegment *segment in self.segments) {
+            if ([segment isInProgress]) {
+                [segment.request cancel];
+            }
+            [segment.chunks removeAllObjects];
+        }
+        _bufferedBytes = 0;
+    }
+
+    [self update];
+}
+
+#pragma mark - Segments
+
+- (AWSPollySynthesizeSpeechStreamSegment *)segmentWithText:(NSString *)text index:(NSUInteger)index {
+    AWSPollySynthesizeSpeechInput *request = [AWSPollySynthesizeSpeechInput new];
+    request.lexiconNames = self.request.lexiconNames;
+    request.outputFormat = self.request.outputFormat;
+    request.sampleRate = self.request.sampleRate;
+    request.speechMarkTypes = self.request.speechMarkTypes;
+    request.text = text;
+    request.textType = self.request.textType;
+    request.voiceId = self.request.voiceId;
+
+    AWSPollySynthesizeSpeechStreamSegment *segment = [AWSPollySynthesizeSpeechStreamSegment new];
+    segment.index = index;
+    segment.request = request;
+    segment.chunks = [NSMutableArray new];
+    return segment;
+}
+
+- (void)sendRequestForSegment:(AWSPollySynthesizeSpeechStreamSegment *)segment {
+    __weak AWSPollySynthesizeSpeechStream *weakSelf = self;
+    __weak AWSPollySynthesizeSpeechStreamSegment *weakSegment = segment;
+    segment.request.dataHandler = ^(NSData *data) {
+        [weakSelf segment:weakSegment didReceiveData:data];
+    };
+    [[self.polly synthesizeSpeech:segment.request] continueWithBlock:^id(AWSTask<AWSPollySynthesizeSpeechOutput *> *task) {
+        [weakSelf segment:weakSegment didCompleteWithResult:task.result error:task.error];
+        return nil;
+    }];
+}
+
+- (void)segment:(AWSPollySynthesizeSpeechStreamSegment *)segment didReceiveData:(NSData *)data {
+    if (!segment || [data length] == 0) {
+        return;
+    }
+    @synchronized(self) {
+        if (self.isCancelled) {
+            return;
+        }
+        [segment.chunks addObject:[data copy]];
+        _bufferedBytes += [data length];
+    }
+
+    [self update];
+}
+
+- (void)segment:(AWSPollySynthesizeSpeechStreamSegment *)segment
+didCompleteWithResult:(AWSPollySynthesizeSpeechOutput *)result
+          error:(NSError *)error {
+    if (!segment) {
+        return;
+    }
+    @synchronized(self) {
+        segment.request.dataHandler = nil;
+        segment.suspendedTask = nil;
+        self.activeRequestCount--;
+        if (error) {
+            segment.error = error;
+            // The audio after a failed segment would never be read.
+            for (NSUInteger i = segment.index + 1; i < [self.segments count]; i++) {
+                if ([self.segments[i] isInProgress]) {
+                    [self.segments[i].request cancel];
+                }
+            }
+            self.nextSegmentIndex = [self.segments count];
+        } else {
+            // The audio arrives through the data handler; this only happens if it was not used.
+            if ([result.audioStream length] > 0 && !self.isCancelled) {
+                [segment.chunks addObject:result.audioStream];
+                _bufferedBytes += [result.audioStream length];
+            }
+            segment.finished = YES;
+        }
+    }
+
+    [self update];
+}
+
+#pragma mark - State
+
+// Completes the reads that can be completed, starts segments and suspends or resumes receiving. The tasks are completed
+// and the requests sent outside the lock, as both can call back into the stream.
+- (void)update {
+    NSMutableArray<dispatch_block_t> *completions = [NSMutableArray new];
+    NSMutableArray<AWSPollySynthesizeSpeechStreamSegment *> *segmentsToStart = [NSMutableArray new];
+    @synchronized(self) {
+        if (!self.segments) {
+            return;
+        }
+        [self completeReads:completions];
+        [self startSegments:segmentsToStart];
+        [self updateFlowControl];
+    }
+
+    for (dispatch_block_t completion in completions) {
+        completion();
+    }
+    for (AWSPollySynthesizeSpeechStreamSegment *segment in segmentsToStart) {
+        [self sendRequestForSegment:segment];
+    }
+}
+
+- (void)completeReads:(NSMutableArray<dispatch_block_t> *)completions {
+    while ([self.pendingReads count] > 0) {
+        AWSTaskCompletionSource<NSData *> *source = [self.pendingReads firstObject];
+        NSData *data = nil;
+        NSError *error = nil;
+        if (self.isCancelled) {
+            error = [NSError errorWithDomain:AWSPollySynthesizeSpeechStreamErrorDomain
+                                        code:AWSPollySynthesizeSpeechStreamErrorCancelled
+                                    userInfo:@{NSLocalizedDescriptionKey : @"The speech stream was cancelled."}];
+        } else if (self.readSegmentIndex < [self.segments count]) {
+            AWSPollySynthesizeSpeechStreamSegment *segment = self.segments[self.readSegmentIndex];
+            if ([segment.chunks count] > 0) {
+                data = [segment.chunks firstObject];
+                [segment.chunks removeObjectAtIndex:0];
+                _bufferedBytes -= [data length];
+            } else if (segment.error) {
+                error = segment.error;
+            } else if (segment.finished) {
+                self.readSegmentIndex++;
+                continue;
+            } else {
+                break;
+            }
+        }
+
+        [self.pendingReads removeObjectAtIndex:0];
+        [completions addObject:^{
+            if (error) {
+                source.error = error;
+            } else {
+                source.result = data;
+            }
+        }];
+    }
+}
+
+- (void)startSegments:(NSMutableArray<AWSPollySynthesizeSpeechStreamSegment *> *)segmentsToStart {
+    while (!self.isCancelled
+           && self.activeRequestCount < self.requestLimit
+           && self.nextSegmentIndex < [self.segments count]
+           && _bufferedBytes < self.bufferLimit) {
+        AWSPollySynthesizeSpeechStreamSegment *segment = self.segments[self.nextSegmentIndex];
+        self.nextSegmentIndex++;
+        self.activeRequestCount++;
+        segment.started = YES;
+        [segmentsToStart addObject:segment];
+    }
+}
+
+- (void)updateFlowControl {
+    for (NSUInteger i = self.readSegmentIndex; i < MIN(self.nextSegmentIndex, [self.segments count]); i++) {
+        AWSPollySynthesizeSpeechStreamSegment *segment = self.segments[i];
+        if (![segment isInProgress]) {
+            continue;
+        }
+        // The segment being read is never held back while it has nothing to read, or the reader would wait forever.
+        BOOL isStarving = i == self.readSegmentIndex && [segment.chunks count] == 0;
+        if (!segment.suspendedTask) {
+            NSURLSessionTask *task = segment.request.internalRequest.task;
+            if (task && _bufferedBytes >= self.bufferLimit && !isStarving) {
+                [task suspend];
+                segment.suspendedTask = task;
+            }
+        } else if (isStarving || _bufferedBytes <= self.bufferLimit / 2) {
+            [segment.suspendedTask resume];
+            segment.suspendedTask = nil;
+        }
+    }
+}
+
+#pragma mark - Splitting
+
++ (NSArray<NSString *> *)segmentsForText:(NSString *)text
+                                textType:(AWSPollyTextType)textType
+                           maximumLength:(NSUInteger)maximumLength {
+    if ([text length] == 0) {
+        return @[];
+    }
+    if (textType == AWSPollyTextTypeSsml) {
+        return [self segmentsForSSML:text maximumLength:maximumLength];
+    }
+
+    NSMutableArray<AWSPollySegmentBoundary *> *boundaries = [NSMutableArray new];
+    [self addBoundariesInText:text
+                        range:NSMakeRange(0, [text length])
+                openStartTags:nil
+                    openNames:nil
+                 skipEntities:NO
+                 toBoundaries:boundaries];
+    return [self segmentsForText:text
+                      boundaries:boundaries
+                    contentRange:NSMakeRange(0, [text length])
+                          prefix:@""
+                          suffix:@""
+                   maximumLength:maximumLength
+                 allowsHardSplit:YES];
+}
+
++ (NSArray<NSString *> *)segmentsForSSML:(NSString *)text maximumLength:(NSUInteger)maximumLength {
+    NSRange rootStartTag = [self rangeOfRootStartTagInSSML:text];
+    if (rootStartTag.location == NSNotFound) {
+        return @[text];
+    }
+    NSRange rootEndTag = [text rangeOfString:@"</speak" options:NSBackwardsSearch];
+    if (rootEndTag.location == NSNotFound || rootEndTag.location < NSMaxRange(rootStartTag)) {
+        return @[text];
+    }
+    NSRange contentRange = NSMakeRange(NSMaxRange(rootStartTag), rootEndTag.location - NSMaxRange(rootStartTag));
+
+    // Elements whose content must not be split.
+    NSSet<NSString *> *atomicNames = [NSSet setWithObjects:@"phoneme", @"say-as", @"sub", @"w", nil];
+    NSMutableArray<NSString *> *openStartTags = [NSMutableArray new];
+    NSMutableArray<NSString *> *openNames = [NSMutableArray new];
+    NSUInteger atomicDepth = 0;
+    NSMutableArray<AWSPollySegmentBoundary *> *boundaries = [NSMutableArray new];
+
+    NSUInteger location = contentRange.location;
+    NSUInteger end = NSMaxRange(contentRange);
+    while (location < end) {
+        NSRange tagStart = [text rangeOfString:@"<" options:0 range:NSMakeRange(location, end - location)];
+        NSUInteger textEnd = tagStart.location == NSNotFound ? end : tagStart.location;
+        if (textEnd > location && atomicDepth == 0) {
+            [self addBoundariesInText:text
+                                range:NSMakeRange(location, textEnd - location)
+                        openStartTags:[openStartTags copy]
+                            openNames:[openNames copy]
+                         skipEntities:YES
+                         toBoundaries:boundaries];
+        }
+        if (tagStart.location == NSNotFound) {
+            break;
+        }
+
+        location = tagStart.location;
+        NSRange remainder = NSMakeRange(location, end - location);
+        if ([text rangeOfString:@"<!--" options:NSAnchoredSearch range:remainder].location != NSNotFound
+            || [text rangeOfString:@"<![CDATA[" options:NSAnchoredSearch range:remainder].location != NSNotFound) {
+            NSString *terminator = [text characterAtIndex:location + 2] == '-' ? @"-->" : @"]]>";
+            NSRange terminatorRange = [text rangeOfString:terminator options:0 range:remainder];
+            if (terminatorRange.location == NSNotFound) {
+                break;
+            }
+            location = NSMaxRange(terminatorRange);
+            continue;
+        }
+
+        NSUInteger tagEnd = [self locationOfTagEndInText:text from:location end:end];
+        if (tagEnd == NSNotFound) {
+            break;
+        }
+        NSString *tag = [text substringWithRange:NSMakeRange(location, tagEnd + 1 - location)];
+        NSString *name = [self elementNameOfTag:tag];
+        location = tagEnd + 1;
+
+        if ([tag hasPrefix:@"</"]) {
+            NSUInteger index = [openNames indexOfObjectWithOptions:NSEnumerationReverse passingTest:^BOOL(NSString *openName, NSUInteger idx, BOOL *stop) {
+                return [openName isEqualToString:name];
+            }];
+            if (index != NSNotFound) {
+                [openNames removeObjectsInRange:NSMakeRange(index, [openNames count] - index)];
+                [openStartTags removeObjectsInRange:NSMakeRange(index, [openStartTags count] - index)];
+                atomicDepth = 0;
+                for (NSString *openName in openNames) {
+                    if ([atomicNames containsObject:openName]) {
+                        atomicDepth++;
+                    }
+                }
+            }
+            if (atomicDepth == 0 && ([name isEqualToString:@"p"] || [name isEqualToString:@"s"])) {
+                [boundaries addObject:[AWSPollySegmentBoundary boundaryWithLocation:location
+                                                                              level:AWSPollySegmentBoundaryLevelSentence
+                                                                      openStartTags:[openStartTags copy]
+                                                                          openNames:[openNames copy]]];
+            }
+        } else if ([tag hasSuffix:@"/>"]) {
+            if (atomicDepth == 0 && [name isEqualToString:@"break"]) {
+                [boundaries addObject:[AWSPollySegmentBoundary boundaryWithLocation:location
+                                                                              level:AWSPollySegmentBoundaryLevelSentence
+                                                                      openStartTags:[openStartTags copy]
+                                                                          openNames:[openNames copy]]];
+            }
+        } else if (![tag hasPrefix:@"<?"] && ![tag hasPrefix:@"<!"]) {
+            [openStartTags addObject:tag];
+            [openNames addObject:name];
+            if ([atomicNames containsObject:name]) {
+                atomicDepth++;
+            }
+        }
+    }
+
+    return [self segmentsForText:text
+                      boundaries:boundaries
+                    contentRange:contentRange
+                          prefix:[text substringToIndex:contentRange.location]
+                          suffix:[text substringFromIndex:NSMaxRange(contentRange)]
+                   maximumLength:maximumLength
+                 allowsHardSplit:NO];
+}
+
+// Sentence and word ends in a run of text.
++ (void)addBoundariesInText:(NSString *)text
+                      range:(NSRange)range
+              openStartTags:(NSArray<NSString *> *)openStartTags
+                  openNames:(NSArray<NSString *> *)openNames
+               skipEntities:(BOOL)skipEntities
+               toBoundaries:(NSMutableArray<AWSPollySegmentBoundary *> *)boundaries {
+    for (AWSPollySegmentBoundaryLevel level = AWSPollySegmentBoundaryLevelSentence; level <= AWSPollySegmentBoundaryLevelWord; level++) {
+        NSStringEnumerationOptions options = level == AWSPollySegmentBoundaryLevelSentence ? NSStringEnumerationBySentences : NSStringEnumerationByWords;
+        [text enumerateSubstringsInRange:range
+                                 options:options | NSStringEnumerationSubstringNotRequired
+                              usingBlock:^(NSString *substring, NSRange substringRange, NSRange enclosingRange, BOOL *stopEnumeration) {
+                                  NSUInteger location = NSMaxRange(enclosingRange);
+                                  if (location <= range.location || location > NSMaxRange(range)) {
+                                      return;
+                                  }
+                                  if (skipEntities) {
+                                      // Not inside a character reference such as &amp;
+                                      NSRange before = NSMakeRange(range.location, location - range.location);
+                                      NSRange ampersand = [text rangeOfString:@"&" options:NSBackwardsSearch range:before];
+                                      if (ampersand.location != NSNotFound
+                                          && [text rangeOfString:@";" options:0 range:NSMakeRange(ampersand.location, location - ampersand.location)].location == NSNotFound) {
+                                          return;
+                                      }
+                                  }
+                                  [boundaries addObject:[AWSPollySegmentBoundary boundaryWithLocation:location
+                                                                                                level:level
+                                                                                        openStartTags:openStartTags
+                                                                                            openNames:openNames]];
+                              }];
+    }
+}
+
+// Packs the content into segments of at most `maximumLength`, ending each at the lowest-level boundary that fits and,
+// among those, the last one. The first segment ends at the first sentence end.
++ (NSArray<NSString *> *)segmentsForText:(NSString *)text
+                              boundaries:(NSMutableArray<AWSPollySegmentBoundary *> *)boundaries
+                            contentRange:(NSRange)contentRange
+                                  prefix:(NSString *)prefix
+                                  suffix:(NSString *)suffix
+                           maximumLength:(NSUInteger)maximumLength
+                         allowsHardSplit:(BOOL)allowsHardSplit {
+    [boundaries sortUsingComparator:^NSComparisonResult(AWSPollySegmentBoundary *boundary1, AWSPollySegmentBoundary *boundary2) {
+        if (boundary1.location != boundary2.location) {
+            return boundary1.location < boundary2.location ? NSOrderedAscending : NSOrderedDescending;
+        }
+        if (boundary1.level != boundary2.level) {
+            return boundary1.level < boundary2.level ? NSOrderedAscending : NSOrderedDescending;
+        }
+        return NSOrderedSame;
+    }];
+
+    NSMutableArray<AWSPollySegmentBoundary *> *candidates = [NSMutableArray new];
+    [candidates addObject:[AWSPollySegmentBoundary boundaryWithLocation:contentRange.location
+                                                                  level:AWSPollySegmentBoundaryLevelEnd
+                                                          openStartTags:nil
+                                                              openNames:nil]];
+    for (AWSPollySegmentBoundary *boundary in boundaries) {
+        if (boundary.location > [candidates lastObject].location && boundary.location < NSMaxRange(contentRange)) {
+            [candidates addObject:boundary];
+        }
+    }
+    [candidates addObject:[AWSPollySegmentBoundary boundaryWithLocation:NSMaxRange(contentRange)
+                                                                  level:AWSPollySegmentBoundaryLevelEnd
+                                                          openStartTags:nil
+                                                              openNames:nil]];
+
+    NSUInteger fixedLength = [prefix length] + [suffix length];
+    NSMutableArray<NSString *> *segments = [NSMutableArray new];
+    AWSPollySegmentBoundary *start = [candidates firstObject];
+    NSUInteger nextIndex = 1;
+    BOOL isFirstSegment = YES;
+    while (start.location < NSMaxRange(contentRange)) {
+        AWSPollySegmentBoundary *end = nil;
+        NSUInteger endIndex = nextIndex;
+        for (NSUInteger i = nextIndex; i < [candidates count]; i++) {
+            AWSPollySegmentBoundary *candidate = candidates[i];
+            NSUInteger length = fixedLength + start.openStartTagsLength + (candidate.location - start.location) + candidate.endTagsLength;
+            if (length > maximumLength) {
+                break;
+            }
+            if (!end || candidate.level <= end.level) {
+                end = candidate;
+                endIndex = i;
+            }
+            if (isFirstSegment && end.level <= AWSPollySegmentBoundaryLevelSentence) {
+                break;
+            }
+        }
+
+        if (!end) {
+            if (allowsHardSplit) {
+                // Plain text without a boundary that fits is split between characters.
+                NSUInteger location = [text rangeOfComposedCharacterSequenceAtIndex:start.location + maximumLength].location;
+                if (location <= start.location) {
+                    location = NSMaxRange([text rangeOfComposedCharacterSequenceAtIndex:start.location]);
+                }
+                end = [AWSPollySegmentBoundary boundaryWithLocation:location
+                                                              level:AWSPollySegmentBoundaryLevelWord
+                                                      openStartTags:nil
+                                                          openNames:nil];
+                endIndex = nextIndex - 1;
+            } else {
+                // Left for the service to reject as too long.
+                end = candidates[nextIndex];
+                endIndex = nextIndex;
+            }
+        }
+
+        NSString *content = [text substringWithRange:NSMakeRange(start.location, end.location - start.location)];
+        if ([[content stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]] length] > 0) {
+            NSMutableString *segment = [NSMutableString stringWithString:prefix];
+            for (NSString *startTag in start.openStartTags) {
+                [segment appendString:startTag];
+            }
+            [segment appendString:content];
+            for (NSString *name in [end.openNames reverseObjectEnumerator]) {
+                [segment appendFormat:@"</%@>", name];
+            }
+            [segment appendString:suffix];
+            [segments addObject:segment];
+            isFirstSegment = NO;
+        }
+
+        start = end;
+        nextIndex = endIndex + 1;
+    }
+
+    return segments;
+}
+
+// The `<speak>` start tag, after an optional XML declaration and comments.
++ (NSRange)rangeOfRootStartTagInSSML:(NSString *)text {
+    NSUInteger length = [text length];
+    NSUInteger location = 0;
+    while (location < length) {
+        if ([[NSCharacterSet whitespaceAndNewlineCharacterSet] characterIsMember:[text characterAtIndex:location]]) {
+            location++;
+            continue;
+        }
+        NSRange remainder = NSMakeRange(location, length - location);
+        if ([text rangeOfString:@"<?" options:NSAnchoredSearch range:remainder].location != NSNotFound
+            || [text rangeOfString:@"<!--" options:NSAnchoredSearch range:remainder].location != NSNotFound) {
+            NSString *terminator = [text characterAtIndex:location + 1] == '?' ? @"?>" : @"-->";
+            NSRange terminatorRange = [text rangeOfString:terminator options:0 range:remainder];
+            if (terminatorRange.location == NSNotFound) {
+                break;
+            }
+            location = NSMaxRange(terminatorRange);
+            continue;
+        }
+        if ([text rangeOfString:@"<speak" options:NSAnchoredSearch range:remainder].location == NSNotFound) {
+            break;
+        }
+        NSUInteger tagEnd = [self locationOfTagEndInText:text from:location end:length];
+        if (tagEnd == NSNotFound
+            || ![[self elementNameOfTag:[text substringWithRange:NSMakeRange(location, tagEnd + 1 - location)]] isEqualToString:@"speak"]
+            || [text characterAtIndex:tagEnd - 1] == '/') {
+            break;
+        }
+        return NSMakeRange(location, tagEnd + 1 - location);
+    }
+
+    return NSMakeRange(NSNotFound, 0);
+}
+
+// The `>` that ends the tag starting at `location`, skipping quoted attribute values.
++ (NSUInteger)locationOfTagEndInText:(NSString *)text from:(NSUInteger)location end:(NSUInteger)end {
+    unichar quote = 0;
+    for (NSUInteger i = location + 1; i < end; i++) {
+        unichar character = [text characterAtIndex:i];
+        if (quote) {
+            if (character == quote) {
+                quote = 0;
+            }
+        } else if (character == '"' || character == '\'') {
+            quote = character;
+        } else if (character == '>') {
+            return i;
+        }
+    }
+
+    return NSNotFound;
+}
+
++ (NSString *)elementNameOfTag:(NSString *)tag {
+    NSUInteger start = [tag hasPrefix:@"</"] ? 2 : 1;
+    NSCharacterSet *terminators = [NSCharacterSet characterSetWithCharactersInString:@" \t\r\n/>"];
+    NSRange terminator = [tag rangeOfCharacterFromSet:terminators options:0 range:NSMakeRange(start, [tag length] - start)];
+    NSUInteger end = terminator.location == NSNotFound ? [tag length] : terminator.location;
+    return [tag substringWithRange:NSMakeRange(start, end - start)];
+}
+
+@end
@@ -0,0 +1,346 @@
+//
+// Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+
+#import <XCTest/XCTest.h>
+#import "AWSPollyService.h"
+#import "AWSPollySynthesizeSpeechStream.h"
+#import "AWSTestHTTPServer.h"
+
+static NSString *const AWSPollySynthesizeSpeechStreamTestsKey = @"AWSPollySynthesizeSpeechStreamTests";
+
+// The audio the stub synthesizes for a text: its UTF-8 bytes repeated to the given length.
+static NSData *AWSPollySynthesizeSpeechStreamTestsAudio(NSString *text, NSUInteger length) {
+    NSData *seed = [text dataUsingEncoding:NSUTF8StringEncoding];
+    NSMutableData *audio = [NSMutableData dataWithCapacity:length];
+    while ([audio length] < length && [seed length] > 0) {
+        [audio appendData:seed];
+    }
+    [audio setLength:length];
+    return audio;
+}
+
+@interface AWSPollySynthesizeSpeechStreamTests : XCTestCase
+
+@property (nonatomic, strong) AWSTestHTTPServer *server;
+@property (nonatomic, strong) AWSPolly *polly;
+
+@end
+
+@implementation AWSPollySynthesizeSpeechStreamTests
+
+- (void)setUp {
+    [super setUp];
+    self.server = [AWSTestHTTPServer new];
+    XCTAssertTrue([self.server start]);
+
+    AWSStaticCredentialsProvider *credentialsProvider = [[AWSStaticCredentialsProvider alloc] initWithAccessKey:@"accessKey"
+                                                                                                      secretKey:@"secretKey"];
+    AWSServiceConfiguration *configuration = [[AWSServiceConfiguration alloc] initWithRegion:AWSRegionUSEast1
+                                                                                    endpoint:[[AWSEndpoint alloc] initWithURL:self.server.URL]
+                                                                         credentialsProvider:credentialsProvider];
+    [AWSPolly registerPollyWithConfiguration:configuration forKey:AWSPollySynthesizeSpeechStreamTestsKey];
+    self.polly = [AWSPolly PollyForKey:AWSPollySynthesizeSpeechStreamTestsKey];
+}
+
+- (void)tearDown {
+    self.server.responseHandler = nil;
+    [AWSPolly removePollyForKey:AWSPollySynthesizeSpeechStreamTestsKey];
+    [self.server stop];
+    [super tearDown];
+}
+
+- (NSString *)longText {
+    NSMutableString *text = [NSMutableString new];
+    for (NSUInteger i = 0; i < 40; i++) {
+        [text appendFormat:@"This is sentence number %lu of the long text. ", (unsigned long)i];
+    }
+    return text;
+}
+
+- (AWSPollySynthesizeSpeechStream *)streamForText:(NSString *)text textType:(AWSPollyTextType)textType {
+    AWSPollySynthesizeSpeechInput *request = [AWSPollySynthesizeSpeechInput new];
+    request.text = text;
+    request.textType = textType;
+    request.outputFormat = AWSPollyOutputFormatPcm;
+    request.voiceId = AWSPollyVoiceIdJoanna;
+    return [[AWSPollySynthesizeSpeechStream alloc] initWithPolly:self.polly request:request];
+}
+
+- (AWSTestHTTPResponse *)audioResponse {
+    AWSTestHTTPResponse *response = [AWSTestHTTPResponse responseWithStatus:@"200 OK"
+                                                                    headers:@{@"Content-Type" : @"audio/pcm"}
+                                                                       body:nil];
+    response.chunked = YES;
+    response.chunkSize = 4 * 1024;
+    return response;
+}
+
+- (NSString *)textOfRequestBody:(NSData *)body {
+    NSDictionary *JSONObject = [NSJSONSerialization JSONObjectWithData:body options:0 error:nil];
+    return JSONObject[@"Text"];
+}
+
+// Reads the stream to the end, calling `chunkHandler` for every chunk.
+- (AWSTask *)readStream:(AWSPollySynthesizeSpeechStream *)stream
+                   into:(NSMutableData *)audio
+           chunkHandler:(void (^)(NSData *chunk))chunkHandler {
+    return [[stream readChunk] continueWithSuccessBlock:^id(AWSTask<NSData *> *task) {
+        if (!task.result) {
+            return nil;
+        }
+        [audio appendData:task.result];
+        if (chunkHandler) {
+            chunkHandler(task.result);
+        }
+        return [self readStream:stream into:audio chunkHandler:chunkHandler];
+    }];
+}
+
+#pragma mark - Splitting
+
+- (void)testSegmentsForPlainText {
+    NSString *text = [self longText];
+    NSArray<NSString *> *segments = [AWSPollySynthesizeSpeechStream segmentsForText:text
+                                                                           textType:AWSPollyTextTypeText
+                                                                      maximumLength:300];
+    XCTAssertGreaterThan([segments count], 2);
+    XCTAssertEqualObjects([segments componentsJoinedByString:@""], text);
+    // The first segment is the first sentence.
+    XCTAssertEqualObjects(segments[0], @"This is sentence number 0 of the long text. ");
+    for (NSString *segment in segments) {
+        XCTAssertLessThanOrEqual([segment length], 300);
+        XCTAssertTrue([segment hasSuffix:@"text. "], @"%@", segment);
+    }
+
+    XCTAssertEqualObjects([AWSPollySynthesizeSpeechStream segmentsForText:@"Short." textType:AWSPollyTextTypeText maximumLength:300], @[@"Short."]);
+    XCTAssertEqualObjects([AWSPollySynthesizeSpeechStream segmentsForText:@"" textType:AWSPollyTextTypeText maximumLength:300], @[]);
+}
+
+- (void)testSegmentsForLongSentence {
+    NSString *sentence = [[@"" stringByPaddingToLength:1000 withString:@"word " startingAtIndex:0] stringByAppendingString:@"end."];
+    NSArray<NSString *> *segments = [AWSPollySynthesizeSpeechStream segmentsForText:sentence
+                                                                           textType:AWSPollyTextTypeText
+                                                                      maximumLength:100];
+    XCTAssertEqualObjects([segments componentsJoinedByString:@""], sentence);
+    for (NSString *segment in segments) {
+        XCTAssertLessThanOrEqual([segment length], 100);
+        XCTAssertTrue([segment hasSuffix:@" "] || segment == [segments lastObject], @"%@", segment);
+    }
+
+    // Without spaces, between characters, but not inside one.
+    NSString *emoji = [@"" stringByPaddingToLength:200 withString:@"\U0001F600" startingAtIndex:0];
+    segments = [AWSPollySynthesizeSpeechStream segmentsForText:emoji textType:AWSPollyTextTypeText maximumLength:51];
+    XCTAssertEqualObjects([segments componentsJoinedByString:@""], emoji);
+    for (NSString *segment in segments) {
+        XCTAssertLessThanOrEqual([segment length], 51);
+        XCTAssertEqual([segment length] % 2, 0);
+    }
+}
+
+- (void)testSegmentsForSSML {
+    NSString *ssml = @"<?xml version=\"1.0\"?>\n<speak xml:lang=\"en-US\">"
+                     @"<p>First paragraph. It has two sentences.</p>"
+                     @"<prosody rate=\"slow\">Slow speech goes on. And on for a while. Until it ends.</prosody>"
+                     @"<break time=\"1s\"/>"
+                     @"<p>Call <say-as interpret-as=\"telephone\">555. 0100. 2222.</say-as> now. Ben &amp; Jerry's. Done.</p>"
+                     @"</speak>";
+    NSArray<NSString *> *segments = [AWSPollySynthesizeSpeechStream segmentsForText:ssml
+                                                                           textType:AWSPollyTextTypeSsml
+                                                                      maximumLength:140];
+    XCTAssertGreaterThan([segments count], 3);
+    NSMutableString *spoken = [NSMutableString new];
+    for (NSString *segment in segments) {
+        XCTAssertLessThanOrEqual([segment length], 140, @"%@", segment);
+        XCTAssertTrue([segment hasPrefix:@"<?xml version=\"1.0\"?>\n<speak xml:lang=\"en-US\">"], @"%@", segment);
+        XCTAssertTrue([segment hasSuffix:@"</speak>"], @"%@", segment);
+        NSXMLParser *parser = [[NSXMLParser alloc] initWithData:[segment dataUsingEncoding:NSUTF8StringEncoding]];
+        XCTAssertTrue([parser parse], @"%@", segment);
+        [spoken appendString:segment];
+    }
+    XCTAssertEqualObjects(segments[0], @"<?xml version=\"1.0\"?>\n<speak xml:lang=\"en-US\"><p>First paragraph. </p></speak>");
+    // Elements open at a split are closed and opened again.
+    XCTAssertTrue([spoken containsString:@"</prosody></speak>"]);
+    XCTAssertTrue([spoken containsString:@"<speak xml:lang=\"en-US\"><prosody rate=\"slow\">"]);
+    // The content of say-as and character references are never split.
+    XCTAssertTrue([spoken containsString:@"<say-as interpret-as=\"telephone\">555. 0100. 2222.</say-as>"]);
+    XCTAssertTrue([spoken containsString:@"&amp;"]);
+
+    // Not an SSML document: left as it is.
+    XCTAssertEqualObjects([AWSPollySynthesizeSpeechStream segmentsForText:@"No root. Second." textType:AWSPollyTextTypeSsml maximumLength:5],
+                          @[@"No root. Second."]);
+}
+
+#pragma mark - Streaming
+
+- (void)testStreamDeliversAudioInOrder {
+    NSUInteger audioLength = 48 * 1024;
+    // Every other segment is answered late, so segments complete out of order.
+    __block NSUInteger requestIndex = 0;
+    self.server.responseHandler = ^AWSTestHTTPResponse *(AWSTestHTTPRequest *request) {
+        AWSTestHTTPResponse *response = [self audioResponse];
+        NSUInteger index = 0;
+        @synchronized(self) {
+            index = requestIndex++;
+        }
+        response.headerDelay = index % 2 == 0 ? 0.2 : 0.0;
+        response.chunkDelay = 0.005;
+        response.body = AWSPollySynthesizeSpeechStreamTestsAudio([self textOfRequestBody:request.body], audioLength);
+        return response;
+    };
+
+    NSString *text = [self longText];
+    AWSPollySynthesizeSpeechStream *stream = [self streamForText:text textType:AWSPollyTextTypeText];
+    stream.maximumSegmentLength = 400;
+    stream.maximumConcurrentRequests = 4;
+    stream.maximumBufferedBytes = 1024 * 1024;
+
+    NSMutableData *audio = [NSMutableData new];
+    AWSTask *task = [self readStream:stream into:audio chunkHandler:nil];
+    [task waitUntilFinished];
+    XCTAssertNil(task.error);
+
+    NSArray<NSString *> *segments = [AWSPollySynthesizeSpeechStream segmentsForText:text textType:AWSPollyTextTypeText maximumLength:400];
+    NSMutableData *expected = [NSMutableData new];
+    for (NSString *segment in segments) {
+        [expected appendData:AWSPollySynthesizeSpeechStreamTestsAudio(segment, audioLength)];
+    }
+    XCTAssertEqual(stream.segmentCount, [segments count]);
+    XCTAssertEqual([self.server.requestLog count], [segments count]);
+    XCTAssertEqualObjects(audio, expected);
+    XCTAssertEqual(stream.bufferedBytes, 0);
+}
+
+- (void)testFirstAudioArrivesBeforeSynthesisCompletes {
+    NSUInteger chunkCount = 20;
+    NSTimeInterval chunkDelay = 0.05;
+    self.server.responseHandler = ^AWSTestHTTPResponse *(AWSTestHTTPRequest *request) {
+        AWSTestHTTPResponse *response = [self audioResponse];
+        response.chunkSize = 1024;
+        response.chunkDelay = chunkDelay;
+        response.body = AWSPollySynthesizeSpeechStreamTestsAudio([self textOfRequestBody:request.body], chunkCount * 1024);
+        return response;
+    };
+
+    // Buffered: the audio is there only when the whole response is.
+    AWSPollySynthesizeSpeechInput *request = [AWSPollySynthesizeSpeechInput new];
+    request.text = @"One sentence.";
+    request.outputFormat = AWSPollyOutputFormatPcm;
+    request.voiceId = AWSPollyVoiceIdJoanna;
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    AWSTask<AWSPollySynthesizeSpeechOutput *> *synthesizeTask = [self.polly synthesizeSpeech:request];
+    [synthesizeTask waitUntilFinished];
+    NSTimeInterval bufferedTime = CFAbsoluteTimeGetCurrent() - startTime;
+    XCTAssertNil(synthesizeTask.error);
+    XCTAssertEqual([synthesizeTask.result.audioStream length], chunkCount * 1024);
+
+    AWSPollySynthesizeSpeechStream *stream = [self streamForText:@"One sentence." textType:AWSPollyTextTypeText];
+    startTime = CFAbsoluteTimeGetCurrent();
+    AWSTask<NSData *> *readTask = [stream readChunk];
+    [readTask waitUntilFinished];
+    NSTimeInterval firstAudioTime = CFAbsoluteTimeGetCurrent() - startTime;
+    XCTAssertNil(readTask.error);
+    XCTAssertGreaterThan([readTask.result length], 0);
+
+    XCTAssertGreaterThan(bufferedTime, chunkCount * chunkDelay);
+    XCTAssertLessThan(firstAudioTime, bufferedTime / 4);
+    [stream cancel];
+}
+
+- (void)testBackPressure {
+    NSUInteger audioLength = 2 * 1024 * 1024;
+    self.server.responseHandler = ^AWSTestHTTPResponse *(AWSTestHTTPRequest *request) {
+        AWSTestHTTPResponse *response = [self audioResponse];
+        response.chunkSize = 16 * 1024;
+        response.body = AWSPollySynthesizeSpeechStreamTestsAudio([self textOfRequestBody:request.body], audioLength);
+        return response;
+    };
+
+    AWSPollySynthesizeSpeechStream *stream = [self streamForText:@"First sentence. Second sentence. Third sentence." textType:AWSPollyTextTypeText];
+    stream.maximumSegmentLength = 20;
+    stream.maximumBufferedBytes = 64 * 1024;
+    stream.maximumConcurrentRequests = 3;
+
+    __block NSUInteger peakBufferedBytes = 0;
+    NSMutableData *audio = [NSMutableData new];
+    AWSTask *task = [self readStream:stream into:audio chunkHandler:^(NSData *chunk) {
+        // A slow reader.
+        [NSThread sleepForTimeInterval:0.001];
+        peakBufferedBytes = MAX(peakBufferedBytes, stream.bufferedBytes);
+    }];
+    [task waitUntilFinished];
+    XCTAssertNil(task.error);
+    XCTAssertEqual([audio length], 3 * audioLength);
+    // Receiving stops at the limit, give or take what was already on its way.
+    XCTAssertLessThan(peakBufferedBytes, 64 * 1024 + 512 * 1024);
+}
+
+- (void)testFailedSegment {
+    self.server.responseHandler = ^AWSTestHTTPResponse *(AWSTestHTTPRequest *request) {
+        AWSTestHTTPResponse *response = [self audioResponse];
+        NSString *text = [self textOfRequestBody:request.body];
+        if ([text hasPrefix:@"This is sentence number 2 "]) {
+            response.status = @"400 Bad Request";
+            response.headers = @{@"Content-Type" : @"application/json",
+                                 @"x-amzn-ErrorType" : @"TextLengthExceededException:"};
+            response.body = [@"{\"message\":\"Too long\"}" dataUsingEncoding:NSUTF8StringEncoding];
+        } else {
+            response.body = AWSPollySynthesizeSpeechStreamTestsAudio(text, 1024);
+        }
+        return response;
+    };
+
+    AWSPollySynthesizeSpeechStream *stream = [self streamForText:[self longText] textType:AWSPollyTextTypeText];
+    stream.maximumSegmentLength = 50;
+
+    NSMutableData *audio = [NSMutableData new];
+    AWSTask *task = [self readStream:stream into:audio chunkHandler:nil];
+    [task waitUntilFinished];
+    XCTAssertEqualObjects(task.error.domain, AWSPollyErrorDomain);
+    XCTAssertEqual(task.error.code, AWSPollyErrorTextLengthExceeded);
+    // The audio of the two segments before the failed one.
+    XCTAssertEqual([audio length], 2 * 1024);
+    XCTAssertLessThan([self.server.requestLog count], stream.segmentCount);
+}
+
+- (void)testCancel {
+    self.server.responseHandler = ^AWSTestHTTPResponse *(AWSTestHTTPRequest *request) {
+        AWSTestHTTPResponse *response = [self audioResponse];
+        response.chunkSize = 1024;
+        response.chunkDelay = 0.05;
+        response.body = AWSPollySynthesizeSpeechStreamTestsAudio([self textOfRequestBody:request.body], 64 * 1024);
+        return response;
+    };
+
+    AWSPollySynthesizeSpeechStream *stream = [self streamForText:[self longText] textType:AWSPollyTextTypeText];
+    AWSTask<NSData *> *firstTask = [stream readChunk];
+    [firstTask waitUntilFinished];
+    XCTAssertNotNil(firstTask.result);
+
+    AWSTask<NSData *> *pendingTask = nil;
+    do {
+        pendingTask = [stream readChunk];
+    } while (pendingTask.completed);
+    [stream cancel];
+    [pendingTask waitUntilFinished];
+    XCTAssertEqualObjects(pendingTask.error.domain, AWSPollySynthesizeSpeechStreamErrorDomain);
+    XCTAssertEqual(pendingTask.error.code, AWSPollySynthesizeSpeechStreamErrorCancelled);
+
+    AWSTask<NSData *> *laterTask = [stream readChunk];
+    [laterTask waitUntilFinished];
+    XCTAssertEqual(laterTask.error.code, AWSPollySynthesizeSpeechStreamErrorCancelled);
+    XCTAssertEqual(stream.bufferedBytes, 0);
+}
+
+@end
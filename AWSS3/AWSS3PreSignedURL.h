@@ -46,6 +46,15 @@ typedef NS_ENUM(NSInteger, AWSS3PresignedURLErrorType) {
 
 @class AWSS3GetPreSignedURLRequest;
 
+/**
+ The block invoked once for every URL produced by a bulk pre-signing call.
+
+ @param index The position of the request or key in the input array.
+ @param URL   The pre-signed URL, or `nil` if the request at `index` is invalid.
+ @param error The validation error for the request at `index`, or `nil` on success.
+ */
+typedef void (^AWSS3PreSignedURLBuilderURLBlock)(NSUInteger index, NSURL * _Nullable URL, NSError * _Nullable error);
+
 @interface AWSS3PreSignedURLBuilder : AWSService
 
 /**
@@ -196,6 +205,35 @@ typedef NS_ENUM(NSInteger, AWSS3PresignedURLErrorType) {
  */
 - (AWSTask<NSURL *> *)getPreSignedURL:(AWSS3GetPreSignedURLRequest *)getPreSignedURLRequest;
 
+/**
+ Builds pre-signed URLs for many requests at once.
+
+ Credentials are resolved a single time for the whole batch, and every URL is signed at the same date with the same derived signing key and credential scope, so generating thousands of URLs costs little more than the hashing each one needs. The URLs are identical to the ones `- getPreSignedURL:` produces for the same requests at the same date.
+
+ `URLBlock` is called once per request, in order, on a background thread as soon as each URL is ready. An invalid request is reported through `URLBlock` and does not stop the batch. The returned task fails without calling `URLBlock` when the configuration is invalid or credentials cannot be retrieved, and completes after the last call otherwise.
+
+ @param getPreSignedURLRequests The requests to pre-sign.
+ @param URLBlock                The block that receives each URL.
+ @return A task that completes when every URL has been delivered.
+ @see AWSS3GetPreSignedURLRequest
+ */
+- (AWSTask *)getPreSignedURLs:(NSArray<AWSS3GetPreSignedURLRequest *> *)getPreSignedURLRequests
+                     URLBlock:(AWSS3PreSignedURLBuilderURLBlock)URLBlock;
+
+/**
+ Builds pre-signed URLs for many keys that share the bucket, HTTP method, expiration date, headers and parameters of a single request. The `key` of `getPreSignedURLRequest` is ignored.
+
+ This behaves like `- getPreSignedURLs:URLBlock:`, and also skips the per-request work that is the same for every key.
+
+ @param keys                   The names of the S3 objects.
+ @param getPreSignedURLRequest The request every URL is built from.
+ @param URLBlock               The block that receives the URL of each key.
+ @return A task that completes when every URL has been delivered.
+ */
+- (AWSTask *)getPreSignedURLsForKeys:(NSArray<NSString *> *)keys
+                             request:(AWSS3GetPreSignedURLRequest *)getPreSignedURLRequest
+                            URLBlock:(AWSS3PreSignedURLBuilderURLBlock)URLBlock;
+
 @end
 
 /** The GetPreSignedURLRequest contains the parameters used to create
@@ -25,13 +25,97 @@ NSString *const AWSS3PresignedURLErrorDomain = @"com.amazonaws.AWSS3PresignedURL
 
 static NSString *const AWSS3PreSignedURLBuilderAcceleratedEndpoint = @"s3-accelerate.amazonaws.com";
 
+static NSString *const AWSS3PreSignedURLBuilderUnsignedPayload = @"UNSIGNED-PAYLOAD";
+
 static NSString *const AWSInfoS3PreSignedURLBuilder = @"S3PreSignedURLBuilder";
 static NSString *const AWSS3PreSignedURLBuilderSDKVersion = @"2.6.12";
 
+static void AWSS3PreSignedURLHexEncode(const unsigned char *bytes, size_t length, char *hex) {
+    static const char AWSS3PreSignedURLHexDigits[] = "0123456789abcdef";
+    for (size_t i = 0; i < length; i++) {
+        hex[i * 2] = AWSS3PreSignedURLHexDigits[bytes[i] >> 4];
+        hex[i * 2 + 1] = AWSS3PreSignedURLHexDigits[bytes[i] & 0x0F];
+    }
+}
+
+/**
+ Everything about a SigV4 query signature that only depends on the credentials and the signing date. The string to sign is `AWS4-HMAC-SHA256\n<date>\n<scope>\n<hash of the canonical request>`, so the HMAC state after the first three lines is computed once and copied for every URL.
+ */
+@interface AWSS3PreSignedURLSigningContext : NSObject {
+    CCHmacContext _stringToSignContext;
+}
+
+@property (nonatomic, strong, readonly) NSString *amzDate;
+@property (nonatomic, strong, readonly) NSString *credentialQueryValue;
+@property (nonatomic, strong, readonly, nullable) NSString *securityTokenQueryValue;
+
+- (instancetype)initWithCredentials:(AWSCredentials *)credentials
+                            amzDate:(NSString *)amzDate
+                              scope:(NSString *)scope
+                         signingKey:(NSData *)signingKey;
+
+- (NSString *)signatureForCanonicalRequest:(NSString *)canonicalRequest;
+
+@end
+
+@implementation AWSS3PreSignedURLSigningContext
+
+- (instancetype)initWithCredentials:(AWSCredentials *)credentials
+                            amzDate:(NSString *)amzDate
+                              scope:(NSString *)scope
+                         signingKey:(NSData *)signingKey {
+    if (self = [super init]) {
+        _amzDate = amzDate;
+        //need to replace "/" with "%2F"
+        _credentialQueryValue = [[NSString stringWithFormat:@"%@/%@", credentials.accessKey, scope] stringByReplacingOccurrencesOfString:@"/"
+                                                                                                                               withString:@"\%2F"];
+        if ([credentials.sessionKey length] > 0) {
+            _securityTokenQueryValue = [credentials.sessionKey aws_stringWithURLEncoding];
+        }
+
+        NSData *stringToSignPrefix = [[NSString stringWithFormat:@"%@\n%@\n%@\n", AWSSignatureV4Algorithm, amzDate, scope] dataUsingEncoding:NSUTF8StringEncoding];
+        CCHmacInit(&_stringToSignContext, kCCHmacAlgSHA256, [signingKey bytes], [signingKey length]);
+        CCHmacUpdate(&_stringToSignContext, [stringToSignPrefix bytes], [stringToSignPrefix length]);
+    }
+
+    return self;
+}
+
+- (NSString *)signatureForCanonicalRequest:(NSString *)canonicalRequest {
+    const char *canonicalRequestBytes = [canonicalRequest UTF8String];
+    unsigned char canonicalRequestHash[CC_SHA256_DIGEST_LENGTH];
+    CC_SHA256(canonicalRequestBytes, (CC_LONG)strlen(canonicalRequestBytes), canonicalRequestHash);
+
+    char canonicalRequestHashHex[CC_SHA256_DIGEST_LENGTH * 2];
+    AWSS3PreSignedURLHexEncode(canonicalRequestHash, CC_SHA256_DIGEST_LENGTH, canonicalRequestHashHex);
+
+    CCHmacContext context = _stringToSignContext;
+    CCHmacUpdate(&context, canonicalRequestHashHex, sizeof(canonicalRequestHashHex));
+    unsigned char signature[CC_SHA256_DIGEST_LENGTH];
+    CCHmacFinal(&context, signature);
+
+    char signatureHex[CC_SHA256_DIGEST_LENGTH * 2];
+    AWSS3PreSignedURLHexEncode(signature, CC_SHA256_DIGEST_LENGTH, signatureHex);
+    return [[NSString alloc] initWithBytes:signatureHex length:sizeof(signatureHex) encoding:NSASCIIStringEncoding];
+}
+
+@end
+
 @interface AWSS3PreSignedURLBuilder()
 
 @property (nonatomic, strong) AWSServiceConfiguration *configuration;
 
+@property (nonatomic, strong) NSString *signingKeySecretKey;
+@property (nonatomic, strong) NSString *signingKeyDateStamp;
+@property (nonatomic, strong) NSData *signingKey;
+
+@end
+
+@interface AWSSignatureV4Signer()
+
++ (NSString *)getCanonicalizedQueryString:(NSString *)query;
++ (NSString *)getCanonicalizedHeaderString:(NSDictionary *)headers;
+
 @end
 
 @interface AWSServiceConfiguration()
@@ -144,6 +228,105 @@ static AWSSynchronizedMutableDictionary *_serviceClients = nil;
     return self;
 }
 
+- (NSError *)configurationError {
+    AWSEndpoint *endpoint = self.configuration.endpoint;
+
+    //validate endpoint
+    if (!endpoint) {
+        return [NSError errorWithDomain:AWSS3PresignedURLErrorDomain
+                                   code:AWSS3PresignedURLErrorEndpointIsNil
+                               userInfo:@{NSLocalizedDescriptionKey: @"endpoint in configuration can not be nil"}];
+    } else if (endpoint.serviceType != AWSServiceS3) {
+        return [NSError errorWithDomain:AWSS3PresignedURLErrorDomain
+                                   code:AWSS3PresignedURLErrorInvalidServiceType
+                               userInfo:@{NSLocalizedDescriptionKey: @"Invalid serviceType: serviceType in endpoint must be AWSServiceS3"}];
+    }
+
+    //validate credentialsProvider
+    if (!self.configuration.credentialsProvider) {
+        return [NSError errorWithDomain:AWSS3PresignedURLErrorDomain
+                                   code:AWSS3PreSignedURLErrorCredentialProviderIsNil
+                               userInfo:@{NSLocalizedDescriptionKey: @"credentialsProvider in configuration can not be nil"}];
+    }
+
+    return nil;
+}
+
+- (NSError *)errorForRequest:(AWSS3GetPreSignedURLRequest *)getPreSignedURLRequest {
+    NSString *bucketName = getPreSignedURLRequest.bucket;
+    NSDate *expires = getPreSignedURLRequest.expires;
+
+    //validate additionalParams
+    for (id key in getPreSignedURLRequest.requestParameters) {
+        id value = getPreSignedURLRequest.requestParameters[key];
+        if (![key isKindOfClass:[NSString class]]
+            || ![value isKindOfClass:[NSString class]]) {
+            return [NSError errorWithDomain:AWSS3PresignedURLErrorDomain
+                                       code:AWSS3PresignedURLErrorInvalidRequestParameters
+                                   userInfo:@{NSLocalizedDescriptionKey: @"requestParameters can only contain key-value pairs in NSString type."}];
+        }
+    }
+
+    //validate bucketName
+    if (!bucketName || [bucketName length] < 1) {
+        return [NSError errorWithDomain:AWSS3PresignedURLErrorDomain
+                                   code:AWSS3PresignedURLErrorBucketNameIsNil
+                               userInfo:@{NSLocalizedDescriptionKey: @"S3 bucket can not be nil or empty"}];
+    }
+
+    // Validates the buket name for transfer acceleration.
+    if (getPreSignedURLRequest.isAccelerateModeEnabled && ![bucketName aws_isVirtualHostedStyleCompliant]) {
+        return [NSError errorWithDomain:AWSS3PresignedURLErrorDomain
+                                   code:AWSS3PresignedURLErrorInvalidBucketNameForAccelerateModeEnabled
+                               userInfo:@{NSLocalizedDescriptionKey: @"For your bucket to work with transfer acceleration, the bucket name must conform to DNS naming requirements and must not contain periods."}];
+    }
+
+    //validate expires Date
+    if (!expires) {
+        return [NSError errorWithDomain:AWSS3PresignedURLErrorDomain
+                                   code:AWSS3PresignedURLErrorInvalidExpiresDate
+                               userInfo:@{NSLocalizedDescriptionKey: @"expires can not be nil"}];
+    } else if ([expires timeIntervalSinceNow] < 0.0) {
+        return [NSError errorWithDomain:AWSS3PresignedURLErrorDomain
+                                   code:AWSS3PresignedURLErrorInvalidExpiresDate
+                               userInfo:@{NSLocalizedDescriptionKey: @"expires can not be in past"}];
+    }
+
+    //validate httpMethod
+    switch (getPreSignedURLRequest.HTTPMethod) {
+        case AWSHTTPMethodGET:
+        case AWSHTTPMethodPUT:
+        case AWSHTTPMethodHEAD:
+        case AWSHTTPMethodDELETE:
+            return nil;
+        default:
+            return [NSError errorWithDomain:AWSS3PresignedURLErrorDomain
+                                       code:AWSS3PresignedURLErrorUnsupportedHTTPVerbs
+                                   userInfo:@{NSLocalizedDescriptionKey: @"unsupported HTTP Method, currently only support AWSHTTPMethodGET, AWSHTTPMethodPUT, AWSHTTPMethodHEAD, AWSHTTPMethodDELETE"}];
+    }
+}
+
+- (NSError *)errorForKeyName:(NSString *)keyName {
+    //validate keyName
+    if (!keyName || [keyName length] < 1) {
+        return [NSError errorWithDomain:AWSS3PresignedURLErrorDomain
+                                   code:AWSS3PresignedURLErrorKeyNameIsNil
+                               userInfo:@{NSLocalizedDescriptionKey: @"S3 key can not be nil or empty"}];
+    }
+
+    return nil;
+}
+
+- (NSError *)errorForExpireDuration:(int32_t)expireDuration {
+    if (expireDuration > 604800) {
+        return [NSError errorWithDomain:AWSS3PresignedURLErrorDomain
+                                   code:AWSS3PresignedURLErrorInvalidExpiresDate
+                               userInfo:@{NSLocalizedDescriptionKey: @"Invalid ExpiresDate, must be less than seven days in future"}];
+    }
+
+    return nil;
+}
+
 - (AWSTask<NSURL *> *)getPreSignedURL:(AWSS3GetPreSignedURLRequest *)getPreSignedURLRequest {
     //retrive parameters from request;
     NSString *bucketName = getPreSignedURLRequest.bucket;
@@ -157,89 +340,15 @@ static AWSSynchronizedMutableDictionary *_serviceClients = nil;
     NSDate *expires = getPreSignedURLRequest.expires;
 
     return [[[AWSTask taskWithResult:nil] continueWithBlock:^id(AWSTask *task) {
-
-        //validate additionalParams
-        for (id key in getPreSignedURLRequest.requestParameters) {
-            id value = getPreSignedURLRequest.requestParameters[key];
-            if (![key isKindOfClass:[NSString class]]
-                || ![value isKindOfClass:[NSString class]]) {
-                return [AWSTask taskWithError:[NSError errorWithDomain:AWSS3PresignedURLErrorDomain
-                                                                  code:AWSS3PresignedURLErrorInvalidRequestParameters
-                                                              userInfo:@{NSLocalizedDescriptionKey: @"requestParameters can only contain key-value pairs in NSString type."}]
-                        ];
-            }
-        }
-
-        //validate endpoint
-        if (!endpoint) {
-            return [AWSTask taskWithError:[NSError errorWithDomain:AWSS3PresignedURLErrorDomain
-                                                              code:AWSS3PresignedURLErrorEndpointIsNil
-                                                          userInfo:@{NSLocalizedDescriptionKey: @"endpoint in configuration can not be nil"}]
-                    ];
-        } else if (endpoint.serviceType != AWSServiceS3) {
-            return [AWSTask taskWithError:[NSError errorWithDomain:AWSS3PresignedURLErrorDomain
-                                                              code:AWSS3PresignedURLErrorInvalidServiceType
-                                                          userInfo:@{NSLocalizedDescriptionKey: @"Invalid serviceType: serviceType in endpoint must be AWSServiceS3"}]
-                    ];
-        }
-
-        //validate credentialsProvider
-        if (!credentialsProvider) {
-            return [AWSTask taskWithError:[NSError errorWithDomain:AWSS3PresignedURLErrorDomain
-                                                              code:AWSS3PreSignedURLErrorCredentialProviderIsNil
-                                                          userInfo:@{NSLocalizedDescriptionKey: @"credentialsProvider in configuration can not be nil"}]
-                    ];
+        NSError *error = [self configurationError];
+        if (!error) {
+            error = [self errorForRequest:getPreSignedURLRequest];
         }
-
-        //validate bucketName
-        if (!bucketName || [bucketName length] < 1) {
-            return [AWSTask taskWithError:[NSError errorWithDomain:AWSS3PresignedURLErrorDomain
-                                                              code:AWSS3PresignedURLErrorBucketNameIsNil
-                                                          userInfo:@{NSLocalizedDescriptionKey: @"S3 bucket can not be nil or empty"}]];
-        }
-
-        // Validates the buket name for transfer acceleration.
-        if (isAccelerateModeEnabled && ![bucketName aws_isVirtualHostedStyleCompliant]) {
-            return [AWSTask taskWithError:[NSError errorWithDomain:AWSS3PresignedURLErrorDomain
-                                                              code:AWSS3PresignedURLErrorInvalidBucketNameForAccelerateModeEnabled
-                                                          userInfo:@{
-                                                                     NSLocalizedDescriptionKey: @"For your bucket to work with transfer acceleration, the bucket name must conform to DNS naming requirements and must not contain periods."}]];
-        }
-
-        //validate keyName
-        if (!keyName || [keyName length] < 1) {
-            return [AWSTask taskWithError:[NSError errorWithDomain:AWSS3PresignedURLErrorDomain
-                                                              code:AWSS3PresignedURLErrorKeyNameIsNil
-                                                          userInfo:@{NSLocalizedDescriptionKey: @"S3 key can not be nil or empty"}]
-                    ];
-        }
-
-        //validate expires Date
-        if (!expires) {
-            return [AWSTask taskWithError:[NSError errorWithDomain:AWSS3PresignedURLErrorDomain
-                                                              code:AWSS3PresignedURLErrorInvalidExpiresDate
-                                                          userInfo:@{NSLocalizedDescriptionKey: @"expires can not be nil"}]
-                    ];
-        }else if ([expires timeIntervalSinceNow] < 0.0) {
-            return [AWSTask taskWithError:[NSError errorWithDomain:AWSS3PresignedURLErrorDomain
-                                                              code:AWSS3PresignedURLErrorInvalidExpiresDate
-                                                          userInfo:@{NSLocalizedDescriptionKey: @"expires can not be in past"}]
-                    ];
+        if (!error) {
+            error = [self errorForKeyName:keyName];
         }
-
-        //validate httpMethod
-        switch (httpMethod) {
-            case AWSHTTPMethodGET:
-            case AWSHTTPMethodPUT:
-            case AWSHTTPMethodHEAD:
-            case AWSHTTPMethodDELETE:
-                break;
-            default:
-                return [AWSTask taskWithError:[NSError errorWithDomain:AWSS3PresignedURLErrorDomain
-                                                                  code:AWSS3PresignedURLErrorUnsupportedHTTPVerbs
-                                                              userInfo:@{NSLocalizedDescriptionKey: @"unsupported HTTP Method, currently only support AWSHTTPMethodGET, AWSHTTPMethodPUT, AWSHTTPMethodHEAD, AWSHTTPMethodDELETE"}]
-                        ];
-                break;
+        if (error) {
+            return [AWSTask taskWithError:error];
         }
 
         return [[credentialsProvider credentials] continueWithSuccessBlock:^id _Nullable(AWSTask<AWSCredentials *> * _Nonnull task) {
@@ -260,27 +369,17 @@ static AWSSynchronizedMutableDictionary *_serviceClients = nil;
             keyPath = (keyName == nil ? [NSString stringWithFormat:@"%@", bucketName] : [NSString stringWithFormat:@"%@/%@", bucketName, [keyName aws_stringWithURLEncodingPath]]);
         }
 
-        //generate correct hostName (use virtualHostStyle if possible)
-        NSString *host = nil;
-        if (bucketName && [bucketName aws_isVirtualHostedStyleCompliant]) {
-            if (isAccelerateModeEnabled) {
-                host = [NSString stringWithFormat:@"%@.%@", bucketName, AWSS3PreSignedURLBuilderAcceleratedEndpoint];
-            } else {
-                host = [NSString stringWithFormat:@"%@.%@", bucketName, endpoint.hostName];
-            }
-        } else {
-            host = endpoint.hostName;
-        }
+        NSString *host = [self hostForBucketName:bucketName
+                            isVirtualHostedStyle:(bucketName && [bucketName aws_isVirtualHostedStyleCompliant])
+                         isAccelerateModeEnabled:isAccelerateModeEnabled];
         [getPreSignedURLRequest setValue:host forRequestHeader:@"host"];
         
         AWSEndpoint *newEndpoint = [[AWSEndpoint alloc]initWithRegion:configuration.regionType service:AWSServiceS3 URL:[NSURL URLWithString:[NSString stringWithFormat:@"%@://%@", endpoint.useUnsafeURL?@"http":@"https", host]]];
         
         int32_t expireDuration = [expires timeIntervalSinceNow];
-        if (expireDuration > 604800) {
-            return [AWSTask taskWithError:[NSError errorWithDomain:AWSS3PresignedURLErrorDomain
-                                                              code:AWSS3PresignedURLErrorInvalidExpiresDate
-                                                          userInfo:@{NSLocalizedDescriptionKey: @"Invalid ExpiresDate, must be less than seven days in future"}]
-                    ];
+        NSError *error = [self errorForExpireDuration:expireDuration];
+        if (error) {
+            return [AWSTask taskWithError:error];
         }
 
         return [AWSSignatureV4Signer  generateQueryStringForSignatureV4WithCredentialProvider:task.result
@@ -294,6 +393,207 @@ static AWSSynchronizedMutableDictionary *_serviceClients = nil;
     }];
 }
 
+- (AWSTask *)getPreSignedURLs:(NSArray<AWSS3GetPreSignedURLRequest *> *)getPreSignedURLRequests
+                     URLBlock:(AWSS3PreSignedURLBuilderURLBlock)URLBlock {
+    return [self getPreSignedURLsForRequests:getPreSignedURLRequests
+                                        keys:nil
+                                    URLBlock:URLBlock];
+}
+
+- (AWSTask *)getPreSignedURLsForKeys:(NSArray<NSString *> *)keys
+                             request:(AWSS3GetPreSignedURLRequest *)getPreSignedURLRequest
+                            URLBlock:(AWSS3PreSignedURLBuilderURLBlock)URLBlock {
+    return [self getPreSignedURLsForRequests:@[getPreSignedURLRequest]
+                                        keys:keys
+                                    URLBlock:URLBlock];
+}
+
+// When `keys` is set, `getPreSignedURLRequests` holds the one request every key is signed with.
+- (AWSTask *)getPreSignedURLsForRequests:(NSArray<AWSS3GetPreSignedURLRequest *> *)getPreSignedURLRequests
+                                    keys:(NSArray<NSString *> *)keys
+                                URLBlock:(AWSS3PreSignedURLBuilderURLBlock)URLBlock {
+    id<AWSCredentialsProvider>credentialsProvider = self.configuration.credentialsProvider;
+    NSUInteger count = keys ? [keys count] : [getPreSignedURLRequests count];
+
+    return [[[AWSTask taskWithResult:nil] continueWithBlock:^id(AWSTask *task) {
+        NSError *error = [self configurationError];
+        if (error) {
+            return [AWSTask taskWithError:error];
+        }
+        if (count == 0) {
+            return nil;
+        }
+
+        // The credentials have to outlive the longest-lived requirement in the batch.
+        NSTimeInterval minimumCredentialsExpirationInterval = 0;
+        for (AWSS3GetPreSignedURLRequest *getPreSignedURLRequest in getPreSignedURLRequests) {
+            minimumCredentialsExpirationInterval = MAX(minimumCredentialsExpirationInterval, getPreSignedURLRequest.minimumCredentialsExpirationInterval);
+        }
+
+        return [[credentialsProvider credentials] continueWithSuccessBlock:^id _Nullable(AWSTask<AWSCredentials *> * _Nonnull task) {
+            if ([task.result.expiration timeIntervalSinceNow] < minimumCredentialsExpirationInterval) {
+                [credentialsProvider invalidateCachedTemporaryCredentials];
+                return [credentialsProvider credentials];
+            }
+
+            return task;
+        }];
+    }] continueWithSuccessBlock:^id _Nullable(AWSTask<AWSCredentials *> * _Nonnull task) {
+        if (count == 0) {
+            return nil;
+        }
+
+        AWSS3PreSignedURLSigningContext *signingContext = [self signingContextWithCredentials:task.result
+                                                                                         date:[NSDate aws_clockSkewFixedDate]];
+
+        AWSS3GetPreSignedURLRequest *currentRequest = nil;
+        NSError *requestError = nil;
+        BOOL isVirtualHostedStyle = NO;
+        NSString *URLPrefix = nil;
+        NSString *httpMethodString = nil;
+        NSString *canonicalRequestSuffix = nil;
+        NSString *queryString = nil;
+
+        for (NSUInteger index = 0; index < count; index++) {
+            @autoreleasepool {
+                AWSS3GetPreSignedURLRequest *getPreSignedURLRequest = keys ? getPreSignedURLRequests[0] : getPreSignedURLRequests[index];
+                NSString *keyName = keys ? keys[index] : getPreSignedURLRequest.key;
+
+                // Everything but the object key is the same for every URL of a request.
+                if (getPreSignedURLRequest != currentRequest) {
+                    currentRequest = getPreSignedURLRequest;
+                    requestError = [self errorForRequest:getPreSignedURLRequest];
+                    int32_t expireDuration = [getPreSignedURLRequest.expires timeIntervalSinceNow];
+                    if (!requestError) {
+                        requestError = [self errorForExpireDuration:expireDuration];
+                    }
+                    if (!requestError) {
+                        NSString *bucketName = getPreSignedURLRequest.bucket;
+                        isVirtualHostedStyle = [bucketName aws_isVirtualHostedStyleCompliant];
+                        NSString *host = [self hostForBucketName:bucketName
+                                            isVirtualHostedStyle:isVirtualHostedStyle
+                                         isAccelerateModeEnabled:getPreSignedURLRequest.isAccelerateModeEnabled];
+                        [getPreSignedURLRequest setValue:host forRequestHeader:@"host"];
+                        URLPrefix = [NSString stringWithFormat:@"%@://%@/", self.configuration.endpoint.useUnsafeURL ? @"http" : @"https", host];
+                        httpMethodString = [NSString aws_stringWithHTTPMethod:getPreSignedURLRequest.HTTPMethod];
+
+                        NSDictionary<NSString *, NSString *> *requestHeaders = getPreSignedURLRequest.requestHeaders;
+                        NSString *signedHeaders = [AWSSignatureV4Signer getSignedHeadersString:requestHeaders];
+                        queryString = [self queryStringWithSigningContext:signingContext
+                                                           expireDuration:expireDuration
+                                                            signedHeaders:signedHeaders
+                                                        requestParameters:getPreSignedURLRequest.requestParameters];
+                        canonicalRequestSuffix = [NSString stringWithFormat:@"\n%@\n%@\n%@\n%@",
+                                                  [AWSSignatureV4Signer getCanonicalizedQueryString:queryString],
+                                                  [AWSSignatureV4Signer getCanonicalizedHeaderString:requestHeaders],
+                                                  signedHeaders,
+                                                  AWSS3PreSignedURLBuilderUnsignedPayload];
+                    }
+                }
+
+                NSError *error = requestError ?: [self errorForKeyName:keyName];
+                if (error) {
+                    URLBlock(index, nil, error);
+                    continue;
+                }
+
+                //base url is not url encoded.
+                NSString *keyPath = [keyName aws_stringWithURLEncodingPath];
+                if (!isVirtualHostedStyle) {
+                    keyPath = [NSString stringWithFormat:@"%@/%@", getPreSignedURLRequest.bucket, keyPath];
+                }
+
+                NSMutableString *canonicalRequest = [NSMutableString stringWithString:httpMethodString];
+                [canonicalRequest appendString:@"\n/"];
+                [canonicalRequest appendString:[keyPath aws_stringWithURLEncodingPath]];
+                [canonicalRequest appendString:canonicalRequestSuffix];
+
+                NSMutableString *URLString = [NSMutableString stringWithString:URLPrefix];
+                [URLString appendString:keyPath];
+                [URLString appendString:@"?"];
+                [URLString appendString:queryString];
+                [URLString appendString:@"X-Amz-Signature="];
+                [URLString appendString:[signingContext signatureForCanonicalRequest:canonicalRequest]];
+
+                URLBlock(index, [NSURL URLWithString:URLString], nil);
+            }
+        }
+
+        return nil;
+    }];
+}
+
+- (AWSS3PreSignedURLSigningContext *)signingContextWithCredentials:(AWSCredentials *)credentials
+                                                              date:(NSDate *)date {
+    AWSEndpoint *endpoint = self.configuration.endpoint;
+    NSString *dateStamp = [date aws_stringValue:AWSDateShortDateFormat1];
+
+    //Format of X-Amz-Credential : <your-access-key-id>/<date>/<AWS-region>/<AWS-service>/aws4_request.
+    NSString *scope = [NSString stringWithFormat:@"%@/%@/%@/%@",
+                       dateStamp,
+                       endpoint.regionName,
+                       endpoint.serviceName,
+                       AWSSignatureV4Terminator];
+
+    // The derived key only changes with the secret key and the day.
+    NSData *signingKey = nil;
+    @synchronized(self) {
+        if (![self.signingKeyDateStamp isEqualToString:dateStamp]
+            || ![self.signingKeySecretKey isEqualToString:credentials.secretKey]) {
+            self.signingKey = [AWSSignatureV4Signer getV4DerivedKey:credentials.secretKey
+                                                               date:dateStamp
+                                                             region:endpoint.regionName
+                                                            service:endpoint.serviceName];
+            self.signingKeyDateStamp = dateStamp;
+            self.signingKeySecretKey = credentials.secretKey;
+        }
+        signingKey = self.signingKey;
+    }
+
+    return [[AWSS3PreSignedURLSigningContext alloc] initWithCredentials:credentials
+                                                                amzDate:[date aws_stringValue:AWSDateISO8601DateFormat2]
+                                                                  scope:scope
+                                                             signingKey:signingKey];
+}
+
+- (NSString *)hostForBucketName:(NSString *)bucketName
+           isVirtualHostedStyle:(BOOL)isVirtualHostedStyle
+        isAccelerateModeEnabled:(BOOL)isAccelerateModeEnabled {
+    //generate correct hostName (use virtualHostStyle if possible)
+    if (isVirtualHostedStyle && isAccelerateModeEnabled) {
+        return [NSString stringWithFormat:@"%@.%@", bucketName, AWSS3PreSignedURLBuilderAcceleratedEndpoint];
+    }
+
+    // Custom endpoints may listen on a non-default port, which is part of the signed host header.
+    AWSEndpoint *endpoint = self.configuration.endpoint;
+    NSString *hostName = endpoint.URL.port ? [NSString stringWithFormat:@"%@:%@", endpoint.hostName, endpoint.URL.port] : endpoint.hostName;
+    if (!isVirtualHostedStyle) {
+        return hostName;
+    }
+    return [NSString stringWithFormat:@"%@.%@", bucketName, hostName];
+}
+
+// Lays the parameters out in the same order as `AWSSignatureV4Signer`, so the URLs match `- getPreSignedURL:` byte for byte. The result ends with `&`, ready for the signature.
+- (NSString *)queryStringWithSigningContext:(AWSS3PreSignedURLSigningContext *)signingContext
+                             expireDuration:(int32_t)expireDuration
+                              signedHeaders:(NSString *)signedHeaders
+                          requestParameters:(NSDictionary<NSString *, NSString *> *)requestParameters {
+    NSMutableString *queryString = [NSMutableString new];
+    [queryString appendFormat:@"%@=%@&", @"X-Amz-Algorithm", AWSSignatureV4Algorithm];
+    [queryString appendFormat:@"%@=%@&", @"X-Amz-Credential", signingContext.credentialQueryValue];
+    [queryString appendFormat:@"%@=%@&", @"X-Amz-Date", signingContext.amzDate];
+    [queryString appendFormat:@"%@=%d&", @"X-Amz-Expires", expireDuration];
+    [queryString appendFormat:@"%@=%@&", @"X-Amz-SignedHeaders", [signedHeaders aws_stringWithURLEncoding]];
+    for (NSString *key in requestParameters) {
+        [queryString appendFormat:@"%@=%@&", [key aws_stringWithURLEncoding], [requestParameters[key] aws_stringWithURLEncoding]];
+    }
+    if (signingContext.securityTokenQueryValue) {
+        [queryString appendFormat:@"%@=%@&", @"X-Amz-Security-Token", signingContext.securityTokenQueryValue];
+    }
+
+    return queryString;
+}
+
 @end
 
 @interface AWSS3GetPreSignedURLRequest ()
@@ -675,11 +675,14 @@ static AWSSynchronizedMutableDictionary *_serviceClients = nil;
     return downloadTask;
 }
 
+// Reads the keys from the disk cache's index, so objects that are not requests are never unarchived.
+- (NSArray<NSString *> *)cachedRequestKeys {
+    return [self.cache.diskCache keysForObjectsOfClasses:@[[AWSS3TransferManagerUploadRequest class],
+                                                           [AWSS3TransferManagerDownloadRequest class]]];
+}
+
 - (AWSTask *)cancelAll {
-    NSMutableArray *keys = [NSMutableArray new];
-    [self.cache.diskCache enumerateObjectsWithBlock:^(AWSTMDiskCache *cache, NSString *key, id<NSCoding> object, NSURL *fileURL) {
-        [keys addObject:key];
-    }];
+    NSArray<NSString *> *keys = [self cachedRequestKeys];
 
     NSMutableArray *tasks = [NSMutableArray new];
     for (NSString *key in keys) {
@@ -694,10 +697,7 @@ static AWSSynchronizedMutableDictionary *_serviceClients = nil;
 }
 
 - (AWSTask *)pauseAll {
-    NSMutableArray *keys = [NSMutableArray new];
-    [self.cache.diskCache enumerateObjectsWithBlock:^(AWSTMDiskCache *cache, NSString *key, id<NSCoding> object, NSURL *fileURL) {
-        [keys addObject:key];
-    }];
+    NSArray<NSString *> *keys = [self cachedRequestKeys];
 
     NSMutableArray *tasks = [NSMutableArray new];
     for (NSString *key in keys) {
@@ -712,10 +712,7 @@ static AWSSynchronizedMutableDictionary *_serviceClients = nil;
 }
 
 - (AWSTask *)resumeAll:(AWSS3TransferManagerResumeAllBlock)block {
-    NSMutableArray *keys = [NSMutableArray new];
-    [self.cache.diskCache enumerateObjectsWithBlock:^(AWSTMDiskCache *cache, NSString *key, id<NSCoding> object, NSURL *fileURL) {
-        [keys addObject:key];
-    }];
+    NSArray<NSString *> *keys = [self cachedRequestKeys];
 
     NSMutableArray *tasks = [NSMutableArray new];
     NSMutableArray *results = [NSMutableArray new];
@@ -26,7 +26,8 @@ typedef NS_ENUM(NSInteger, AWSS3TransferUtilityErrorType) {
     AWSS3TransferUtilityErrorRedirection,
     AWSS3TransferUtilityErrorClientError,
     AWSS3TransferUtilityErrorServerError,
-    AWSS3TransferUtilityErrorLocalFileNotFound
+    AWSS3TransferUtilityErrorLocalFileNotFound,
+    AWSS3TransferUtilityErrorObjectModified
 };
 
 
@@ -37,10 +38,12 @@ FOUNDATION_EXPORT NSString *const AWSS3TransferUtilityURLSessionDidBecomeInvalid
 @class AWSS3TransferUtilityUploadTask;
 @class AWSS3TransferUtilityMultiPartUploadTask;
 @class AWSS3TransferUtilityDownloadTask;
+@class AWSS3TransferUtilityMultiPartDownloadTask;
 @class AWSS3TransferUtilityExpression;
 @class AWSS3TransferUtilityUploadExpression;
 @class AWSS3TransferUtilityMultiPartUploadExpression;
 @class AWSS3TransferUtilityDownloadExpression;
+@class AWSS3TransferUtilityMultiPartDownloadExpression;
 
 
 /**
@@ -74,6 +77,17 @@ typedef void (^AWSS3TransferUtilityDownloadCompletionHandlerBlock) (AWSS3Transfe
                                                                     NSData * _Nullable data,
                                                                     NSError * _Nullable error);
 
+/**
+ The download completion handler for MultiPart.
+
+ @param task     The download task object.
+ @param location The file URL the Amazon S3 object was downloaded to. Returns `nil` when the download failed.
+ @param error    Returns the error object when the download failed. Returns `nil` on successful download.
+ */
+typedef void (^AWSS3TransferUtilityMultiPartDownloadCompletionHandlerBlock) (AWSS3TransferUtilityMultiPartDownloadTask *task,
+                                                                             NSURL * _Nullable location,
+                                                                             NSError * _Nullable error);
+
 /**
  The transfer progress feedback block.
 
@@ -94,6 +108,15 @@ typedef void (^AWSS3TransferUtilityProgressBlock) (AWSS3TransferUtilityTask *tas
 typedef void (^AWSS3TransferUtilityMultiPartProgressBlock) (AWSS3TransferUtilityMultiPartUploadTask *task,
                                                    NSProgress *progress);
 
+/**
+ The multi part download progress feedback block.
+
+ @param task                     The download task object.
+ @param progress                 The progress object.
+ */
+typedef void (^AWSS3TransferUtilityMultiPartDownloadProgressBlock) (AWSS3TransferUtilityMultiPartDownloadTask *task,
+                                                                    NSProgress *progress);
+
 
 #pragma mark - AWSS3TransferUtility
 
@@ -244,6 +267,23 @@ typedef void (^AWSS3TransferUtilityMultiPartProgressBlock) (AWSS3TransferUtility
                       transferUtilityConfiguration:(nullable AWSS3TransferUtilityConfiguration *)transferUtilityConfiguration
                                             forKey:(NSString *)key;
 
+/**
+ Creates a service client with the given service configuration and registers it for the key, then recovers the transfers that were persisted by a previous launch of the app. Multipart downloads are resumed and only fetch the ranges that had not been written to the destination file yet.
+
+ Call `- enumerateToAssignBlocksForMultiPartDownloadTask:` from the completion handler to reattach progress feedback and completion handler blocks to the recovered multipart downloads.
+
+ @warning After calling this method, do not modify the configuration object. It may cause unspecified behaviors.
+
+ @param configuration A service configuration object.
+ @param transferUtilityConfiguration An S3 transfer utility configuration object.
+ @param key           A string to identify the service client.
+ @param completionHandler The completion handler called once the persisted transfers have been recovered.
+ */
++ (void)registerS3TransferUtilityWithConfiguration:(AWSServiceConfiguration *)configuration
+                      transferUtilityConfiguration:(nullable AWSS3TransferUtilityConfiguration *)transferUtilityConfiguration
+                                            forKey:(NSString *)key
+                                 completionHandler:(nullable void (^)(NSError * _Nullable error))completionHandler;
+
 /**
  Retrieves the service client associated with the key. You need to call `+ registerS3TransferUtilityWithConfiguration:forKey:` before invoking this method.
 
@@ -504,6 +544,44 @@ handleEventsForBackgroundURLSession:(NSString *)identifier
                                                     expression:(nullable AWSS3TransferUtilityDownloadExpression *)expression
                                              completionHandler:(nullable AWSS3TransferUtilityDownloadCompletionHandlerBlock)completionHandler;
 
+/**
+ Downloads the specified Amazon S3 object from the bucket configured in `AWSS3TransferUtilityConfiguration` to a file URL using MultiPart.
+
+ The object is fetched with concurrent ranged `GET` requests which are written into a preallocated file at `fileURL`. Every range is requested with the `ETag` returned by the initial `HEAD` request, so the download fails with `AWSS3TransferUtilityErrorObjectModified` if the object changes while it is being downloaded.
+
+ @param fileURL           The file URL to download the object to.
+ @param key               The Amazon S3 object key name.
+ @param expression        The container object to configure the download request.
+ @param completionHandler The completion handler when the download completes.
+
+ @return Returns an instance of `AWSTask`. On successful initialization, `task.result` contains an instance of `AWSS3TransferUtilityMultiPartDownloadTask`.
+ */
+- (AWSTask<AWSS3TransferUtilityMultiPartDownloadTask *> *)downloadToURLUsingMultiPart:(NSURL *)fileURL
+                                                                                  key:(NSString *)key
+                                                                           expression:(nullable AWSS3TransferUtilityMultiPartDownloadExpression *)expression
+                                                                    completionHandler:(nullable AWSS3TransferUtilityMultiPartDownloadCompletionHandlerBlock)completionHandler
+                                                                    NS_SWIFT_NAME(downloadUsingMultiPart(fileURL:key:expression:completionHandler:));
+
+/**
+ Downloads the specified Amazon S3 object to a file URL using MultiPart.
+
+ The object is fetched with concurrent ranged `GET` requests which are written into a preallocated file at `fileURL`. Every range is requested with the `ETag` returned by the initial `HEAD` request, so the download fails with `AWSS3TransferUtilityErrorObjectModified` if the object changes while it is being downloaded.
+
+ @param fileURL           The file URL to download the object to.
+ @param bucket            The Amazon S3 bucket name.
+ @param key               The Amazon S3 object key name.
+ @param expression        The container object to configure the download request.
+ @param completionHandler The completion handler when the download completes.
+
+ @return Returns an instance of `AWSTask`. On successful initialization, `task.result` contains an instance of `AWSS3TransferUtilityMultiPartDownloadTask`.
+ */
+- (AWSTask<AWSS3TransferUtilityMultiPartDownloadTask *> *)downloadToURLUsingMultiPart:(NSURL *)fileURL
+                                                                               bucket:(NSString *)bucket
+                                                                                  key:(NSString *)key
+                                                                           expression:(nullable AWSS3TransferUtilityMultiPartDownloadExpression *)expression
+                                                                    completionHandler:(nullable AWSS3TransferUtilityMultiPartDownloadCompletionHandlerBlock)completionHandler
+                                                                    NS_SWIFT_NAME(downloadUsingMultiPart(fileURL:bucket:key:expression:completionHandler:));
+
 /**
  Assigns progress feedback and completion handler blocks. This method should be called when the app was suspended while the transfer is still happening.
 
@@ -534,6 +612,15 @@ handleEventsForBackgroundURLSession:(NSString *)identifier
                                                       AWSS3TransferUtilityProgressBlock _Nullable * _Nullable downloadProgressBlockReference,
                                                       AWSS3TransferUtilityDownloadCompletionHandlerBlock _Nullable * _Nullable completionHandlerReference))downloadBlocksAssigner;
 
+/**
+ Assigns progress feedback and completion handler blocks to the MultiPart downloads. This method should be called when the app was suspended while the transfer is still happening.
+
+ @param multiPartDownloadBlocksAssigner The block for assigning the multipart download progress feedback and completion handler blocks.
+ */
+- (void)enumerateToAssignBlocksForMultiPartDownloadTask:(void (^)(AWSS3TransferUtilityMultiPartDownloadTask *multiPartDownloadTask,
+                                                                  AWSS3TransferUtilityMultiPartDownloadProgressBlock _Nullable * _Nullable multiPartDownloadProgressBlockReference,
+                                                                  AWSS3TransferUtilityMultiPartDownloadCompletionHandlerBlock _Nullable * _Nullable completionHandlerReference))multiPartDownloadBlocksAssigner;
+
 /**
  Retrieves all running tasks.
  @deprecated Use `getUploadTasks:, getMultiPartUploadTasks: and getDownloadTasks:` methods instead.
@@ -562,6 +649,13 @@ handleEventsForBackgroundURLSession:(NSString *)identifier
  */
 - (AWSTask<NSArray<AWSS3TransferUtilityDownloadTask *> *> *)getDownloadTasks;
 
+/**
+ Retrieves all running MultiPart download tasks.
+
+ @return An array of `AWSS3TransferUtilityMultiPartDownloadTask`.
+ */
+- (AWSTask<NSArray<AWSS3TransferUtilityMultiPartDownloadTask *> *> *)getMultiPartDownloadTasks;
+
 @end
 
 #pragma mark - AWSS3TransferUtilityConfiguration
@@ -575,6 +669,11 @@ handleEventsForBackgroundURLSession:(NSString *)identifier
 @property NSInteger retryLimit;
 
 @property (nonatomic, nullable) NSNumber *multiPartConcurrencyLimit;
+
+/**
+ The size in bytes of the ranges requested by MultiPart downloads. The default is 5 MB.
+ */
+@property (nonatomic, nullable) NSNumber *multiPartDownloadPartSize;
 @end
 
 
@@ -699,6 +798,52 @@ handleEventsForBackgroundURLSession:(NSString *)identifier
 
 @end
 
+/**
+ The task object to represent a multipart download task.
+ */
+@interface AWSS3TransferUtilityMultiPartDownloadTask: NSObject
+
+/**
+ An identifier uniquely identifies the transferID.
+ */
+@property (readonly) NSString *transferID;
+
+/**
+ The Amazon S3 bucket name associated with the transfer.
+ */
+@property (readonly) NSString *bucket;
+
+/**
+ The Amazon S3 object key name associated with the transfer.
+ */
+@property (readonly) NSString *key;
+
+/**
+ The entity tag of the Amazon S3 object being downloaded.
+ */
+@property (nullable, readonly) NSString *eTag;
+
+/**
+ The transfer progress.
+ */
+@property (readonly) NSProgress *progress;
+
+/**
+ Cancels the task.
+ */
+- (void)cancel;
+
+/**
+ Resumes the task, if it is suspended.
+ */
+- (void)resume;
+
+/**
+ Temporarily suspends a task.
+ */
+- (void)suspend;
+@end
+
 #pragma mark - AWSS3TransferUtilityExpressions
 
 /**
@@ -797,4 +942,42 @@ handleEventsForBackgroundURLSession:(NSString *)identifier
 
 @end
 
-NS_ASSUME_NONNULL_END
\ No newline at end of file
+/**
+ The expression object for configuring a Multipart download task.
+ */
+@interface AWSS3TransferUtilityMultiPartDownloadExpression : NSObject
+
+/**
+ This NSDictionary can contains additional request headers to be included in the pre-signed URL. Default is emtpy.
+ */
+@property (nonatomic, readonly) NSDictionary<NSString *, NSString *> *requestHeaders;
+
+/**
+ This NSDictionary can contains additional request parameters to be included in the pre-signed URL. Adding additional request parameters enables more advanced pre-signed URLs, such as accessing Amazon S3's torrent resource for an object, or for specifying a version ID when accessing an object. Default is emtpy.
+ */
+@property (nonatomic, readonly) NSDictionary<NSString *, NSString *> *requestParameters;
+
+/**
+ The progress feedback block.
+ */
+@property (copy, nonatomic, nullable) AWSS3TransferUtilityMultiPartDownloadProgressBlock progressBlock;
+
+/**
+ Set an additional request header to be included in the pre-signed URL.
+
+ @param value The value of the request parameter being added. Set to nil if parameter doesn't contains value.
+ @param requestHeader The name of the request header.
+ */
+- (void)setValue:(nullable NSString *)value forRequestHeader:(NSString *)requestHeader;
+
+/**
+ Set an additional request parameter to be included in the pre-signed URL. Adding additional request parameters enables more advanced pre-signed URLs, such as accessing Amazon S3's torrent resource for an object, or for specifying a version ID when accessing an object.
+
+ @param value The value of the request parameter being added. Set to nil if parameter doesn't contains value.
+ @param requestParameter The name of the request parameter, as it appears in the URL's query string (e.g. AWSS3PresignedURLVersionID).
+ */
+- (void)setValue:(nullable NSString *)value forRequestParameter:(NSString *)requestParameter;
+
+@end
+
+NS_ASSUME_NONNULL_END
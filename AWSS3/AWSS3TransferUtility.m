@@ -22,6 +22,9 @@
 #import "AWSFMDB.h"
 #import "AWSS3TransferUtility+Validation.h"
 
+#import <fcntl.h>
+#import <unistd.h>
+
 // Public constants
 NSString *const AWSS3TransferUtilityErrorDomain = @"com.amazonaws.AWSS3TransferUtilityErrorDomain";
 NSString *const AWSS3TransferUtilityURLSessionDidBecomeInvalidNotification = @"com.amazonaws.AWSS3TransferUtility.AWSS3TransferUtilityURLSessionDidBecomeInvalidNotification";
@@ -37,6 +40,7 @@ static NSString *const AWSS3TransferUtilityRetrySucceeded = @"AWSS3TransferUtili
 static NSUInteger const AWSS3TransferUtilityMultiPartSize = 5 * 1024 * 1024;
 static NSString *const AWSS3TransferUtiltityRequestTimeoutErrorCode = @"RequestTimeout";
 static int const AWSS3TransferUtilityMultiPartDefaultConcurrencyLimit = 5;
+static NSTimeInterval const AWSS3TransferUtilityPreSignedURLRefreshInterval = 5 * 60; // 5 minutes
 
 #pragma mark - Private classes
 
@@ -58,6 +62,24 @@ static int const AWSS3TransferUtilityMultiPartDefaultConcurrencyLimit = 5;
 
 @end
 
+@interface AWSS3TransferUtilityDownloadSubTask: NSObject
+@end
+
+@interface AWSS3TransferUtilityDownloadSubTask()
+@property (strong, nonatomic) NSURLSessionTask *sessionTask;
+@property (strong, nonatomic) NSNumber *partNumber;
+@property (readwrite) NSUInteger taskIdentifier;
+@property int64_t rangeStart;
+@property int64_t totalBytesExpectedToReceive;
+@property int64_t totalBytesReceived;
+@property NSString *responseData;
+@property NSString *transferID;
+@property NSString *status;
+@property (strong, nonatomic) NSError *error;
+@property int retryCount;
+
+@end
+
 @interface AWSS3TransferUtility() <NSURLSessionDelegate, NSURLSessionTaskDelegate, NSURLSessionDataDelegate>
 
 @property (strong, nonatomic) AWSServiceConfiguration *configuration;
@@ -127,6 +149,33 @@ static int const AWSS3TransferUtilityMultiPartDefaultConcurrencyLimit = 5;
 @property NSString *responseData;
 @end
 
+@interface AWSS3TransferUtilityMultiPartDownloadTask()
+
+@property (strong, nonatomic) AWSS3TransferUtilityMultiPartDownloadExpression *expression;
+@property (strong, nonatomic) NSURL *location;
+@property (strong, nonatomic) NSURL *preSignedURL;
+@property (strong, nonatomic) NSDate *preSignedURLExpiration;
+@property BOOL cancelled;
+@property NSMutableDictionary <NSNumber *, AWSS3TransferUtilityDownloadSubTask *> *waitingPartsDictionary;
+@property (strong, nonatomic) NSMutableDictionary <NSNumber *, AWSS3TransferUtilityDownloadSubTask *> *completedPartsDictionary;
+@property (strong, nonatomic) NSMutableDictionary <NSNumber *, AWSS3TransferUtilityDownloadSubTask *> *inProgressPartsDictionary;
+@property int retryCount;
+@property int64_t partSize;
+@property NSString *file;
+@property NSString *nsURLSessionID;
+@property (strong) AWSFMDatabaseQueue *databaseQueue;
+@property (strong, nonatomic) NSError *error;
+@property (strong, nonatomic) NSString *bucket;
+@property (strong, nonatomic) NSString *key;
+@property (strong, nonatomic) NSString *transferID;
+@property (strong, nonatomic) NSString *eTag;
+@property NSString *status;
+@property NSNumber *contentLength;
+
+- (void)updateStatusForSubTask:(AWSS3TransferUtilityDownloadSubTask *)subTask;
+
+@end
+
 @interface AWSS3TransferUtilityExpression()
 
 @property (strong, nonatomic) NSMutableDictionary<NSString *, NSString *> *internalRequestHeaders;
@@ -160,6 +209,16 @@ static int const AWSS3TransferUtilityMultiPartDefaultConcurrencyLimit = 5;
 
 @end
 
+@interface AWSS3TransferUtilityMultiPartDownloadExpression()
+
+@property (strong, nonatomic) NSMutableDictionary<NSString *, NSString *> *internalRequestHeaders;
+@property (strong, nonatomic) NSMutableDictionary<NSString *, NSString *> *internalRequestParameters;
+- (void)assignRequestHeaders:(AWSS3GetPreSignedURLRequest *)getPreSignedURLRequest;
+- (void)assignRequestParameters:(AWSS3GetPreSignedURLRequest *)getPreSignedURLRequest;
+@property (copy, atomic) AWSS3TransferUtilityMultiPartDownloadCompletionHandlerBlock completionHandler;
+
+@end
+
 @interface AWSS3PreSignedURLBuilder()
 
 - (instancetype)initWithConfiguration:(AWSServiceConfiguration *)configuration;
@@ -253,6 +312,21 @@ static AWSS3TransferUtility *_defaultS3TransferUtility = nil;
                         forKey:key];
 }
 
++ (void)registerS3TransferUtilityWithConfiguration:(AWSServiceConfiguration *)configuration
+                      transferUtilityConfiguration:(AWSS3TransferUtilityConfiguration *)transferUtilityConfiguration
+                                            forKey:(NSString *)key
+                                 completionHandler:(void (^)(NSError *error))completionHandler {
+    [self registerS3TransferUtilityWithConfiguration:configuration
+                        transferUtilityConfiguration:transferUtilityConfiguration
+                                              forKey:key];
+    
+    AWSS3TransferUtility *s3TransferUtility = [_serviceClients objectForKey:key];
+    [s3TransferUtility recover:nil
+ multiPartUploadBlocksAssigner:nil
+        downloadBlocksAssigner:nil
+             completionHandler:completionHandler];
+}
+
 + (instancetype)S3TransferUtilityForKey:(NSString *)key {
     @synchronized(self) {
         AWSS3TransferUtility *serviceClient = [_serviceClients objectForKey:key];
@@ -370,6 +444,7 @@ downloadBlocksAssigner:(void (^)(AWSS3TransferUtilityDownloadTask *downloadTask,
    
     //Create temporary datastructures to hold the database records.
     NSMutableDictionary *multiPartUploads = [NSMutableDictionary new];
+    NSMutableDictionary *multiPartDownloads = [NSMutableDictionary new];
     NSMutableDictionary *transferRequests = [NSMutableDictionary new];
     
     //Get All Tasks from DB
@@ -385,7 +460,7 @@ downloadBlocksAssigner:(void (^)(AWSS3TransferUtilityDownloadTask *downloadTask,
             AWSS3TransferUtilityUploadTask *transferUtilityUploadTask = [AWSS3TransferUtilityUploadTask new];
             transferUtilityUploadTask.nsURLSessionID = self.sessionIdentifier;
             transferUtilityUploadTask.databaseQueue = self.databaseQueue;
-            transferUtilityUploadTask.bucket = [task objectForKey:@"bucket"];
+            transferUtilityUploadTask.bucket = [task objectForKey:@"bucket_name"];
             transferUtilityUploadTask.key = [task objectForKey:@"key"];
             transferUtilityUploadTask.expression = [AWSS3TransferUtilityUploadExpression new];
             transferUtilityUploadTask.expression.internalRequestHeaders = [[self getDictionaryFromJson:[task objectForKey:@"request_headers"]] mutableCopy];
@@ -419,7 +494,7 @@ downloadBlocksAssigner:(void (^)(AWSS3TransferUtilityDownloadTask *downloadTask,
             AWSS3TransferUtilityDownloadTask *transferUtilityDownloadTask = [AWSS3TransferUtilityDownloadTask new];
             transferUtilityDownloadTask.nsURLSessionID = self.sessionIdentifier;
             transferUtilityDownloadTask.databaseQueue = self.databaseQueue;
-            transferUtilityDownloadTask.bucket = [task objectForKey:@"bucket"];
+            transferUtilityDownloadTask.bucket = [task objectForKey:@"bucket_name"];
             transferUtilityDownloadTask.key = [task objectForKey:@"key"];
             transferUtilityDownloadTask.expression = [AWSS3TransferUtilityDownloadExpression new];
             transferUtilityDownloadTask.expression.internalRequestHeaders = [[self getDictionaryFromJson:[task objectForKey:@"request_headers"]] mutableCopy];
@@ -455,7 +530,7 @@ downloadBlocksAssigner:(void (^)(AWSS3TransferUtilityDownloadTask *downloadTask,
             AWSS3TransferUtilityMultiPartUploadTask *transferUtilityMultiPartUploadTask = [AWSS3TransferUtilityMultiPartUploadTask new];
             transferUtilityMultiPartUploadTask.nsURLSessionID = self.sessionIdentifier;
             transferUtilityMultiPartUploadTask.databaseQueue = self.databaseQueue;
-            transferUtilityMultiPartUploadTask.bucket = [task objectForKey:@"bucket"];
+            transferUtilityMultiPartUploadTask.bucket = [task objectForKey:@"bucket_name"];
             transferUtilityMultiPartUploadTask.key = [task objectForKey:@"key"];
             transferUtilityMultiPartUploadTask.expression = [AWSS3TransferUtilityMultiPartUploadExpression new];
             transferUtilityMultiPartUploadTask.expression.internalRequestHeaders = [[self getDictionaryFromJson:[task objectForKey:@"request_headers"]] mutableCopy];
@@ -497,6 +572,67 @@ downloadBlocksAssigner:(void (^)(AWSS3TransferUtilityDownloadTask *downloadTask,
             [transferRequests setObject:subTask forKey:@(sessionTaskID)];
           
         }
+        else if ([transferType isEqualToString:@"MULTI_PART_DOWNLOAD"]) {
+            AWSS3TransferUtilityMultiPartDownloadTask *transferUtilityMultiPartDownloadTask = [AWSS3TransferUtilityMultiPartDownloadTask new];
+            transferUtilityMultiPartDownloadTask.nsURLSessionID = self.sessionIdentifier;
+            transferUtilityMultiPartDownloadTask.databaseQueue = self.databaseQueue;
+            transferUtilityMultiPartDownloadTask.bucket = [task objectForKey:@"bucket_name"];
+            transferUtilityMultiPartDownloadTask.key = [task objectForKey:@"key"];
+            transferUtilityMultiPartDownloadTask.expression = [AWSS3TransferUtilityMultiPartDownloadExpression new];
+            transferUtilityMultiPartDownloadTask.expression.internalRequestHeaders = [[self getDictionaryFromJson:[task objectForKey:@"request_headers"]] mutableCopy];
+            transferUtilityMultiPartDownloadTask.expression.internalRequestParameters = [[self getDictionaryFromJson:[task objectForKey:@"request_parameters"]] mutableCopy];
+            transferUtilityMultiPartDownloadTask.transferID = [task objectForKey:@"transfer_id"];
+            transferUtilityMultiPartDownloadTask.file = [task objectForKey:@"file"];
+            transferUtilityMultiPartDownloadTask.location = [NSURL fileURLWithPath:transferUtilityMultiPartDownloadTask.file];
+            transferUtilityMultiPartDownloadTask.eTag = [[task objectForKey:@"etag"] length] > 0 ? [task objectForKey:@"etag"] : nil;
+            transferUtilityMultiPartDownloadTask.contentLength = [task objectForKey:@"content_length"];
+            transferUtilityMultiPartDownloadTask.progress.totalUnitCount = [transferUtilityMultiPartDownloadTask.contentLength longLongValue];
+            transferUtilityMultiPartDownloadTask.cancelled = NO;
+            transferUtilityMultiPartDownloadTask.retryCount = [[task objectForKey:@"retry_count"] intValue];
+            transferUtilityMultiPartDownloadTask.status = AWSS3TransferUtilityInProgressStatus;
+            
+            //Register the download, so that the blocks can be assigned before its ranges are requested again.
+            [multiPartDownloads setObject:transferUtilityMultiPartDownloadTask forKey:transferUtilityMultiPartDownloadTask.transferID];
+            [self.taskDictionary setObject:transferUtilityMultiPartDownloadTask forKey:transferUtilityMultiPartDownloadTask.transferID];
+        }
+        else if ([transferType isEqualToString:@"MULTI_PART_DOWNLOAD_SUB_TASK"]) {
+            AWSS3TransferUtilityMultiPartDownloadTask *transferUtilityMultiPartDownloadTask = [multiPartDownloads objectForKey:[task objectForKey:@"transfer_id"]];
+            if (!transferUtilityMultiPartDownloadTask) {
+                AWSDDLogWarn(@"MultiPart download not found for part of transfer %@. Ignoring.", [task objectForKey:@"transfer_id"]);
+                continue;
+            }
+            AWSS3TransferUtilityDownloadSubTask *subTask = [AWSS3TransferUtilityDownloadSubTask new];
+            subTask.taskIdentifier = sessionTaskID;
+            subTask.partNumber = [task objectForKey:@"part_number"];
+            subTask.status = [task objectForKey:@"status"];
+            subTask.transferID = [task objectForKey:@"transfer_id"];
+            subTask.totalBytesExpectedToReceive = [[task objectForKey:@"content_length"] longLongValue];
+            subTask.responseData = @"";
+            
+            //Rows are ordered by part number, and every part but the last one has the full part size.
+            if ([subTask.partNumber integerValue] == 1) {
+                transferUtilityMultiPartDownloadTask.partSize = subTask.totalBytesExpectedToReceive;
+            }
+            subTask.rangeStart = ([subTask.partNumber longLongValue] - 1) * transferUtilityMultiPartDownloadTask.partSize;
+            
+            //Ranges that were written to the file are not requested again.
+            if ([subTask.status isEqualToString:AWSS3TransferUtilityCompletedStatus]) {
+                subTask.totalBytesReceived = subTask.totalBytesExpectedToReceive;
+                [transferUtilityMultiPartDownloadTask.completedPartsDictionary setObject:subTask forKey:subTask.partNumber];
+                transferUtilityMultiPartDownloadTask.progress.completedUnitCount += subTask.totalBytesExpectedToReceive;
+                continue;
+            }
+            
+            if ([subTask.status isEqualToString:AWSS3TransferUtilityPausedStatus]) {
+                transferUtilityMultiPartDownloadTask.status = AWSS3TransferUtilityPausedStatus;
+            }
+            
+            //Everything else waits, unless the NSURLSession still knows about the range.
+            [transferUtilityMultiPartDownloadTask.waitingPartsDictionary setObject:subTask forKey:subTask.partNumber];
+            if (sessionTaskID != 0) {
+                [transferRequests setObject:subTask forKey:@(sessionTaskID)];
+            }
+        }
     }
     
     //Reattach to the NSURLsession objects
@@ -617,6 +753,25 @@ downloadBlocksAssigner:(void (^)(AWSS3TransferUtilityDownloadTask *downloadTask,
                     }
                 }
             }
+            else if ([[transferRequests objectForKey:@(task.taskIdentifier)] isKindOfClass:[AWSS3TransferUtilityDownloadSubTask class]]) {
+                //Found a range of a multipart download.
+                AWSS3TransferUtilityDownloadSubTask *subTask = [transferRequests objectForKey:@(task.taskIdentifier)];
+                AWSS3TransferUtilityMultiPartDownloadTask *transferUtilityMultiPartDownloadTask = [multiPartDownloads objectForKey:subTask.transferID];
+                
+                //Remove this request from the transferRequests list.
+                [transferRequests removeObjectForKey:@(task.taskIdentifier)];
+                
+                //Reattach the range if it can still finish. Otherwise it stays in the waiting list and is requested again.
+                if ([task state] == NSURLSessionTaskStateRunning || [task state] == NSURLSessionTaskStateSuspended) {
+                    subTask.sessionTask = task;
+                    [transferUtilityMultiPartDownloadTask.waitingPartsDictionary removeObjectForKey:subTask.partNumber];
+                    [transferUtilityMultiPartDownloadTask.inProgressPartsDictionary setObject:subTask forKey:@(task.taskIdentifier)];
+                    [self.taskDictionary setObject:transferUtilityMultiPartDownloadTask forKey:@(task.taskIdentifier)];
+                }
+                else {
+                    [task cancel];
+                }
+            }
             else {
                 AWSDDLogError(@"Object not found in taskDictionary for %lu",(unsigned long)task.taskIdentifier);
             }
@@ -630,7 +785,11 @@ downloadBlocksAssigner:(void (^)(AWSS3TransferUtilityDownloadTask *downloadTask,
         if (completionHandler) {
             completionHandler(nil);
         }
-                
+        
+        //Request the missing ranges of the multipart downloads, now that their blocks could be assigned.
+        for (AWSS3TransferUtilityMultiPartDownloadTask *transferUtilityMultiPartDownloadTask in [multiPartDownloads allValues]) {
+            [self resumeRecoveredMultiPartDownloadTask:transferUtilityMultiPartDownloadTask];
+        }
     }];
 }
 
@@ -1330,6 +1489,522 @@ downloadBlocksAssigner:(void (^)(AWSS3TransferUtilityDownloadTask *downloadTask,
     [self createDownloadTask:transferUtilityDownloadTask];
 }
 
+#pragma mark - MultiPart Download methods
+
+- (AWSTask<AWSS3TransferUtilityMultiPartDownloadTask *> *)downloadToURLUsingMultiPart:(NSURL *)fileURL
+                                                                                  key:(NSString *)key
+                                                                           expression:(AWSS3TransferUtilityMultiPartDownloadExpression *)expression
+                                                                    completionHandler:(AWSS3TransferUtilityMultiPartDownloadCompletionHandlerBlock)completionHandler {
+    return [self downloadToURLUsingMultiPart:fileURL
+                                      bucket:self.transferUtilityConfiguration.bucket
+                                         key:key
+                                  expression:expression
+                           completionHandler:completionHandler];
+}
+
+- (AWSTask<AWSS3TransferUtilityMultiPartDownloadTask *> *)downloadToURLUsingMultiPart:(NSURL *)fileURL
+                                                                               bucket:(NSString *)bucket
+                                                                                  key:(NSString *)key
+                                                                           expression:(AWSS3TransferUtilityMultiPartDownloadExpression *)expression
+                                                                    completionHandler:(AWSS3TransferUtilityMultiPartDownloadCompletionHandlerBlock)completionHandler {
+    //Validate that bucket has been specified.
+    if (!bucket || [bucket length] == 0) {
+        NSInteger errorCode = (self.transferUtilityConfiguration.isAccelerateModeEnabled) ?
+        AWSS3PresignedURLErrorInvalidBucketNameForAccelerateModeEnabled : AWSS3PresignedURLErrorInvalidBucketName;
+        NSString *errorMessage = @"Invalid bucket specified. Please specify a bucket name or configure the bucket property in `AWSS3TransferUtilityConfiguration`.";
+        NSDictionary *userInfo = [NSDictionary dictionaryWithObject:errorMessage
+                                                             forKey:NSLocalizedDescriptionKey];
+        
+        return [AWSTask taskWithError:[NSError errorWithDomain:AWSS3PresignedURLErrorDomain
+                                                          code:errorCode
+                                                      userInfo:userInfo]];
+    }
+    
+    //The ranges are written in place, so a file URL is required.
+    if (![fileURL isFileURL]) {
+        NSString *errorMessage = @"Invalid file URL specified. MultiPart downloads are written to a local file.";
+        NSDictionary *userInfo = [NSDictionary dictionaryWithObject:errorMessage
+                                                             forKey:NSLocalizedDescriptionKey];
+        
+        return [AWSTask taskWithError:[NSError errorWithDomain:AWSS3TransferUtilityErrorDomain
+                                                          code:AWSS3TransferUtilityErrorLocalFileNotFound
+                                                      userInfo:userInfo]];
+    }
+    
+    //Create Expression if required and set completion Handler.
+    if (!expression) {
+        expression = [AWSS3TransferUtilityMultiPartDownloadExpression new];
+    }
+    expression.completionHandler = completionHandler;
+    
+    //Create TransferUtility Multipart Download Task
+    AWSS3TransferUtilityMultiPartDownloadTask *transferUtilityMultiPartDownloadTask = [AWSS3TransferUtilityMultiPartDownloadTask new];
+    transferUtilityMultiPartDownloadTask.nsURLSessionID = self.sessionIdentifier;
+    transferUtilityMultiPartDownloadTask.databaseQueue = self.databaseQueue;
+    transferUtilityMultiPartDownloadTask.location = fileURL;
+    transferUtilityMultiPartDownloadTask.bucket = bucket;
+    transferUtilityMultiPartDownloadTask.key = key;
+    transferUtilityMultiPartDownloadTask.expression = expression;
+    transferUtilityMultiPartDownloadTask.transferID = [[NSUUID UUID] UUIDString];
+    transferUtilityMultiPartDownloadTask.file = [fileURL path];
+    transferUtilityMultiPartDownloadTask.cancelled = NO;
+    transferUtilityMultiPartDownloadTask.retryCount = 0;
+    transferUtilityMultiPartDownloadTask.status = AWSS3TransferUtilityInProgressStatus;
+    transferUtilityMultiPartDownloadTask.partSize = AWSS3TransferUtilityMultiPartSize;
+    if ([self.transferUtilityConfiguration.multiPartDownloadPartSize longLongValue] > 0) {
+        transferUtilityMultiPartDownloadTask.partSize = [self.transferUtilityConfiguration.multiPartDownloadPartSize longLongValue];
+    }
+    
+    //Get the size and the entity tag of the object. Every range is requested with If-Match on this ETag.
+    AWSS3HeadObjectRequest *headObjectRequest = [AWSS3HeadObjectRequest new];
+    headObjectRequest.bucket = bucket;
+    headObjectRequest.key = key;
+    headObjectRequest.versionId = expression.requestParameters[AWSS3PresignedURLVersionID];
+    for (NSString *requestHeader in expression.requestHeaders) {
+        NSString *lKey = [requestHeader lowercaseString];
+        if ([lKey isEqualToString:@"x-amz-server-side-encryption-customer-algorithm"]) {
+            headObjectRequest.SSECustomerAlgorithm = expression.requestHeaders[requestHeader];
+        }
+        else if ([lKey isEqualToString:@"x-amz-server-side-encryption-customer-key"]) {
+            headObjectRequest.SSECustomerKey = expression.requestHeaders[requestHeader];
+        }
+        else if ([lKey isEqualToString:@"x-amz-server-side-encryption-customer-key-md5"]) {
+            headObjectRequest.SSECustomerKeyMD5 = expression.requestHeaders[requestHeader];
+        }
+    }
+    
+    return [[self.s3 headObject:headObjectRequest] continueWithBlock:^id(AWSTask *task) {
+        if (task.error) {
+            return [AWSTask taskWithError:task.error];
+        }
+        AWSS3HeadObjectOutput *output = task.result;
+        int64_t contentLength = [output.contentLength longLongValue];
+        transferUtilityMultiPartDownloadTask.eTag = output.ETag;
+        transferUtilityMultiPartDownloadTask.contentLength = @(contentLength);
+        transferUtilityMultiPartDownloadTask.progress.totalUnitCount = contentLength;
+        transferUtilityMultiPartDownloadTask.progress.completedUnitCount = (long long) 0;
+        
+        //Reserve the whole file up front, so that the ranges can be written at their offsets as they arrive.
+        NSError *error = nil;
+        if (![self preallocateFileAtPath:transferUtilityMultiPartDownloadTask.file length:contentLength error:&error]) {
+            return [AWSTask taskWithError:error];
+        }
+        
+        //Split the object into ranges. All of them start out waiting and are picked up in order.
+        int64_t partSize = transferUtilityMultiPartDownloadTask.partSize;
+        int64_t partCount = (contentLength + partSize - 1) / partSize;
+        AWSDDLogDebug(@"Object size is %lld, number of parts is %lld", contentLength, partCount);
+        for (int64_t i = 1; i <= partCount; i++) {
+            AWSS3TransferUtilityDownloadSubTask *subTask = [AWSS3TransferUtilityDownloadSubTask new];
+            subTask.transferID = transferUtilityMultiPartDownloadTask.transferID;
+            subTask.partNumber = @(i);
+            subTask.rangeStart = (i - 1) * partSize;
+            subTask.totalBytesExpectedToReceive = MIN(partSize, contentLength - subTask.rangeStart);
+            subTask.totalBytesReceived = (long long) 0;
+            subTask.responseData = @"";
+            subTask.status = AWSS3TransferUtilityWaitingStatus;
+            [transferUtilityMultiPartDownloadTask.waitingPartsDictionary setObject:subTask forKey:subTask.partNumber];
+        }
+        
+        //Save the download and all of its ranges in the DB
+        [self insertMultiPartDownloadRequestInDB:transferUtilityMultiPartDownloadTask databaseQueue:self->_databaseQueue];
+        [self.taskDictionary setObject:transferUtilityMultiPartDownloadTask forKey:transferUtilityMultiPartDownloadTask.transferID];
+        
+        if (partCount == 0) {
+            [self completeMultiPartDownloadTask:transferUtilityMultiPartDownloadTask];
+        }
+        else {
+            [self startMultiPartDownloadSubTasks:transferUtilityMultiPartDownloadTask];
+        }
+        return [AWSTask taskWithResult:transferUtilityMultiPartDownloadTask];
+    }];
+}
+
+- (BOOL)preallocateFileAtPath:(NSString *)path
+                       length:(int64_t)length
+                        error:(NSError **)error {
+    int fileDescriptor = open([path fileSystemRepresentation], O_RDWR | O_CREAT, 0644);
+    if (fileDescriptor < 0) {
+        if (error) {
+            *error = [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:nil];
+        }
+        return NO;
+    }
+    
+    //Ask for contiguous blocks first and fall back to any blocks. This is only an optimization, ftruncate sets the size.
+    if (length > 0) {
+        fstore_t store = {F_ALLOCATECONTIG | F_ALLOCATEALL, F_PEOFPOSMODE, 0, length, 0};
+        if (fcntl(fileDescriptor, F_PREALLOCATE, &store) == -1) {
+            store.fst_flags = F_ALLOCATEALL;
+            fcntl(fileDescriptor, F_PREALLOCATE, &store);
+        }
+    }
+    
+    BOOL result = YES;
+    if (ftruncate(fileDescriptor, length) != 0) {
+        if (error) {
+            *error = [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:nil];
+        }
+        result = NO;
+    }
+    close(fileDescriptor);
+    return result;
+}
+
+- (AWSTask<NSURL *> *)preSignedURLForMultiPartDownloadTask:(AWSS3TransferUtilityMultiPartDownloadTask *)transferUtilityMultiPartDownloadTask {
+    //All the ranges share one pre-signed URL. The Range and If-Match headers are not part of the signature.
+    @synchronized(transferUtilityMultiPartDownloadTask) {
+        if (transferUtilityMultiPartDownloadTask.preSignedURL
+            && [transferUtilityMultiPartDownloadTask.preSignedURLExpiration timeIntervalSinceNow] > AWSS3TransferUtilityPreSignedURLRefreshInterval) {
+            return [AWSTask taskWithResult:transferUtilityMultiPartDownloadTask.preSignedURL];
+        }
+    }
+    
+    NSDate *expires = [NSDate dateWithTimeIntervalSinceNow:AWSS3TransferUtilityTimeoutIntervalForResource];
+    AWSS3GetPreSignedURLRequest *getPreSignedURLRequest = [AWSS3GetPreSignedURLRequest new];
+    getPreSignedURLRequest.bucket = transferUtilityMultiPartDownloadTask.bucket;
+    getPreSignedURLRequest.key = transferUtilityMultiPartDownloadTask.key;
+    getPreSignedURLRequest.HTTPMethod = AWSHTTPMethodGET;
+    getPreSignedURLRequest.expires = expires;
+    getPreSignedURLRequest.minimumCredentialsExpirationInterval = AWSS3TransferUtilityTimeoutIntervalForResource;
+    getPreSignedURLRequest.accelerateModeEnabled = self.transferUtilityConfiguration.isAccelerateModeEnabled;
+    
+    [transferUtilityMultiPartDownloadTask.expression assignRequestHeaders:getPreSignedURLRequest];
+    [transferUtilityMultiPartDownloadTask.expression assignRequestParameters:getPreSignedURLRequest];
+    
+    return [[self.preSignedURLBuilder getPreSignedURL:getPreSignedURLRequest] continueWithSuccessBlock:^id(AWSTask *task) {
+        @synchronized(transferUtilityMultiPartDownloadTask) {
+            transferUtilityMultiPartDownloadTask.preSignedURL = task.result;
+            transferUtilityMultiPartDownloadTask.preSignedURLExpiration = expires;
+        }
+        return task;
+    }];
+}
+
+- (void)startMultiPartDownloadSubTasks:(AWSS3TransferUtilityMultiPartDownloadTask *)transferUtilityMultiPartDownloadTask {
+    [[self preSignedURLForMultiPartDownloadTask:transferUtilityMultiPartDownloadTask] continueWithBlock:^id(AWSTask *task) {
+        if (transferUtilityMultiPartDownloadTask.cancelled) {
+            [self cleanupForMultiPartDownloadTask:transferUtilityMultiPartDownloadTask];
+            [self removeFile:transferUtilityMultiPartDownloadTask.file];
+            return nil;
+        }
+        if (task.error) {
+            [self failMultiPartDownloadTask:transferUtilityMultiPartDownloadTask error:task.error];
+            return nil;
+        }
+        
+        //Move the lowest waiting ranges to inProgress until the concurrency limit is reached.
+        NSUInteger concurrencyLimit = MAX([self.transferUtilityConfiguration.multiPartConcurrencyLimit integerValue], 1);
+        @synchronized(transferUtilityMultiPartDownloadTask) {
+            NSArray *partNumbers = [[transferUtilityMultiPartDownloadTask.waitingPartsDictionary allKeys] sortedArrayUsingSelector:@selector(compare:)];
+            for (NSNumber *partNumber in partNumbers) {
+                if ([transferUtilityMultiPartDownloadTask.inProgressPartsDictionary count] >= concurrencyLimit) {
+                    break;
+                }
+                AWSS3TransferUtilityDownloadSubTask *subTask = [transferUtilityMultiPartDownloadTask.waitingPartsDictionary objectForKey:partNumber];
+                [transferUtilityMultiPartDownloadTask.waitingPartsDictionary removeObjectForKey:partNumber];
+                [self createDownloadSubTask:transferUtilityMultiPartDownloadTask subTask:subTask preSignedURL:task.result];
+            }
+        }
+        return nil;
+    }];
+}
+
+- (void)createDownloadSubTask:(AWSS3TransferUtilityMultiPartDownloadTask *)transferUtilityMultiPartDownloadTask
+                      subTask:(AWSS3TransferUtilityDownloadSubTask *)subTask
+                 preSignedURL:(NSURL *)preSignedURL {
+    NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:preSignedURL];
+    request.cachePolicy = NSURLRequestReloadIgnoringLocalCacheData;
+    request.HTTPMethod = @"GET";
+    
+    for (NSString *key in transferUtilityMultiPartDownloadTask.expression.requestHeaders) {
+        [request setValue:transferUtilityMultiPartDownloadTask.expression.requestHeaders[key] forHTTPHeaderField:key];
+    }
+    [request setValue:[NSString stringWithFormat:@"bytes=%lld-%lld", subTask.rangeStart, subTask.rangeStart + subTask.totalBytesExpectedToReceive - 1]
+   forHTTPHeaderField:@"Range"];
+    if (transferUtilityMultiPartDownloadTask.eTag) {
+        [request setValue:transferUtilityMultiPartDownloadTask.eTag forHTTPHeaderField:@"If-Match"];
+    }
+    [request setValue:[self.configuration.userAgent stringByAppendingString:@" MultiPart"] forHTTPHeaderField:@"User-Agent"];
+    
+    NSURLSessionDownloadTask *downloadTask = [self.session downloadTaskWithRequest:request];
+    subTask.sessionTask = downloadTask;
+    subTask.taskIdentifier = downloadTask.taskIdentifier;
+    subTask.totalBytesReceived = (long long) 0;
+    subTask.responseData = @"";
+    subTask.error = nil;
+    subTask.status = AWSS3TransferUtilityInProgressStatus;
+    
+    [transferUtilityMultiPartDownloadTask.inProgressPartsDictionary setObject:subTask forKey:@(subTask.taskIdentifier)];
+    
+    //Also register transferUtilityMultiPartDownloadTask into the taskDictionary for easy lookup in the NSURLCallback
+    [self.taskDictionary setObject:transferUtilityMultiPartDownloadTask forKey:@(subTask.taskIdentifier)];
+    
+    //Save the session task of this range in the DB
+    [transferUtilityMultiPartDownloadTask updateStatusForSubTask:subTask];
+    
+    //A suspended download keeps its new ranges suspended until it is resumed.
+    if ([transferUtilityMultiPartDownloadTask.status isEqualToString:AWSS3TransferUtilityPausedStatus]) {
+        subTask.status = AWSS3TransferUtilityPausedStatus;
+        [transferUtilityMultiPartDownloadTask updateStatusForSubTask:subTask];
+        return;
+    }
+    [downloadTask resume];
+}
+
+- (NSError *)validateResponse:(NSHTTPURLResponse *)HTTPResponse
+     forMultiPartDownloadTask:(AWSS3TransferUtilityMultiPartDownloadTask *)transferUtilityMultiPartDownloadTask
+                      subTask:(AWSS3TransferUtilityDownloadSubTask *)subTask {
+    NSString *eTag = nil;
+    NSString *contentRange = nil;
+    for (NSString *header in HTTPResponse.allHeaderFields) {
+        if ([header caseInsensitiveCompare:@"ETag"] == NSOrderedSame) {
+            eTag = HTTPResponse.allHeaderFields[header];
+        }
+        else if ([header caseInsensitiveCompare:@"Content-Range"] == NSOrderedSame) {
+            contentRange = HTTPResponse.allHeaderFields[header];
+        }
+    }
+    
+    int64_t contentLength = [transferUtilityMultiPartDownloadTask.contentLength longLongValue];
+    if ((transferUtilityMultiPartDownloadTask.eTag && eTag && ![eTag isEqualToString:transferUtilityMultiPartDownloadTask.eTag])) {
+        return [NSError errorWithDomain:AWSS3TransferUtilityErrorDomain
+                                   code:AWSS3TransferUtilityErrorObjectModified
+                               userInfo:@{NSLocalizedDescriptionKey: @"The object was modified while it was being downloaded."}];
+    }
+    
+    if (HTTPResponse.statusCode == 206) {
+        long long start = -1;
+        long long end = -1;
+        long long total = -1;
+        if (!contentRange || sscanf([contentRange UTF8String], "bytes %lld-%lld/%lld", &start, &end, &total) != 3) {
+            return [NSError errorWithDomain:AWSS3TransferUtilityErrorDomain
+                                       code:AWSS3TransferUtilityErrorUnknown
+                                   userInfo:@{NSLocalizedDescriptionKey: @"The response does not contain a valid Content-Range header."}];
+        }
+        if (total != contentLength) {
+            return [NSError errorWithDomain:AWSS3TransferUtilityErrorDomain
+                                       code:AWSS3TransferUtilityErrorObjectModified
+                                   userInfo:@{NSLocalizedDescriptionKey: @"The object was modified while it was being downloaded."}];
+        }
+        if (start != subTask.rangeStart || end != subTask.rangeStart + subTask.totalBytesExpectedToReceive - 1) {
+            return [NSError errorWithDomain:AWSS3TransferUtilityErrorDomain
+                                       code:AWSS3TransferUtilityErrorUnknown
+                                   userInfo:@{NSLocalizedDescriptionKey: [NSString stringWithFormat:@"Received range %@ for part %@.", contentRange, subTask.partNumber]}];
+        }
+        return nil;
+    }
+    
+    //A server that ignores the Range header can only be used when a single range covers the whole object.
+    if (subTask.rangeStart != 0 || subTask.totalBytesExpectedToReceive != contentLength) {
+        return [NSError errorWithDomain:AWSS3TransferUtilityErrorDomain
+                                   code:AWSS3TransferUtilityErrorUnknown
+                               userInfo:@{NSLocalizedDescriptionKey: @"The server did not return the requested range."}];
+    }
+    return nil;
+}
+
+- (NSError *)writeFileAtURL:(NSURL *)location
+   toMultiPartDownloadTask:(AWSS3TransferUtilityMultiPartDownloadTask *)transferUtilityMultiPartDownloadTask
+                   subTask:(AWSS3TransferUtilityDownloadSubTask *)subTask {
+    NSError *error = nil;
+    NSData *data = [NSData dataWithContentsOfURL:location options:NSDataReadingMappedIfSafe error:&error];
+    if (!data) {
+        return error;
+    }
+    if ([data length] != subTask.totalBytesExpectedToReceive) {
+        return [NSError errorWithDomain:AWSS3TransferUtilityErrorDomain
+                                   code:AWSS3TransferUtilityErrorUnknown
+                               userInfo:@{NSLocalizedDescriptionKey: [NSString stringWithFormat:@"Received %lu bytes for part %@, expected %lld.",
+                                                                      (unsigned long)[data length], subTask.partNumber, subTask.totalBytesExpectedToReceive]}];
+    }
+    
+    NSFileHandle *fileHandle = [NSFileHandle fileHandleForWritingToURL:transferUtilityMultiPartDownloadTask.location error:&error];
+    if (!fileHandle) {
+        return error;
+    }
+    @try {
+        [fileHandle seekToFileOffset:subTask.rangeStart];
+        [fileHandle writeData:data];
+        [fileHandle synchronizeFile];
+    }
+    @catch (NSException *exception) {
+        error = [NSError errorWithDomain:AWSS3TransferUtilityErrorDomain
+                                    code:AWSS3TransferUtilityErrorUnknown
+                                userInfo:@{NSLocalizedDescriptionKey: exception.reason ?: @"Failed to write to the destination file."}];
+    }
+    @finally {
+        [fileHandle closeFile];
+    }
+    return error;
+}
+
+- (void)completeMultiPartDownloadSubTask:(AWSS3TransferUtilityMultiPartDownloadTask *)transferUtilityMultiPartDownloadTask
+                             sessionTask:(NSURLSessionTask *)task
+                                   error:(NSError *)error
+                            HTTPResponse:(NSHTTPURLResponse *)HTTPResponse
+                                userInfo:(NSMutableDictionary *)userInfo {
+    AWSS3TransferUtilityDownloadSubTask *subTask = nil;
+    @synchronized(transferUtilityMultiPartDownloadTask) {
+        subTask = [transferUtilityMultiPartDownloadTask.inProgressPartsDictionary objectForKey:@(task.taskIdentifier)];
+        [transferUtilityMultiPartDownloadTask.inProgressPartsDictionary removeObjectForKey:@(task.taskIdentifier)];
+    }
+    [self.taskDictionary removeObjectForKey:@(task.taskIdentifier)];
+    if (!subTask) {
+        AWSDDLogDebug(@"Unable to find information for part %lu in inProgressPartsDictionary", (unsigned long)task.taskIdentifier);
+        return;
+    }
+    
+    //Check if the task was cancelled.
+    if (transferUtilityMultiPartDownloadTask.cancelled) {
+        [self cleanupForMultiPartDownloadTask:transferUtilityMultiPartDownloadTask];
+        [self removeFile:transferUtilityMultiPartDownloadTask.file];
+        return;
+    }
+    
+    //The session was invalidated with the range in flight. Keep it in the DB, so it is requested again on the next launch.
+    if ([error.domain isEqualToString:NSURLErrorDomain] && error.code == NSURLErrorCancelled) {
+        AWSDDLogDebug(@"Part %@ of %@ was cancelled by the session", subTask.partNumber, transferUtilityMultiPartDownloadTask.transferID);
+        return;
+    }
+    
+    if (!error) {
+        error = subTask.error;
+    }
+    
+    if (error) {
+        //412 Precondition Failed means that the ETag does not match anymore.
+        if (HTTPResponse.statusCode == 412) {
+            error = [NSError errorWithDomain:AWSS3TransferUtilityErrorDomain
+                                        code:AWSS3TransferUtilityErrorObjectModified
+                                    userInfo:userInfo];
+        }
+        //Retrying if the connection was lost or a 500, 503 or 400 RequestTimeout error occured.
+        else if ([error.domain isEqualToString:NSURLErrorDomain]
+                 || [self isErrorRetriable:HTTPResponse.statusCode responseFromServer:subTask.responseData]) {
+            //Each range has its own retry budget, so transient failures spread over a large object do not fail the download.
+            if (subTask.retryCount < self.transferUtilityConfiguration.retryLimit) {
+                AWSDDLogDebug(@"Retry count is below limit and error is retriable. Retrying part %@", subTask.partNumber);
+                subTask.retryCount = subTask.retryCount + 1;
+                @synchronized(transferUtilityMultiPartDownloadTask) {
+                    transferUtilityMultiPartDownloadTask.progress.completedUnitCount -= subTask.totalBytesReceived;
+                    subTask.totalBytesReceived = (long long) 0;
+                    subTask.status = AWSS3TransferUtilityWaitingStatus;
+                    [transferUtilityMultiPartDownloadTask.waitingPartsDictionary setObject:subTask forKey:subTask.partNumber];
+                    //The server may have rejected an expired signature, so sign a new URL.
+                    if (HTTPResponse) {
+                        transferUtilityMultiPartDownloadTask.preSignedURL = nil;
+                    }
+                }
+                [transferUtilityMultiPartDownloadTask updateStatusForSubTask:subTask];
+                [self startMultiPartDownloadSubTasks:transferUtilityMultiPartDownloadTask];
+                return;
+            }
+        }
+        
+        //Errors of a range that failed validation already describe the problem; only HTTP errors carry the S3 error.
+        if (HTTPResponse && HTTPResponse.statusCode / 100 != 2 && [error.domain isEqualToString:AWSS3TransferUtilityErrorDomain]) {
+            [self handleS3Errors:subTask.responseData
+                        userInfo:userInfo];
+            error = [[NSError alloc] initWithDomain:error.domain code:error.code userInfo:userInfo];
+        }
+        [self failMultiPartDownloadTask:transferUtilityMultiPartDownloadTask error:error];
+        return;
+    }
+    
+    //The range has been written to the file. Add it to completed parts.
+    BOOL finished = NO;
+    @synchronized(transferUtilityMultiPartDownloadTask) {
+        transferUtilityMultiPartDownloadTask.progress.completedUnitCount += subTask.totalBytesExpectedToReceive - subTask.totalBytesReceived;
+        subTask.totalBytesReceived = subTask.totalBytesExpectedToReceive;
+        subTask.status = AWSS3TransferUtilityCompletedStatus;
+        [transferUtilityMultiPartDownloadTask.completedPartsDictionary setObject:subTask forKey:subTask.partNumber];
+        finished = [transferUtilityMultiPartDownloadTask.waitingPartsDictionary count] == 0
+        && [transferUtilityMultiPartDownloadTask.inProgressPartsDictionary count] == 0;
+    }
+    [transferUtilityMultiPartDownloadTask updateStatusForSubTask:subTask];
+    
+    if (transferUtilityMultiPartDownloadTask.expression.progressBlock) {
+        transferUtilityMultiPartDownloadTask.expression.progressBlock(transferUtilityMultiPartDownloadTask, transferUtilityMultiPartDownloadTask.progress);
+    }
+    
+    if (finished) {
+        [self completeMultiPartDownloadTask:transferUtilityMultiPartDownloadTask];
+    }
+    else {
+        [self startMultiPartDownloadSubTasks:transferUtilityMultiPartDownloadTask];
+    }
+}
+
+- (void)completeMultiPartDownloadTask:(AWSS3TransferUtilityMultiPartDownloadTask *)transferUtilityMultiPartDownloadTask {
+    AWSDDLogInfo(@"Completed Multipart Download: %@", transferUtilityMultiPartDownloadTask.transferID);
+    [self cleanupForMultiPartDownloadTask:transferUtilityMultiPartDownloadTask];
+    
+    //Call the callback function is specified.
+    if (transferUtilityMultiPartDownloadTask.expression.completionHandler) {
+        transferUtilityMultiPartDownloadTask.expression.completionHandler(transferUtilityMultiPartDownloadTask,
+                                                                          transferUtilityMultiPartDownloadTask.location,
+                                                                          nil);
+    }
+}
+
+- (void)failMultiPartDownloadTask:(AWSS3TransferUtilityMultiPartDownloadTask *)transferUtilityMultiPartDownloadTask
+                            error:(NSError *)error {
+    transferUtilityMultiPartDownloadTask.error = error;
+    
+    //Make sure all the parts are canceled.
+    [transferUtilityMultiPartDownloadTask cancel];
+    
+    //clean up.
+    [self cleanupForMultiPartDownloadTask:transferUtilityMultiPartDownloadTask];
+    [self removeFile:transferUtilityMultiPartDownloadTask.file];
+    
+    //Execute call back if provided.
+    if (transferUtilityMultiPartDownloadTask.expression.completionHandler) {
+        transferUtilityMultiPartDownloadTask.expression.completionHandler(transferUtilityMultiPartDownloadTask, nil, error);
+    }
+}
+
+- (void)resumeRecoveredMultiPartDownloadTask:(AWSS3TransferUtilityMultiPartDownloadTask *)transferUtilityMultiPartDownloadTask {
+    //The file was removed while the app was not running. The completed ranges are gone, so start over.
+    if (![[NSFileManager defaultManager] fileExistsAtPath:transferUtilityMultiPartDownloadTask.file]) {
+        NSError *error = nil;
+        if (![self preallocateFileAtPath:transferUtilityMultiPartDownloadTask.file
+                                  length:[transferUtilityMultiPartDownloadTask.contentLength longLongValue]
+                                   error:&error]) {
+            [self failMultiPartDownloadTask:transferUtilityMultiPartDownloadTask error:error];
+            return;
+        }
+        
+        NSArray *completedParts = nil;
+        @synchronized(transferUtilityMultiPartDownloadTask) {
+            completedParts = [transferUtilityMultiPartDownloadTask.completedPartsDictionary allValues];
+            [transferUtilityMultiPartDownloadTask.completedPartsDictionary removeAllObjects];
+            for (AWSS3TransferUtilityDownloadSubTask *subTask in completedParts) {
+                subTask.totalBytesReceived = (long long) 0;
+                subTask.status = AWSS3TransferUtilityWaitingStatus;
+                [transferUtilityMultiPartDownloadTask.waitingPartsDictionary setObject:subTask forKey:subTask.partNumber];
+            }
+            transferUtilityMultiPartDownloadTask.progress.completedUnitCount = (long long) 0;
+        }
+        for (AWSS3TransferUtilityDownloadSubTask *subTask in completedParts) {
+            [transferUtilityMultiPartDownloadTask updateStatusForSubTask:subTask];
+        }
+    }
+    
+    BOOL finished = NO;
+    @synchronized(transferUtilityMultiPartDownloadTask) {
+        finished = [transferUtilityMultiPartDownloadTask.waitingPartsDictionary count] == 0
+        && [transferUtilityMultiPartDownloadTask.inProgressPartsDictionary count] == 0;
+    }
+    if (finished) {
+        [self completeMultiPartDownloadTask:transferUtilityMultiPartDownloadTask];
+    }
+    else {
+        [self startMultiPartDownloadSubTasks:transferUtilityMultiPartDownloadTask];
+    }
+}
+
 #pragma mark - Utility methods
 
 - (void)enumerateToAssignBlocksForUploadTask:(void (^)(AWSS3TransferUtilityUploadTask *uploadTask,
@@ -1409,6 +2084,26 @@ downloadBlocksAssigner:(void (^)(AWSS3TransferUtilityDownloadTask *downloadTask,
     }
 }
 
+- (void)enumerateToAssignBlocksForMultiPartDownloadTask:(void (^)(AWSS3TransferUtilityMultiPartDownloadTask *multiPartDownloadTask,
+                                                                  AWSS3TransferUtilityMultiPartDownloadProgressBlock *multiPartDownloadProgressBlockReference,
+                                                                  AWSS3TransferUtilityMultiPartDownloadCompletionHandlerBlock *completionHandlerReference))multiPartDownloadBlocksAssigner {
+    if (!multiPartDownloadBlocksAssigner) {
+        return;
+    }
+    
+    //A MultiPart download is registered once for every range in flight. Assign the blocks once per download.
+    for (AWSS3TransferUtilityMultiPartDownloadTask *task in [self multiPartDownloadTasks]) {
+        AWSS3TransferUtilityMultiPartDownloadProgressBlock progressBlock = nil;
+        AWSS3TransferUtilityMultiPartDownloadCompletionHandlerBlock completionHandler = nil;
+        multiPartDownloadBlocksAssigner(task, &progressBlock, &completionHandler);
+        if (progressBlock) {
+            task.expression.progressBlock = progressBlock;
+        }
+        if (completionHandler) {
+            task.expression.completionHandler = completionHandler;
+        }
+    }
+}
 
 - (AWSTask *)getAllTasks {
     AWSTaskCompletionSource *completionSource = [AWSTaskCompletionSource new];
@@ -1416,7 +2111,8 @@ downloadBlocksAssigner:(void (^)(AWSS3TransferUtilityDownloadTask *downloadTask,
     for (id key in [self.taskDictionary allKeys]) {
         id value = [self.taskDictionary objectForKey:key];
         //To retain backward compatability, make sure that we filter out Multipart tasks.
-        if (! [value isKindOfClass:[AWSS3TransferUtilityMultiPartUploadTask class]]) {
+        if (! [value isKindOfClass:[AWSS3TransferUtilityMultiPartUploadTask class]]
+            && ! [value isKindOfClass:[AWSS3TransferUtilityMultiPartDownloadTask class]]) {
             [allTasks addObject:value];
         }
         [allTasks addObject:[self.taskDictionary objectForKey:key]];
@@ -1467,6 +2163,23 @@ downloadBlocksAssigner:(void (^)(AWSS3TransferUtilityDownloadTask *downloadTask,
     return completionSource.task;
 }
 
+- (AWSTask *)getMultiPartDownloadTasks {
+    AWSTaskCompletionSource *completionSource = [AWSTaskCompletionSource new];
+    [completionSource setResult:[self multiPartDownloadTasks]];
+    return completionSource.task;
+}
+
+- (NSArray<AWSS3TransferUtilityMultiPartDownloadTask *> *)multiPartDownloadTasks {
+    NSMutableArray *allTasks = [NSMutableArray new];
+    for (id key in [self.taskDictionary allKeys]) {
+        id value = [self.taskDictionary objectForKey:key];
+        if ([value isKindOfClass:[AWSS3TransferUtilityMultiPartDownloadTask class]]
+            && [allTasks indexOfObjectIdenticalTo:value] == NSNotFound) {
+            [allTasks addObject:value];
+        }
+    }
+    return allTasks;
+}
 
 #pragma mark - Internal helper methods
 
@@ -1751,6 +2464,15 @@ didCompleteWithError:(NSError *)error {
         }
     }
     else if ([task isKindOfClass:[NSURLSessionDownloadTask class]]) {
+        if ([[self.taskDictionary objectForKey:@(task.taskIdentifier)] isKindOfClass:[AWSS3TransferUtilityMultiPartDownloadTask class]]) {
+            [self completeMultiPartDownloadSubTask:[self.taskDictionary objectForKey:@(task.taskIdentifier)]
+                                       sessionTask:task
+                                             error:error
+                                      HTTPResponse:HTTPResponse
+                                          userInfo:userInfo];
+            return;
+        }
+        
         AWSS3TransferUtilityDownloadTask *downloadTask = [self.taskDictionary objectForKey:@(task.taskIdentifier)];
         if (!downloadTask) {
             AWSDDLogDebug(@"Unable to find information for task %lu in taskDictionary", (unsigned long)task.taskIdentifier);
@@ -1824,6 +2546,18 @@ didCompleteWithError:(NSError *)error {
     }
 }
 
+- (void) cleanupForMultiPartDownloadTask: (AWSS3TransferUtilityMultiPartDownloadTask *) task {
+    //Remove data from the Database.
+    [self deleteTransferRequestFromDB:task.transferID databaseQueue:_databaseQueue];
+    
+    //Remove all the entries for this download from taskDictionary.
+    for (id key in [self.taskDictionary allKeys]) {
+        if ([self.taskDictionary objectForKey:key] == task) {
+            [self.taskDictionary removeObjectForKey:key];
+        }
+    }
+}
+
 - (void) cleanupForUploadTask: (AWSS3TransferUtilityUploadTask *) uploadTask {
     [self.taskDictionary removeObjectForKey:@(uploadTask.taskIdentifier)];
     if (uploadTask.temporaryFileCreated) {
@@ -1911,6 +2645,35 @@ totalBytesExpectedToSend:(int64_t)totalBytesExpectedToSend {
 - (void)URLSession:(NSURLSession *)session
       downloadTask:(NSURLSessionDownloadTask *)downloadTask
 didFinishDownloadingToURL:(NSURL *)location {
+    if ([[self.taskDictionary objectForKey:@(downloadTask.taskIdentifier)] isKindOfClass:[AWSS3TransferUtilityMultiPartDownloadTask class]]) {
+        AWSS3TransferUtilityMultiPartDownloadTask *transferUtilityMultiPartDownloadTask = [self.taskDictionary objectForKey:@(downloadTask.taskIdentifier)];
+        AWSS3TransferUtilityDownloadSubTask *subTask = nil;
+        @synchronized(transferUtilityMultiPartDownloadTask) {
+            subTask = [transferUtilityMultiPartDownloadTask.inProgressPartsDictionary objectForKey:@(downloadTask.taskIdentifier)];
+        }
+        if (!subTask || transferUtilityMultiPartDownloadTask.cancelled) {
+            return;
+        }
+        
+        NSHTTPURLResponse *HTTPResponse = nil;
+        if ([downloadTask.response isKindOfClass:[NSHTTPURLResponse class]]) {
+            HTTPResponse = (NSHTTPURLResponse *)downloadTask.response;
+        }
+        //Keep the error document, it is parsed once the range completes.
+        if (HTTPResponse.statusCode / 100 != 2) {
+            subTask.responseData = [NSString stringWithContentsOfURL:location encoding:NSUTF8StringEncoding error:nil] ?: @"";
+            return;
+        }
+        
+        //Write the range to its offset in the destination file, unless the response does not belong to this download.
+        NSError *error = [self validateResponse:HTTPResponse forMultiPartDownloadTask:transferUtilityMultiPartDownloadTask subTask:subTask];
+        if (!error) {
+            error = [self writeFileAtURL:location toMultiPartDownloadTask:transferUtilityMultiPartDownloadTask subTask:subTask];
+        }
+        subTask.error = error;
+        return;
+    }
+    
     AWSS3TransferUtilityDownloadTask *transferUtilityTask = [self.taskDictionary objectForKey:@(downloadTask.taskIdentifier)];
     if (!transferUtilityTask) {
         AWSDDLogDebug(@"Unable to find information for task %lu in taskDictionary", (unsigned long)downloadTask.taskIdentifier);
@@ -1941,6 +2704,26 @@ didFinishDownloadingToURL:(NSURL *)location {
  totalBytesWritten:(int64_t)totalBytesWritten
 totalBytesExpectedToWrite:(int64_t)totalBytesExpectedToWrite {
     
+    if ([[self.taskDictionary objectForKey:@(downloadTask.taskIdentifier)] isKindOfClass:[AWSS3TransferUtilityMultiPartDownloadTask class]]) {
+        AWSS3TransferUtilityMultiPartDownloadTask *transferUtilityMultiPartDownloadTask = [self.taskDictionary objectForKey:@(downloadTask.taskIdentifier)];
+        @synchronized(transferUtilityMultiPartDownloadTask) {
+            //Get multipart download sub task
+            AWSS3TransferUtilityDownloadSubTask *subTask = [transferUtilityMultiPartDownloadTask.inProgressPartsDictionary objectForKey:@(downloadTask.taskIdentifier)];
+            if (!subTask || subTask.totalBytesReceived >= totalBytesWritten) {
+                return;
+            }
+            //Calculate and update the running total
+            transferUtilityMultiPartDownloadTask.progress.completedUnitCount = transferUtilityMultiPartDownloadTask.progress.completedUnitCount - subTask.totalBytesReceived + totalBytesWritten;
+            subTask.totalBytesReceived = totalBytesWritten;
+        }
+        
+        //execute the callback to the progressblock if present.
+        if (transferUtilityMultiPartDownloadTask.expression.progressBlock) {
+            transferUtilityMultiPartDownloadTask.expression.progressBlock(transferUtilityMultiPartDownloadTask, transferUtilityMultiPartDownloadTask.progress);
+        }
+        return;
+    }
+    
     AWSS3TransferUtilityDownloadTask *transferUtilityDownloadTask =
         [self.taskDictionary objectForKey:@(downloadTask.taskIdentifier)];
    
@@ -2047,6 +2830,11 @@ NSString *const AWSS3TransferUtilityUpdateTransferUtilityStatusAndETag = @"UPDAT
 @"WHERE transfer_id=:transfer_id and "
 @"      session_task_id=:session_task_id ";
 
+NSString *const AWSS3TransferUtilityUpdateMultiPartDownloadSubTask = @"UPDATE awstransfer "
+@"SET status=:status, session_task_id=:session_task_id "
+@"WHERE transfer_id=:transfer_id and "
+@"      part_number=:part_number ";
+
 NSString *const AWSS3TransferUtilityDatabaseDirectory = @"/com/amazonaws/AWSS3TransferUtility/";
 NSString *const AWSS3TransferUtilityDatabaseName = @"transfer_utility_database";
 NSString *const AWSS3TransferUtilityInProgressStatus = @"IN_PROGRESS";
@@ -2200,6 +2988,49 @@ NSString *const AWSS3TransferUtilityWaitingStatus = @"WAITING";
                       databaseQueue:databaseQueue];
 }
 
+- (void) insertMultiPartDownloadRequestInDB:(AWSS3TransferUtilityMultiPartDownloadTask *) task
+                              databaseQueue: (AWSFMDatabaseQueue *) databaseQueue {
+    NSMutableDictionary *parameters = [NSMutableDictionary dictionaryWithDictionary:@{
+                                                                                      @"transfer_id": task.transferID,
+                                                                                      @"ns_url_session_id": task.nsURLSessionID,
+                                                                                      @"session_task_id": @0,
+                                                                                      @"transfer_type": @"MULTI_PART_DOWNLOAD",
+                                                                                      @"bucket_name": task.bucket,
+                                                                                      @"key": task.key,
+                                                                                      @"part_number": @0,
+                                                                                      @"multi_part_id": @"",
+                                                                                      @"etag": task.eTag ?: @"",
+                                                                                      @"file": task.file,
+                                                                                      @"temporary_file_created": @0,
+                                                                                      @"content_length": task.contentLength,
+                                                                                      @"status": AWSS3TransferUtilityInProgressStatus,
+                                                                                      @"request_headers": [self getJSONRepresentation:task.expression.requestHeaders],
+                                                                                      @"request_parameters": [self getJSONRepresentation:task.expression.requestParameters],
+                                                                                      @"retry_count": @(task.retryCount)
+                                                                                      }];
+    NSArray *partNumbers = [[task.waitingPartsDictionary allKeys] sortedArrayUsingSelector:@selector(compare:)];
+    
+    //Save the download and all of its ranges in a single transaction.
+    [databaseQueue inTransaction:^(AWSFMDatabase *db, BOOL *rollback) {
+        if (![db executeUpdate:AWSS3TransferUtiltyInsertIntoAWSTransfer withParameterDictionary:parameters]) {
+            AWSDDLogError(@"Failed to save Transfer [%@] in awstransfer database table. [%@]", task.transferID, db.lastError);
+            *rollback = YES;
+            return;
+        }
+        parameters[@"transfer_type"] = @"MULTI_PART_DOWNLOAD_SUB_TASK";
+        for (NSNumber *partNumber in partNumbers) {
+            AWSS3TransferUtilityDownloadSubTask *subTask = [task.waitingPartsDictionary objectForKey:partNumber];
+            parameters[@"part_number"] = subTask.partNumber;
+            parameters[@"content_length"] = @(subTask.totalBytesExpectedToReceive);
+            parameters[@"status"] = subTask.status;
+            if (![db executeUpdate:AWSS3TransferUtiltyInsertIntoAWSTransfer withParameterDictionary:parameters]) {
+                AWSDDLogError(@"Failed to save part [%@] of Transfer [%@] in awstransfer database table. [%@]", partNumber, task.transferID, db.lastError);
+                *rollback = YES;
+                return;
+            }
+        }
+    }];
+}
 
 - (void) insertTransferRequestInDB: (NSString *) transferID
                     nsURLSessionID: (NSString *) nsURLSessionID
@@ -2327,7 +3158,7 @@ NSString *const AWSS3TransferUtilityWaitingStatus = @"WAITING";
             [transfer setObject:[rs stringForColumn:@"etag"] forKey:@"etag"];
             [transfer setObject:[rs stringForColumn:@"file"] forKey:@"file"];
             [transfer setObject:@([rs intForColumn:@"temporary_file_created"]) forKey:@"temporary_file_created"];
-            [transfer setObject:@([rs intForColumn:@"content_length"]) forKey:@"content_length"];
+            [transfer setObject:@([rs longLongIntForColumn:@"content_length"]) forKey:@"content_length"];
             [transfer setObject:[rs stringForColumn:@"status"] forKey:@"status"];
             [transfer setObject:@([rs intForColumn:@"retry_count"]) forKey:@"retry_count"];
             [transfer setObject:[rs stringForColumn:@"request_headers"] forKey:@"request_headers"];
@@ -2365,6 +3196,7 @@ NSString *const AWSS3TransferUtilityWaitingStatus = @"WAITING";
         _accelerateModeEnabled = NO;
         _retryLimit = 0;
         _multiPartConcurrencyLimit = @(AWSS3TransferUtilityMultiPartDefaultConcurrencyLimit);
+        _multiPartDownloadPartSize = @(AWSS3TransferUtilityMultiPartSize);
     }
     return self;
 }
@@ -2375,6 +3207,7 @@ NSString *const AWSS3TransferUtilityWaitingStatus = @"WAITING";
     configuration.bucket = self.bucket;
     configuration.retryLimit = self.retryLimit;
     configuration.multiPartConcurrencyLimit = self.multiPartConcurrencyLimit;
+    configuration.multiPartDownloadPartSize = self.multiPartDownloadPartSize;
     
     return configuration;
 }
@@ -2543,6 +3376,77 @@ NSString *const AWSS3TransferUtilityWaitingStatus = @"WAITING";
 
 @end
 
+@implementation AWSS3TransferUtilityMultiPartDownloadTask
+
+- (instancetype)init {
+    if (self = [super init]) {
+        _progress = [NSProgress new];
+        _waitingPartsDictionary = [NSMutableDictionary new];
+        _inProgressPartsDictionary = [NSMutableDictionary new];
+        _completedPartsDictionary = [NSMutableDictionary new];
+    }
+    return self;
+}
+
+- (AWSS3TransferUtilityMultiPartDownloadExpression *)expression {
+    if (!_expression) {
+        _expression = [AWSS3TransferUtilityMultiPartDownloadExpression new];
+    }
+    return _expression;
+}
+
+- (void)updateStatusForSubTask:(AWSS3TransferUtilityDownloadSubTask *)subTask {
+    NSString *transferID = self.transferID;
+    NSDictionary *parameters = @{
+                                 @"transfer_id": transferID,
+                                 @"part_number": subTask.partNumber,
+                                 @"session_task_id": @(subTask.taskIdentifier),
+                                 @"status": subTask.status
+                                 };
+    [self.databaseQueue inDatabase:^(AWSFMDatabase *db) {
+        BOOL result = [db executeUpdate: AWSS3TransferUtilityUpdateMultiPartDownloadSubTask
+                withParameterDictionary:parameters];
+        
+        if (!result) {
+            AWSDDLogError(@"Failed to update transfer_request [%@] in Database. [%@]", transferID,
+                          db.lastError);
+        }
+    }];
+}
+
+- (void)cancel {
+    @synchronized(self) {
+        self.cancelled = YES;
+        for (AWSS3TransferUtilityDownloadSubTask *subTask in [self.inProgressPartsDictionary allValues]) {
+            [subTask.sessionTask cancel];
+        }
+    }
+}
+
+- (void)resume {
+    @synchronized(self) {
+        self.status = AWSS3TransferUtilityInProgressStatus;
+        for (AWSS3TransferUtilityDownloadSubTask *subTask in [self.inProgressPartsDictionary allValues]) {
+            subTask.status = AWSS3TransferUtilityInProgressStatus;
+            [self updateStatusForSubTask:subTask];
+            [subTask.sessionTask resume];
+        }
+    }
+}
+
+- (void)suspend {
+    @synchronized(self) {
+        self.status = AWSS3TransferUtilityPausedStatus;
+        for (AWSS3TransferUtilityDownloadSubTask *subTask in [self.inProgressPartsDictionary allValues]) {
+            [subTask.sessionTask suspend];
+            subTask.status = AWSS3TransferUtilityPausedStatus;
+            [self updateStatusForSubTask:subTask];
+        }
+    }
+}
+
+@end
+
 #pragma mark - AWSS3TransferUtilityExpressions
 
 @implementation AWSS3TransferUtilityExpression
@@ -2636,6 +3540,51 @@ NSString *const AWSS3TransferUtilityWaitingStatus = @"WAITING";
 @implementation AWSS3TransferUtilityDownloadExpression
 @end
 
+@implementation AWSS3TransferUtilityMultiPartDownloadExpression
+
+- (instancetype)init {
+    if (self = [super init]) {
+        _internalRequestHeaders = [NSMutableDictionary new];
+        _internalRequestParameters = [NSMutableDictionary new];
+    }
+    return self;
+}
+
+- (NSDictionary<NSString *, NSString *> *)requestHeaders {
+    return [NSDictionary dictionaryWithDictionary:self.internalRequestHeaders];
+}
+
+- (NSDictionary<NSString *, NSString *> *)requestParameters {
+    return [NSDictionary dictionaryWithDictionary:self.internalRequestParameters];
+}
+
+- (void)setValue:(NSString *)value forRequestHeader:(NSString *)requestHeader {
+    [self.internalRequestHeaders setValue:value forKey:requestHeader];
+}
+
+- (void)setValue:(NSString *)value forRequestParameter:(NSString *)requestParameter {
+    [self.internalRequestParameters setValue:value forKey:requestParameter];
+}
+
+- (void)assignRequestHeaders:(AWSS3GetPreSignedURLRequest *)getPreSignedURLRequest {
+    for (NSString *key in self.internalRequestHeaders) {
+        [getPreSignedURLRequest setValue:self.internalRequestHeaders[key]
+                        forRequestHeader:key];
+    }
+}
+
+- (void)assignRequestParameters:(AWSS3GetPreSignedURLRequest *)getPreSignedURLRequest {
+    for (NSString *key in self.internalRequestParameters) {
+        [getPreSignedURLRequest setValue:self.internalRequestParameters[key]
+                     forRequestParameter:key];
+    }
+}
+
+@end
+
 @implementation AWSS3TransferUtilityUploadSubTask
 @end
 
+@implementation AWSS3TransferUtilityDownloadSubTask
+@end
+
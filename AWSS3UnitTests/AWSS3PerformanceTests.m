@@ -0,0 +1,134 @@
+//
+// Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+
+#import <XCTest/XCTest.h>
+#import "AWSS3PreSignedURL.h"
+#import "AWSS3Resources.h"
+
+@interface AWSS3Resources (AWSS3PerformanceTests)
+
+- (NSString *)definitionString;
+
+@end
+
+static NSUInteger const AWSS3PerformanceTestsPreSignedURLCount = 2000;
+static NSString *const AWSS3PerformanceTestsPreSignedURLBuilderKey = @"AWSS3PerformanceTests";
+
+@interface AWSS3PerformanceTests : XCTestCase
+
+@property (nonatomic, strong) AWSS3PreSignedURLBuilder *preSignedURLBuilder;
+@property (nonatomic, strong) NSArray<NSString *> *keys;
+
+@end
+
+@implementation AWSS3PerformanceTests
+
+- (void)setUp {
+    [super setUp];
+    AWSStaticCredentialsProvider *credentialsProvider = [[AWSStaticCredentialsProvider alloc] initWithAccessKey:@"AKIDEXAMPLE"
+                                                                                                      secretKey:@"wJalrXUtnFEMI/K7MDENG+bPxRfiCYEXAMPLEKEY"];
+    AWSServiceConfiguration *configuration = [[AWSServiceConfiguration alloc] initWithRegion:AWSRegionUSEast1
+                                                                         credentialsProvider:credentialsProvider];
+    [AWSS3PreSignedURLBuilder registerS3PreSignedURLBuilderWithConfiguration:configuration
+                                                                      forKey:AWSS3PerformanceTestsPreSignedURLBuilderKey];
+    self.preSignedURLBuilder = [AWSS3PreSignedURLBuilder S3PreSignedURLBuilderForKey:AWSS3PerformanceTestsPreSignedURLBuilderKey];
+
+    NSMutableArray<NSString *> *keys = [NSMutableArray arrayWithCapacity:AWSS3PerformanceTestsPreSignedURLCount];
+    for (NSUInteger i = 0; i < AWSS3PerformanceTestsPreSignedURLCount; i++) {
+        [keys addObject:[NSString stringWithFormat:@"gallery/%lu/thumbnail-%lu.jpg", (unsigned long)i / 100, (unsigned long)i]];
+    }
+    self.keys = keys;
+}
+
+- (void)tearDown {
+    [AWSS3PreSignedURLBuilder removeS3PreSignedURLBuilderForKey:AWSS3PerformanceTestsPreSignedURLBuilderKey];
+    [super tearDown];
+}
+
+- (AWSS3GetPreSignedURLRequest *)requestWithKey:(NSString *)key {
+    AWSS3GetPreSignedURLRequest *request = [AWSS3GetPreSignedURLRequest new];
+    request.bucket = @"aws-sdk-gallery";
+    request.key = key;
+    request.HTTPMethod = AWSHTTPMethodGET;
+    request.expires = [NSDate dateWithTimeIntervalSinceNow:3600];
+    return request;
+}
+
+- (void)testGetPreSignedURLPerformance {
+    [self measureBlock:^{
+        NSMutableArray<AWSTask *> *tasks = [NSMutableArray arrayWithCapacity:AWSS3PerformanceTestsPreSignedURLCount];
+        for (NSString *key in self.keys) {
+            [tasks addObject:[self.preSignedURLBuilder getPreSignedURL:[self requestWithKey:key]]];
+        }
+        [[AWSTask taskForCompletionOfAllTasks:tasks] waitUntilFinished];
+    }];
+}
+
+- (void)testGetPreSignedURLsPerformance {
+    [self measureBlock:^{
+        NSMutableArray<AWSS3GetPreSignedURLRequest *> *requests = [NSMutableArray arrayWithCapacity:AWSS3PerformanceTestsPreSignedURLCount];
+        for (NSString *key in self.keys) {
+            [requests addObject:[self requestWithKey:key]];
+        }
+        __block NSUInteger count = 0;
+        [[self.preSignedURLBuilder getPreSignedURLs:requests URLBlock:^(NSUInteger index, NSURL *URL, NSError *error) {
+            count++;
+        }] waitUntilFinished];
+        XCTAssertEqual(count, AWSS3PerformanceTestsPreSignedURLCount);
+    }];
+}
+
+- (void)testGetPreSignedURLsForKeysPerformance {
+    [self measureBlock:^{
+        __block NSUInteger count = 0;
+        [[self.preSignedURLBuilder getPreSignedURLsForKeys:self.keys
+                                                   request:[self requestWithKey:@"ignored"]
+                                                  URLBlock:^(NSUInteger index, NSURL *URL, NSError *error) {
+                                                      count++;
+                                                  }] waitUntilFinished];
+        XCTAssertEqual(count, AWSS3PerformanceTestsPreSignedURLCount);
+    }];
+}
+
+#pragma mark - Service definition
+
+// The work before a client's first request: load the definition, then read one operation and its input shape.
+- (void)measureFirstRequestWithDefinitionLoader:(NSDictionary *(^)(NSString *definitionString))loader {
+    NSString *definitionString = [[AWSS3Resources sharedInstance] definitionString];
+
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 10; i++) {
+            NSDictionary *definition = loader(definitionString);
+            NSString *inputShape = definition[@"operations"][@"GetObject"][@"input"][@"shape"];
+            XCTAssertNotNil(definition[@"shapes"][inputShape]);
+        }
+    }];
+}
+
+- (void)testPerformanceFirstRequestWithLazyDefinition {
+    [self measureFirstRequestWithDefinitionLoader:^NSDictionary *(NSString *definitionString) {
+        return [AWSServiceDefinition definitionWithJSONString:definitionString error:nil];
+    }];
+}
+
+- (void)testPerformanceFirstRequestWithJSONSerializationDefinition {
+    [self measureFirstRequestWithDefinitionLoader:^NSDictionary *(NSString *definitionString) {
+        return [NSJSONSerialization JSONObjectWithData:[definitionString dataUsingEncoding:NSUTF8StringEncoding]
+                                               options:kNilOptions
+                                                 error:nil];
+    }];
+}
+
+@end
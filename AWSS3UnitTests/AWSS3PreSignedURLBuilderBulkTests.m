@@ -0,0 +1,272 @@
+//
+// Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+
+#import <XCTest/XCTest.h>
+#import "AWSTestUtility.h"
+#import "AWSS3PreSignedURL.h"
+
+static NSString *const AWSS3PreSignedURLBuilderBulkTestsKey = @"AWSS3PreSignedURLBuilderBulkTests";
+
+// Hands out the same temporary credentials every time and counts how often it is asked.
+@interface AWSS3PreSignedURLBuilderBulkTestsCredentialsProvider : NSObject <AWSCredentialsProvider>
+
+@property (atomic, assign) NSUInteger credentialsCount;
+@property (nonatomic, strong) AWSCredentials *internalCredentials;
+
+@end
+
+@implementation AWSS3PreSignedURLBuilderBulkTestsCredentialsProvider
+
+- (AWSTask<AWSCredentials *> *)credentials {
+    self.credentialsCount++;
+    return [AWSTask taskWithResult:self.internalCredentials];
+}
+
+- (void)invalidateCachedTemporaryCredentials {
+}
+
+@end
+
+@interface AWSS3PreSignedURLBuilderBulkTests : XCTestCase
+
+@property (nonatomic, strong) AWSS3PreSignedURLBuilderBulkTestsCredentialsProvider *credentialsProvider;
+@property (nonatomic, strong) AWSS3PreSignedURLBuilder *preSignedURLBuilder;
+
+@end
+
+@implementation AWSS3PreSignedURLBuilderBulkTests
+
+- (void)setUp {
+    [super setUp];
+    // Both paths read the signing date from [NSDate date].
+    [AWSTestUtility setupSwizzling];
+
+    self.credentialsProvider = [AWSS3PreSignedURLBuilderBulkTestsCredentialsProvider new];
+    self.credentialsProvider.internalCredentials = [[AWSCredentials alloc] initWithAccessKey:@"AKIDEXAMPLE"
+                                                                                   secretKey:@"wJalrXUtnFEMI/K7MDENG+bPxRfiCYEXAMPLEKEY"
+                                                                                  sessionKey:@"session/token+with=reserved&characters"
+                                                                                  expiration:[NSDate dateWithTimeIntervalSinceNow:60 * 60 * 6]];
+    AWSServiceConfiguration *configuration = [[AWSServiceConfiguration alloc] initWithRegion:AWSRegionEUCentral1
+                                                                         credentialsProvider:self.credentialsProvider];
+    [AWSS3PreSignedURLBuilder registerS3PreSignedURLBuilderWithConfiguration:configuration
+                                                                      forKey:AWSS3PreSignedURLBuilderBulkTestsKey];
+    self.preSignedURLBuilder = [AWSS3PreSignedURLBuilder S3PreSignedURLBuilderForKey:AWSS3PreSignedURLBuilderBulkTestsKey];
+}
+
+- (void)tearDown {
+    [AWSS3PreSignedURLBuilder removeS3PreSignedURLBuilderForKey:AWSS3PreSignedURLBuilderBulkTestsKey];
+    [AWSTestUtility revertSwizzling];
+    [super tearDown];
+}
+
+// Most of a second past the hour keeps X-Amz-Expires the same while a test runs.
+- (AWSS3GetPreSignedURLRequest *)requestWithBucket:(NSString *)bucket key:(NSString *)key {
+    AWSS3GetPreSignedURLRequest *request = [AWSS3GetPreSignedURLRequest new];
+    request.bucket = bucket;
+    request.key = key;
+    request.HTTPMethod = AWSHTTPMethodGET;
+    request.expires = [NSDate dateWithTimeIntervalSinceNow:3600.9];
+    return request;
+}
+
+- (NSArray<AWSS3GetPreSignedURLRequest *> *)variedRequests {
+    AWSS3GetPreSignedURLRequest *virtualHosted = [self requestWithBucket:@"aws-sdk-bucket" key:@"photos/2018/IMG 0001.jpg"];
+
+    AWSS3GetPreSignedURLRequest *pathStyle = [self requestWithBucket:@"aws.sdk.bucket.with.dots" key:@"résumé+notes?.txt"];
+
+    AWSS3GetPreSignedURLRequest *accelerated = [self requestWithBucket:@"aws-sdk-bucket" key:@"video.mp4"];
+    accelerated.accelerateModeEnabled = YES;
+
+    AWSS3GetPreSignedURLRequest *upload = [self requestWithBucket:@"aws-sdk-bucket" key:@"uploads/data.json"];
+    upload.HTTPMethod = AWSHTTPMethodPUT;
+    upload.contentType = @"application/json";
+    upload.contentMD5 = @"1B2M2Y8AsgTpgAmY7PhCfg==";
+    [upload setValue:@"AES256" forRequestHeader:AWSS3PresignedURLServerSideEncryption];
+
+    AWSS3GetPreSignedURLRequest *versioned = [self requestWithBucket:@"aws-sdk-bucket" key:@"versioned"];
+    versioned.HTTPMethod = AWSHTTPMethodHEAD;
+    [versioned setValue:@"3/L4kqtJlcpXroDTDmJ+rmSpXd3dIbrHY+MTRCxf3vjVBH40Nr8X8gdRQBpUMLUo" forRequestParameter:AWSS3PresignedURLVersionID];
+    [versioned setValue:@"" forRequestParameter:AWSS3PresignedURLTorrent];
+
+    return @[virtualHosted, pathStyle, accelerated, upload, versioned];
+}
+
+- (NSURL *)singleURLForRequest:(AWSS3GetPreSignedURLRequest *)request {
+    AWSTask<NSURL *> *task = [self.preSignedURLBuilder getPreSignedURL:request];
+    [task waitUntilFinished];
+    XCTAssertNil(task.error);
+    return task.result;
+}
+
+- (NSMutableDictionary<NSNumber *, id> *)resultsOfTask:(AWSTask *(^)(AWSS3PreSignedURLBuilderURLBlock URLBlock))block {
+    NSMutableDictionary<NSNumber *, id> *results = [NSMutableDictionary new];
+    __block NSUInteger nextIndex = 0;
+    AWSTask *task = block(^(NSUInteger index, NSURL *URL, NSError *error) {
+        XCTAssertEqual(index, nextIndex);
+        nextIndex++;
+        XCTAssertTrue((URL == nil) != (error == nil));
+        results[@(index)] = URL ?: error;
+    });
+    [task waitUntilFinished];
+    XCTAssertNil(task.error);
+    return results;
+}
+
+- (void)testRequestsMatchSingleURLs {
+    NSArray<AWSS3GetPreSignedURLRequest *> *requests = [self variedRequests];
+    NSDictionary<NSNumber *, id> *results = [self resultsOfTask:^AWSTask *(AWSS3PreSignedURLBuilderURLBlock URLBlock) {
+        return [self.preSignedURLBuilder getPreSignedURLs:requests URLBlock:URLBlock];
+    }];
+
+    XCTAssertEqual(results.count, requests.count);
+    [requests enumerateObjectsUsingBlock:^(AWSS3GetPreSignedURLRequest *request, NSUInteger index, BOOL *stop) {
+        NSURL *URL = results[@(index)];
+        XCTAssertEqualObjects([URL absoluteString], [[self singleURLForRequest:request] absoluteString]);
+        XCTAssertTrue([[URL query] containsString:@"X-Amz-Security-Token="]);
+    }];
+}
+
+- (void)testKeysMatchSingleURLs {
+    NSMutableArray<NSString *> *keys = [NSMutableArray new];
+    for (NSUInteger i = 0; i < 200; i++) {
+        [keys addObject:[NSString stringWithFormat:@"gallery/album %lu/photo-%lu.jpg", (unsigned long)i / 20, (unsigned long)i]];
+    }
+    AWSS3GetPreSignedURLRequest *request = [self requestWithBucket:@"aws-sdk-bucket" key:@"ignored"];
+    [request setValue:@"inline" forRequestParameter:@"response-content-disposition"];
+
+    NSDictionary<NSNumber *, id> *results = [self resultsOfTask:^AWSTask *(AWSS3PreSignedURLBuilderURLBlock URLBlock) {
+        return [self.preSignedURLBuilder getPreSignedURLsForKeys:keys request:request URLBlock:URLBlock];
+    }];
+
+    XCTAssertEqual(results.count, keys.count);
+    [keys enumerateObjectsUsingBlock:^(NSString *key, NSUInteger index, BOOL *stop) {
+        AWSS3GetPreSignedURLRequest *singleRequest = [self requestWithBucket:@"aws-sdk-bucket" key:key];
+        singleRequest.expires = request.expires;
+        [singleRequest setValue:@"inline" forRequestParameter:@"response-content-disposition"];
+        XCTAssertEqualObjects([results[@(index)] absoluteString], [[self singleURLForRequest:singleRequest] absoluteString]);
+    }];
+}
+
+- (void)testStaticCredentialsMatchSingleURLs {
+    AWSStaticCredentialsProvider *credentialsProvider = [[AWSStaticCredentialsProvider alloc] initWithAccessKey:@"AKIDEXAMPLE"
+                                                                                                      secretKey:@"wJalrXUtnFEMI/K7MDENG+bPxRfiCYEXAMPLEKEY"];
+    AWSServiceConfiguration *configuration = [[AWSServiceConfiguration alloc] initWithRegion:AWSRegionUSEast1
+                                                                         credentialsProvider:credentialsProvider];
+    [AWSS3PreSignedURLBuilder registerS3PreSignedURLBuilderWithConfiguration:configuration
+                                                                      forKey:AWSS3PreSignedURLBuilderBulkTestsKey];
+    self.preSignedURLBuilder = [AWSS3PreSignedURLBuilder S3PreSignedURLBuilderForKey:AWSS3PreSignedURLBuilderBulkTestsKey];
+
+    NSArray<AWSS3GetPreSignedURLRequest *> *requests = [self variedRequests];
+    NSDictionary<NSNumber *, id> *results = [self resultsOfTask:^AWSTask *(AWSS3PreSignedURLBuilderURLBlock URLBlock) {
+        return [self.preSignedURLBuilder getPreSignedURLs:requests URLBlock:URLBlock];
+    }];
+
+    [requests enumerateObjectsUsingBlock:^(AWSS3GetPreSignedURLRequest *request, NSUInteger index, BOOL *stop) {
+        NSURL *URL = results[@(index)];
+        XCTAssertEqualObjects([URL absoluteString], [[self singleURLForRequest:request] absoluteString]);
+        XCTAssertFalse([[URL query] containsString:@"X-Amz-Security-Token="]);
+    }];
+}
+
+- (void)testCredentialsAndSigningKeyAreShared {
+    NSMutableArray<NSString *> *keys = [NSMutableArray new];
+    for (NSUInteger i = 0; i < 500; i++) {
+        [keys addObject:[NSString stringWithFormat:@"object-%lu", (unsigned long)i]];
+    }
+    AWSS3GetPreSignedURLRequest *request = [self requestWithBucket:@"aws-sdk-bucket" key:@"ignored"];
+
+    NSDictionary<NSNumber *, id> *results = [self resultsOfTask:^AWSTask *(AWSS3PreSignedURLBuilderURLBlock URLBlock) {
+        return [self.preSignedURLBuilder getPreSignedURLsForKeys:keys request:request URLBlock:URLBlock];
+    }];
+    XCTAssertEqual(results.count, keys.count);
+    XCTAssertEqual(self.credentialsProvider.credentialsCount, 1);
+
+    NSData *signingKey = [self.preSignedURLBuilder valueForKey:@"signingKey"];
+    XCTAssertNotNil(signingKey);
+    [self resultsOfTask:^AWSTask *(AWSS3PreSignedURLBuilderURLBlock URLBlock) {
+        return [self.preSignedURLBuilder getPreSignedURLs:[self variedRequests] URLBlock:URLBlock];
+    }];
+    XCTAssertEqual(self.credentialsProvider.credentialsCount, 2);
+    XCTAssertEqual([self.preSignedURLBuilder valueForKey:@"signingKey"], signingKey);
+}
+
+- (void)testExpiringCredentialsAreRefreshedOnce {
+    self.credentialsProvider.internalCredentials = [[AWSCredentials alloc] initWithAccessKey:@"AKIDEXAMPLE"
+                                                                                   secretKey:@"wJalrXUtnFEMI/K7MDENG+bPxRfiCYEXAMPLEKEY"
+                                                                                  sessionKey:@"token"
+                                                                                  expiration:[NSDate dateWithTimeIntervalSinceNow:60]];
+    NSArray<AWSS3GetPreSignedURLRequest *> *requests = [self variedRequests];
+    [self resultsOfTask:^AWSTask *(AWSS3PreSignedURLBuilderURLBlock URLBlock) {
+        return [self.preSignedURLBuilder getPreSignedURLs:requests URLBlock:URLBlock];
+    }];
+
+    XCTAssertEqual(self.credentialsProvider.credentialsCount, 2);
+}
+
+- (void)testInvalidRequestsAreReportedByIndex {
+    AWSS3GetPreSignedURLRequest *noKey = [self requestWithBucket:@"aws-sdk-bucket" key:@""];
+    AWSS3GetPreSignedURLRequest *noExpires = [self requestWithBucket:@"aws-sdk-bucket" key:@"key"];
+    noExpires.expires = nil;
+    AWSS3GetPreSignedURLRequest *tooLate = [self requestWithBucket:@"aws-sdk-bucket" key:@"key"];
+    tooLate.expires = [NSDate dateWithTimeIntervalSinceNow:60 * 60 * 24 * 8];
+    AWSS3GetPreSignedURLRequest *post = [self requestWithBucket:@"aws-sdk-bucket" key:@"key"];
+    post.HTTPMethod = AWSHTTPMethodPOST;
+    AWSS3GetPreSignedURLRequest *valid = [self requestWithBucket:@"aws-sdk-bucket" key:@"key"];
+
+    NSDictionary<NSNumber *, id> *results = [self resultsOfTask:^AWSTask *(AWSS3PreSignedURLBuilderURLBlock URLBlock) {
+        return [self.preSignedURLBuilder getPreSignedURLs:@[noKey, noExpires, tooLate, post, valid] URLBlock:URLBlock];
+    }];
+
+    XCTAssertEqual([results[@0] code], AWSS3PresignedURLErrorKeyNameIsNil);
+    XCTAssertEqual([results[@1] code], AWSS3PresignedURLErrorInvalidExpiresDate);
+    XCTAssertEqual([results[@2] code], AWSS3PresignedURLErrorInvalidExpiresDate);
+    XCTAssertEqual([results[@3] code], AWSS3PresignedURLErrorUnsupportedHTTPVerbs);
+    XCTAssertEqualObjects([results[@4] absoluteString], [[self singleURLForRequest:valid] absoluteString]);
+
+    results = [self resultsOfTask:^AWSTask *(AWSS3PreSignedURLBuilderURLBlock URLBlock) {
+        return [self.preSignedURLBuilder getPreSignedURLsForKeys:@[@"a", @"", @"c"] request:valid URLBlock:URLBlock];
+    }];
+    XCTAssertTrue([results[@0] isKindOfClass:[NSURL class]]);
+    XCTAssertEqual([results[@1] code], AWSS3PresignedURLErrorKeyNameIsNil);
+    XCTAssertTrue([results[@2] isKindOfClass:[NSURL class]]);
+}
+
+- (void)testMissingCredentialsProviderFailsBatch {
+    AWSServiceConfiguration *configuration = [[AWSServiceConfiguration alloc] initWithRegion:AWSRegionUSEast1
+                                                                         credentialsProvider:nil];
+    [AWSS3PreSignedURLBuilder registerS3PreSignedURLBuilderWithConfiguration:configuration
+                                                                      forKey:AWSS3PreSignedURLBuilderBulkTestsKey];
+    AWSS3PreSignedURLBuilder *preSignedURLBuilder = [AWSS3PreSignedURLBuilder S3PreSignedURLBuilderForKey:AWSS3PreSignedURLBuilderBulkTestsKey];
+
+    AWSTask *task = [preSignedURLBuilder getPreSignedURLs:[self variedRequests] URLBlock:^(NSUInteger index, NSURL *URL, NSError *error) {
+        XCTFail(@"No URL is built without credentials.");
+    }];
+    [task waitUntilFinished];
+
+    XCTAssertEqualObjects(task.error.domain, AWSS3PresignedURLErrorDomain);
+    XCTAssertEqual(task.error.code, AWSS3PreSignedURLErrorCredentialProviderIsNil);
+}
+
+- (void)testNoRequests {
+    AWSTask *task = [self.preSignedURLBuilder getPreSignedURLs:@[] URLBlock:^(NSUInteger index, NSURL *URL, NSError *error) {
+        XCTFail(@"There is nothing to sign.");
+    }];
+    [task waitUntilFinished];
+
+    XCTAssertNil(task.error);
+    XCTAssertEqual(self.credentialsProvider.credentialsCount, 0);
+}
+
+@end
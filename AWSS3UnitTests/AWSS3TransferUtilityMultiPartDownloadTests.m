@@ -0,0 +1,383 @@
+//
+// Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+
+#import <XCTest/XCTest.h>
+#import "AWSS3TransferUtility.h"
+#import "AWSTestHTTPServer.h"
+
+// A dotted bucket name is addressed path style, so every request goes to the local server.
+static NSString *const AWSS3TransferUtilityMultiPartDownloadTestsBucket = @"aws.sdk.tests";
+static NSString *const AWSS3TransferUtilityMultiPartDownloadTestsObjectKey = @"multipart/download.bin";
+static long long const AWSS3TransferUtilityMultiPartDownloadTestsPartSize = 256 * 1024;
+static NSUInteger const AWSS3TransferUtilityMultiPartDownloadTestsObjectSize = 4 * 256 * 1024 + 123;
+static NSTimeInterval const AWSS3TransferUtilityMultiPartDownloadTestsTimeout = 30;
+
+@interface AWSS3TransferUtility()
+
+- (void) recover:(void (^)(AWSS3TransferUtilityUploadTask *uploadTask,
+                           AWSS3TransferUtilityProgressBlock *uploadProgressBlockReference,
+                           AWSS3TransferUtilityUploadCompletionHandlerBlock *completionHandlerReference))uploadBlocksAssigner
+multiPartUploadBlocksAssigner: (void (^) (AWSS3TransferUtilityMultiPartUploadTask *multiPartUploadTask,
+                                          AWSS3TransferUtilityMultiPartProgressBlock *multiPartUploadProgressBlockReference,
+                                          AWSS3TransferUtilityMultiPartUploadCompletionHandlerBlock *completionHandlerReference)) multiPartUploadBlocksAssigner
+downloadBlocksAssigner:(void (^)(AWSS3TransferUtilityDownloadTask *downloadTask,
+                                 AWSS3TransferUtilityProgressBlock *downloadProgressBlockReference,
+                                 AWSS3TransferUtilityDownloadCompletionHandlerBlock *completionHandlerReference))downloadBlocksAssigner
+completionHandler:(void (^)(NSError *_Nullable error)) completionHandler;
+
+@end
+
+@interface AWSS3TransferUtilityMultiPartDownloadTests : XCTestCase
+
+@property (nonatomic, strong) AWSTestHTTPServer *server;
+@property (nonatomic, strong) NSData *data;
+
+// The object the server serves. It answers HEAD and ranged GET requests and honors If-Match against the ETag.
+@property (atomic, strong) NSData *objectData;
+@property (atomic, strong) NSString *eTag;
+
+// The number of upcoming GET requests that send half of their body and then close the connection.
+@property (atomic, assign) NSUInteger dropConnectionCount;
+
+// GET requests whose range starts at or after this offset wait until -releaseHeldRequests. -1 serves them right away.
+@property (atomic, assign) long long holdRangesFromOffset;
+@property (atomic, assign) NSUInteger heldRequestCount;
+@property (nonatomic, strong) NSMutableArray<dispatch_semaphore_t> *heldRequests;
+@property (nonatomic, strong) NSString *transferUtilityKey;
+@property (nonatomic, strong) NSURL *fileURL;
+@property (atomic, strong) NSError *downloadError;
+
+@end
+
+@implementation AWSS3TransferUtilityMultiPartDownloadTests
+
+- (void)setUp {
+    [super setUp];
+    NSMutableData *data = [NSMutableData dataWithLength:AWSS3TransferUtilityMultiPartDownloadTestsObjectSize];
+    arc4random_buf([data mutableBytes], [data length]);
+    self.data = data;
+
+    [self replaceObjectWithData:data];
+    self.holdRangesFromOffset = -1;
+    self.heldRequests = [NSMutableArray new];
+
+    __weak AWSS3TransferUtilityMultiPartDownloadTests *weakSelf = self;
+    self.server = [AWSTestHTTPServer new];
+    self.server.responseHandler = ^AWSTestHTTPResponse *(AWSTestHTTPRequest *request) {
+        return [weakSelf responseToRequest:request];
+    };
+    XCTAssertTrue([self.server start]);
+
+    // The transfer utility persists its transfers per key, so a fresh key keeps the tests apart.
+    self.transferUtilityKey = [[NSUUID UUID] UUIDString];
+    self.fileURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]]];
+}
+
+- (void)tearDown {
+    [AWSS3TransferUtility removeS3TransferUtilityForKey:self.transferUtilityKey];
+    [self releaseHeldRequests];
+    [self.server stop];
+    [[NSFileManager defaultManager] removeItemAtURL:self.fileURL error:nil];
+    [super tearDown];
+}
+
+#pragma mark - Server
+
+- (void)replaceObjectWithData:(NSData *)data {
+    @synchronized(self) {
+        self.objectData = data;
+        self.eTag = [NSString stringWithFormat:@"\"%@\"", [[NSUUID UUID] UUIDString]];
+    }
+}
+
+- (void)releaseHeldRequests {
+    NSArray<dispatch_semaphore_t> *heldRequests = nil;
+    @synchronized(self) {
+        heldRequests = [self.heldRequests copy];
+        [self.heldRequests removeAllObjects];
+        self.heldRequestCount = 0;
+    }
+    for (dispatch_semaphore_t semaphore in heldRequests) {
+        dispatch_semaphore_signal(semaphore);
+    }
+}
+
+- (AWSTestHTTPResponse *)responseToRequest:(AWSTestHTTPRequest *)request {
+    NSString *range = request.headers[@"range"];
+    long long start = 0;
+    long long end = -1;
+    if (range) {
+        sscanf([range UTF8String], "bytes=%lld-%lld", &start, &end);
+    }
+
+    // Hold before looking at the object, so a replacement while held is seen by If-Match.
+    long long holdRangesFromOffset = self.holdRangesFromOffset;
+    if ([request.method isEqualToString:@"GET"] && holdRangesFromOffset >= 0 && start >= holdRangesFromOffset) {
+        dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+        @synchronized(self) {
+            [self.heldRequests addObject:semaphore];
+            self.heldRequestCount = [self.heldRequests count];
+        }
+        dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER);
+    }
+
+    NSData *data = nil;
+    NSString *eTag = nil;
+    @synchronized(self) {
+        data = self.objectData;
+        eTag = self.eTag;
+    }
+
+    NSString *ifMatch = request.headers[@"if-match"];
+    if (ifMatch && ![ifMatch isEqualToString:eTag]) {
+        NSData *body = [@"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<Error><Code>PreconditionFailed</Code><Message>At least one of the pre-conditions you specified did not hold</Message></Error>"
+                        dataUsingEncoding:NSUTF8StringEncoding];
+        return [AWSTestHTTPResponse responseWithStatus:@"412 Precondition Failed" headers:@{@"Content-Type": @"application/xml"} body:body];
+    }
+
+    long long length = (long long)[data length];
+    if ([request.method isEqualToString:@"HEAD"]) {
+        NSDictionary *headers = @{@"ETag": eTag,
+                                  @"Accept-Ranges": @"bytes",
+                                  @"Content-Length": [NSString stringWithFormat:@"%lld", length]};
+        return [AWSTestHTTPResponse responseWithStatus:@"200 OK" headers:headers body:nil];
+    }
+
+    NSString *status = @"200 OK";
+    NSMutableDictionary *headers = [NSMutableDictionary dictionaryWithObject:eTag forKey:@"ETag"];
+    if (range) {
+        if (end < 0 || end >= length) {
+            end = length - 1;
+        }
+        if (start > end) {
+            return [AWSTestHTTPResponse responseWithStatus:@"416 Requested Range Not Satisfiable"
+                                                   headers:@{@"Content-Range": [NSString stringWithFormat:@"bytes */%lld", length]}
+                                                      body:nil];
+        }
+        status = @"206 Partial Content";
+        headers[@"Content-Range"] = [NSString stringWithFormat:@"bytes %lld-%lld/%lld", start, end, length];
+        data = [data subdataWithRange:NSMakeRange((NSUInteger)start, (NSUInteger)(end - start + 1))];
+    }
+
+    AWSTestHTTPResponse *response = [AWSTestHTTPResponse responseWithStatus:status headers:headers body:data];
+    @synchronized(self) {
+        if (self.dropConnectionCount > 0) {
+            self.dropConnectionCount--;
+            response.dropConnectionAfterLength = [data length] / 2;
+        }
+    }
+    return response;
+}
+
+#pragma mark - Helpers
+
+- (AWSS3TransferUtility *)registerTransferUtilityWithConcurrencyLimit:(NSInteger)concurrencyLimit {
+    AWSStaticCredentialsProvider *credentialsProvider = [[AWSStaticCredentialsProvider alloc] initWithAccessKey:@"AKIDEXAMPLE"
+                                                                                                      secretKey:@"wJalrXUtnFEMI/K7MDENG+bPxRfiCYEXAMPLEKEY"];
+    AWSEndpoint *endpoint = [[AWSEndpoint alloc] initWithRegion:AWSRegionUSEast1
+                                                        service:AWSServiceS3
+                                                            URL:self.server.URL];
+    AWSServiceConfiguration *configuration = [[AWSServiceConfiguration alloc] initWithRegion:AWSRegionUSEast1
+                                                                                    endpoint:endpoint
+                                                                         credentialsProvider:credentialsProvider];
+    AWSS3TransferUtilityConfiguration *transferUtilityConfiguration = [AWSS3TransferUtilityConfiguration new];
+    transferUtilityConfiguration.bucket = AWSS3TransferUtilityMultiPartDownloadTestsBucket;
+    transferUtilityConfiguration.retryLimit = 3;
+    transferUtilityConfiguration.multiPartConcurrencyLimit = @(concurrencyLimit);
+    transferUtilityConfiguration.multiPartDownloadPartSize = @(AWSS3TransferUtilityMultiPartDownloadTestsPartSize);
+
+    [AWSS3TransferUtility registerS3TransferUtilityWithConfiguration:configuration
+                                        transferUtilityConfiguration:transferUtilityConfiguration
+                                                              forKey:self.transferUtilityKey];
+    AWSS3TransferUtility *transferUtility = [AWSS3TransferUtility S3TransferUtilityForKey:self.transferUtilityKey];
+
+    // The test bundle has no host app for a background session, so the ranges go through a default session.
+    NSURLSession *session = [NSURLSession sessionWithConfiguration:[NSURLSessionConfiguration defaultSessionConfiguration]
+                                                          delegate:transferUtility
+                                                     delegateQueue:nil];
+    [transferUtility setValue:session forKey:@"session"];
+    return transferUtility;
+}
+
+- (AWSS3TransferUtilityMultiPartDownloadCompletionHandlerBlock)completionHandlerWithExpectation:(XCTestExpectation *)expectation {
+    return ^(AWSS3TransferUtilityMultiPartDownloadTask *task, NSURL *location, NSError *error) {
+        self.downloadError = error;
+        [expectation fulfill];
+    };
+}
+
+- (NSArray<NSString *> *)rangesFromPartNumber:(NSUInteger)partNumber {
+    NSMutableArray<NSString *> *ranges = [NSMutableArray new];
+    for (long long start = (partNumber - 1) * AWSS3TransferUtilityMultiPartDownloadTestsPartSize;
+         start < (long long)[self.data length];
+         start += AWSS3TransferUtilityMultiPartDownloadTestsPartSize) {
+        long long end = MIN(start + AWSS3TransferUtilityMultiPartDownloadTestsPartSize, (long long)[self.data length]) - 1;
+        [ranges addObject:[NSString stringWithFormat:@"bytes=%lld-%lld", start, end]];
+    }
+    return ranges;
+}
+
+- (NSArray<AWSTestHTTPRequest *> *)requestsWithMethod:(NSString *)method {
+    return [self.server.requestLog filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"method == %@", method]];
+}
+
+- (void)testDownloadsRangesConcurrently {
+    AWSS3TransferUtility *transferUtility = [self registerTransferUtilityWithConcurrencyLimit:3];
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"The download completes."];
+    __block NSError *downloadError = nil;
+    __block NSURL *downloadLocation = nil;
+    __block int64_t completedUnitCount = 0;
+    AWSS3TransferUtilityMultiPartDownloadExpression *expression = [AWSS3TransferUtilityMultiPartDownloadExpression new];
+    expression.progressBlock = ^(AWSS3TransferUtilityMultiPartDownloadTask *task, NSProgress *progress) {
+        completedUnitCount = progress.completedUnitCount;
+    };
+    AWSTask *downloadTask = [transferUtility downloadToURLUsingMultiPart:self.fileURL
+                                                                     key:AWSS3TransferUtilityMultiPartDownloadTestsObjectKey
+                                                              expression:expression
+                                                       completionHandler:^(AWSS3TransferUtilityMultiPartDownloadTask *task, NSURL *location, NSError *error) {
+                                                           downloadError = error;
+                                                           downloadLocation = location;
+                                                           [expectation fulfill];
+                                                       }];
+    [self waitForExpectationsWithTimeout:AWSS3TransferUtilityMultiPartDownloadTestsTimeout handler:nil];
+
+    XCTAssertNil(downloadTask.error);
+    XCTAssertNil(downloadError);
+    XCTAssertEqualObjects(downloadLocation, self.fileURL);
+    XCTAssertEqualObjects([NSData dataWithContentsOfURL:self.fileURL], self.data);
+    XCTAssertEqual(completedUnitCount, (int64_t)[self.data length]);
+
+    XCTAssertEqual([[self requestsWithMethod:@"HEAD"] count], 1);
+    NSArray<AWSTestHTTPRequest *> *getRequests = [self requestsWithMethod:@"GET"];
+    XCTAssertEqualObjects([NSSet setWithArray:[getRequests valueForKeyPath:@"headers.range"]], [NSSet setWithArray:[self rangesFromPartNumber:1]]);
+    XCTAssertEqual([getRequests count], [[self rangesFromPartNumber:1] count]);
+    for (AWSTestHTTPRequest *request in getRequests) {
+        XCTAssertEqualObjects(request.headers[@"if-match"], self.eTag);
+    }
+}
+
+- (void)testRetriesDroppedConnections {
+    AWSS3TransferUtility *transferUtility = [self registerTransferUtilityWithConcurrencyLimit:3];
+    self.dropConnectionCount = 2;
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"The download completes."];
+    [transferUtility downloadToURLUsingMultiPart:self.fileURL
+                                             key:AWSS3TransferUtilityMultiPartDownloadTestsObjectKey
+                                      expression:nil
+                               completionHandler:[self completionHandlerWithExpectation:expectation]];
+    [self waitForExpectationsWithTimeout:AWSS3TransferUtilityMultiPartDownloadTestsTimeout handler:nil];
+
+    XCTAssertNil(self.downloadError);
+    XCTAssertEqualObjects([NSData dataWithContentsOfURL:self.fileURL], self.data);
+    XCTAssertEqual(self.dropConnectionCount, 0);
+    XCTAssertEqual([[self requestsWithMethod:@"GET"] count], [[self rangesFromPartNumber:1] count] + 2);
+}
+
+- (void)testRetryLimitAppliesToEachRange {
+    // More dropped connections than the retry limit, one for each range.
+    NSUInteger rangeCount = [[self rangesFromPartNumber:1] count];
+    AWSS3TransferUtility *transferUtility = [self registerTransferUtilityWithConcurrencyLimit:rangeCount];
+    self.dropConnectionCount = rangeCount;
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"The download completes."];
+    [transferUtility downloadToURLUsingMultiPart:self.fileURL
+                                             key:AWSS3TransferUtilityMultiPartDownloadTestsObjectKey
+                                      expression:nil
+                               completionHandler:[self completionHandlerWithExpectation:expectation]];
+    [self waitForExpectationsWithTimeout:AWSS3TransferUtilityMultiPartDownloadTestsTimeout handler:nil];
+
+    XCTAssertGreaterThan(rangeCount, 3);
+    XCTAssertNil(self.downloadError);
+    XCTAssertEqualObjects([NSData dataWithContentsOfURL:self.fileURL], self.data);
+    XCTAssertEqual([[self requestsWithMethod:@"GET"] count], 2 * rangeCount);
+}
+
+- (void)testFailsWhenObjectIsModified {
+    AWSS3TransferUtility *transferUtility = [self registerTransferUtilityWithConcurrencyLimit:2];
+    self.holdRangesFromOffset = 2 * AWSS3TransferUtilityMultiPartDownloadTestsPartSize;
+
+    XCTestExpectation *heldExpectation = [self expectationForPredicate:[NSPredicate predicateWithFormat:@"heldRequestCount == 2"]
+                                                   evaluatedWithObject:self
+                                                               handler:nil];
+    XCTestExpectation *expectation = [self expectationWithDescription:@"The download fails."];
+    [transferUtility downloadToURLUsingMultiPart:self.fileURL
+                                             key:AWSS3TransferUtilityMultiPartDownloadTestsObjectKey
+                                      expression:nil
+                               completionHandler:[self completionHandlerWithExpectation:expectation]];
+    [self waitForExpectations:@[heldExpectation] timeout:AWSS3TransferUtilityMultiPartDownloadTestsTimeout];
+
+    // Overwrite the object while the third and fourth ranges are in flight.
+    [self replaceObjectWithData:[self.data subdataWithRange:NSMakeRange(0, [self.data length] / 2)]];
+    [self releaseHeldRequests];
+    [self waitForExpectations:@[expectation] timeout:AWSS3TransferUtilityMultiPartDownloadTestsTimeout];
+
+    XCTAssertEqualObjects(self.downloadError.domain, AWSS3TransferUtilityErrorDomain);
+    XCTAssertEqual(self.downloadError.code, AWSS3TransferUtilityErrorObjectModified);
+    XCTAssertFalse([[NSFileManager defaultManager] fileExistsAtPath:[self.fileURL path]]);
+}
+
+- (void)testResumesOnlyMissingRangesAfterRelaunch {
+    AWSS3TransferUtility *transferUtility = [self registerTransferUtilityWithConcurrencyLimit:2];
+    self.holdRangesFromOffset = 2 * AWSS3TransferUtilityMultiPartDownloadTestsPartSize;
+
+    XCTestExpectation *heldExpectation = [self expectationForPredicate:[NSPredicate predicateWithFormat:@"heldRequestCount == 2"]
+                                                   evaluatedWithObject:self
+                                                               handler:nil];
+    [transferUtility downloadToURLUsingMultiPart:self.fileURL
+                                             key:AWSS3TransferUtilityMultiPartDownloadTestsObjectKey
+                                      expression:nil
+                               completionHandler:^(AWSS3TransferUtilityMultiPartDownloadTask *task, NSURL *location, NSError *error) {
+                                   XCTFail(@"The download should not complete before the relaunch.");
+                               }];
+    [self waitForExpectations:@[heldExpectation] timeout:AWSS3TransferUtilityMultiPartDownloadTestsTimeout];
+
+    // Tear down the session with the third and fourth ranges in flight, as if the app was terminated.
+    XCTestExpectation *invalidatedExpectation = [self expectationForNotification:AWSS3TransferUtilityURLSessionDidBecomeInvalidNotification
+                                                                          object:transferUtility
+                                                                         handler:nil];
+    [AWSS3TransferUtility removeS3TransferUtilityForKey:self.transferUtilityKey];
+    [self waitForExpectations:@[invalidatedExpectation] timeout:AWSS3TransferUtilityMultiPartDownloadTestsTimeout];
+
+    self.holdRangesFromOffset = -1;
+    [self releaseHeldRequests];
+    [self.server resetRequestLog];
+
+    AWSS3TransferUtility *relaunchedTransferUtility = [self registerTransferUtilityWithConcurrencyLimit:2];
+    XCTestExpectation *expectation = [self expectationWithDescription:@"The recovered download completes."];
+    __block NSUInteger recoveredCount = 0;
+    [relaunchedTransferUtility recover:nil
+         multiPartUploadBlocksAssigner:nil
+                downloadBlocksAssigner:nil
+                     completionHandler:^(NSError *error) {
+                         [relaunchedTransferUtility enumerateToAssignBlocksForMultiPartDownloadTask:^(AWSS3TransferUtilityMultiPartDownloadTask *multiPartDownloadTask,
+                                                                                                      AWSS3TransferUtilityMultiPartDownloadProgressBlock *multiPartDownloadProgressBlockReference,
+                                                                                                      AWSS3TransferUtilityMultiPartDownloadCompletionHandlerBlock *completionHandlerReference) {
+                             recoveredCount++;
+                             *completionHandlerReference = [self completionHandlerWithExpectation:expectation];
+                         }];
+                     }];
+    [self waitForExpectations:@[expectation] timeout:AWSS3TransferUtilityMultiPartDownloadTestsTimeout];
+
+    XCTAssertEqual(recoveredCount, 1);
+    XCTAssertNil(self.downloadError);
+    XCTAssertEqualObjects([NSData dataWithContentsOfURL:self.fileURL], self.data);
+    XCTAssertEqual([[self requestsWithMethod:@"HEAD"] count], 0);
+    NSArray<AWSTestHTTPRequest *> *getRequests = [self requestsWithMethod:@"GET"];
+    XCTAssertEqualObjects([NSSet setWithArray:[getRequests valueForKeyPath:@"headers.range"]], [NSSet setWithArray:[self rangesFromPartNumber:3]]);
+    XCTAssertEqual([getRequests count], [[self rangesFromPartNumber:3] count]);
+}
+
+@end
@@ -23,3 +23,4 @@ FOUNDATION_EXPORT const unsigned char AWSSQSVersionString[];
 
 #import <AWSCore/AWSCore.h>
 #import "AWSSQSService.h"
+#import "AWSSQSBufferedClient.h"
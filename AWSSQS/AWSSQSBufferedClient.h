@@ -0,0 +1,193 @@
+//
+// Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+
+#import <Foundation/Foundation.h>
+#import "AWSSQSModel.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class AWSSQS;
+@class AWSTask<__covariant ResultType>;
+
+FOUNDATION_EXPORT NSString *const AWSSQSBufferedClientErrorDomain;
+typedef NS_ENUM(NSInteger, AWSSQSBufferedClientErrorType) {
+    AWSSQSBufferedClientErrorUnknown,
+    /** The service rejected this entry of a batch. The `userInfo` holds the `AWSSQSBatchResultErrorEntry` under `AWSSQSBufferedClientBatchResultErrorEntryKey`. */
+    AWSSQSBufferedClientErrorBatchEntryFailed,
+    /** The message is larger than one `SendMessageBatch` request may be. */
+    AWSSQSBufferedClientErrorMessageTooLong,
+    /** The client was shut down before the operation completed. */
+    AWSSQSBufferedClientErrorShutDown,
+};
+
+FOUNDATION_EXPORT NSString *const AWSSQSBufferedClientBatchResultErrorEntryKey;
+
+/**
+ The batching and prefetching settings of an `AWSSQSBufferedClient`.
+ */
+@interface AWSSQSBufferedClientConfiguration : NSObject <NSCopying>
+
+/**
+ How long a send, delete or visibility change waits for others to share its batch. The default is 0.2 seconds.
+ */
+@property (nonatomic, assign) NSTimeInterval lingerTime;
+
+/**
+ The maximum number of entries in one batch request. The default and the service maximum is 10.
+ */
+@property (nonatomic, assign) NSUInteger maximumBatchSize;
+
+/**
+ The maximum total size in bytes of the messages in one `SendMessageBatch` request. The default and the service maximum is 256 KB.
+ */
+@property (nonatomic, assign) NSUInteger maximumBatchBytes;
+
+/**
+ The number of long-poll `ReceiveMessage` requests kept in flight while the receive buffer has room. The default is 2. Set it to 0 to receive only on demand.
+ */
+@property (nonatomic, assign) NSUInteger receiveConcurrency;
+
+/**
+ The maximum number of received messages held in the buffer before they are returned by `receiveMessages:`. The default is 20.
+ */
+@property (nonatomic, assign) NSUInteger maximumBufferedMessages;
+
+/**
+ The `WaitTimeSeconds` of each `ReceiveMessage` request. The default and the service maximum is 20 seconds.
+ */
+@property (nonatomic, assign) NSUInteger waitTimeSeconds;
+
+/**
+ The `VisibilityTimeout` of each `ReceiveMessage` request, or nil for the queue's default. When set, buffered messages whose timeout has passed are discarded instead of returned.
+ */
+@property (nonatomic, strong, nullable) NSNumber *visibilityTimeout;
+
+/**
+ The message attribute names requested with each `ReceiveMessage` request. The default is none.
+ */
+@property (nonatomic, strong, nullable) NSArray<NSString *> *messageAttributeNames;
+
+@end
+
+/**
+ `AWSSQSBufferedClient` sends, receives and deletes messages of one queue in batches.
+
+ `sendMessage:` calls made within `lingerTime` of each other are sent as one `SendMessageBatch` request of up to 10 messages and 256 KB, and each call gets its own task with its own result. Deletes and visibility changes are batched the same way. Received messages are prefetched by `receiveConcurrency` concurrent long polls into a bounded buffer, so `receiveMessages:` usually returns without a round trip.
+
+ @discussion Prefetched messages are invisible to other consumers until their visibility timeout expires. Call `shutdown` to make the messages still in the buffer visible again.
+ */
+@interface AWSSQSBufferedClient : NSObject
+
+/**
+ The service client the requests are sent with.
+ */
+@property (nonatomic, strong, readonly) AWSSQS *sqs;
+
+/**
+ The URL of the queue.
+ */
+@property (nonatomic, strong, readonly) NSString *queueUrl;
+
+/**
+ A copy of the configuration the client was created with.
+ */
+@property (nonatomic, copy, readonly) AWSSQSBufferedClientConfiguration *configuration;
+
+/**
+ Returns a client for the queue with the default configuration.
+
+ @param sqs      The service client.
+ @param queueUrl The URL of the queue.
+ */
+- (instancetype)initWithSQS:(AWSSQS *)sqs
+                   queueUrl:(NSString *)queueUrl;
+
+/**
+ Returns a client for the queue.
+
+ @param sqs           The service client.
+ @param queueUrl      The URL of the queue.
+ @param configuration The batching and prefetching settings, or nil for the defaults.
+ */
+- (instancetype)initWithSQS:(AWSSQS *)sqs
+                   queueUrl:(NSString *)queueUrl
+              configuration:(nullable AWSSQSBufferedClientConfiguration *)configuration NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ Sends a message with the next batch.
+
+ @param entry The message. Its `identifier` is assigned by the client and may be nil.
+
+ @return AWSTask - task.result contains an `AWSSQSSendMessageBatchResultEntry`; task.error is set if the request or this entry failed.
+ */
+- (AWSTask<AWSSQSSendMessageBatchResultEntry *> *)sendMessage:(AWSSQSSendMessageBatchRequestEntry *)entry;
+
+/**
+ Sends a message body with the next batch.
+
+ @param messageBody The body of the message.
+
+ @return AWSTask - task.result contains an `AWSSQSSendMessageBatchResultEntry`; task.error is set if the request or this entry failed.
+ */
+- (AWSTask<AWSSQSSendMessageBatchResultEntry *> *)sendMessageBody:(NSString *)messageBody;
+
+/**
+ Returns up to `maximumCount` messages, waiting for at least one if the buffer is empty.
+
+ @param maximumCount The maximum number of messages to return.
+
+ @return AWSTask - task.result contains an array of one to `maximumCount` `AWSSQSMessage` objects.
+ */
+- (AWSTask<NSArray<AWSSQSMessage *> *> *)receiveMessages:(NSUInteger)maximumCount;
+
+/**
+ Deletes a received message with the next batch.
+
+ @param message The received message.
+
+ @return AWSTask - task.result is nil; task.error is set if the request or this entry failed.
+ */
+- (AWSTask *)deleteMessage:(AWSSQSMessage *)message;
+
+/**
+ Changes the visibility timeout of a received message with the next batch, for example to extend it while the message is being processed.
+
+ @param message           The received message.
+ @param visibilityTimeout The new timeout in seconds, counted from now.
+
+ @return AWSTask - task.result is nil; task.error is set if the request or this entry failed.
+ */
+- (AWSTask *)changeMessageVisibility:(AWSSQSMessage *)message
+                   visibilityTimeout:(NSUInteger)visibilityTimeout;
+
+/**
+ Sends the pending sends, deletes and visibility changes without waiting for `lingerTime`.
+
+ @return AWSTask - completes when every request sent by this call has completed. task.result is always nil.
+ */
+- (AWSTask *)flush;
+
+/**
+ Stops prefetching, fails the pending `receiveMessages:` calls, sends the pending batches and makes the buffered messages visible again.
+
+ @return AWSTask - completes when the final requests have completed. task.result is always nil.
+ */
+- (AWSTask *)shutdown;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,625 @@
+//
+// Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+
+#import "AWSSQSBufferedClient.h"
+#import <pthread.h>
+#import "AWSSQSService.h"
+#import <AWSCore/AWSCocoaLumberjack.h>
+
+NSString *const AWSSQSBufferedClientErrorDomain = @"com.amazonaws.AWSSQSBufferedClientErrorDomain";
+NSString *const AWSSQSBufferedClientBatchResultErrorEntryKey = @"AWSSQSBufferedClientBatchResultErrorEntryKey";
+
+static NSTimeInterval const AWSSQSBufferedClientLingerTimeDefault = 0.2;
+static NSUInteger const AWSSQSBufferedClientMaximumBatchSize = 10;
+static NSUInteger const AWSSQSBufferedClientMaximumBatchBytes = 256 * 1024;
+static NSUInteger const AWSSQSBufferedClientReceiveConcurrencyDefault = 2;
+static NSUInteger const AWSSQSBufferedClientMaximumBufferedMessagesDefault = 20;
+static NSUInteger const AWSSQSBufferedClientMaximumWaitTimeSeconds = 20;
+// Buffered messages this close to the end of their visibility timeout are discarded rather than returned.
+static NSTimeInterval const AWSSQSBufferedClientVisibilityMargin = 1.0;
+
+#pragma mark - AWSSQSBufferedClientConfiguration
+
+@implementation AWSSQSBufferedClientConfiguration
+
+- (instancetype)init {
+    if (self = [super init]) {
+        _lingerTime = AWSSQSBufferedClientLingerTimeDefault;
+        _maximumBatchSize = AWSSQSBufferedClientMaximumBatchSize;
+        _maximumBatchBytes = AWSSQSBufferedClientMaximumBatchBytes;
+        _receiveConcurrency = AWSSQSBufferedClientReceiveConcurrencyDefault;
+        _maximumBufferedMessages = AWSSQSBufferedClientMaximumBufferedMessagesDefault;
+        _waitTimeSeconds = AWSSQSBufferedClientMaximumWaitTimeSeconds;
+    }
+    return self;
+}
+
+- (id)copyWithZone:(NSZone *)zone {
+    AWSSQSBufferedClientConfiguration *configuration = [[[self class] allocWithZone:zone] init];
+    configuration.lingerTime = self.lingerTime;
+    configuration.maximumBatchSize = self.maximumBatchSize;
+    configuration.maximumBatchBytes = self.maximumBatchBytes;
+    configuration.receiveConcurrency = self.receiveConcurrency;
+    configuration.maximumBufferedMessages = self.maximumBufferedMessages;
+    configuration.waitTimeSeconds = self.waitTimeSeconds;
+    configuration.visibilityTimeout = self.visibilityTimeout;
+    configuration.messageAttributeNames = self.messageAttributeNames;
+    return configuration;
+}
+
+@end
+
+#pragma mark - AWSSQSBufferedClientBatcher
+
+@interface AWSSQSBufferedClientBatchEntry : NSObject
+
+@property (nonatomic, strong) id payload;
+@property (nonatomic, assign) NSUInteger byteCount;
+@property (nonatomic, strong) AWSTaskCompletionSource *completionSource;
+
+@end
+
+@implementation AWSSQSBufferedClientBatchEntry
+
+@end
+
+// Sends the payloads as a batch request and returns one result per payload, in order: a result object, NSNull or an NSError.
+typedef AWSTask<NSArray *> *(^AWSSQSBufferedClientSendBlock)(NSArray *payloads);
+
+// Collects payloads until the batch is full or the first one has waited `lingerTime`, then sends them with one request.
+@interface AWSSQSBufferedClientBatcher : NSObject {
+    pthread_mutex_t _lock;
+    NSMutableArray<AWSSQSBufferedClientBatchEntry *> *_pendingEntries;
+    NSUInteger _pendingByteCount;
+    // Incremented every time the pending entries are taken, so a linger timer can tell whether its batch already left.
+    NSUInteger _generation;
+}
+
+@property (nonatomic, assign, readonly) NSUInteger maximumBatchSize;
+@property (nonatomic, assign, readonly) NSUInteger maximumBatchBytes;
+@property (nonatomic, assign, readonly) NSTimeInterval lingerTime;
+@property (nonatomic, copy, readonly) AWSSQSBufferedClientSendBlock sendBlock;
+
+@end
+
+@implementation AWSSQSBufferedClientBatcher
+
+- (instancetype)initWithMaximumBatchSize:(NSUInteger)maximumBatchSize
+                       maximumBatchBytes:(NSUInteger)maximumBatchBytes
+                              lingerTime:(NSTimeInterval)lingerTime
+                               sendBlock:(AWSSQSBufferedClientSendBlock)sendBlock {
+    if (self = [super init]) {
+        pthread_mutex_init(&_lock, NULL);
+        _pendingEntries = [NSMutableArray new];
+        _maximumBatchSize = MAX(1, MIN(maximumBatchSize, AWSSQSBufferedClientMaximumBatchSize));
+        _maximumBatchBytes = maximumBatchBytes;
+        _lingerTime = lingerTime;
+        _sendBlock = [sendBlock copy];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    pthread_mutex_destroy(&_lock);
+}
+
+- (AWSTask *)addPayload:(id)payload byteCount:(NSUInteger)byteCount {
+    AWSSQSBufferedClientBatchEntry *entry = [AWSSQSBufferedClientBatchEntry new];
+    entry.payload = payload;
+    entry.byteCount = byteCount;
+    entry.completionSource = [AWSTaskCompletionSource taskCompletionSource];
+
+    NSArray<AWSSQSBufferedClientBatchEntry *> *fullBatch = nil;
+    NSArray<AWSSQSBufferedClientBatchEntry *> *overflowBatch = nil;
+    NSUInteger generation = 0;
+    BOOL scheduleLinger = NO;
+
+    pthread_mutex_lock(&_lock);
+    if ([_pendingEntries count] > 0 && _pendingByteCount + byteCount > self.maximumBatchBytes) {
+        overflowBatch = [self takePendingEntriesLocked];
+    }
+    [_pendingEntries addObject:entry];
+    _pendingByteCount += byteCount;
+    if ([_pendingEntries count] >= self.maximumBatchSize) {
+        fullBatch = [self takePendingEntriesLocked];
+    } else if ([_pendingEntries count] == 1) {
+        scheduleLinger = YES;
+        generation = _generation;
+    }
+    pthread_mutex_unlock(&_lock);
+
+    if (overflowBatch) {
+        [self sendEntries:overflowBatch];
+    }
+    if (fullBatch) {
+        [self sendEntries:fullBatch];
+    }
+    if (scheduleLinger) {
+        __weak AWSSQSBufferedClientBatcher *weakSelf = self;
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(self.lingerTime * NSEC_PER_SEC)), dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+            [weakSelf flushGeneration:generation];
+        });
+    }
+
+    return entry.completionSource.task;
+}
+
+- (NSArray<AWSSQSBufferedClientBatchEntry *> *)takePendingEntriesLocked {
+    NSArray<AWSSQSBufferedClientBatchEntry *> *entries = _pendingEntries;
+    _pendingEntries = [NSMutableArray new];
+    _pendingByteCount = 0;
+    _generation++;
+    return entries;
+}
+
+- (void)flushGeneration:(NSUInteger)generation {
+    NSArray<AWSSQSBufferedClientBatchEntry *> *entries = nil;
+    pthread_mutex_lock(&_lock);
+    if (generation == _generation && [_pendingEntries count] > 0) {
+        entries = [self takePendingEntriesLocked];
+    }
+    pthread_mutex_unlock(&_lock);
+
+    if (entries) {
+        [self sendEntries:entries];
+    }
+}
+
+- (AWSTask *)flush {
+    pthread_mutex_lock(&_lock);
+    NSArray<AWSSQSBufferedClientBatchEntry *> *entries = [_pendingEntries count] > 0 ? [self takePendingEntriesLocked] : nil;
+    pthread_mutex_unlock(&_lock);
+
+    if (!entries) {
+        return [AWSTask taskWithResult:nil];
+    }
+    return [self sendEntries:entries];
+}
+
+- (AWSTask *)sendEntries:(NSArray<AWSSQSBufferedClientBatchEntry *> *)entries {
+    NSMutableArray *payloads = [NSMutableArray arrayWithCapacity:[entries count]];
+    for (AWSSQSBufferedClientBatchEntry *entry in entries) {
+        [payloads addObject:entry.payload];
+    }
+
+    return [self.sendBlock(payloads) continueWithBlock:^id(AWSTask<NSArray *> *task) {
+        [entries enumerateObjectsUsingBlock:^(AWSSQSBufferedClientBatchEntry *entry, NSUInteger idx, BOOL *stop) {
+            id result = task.error ?: task.result[idx];
+            if ([result isKindOfClass:[NSError class]]) {
+                [entry.completionSource setError:result];
+            } else {
+                [entry.completionSource setResult:result == [NSNull null] ? nil : result];
+            }
+        }];
+        return nil;
+    }];
+}
+
+@end
+
+#pragma mark - AWSSQSBufferedClient
+
+@interface AWSSQSBufferedClientReceivedMessage : NSObject
+
+@property (nonatomic, strong) AWSSQSMessage *message;
+@property (nonatomic, strong) NSDate *expirationDate;
+
+@end
+
+@implementation AWSSQSBufferedClientReceivedMessage
+
+@end
+
+@interface AWSSQSBufferedClientReceiveWaiter : NSObject
+
+@property (nonatomic, assign) NSUInteger maximumCount;
+@property (nonatomic, strong) AWSTaskCompletionSource<NSArray<AWSSQSMessage *> *> *completionSource;
+@property (nonatomic, strong) NSArray<AWSSQSMessage *> *messages;
+
+@end
+
+@implementation AWSSQSBufferedClientReceiveWaiter
+
+@end
+
+@interface AWSSQSBufferedClient() {
+    // Guards the receive buffer, the waiters and the receive state below.
+    pthread_mutex_t _receiveLock;
+    NSMutableArray<AWSSQSBufferedClientReceivedMessage *> *_bufferedMessages;
+    NSMutableArray<AWSSQSBufferedClientReceiveWaiter *> *_receiveWaiters;
+    NSUInteger _inFlightReceiveCount;
+    BOOL _receiving;
+    BOOL _shutDown;
+}
+
+@property (nonatomic, strong) AWSSQS *sqs;
+@property (nonatomic, strong) NSString *queueUrl;
+@property (nonatomic, copy) AWSSQSBufferedClientConfiguration *configuration;
+@property (nonatomic, strong) AWSSQSBufferedClientBatcher *sendBatcher;
+@property (nonatomic, strong) AWSSQSBufferedClientBatcher *deleteBatcher;
+@property (nonatomic, strong) AWSSQSBufferedClientBatcher *visibilityBatcher;
+
+@end
+
+@implementation AWSSQSBufferedClient
+
+- (instancetype)initWithSQS:(AWSSQS *)sqs
+                   queueUrl:(NSString *)queueUrl {
+    return [self initWithSQS:sqs queueUrl:queueUrl configuration:nil];
+}
+
+- (instancetype)initWithSQS:(AWSSQS *)sqs
+                   queueUrl:(NSString *)queueUrl
+              configuration:(AWSSQSBufferedClientConfiguration *)configuration {
+    if (self = [super init]) {
+        _sqs = sqs;
+        _queueUrl = [queueUrl copy];
+        _configuration = configuration ? [configuration copy] : [AWSSQSBufferedClientConfiguration new];
+        pthread_mutex_init(&_receiveLock, NULL);
+        _bufferedMessages = [NSMutableArray new];
+        _receiveWaiters = [NSMutableArray new];
+
+        // The batchers are owned by the client, so their blocks hold the service client rather than the client itself.
+        AWSSQS *service = sqs;
+        NSString *URL = _queueUrl;
+
+        _sendBatcher = [[AWSSQSBufferedClientBatcher alloc] initWithMaximumBatchSize:_configuration.maximumBatchSize
+                                                                   maximumBatchBytes:_configuration.maximumBatchBytes
+                                                                          lingerTime:_configuration.lingerTime
+                                                                           sendBlock:^AWSTask<NSArray *> *(NSArray<AWSSQSSendMessageBatchRequestEntry *> *payloads) {
+            AWSSQSSendMessageBatchRequest *request = [AWSSQSSendMessageBatchRequest new];
+            request.queueUrl = URL;
+            NSMutableArray<AWSSQSSendMessageBatchRequestEntry *> *entries = [NSMutableArray arrayWithCapacity:[payloads count]];
+            [payloads enumerateObjectsUsingBlock:^(AWSSQSSendMessageBatchRequestEntry *payload, NSUInteger idx, BOOL *stop) {
+                AWSSQSSendMessageBatchRequestEntry *entry = [payload copy];
+                entry.identifier = [@(idx) stringValue];
+                [entries addObject:entry];
+            }];
+            request.entries = entries;
+            return [[service sendMessageBatch:request] continueWithSuccessBlock:^id(AWSTask<AWSSQSSendMessageBatchResult *> *task) {
+                return [AWSSQSBufferedClient resultsForEntryCount:[payloads count]
+                                                       successful:task.result.successful
+                                                           failed:task.result.failed
+                                                   keepsSuccesses:YES];
+            }];
+        }];
+
+        _deleteBatcher = [[AWSSQSBufferedClientBatcher alloc] initWithMaximumBatchSize:_configuration.maximumBatchSize
+                                                                     maximumBatchBytes:NSUIntegerMax
+                                                                            lingerTime:_configuration.lingerTime
+                                                                             sendBlock:^AWSTask<NSArray *> *(NSArray<NSString *> *payloads) {
+            AWSSQSDeleteMessageBatchRequest *request = [AWSSQSDeleteMessageBatchRequest new];
+            request.queueUrl = URL;
+            NSMutableArray<AWSSQSDeleteMessageBatchRequestEntry *> *entries = [NSMutableArray arrayWithCapacity:[payloads count]];
+            [payloads enumerateObjectsUsingBlock:^(NSString *receiptHandle, NSUInteger idx, BOOL *stop) {
+                AWSSQSDeleteMessageBatchRequestEntry *entry = [AWSSQSDeleteMessageBatchRequestEntry new];
+                entry.identifier = [@(idx) stringValue];
+                entry.receiptHandle = receiptHandle;
+                [entries addObject:entry];
+            }];
+            request.entries = entries;
+            return [[service deleteMessageBatch:request] continueWithSuccessBlock:^id(AWSTask<AWSSQSDeleteMessageBatchResult *> *task) {
+                return [AWSSQSBufferedClient resultsForEntryCount:[payloads count]
+                                                       successful:task.result.successful
+                                                           failed:task.result.failed
+                                                   keepsSuccesses:NO];
+            }];
+        }];
+
+        _visibilityBatcher = [[AWSSQSBufferedClientBatcher alloc] initWithMaximumBatchSize:_configuration.maximumBatchSize
+                                                                         maximumBatchBytes:NSUIntegerMax
+                                                                                lingerTime:_configuration.lingerTime
+                                                                                 sendBlock:^AWSTask<NSArray *> *(NSArray<AWSSQSChangeMessageVisibilityBatchRequestEntry *> *payloads) {
+            AWSSQSChangeMessageVisibilityBatchRequest *request = [AWSSQSChangeMessageVisibilityBatchRequest new];
+            request.queueUrl = URL;
+            NSMutableArray<AWSSQSChangeMessageVisibilityBatchRequestEntry *> *entries = [NSMutableArray arrayWithCapacity:[payloads count]];
+            [payloads enumerateObjectsUsingBlock:^(AWSSQSChangeMessageVisibilityBatchRequestEntry *payload, NSUInteger idx, BOOL *stop) {
+                payload.identifier = [@(idx) stringValue];
+                [entries addObject:payload];
+            }];
+            request.entries = entries;
+            return [[service changeMessageVisibilityBatch:request] continueWithSuccessBlock:^id(AWSTask<AWSSQSChangeMessageVisibilityBatchResult *> *task) {
+                return [AWSSQSBufferedClient resultsForEntryCount:[payloads count]
+                                                       successful:task.result.successful
+                                                           failed:task.result.failed
+                                                   keepsSuccesses:NO];
+            }];
+        }];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    pthread_mutex_destroy(&_receiveLock);
+}
+
+// Matches the entries of a batch result to the payloads by their identifiers, which are the payloads' indexes.
++ (NSArray *)resultsForEntryCount:(NSUInteger)count
+                       successful:(NSArray *)successful
+                           failed:(NSArray<AWSSQSBatchResultErrorEntry *> *)failed
+                   keepsSuccesses:(BOOL)keepsSuccesses {
+    NSMutableArray *results = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger i = 0; i < count; i++) {
+        [results addObject:[NSError errorWithDomain:AWSSQSBufferedClientErrorDomain
+                                               code:AWSSQSBufferedClientErrorUnknown
+                                           userInfo:@{NSLocalizedDescriptionKey : @"The batch result does not contain this entry."}]];
+    }
+    for (id entry in successful) {
+        NSUInteger idx = (NSUInteger)[[entry valueForKey:@"identifier"] integerValue];
+        if (idx < count) {
+            results[idx] = keepsSuccesses ? entry : [NSNull null];
+        }
+    }
+    for (AWSSQSBatchResultErrorEntry *entry in failed) {
+        NSUInteger idx = (NSUInteger)[entry.identifier integerValue];
+        if (idx < count) {
+            results[idx] = [NSError errorWithDomain:AWSSQSBufferedClientErrorDomain
+                                               code:AWSSQSBufferedClientErrorBatchEntryFailed
+                                           userInfo:@{NSLocalizedDescriptionKey : entry.message ?: entry.code ?: @"The batch entry failed.",
+                                                      AWSSQSBufferedClientBatchResultErrorEntryKey : entry}];
+        }
+    }
+    return results;
+}
+
++ (NSError *)shutDownError {
+    return [NSError errorWithDomain:AWSSQSBufferedClientErrorDomain
+                               code:AWSSQSBufferedClientErrorShutDown
+                           userInfo:@{NSLocalizedDescriptionKey : @"The client has been shut down."}];
+}
+
+- (BOOL)isShutDown {
+    pthread_mutex_lock(&_receiveLock);
+    BOOL shutDown = _shutDown;
+    pthread_mutex_unlock(&_receiveLock);
+    return shutDown;
+}
+
+#pragma mark - Sending
+
+// The size SQS counts against the message limit: the body and the name, type and value of every attribute.
++ (NSUInteger)byteCountOfEntry:(AWSSQSSendMessageBatchRequestEntry *)entry {
+    __block NSUInteger byteCount = [entry.messageBody lengthOfBytesUsingEncoding:NSUTF8StringEncoding];
+    [entry.messageAttributes enumerateKeysAndObjectsUsingBlock:^(NSString *name, AWSSQSMessageAttributeValue *value, BOOL *stop) {
+        byteCount += [name lengthOfBytesUsingEncoding:NSUTF8StringEncoding];
+        byteCount += [value.dataType lengthOfBytesUsingEncoding:NSUTF8StringEncoding];
+        byteCount += [value.stringValue lengthOfBytesUsingEncoding:NSUTF8StringEncoding];
+        byteCount += [value.binaryValue length];
+    }];
+    return byteCount;
+}
+
+- (AWSTask<AWSSQSSendMessageBatchResultEntry *> *)sendMessage:(AWSSQSSendMessageBatchRequestEntry *)entry {
+    if ([self isShutDown]) {
+        return [AWSTask taskWithError:[AWSSQSBufferedClient shutDownError]];
+    }
+
+    NSUInteger byteCount = [AWSSQSBufferedClient byteCountOfEntry:entry];
+    if (byteCount > self.configuration.maximumBatchBytes) {
+        return [AWSTask taskWithError:[NSError errorWithDomain:AWSSQSBufferedClientErrorDomain
+                                                          code:AWSSQSBufferedClientErrorMessageTooLong
+                                                      userInfo:@{NSLocalizedDescriptionKey : [NSString stringWithFormat:@"The message is %lu bytes; a batch may be at most %lu bytes.", (unsigned long)byteCount, (unsigned long)self.configuration.maximumBatchBytes]}]];
+    }
+    return [self.sendBatcher addPayload:entry byteCount:byteCount];
+}
+
+- (AWSTask<AWSSQSSendMessageBatchResultEntry *> *)sendMessageBody:(NSString *)messageBody {
+    AWSSQSSendMessageBatchRequestEntry *entry = [AWSSQSSendMessageBatchRequestEntry new];
+    entry.messageBody = messageBody;
+    return [self sendMessage:entry];
+}
+
+#pragma mark - Deleting and changing visibility
+
+- (AWSTask *)deleteMessage:(AWSSQSMessage *)message {
+    if ([self isShutDown]) {
+        return [AWSTask taskWithError:[AWSSQSBufferedClient shutDownError]];
+    }
+    return [self.deleteBatcher addPayload:message.receiptHandle byteCount:0];
+}
+
+- (AWSTask *)changeMessageVisibility:(AWSSQSMessage *)message
+                   visibilityTimeout:(NSUInteger)visibilityTimeout {
+    if ([self isShutDown]) {
+        return [AWSTask taskWithError:[AWSSQSBufferedClient shutDownError]];
+    }
+    return [self addVisibilityChangeForReceiptHandle:message.receiptHandle visibilityTimeout:visibilityTimeout];
+}
+
+- (AWSTask *)addVisibilityChangeForReceiptHandle:(NSString *)receiptHandle visibilityTimeout:(NSUInteger)visibilityTimeout {
+    AWSSQSChangeMessageVisibilityBatchRequestEntry *entry = [AWSSQSChangeMessageVisibilityBatchRequestEntry new];
+    entry.receiptHandle = receiptHandle;
+    entry.visibilityTimeout = @(visibilityTimeout);
+    return [self.visibilityBatcher addPayload:entry byteCount:0];
+}
+
+- (AWSTask *)flush {
+    return [[AWSTask taskForCompletionOfAllTasks:@[[self.sendBatcher flush],
+                                                   [self.deleteBatcher flush],
+                                                   [self.visibilityBatcher flush]]] continueWithBlock:^id(AWSTask *task) {
+        return nil;
+    }];
+}
+
+#pragma mark - Receiving
+
+- (AWSTask<NSArray<AWSSQSMessage *> *> *)receiveMessages:(NSUInteger)maximumCount {
+    AWSSQSBufferedClientReceiveWaiter *waiter = [AWSSQSBufferedClientReceiveWaiter new];
+    waiter.maximumCount = MAX(maximumCount, 1);
+    waiter.completionSource = [AWSTaskCompletionSource taskCompletionSource];
+
+    pthread_mutex_lock(&_receiveLock);
+    if (_shutDown) {
+        pthread_mutex_unlock(&_receiveLock);
+        return [AWSTask taskWithError:[AWSSQSBufferedClient shutDownError]];
+    }
+    _receiving = YES;
+    [_receiveWaiters addObject:waiter];
+    NSArray<AWSSQSBufferedClientReceiveWaiter *> *satisfiedWaiters = [self satisfyWaitersLocked];
+    NSUInteger receiveCount = [self receiveCountToStartLocked];
+    pthread_mutex_unlock(&_receiveLock);
+
+    for (AWSSQSBufferedClientReceiveWaiter *satisfiedWaiter in satisfiedWaiters) {
+        [satisfiedWaiter.completionSource setResult:satisfiedWaiter.messages];
+    }
+    [self startReceives:receiveCount];
+
+    return waiter.completionSource.task;
+}
+
+// Hands buffered messages to the waiters in the order they arrived. Returns the waiters to complete outside the lock.
+- (NSArray<AWSSQSBufferedClientReceiveWaiter *> *)satisfyWaitersLocked {
+    if (self.configuration.visibilityTimeout) {
+        NSDate *now = [NSDate date];
+        NSIndexSet *expiredIndexes = [_bufferedMessages indexesOfObjectsPassingTest:^BOOL(AWSSQSBufferedClientReceivedMessage *receivedMessage, NSUInteger idx, BOOL *stop) {
+            return [receivedMessage.expirationDate compare:now] != NSOrderedDescending;
+        }];
+        if ([expiredIndexes count] > 0) {
+            AWSDDLogDebug(@"Discarding %lu buffered messages whose visibility timeout has passed.", (unsigned long)[expiredIndexes count]);
+            [_bufferedMessages removeObjectsAtIndexes:expiredIndexes];
+        }
+    }
+
+    NSMutableArray<AWSSQSBufferedClientReceiveWaiter *> *satisfiedWaiters = [NSMutableArray new];
+    while ([_receiveWaiters count] > 0 && [_bufferedMessages count] > 0) {
+        AWSSQSBufferedClientReceiveWaiter *waiter = [_receiveWaiters firstObject];
+        [_receiveWaiters removeObjectAtIndex:0];
+
+        NSRange range = NSMakeRange(0, MIN(waiter.maximumCount, [_bufferedMessages count]));
+        NSMutableArray<AWSSQSMessage *> *messages = [NSMutableArray arrayWithCapacity:range.length];
+        for (AWSSQSBufferedClientReceivedMessage *receivedMessage in [_bufferedMessages subarrayWithRange:range]) {
+            [messages addObject:receivedMessage.message];
+        }
+        [_bufferedMessages removeObjectsInRange:range];
+        waiter.messages = messages;
+        [satisfiedWaiters addObject:waiter];
+    }
+    return satisfiedWaiters;
+}
+
+// Keeps `receiveConcurrency` long polls in flight while the buffer has room, and at least one while a caller waits.
+- (NSUInteger)receiveCountToStartLocked {
+    if (_shutDown || !_receiving) {
+        return 0;
+    }
+
+    NSUInteger batchSize = MAX(1, MIN(self.configuration.maximumBatchSize, AWSSQSBufferedClientMaximumBatchSize));
+    NSUInteger concurrency = self.configuration.receiveConcurrency;
+    if ([_receiveWaiters count] > 0) {
+        concurrency = MAX(concurrency, 1);
+    }
+
+    NSUInteger receiveCount = 0;
+    while (_inFlightReceiveCount < concurrency
+           && ([_receiveWaiters count] > 0 || [_bufferedMessages count] + _inFlightReceiveCount * batchSize < self.configuration.maximumBufferedMessages)) {
+        _inFlightReceiveCount++;
+        receiveCount++;
+    }
+    return receiveCount;
+}
+
+- (void)startReceives:(NSUInteger)receiveCount {
+    for (NSUInteger i = 0; i < receiveCount; i++) {
+        AWSSQSReceiveMessageRequest *request = [AWSSQSReceiveMessageRequest new];
+        request.queueUrl = self.queueUrl;
+        request.maxNumberOfMessages = @(MAX(1, MIN(self.configuration.maximumBatchSize, AWSSQSBufferedClientMaximumBatchSize)));
+        request.waitTimeSeconds = @(MIN(self.configuration.waitTimeSeconds, AWSSQSBufferedClientMaximumWaitTimeSeconds));
+        request.visibilityTimeout = self.configuration.visibilityTimeout;
+        request.messageAttributeNames = self.configuration.messageAttributeNames;
+        NSDate *requestDate = [NSDate date];
+
+        __weak AWSSQSBufferedClient *weakSelf = self;
+        [[self.sqs receiveMessage:request] continueWithBlock:^id(AWSTask<AWSSQSReceiveMessageResult *> *task) {
+            [weakSelf didReceiveMessagesWithTask:task requestDate:requestDate];
+            return nil;
+        }];
+    }
+}
+
+- (void)didReceiveMessagesWithTask:(AWSTask<AWSSQSReceiveMessageResult *> *)task requestDate:(NSDate *)requestDate {
+    NSArray<AWSSQSBufferedClientReceiveWaiter *> *satisfiedWaiters = nil;
+    NSArray<AWSSQSBufferedClientReceiveWaiter *> *failedWaiters = nil;
+    NSArray<AWSSQSMessage *> *releasedMessages = nil;
+    NSUInteger receiveCount = 0;
+
+    pthread_mutex_lock(&_receiveLock);
+    _inFlightReceiveCount--;
+    if (task.error) {
+        // Polls are not restarted after an error, so a failing queue is not polled in a tight loop; the next call restarts them.
+        AWSDDLogError(@"Failed to receive messages. [%@]", task.error);
+        if (_inFlightReceiveCount == 0) {
+            failedWaiters = [_receiveWaiters copy];
+            [_receiveWaiters removeAllObjects];
+        }
+    } else if (_shutDown) {
+        releasedMessages = task.result.messages;
+    } else {
+        NSDate *expirationDate = self.configuration.visibilityTimeout
+        ? [requestDate dateByAddingTimeInterval:[self.configuration.visibilityTimeout doubleValue] - AWSSQSBufferedClientVisibilityMargin]
+        : nil;
+        for (AWSSQSMessage *message in task.result.messages) {
+            AWSSQSBufferedClientReceivedMessage *receivedMessage = [AWSSQSBufferedClientReceivedMessage new];
+            receivedMessage.message = message;
+            receivedMessage.expirationDate = expirationDate;
+            [_bufferedMessages addObject:receivedMessage];
+        }
+        satisfiedWaiters = [self satisfyWaitersLocked];
+        receiveCount = [self receiveCountToStartLocked];
+    }
+    pthread_mutex_unlock(&_receiveLock);
+
+    for (AWSSQSBufferedClientReceiveWaiter *waiter in satisfiedWaiters) {
+        [waiter.completionSource setResult:waiter.messages];
+    }
+    for (AWSSQSBufferedClientReceiveWaiter *waiter in failedWaiters) {
+        [waiter.completionSource setError:task.error];
+    }
+    for (AWSSQSMessage *message in releasedMessages) {
+        [self addVisibilityChangeForReceiptHandle:message.receiptHandle visibilityTimeout:0];
+    }
+    if ([releasedMessages count] > 0) {
+        [self.visibilityBatcher flush];
+    }
+    [self startReceives:receiveCount];
+}
+
+#pragma mark - Shutting down
+
+- (AWSTask *)shutdown {
+    pthread_mutex_lock(&_receiveLock);
+    _shutDown = YES;
+    NSArray<AWSSQSBufferedClientReceiveWaiter *> *waiters = [_receiveWaiters copy];
+    [_receiveWaiters removeAllObjects];
+    NSArray<AWSSQSBufferedClientReceivedMessage *> *bufferedMessages = [_bufferedMessages copy];
+    [_bufferedMessages removeAllObjects];
+    pthread_mutex_unlock(&_receiveLock);
+
+    for (AWSSQSBufferedClientReceiveWaiter *waiter in waiters) {
+        [waiter.completionSource setError:[AWSSQSBufferedClient shutDownError]];
+    }
+
+    // Makes the prefetched messages nobody received available to other consumers right away.
+    NSMutableArray<AWSTask *> *tasks = [NSMutableArray new];
+    for (AWSSQSBufferedClientReceivedMessage *receivedMessage in bufferedMessages) {
+        [tasks addObject:[self addVisibilityChangeForReceiptHandle:receivedMessage.message.receiptHandle visibilityTimeout:0]];
+    }
+    [tasks addObject:[self flush]];
+
+    return [[AWSTask taskForCompletionOfAllTasks:tasks] continueWithBlock:^id(AWSTask *task) {
+        return nil;
+    }];
+}
+
+@end
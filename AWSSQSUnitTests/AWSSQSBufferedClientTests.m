@@ -0,0 +1,234 @@
+//
+// Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+
+#import <XCTest/XCTest.h>
+#import "AWSTestUtility.h"
+#import "AWSSQSService.h"
+#import "AWSSQSBufferedClient.h"
+#import "AWSSQSStubEndpoint.h"
+
+static NSString *const AWSSQSBufferedClientTestsKey = @"AWSSQSBufferedClientTests";
+static NSString *const AWSSQSBufferedClientTestsQueueUrl = @"https://sqs.us-east-1.amazonaws.com/123456789012/AWSSQSBufferedClientTests";
+
+@interface AWSSQSBufferedClientTests : XCTestCase
+
+@property (nonatomic, strong) AWSSQSStubEndpoint *endpoint;
+
+@end
+
+@implementation AWSSQSBufferedClientTests
+
+- (void)setUp {
+    [super setUp];
+    [AWSTestUtility setupFakeCognitoCredentialsProvider];
+
+    AWSServiceConfiguration *configuration = [[AWSServiceConfiguration alloc] initWithRegion:AWSRegionUSEast1
+                                                                         credentialsProvider:[AWSServiceManager defaultServiceManager].defaultServiceConfiguration.credentialsProvider];
+    [AWSSQS registerSQSWithConfiguration:configuration forKey:AWSSQSBufferedClientTestsKey];
+    self.endpoint = [AWSSQSStubEndpoint new];
+    [self.endpoint attachToServiceClient:[AWSSQS SQSForKey:AWSSQSBufferedClientTestsKey]];
+}
+
+- (void)tearDown {
+    [AWSSQS removeSQSForKey:AWSSQSBufferedClientTestsKey];
+    [super tearDown];
+}
+
+- (AWSSQSBufferedClient *)clientWithConfiguration:(AWSSQSBufferedClientConfiguration *)configuration {
+    return [[AWSSQSBufferedClient alloc] initWithSQS:[AWSSQS SQSForKey:AWSSQSBufferedClientTestsKey]
+                                            queueUrl:AWSSQSBufferedClientTestsQueueUrl
+                                       configuration:configuration];
+}
+
+- (AWSSQSBufferedClientConfiguration *)configuration {
+    AWSSQSBufferedClientConfiguration *configuration = [AWSSQSBufferedClientConfiguration new];
+    configuration.lingerTime = 0.05;
+    configuration.waitTimeSeconds = 1;
+    return configuration;
+}
+
+// Receives until `count` messages arrived or a few seconds passed.
+- (NSArray<AWSSQSMessage *> *)receiveMessages:(NSUInteger)count withClient:(AWSSQSBufferedClient *)client {
+    NSMutableArray<AWSSQSMessage *> *messages = [NSMutableArray new];
+    NSDate *deadline = [NSDate dateWithTimeIntervalSinceNow:5];
+    while ([messages count] < count && [deadline timeIntervalSinceNow] > 0) {
+        AWSTask<NSArray<AWSSQSMessage *> *> *task = [[client receiveMessages:count - [messages count]] waitUntilFinished];
+        XCTAssertNil(task.error);
+        [messages addObjectsFromArray:task.result];
+    }
+    return messages;
+}
+
+- (void)testSendsAreBatched {
+    AWSSQSBufferedClient *client = [self clientWithConfiguration:[self configuration]];
+    NSMutableArray<AWSTask *> *tasks = [NSMutableArray new];
+    for (NSUInteger i = 0; i < 25; i++) {
+        [tasks addObject:[client sendMessageBody:[NSString stringWithFormat:@"message-%lu", (unsigned long)i]]];
+    }
+    [[AWSTask taskForCompletionOfAllTasks:tasks] waitUntilFinished];
+
+    XCTAssertEqual([self.endpoint requestCountForOperation:@"SendMessageBatch"], 3);
+    XCTAssertEqual(self.endpoint.messageCount, 25);
+    NSMutableSet<NSString *> *messageIds = [NSMutableSet new];
+    for (AWSTask<AWSSQSSendMessageBatchResultEntry *> *task in tasks) {
+        XCTAssertNil(task.error);
+        XCTAssertNotNil(task.result.messageId);
+        [messageIds addObject:task.result.messageId];
+    }
+    XCTAssertEqual([messageIds count], 25);
+}
+
+- (void)testSendBatchesStayWithinByteLimit {
+    AWSSQSBufferedClient *client = [self clientWithConfiguration:[self configuration]];
+    NSString *largeBody = [@"" stringByPaddingToLength:100 * 1024 withString:@"a" startingAtIndex:0];
+    NSArray<AWSTask *> *tasks = @[[client sendMessageBody:largeBody], [client sendMessageBody:largeBody], [client sendMessageBody:largeBody]];
+    [[AWSTask taskForCompletionOfAllTasks:tasks] waitUntilFinished];
+
+    XCTAssertEqual([self.endpoint requestCountForOperation:@"SendMessageBatch"], 2);
+    XCTAssertEqual(self.endpoint.messageCount, 3);
+
+    AWSTask *tooLongTask = [client sendMessageBody:[@"" stringByPaddingToLength:300 * 1024 withString:@"a" startingAtIndex:0]];
+    XCTAssertEqualObjects(tooLongTask.error.domain, AWSSQSBufferedClientErrorDomain);
+    XCTAssertEqual(tooLongTask.error.code, AWSSQSBufferedClientErrorMessageTooLong);
+}
+
+- (void)testFailedEntryFailsOnlyItsTask {
+    self.endpoint.rejectedMessageBody = @"rejected";
+    AWSSQSBufferedClient *client = [self clientWithConfiguration:[self configuration]];
+    AWSTask *acceptedTask = [client sendMessageBody:@"accepted"];
+    AWSTask *rejectedTask = [client sendMessageBody:@"rejected"];
+    [[client flush] waitUntilFinished];
+    [[AWSTask taskForCompletionOfAllTasks:@[acceptedTask, rejectedTask]] waitUntilFinished];
+
+    XCTAssertEqual([self.endpoint requestCountForOperation:@"SendMessageBatch"], 1);
+    XCTAssertNil(acceptedTask.error);
+    XCTAssertEqualObjects(rejectedTask.error.domain, AWSSQSBufferedClientErrorDomain);
+    XCTAssertEqual(rejectedTask.error.code, AWSSQSBufferedClientErrorBatchEntryFailed);
+    AWSSQSBatchResultErrorEntry *errorEntry = rejectedTask.error.userInfo[AWSSQSBufferedClientBatchResultErrorEntryKey];
+    XCTAssertEqualObjects(errorEntry.code, @"InvalidMessageContents");
+}
+
+- (void)testReceiveAndDeleteAreBatched {
+    AWSSQSBufferedClient *client = [self clientWithConfiguration:[self configuration]];
+    for (NSUInteger i = 0; i < 30; i++) {
+        [client sendMessageBody:[NSString stringWithFormat:@"message-%lu", (unsigned long)i]];
+    }
+    [[client flush] waitUntilFinished];
+
+    NSArray<AWSSQSMessage *> *messages = [self receiveMessages:30 withClient:client];
+    XCTAssertEqual([messages count], 30);
+
+    NSMutableArray<AWSTask *> *tasks = [NSMutableArray new];
+    for (AWSSQSMessage *message in messages) {
+        [tasks addObject:[client deleteMessage:message]];
+    }
+    [[AWSTask taskForCompletionOfAllTasks:tasks] waitUntilFinished];
+    for (AWSTask *task in tasks) {
+        XCTAssertNil(task.error);
+    }
+    XCTAssertEqual([self.endpoint requestCountForOperation:@"DeleteMessageBatch"], 3);
+    XCTAssertEqual(self.endpoint.messageCount, 0);
+
+    [[client shutdown] waitUntilFinished];
+}
+
+- (void)testUndeletedMessagesAreRedelivered {
+    AWSSQSBufferedClientConfiguration *configuration = [self configuration];
+    configuration.receiveConcurrency = 0;
+    configuration.visibilityTimeout = @2;
+    AWSSQSBufferedClient *client = [self clientWithConfiguration:configuration];
+    for (NSUInteger i = 0; i < 4; i++) {
+        [client sendMessageBody:[NSString stringWithFormat:@"message-%lu", (unsigned long)i]];
+    }
+    [[client flush] waitUntilFinished];
+
+    NSArray<AWSSQSMessage *> *messages = [self receiveMessages:4 withClient:client];
+    XCTAssertEqual([messages count], 4);
+    [client deleteMessage:messages[0]];
+    [client changeMessageVisibility:messages[1] visibilityTimeout:60];
+    [[client flush] waitUntilFinished];
+
+    // The two messages left alone come back once their visibility timeout passes; the extended one does not.
+    [NSThread sleepForTimeInterval:2.5];
+    NSArray<AWSSQSMessage *> *redeliveredMessages = [self receiveMessages:2 withClient:client];
+    NSSet<NSString *> *bodies = [NSSet setWithArray:[redeliveredMessages valueForKey:@"body"]];
+    XCTAssertEqualObjects(bodies, ([NSSet setWithObjects:messages[2].body, messages[3].body, nil]));
+    XCTAssertEqual([self.endpoint receiveCountForMessageBody:messages[2].body], 2);
+    XCTAssertEqual([self.endpoint receiveCountForMessageBody:messages[1].body], 1);
+    XCTAssertEqual([self.endpoint requestCountForOperation:@"ChangeMessageVisibilityBatch"], 1);
+
+    // A receipt handle from an earlier delivery no longer deletes the message.
+    AWSTask *staleDeleteTask = [[client deleteMessage:messages[2]] waitUntilFinished];
+    XCTAssertEqual(staleDeleteTask.error.code, AWSSQSBufferedClientErrorBatchEntryFailed);
+}
+
+- (void)testShutdownReleasesBufferedMessages {
+    AWSSQSBufferedClient *client = [self clientWithConfiguration:[self configuration]];
+    for (NSUInteger i = 0; i < 20; i++) {
+        [client sendMessageBody:[NSString stringWithFormat:@"message-%lu", (unsigned long)i]];
+    }
+    [[client flush] waitUntilFinished];
+
+    AWSSQSMessage *message = [[[client receiveMessages:1] waitUntilFinished].result firstObject];
+    XCTAssertNotNil(message);
+    AWSTask *pendingReceiveTask = [client receiveMessages:100];
+    [[client shutdown] waitUntilFinished];
+
+    XCTAssertTrue(pendingReceiveTask.error == nil || pendingReceiveTask.error.code == AWSSQSBufferedClientErrorShutDown);
+    XCTAssertEqual([client receiveMessages:1].error.code, AWSSQSBufferedClientErrorShutDown);
+    XCTAssertEqual([client sendMessageBody:@"late"].error.code, AWSSQSBufferedClientErrorShutDown);
+
+    // Everything but the message taken before the shutdown is available to another consumer right away.
+    NSUInteger received = [[pendingReceiveTask.result ?: @[] arrayByAddingObject:message] count];
+    AWSSQSBufferedClient *otherClient = [self clientWithConfiguration:[self configuration]];
+    NSArray<AWSSQSMessage *> *messages = [self receiveMessages:20 - received withClient:otherClient];
+    XCTAssertEqual([messages count], 20 - received);
+    [[otherClient shutdown] waitUntilFinished];
+}
+
+#pragma mark - Performance
+
+- (void)testPerformanceSendReceiveDelete {
+    AWSSQSBufferedClientConfiguration *configuration = [self configuration];
+    configuration.lingerTime = 0.01;
+    configuration.receiveConcurrency = 4;
+    configuration.maximumBufferedMessages = 40;
+    NSUInteger messageCount = 500;
+
+    [self measureBlock:^{
+        AWSSQSBufferedClient *client = [self clientWithConfiguration:configuration];
+        NSMutableArray<AWSTask *> *tasks = [NSMutableArray arrayWithCapacity:messageCount * 2];
+        dispatch_apply(4, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t thread) {
+            for (NSUInteger i = thread; i < messageCount; i += 4) {
+                AWSTask *task = [client sendMessageBody:[NSString stringWithFormat:@"message-%lu", (unsigned long)i]];
+                @synchronized(tasks) {
+                    [tasks addObject:task];
+                }
+            }
+        });
+        [[client flush] waitUntilFinished];
+
+        NSArray<AWSSQSMessage *> *messages = [self receiveMessages:messageCount withClient:client];
+        XCTAssertEqual([messages count], messageCount);
+        for (AWSSQSMessage *message in messages) {
+            [tasks addObject:[client deleteMessage:message]];
+        }
+        [[client shutdown] waitUntilFinished];
+        [[AWSTask taskForCompletionOfAllTasks:tasks] waitUntilFinished];
+        XCTAssertEqual(self.endpoint.messageCount, 0);
+    }];
+}
+
+@end
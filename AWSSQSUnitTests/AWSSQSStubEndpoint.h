@@ -0,0 +1,58 @@
+//
+// Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+
+#import <Foundation/Foundation.h>
+#import "AWSSQSService.h"
+#import "AWSTestStubEndpoint.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ An in-process SQS queue. Received messages stay in the queue, invisible, until
+ they are deleted or their visibility timeout passes, and are then delivered
+ again with a new receipt handle.
+ */
+@interface AWSSQSStubEndpoint : AWSTestStubEndpoint
+
+/**
+ The visibility timeout of receives that do not set one, in seconds. The default is 30.
+ */
+@property (atomic, assign) NSTimeInterval defaultVisibilityTimeout;
+
+/**
+ The longest a receive waits for a message, whatever its `WaitTimeSeconds`. The default is 0.5 seconds.
+ */
+@property (atomic, assign) NSTimeInterval maximumWaitTime;
+
+/**
+ Messages with this body are rejected with a failed batch entry.
+ */
+@property (atomic, strong, nullable) NSString *rejectedMessageBody;
+
+/**
+ The number of messages in the queue, visible or not.
+ */
+@property (atomic, readonly) NSUInteger messageCount;
+
+- (NSUInteger)requestCountForOperation:(NSString *)operationName;
+
+/**
+ The number of times each message body has been delivered by `ReceiveMessage`.
+ */
+- (NSUInteger)receiveCountForMessageBody:(NSString *)messageBody;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,255 @@
+//
+// Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License").
+// You may not use this file except in compliance with the License.
+// A copy of the License is located at
+//
+// http://aws.amazon.com/apache2.0
+//
+// or in the "license" file accompanying this file. This file is distributed
+// on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+// express or implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+
+#import "AWSSQSStubEndpoint.h"
+
+@interface AWSSQSStubEndpointMessage : NSObject
+
+@property (nonatomic, strong) NSString *messageId;
+@property (nonatomic, strong) NSString *body;
+@property (nonatomic, strong) NSDate *visibleDate;
+@property (nonatomic, strong) NSString *receiptHandle;
+
+@end
+
+@implementation AWSSQSStubEndpointMessage
+
+@end
+
+@interface AWSSQSStubEndpoint()
+
+// Guards the queue; signalled whenever a message may have become visible.
+@property (nonatomic, strong) NSCondition *condition;
+@property (nonatomic, strong) NSMutableArray<AWSSQSStubEndpointMessage *> *messages;
+@property (nonatomic, strong) NSCountedSet<NSString *> *operationCounts;
+@property (nonatomic, strong) NSCountedSet<NSString *> *receiveCounts;
+
+@end
+
+@implementation AWSSQSStubEndpoint
+
+- (instancetype)init {
+    if (self = [super init]) {
+        _defaultVisibilityTimeout = 30;
+        _maximumWaitTime = 0.5;
+        _condition = [NSCondition new];
+        _messages = [NSMutableArray new];
+        _operationCounts = [NSCountedSet new];
+        _receiveCounts = [NSCountedSet new];
+    }
+    return self;
+}
+
+- (NSUInteger)messageCount {
+    [self.condition lock];
+    NSUInteger count = [self.messages count];
+    [self.condition unlock];
+    return count;
+}
+
+- (NSUInteger)requestCountForOperation:(NSString *)operationName {
+    [self.condition lock];
+    NSUInteger count = [self.operationCounts countForObject:operationName];
+    [self.condition unlock];
+    return count;
+}
+
+- (NSUInteger)receiveCountForMessageBody:(NSString *)messageBody {
+    [self.condition lock];
+    NSUInteger count = [self.receiveCounts countForObject:messageBody];
+    [self.condition unlock];
+    return count;
+}
+
+#pragma mark - Request handling
+
+- (AWSTask<AWSTestHTTPResponse *> *)responseForRequest:(NSURLRequest *)request parameters:(NSDictionary *)parameters {
+    NSString *operationName = nil;
+    NSString *body = [[NSString alloc] initWithData:request.HTTPBody encoding:NSUTF8StringEncoding];
+    for (NSString *pair in [body componentsSeparatedByString:@"&"]) {
+        if ([pair hasPrefix:@"Action="]) {
+            operationName = [pair substringFromIndex:[@"Action=" length]];
+        }
+    }
+
+    [self.condition lock];
+    [self.operationCounts addObject:operationName ?: @""];
+    [self.condition unlock];
+
+    if ([operationName isEqualToString:@"SendMessageBatch"]) {
+        return [AWSTask taskWithResult:[self responseForOperation:operationName result:[self sendMessageBatch:parameters]]];
+    }
+    if ([operationName isEqualToString:@"DeleteMessageBatch"]) {
+        return [AWSTask taskWithResult:[self responseForOperation:operationName result:[self deleteMessageBatch:parameters]]];
+    }
+    if ([operationName isEqualToString:@"ChangeMessageVisibilityBatch"]) {
+        return [AWSTask taskWithResult:[self responseForOperation:operationName result:[self changeMessageVisibilityBatch:parameters]]];
+    }
+    if ([operationName isEqualToString:@"ReceiveMessage"]) {
+        AWSTaskCompletionSource *completionSource = [AWSTaskCompletionSource taskCompletionSource];
+        dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+            [completionSource setResult:[self responseForOperation:operationName result:[self receiveMessage:parameters]]];
+        });
+        return completionSource.task;
+    }
+
+    return [AWSTask taskWithError:[NSError errorWithDomain:AWSSQSErrorDomain
+                                                      code:AWSSQSErrorUnsupportedOperation
+                                                  userInfo:@{NSLocalizedDescriptionKey : [NSString stringWithFormat:@"%@ is not supported by the stub.", operationName]}]];
+}
+
+#pragma mark - Responses
+
++ (NSString *)XMLElement:(NSString *)name text:(NSString *)text {
+    NSString *escapedText = [[[text stringByReplacingOccurrencesOfString:@"&" withString:@"&amp;"]
+                              stringByReplacingOccurrencesOfString:@"<" withString:@"&lt;"]
+                             stringByReplacingOccurrencesOfString:@">" withString:@"&gt;"];
+    return [NSString stringWithFormat:@"<%@>%@</%@>", name, escapedText, name];
+}
+
+- (AWSTestHTTPResponse *)responseForOperation:(NSString *)operationName result:(NSString *)result {
+    NSString *XML = [NSString stringWithFormat:@"<%@Response xmlns=\"http://queue.amazonaws.com/doc/2012-11-05/\"><%@Result>%@</%@Result><ResponseMetadata><RequestId>stub</RequestId></ResponseMetadata></%@Response>",
+                     operationName, operationName, result, operationName, operationName];
+    return [AWSTestHTTPResponse responseWithStatus:@"200 OK"
+                                           headers:@{@"Content-Type" : @"text/xml"}
+                                              body:[XML dataUsingEncoding:NSUTF8StringEncoding]];
+}
+
+// The entries of each list are flattened into the result, as SQS sends them.
+- (NSString *)resultEntry:(NSString *)name identifier:(NSString *)identifier {
+    return [NSString stringWithFormat:@"<%@>%@</%@>", name, [AWSSQSStubEndpoint XMLElement:@"Id" text:identifier], name];
+}
+
+- (NSString *)errorEntryWithIdentifier:(NSString *)identifier code:(NSString *)code {
+    return [NSString stringWithFormat:@"<BatchResultErrorEntry>%@%@%@<SenderFault>true</SenderFault></BatchResultErrorEntry>",
+            [AWSSQSStubEndpoint XMLElement:@"Id" text:identifier],
+            [AWSSQSStubEndpoint XMLElement:@"Code" text:code],
+            [AWSSQSStubEndpoint XMLElement:@"Message" text:code]];
+}
+
+#pragma mark - Queue
+
+- (AWSSQSStubEndpointMessage *)messageWithReceiptHandleLocked:(NSString *)receiptHandle {
+    for (AWSSQSStubEndpointMessage *message in self.messages) {
+        if ([message.receiptHandle isEqualToString:receiptHandle]) {
+            return message;
+        }
+    }
+    return nil;
+}
+
+- (NSString *)sendMessageBatch:(NSDictionary *)parameters {
+    NSMutableString *result = [NSMutableString new];
+
+    [self.condition lock];
+    for (NSDictionary *entry in parameters[@"Entries"]) {
+        if ([entry[@"MessageBody"] isEqualToString:self.rejectedMessageBody]) {
+            [result appendString:[self errorEntryWithIdentifier:entry[@"Id"] code:@"InvalidMessageContents"]];
+            continue;
+        }
+
+        AWSSQSStubEndpointMessage *message = [AWSSQSStubEndpointMessage new];
+        message.messageId = [[NSUUID UUID] UUIDString];
+        message.body = entry[@"MessageBody"];
+        message.visibleDate = [NSDate dateWithTimeIntervalSinceNow:[entry[@"DelaySeconds"] doubleValue]];
+        [self.messages addObject:message];
+
+        [result appendFormat:@"<SendMessageBatchResultEntry>%@%@</SendMessageBatchResultEntry>",
+         [AWSSQSStubEndpoint XMLElement:@"Id" text:entry[@"Id"]],
+         [AWSSQSStubEndpoint XMLElement:@"MessageId" text:message.messageId]];
+    }
+    [self.condition broadcast];
+    [self.condition unlock];
+
+    return result;
+}
+
+- (NSString *)deleteMessageBatch:(NSDictionary *)parameters {
+    NSMutableString *result = [NSMutableString new];
+
+    [self.condition lock];
+    for (NSDictionary *entry in parameters[@"Entries"]) {
+        AWSSQSStubEndpointMessage *message = [self messageWithReceiptHandleLocked:entry[@"ReceiptHandle"]];
+        if (!message) {
+            [result appendString:[self errorEntryWithIdentifier:entry[@"Id"] code:@"ReceiptHandleIsInvalid"]];
+            continue;
+        }
+        [self.messages removeObjectIdenticalTo:message];
+        [result appendString:[self resultEntry:@"DeleteMessageBatchResultEntry" identifier:entry[@"Id"]]];
+    }
+    [self.condition unlock];
+
+    return result;
+}
+
+- (NSString *)changeMessageVisibilityBatch:(NSDictionary *)parameters {
+    NSMutableString *result = [NSMutableString new];
+
+    [self.condition lock];
+    for (NSDictionary *entry in parameters[@"Entries"]) {
+        AWSSQSStubEndpointMessage *message = [self messageWithReceiptHandleLocked:entry[@"ReceiptHandle"]];
+        if (!message || [message.visibleDate timeIntervalSinceNow] <= 0) {
+            [result appendString:[self errorEntryWithIdentifier:entry[@"Id"] code:@"MessageNotInflight"]];
+            continue;
+        }
+        message.visibleDate = [NSDate dateWithTimeIntervalSinceNow:[entry[@"VisibilityTimeout"] doubleValue]];
+        [result appendString:[self resultEntry:@"ChangeMessageVisibilityBatchResultEntry" identifier:entry[@"Id"]]];
+    }
+    [self.condition broadcast];
+    [self.condition unlock];
+
+    return result;
+}
+
+// Long polls: waits until a message is visible or the wait time passes.
+- (NSString *)receiveMessage:(NSDictionary *)parameters {
+    NSUInteger maximumCount = MAX(1, [parameters[@"MaxNumberOfMessages"] unsignedIntegerValue]);
+    NSTimeInterval visibilityTimeout = parameters[@"VisibilityTimeout"] ? [parameters[@"VisibilityTimeout"] doubleValue] : self.defaultVisibilityTimeout;
+    NSDate *deadline = [NSDate dateWithTimeIntervalSinceNow:MIN([parameters[@"WaitTimeSeconds"] doubleValue], self.maximumWaitTime)];
+    NSMutableString *result = [NSMutableString new];
+    NSUInteger count = 0;
+
+    [self.condition lock];
+    while (YES) {
+        NSDate *now = [NSDate date];
+        NSDate *nextVisibleDate = deadline;
+        for (AWSSQSStubEndpointMessage *message in self.messages) {
+            if ([message.visibleDate compare:now] == NSOrderedDescending) {
+                nextVisibleDate = [nextVisibleDate earlierDate:message.visibleDate];
+                continue;
+            }
+            message.receiptHandle = [[NSUUID UUID] UUIDString];
+            message.visibleDate = [now dateByAddingTimeInterval:visibilityTimeout];
+            [self.receiveCounts addObject:message.body];
+
+            [result appendFormat:@"<Message>%@%@%@</Message>",
+             [AWSSQSStubEndpoint XMLElement:@"MessageId" text:message.messageId],
+             [AWSSQSStubEndpoint XMLElement:@"ReceiptHandle" text:message.receiptHandle],
+             [AWSSQSStubEndpoint XMLElement:@"Body" text:message.body]];
+            if (++count == maximumCount) {
+                break;
+            }
+        }
+        if (count > 0 || [deadline timeIntervalSinceNow] <= 0) {
+            break;
+        }
+        [self.condition waitUntilDate:nextVisibleDate];
+    }
+    [self.condition unlock];
+
+    return result;
+}
+
+@end